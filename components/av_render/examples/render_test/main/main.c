@@ -7,10 +7,12 @@
    CONDITIONS OF ANY KIND, either express or implied.
 */
 
+#include <string.h>
 #include "sdkconfig.h"
 #include "esp_timer.h"
 #include "media_lib_adapter.h"
 #include "media_lib_os.h"
+#include "media_lib_err.h"
 #include "esp_codec_dev.h"
 #include "codec_init.h"
 #include "codec_board.h"
@@ -30,6 +32,12 @@
 
 static const char *TAG = "Render Test";
 
+// Frame pools so that capture frame is copied once into slab and passed to player by reference
+#define AUDIO_POOL_BLOCK_SIZE (1024)
+#define AUDIO_POOL_BLOCK_NUM  (16)
+#define VIDEO_POOL_BLOCK_SIZE (VIDEO_WIDTH * VIDEO_HEIGHT / 4)
+#define VIDEO_POOL_BLOCK_NUM  (4)
+
 #define RET_ON_NULL(ptr, v) do {                                \
     if (ptr == NULL) {                                          \
         ESP_LOGE(TAG, "Memory allocate fail on %d", __LINE__);  \
@@ -44,9 +52,11 @@ typedef struct {
 } capture_system_t;
 
 typedef struct {
-    audio_render_handle_t audio_render;
-    video_render_handle_t video_render;
-    av_render_handle_t    player;
+    audio_render_handle_t   audio_render;
+    video_render_handle_t   video_render;
+    av_render_handle_t      player;
+    av_render_pool_handle_t audio_pool;
+    av_render_pool_handle_t video_pool;
 } player_system_t;
 
 static capture_system_t capture_sys;
@@ -207,7 +217,7 @@ static int build_player_system(void)
         .video_render = player_sys.video_render,
         .audio_raw_fifo_size = 4096,
         .audio_render_fifo_size = 6 * 1024,
-        .video_raw_fifo_size = 500 * 1024,
+        .video_raw_fifo_size = 4096,
         .allow_drop_data = false,
     };
     player_sys.player = av_render_open(&render_cfg);
@@ -218,6 +228,51 @@ static int build_player_system(void)
     return 0;
 }
 
+static void player_pool_free(void *data, void *ctx)
+{
+    // Release only accept data inside the pool, try video pool first
+    if (av_render_pool_release(player_sys.video_pool, (uint8_t *)data) == ESP_MEDIA_ERR_INVALID_ARG) {
+        av_render_pool_release(player_sys.audio_pool, (uint8_t *)data);
+    }
+}
+
+static int create_player_pool(void)
+{
+    av_render_pool_cfg_t pool_cfg = {
+        .block_size = AUDIO_POOL_BLOCK_SIZE,
+        .block_num = AUDIO_POOL_BLOCK_NUM,
+    };
+    player_sys.audio_pool = av_render_pool_create(&pool_cfg);
+    pool_cfg.block_size = VIDEO_POOL_BLOCK_SIZE;
+    pool_cfg.block_num = VIDEO_POOL_BLOCK_NUM;
+    player_sys.video_pool = av_render_pool_create(&pool_cfg);
+    if (player_sys.audio_pool == NULL || player_sys.video_pool == NULL) {
+        ESP_LOGE(TAG, "Fail to create frame pool");
+        return -1;
+    }
+    return av_render_use_data_pool(player_sys.player, player_pool_free, NULL);
+}
+
+static void destroy_player_pool(void)
+{
+    av_render_pool_destroy(player_sys.audio_pool);
+    av_render_pool_destroy(player_sys.video_pool);
+    player_sys.audio_pool = NULL;
+    player_sys.video_pool = NULL;
+}
+
+static uint8_t *copy_to_pool(av_render_pool_handle_t pool, esp_capture_stream_frame_t *frame)
+{
+    // Wait for render to release slab, drop frame if it is too big
+    uint8_t *data = av_render_pool_acquire(pool, frame->size, 1000);
+    if (data == NULL) {
+        ESP_LOGW(TAG, "Drop frame size %d for no slab", frame->size);
+        return NULL;
+    }
+    memcpy(data, frame->data, frame->size);
+    return data;
+}
+
 static int media_sys_buildup(void)
 {
     // Register for default audio and video codecs
@@ -261,6 +316,10 @@ static int test_capture_to_player(int duration)
     esp_capture_sink_handle_t capture_path = setup_capture_sink();
 
     // Create player
+    if (create_player_pool() != 0) {
+        destroy_player_pool();
+        return -1;
+    }
     av_render_audio_info_t render_aud_info = {
         .codec = AV_RENDER_AUDIO_CODEC_G711A,
         .sample_rate = 8000,
@@ -282,26 +341,32 @@ static int test_capture_to_player(int duration)
         };
         while (esp_capture_sink_acquire_frame(capture_path, &frame, true) == ESP_CAPTURE_ERR_OK) {
             av_render_audio_data_t audio_data = {
-                .data = frame.data,
+                .data = copy_to_pool(player_sys.audio_pool, &frame),
                 .size = frame.size,
                 .pts = frame.pts,
             };
-            av_render_add_audio_data(player_sys.player, &audio_data);
             esp_capture_sink_release_frame(capture_path, &frame);
+            if (audio_data.data) {
+                av_render_add_audio_data(player_sys.player, &audio_data);
+            }
         }
         frame.stream_type = ESP_CAPTURE_STREAM_TYPE_VIDEO;
         while (esp_capture_sink_acquire_frame(capture_path, &frame, true) == ESP_CAPTURE_ERR_OK) {
             av_render_video_data_t video_data = {
-                .data = frame.data,
+                .data = copy_to_pool(player_sys.video_pool, &frame),
                 .size = frame.size,
                 .pts = frame.pts,
             };
-            av_render_add_video_data(player_sys.player, &video_data);
             esp_capture_sink_release_frame(capture_path, &frame);
+            if (video_data.data) {
+                av_render_add_video_data(player_sys.player, &video_data);
+            }
         }
     }
     esp_capture_stop(capture_sys.capture_handle);
     av_render_reset(player_sys.player);
+    // All slabs are released after reset
+    destroy_player_pool();
     return 0;
 }
 
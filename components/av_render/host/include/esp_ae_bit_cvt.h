@@ -0,0 +1,28 @@
+/* Host replacement of esp_ae bit convert, stand-in in sim_ae.c */
+#pragma once
+
+#include "esp_ae_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *esp_ae_bit_cvt_handle_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t  channel;
+    uint8_t  src_bits;
+    uint8_t  dest_bits;
+} esp_ae_bit_cvt_cfg_t;
+
+esp_ae_err_t esp_ae_bit_cvt_open(esp_ae_bit_cvt_cfg_t *cfg, esp_ae_bit_cvt_handle_t *handle);
+
+esp_ae_err_t esp_ae_bit_cvt_process(esp_ae_bit_cvt_handle_t handle, uint32_t sample_num, esp_ae_sample_t in_samples,
+                                    esp_ae_sample_t out_samples);
+
+void esp_ae_bit_cvt_close(esp_ae_bit_cvt_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,38 @@
+/* Host replacement of esp_ae rate convert, stand-in in sim_ae.c */
+#pragma once
+
+#include "esp_ae_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *esp_ae_rate_cvt_handle_t;
+
+typedef enum {
+    ESP_AE_RATE_CVT_PERF_TYPE_MEMORY = 0,
+    ESP_AE_RATE_CVT_PERF_TYPE_SPEED  = 1,
+} esp_ae_rate_cvt_perf_type_t;
+
+typedef struct {
+    uint32_t                    src_rate;
+    uint32_t                    dest_rate;
+    uint8_t                     channel;
+    uint8_t                     bits_per_sample;
+    uint8_t                     complexity;
+    esp_ae_rate_cvt_perf_type_t perf_type;
+} esp_ae_rate_cvt_cfg_t;
+
+esp_ae_err_t esp_ae_rate_cvt_open(esp_ae_rate_cvt_cfg_t *cfg, esp_ae_rate_cvt_handle_t *handle);
+
+esp_ae_err_t esp_ae_rate_cvt_get_max_out_sample_num(esp_ae_rate_cvt_handle_t handle, uint32_t in_sample_num,
+                                                    uint32_t *out_sample_num);
+
+esp_ae_err_t esp_ae_rate_cvt_process(esp_ae_rate_cvt_handle_t handle, esp_ae_sample_t in_samples,
+                                     uint32_t in_sample_num, esp_ae_sample_t out_samples, uint32_t *out_sample_num);
+
+void esp_ae_rate_cvt_close(esp_ae_rate_cvt_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
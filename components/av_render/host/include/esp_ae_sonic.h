@@ -0,0 +1,41 @@
+/* Host replacement of esp_ae sonic, only what render uses */
+#pragma once
+
+#include "esp_ae_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *esp_ae_sonic_handle_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t  channel;
+    uint8_t  bits_per_sample;
+} esp_ae_sonic_cfg_t;
+
+typedef struct {
+    esp_ae_sample_t samples;
+    uint32_t        num;
+    uint32_t        consume_num;
+} esp_ae_sonic_in_data_t;
+
+typedef struct {
+    esp_ae_sample_t samples;
+    uint32_t        needed_num;
+    uint32_t        out_num;
+} esp_ae_sonic_out_data_t;
+
+esp_ae_err_t esp_ae_sonic_open(esp_ae_sonic_cfg_t *cfg, esp_ae_sonic_handle_t *handle);
+
+esp_ae_err_t esp_ae_sonic_process(esp_ae_sonic_handle_t handle, esp_ae_sonic_in_data_t *in_samples,
+                                  esp_ae_sonic_out_data_t *out_samples);
+
+esp_ae_err_t esp_ae_sonic_set_speed(esp_ae_sonic_handle_t handle, float speed);
+
+void esp_ae_sonic_close(esp_ae_sonic_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
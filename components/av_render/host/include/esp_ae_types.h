@@ -0,0 +1,21 @@
+/* Host replacement of esp_ae types, only what render uses */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ESP_AE_ERR_OK                = 0,
+    ESP_AE_ERR_FAIL              = -1,
+    ESP_AE_ERR_MEM_LACK          = -2,
+    ESP_AE_ERR_INVALID_PARAMETER = -4,
+} esp_ae_err_t;
+
+typedef void *esp_ae_sample_t;
+
+#ifdef __cplusplus
+}
+#endif
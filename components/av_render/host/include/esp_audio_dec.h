@@ -0,0 +1,80 @@
+/* Host replacement of esp_audio_dec, only what audio decoder uses, stand-in in sim_audio_dec.c */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ESP_AUDIO_ERR_OK                = 0,
+    ESP_AUDIO_ERR_FAIL              = -1,
+    ESP_AUDIO_ERR_MEM_LACK          = -2,
+    ESP_AUDIO_ERR_INVALID_PARAMETER = -4,
+    ESP_AUDIO_ERR_BUFF_NOT_ENOUGH   = -5,
+} esp_audio_err_t;
+
+typedef enum {
+    ESP_AUDIO_TYPE_UNSUPPORT,
+    ESP_AUDIO_TYPE_MP3,
+    ESP_AUDIO_TYPE_AAC,
+    ESP_AUDIO_TYPE_AMRNB,
+    ESP_AUDIO_TYPE_AMRWB,
+    ESP_AUDIO_TYPE_OPUS,
+    ESP_AUDIO_TYPE_FLAC,
+    ESP_AUDIO_TYPE_VORBIS,
+    ESP_AUDIO_TYPE_G711A,
+    ESP_AUDIO_TYPE_G711U,
+    ESP_AUDIO_TYPE_ADPCM,
+    ESP_AUDIO_TYPE_ALAC,
+} esp_audio_type_t;
+
+typedef enum {
+    ESP_AUDIO_DEC_RECOVERY_NONE = 0,
+    ESP_AUDIO_DEC_RECOVERY_PLC  = 1,
+} esp_audio_dec_recovery_t;
+
+typedef void *esp_audio_dec_handle_t;
+
+typedef struct {
+    esp_audio_type_t type;
+    void            *cfg;
+    uint32_t         cfg_sz;
+} esp_audio_dec_cfg_t;
+
+typedef struct {
+    uint8_t                 *buffer;
+    uint32_t                 len;
+    uint32_t                 consumed;
+    esp_audio_dec_recovery_t frame_recover;
+} esp_audio_dec_in_raw_t;
+
+typedef struct {
+    uint8_t *buffer;
+    uint32_t len;
+    uint32_t needed_size;
+    uint32_t decoded_size;
+} esp_audio_dec_out_frame_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t  bits_per_sample;
+    uint8_t  channel;
+    uint32_t bitrate;
+    uint32_t frame_size;
+} esp_audio_dec_info_t;
+
+esp_audio_err_t esp_audio_dec_open(esp_audio_dec_cfg_t *config, esp_audio_dec_handle_t *decoder);
+
+esp_audio_err_t esp_audio_dec_process(esp_audio_dec_handle_t decoder, esp_audio_dec_in_raw_t *raw,
+                                      esp_audio_dec_out_frame_t *frame);
+
+esp_audio_err_t esp_audio_dec_get_info(esp_audio_dec_handle_t decoder, esp_audio_dec_info_t *info);
+
+esp_audio_err_t esp_audio_dec_close(esp_audio_dec_handle_t decoder);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,39 @@
+/* Host replacement of esp_audio_dec decoder configurations */
+#pragma once
+
+#include "esp_audio_dec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t  channel;
+} esp_opus_dec_cfg_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t  channel;
+    uint8_t  bits_per_sample;
+} esp_adpcm_dec_cfg_t;
+
+typedef struct {
+    uint8_t channel;
+} esp_g711_dec_cfg_t;
+
+typedef struct {
+    void *codec_spec_info;
+    int   spec_info_len;
+} esp_alac_dec_cfg_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t  channel;
+    uint8_t  bits_per_sample;
+    bool     no_adts_header;
+} esp_aac_dec_cfg_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,28 @@
+/* Host replacement of esp_codec_dev, playback is simulated by `sim_device.c` */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *esp_codec_dev_handle_t;
+
+typedef struct {
+    uint8_t  bits_per_sample;
+    uint8_t  channel;
+    uint16_t channel_mask;
+    uint32_t sample_rate;
+    int      mclk_multiple;
+} esp_codec_dev_sample_info_t;
+
+int esp_codec_dev_open(esp_codec_dev_handle_t codec, esp_codec_dev_sample_info_t *fs);
+
+int esp_codec_dev_write(esp_codec_dev_handle_t codec, void *data, int len);
+
+int esp_codec_dev_close(esp_codec_dev_handle_t codec);
+
+#ifdef __cplusplus
+}
+#endif
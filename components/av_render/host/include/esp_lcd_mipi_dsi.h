@@ -0,0 +1,31 @@
+/* Host replacement of esp_lcd MIPI DSI panel, only what render uses */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_lcd_panel_ops.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int reserved;
+} esp_lcd_dpi_panel_event_data_t;
+
+typedef bool (*esp_lcd_dpi_panel_general_cb_t)(esp_lcd_panel_handle_t panel, esp_lcd_dpi_panel_event_data_t *edata,
+                                               void *user_ctx);
+
+typedef struct {
+    esp_lcd_dpi_panel_general_cb_t on_color_trans_done;
+    esp_lcd_dpi_panel_general_cb_t on_refresh_done;
+} esp_lcd_dpi_panel_event_callbacks_t;
+
+esp_err_t esp_lcd_dpi_panel_register_event_callbacks(esp_lcd_panel_handle_t dpi_panel,
+                                                     const esp_lcd_dpi_panel_event_callbacks_t *cbs, void *user_ctx);
+
+esp_err_t esp_lcd_dpi_panel_get_frame_buffer(esp_lcd_panel_handle_t dpi_panel, uint32_t fb_num, void **fb0, ...);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+/* Host replacement of esp_lcd panel operations, panel is simulated by `sim_device.c` */
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+/* Host replacement of esp_timer, time is provided by simulated clock */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
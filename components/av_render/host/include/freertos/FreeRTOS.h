@@ -0,0 +1,29 @@
+/* Host replacement of FreeRTOS types and critical section, only what render uses */
+#pragma once
+
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int      BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE            (1)
+#define pdFALSE           (0)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+typedef pthread_mutex_t portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED PTHREAD_MUTEX_INITIALIZER
+#define portMUX_INITIALIZE(mux)      pthread_mutex_init(mux, NULL)
+#define portENTER_CRITICAL(mux)      pthread_mutex_lock(mux)
+#define portEXIT_CRITICAL(mux)       pthread_mutex_unlock(mux)
+#define portENTER_CRITICAL_ISR(mux)  pthread_mutex_lock(mux)
+#define portEXIT_CRITICAL_ISR(mux)   pthread_mutex_unlock(mux)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,2 @@
+/* Host build has no target specific configuration */
+#pragma once
@@ -0,0 +1,203 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Stand-in audio effects for host build of `audio_resample`
+ * Only 16 bits samples are handled: channel convert averages or duplicates, bit convert copies,
+ * rate convert runs a windowed sinc filter bank built at open so that open costs like a real converter
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_ae_ch_cvt.h"
+#include "esp_ae_bit_cvt.h"
+#include "esp_ae_rate_cvt.h"
+
+#define SIM_AE_TAPS    (32)
+#define SIM_AE_PHASES  (256)
+#define SIM_AE_MAX_CH  (8)
+
+typedef struct {
+    esp_ae_ch_cvt_cfg_t cfg;
+} sim_ch_cvt_t;
+
+typedef struct {
+    esp_ae_bit_cvt_cfg_t cfg;
+} sim_bit_cvt_t;
+
+typedef struct {
+    esp_ae_rate_cvt_cfg_t cfg;
+    uint64_t              pos;  /* Next output position in input samples, Q16 */
+    uint64_t              step; /* Input samples for one output sample, Q16 */
+    float                *coef;
+    int16_t               hist[SIM_AE_TAPS * SIM_AE_MAX_CH];
+} sim_rate_cvt_t;
+
+esp_ae_err_t esp_ae_ch_cvt_open(esp_ae_ch_cvt_cfg_t *cfg, esp_ae_ch_cvt_handle_t *handle)
+{
+    if (cfg == NULL || handle == NULL || cfg->src_ch == 0 || cfg->dest_ch == 0 || cfg->bits_per_sample != 16) {
+        return ESP_AE_ERR_INVALID_PARAMETER;
+    }
+    sim_ch_cvt_t *cvt = (sim_ch_cvt_t *)calloc(1, sizeof(sim_ch_cvt_t));
+    if (cvt == NULL) {
+        return ESP_AE_ERR_MEM_LACK;
+    }
+    cvt->cfg = *cfg;
+    *handle = cvt;
+    return ESP_AE_ERR_OK;
+}
+
+esp_ae_err_t esp_ae_ch_cvt_process(esp_ae_ch_cvt_handle_t handle, uint32_t sample_num, esp_ae_sample_t in_samples,
+                                   esp_ae_sample_t out_samples)
+{
+    sim_ch_cvt_t *cvt = (sim_ch_cvt_t *)handle;
+    int16_t *in = (int16_t *)in_samples;
+    int16_t *out = (int16_t *)out_samples;
+    int src_ch = cvt->cfg.src_ch;
+    int dest_ch = cvt->cfg.dest_ch;
+    for (uint32_t i = 0; i < sample_num; i++) {
+        int32_t sum = 0;
+        for (int c = 0; c < src_ch; c++) {
+            sum += in[i * src_ch + c];
+        }
+        for (int c = 0; c < dest_ch; c++) {
+            out[i * dest_ch + c] = (int16_t)(sum / src_ch);
+        }
+    }
+    return ESP_AE_ERR_OK;
+}
+
+void esp_ae_ch_cvt_close(esp_ae_ch_cvt_handle_t handle)
+{
+    free(handle);
+}
+
+esp_ae_err_t esp_ae_bit_cvt_open(esp_ae_bit_cvt_cfg_t *cfg, esp_ae_bit_cvt_handle_t *handle)
+{
+    if (cfg == NULL || handle == NULL || cfg->channel == 0 || cfg->dest_bits != 16) {
+        return ESP_AE_ERR_INVALID_PARAMETER;
+    }
+    sim_bit_cvt_t *cvt = (sim_bit_cvt_t *)calloc(1, sizeof(sim_bit_cvt_t));
+    if (cvt == NULL) {
+        return ESP_AE_ERR_MEM_LACK;
+    }
+    cvt->cfg = *cfg;
+    *handle = cvt;
+    return ESP_AE_ERR_OK;
+}
+
+esp_ae_err_t esp_ae_bit_cvt_process(esp_ae_bit_cvt_handle_t handle, uint32_t sample_num, esp_ae_sample_t in_samples,
+                                    esp_ae_sample_t out_samples)
+{
+    sim_bit_cvt_t *cvt = (sim_bit_cvt_t *)handle;
+    memmove(out_samples, in_samples, sample_num * cvt->cfg.channel * sizeof(int16_t));
+    return ESP_AE_ERR_OK;
+}
+
+void esp_ae_bit_cvt_close(esp_ae_bit_cvt_handle_t handle)
+{
+    free(handle);
+}
+
+esp_ae_err_t esp_ae_rate_cvt_open(esp_ae_rate_cvt_cfg_t *cfg, esp_ae_rate_cvt_handle_t *handle)
+{
+    if (cfg == NULL || handle == NULL || cfg->src_rate == 0 || cfg->dest_rate == 0 ||
+        cfg->channel == 0 || cfg->channel > SIM_AE_MAX_CH || cfg->bits_per_sample != 16) {
+        return ESP_AE_ERR_INVALID_PARAMETER;
+    }
+    sim_rate_cvt_t *cvt = (sim_rate_cvt_t *)calloc(1, sizeof(sim_rate_cvt_t));
+    if (cvt == NULL) {
+        return ESP_AE_ERR_MEM_LACK;
+    }
+    cvt->coef = (float *)malloc(sizeof(float) * SIM_AE_TAPS * SIM_AE_PHASES);
+    if (cvt->coef == NULL) {
+        free(cvt);
+        return ESP_AE_ERR_MEM_LACK;
+    }
+    cvt->cfg = *cfg;
+    cvt->step = ((uint64_t)cfg->src_rate << 16) / cfg->dest_rate;
+    // Hamming windowed sinc for each sub-sample phase
+    for (int p = 0; p < SIM_AE_PHASES; p++) {
+        for (int t = 0; t < SIM_AE_TAPS; t++) {
+            float x = (float)(t - SIM_AE_TAPS / 2) + (float)p / SIM_AE_PHASES;
+            float sinc = (x == 0) ? 1.0f : sinf((float)M_PI * x) / ((float)M_PI * x);
+            cvt->coef[p * SIM_AE_TAPS + t] = sinc * (0.54f - 0.46f * cosf(2.0f * (float)M_PI * t / SIM_AE_TAPS));
+        }
+    }
+    *handle = cvt;
+    return ESP_AE_ERR_OK;
+}
+
+esp_ae_err_t esp_ae_rate_cvt_get_max_out_sample_num(esp_ae_rate_cvt_handle_t handle, uint32_t in_sample_num,
+                                                    uint32_t *out_sample_num)
+{
+    sim_rate_cvt_t *cvt = (sim_rate_cvt_t *)handle;
+    *out_sample_num = (uint32_t)((uint64_t)in_sample_num * cvt->cfg.dest_rate / cvt->cfg.src_rate + 2);
+    return ESP_AE_ERR_OK;
+}
+
+esp_ae_err_t esp_ae_rate_cvt_process(esp_ae_rate_cvt_handle_t handle, esp_ae_sample_t in_samples,
+                                     uint32_t in_sample_num, esp_ae_sample_t out_samples, uint32_t *out_sample_num)
+{
+    sim_rate_cvt_t *cvt = (sim_rate_cvt_t *)handle;
+    int ch = cvt->cfg.channel;
+    int16_t *in = (int16_t *)in_samples;
+    int16_t *out = (int16_t *)out_samples;
+    uint32_t n = 0;
+    while ((cvt->pos >> 16) < in_sample_num) {
+        int pos = (int)(cvt->pos >> 16);
+        const float *coef = cvt->coef + ((cvt->pos >> 8) & (SIM_AE_PHASES - 1)) * SIM_AE_TAPS;
+        for (int c = 0; c < ch; c++) {
+            float sum = 0;
+            for (int t = 0; t < SIM_AE_TAPS; t++) {
+                // Samples before this call come from history of last call
+                int idx = pos - t;
+                int16_t v = idx >= 0 ? in[idx * ch + c] : cvt->hist[(SIM_AE_TAPS + idx) * ch + c];
+                sum += v * coef[t];
+            }
+            out[n * ch + c] = (int16_t)(sum > 32767 ? 32767 : sum < -32768 ? -32768 : sum);
+        }
+        n++;
+        cvt->pos += cvt->step;
+    }
+    cvt->pos -= (uint64_t)in_sample_num << 16;
+    // Keep last taps of input, shift old history when input is shorter than filter
+    for (int t = 0; t < SIM_AE_TAPS; t++) {
+        int idx = (int)in_sample_num - SIM_AE_TAPS + t;
+        for (int c = 0; c < ch; c++) {
+            cvt->hist[t * ch + c] = idx >= 0 ? in[idx * ch + c] : cvt->hist[(t + in_sample_num) * ch + c];
+        }
+    }
+    *out_sample_num = n;
+    return ESP_AE_ERR_OK;
+}
+
+void esp_ae_rate_cvt_close(esp_ae_rate_cvt_handle_t handle)
+{
+    sim_rate_cvt_t *cvt = (sim_rate_cvt_t *)handle;
+    if (cvt) {
+        free(cvt->coef);
+        free(cvt);
+    }
+}
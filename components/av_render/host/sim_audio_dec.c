@@ -0,0 +1,166 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Stand-in esp_audio_dec for host test of `audio_decoder`
+ * G.711 A-law is decoded for real so that concealment quality can be measured, G.711 u-law outputs silence
+ * Other codecs carry 16 bits PCM as payload, PLC request outputs silence of last frame size and is counted
+ * Or output silence of real frame size of codec, set by `sim_audio_dec_set_frame`
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_audio_dec.h"
+#include "sim_audio_dec.h"
+
+typedef struct {
+    esp_audio_type_t type;
+    uint32_t         last_size;
+} sim_audio_dec_t;
+
+static int      plc_num;
+static uint32_t frame_rate;
+static uint8_t  frame_channel;
+static uint32_t frame_samples;
+
+int16_t sim_audio_dec_alaw_decode(uint8_t alaw)
+{
+    alaw ^= 0x55;
+    int t = (alaw & 0x0F) << 4;
+    int seg = (alaw & 0x70) >> 4;
+    if (seg == 0) {
+        t += 8;
+    } else {
+        t += 0x108;
+        t <<= seg - 1;
+    }
+    return (int16_t)((alaw & 0x80) ? t : -t);
+}
+
+uint8_t sim_audio_dec_alaw_encode(int16_t pcm)
+{
+    static const int seg_end[8] = { 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF, 0x1FFF, 0x3FFF, 0x7FFF };
+    int p = pcm >> 3;
+    int mask = 0xD5;
+    if (p < 0) {
+        mask = 0x55;
+        p = -p - 1;
+    }
+    int seg = 0;
+    while (seg < 8 && p > seg_end[seg]) {
+        seg++;
+    }
+    if (seg >= 8) {
+        return (uint8_t)(0x7F ^ mask);
+    }
+    uint8_t alaw = (uint8_t)(seg << 4);
+    alaw |= (seg < 2) ? (p >> 1) & 0x0F : (p >> seg) & 0x0F;
+    return (uint8_t)(alaw ^ mask);
+}
+
+int sim_audio_dec_get_plc_num(void)
+{
+    return plc_num;
+}
+
+void sim_audio_dec_set_frame(uint32_t sample_rate, uint8_t channel, uint32_t samples)
+{
+    frame_rate = sample_rate;
+    frame_channel = channel;
+    frame_samples = samples;
+}
+
+static uint32_t get_frame_size(sim_audio_dec_t *dec, uint32_t len)
+{
+    switch (dec->type) {
+        case ESP_AUDIO_TYPE_G711A:
+        case ESP_AUDIO_TYPE_G711U:
+            return len * 2;
+        case ESP_AUDIO_TYPE_ADPCM:
+            // IMA block carries 4 bytes header with first sample for each channel
+            return frame_samples ? ((len / frame_channel - 4) * 2 + 1) * frame_channel * 2 : len;
+        default:
+            return frame_samples ? frame_samples * frame_channel * 2 : len;
+    }
+}
+
+esp_audio_err_t esp_audio_dec_open(esp_audio_dec_cfg_t *config, esp_audio_dec_handle_t *decoder)
+{
+    if (config == NULL || decoder == NULL) {
+        return ESP_AUDIO_ERR_INVALID_PARAMETER;
+    }
+    sim_audio_dec_t *dec = (sim_audio_dec_t *)calloc(1, sizeof(sim_audio_dec_t));
+    if (dec == NULL) {
+        return ESP_AUDIO_ERR_MEM_LACK;
+    }
+    dec->type = config->type;
+    *decoder = dec;
+    return ESP_AUDIO_ERR_OK;
+}
+
+esp_audio_err_t esp_audio_dec_process(esp_audio_dec_handle_t decoder, esp_audio_dec_in_raw_t *raw,
+                                      esp_audio_dec_out_frame_t *frame)
+{
+    sim_audio_dec_t *dec = (sim_audio_dec_t *)decoder;
+    bool alaw = (dec->type == ESP_AUDIO_TYPE_G711A);
+    uint32_t need = raw->frame_recover == ESP_AUDIO_DEC_RECOVERY_PLC ? dec->last_size : get_frame_size(dec, raw->len);
+    if (frame->len < need) {
+        frame->needed_size = need;
+        return ESP_AUDIO_ERR_BUFF_NOT_ENOUGH;
+    }
+    if (raw->frame_recover == ESP_AUDIO_DEC_RECOVERY_PLC) {
+        plc_num++;
+        memset(frame->buffer, 0, need);
+    } else if (alaw) {
+        int16_t *pcm = (int16_t *)frame->buffer;
+        for (uint32_t i = 0; i < raw->len; i++) {
+            pcm[i] = sim_audio_dec_alaw_decode(raw->buffer[i]);
+        }
+        raw->consumed = raw->len;
+    } else if (need != raw->len) {
+        memset(frame->buffer, 0, need);
+        raw->consumed = raw->len;
+    } else {
+        memcpy(frame->buffer, raw->buffer, raw->len);
+        raw->consumed = raw->len;
+    }
+    frame->decoded_size = need;
+    dec->last_size = need;
+    return ESP_AUDIO_ERR_OK;
+}
+
+esp_audio_err_t esp_audio_dec_get_info(esp_audio_dec_handle_t decoder, esp_audio_dec_info_t *info)
+{
+    sim_audio_dec_t *dec = (sim_audio_dec_t *)decoder;
+    bool g711 = (dec->type == ESP_AUDIO_TYPE_G711A || dec->type == ESP_AUDIO_TYPE_G711U);
+    info->sample_rate = frame_rate ? frame_rate : g711 ? 8000 : 48000;
+    info->channel = frame_channel ? frame_channel : 1;
+    info->bits_per_sample = 16;
+    return ESP_AUDIO_ERR_OK;
+}
+
+esp_audio_err_t esp_audio_dec_close(esp_audio_dec_handle_t decoder)
+{
+    free(decoder);
+    return ESP_AUDIO_ERR_OK;
+}
@@ -0,0 +1,61 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Encode one linear sample to G.711 A-law, used to build test stream for stand-in decoder
+ */
+uint8_t sim_audio_dec_alaw_encode(int16_t pcm);
+
+/**
+ * @brief  Decode one G.711 A-law sample, same as stand-in decoder
+ */
+int16_t sim_audio_dec_alaw_decode(uint8_t alaw);
+
+/**
+ * @brief  Get number of frames decoded with `ESP_AUDIO_DEC_RECOVERY_PLC` since process start
+ */
+int sim_audio_dec_get_plc_num(void);
+
+/**
+ * @brief  Make stand-in decoder output silence of real decoded frame size instead of PCM payload
+ *
+ * @note  G711 output size still follows packet size, ADPCM follows IMA block size
+ *
+ * @param[in]  sample_rate    Sample rate reported after header parsed
+ * @param[in]  channel        Channel reported after header parsed
+ * @param[in]  frame_samples  Samples per channel of following frames, 0 to carry PCM payload again
+ */
+void sim_audio_dec_set_frame(uint32_t sample_rate, uint8_t channel, uint32_t frame_samples);
+
+#ifdef __cplusplus
+}
+#endif
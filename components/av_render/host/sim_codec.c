@@ -0,0 +1,442 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Stand-in decoders and resample for host build
+ * They output silence or blank frames of the size real codec produces, so that timing, sync and drop decisions
+ * of av_render are kept while no codec library is needed
+ */
+
+#include <string.h>
+#include "audio_decoder.h"
+#include "video_decoder.h"
+#include "audio_resample.h"
+#include "video_parser.h"
+#include "sim_codec.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+#include "esp_log.h"
+
+#define TAG "SIM_CODEC"
+
+#define SIM_DEFAULT_FRAME_MS (20)
+#define SIM_FRAME_ALIGN      (16)
+
+typedef struct {
+    av_render_audio_info_t       info;
+    av_render_audio_frame_info_t frame_info;
+    adec_frame_cb                frame_cb;
+    void                        *ctx;
+    uint8_t                     *pcm;
+    uint32_t                     pcm_size;
+} sim_adec_t;
+
+typedef struct {
+    av_render_video_codec_t      codec;
+    av_render_video_frame_info_t frame_info;
+    vdec_frame_cb                frame_cb;
+    void                        *ctx;
+    vdec_fb_cb_cfg_t             fb_cb;
+    uint8_t                     *local_fb;
+    uint32_t                     local_fb_size;
+} sim_vdec_t;
+
+typedef struct {
+    audio_resample_cfg_t cfg;
+    uint8_t             *out;
+    uint32_t             out_size;
+    uint64_t             in_total;
+    uint64_t             out_total;
+} sim_resample_t;
+
+static sim_vdec_hook_t vdec_hook;
+static void           *vdec_hook_ctx;
+
+static uint32_t opus_frame_samples(const uint8_t *data, uint32_t size, uint32_t rate)
+{
+    if (size == 0) {
+        return rate * SIM_DEFAULT_FRAME_MS / 1000;
+    }
+    // Frame duration in 0.1ms from TOC configuration
+    static const uint16_t silk_dur[] = { 100, 200, 400, 600 };
+    static const uint16_t celt_dur[] = { 25, 50, 100, 200 };
+    uint8_t config = data[0] >> 3;
+    uint32_t dur = config < 12 ? silk_dur[config & 3] : config < 16 ? (config & 1 ? 200 : 100) : celt_dur[config & 3];
+    uint32_t count = 1;
+    switch (data[0] & 3) {
+        case 1:
+        case 2:
+            count = 2;
+            break;
+        case 3:
+            count = size > 1 ? (data[1] & 0x3F) : 1;
+            break;
+    }
+    return rate * dur * count / 10000;
+}
+
+static uint32_t audio_frame_samples(sim_adec_t *adec, av_render_audio_data_t *data)
+{
+    uint32_t rate = adec->frame_info.sample_rate;
+    switch (adec->info.codec) {
+        case AV_RENDER_AUDIO_CODEC_G711A:
+        case AV_RENDER_AUDIO_CODEC_G711U:
+            return data->size / adec->frame_info.channel;
+        case AV_RENDER_AUDIO_CODEC_ADPCM:
+            return data->size * 2 / adec->frame_info.channel;
+        case AV_RENDER_AUDIO_CODEC_AAC:
+            return 1024;
+        case AV_RENDER_AUDIO_CODEC_MP3:
+            return rate >= 32000 ? 1152 : 576;
+        case AV_RENDER_AUDIO_CODEC_OPUS:
+            return opus_frame_samples(data->data, data->size, rate);
+        default:
+            return rate * SIM_DEFAULT_FRAME_MS / 1000;
+    }
+}
+
+adec_handle_t adec_open(adec_cfg_t *cfg)
+{
+    if (cfg == NULL) {
+        return NULL;
+    }
+    sim_adec_t *adec = (sim_adec_t *)media_lib_calloc(1, sizeof(sim_adec_t));
+    if (adec == NULL) {
+        return NULL;
+    }
+    adec->info = cfg->audio_info;
+    adec->frame_cb = cfg->frame_cb;
+    adec->ctx = cfg->ctx;
+    adec->frame_info.sample_rate = cfg->audio_info.sample_rate ? cfg->audio_info.sample_rate : 8000;
+    adec->frame_info.channel = cfg->audio_info.channel ? cfg->audio_info.channel : 1;
+    adec->frame_info.bits_per_sample = 16;
+    return adec;
+}
+
+int adec_decode(adec_handle_t h, av_render_audio_data_t *data)
+{
+    sim_adec_t *adec = (sim_adec_t *)h;
+    if (adec == NULL || data == NULL || (data->size == 0 && data->eos == false)) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    av_render_audio_frame_t frame = {
+        .pts = data->pts,
+        .eos = data->eos,
+    };
+    if (data->size) {
+        uint32_t size = audio_frame_samples(adec, data) * adec->frame_info.channel * 2;
+        if (size > adec->pcm_size) {
+            media_lib_free(adec->pcm);
+            adec->pcm = (uint8_t *)media_lib_calloc(1, size);
+            if (adec->pcm == NULL) {
+                adec->pcm_size = 0;
+                return ESP_MEDIA_ERR_NO_MEM;
+            }
+            adec->pcm_size = size;
+        }
+        frame.data = adec->pcm;
+        frame.size = size;
+    }
+    if (adec->frame_cb) {
+        adec->frame_cb(&frame, adec->ctx);
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+int adec_get_frame_info(adec_handle_t h, av_render_audio_frame_info_t *frame_info)
+{
+    sim_adec_t *adec = (sim_adec_t *)h;
+    if (adec == NULL || frame_info == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    *frame_info = adec->frame_info;
+    return ESP_MEDIA_ERR_OK;
+}
+
+int adec_close(adec_handle_t h)
+{
+    sim_adec_t *adec = (sim_adec_t *)h;
+    if (adec == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    media_lib_free(adec->pcm);
+    media_lib_free(adec);
+    return ESP_MEDIA_ERR_OK;
+}
+
+void sim_vdec_set_hook(sim_vdec_hook_t hook, void *ctx)
+{
+    vdec_hook = hook;
+    vdec_hook_ctx = ctx;
+}
+
+static uint32_t video_frame_size(av_render_video_frame_info_t *info)
+{
+    uint32_t pixels = (uint32_t)info->width * info->height;
+    switch (info->type) {
+        case AV_RENDER_VIDEO_RAW_TYPE_YUV420:
+        case AV_RENDER_VIDEO_RAW_TYPE_NV12:
+        case AV_RENDER_VIDEO_RAW_TYPE_NV21:
+            return pixels * 3 / 2;
+        case AV_RENDER_VIDEO_RAW_TYPE_RGB888:
+            return pixels * 3;
+        default:
+            return pixels * 2;
+    }
+}
+
+int vdec_get_output_formats(av_render_video_codec_t codec, av_render_video_frame_type_t *fmts, uint8_t *num)
+{
+    // Same as software decoders: H264 output YUV420, JPEG output RGB565 directly
+    if (codec == AV_RENDER_VIDEO_CODEC_H264) {
+        if (*num < 1) {
+            return ESP_MEDIA_ERR_EXCEED_LIMIT;
+        }
+        fmts[0] = AV_RENDER_VIDEO_RAW_TYPE_YUV420;
+        *num = 1;
+        return ESP_MEDIA_ERR_OK;
+    }
+    if (codec == AV_RENDER_VIDEO_CODEC_MJPEG) {
+        if (*num < 3) {
+            return ESP_MEDIA_ERR_EXCEED_LIMIT;
+        }
+        fmts[0] = AV_RENDER_VIDEO_RAW_TYPE_RGB565;
+        fmts[1] = AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE;
+        fmts[2] = AV_RENDER_VIDEO_RAW_TYPE_YUV420;
+        *num = 3;
+        return ESP_MEDIA_ERR_OK;
+    }
+    return ESP_MEDIA_ERR_NOT_SUPPORT;
+}
+
+static uint8_t *local_fb_fetch(int align, int size, void *ctx)
+{
+    sim_vdec_t *vdec = (sim_vdec_t *)ctx;
+    if (vdec->local_fb && vdec->local_fb_size < (uint32_t)size) {
+        media_lib_free_align(vdec->local_fb);
+        vdec->local_fb = NULL;
+    }
+    if (vdec->local_fb == NULL) {
+        vdec->local_fb = (uint8_t *)media_lib_malloc_align(size, align > SIM_FRAME_ALIGN ? align : SIM_FRAME_ALIGN);
+        vdec->local_fb_size = vdec->local_fb ? size : 0;
+    }
+    return vdec->local_fb;
+}
+
+static int local_fb_return(uint8_t *addr, bool drop, void *ctx)
+{
+    return ESP_MEDIA_ERR_OK;
+}
+
+vdec_handle_t vdec_open(vdec_cfg_t *cfg)
+{
+    if (cfg == NULL) {
+        return NULL;
+    }
+    sim_vdec_t *vdec = (sim_vdec_t *)media_lib_calloc(1, sizeof(sim_vdec_t));
+    if (vdec == NULL) {
+        return NULL;
+    }
+    vdec->codec = cfg->video_info.codec;
+    vdec->frame_info.width = cfg->video_info.width;
+    vdec->frame_info.height = cfg->video_info.height;
+    vdec->frame_info.fps = cfg->video_info.fps;
+    vdec->frame_info.type = cfg->out_type ? cfg->out_type : AV_RENDER_VIDEO_RAW_TYPE_RGB565;
+    vdec->frame_cb = cfg->frame_cb;
+    vdec->ctx = cfg->ctx;
+    vdec->fb_cb.fb_fetch = local_fb_fetch;
+    vdec->fb_cb.fb_return = local_fb_return;
+    vdec->fb_cb.ctx = vdec;
+    return vdec;
+}
+
+int vdec_set_fb_cb(vdec_handle_t h, vdec_fb_cb_cfg_t *cfg)
+{
+    sim_vdec_t *vdec = (sim_vdec_t *)h;
+    if (vdec == NULL || cfg->fb_fetch == NULL || cfg->fb_return == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    vdec->fb_cb = *cfg;
+    return ESP_MEDIA_ERR_OK;
+}
+
+int vdec_decode(vdec_handle_t h, av_render_video_data_t *data)
+{
+    sim_vdec_t *vdec = (sim_vdec_t *)h;
+    if (vdec == NULL || data == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    av_render_video_frame_t out_frame = {
+        .pts = data->pts,
+        .eos = data->eos,
+    };
+    if (data->size) {
+        // Resolution is taken from stream header like real decoder does
+        video_parser_info_t info = {};
+        int ret = ESP_MEDIA_ERR_NOT_SUPPORT;
+        if (vdec->codec == AV_RENDER_VIDEO_CODEC_H264) {
+            ret = video_parse_h264(data->data, data->size, &info);
+        } else if (vdec->codec == AV_RENDER_VIDEO_CODEC_MJPEG) {
+            ret = video_parse_jpeg(data->data, data->size, &info);
+        }
+        if (ret == ESP_MEDIA_ERR_OK) {
+            vdec->frame_info.width = info.width;
+            vdec->frame_info.height = info.height;
+        } else if (vdec->frame_info.width == 0 || vdec->frame_info.height == 0) {
+            // Nothing decodable before header when stream information gives no resolution
+            return ESP_MEDIA_ERR_OK;
+        }
+        if (vdec_hook) {
+            uint32_t cost = vdec_hook(data->data, data->size, data->pts, vdec_hook_ctx);
+            if (cost) {
+                media_lib_thread_sleep(cost);
+            }
+        }
+        uint32_t size = video_frame_size(&vdec->frame_info);
+        out_frame.data = vdec->fb_cb.fb_fetch(SIM_FRAME_ALIGN, size, vdec->fb_cb.ctx);
+        if (out_frame.data == NULL) {
+            return ESP_MEDIA_ERR_NO_MEM;
+        }
+        out_frame.size = size;
+    }
+    if (vdec->frame_cb && (out_frame.data || data->eos)) {
+        vdec->frame_cb(&out_frame, vdec->ctx);
+        if (out_frame.data) {
+            vdec->fb_cb.fb_return(out_frame.data, false, vdec->fb_cb.ctx);
+        }
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+int vdec_get_convert_time(vdec_handle_t h, uint32_t *convert_us)
+{
+    // Stand-in decoder outputs requested format without convert
+    if (h == NULL || convert_us == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    *convert_us = 0;
+    return ESP_MEDIA_ERR_OK;
+}
+
+int vdec_get_frame_info(vdec_handle_t h, av_render_video_frame_info_t *frame_info)
+{
+    sim_vdec_t *vdec = (sim_vdec_t *)h;
+    if (vdec == NULL || frame_info == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    if (vdec->frame_info.width == 0 || vdec->frame_info.height == 0) {
+        return ESP_MEDIA_ERR_NOT_SUPPORT;
+    }
+    *frame_info = vdec->frame_info;
+    return ESP_MEDIA_ERR_OK;
+}
+
+int vdec_close(vdec_handle_t h)
+{
+    sim_vdec_t *vdec = (sim_vdec_t *)h;
+    if (vdec == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    if (vdec->local_fb) {
+        media_lib_free_align(vdec->local_fb);
+    }
+    media_lib_free(vdec);
+    return ESP_MEDIA_ERR_OK;
+}
+
+audio_resample_handle_t audio_resample_open(audio_resample_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->resample_cb == NULL) {
+        return NULL;
+    }
+    sim_resample_t *resample = (sim_resample_t *)media_lib_calloc(1, sizeof(sim_resample_t));
+    if (resample == NULL) {
+        return NULL;
+    }
+    resample->cfg = *cfg;
+    return resample;
+}
+
+int audio_resample_set_info(audio_resample_handle_t h, av_render_audio_frame_info_t *input_info,
+                            av_render_audio_frame_info_t *output_info)
+{
+    sim_resample_t *resample = (sim_resample_t *)h;
+    if (resample == NULL || input_info == NULL || output_info == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    resample->cfg.input_info = *input_info;
+    resample->cfg.output_info = *output_info;
+    resample->in_total = resample->out_total = 0;
+    return ESP_MEDIA_ERR_OK;
+}
+
+int audio_resample_write(audio_resample_handle_t h, av_render_audio_frame_t *data)
+{
+    sim_resample_t *resample = (sim_resample_t *)h;
+    av_render_audio_frame_info_t *in_info = &resample->cfg.input_info;
+    av_render_audio_frame_info_t *out_info = &resample->cfg.output_info;
+    if (data->size == 0 || memcmp(in_info, out_info, sizeof(av_render_audio_frame_info_t)) == 0) {
+        resample->cfg.resample_cb(data, resample->cfg.ctx);
+        return ESP_MEDIA_ERR_OK;
+    }
+    int in_sample_size = in_info->channel * in_info->bits_per_sample / 8;
+    int out_sample_size = out_info->channel * out_info->bits_per_sample / 8;
+    uint32_t sample_num = data->size / in_sample_size;
+    uint32_t block = resample->cfg.block_samples ? resample->cfg.block_samples : sample_num;
+    uint32_t done = 0;
+    av_render_audio_frame_t new_frame = *data;
+    // Keep same block split and PTS as real resample, output count follows rate without accumulated rounding
+    while (done < sample_num) {
+        uint32_t n = (sample_num - done) > block ? block : (sample_num - done);
+        resample->in_total += n;
+        uint64_t out_total = resample->in_total * out_info->sample_rate / in_info->sample_rate;
+        uint32_t size = (uint32_t)(out_total - resample->out_total) * out_sample_size;
+        resample->out_total = out_total;
+        if (size > resample->out_size) {
+            media_lib_free(resample->out);
+            resample->out = (uint8_t *)media_lib_calloc(1, size);
+            if (resample->out == NULL) {
+                resample->out_size = 0;
+                return ESP_MEDIA_ERR_NO_MEM;
+            }
+            resample->out_size = size;
+        }
+        new_frame.data = resample->out;
+        new_frame.size = size;
+        new_frame.pts = data->pts + (uint32_t)((uint64_t)done * 1000 / in_info->sample_rate);
+        done += n;
+        new_frame.eos = (done >= sample_num) ? data->eos : false;
+        resample->cfg.resample_cb(&new_frame, resample->cfg.ctx);
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+void audio_resample_close(audio_resample_handle_t h)
+{
+    sim_resample_t *resample = (sim_resample_t *)h;
+    if (resample == NULL) {
+        return;
+    }
+    media_lib_free(resample->out);
+    media_lib_free(resample);
+}
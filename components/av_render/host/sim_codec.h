@@ -0,0 +1,54 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Hook called by stand-in video decoder for each frame it decodes
+ *
+ * @param[in]  data  Encoded frame
+ * @param[in]  size  Encoded frame size
+ * @param[in]  pts   Frame pts
+ * @param[in]  ctx   User context
+ *
+ * @return  Time in milliseconds the decode takes, it is slept so that slow decoder can be simulated
+ */
+typedef uint32_t (*sim_vdec_hook_t)(const uint8_t *data, uint32_t size, uint32_t pts, void *ctx);
+
+/**
+ * @brief  Set video decode hook, set NULL to decode without cost
+ *
+ * @note  Set before video stream added, hook is called from decoder thread
+ */
+void sim_vdec_set_hook(sim_vdec_hook_t hook, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,371 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Simulated codec, sonic and DSI panel for host test of `render_impl`
+ * Devices run on virtual clock of `sim_render.c`
+ * Codec is DMA ring drained at sample rate, space freed per descriptor and write blocks while full
+ * Sonic keeps fixed amount of input inside and outputs rest at speed
+ * DSI panel transfer takes fixed time, done interrupt gives callback when clock passes it
+ * DSI panel with frame buffers switches scan out to last drawn one on each refresh, then gives refresh done
+ * Panel can keep drawn pixels and count drawn bytes to check partial update
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_codec_dev.h"
+#include "esp_ae_sonic.h"
+#include "esp_lcd_mipi_dsi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sim_render.h"
+#include "sim_device.h"
+
+#define SIM_DMA_SAMPLES  (6 * 240)
+#define SIM_DESC_SAMPLES (240)
+#define SIM_DRAW_US      (12000)
+#define SIM_SONIC_HOLD   (256)
+#define SIM_MAX_FB_NUM   (3)
+
+struct sim_semaphore_t {
+    bool given;
+};
+
+static sim_device_cfg_t device_cfg = {
+    .dma_samples = SIM_DMA_SAMPLES,
+    .desc_samples = SIM_DESC_SAMPLES,
+    .draw_us = SIM_DRAW_US,
+};
+
+static uint32_t codec_rate;
+static uint32_t codec_sample_size;
+static int64_t  codec_play_end;
+
+static float sonic_pending;
+static float sonic_speed = 1.0f;
+
+static esp_lcd_dpi_panel_general_cb_t draw_done_cb;
+static void                          *draw_done_ctx;
+static bool                           drawing;
+static int64_t                        draw_end;
+
+static esp_lcd_dpi_panel_general_cb_t refresh_cb;
+static void                          *refresh_ctx;
+static int64_t                        refresh_next;
+static uint8_t                       *panel_fb[SIM_MAX_FB_NUM];
+static uint8_t                       *scan_fb;
+static uint8_t                       *submit_fb;
+
+static uint8_t *panel_data;
+static int      panel_width;
+static int      panel_height;
+static uint64_t panel_bytes;
+static uint32_t panel_draw_num;
+
+void sim_device_set_cfg(sim_device_cfg_t *cfg)
+{
+    device_cfg = *cfg;
+    // Refresh runs from time 0 with fixed period
+    refresh_next = 0;
+    if (device_cfg.refresh_us) {
+        refresh_next = (sim_clock_now() / device_cfg.refresh_us + 1) * device_cfg.refresh_us;
+    }
+}
+
+static void panel_check_done(void)
+{
+    if (drawing == false || sim_clock_now() < draw_end) {
+        return;
+    }
+    drawing = false;
+    esp_lcd_dpi_panel_event_data_t data = {};
+    if (draw_done_cb) {
+        draw_done_cb(NULL, &data, draw_done_ctx);
+    }
+}
+
+static void panel_check_refresh(void)
+{
+    if (refresh_next == 0 || sim_clock_now() < refresh_next) {
+        return;
+    }
+    refresh_next += device_cfg.refresh_us;
+    if (submit_fb) {
+        scan_fb = submit_fb;
+    }
+    esp_lcd_dpi_panel_event_data_t data = {};
+    if (refresh_cb) {
+        refresh_cb(NULL, &data, refresh_ctx);
+    }
+}
+
+// Time of next panel interrupt, -1 for none
+static int64_t panel_next_event(void)
+{
+    int64_t next = -1;
+    if (drawing) {
+        next = draw_end;
+    }
+    if (refresh_next && (next < 0 || refresh_next < next)) {
+        next = refresh_next;
+    }
+    return next;
+}
+
+void sim_device_advance(int64_t us)
+{
+    int64_t target = sim_clock_now() + (us > 0 ? us : 0);
+    // Stop at each interrupt so that it sees right time
+    int64_t next;
+    while ((next = panel_next_event()) >= 0 && next <= target) {
+        sim_clock_wait_until(next);
+        panel_check_done();
+        panel_check_refresh();
+    }
+    sim_clock_wait_until(target);
+}
+
+int64_t sim_device_audio_queued(void)
+{
+    int64_t left = codec_play_end - sim_clock_now();
+    return left > 0 ? left : 0;
+}
+
+float sim_device_sonic_pending(void)
+{
+    return sonic_pending;
+}
+
+int64_t sim_device_draw_pending(void)
+{
+    int64_t left = draw_end - sim_clock_now();
+    return drawing && left > 0 ? left : 0;
+}
+
+uint8_t *sim_device_scan_out(void)
+{
+    return scan_fb;
+}
+
+int sim_device_panel_init(int width, int height)
+{
+    sim_device_panel_deinit();
+    panel_data = (uint8_t *)calloc(1, width * height * 2);
+    if (panel_data == NULL) {
+        return -1;
+    }
+    panel_width = width;
+    panel_height = height;
+    return 0;
+}
+
+void sim_device_panel_deinit(void)
+{
+    free(panel_data);
+    panel_data = NULL;
+    panel_bytes = 0;
+    panel_draw_num = 0;
+}
+
+void sim_device_panel_stats(uint64_t *bytes, uint32_t *draw_num)
+{
+    *bytes = panel_bytes;
+    *draw_num = panel_draw_num;
+}
+
+const uint8_t *sim_device_panel_data(void)
+{
+    return panel_data;
+}
+
+int esp_codec_dev_open(esp_codec_dev_handle_t codec, esp_codec_dev_sample_info_t *fs)
+{
+    codec_rate = fs->sample_rate;
+    codec_sample_size = fs->channel * fs->bits_per_sample / 8;
+    codec_play_end = sim_clock_now();
+    return codec_rate && codec_sample_size ? 0 : -1;
+}
+
+int esp_codec_dev_write(esp_codec_dev_handle_t codec, void *data, int len)
+{
+    int64_t dma_us = (int64_t)device_cfg.dma_samples * 1000000 / codec_rate;
+    int64_t desc_us = (int64_t)device_cfg.desc_samples * 1000000 / codec_rate;
+    int64_t left = (int64_t)(len / codec_sample_size) * 1000000 / codec_rate;
+    while (left > 0) {
+        int64_t queued = sim_device_audio_queued();
+        // Descriptor still playing is not writable
+        int64_t busy = (queued + desc_us - 1) / desc_us * desc_us;
+        int64_t room = dma_us - busy;
+        if (room <= 0) {
+            // Block until one descriptor is played
+            sim_device_advance(queued - (busy - desc_us));
+            continue;
+        }
+        int64_t n = room < left ? room : left;
+        if (codec_play_end < sim_clock_now()) {
+            codec_play_end = sim_clock_now();
+        }
+        codec_play_end += n;
+        left -= n;
+    }
+    return 0;
+}
+
+int esp_codec_dev_close(esp_codec_dev_handle_t codec)
+{
+    return 0;
+}
+
+esp_ae_err_t esp_ae_sonic_open(esp_ae_sonic_cfg_t *cfg, esp_ae_sonic_handle_t *handle)
+{
+    *handle = (esp_ae_sonic_handle_t)&sonic_pending;
+    sonic_pending = 0;
+    return ESP_AE_ERR_OK;
+}
+
+esp_ae_err_t esp_ae_sonic_process(esp_ae_sonic_handle_t handle, esp_ae_sonic_in_data_t *in_samples,
+                                  esp_ae_sonic_out_data_t *out_samples)
+{
+    in_samples->consume_num = in_samples->num;
+    sonic_pending += in_samples->num;
+    uint32_t out_num = 0;
+    if (sonic_pending > SIM_SONIC_HOLD) {
+        out_num = (uint32_t)((sonic_pending - SIM_SONIC_HOLD) / sonic_speed);
+    }
+    if (out_num > out_samples->needed_num) {
+        out_num = out_samples->needed_num;
+    }
+    sonic_pending -= out_num * sonic_speed;
+    out_samples->out_num = out_num;
+    return ESP_AE_ERR_OK;
+}
+
+esp_ae_err_t esp_ae_sonic_set_speed(esp_ae_sonic_handle_t handle, float speed)
+{
+    sonic_speed = speed;
+    return ESP_AE_ERR_OK;
+}
+
+void esp_ae_sonic_close(esp_ae_sonic_handle_t handle)
+{
+    sonic_pending = 0;
+    sonic_speed = 1.0f;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data)
+{
+    for (int i = 0; i < SIM_MAX_FB_NUM; i++) {
+        if (panel_fb[i] && color_data == panel_fb[i]) {
+            // Only switch scan out buffer, taken on next refresh
+            submit_fb = panel_fb[i];
+            return ESP_OK;
+        }
+    }
+    int len = (x_end - x_start) * 2;
+    if (panel_data) {
+        if (x_start < 0 || y_start < 0 || x_end > panel_width || y_end > panel_height) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        const uint8_t *src = (const uint8_t *)color_data;
+        for (int y = y_start; y < y_end; y++) {
+            memcpy(panel_data + (y * panel_width + x_start) * 2, src, len);
+            src += len;
+        }
+    }
+    panel_bytes += (uint64_t)len * (y_end - y_start);
+    panel_draw_num++;
+    draw_end = sim_clock_now() + device_cfg.draw_us;
+    drawing = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_dpi_panel_register_event_callbacks(esp_lcd_panel_handle_t dpi_panel,
+                                                     const esp_lcd_dpi_panel_event_callbacks_t *cbs, void *user_ctx)
+{
+    draw_done_cb = cbs->on_color_trans_done;
+    draw_done_ctx = user_ctx;
+    refresh_cb = cbs->on_refresh_done;
+    refresh_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_dpi_panel_get_frame_buffer(esp_lcd_panel_handle_t dpi_panel, uint32_t fb_num, void **fb0, ...)
+{
+    if (fb_num == 0 || fb_num > device_cfg.fb_num) {
+        return ESP_FAIL;
+    }
+    for (int i = 0; i < SIM_MAX_FB_NUM; i++) {
+        free(panel_fb[i]);
+        panel_fb[i] = i < fb_num ? (uint8_t *)calloc(1, device_cfg.fb_size) : NULL;
+    }
+    // Panel starts from showing first frame buffer
+    scan_fb = submit_fb = panel_fb[0];
+    va_list args;
+    va_start(args, fb0);
+    *fb0 = panel_fb[0];
+    for (int i = 1; i < fb_num; i++) {
+        *va_arg(args, void **) = panel_fb[i];
+    }
+    va_end(args);
+    return ESP_OK;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return (SemaphoreHandle_t)calloc(1, sizeof(struct sim_semaphore_t));
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    // Only panel interrupts give it asynchronously, wait for them on virtual clock
+    int64_t timeout = sim_clock_now() + (int64_t)ticks * 1000;
+    int64_t next;
+    while (sem->given == false && sim_clock_now() < timeout && (next = panel_next_event()) >= 0) {
+        sim_device_advance((next < timeout ? next : timeout) - sim_clock_now());
+    }
+    if (sem->given == false) {
+        return pdFALSE;
+    }
+    sem->given = false;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    sem->given = true;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *need_yield)
+{
+    *need_yield = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    free(sem);
+}
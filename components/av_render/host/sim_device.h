@@ -0,0 +1,99 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Simulated playback and display device configuration
+ */
+typedef struct {
+    uint32_t dma_samples;  /*!< Audio DMA ring size in samples, write blocks when full */
+    uint32_t desc_samples; /*!< Samples of one DMA descriptor, space is freed per descriptor */
+    uint32_t draw_us;      /*!< DSI transfer time of one frame */
+    uint8_t  fb_num;       /*!< Frame buffers DSI panel provides, 0 for none */
+    uint32_t fb_size;      /*!< Size of one frame buffer */
+    uint32_t refresh_us;   /*!< Refresh period of DSI panel, 0 for no refresh done interrupt */
+} sim_device_cfg_t;
+
+/**
+ * @brief  Set simulated device configuration, take effect on next open or draw
+ */
+void sim_device_set_cfg(sim_device_cfg_t *cfg);
+
+/**
+ * @brief  Advance simulated clock, transfer done and refresh done interrupt of panel fire when their time passed
+ */
+void sim_device_advance(int64_t us);
+
+/**
+ * @brief  Get true time (unit us) to play out audio queued in DMA of simulated codec
+ */
+int64_t sim_device_audio_queued(void);
+
+/**
+ * @brief  Get input samples kept inside simulated sonic
+ */
+float sim_device_sonic_pending(void);
+
+/**
+ * @brief  Get time (unit us) until current panel transfer finish
+ */
+int64_t sim_device_draw_pending(void);
+
+/**
+ * @brief  Get frame buffer being scanned out by panel, NULL when frame buffer not used
+ *         Panel switches to last drawn frame buffer on each refresh
+ */
+uint8_t *sim_device_scan_out(void);
+
+/**
+ * @brief  Give simulated panel memory of `width` x `height` RGB565 pixels and clear draw counters
+ *         Drawn bitmaps are copied into it afterwards
+ */
+int sim_device_panel_init(int width, int height);
+
+/**
+ * @brief  Release simulated panel memory
+ */
+void sim_device_panel_deinit(void);
+
+/**
+ * @brief  Get bytes and calls drawn into simulated panel since init
+ */
+void sim_device_panel_stats(uint64_t *bytes, uint32_t *draw_num);
+
+/**
+ * @brief  Get current content of simulated panel
+ */
+const uint8_t *sim_device_panel_data(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,331 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Simulated audio and video devices for host build
+ * Device time follows real or virtual clock so that render timing can be checked without hardware
+ */
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim_render.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+#include "esp_timer.h"
+
+#define VIRTUAL_CLOCK_START_US (1000000)
+#define SIM_MAX_FB_NUM         (3)
+#define SIM_FB_ALIGN           (64)
+
+typedef struct {
+    sim_render_cfg_t             cfg;
+    av_render_audio_frame_info_t info;
+    float                        speed;
+    int64_t                      play_end;
+    media_lib_mutex_handle_t     lock;
+} sim_audio_t;
+
+typedef struct {
+    sim_render_cfg_t             cfg;
+    av_render_video_frame_info_t info;
+    uint8_t                     *fb[SIM_MAX_FB_NUM];
+    int                          fb_size;
+    uint8_t                      fb_idx;
+} sim_video_t;
+
+static bool    use_virtual;
+static int64_t virtual_now = VIRTUAL_CLOCK_START_US;
+
+void __real_media_lib_thread_sleep(uint32_t ms);
+
+void sim_clock_use_virtual(bool virtual_clock)
+{
+    use_virtual = virtual_clock;
+}
+
+int64_t sim_clock_now(void)
+{
+    if (use_virtual) {
+        return virtual_now;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void sim_clock_wait_until(int64_t time_us)
+{
+    if (use_virtual) {
+        if (time_us > virtual_now) {
+            virtual_now = time_us;
+        }
+        return;
+    }
+    int64_t left = time_us - sim_clock_now();
+    if (left > 0) {
+        usleep((useconds_t)left);
+    }
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return sim_clock_now();
+}
+
+// Linked with --wrap so that render waits for frame due time on virtual clock
+void __wrap_media_lib_thread_sleep(uint32_t ms)
+{
+    if (use_virtual) {
+        virtual_now += (int64_t)ms * 1000;
+        return;
+    }
+    __real_media_lib_thread_sleep(ms);
+}
+
+static audio_render_handle_t sim_audio_init(void *cfg, int size)
+{
+    sim_audio_t *audio = (sim_audio_t *)media_lib_calloc(1, sizeof(sim_audio_t));
+    if (audio == NULL) {
+        return NULL;
+    }
+    audio->cfg = *(sim_render_cfg_t *)cfg;
+    audio->speed = 1.0f;
+    media_lib_mutex_create(&audio->lock);
+    return audio;
+}
+
+static int sim_audio_open(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    sim_audio_t *audio = (sim_audio_t *)h;
+    audio->info = *info;
+    audio->play_end = sim_clock_now();
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_audio_write(audio_render_handle_t h, av_render_audio_frame_t *frame)
+{
+    sim_audio_t *audio = (sim_audio_t *)h;
+    uint32_t sample_size = audio->info.channel * audio->info.bits_per_sample / 8;
+    if (sample_size == 0 || audio->info.sample_rate == 0) {
+        return ESP_MEDIA_ERR_WRONG_STATE;
+    }
+    int64_t duration = (int64_t)((double)frame->size / sample_size * 1000000 / audio->info.sample_rate / audio->speed);
+    media_lib_mutex_lock(audio->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int64_t now = sim_clock_now();
+    // Underrun when device run dry
+    if (audio->play_end < now) {
+        audio->play_end = now;
+    }
+    // Block until device has room like I2S write does
+    int64_t room_at = audio->play_end + duration - (int64_t)audio->cfg.audio_buffer_ms * 1000;
+    media_lib_mutex_unlock(audio->lock);
+    sim_clock_wait_until(room_at);
+    media_lib_mutex_lock(audio->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    now = sim_clock_now();
+    if (audio->play_end < now) {
+        audio->play_end = now;
+    }
+    audio->play_end += duration;
+    media_lib_mutex_unlock(audio->lock);
+    sim_trace('A', frame->pts, frame->size);
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_audio_get_latency(audio_render_handle_t h, uint32_t *latency)
+{
+    sim_audio_t *audio = (sim_audio_t *)h;
+    media_lib_mutex_lock(audio->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int64_t left = audio->play_end - sim_clock_now();
+    media_lib_mutex_unlock(audio->lock);
+    *latency = left > 0 ? (uint32_t)(left / 1000) : 0;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_audio_get_frame_info(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    sim_audio_t *audio = (sim_audio_t *)h;
+    *info = audio->info;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_audio_set_speed(audio_render_handle_t h, float speed)
+{
+    sim_audio_t *audio = (sim_audio_t *)h;
+    audio->speed = speed > 0 ? speed : 1.0f;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_audio_close(audio_render_handle_t h)
+{
+    return ESP_MEDIA_ERR_OK;
+}
+
+static void sim_audio_deinit(audio_render_handle_t h)
+{
+    sim_audio_t *audio = (sim_audio_t *)h;
+    media_lib_mutex_destroy(audio->lock);
+    media_lib_free(audio);
+}
+
+audio_render_handle_t sim_audio_render_alloc(sim_render_cfg_t *cfg)
+{
+    audio_render_cfg_t render_cfg = {
+        .ops = {
+            .init = sim_audio_init,
+            .open = sim_audio_open,
+            .write = sim_audio_write,
+            .get_latency = sim_audio_get_latency,
+            .get_frame_info = sim_audio_get_frame_info,
+            .set_speed = sim_audio_set_speed,
+            .close = sim_audio_close,
+            .deinit = sim_audio_deinit,
+        },
+        .cfg = cfg,
+        .cfg_size = sizeof(sim_render_cfg_t),
+    };
+    return audio_render_alloc_handle(&render_cfg);
+}
+
+static video_render_handle_t sim_video_open(void *cfg, int size)
+{
+    sim_video_t *video = (sim_video_t *)media_lib_calloc(1, sizeof(sim_video_t));
+    if (video) {
+        video->cfg = *(sim_render_cfg_t *)cfg;
+        if (video->cfg.video_fb_num > SIM_MAX_FB_NUM) {
+            video->cfg.video_fb_num = SIM_MAX_FB_NUM;
+        }
+    }
+    return video;
+}
+
+static void sim_video_free_fb(sim_video_t *video)
+{
+    for (int i = 0; i < SIM_MAX_FB_NUM; i++) {
+        if (video->fb[i]) {
+            media_lib_free_align(video->fb[i]);
+            video->fb[i] = NULL;
+        }
+    }
+    video->fb_size = 0;
+}
+
+static bool sim_video_format_support(video_render_handle_t h, av_render_video_frame_type_t type)
+{
+    return type == AV_RENDER_VIDEO_RAW_TYPE_RGB565;
+}
+
+static int sim_video_set_frame_info(video_render_handle_t h, av_render_video_frame_info_t *info)
+{
+    sim_video_t *video = (sim_video_t *)h;
+    video->info = *info;
+    int fb_size = info->width * info->height * 2;
+    if (video->cfg.video_fb_num && fb_size != video->fb_size) {
+        sim_video_free_fb(video);
+        for (int i = 0; i < video->cfg.video_fb_num; i++) {
+            video->fb[i] = (uint8_t *)media_lib_malloc_align(fb_size, SIM_FB_ALIGN);
+            if (video->fb[i] == NULL) {
+                sim_video_free_fb(video);
+                return ESP_MEDIA_ERR_NO_MEM;
+            }
+        }
+        video->fb_size = fb_size;
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_video_get_frame_buffer(video_render_handle_t h, av_render_frame_buffer_t *fb)
+{
+    sim_video_t *video = (sim_video_t *)h;
+    if (video->fb[0] == NULL) {
+        return ESP_MEDIA_ERR_NOT_SUPPORT;
+    }
+    // Lend buffer next to the one shown
+    fb->data = video->fb[(video->fb_idx + 1) % video->cfg.video_fb_num];
+    fb->size = video->fb_size;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_video_write(video_render_handle_t h, av_render_video_frame_t *frame)
+{
+    sim_video_t *video = (sim_video_t *)h;
+    if (video->fb[0]) {
+        int idx = (video->fb_idx + 1) % video->cfg.video_fb_num;
+        // Frame not drawn into lent buffer is copied into it
+        if (frame->data != video->fb[idx] && frame->size) {
+            memcpy(video->fb[idx], frame->data, frame->size < video->fb_size ? frame->size : video->fb_size);
+        }
+        video->fb_idx = idx;
+    }
+    if (video->cfg.video_draw_ms) {
+        sim_clock_wait_until(sim_clock_now() + (int64_t)video->cfg.video_draw_ms * 1000);
+    }
+    sim_trace('V', frame->pts, frame->size);
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_video_get_latency(video_render_handle_t h, uint32_t *latency)
+{
+    // Frame is shown once draw returns
+    *latency = 0;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_video_get_frame_info(video_render_handle_t h, av_render_video_frame_info_t *info)
+{
+    sim_video_t *video = (sim_video_t *)h;
+    *info = video->info;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_video_clear(video_render_handle_t h)
+{
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int sim_video_close(video_render_handle_t h)
+{
+    sim_video_free_fb((sim_video_t *)h);
+    media_lib_free(h);
+    return ESP_MEDIA_ERR_OK;
+}
+
+video_render_handle_t sim_video_render_alloc(sim_render_cfg_t *cfg)
+{
+    video_render_cfg_t render_cfg = {
+        .ops = {
+            .open = sim_video_open,
+            .format_support = sim_video_format_support,
+            .set_frame_info = sim_video_set_frame_info,
+            .get_frame_buffer = sim_video_get_frame_buffer,
+            .write = sim_video_write,
+            .get_latency = sim_video_get_latency,
+            .get_frame_info = sim_video_get_frame_info,
+            .clear = sim_video_clear,
+            .close = sim_video_close,
+        },
+        .cfg = cfg,
+        .cfg_size = sizeof(sim_render_cfg_t),
+    };
+    return video_render_alloc_handle(&render_cfg);
+}
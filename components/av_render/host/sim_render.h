@@ -0,0 +1,81 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "audio_render.h"
+#include "video_render.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Simulated render device configuration
+ */
+typedef struct {
+    uint16_t audio_buffer_ms; /*!< Audio queued in device (like I2S DMA) before write blocks */
+    uint16_t video_draw_ms;   /*!< Time to draw one frame, write blocks until drawn */
+    uint8_t  video_fb_num;    /*!< Frame buffers of panel (like RGB or DSI panel), 0 for panel without frame buffer */
+} sim_render_cfg_t;
+
+/**
+ * @brief  Use virtual clock, time only moves when advanced or slept
+ */
+void sim_clock_use_virtual(bool virtual_clock);
+
+/**
+ * @brief  Get current time in microseconds
+ */
+int64_t sim_clock_now(void);
+
+/**
+ * @brief  Advance virtual clock to given time, or sleep until it for real clock
+ */
+void sim_clock_wait_until(int64_t time_us);
+
+/**
+ * @brief  Allocate simulated audio render which plays at sample rate
+ */
+audio_render_handle_t sim_audio_render_alloc(sim_render_cfg_t *cfg);
+
+/**
+ * @brief  Allocate simulated RGB565 panel
+ *
+ * @note  When `video_fb_num` is set, panel lends its frame buffers
+ *        Frame written from other memory is copied into frame buffer like panel driver does
+ */
+video_render_handle_t sim_video_render_alloc(sim_render_cfg_t *cfg);
+
+/**
+ * @brief  Trace frame written to simulated device, implemented by user of host library
+ *
+ * @param[in]  kind  'A' audio written, 'V' video written, other kinds are free for user
+ */
+void sim_trace(char kind, uint32_t pts, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,253 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Audio resample per call latency, peak memory and converter chain rebuild
+ *
+ * 48 kHz stereo goes to 16 kHz mono in frames of 1024, 2048 and 4096 samples, whole frame against 512 sample blocks
+ * Output of both modes must be identical and block mode must not realloc work buffers while writing
+ * Format switch compares close and open, uncached `audio_resample_set_info` and cached one
+ * esp_ae is replaced by stand-in converters from host/sim_ae.c, so numbers only compare modes on the same host
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <math.h>
+#include <time.h>
+#include "media_lib_adapter.h"
+#include "audio_resample.h"
+#include "host_test.h"
+
+#define FRAME_NUM    (400)
+#define MAX_FRAME    (4096)
+#define BLOCK        (512)
+#define SWITCH_NUM   (200)
+
+typedef struct {
+    uint64_t write_ns[FRAME_NUM];
+    uint64_t first_ns[FRAME_NUM];
+    size_t   peak_mem;
+    int      realloc_num;
+    uint8_t *out;
+    size_t   out_size;
+} run_result_t;
+
+static bool     mem_track;
+static size_t   cur_mem;
+static size_t   peak_mem;
+static int      realloc_num;
+static uint64_t write_start;
+static uint64_t first_out;
+static int      out_count;
+static run_result_t *cur_run;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static void mem_add(void *ptr, size_t old_size)
+{
+    if (mem_track && ptr) {
+        cur_mem += malloc_usable_size(ptr) - old_size;
+        peak_mem = cur_mem > peak_mem ? cur_mem : peak_mem;
+    }
+}
+
+void *__wrap_malloc(size_t size)
+{
+    void *ptr = __real_malloc(size);
+    mem_add(ptr, 0);
+    return ptr;
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    void *ptr = __real_calloc(n, size);
+    mem_add(ptr, 0);
+    return ptr;
+}
+
+void *__wrap_realloc(void *old, size_t size)
+{
+    size_t old_size = (mem_track && old) ? malloc_usable_size(old) : 0;
+    void *ptr = __real_realloc(old, size);
+    if (mem_track) {
+        realloc_num++;
+    }
+    mem_add(ptr, old_size);
+    return ptr;
+}
+
+void __wrap_free(void *ptr)
+{
+    if (mem_track && ptr) {
+        cur_mem -= malloc_usable_size(ptr);
+    }
+    __real_free(ptr);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int resample_out(av_render_audio_frame_t *frame, void *ctx)
+{
+    if (out_count++ == 0) {
+        first_out = now_ns() - write_start;
+    }
+    if (cur_run) {
+        memcpy(cur_run->out + cur_run->out_size, frame->data, frame->size);
+        cur_run->out_size += frame->size;
+    }
+    return 0;
+}
+
+static int frame_samples(int i)
+{
+    // Mix of AAC-LC, HE-AAC and oversize burst frames
+    return (i % 10 == 9) ? 4096 : (i % 3) ? 1024 : 2048;
+}
+
+static void run_stream(int16_t *pcm, uint16_t block_samples, run_result_t *res)
+{
+    audio_resample_cfg_t cfg = {
+        .input_info = { .channel = 2, .bits_per_sample = 16, .sample_rate = 48000 },
+        .output_info = { .channel = 1, .bits_per_sample = 16, .sample_rate = 16000 },
+        .resample_cb = resample_out,
+        .block_samples = block_samples,
+        .cache_num = 2,
+    };
+    cur_run = res;
+    cur_mem = peak_mem = 0;
+    mem_track = true;
+    audio_resample_handle_t h = audio_resample_open(&cfg);
+    TEST_CHECK(h, "open resample");
+    realloc_num = 0;
+    size_t offset = 0;
+    for (int i = 0; h && i < FRAME_NUM; i++) {
+        int samples = frame_samples(i);
+        av_render_audio_frame_t frame = {
+            .pts = i * 20,
+            .data = (uint8_t *)(pcm + offset),
+            .size = samples * 4,
+        };
+        out_count = 0;
+        write_start = now_ns();
+        audio_resample_write(h, &frame);
+        res->write_ns[i] = now_ns() - write_start;
+        res->first_ns[i] = first_out;
+        offset += samples * 2;
+    }
+    res->realloc_num = realloc_num;
+    res->peak_mem = peak_mem;
+    audio_resample_close(h);
+    mem_track = false;
+    cur_run = NULL;
+    qsort(res->write_ns, FRAME_NUM, sizeof(uint64_t), cmp_u64);
+    qsort(res->first_ns, FRAME_NUM, sizeof(uint64_t), cmp_u64);
+    printf("%-12s write p50 %6.1f us max %6.1f us | first output p50 %6.1f us max %6.1f us | "
+           "peak %zu B, %d reallocs in write\n", block_samples ? "block 512" : "whole frame",
+           res->write_ns[FRAME_NUM / 2] / 1e3, res->write_ns[FRAME_NUM - 1] / 1e3,
+           res->first_ns[FRAME_NUM / 2] / 1e3, res->first_ns[FRAME_NUM - 1] / 1e3, res->peak_mem, res->realloc_num);
+}
+
+static double switch_cost(bool reopen, uint8_t cache_num)
+{
+    av_render_audio_frame_info_t in[2] = {
+        { .channel = 2, .bits_per_sample = 16, .sample_rate = 48000 },
+        { .channel = 2, .bits_per_sample = 16, .sample_rate = 44100 },
+    };
+    audio_resample_cfg_t cfg = {
+        .input_info = in[0],
+        .output_info = { .channel = 1, .bits_per_sample = 16, .sample_rate = 16000 },
+        .resample_cb = resample_out,
+        .block_samples = BLOCK,
+        .cache_num = cache_num,
+    };
+    audio_resample_handle_t h = audio_resample_open(&cfg);
+    uint64_t start = now_ns();
+    for (int i = 1; i <= SWITCH_NUM; i++) {
+        if (reopen) {
+            audio_resample_close(h);
+            cfg.input_info = in[i & 1];
+            h = audio_resample_open(&cfg);
+        } else {
+            audio_resample_set_info(h, &in[i & 1], &cfg.output_info);
+        }
+    }
+    double us = (now_ns() - start) / 1e3 / SWITCH_NUM;
+    // Switched chain still works
+    int16_t pcm[BLOCK * 2] = { 0 };
+    av_render_audio_frame_t frame = { .data = (uint8_t *)pcm, .size = sizeof(pcm) };
+    out_count = 0;
+    TEST_CHECK(audio_resample_write(h, &frame) == 0 && out_count == 1, "write after switch");
+    audio_resample_close(h);
+    return us;
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    size_t total = 0;
+    for (int i = 0; i < FRAME_NUM; i++) {
+        total += frame_samples(i);
+    }
+    int16_t *pcm = (int16_t *)malloc(total * 4);
+    unsigned seed = 1;
+    for (size_t i = 0; i < total * 2; i++) {
+        pcm[i] = (int16_t)(8000 * sin(i * 0.01) + (rand_r(&seed) % 200));
+    }
+    static run_result_t res[2];
+    for (int i = 0; i < 2; i++) {
+        res[i].out = (uint8_t *)malloc(total * 2);
+    }
+    run_stream(pcm, 0, &res[0]);
+    run_stream(pcm, BLOCK, &res[1]);
+    TEST_CHECK(res[0].out_size == res[1].out_size && memcmp(res[0].out, res[1].out, res[0].out_size) == 0,
+               "block output differs from whole frame output (%zu vs %zu bytes)", res[1].out_size, res[0].out_size);
+    TEST_CHECK(res[1].realloc_num == 0, "block mode realloc %d times in write", res[1].realloc_num);
+    TEST_CHECK(res[1].peak_mem < res[0].peak_mem, "block mode peak %zu B not lower", res[1].peak_mem);
+
+    double reopen_us = switch_cost(true, 0);
+    double uncached_us = switch_cost(false, 0);
+    double cached_us = switch_cost(false, 2);
+    printf("switch 48k/44.1k: close+open %.1f us, set_info uncached %.1f us, set_info cached %.2f us\n",
+           reopen_us, uncached_us, cached_us);
+    TEST_CHECK(cached_us < reopen_us, "cached switch not faster than reopen");
+    for (int i = 0; i < 2; i++) {
+        free(res[i].out);
+    }
+    free(pcm);
+    return TEST_RESULT();
+}
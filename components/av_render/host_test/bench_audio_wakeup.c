@@ -0,0 +1,195 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Benchmark audio render thread wake ups and start latency while buffering to threshold
+ *
+ * 20ms G711 frames arrive with exponential jitter and 1% stalls of 150ms, decoded frames are queued in render fifo
+ * with 100ms threshold, audio render thread waits on queue arrival until threshold reached or after underrun
+ * Report wake ups of audio render thread per second (overall and while buffering) and latency from
+ * arrival of frame which reach threshold to first write into device
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "data_queue.h"
+#include "av_render.h"
+#include "sim_render.h"
+#include "host_test.h"
+
+#define SAMPLE_RATE     (8000)
+#define FRAME_MS        (20)
+#define FRAME_BYTES     (SAMPLE_RATE * FRAME_MS / 1000)
+#define THRESHOLD_MS    (100)
+#define RUN_SECONDS     (6)
+#define STALL_MS        (150)
+#define MAX_START       (256)
+// Previous render slept 10ms per check while buffering
+#define POLL_WAKEUP_NUM (100)
+
+static bool    counting;
+static int     read_num;
+static int     wait_num;
+static int64_t wait_us;
+static bool    waited;
+static int64_t last_add;
+static int64_t start_latency[MAX_START];
+static int     start_num;
+static int     write_num;
+
+int __real_data_queue_read_lock(data_queue_t *q, void **buffer, int *size);
+int __real_data_queue_wait_arrive(data_queue_t *q, int q_num, uint32_t timeout);
+int __real_audio_render_write(audio_render_handle_t render, av_render_audio_frame_t *audio_data);
+
+static bool is_audio_render_thread(void)
+{
+    char name[16] = { 0 };
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    return strcmp(name, "ARender") == 0;
+}
+
+// Linked with --wrap so that loop of audio render thread is counted
+int __wrap_data_queue_read_lock(data_queue_t *q, void **buffer, int *size)
+{
+    int ret = __real_data_queue_read_lock(q, buffer, size);
+    if (__atomic_load_n(&counting, __ATOMIC_ACQUIRE) && is_audio_render_thread()) {
+        __atomic_add_fetch(&read_num, 1, __ATOMIC_RELAXED);
+    }
+    return ret;
+}
+
+int __wrap_data_queue_wait_arrive(data_queue_t *q, int q_num, uint32_t timeout)
+{
+    if (is_audio_render_thread() == false) {
+        return __real_data_queue_wait_arrive(q, q_num, timeout);
+    }
+    int64_t start = sim_clock_now();
+    int ret = __real_data_queue_wait_arrive(q, q_num, timeout);
+    if (__atomic_load_n(&counting, __ATOMIC_ACQUIRE)) {
+        __atomic_add_fetch(&wait_num, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&wait_us, sim_clock_now() - start, __ATOMIC_RELAXED);
+        __atomic_store_n(&waited, true, __ATOMIC_RELEASE);
+    }
+    return ret;
+}
+
+// Measure before device write blocks, latency of device buffer is not part of wake up
+int __wrap_audio_render_write(audio_render_handle_t render, av_render_audio_frame_t *audio_data)
+{
+    write_num++;
+    // First write after buffering, measure from arrival which let it start
+    if (__atomic_exchange_n(&waited, false, __ATOMIC_ACQ_REL) && start_num < MAX_START) {
+        int64_t latency = sim_clock_now() - __atomic_load_n(&last_add, __ATOMIC_ACQUIRE);
+        start_latency[start_num++] = latency > 0 ? latency : 0;
+    }
+    return __real_audio_render_write(render, audio_data);
+}
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+}
+
+static void run(double jitter_ms, unsigned seed)
+{
+    unsigned run_seed = seed;
+    sim_render_cfg_t render_cfg = { .audio_buffer_ms = 20 };
+    audio_render_handle_t audio_render = sim_audio_render_alloc(&render_cfg);
+    av_render_cfg_t cfg = {
+        .audio_render = audio_render,
+        .audio_render_fifo_size = 16 * 1024,
+        .sync_mode = AV_RENDER_SYNC_NONE,
+    };
+    av_render_handle_t render = av_render_open(&cfg);
+    av_render_audio_info_t audio_info = {
+        .codec = AV_RENDER_AUDIO_CODEC_G711A,
+        .sample_rate = SAMPLE_RATE,
+        .channel = 1,
+    };
+    av_render_add_audio_stream(render, &audio_info);
+    av_render_set_audio_threshold(render, THRESHOLD_MS * SAMPLE_RATE / 1000 * 2);
+    read_num = wait_num = start_num = write_num = 0;
+    wait_us = 0;
+    waited = false;
+    __atomic_store_n(&counting, true, __ATOMIC_RELEASE);
+
+    static uint8_t frame[FRAME_BYTES];
+    int frame_num = RUN_SECONDS * 1000 / FRAME_MS;
+    int64_t begin = sim_clock_now();
+    double last = 0, stall_end = -1;
+    for (int i = 0; i < frame_num; i++) {
+        double send = i * FRAME_MS;
+        double delay = -jitter_ms * log(1 - rand_r(&seed) / (RAND_MAX + 1.0));
+        if (jitter_ms && rand_r(&seed) % 100 == 0) {
+            stall_end = send + STALL_MS;
+        }
+        double arrive = (send < stall_end ? stall_end : send) + delay;
+        if (arrive < last) {
+            arrive = last;
+        }
+        last = arrive;
+        sim_clock_wait_until(begin + (int64_t)(arrive * 1000));
+        av_render_audio_data_t data = {
+            .pts = i * FRAME_MS,
+            .data = frame,
+            .size = FRAME_BYTES,
+        };
+        __atomic_store_n(&last_add, sim_clock_now(), __ATOMIC_RELEASE);
+        av_render_add_audio_data(render, &data);
+    }
+    media_lib_thread_sleep(THRESHOLD_MS * 3);
+    __atomic_store_n(&counting, false, __ATOMIC_RELEASE);
+    double elapse = (sim_clock_now() - begin) / 1e6;
+    av_render_close(render);
+    audio_render_free_handle(audio_render);
+
+    int64_t sum = 0, max = 0;
+    for (int i = 0; i < start_num; i++) {
+        sum += start_latency[i];
+        max = start_latency[i] > max ? start_latency[i] : max;
+    }
+    double mean_ms = start_num ? sum / 1000.0 / start_num : 0;
+    double buffering_wakeup = wait_us ? wait_num / (wait_us / 1e6) : 0;
+    printf("%6.0f %5u %10.1f %10.0f %12.1f %7d %9.2f %9.2f %8d\n", jitter_ms, run_seed, read_num / elapse,
+           wait_us / 1000.0, buffering_wakeup, start_num, mean_ms, max / 1000.0, write_num);
+    // Tail under threshold stays queued as no EOS is sent, it can rebuffer after a late stall
+    TEST_CHECK(write_num >= frame_num - THRESHOLD_MS / FRAME_MS, "rendered %d of %d frames", write_num, frame_num);
+    TEST_CHECK(start_num > 0, "never buffered");
+    TEST_CHECK(buffering_wakeup < POLL_WAKEUP_NUM, "%.1f wake ups per second while buffering", buffering_wakeup);
+    TEST_CHECK(mean_ms < 2.0, "start latency %.2f ms", mean_ms);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    printf("%6s %5s %10s %10s %12s %7s %9s %9s %8s\n", "Jitter", "Seed", "Wakeup/s", "Buffer(ms)", "BufWakeup/s",
+           "Starts", "Start(ms)", "Max(ms)", "Frames");
+    static const double jitters[] = { 0, 15, 40 };
+    for (int j = 0; j < sizeof(jitters) / sizeof(jitters[0]); j++) {
+        run(jitters[j], 1 + j);
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,105 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Color convert throughput in Mpixel/s
+ *
+ * Converts YUV420 to RGB565 at 320x240, 640x480 and 1280x720 with one thread and with row band workers
+ * Result depends on host, so it is only printed
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "media_lib_adapter.h"
+#include "color_convert.h"
+#include "host_test.h"
+
+#define BENCH_PIXELS (200 * 1000 * 1000)
+
+typedef struct {
+    int width;
+    int height;
+} bench_size_t;
+
+static const bench_size_t bench_sizes[] = {
+    { 320, 240 },
+    { 640, 480 },
+    { 1280, 720 },
+};
+
+static const uint8_t bench_workers[] = { 1, 2, 4 };
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_one(int width, int height, uint8_t worker_num)
+{
+    color_convert_cfg_t cfg = {
+        .from = AV_RENDER_VIDEO_RAW_TYPE_YUV420,
+        .to = AV_RENDER_VIDEO_RAW_TYPE_RGB565,
+        .width = width,
+        .height = height,
+        .worker_num = worker_num,
+    };
+    int src_size = convert_table_get_image_size(cfg.from, width, height);
+    int dst_size = convert_table_get_image_size(cfg.to, width, height);
+    uint8_t *src = (uint8_t *)malloc(src_size);
+    uint8_t *dst = (uint8_t *)malloc(dst_size);
+    unsigned seed = 1;
+    for (int i = 0; i < src_size; i++) {
+        src[i] = (uint8_t)rand_r(&seed);
+    }
+    color_convert_table_t table = init_convert_table(&cfg);
+    TEST_CHECK(table, "init convert %dx%d", width, height);
+    if (table) {
+        int frames = BENCH_PIXELS / (width * height);
+        // Warm up caches and wake workers once
+        convert_color(table, src, src_size, dst, dst_size);
+        uint64_t start = now_ns();
+        for (int i = 0; i < frames; i++) {
+            convert_color(table, src, src_size, dst, dst_size);
+        }
+        double sec = (now_ns() - start) / 1e9;
+        printf("%4dx%-4d workers %d: %7.1f Mpixel/s %6.3f ms/frame\n", width, height, worker_num,
+               (double)frames * width * height / sec / 1e6, sec * 1000 / frames);
+        deinit_convert_table(table);
+    }
+    free(src);
+    free(dst);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    for (int s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++) {
+        for (int w = 0; w < sizeof(bench_workers); w++) {
+            bench_one(bench_sizes[s].width, bench_sizes[s].height, bench_workers[w]);
+        }
+    }
+    return TEST_RESULT();
+}
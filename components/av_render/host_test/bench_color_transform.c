@@ -0,0 +1,276 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Fused scale and rotate in color convert against convert then scale
+ *
+ * 1280x720 YUV420 goes to 320x240 RGB565 (240x320 when rotated), either converted at full size and then scaled
+ * from the RGB565 copy, or sampled directly by color convert in one pass
+ * Prints ms per frame and bytes touched: 64 byte cache lines read plus bytes written, counted on the sample positions
+ * Result depends on host, so it is only printed
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "media_lib_adapter.h"
+#include "color_convert.h"
+#include "host_test.h"
+
+#define SRC_WIDTH    (1280)
+#define SRC_HEIGHT   (720)
+#define BENCH_FRAMES (100)
+#define CACHE_LINE   (64)
+
+typedef struct {
+    const char                 *name;
+    av_render_video_transform_t transform;
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+    { "nearest", { .width = 320, .height = 240, .scale = AV_RENDER_VIDEO_SCALE_NEAREST } },
+    { "bilinear", { .width = 320, .height = 240, .scale = AV_RENDER_VIDEO_SCALE_BILINEAR } },
+    { "rot90 nearest", { .width = 240, .height = 320, .rotate = AV_RENDER_VIDEO_ROTATE_90 } },
+    { "rot90 bilinear", { .width = 240, .height = 320, .rotate = AV_RENDER_VIDEO_ROTATE_90,
+                          .scale = AV_RENDER_VIDEO_SCALE_BILINEAR } },
+};
+
+/* Cache lines touched inside one buffer */
+typedef struct {
+    uint8_t *line;
+    int      line_num;
+} touch_map_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void touch_init(touch_map_t *map, int size)
+{
+    map->line_num = (size + CACHE_LINE - 1) / CACHE_LINE;
+    map->line = (uint8_t *)calloc(map->line_num, 1);
+}
+
+static void touch(touch_map_t *map, int offset)
+{
+    map->line[offset / CACHE_LINE] = 1;
+}
+
+static int touch_bytes(touch_map_t *map)
+{
+    int n = 0;
+    for (int i = 0; i < map->line_num; i++) {
+        n += map->line[i];
+    }
+    free(map->line);
+    return n * CACHE_LINE;
+}
+
+/* Source position in Q16 with pixel centers aligned, same as color convert */
+static int32_t sample_pos(int k, int out_len, int src_len, bool bilinear)
+{
+    if (bilinear == false) {
+        return (int32_t)((2 * k + 1) * (int64_t)src_len / (2 * out_len)) << 16;
+    }
+    int64_t pos = ((int64_t)(2 * k + 1) * src_len << 16) / (2 * out_len) - (1 << 15);
+    int64_t max_pos = (int64_t)(src_len - 1) << 16;
+    return (int32_t)(pos < 0 ? 0 : pos > max_pos ? max_pos : pos);
+}
+
+/* Map output pixel to source coordinate in Q16, only no rotation and 90 degree are used here */
+static void sample_xy(const av_render_video_transform_t *t, int ox, int oy, int32_t *x, int32_t *y)
+{
+    bool bilinear = (t->scale == AV_RENDER_VIDEO_SCALE_BILINEAR);
+    if (t->rotate == AV_RENDER_VIDEO_ROTATE_90) {
+        *x = sample_pos(oy, t->height, SRC_WIDTH, bilinear);
+        *y = sample_pos(t->width - 1 - ox, t->width, SRC_HEIGHT, bilinear);
+    } else {
+        *x = sample_pos(ox, t->width, SRC_WIDTH, bilinear);
+        *y = sample_pos(oy, t->height, SRC_HEIGHT, bilinear);
+    }
+}
+
+static inline int lerp(int a, int b, int f)
+{
+    return (a * (256 - f) + b * f + 128) >> 8;
+}
+
+/* Scale and rotate RGB565 image from full size convert output */
+static void scale_rgb565(const av_render_video_transform_t *t, const uint16_t *src, uint16_t *dst)
+{
+    bool bilinear = (t->scale == AV_RENDER_VIDEO_SCALE_BILINEAR);
+    for (int oy = 0; oy < t->height; oy++) {
+        for (int ox = 0; ox < t->width; ox++) {
+            int32_t x, y;
+            sample_xy(t, ox, oy, &x, &y);
+            int xi = x >> 16, yi = y >> 16;
+            const uint16_t *p = src + yi * SRC_WIDTH + xi;
+            if (bilinear == false) {
+                *dst++ = p[0];
+                continue;
+            }
+            int fx = (x >> 8) & 0xFF, fy = (y >> 8) & 0xFF;
+            int dx = xi < SRC_WIDTH - 1 ? 1 : 0;
+            int dy = yi < SRC_HEIGHT - 1 ? SRC_WIDTH : 0;
+            uint16_t q[4] = { p[0], p[dx], p[dy], p[dy + dx] };
+            int r = lerp(lerp(q[0] >> 11, q[1] >> 11, fx), lerp(q[2] >> 11, q[3] >> 11, fx), fy);
+            int g = lerp(lerp((q[0] >> 5) & 0x3F, (q[1] >> 5) & 0x3F, fx),
+                         lerp((q[2] >> 5) & 0x3F, (q[3] >> 5) & 0x3F, fx), fy);
+            int b = lerp(lerp(q[0] & 0x1F, q[1] & 0x1F, fx), lerp(q[2] & 0x1F, q[3] & 0x1F, fx), fy);
+            *dst++ = (uint16_t)((r << 11) | (g << 5) | b);
+        }
+    }
+}
+
+/* Bytes touched when converting whole frame then scaling RGB565 copy */
+static int count_convert_then_scale(const av_render_video_transform_t *t, int src_size)
+{
+    bool bilinear = (t->scale == AV_RENDER_VIDEO_SCALE_BILINEAR);
+    int full_size = SRC_WIDTH * SRC_HEIGHT * 2;
+    touch_map_t rgb;
+    touch_init(&rgb, full_size);
+    for (int oy = 0; oy < t->height; oy++) {
+        for (int ox = 0; ox < t->width; ox++) {
+            int32_t x, y;
+            sample_xy(t, ox, oy, &x, &y);
+            int pos = ((y >> 16) * SRC_WIDTH + (x >> 16)) * 2;
+            touch(&rgb, pos);
+            if (bilinear) {
+                touch(&rgb, pos + 2);
+                touch(&rgb, pos + SRC_WIDTH * 2 < full_size ? pos + SRC_WIDTH * 2 : pos);
+            }
+        }
+    }
+    return src_size + full_size + touch_bytes(&rgb) + t->width * t->height * 2;
+}
+
+/* Bytes touched when color convert samples source directly */
+static int count_fused(const av_render_video_transform_t *t, int src_size)
+{
+    bool bilinear = (t->scale == AV_RENDER_VIDEO_SCALE_BILINEAR);
+    int cw = SRC_WIDTH / 2;
+    int u_off = SRC_WIDTH * SRC_HEIGHT;
+    int v_off = u_off + cw * SRC_HEIGHT / 2;
+    touch_map_t src;
+    touch_init(&src, src_size);
+    for (int oy = 0; oy < t->height; oy++) {
+        for (int ox = 0; ox < t->width; ox++) {
+            int32_t x, y;
+            sample_xy(t, ox, oy, &x, &y);
+            int xi = x >> 16, yi = y >> 16;
+            int cx = xi >> 1, cy = yi >> 1;
+            int taps = bilinear ? 2 : 1;
+            for (int j = 0; j < taps; j++) {
+                int ly = yi + j < SRC_HEIGHT ? yi + j : yi;
+                int ccy = cy + j < SRC_HEIGHT / 2 ? cy + j : cy;
+                touch(&src, ly * SRC_WIDTH + xi);
+                touch(&src, u_off + ccy * cw + cx);
+                touch(&src, v_off + ccy * cw + cx);
+                if (bilinear) {
+                    touch(&src, ly * SRC_WIDTH + xi + 1);
+                }
+            }
+        }
+    }
+    return touch_bytes(&src) + t->width * t->height * 2;
+}
+
+static double run_convert_then_scale(const av_render_video_transform_t *t, uint8_t *src, int src_size, uint16_t *dst)
+{
+    color_convert_cfg_t cfg = {
+        .from = AV_RENDER_VIDEO_RAW_TYPE_YUV420,
+        .to = AV_RENDER_VIDEO_RAW_TYPE_RGB565,
+        .width = SRC_WIDTH,
+        .height = SRC_HEIGHT,
+    };
+    int full_size = SRC_WIDTH * SRC_HEIGHT * 2;
+    uint16_t *full = (uint16_t *)malloc(full_size);
+    color_convert_table_t table = init_convert_table(&cfg);
+    TEST_CHECK(table, "init full size convert");
+    if (table == NULL) {
+        free(full);
+        return 0;
+    }
+    uint64_t start = now_ns();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        convert_color(table, src, src_size, (uint8_t *)full, full_size);
+        scale_rgb565(t, full, dst);
+    }
+    double ms = (now_ns() - start) / 1e6 / BENCH_FRAMES;
+    deinit_convert_table(table);
+    free(full);
+    return ms;
+}
+
+static double run_fused(const av_render_video_transform_t *t, uint8_t *src, int src_size, uint16_t *dst)
+{
+    color_convert_cfg_t cfg = {
+        .from = AV_RENDER_VIDEO_RAW_TYPE_YUV420,
+        .to = AV_RENDER_VIDEO_RAW_TYPE_RGB565,
+        .width = SRC_WIDTH,
+        .height = SRC_HEIGHT,
+        .transform = *t,
+    };
+    color_convert_table_t table = init_convert_table(&cfg);
+    TEST_CHECK(table, "init fused convert");
+    if (table == NULL) {
+        return 0;
+    }
+    int dst_size = t->width * t->height * 2;
+    uint64_t start = now_ns();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        convert_color(table, src, src_size, (uint8_t *)dst, dst_size);
+    }
+    double ms = (now_ns() - start) / 1e6 / BENCH_FRAMES;
+    deinit_convert_table(table);
+    return ms;
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    int src_size = convert_table_get_image_size(AV_RENDER_VIDEO_RAW_TYPE_YUV420, SRC_WIDTH, SRC_HEIGHT);
+    uint8_t *src = (uint8_t *)malloc(src_size);
+    uint16_t *dst = (uint16_t *)malloc(320 * 240 * 2);
+    unsigned seed = 1;
+    for (int i = 0; i < src_size; i++) {
+        src[i] = (uint8_t)rand_r(&seed);
+    }
+    printf("%dx%d YUV420 to RGB565, %d frames\n", SRC_WIDTH, SRC_HEIGHT, BENCH_FRAMES);
+    for (int i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+        const av_render_video_transform_t *t = &bench_cases[i].transform;
+        double split_ms = run_convert_then_scale(t, src, src_size, dst);
+        double fused_ms = run_fused(t, src, src_size, dst);
+        printf("%-15s %dx%d: convert+scale %6.2f ms %5.2f MB | fused %6.2f ms %5.2f MB\n", bench_cases[i].name,
+               t->width, t->height, split_ms, count_convert_then_scale(t, src_size) / 1e6, fused_ms,
+               count_fused(t, src_size) / 1e6);
+        TEST_CHECK(fused_ms < split_ms, "%s: fused convert not faster", bench_cases[i].name);
+    }
+    free(src);
+    free(dst);
+    return TEST_RESULT();
+}
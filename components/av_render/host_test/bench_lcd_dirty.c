@@ -0,0 +1,183 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Bytes sent to panel without frame buffer, full draw against `dirty_update`
+ *
+ * Clips are 150 frames of synthetic 320x240 RGB565:
+ *   static      same frame repeated
+ *   low-motion  visitor walking across still background with changing timestamp, render is reopened midway
+ *   high-motion camera pan, every line changes
+ * Simulated panel keeps drawn pixels, they must equal source frame after each frame is drawn
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "av_render_default.h"
+#include "sim_render.h"
+#include "sim_device.h"
+#include "host_test.h"
+
+#define WIDTH     (320)
+#define HEIGHT    (240)
+#define FRAME_NUM (150)
+
+typedef enum {
+    CLIP_STATIC,
+    CLIP_LOW_MOTION,
+    CLIP_HIGH_MOTION,
+    CLIP_MAX,
+} clip_t;
+
+typedef enum {
+    DRAW_FULL,
+    DRAW_DIRTY,
+    DRAW_DIRTY_ASYNC,
+    DRAW_MAX,
+} draw_mode_t;
+
+static const char *clip_name[CLIP_MAX] = { "static", "low-motion", "high-motion" };
+static const char *mode_name[DRAW_MAX] = { "full", "dirty", "dirty+async" };
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+}
+
+static void put_pixel(uint8_t *frame, int x, int y, uint16_t color)
+{
+    frame[(y * WIDTH + x) * 2] = color >> 8;
+    frame[(y * WIDTH + x) * 2 + 1] = color & 0xFF;
+}
+
+static void fill_rect(uint8_t *frame, int x, int y, int w, int h, uint16_t color)
+{
+    for (int j = y; j < y + h && j < HEIGHT; j++) {
+        for (int i = x; i < x + w && i < WIDTH; i++) {
+            put_pixel(frame, i, j, color);
+        }
+    }
+}
+
+static void make_frame(uint8_t *frame, clip_t clip, int n)
+{
+    int pan = (clip == CLIP_HIGH_MOTION) ? n * 3 : 0;
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            int u = x + pan;
+            put_pixel(frame, x, y, (uint16_t)(((u * 7 + y * 13) ^ (u >> 3)) * 0x0841));
+        }
+    }
+    if (clip == CLIP_LOW_MOTION) {
+        // Timestamp digits in top left corner
+        for (int d = 0; d < 4; d++) {
+            fill_rect(frame, 8 + d * 12, 4, 10, 14, (uint16_t)((n >> d) * 0x1111 + d));
+        }
+        // Visitor walking from left to right
+        fill_rect(frame, 20 + n * 2, 120, 24, 64, 0xF800);
+    }
+}
+
+static void wait_drawn(video_render_handle_t render, uint32_t present_num)
+{
+    video_render_stats_t stats = {};
+    for (int i = 0; i < 1000; i++) {
+        video_render_get_stats(render, &stats);
+        if (stats.present_num >= present_num) {
+            return;
+        }
+        media_lib_thread_sleep(1);
+    }
+}
+
+static double run_clip(clip_t clip, draw_mode_t mode, double *draw_per_frame)
+{
+    lcd_render_cfg_t cfg = {
+        .lcd_handle = (esp_lcd_panel_handle_t)1,
+        .dirty_update = (mode != DRAW_FULL),
+        .async_draw = (mode == DRAW_DIRTY_ASYNC),
+    };
+    av_render_video_frame_info_t info = {
+        .type = AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE,
+        .width = WIDTH,
+        .height = HEIGHT,
+    };
+    static uint8_t frame[WIDTH * HEIGHT * 2];
+    av_render_video_frame_t video = { .data = frame, .size = sizeof(frame) };
+    video_render_handle_t render = av_render_alloc_lcd_render(&cfg);
+    sim_device_panel_init(WIDTH, HEIGHT);
+    video_render_open(render, &info);
+    int mismatch = 0;
+    uint32_t present_num = 0;
+    for (int n = 0; n < FRAME_NUM; n++) {
+        if (clip == CLIP_LOW_MOTION && n == FRAME_NUM / 2) {
+            // Close clears panel, next frame must be drawn in full
+            video_render_close(render);
+            video_render_open(render, &info);
+        }
+        make_frame(frame, clip, n);
+        video_render_write(render, &video);
+        wait_drawn(render, ++present_num);
+        mismatch += memcmp(sim_device_panel_data(), frame, sizeof(frame)) != 0;
+    }
+    uint64_t bytes = 0;
+    uint32_t draw_num = 0;
+    sim_device_panel_stats(&bytes, &draw_num);
+    video_render_close(render);
+    video_render_free_handle(render);
+    sim_device_panel_deinit();
+    TEST_CHECK(mismatch == 0, "%s %s: %d frames differ on panel", clip_name[clip], mode_name[mode], mismatch);
+    // Clear draws black lines, exclude them from frame cost
+    if (clip == CLIP_LOW_MOTION) {
+        bytes -= WIDTH * HEIGHT * 2;
+        draw_num -= HEIGHT;
+    }
+    *draw_per_frame = (double)draw_num / FRAME_NUM;
+    return bytes / 1024.0 / FRAME_NUM;
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    double kb[CLIP_MAX][DRAW_MAX];
+    double draws[CLIP_MAX][DRAW_MAX];
+    printf("%-12s %-12s %10s %12s\n", "clip", "mode", "KB/frame", "draws/frame");
+    for (int c = 0; c < CLIP_MAX; c++) {
+        for (int m = 0; m < DRAW_MAX; m++) {
+            kb[c][m] = run_clip((clip_t)c, (draw_mode_t)m, &draws[c][m]);
+            printf("%-12s %-12s %10.1f %12.1f\n", clip_name[c], mode_name[m], kb[c][m], draws[c][m]);
+        }
+    }
+    for (int m = DRAW_DIRTY; m < DRAW_MAX; m++) {
+        // Only first frame is sent
+        TEST_CHECK(kb[CLIP_STATIC][m] * FRAME_NUM <= kb[CLIP_STATIC][DRAW_FULL] + 1, "static %.1f KB/frame",
+                   kb[CLIP_STATIC][m]);
+        TEST_CHECK(kb[CLIP_LOW_MOTION][m] < kb[CLIP_LOW_MOTION][DRAW_FULL] / 2, "low-motion %.1f KB/frame",
+                   kb[CLIP_LOW_MOTION][m]);
+        // Falls back to full draw, not more costly
+        TEST_CHECK(kb[CLIP_HIGH_MOTION][m] <= kb[CLIP_HIGH_MOTION][DRAW_FULL], "high-motion %.1f KB/frame",
+                   kb[CLIP_HIGH_MOTION][m]);
+    }
+    return TEST_RESULT();
+}
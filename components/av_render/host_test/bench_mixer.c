@@ -0,0 +1,226 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* CPU cost of audio mixer per 10 ms block
+ *
+ * Sources are fed as fast as mixer takes them into output which never blocks, process CPU time is divided by
+ * 10 ms blocks written to output. Cost covers copy into source buffer, mixing, saturation and thread wakeups
+ * Single source of unity gain is written to output directly so its cost is only the pass through
+ *
+ * Usage: ./bench_mixer [run_ms]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "av_render_mixer.h"
+#include "sim_render.h"
+#include "host_test.h"
+
+#define BLOCK_MS       (10)
+#define MAX_SOURCE     (4)
+#define WARM_MS        (200)
+#define DEFAULT_RUN_MS (1000)
+
+typedef struct {
+    audio_render_handle_t render;
+    int16_t              *buf;
+    uint32_t              size;
+    pthread_t             thread;
+} bench_source_t;
+
+typedef enum {
+    BENCH_UNITY,  /* All sources at unity gain */
+    BENCH_GAIN,   /* All sources at gain 0.5 */
+    BENCH_DUCKED, /* First source of higher priority ducks the others */
+} bench_mode_t;
+
+static volatile uint64_t out_bytes;
+static volatile bool     stopping;
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+    // Simulated devices are not used
+}
+
+static audio_render_handle_t out_init(void *cfg, int size)
+{
+    return (audio_render_handle_t)&out_bytes;
+}
+
+static int out_open(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    return 0;
+}
+
+static int out_write(audio_render_handle_t h, av_render_audio_frame_t *frame)
+{
+    out_bytes += frame->size;
+    return 0;
+}
+
+static int out_get_latency(audio_render_handle_t h, uint32_t *latency)
+{
+    // Report enough queued so that mixer waits for all sources
+    *latency = 1000;
+    return 0;
+}
+
+static int out_get_frame_info(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    return 0;
+}
+
+static int out_set_speed(audio_render_handle_t h, float speed)
+{
+    return 0;
+}
+
+static int out_close(audio_render_handle_t h)
+{
+    return 0;
+}
+
+static void out_deinit(audio_render_handle_t h)
+{
+}
+
+static void *feed_thread(void *arg)
+{
+    bench_source_t *s = (bench_source_t *)arg;
+    while (stopping == false) {
+        av_render_audio_frame_t frame = { .data = (uint8_t *)s->buf, .size = s->size };
+        if (audio_render_write(s->render, &frame) != 0) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int64_t cpu_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static double bench(av_render_audio_frame_info_t *fmt, int source_num, bench_mode_t mode, int run_ms)
+{
+    audio_render_cfg_t out_cfg = {
+        .ops = {
+            .init = out_init,
+            .open = out_open,
+            .write = out_write,
+            .get_latency = out_get_latency,
+            .get_frame_info = out_get_frame_info,
+            .set_speed = out_set_speed,
+            .close = out_close,
+            .deinit = out_deinit,
+        },
+    };
+    audio_render_handle_t out = audio_render_alloc_handle(&out_cfg);
+    av_render_mixer_cfg_t cfg = { .out_render = out, .out_info = *fmt, .block_ms = BLOCK_MS };
+    av_render_mixer_handle_t mixer = av_render_mixer_create(&cfg);
+    if (mixer == NULL) {
+        audio_render_free_handle(out);
+        return -1;
+    }
+    uint32_t block_bytes = fmt->sample_rate * BLOCK_MS / 1000 * fmt->channel * sizeof(int16_t);
+    bench_source_t sources[MAX_SOURCE] = {};
+    stopping = false;
+    out_bytes = 0;
+    for (int i = 0; i < source_num; i++) {
+        bench_source_t *s = &sources[i];
+        av_render_mixer_source_cfg_t src_cfg = {
+            .gain = mode == BENCH_GAIN ? 0.5f : 1.0f,
+            .priority = (mode == BENCH_DUCKED && i == 0) ? 1 : 0,
+            .duck_gain = 0.25f,
+        };
+        s->render = av_render_mixer_alloc_source(mixer, &src_cfg);
+        s->size = block_bytes;
+        s->buf = (int16_t *)malloc(block_bytes);
+        for (uint32_t k = 0; k < block_bytes / sizeof(int16_t); k++) {
+            s->buf[k] = (int16_t)(k * 37 * (i + 1));
+        }
+        audio_render_open(s->render, fmt);
+    }
+    for (int i = 0; i < source_num; i++) {
+        pthread_create(&sources[i].thread, NULL, feed_thread, &sources[i]);
+    }
+    // Measure after ducking fade done
+    usleep(WARM_MS * 1000);
+    uint64_t bytes = out_bytes;
+    int64_t cpu = cpu_time_us();
+    usleep(run_ms * 1000);
+    cpu = cpu_time_us() - cpu;
+    bytes = out_bytes - bytes;
+    stopping = true;
+    for (int i = 0; i < source_num; i++) {
+        audio_render_close(sources[i].render);
+        pthread_join(sources[i].thread, NULL);
+        audio_render_free_handle(sources[i].render);
+        free(sources[i].buf);
+    }
+    av_render_mixer_destroy(mixer);
+    audio_render_free_handle(out);
+    uint64_t blocks = bytes / block_bytes;
+    return blocks ? (double)cpu / blocks : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    media_lib_add_default_adapter();
+    sim_clock_use_virtual(false);
+    int run_ms = argc > 1 ? atoi(argv[1]) : DEFAULT_RUN_MS;
+    if (run_ms <= 0) {
+        run_ms = DEFAULT_RUN_MS;
+    }
+    av_render_audio_frame_info_t formats[] = {
+        { .sample_rate = 16000, .channel = 1, .bits_per_sample = 16 },
+        { .sample_rate = 48000, .channel = 2, .bits_per_sample = 16 },
+    };
+    for (int f = 0; f < (int)(sizeof(formats) / sizeof(formats[0])); f++) {
+        av_render_audio_frame_info_t *fmt = &formats[f];
+        printf("%d Hz %d ch, CPU us per %d ms block:\n", (int)fmt->sample_rate, fmt->channel, BLOCK_MS);
+        for (int n = 1; n <= MAX_SOURCE; n *= 2) {
+            double unity = bench(fmt, n, BENCH_UNITY, run_ms);
+            double gain = bench(fmt, n, BENCH_GAIN, run_ms);
+            printf("  %d source%s: unity %7.2f  gain 0.5 %7.2f", n, n > 1 ? "s" : " ", unity, gain);
+            double ducked = 0;
+            // Need higher priority source to duck others
+            if (n > 1) {
+                ducked = bench(fmt, n, BENCH_DUCKED, run_ms);
+                printf("  ducked %7.2f", ducked);
+            }
+            printf("\n");
+            // Cost depends on host, only check that mixer kept output running
+            TEST_CHECK(unity >= 0 && gain >= 0 && ducked >= 0, "%d sources wrote no block", n);
+        }
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,218 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Benchmark per stage latency reported by `av_render_get_stream_stats` for G711, Opus, MJPEG and H264
+ *
+ * Stand-in codecs are linked with --wrap so that each decode costs busy time with jitter like real codec
+ * Streams are fed in real time through decode and render threads, report p50/p95/p99/max of each stage
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "av_render.h"
+#include "sim_render.h"
+#include "host_test.h"
+
+#define AUDIO_FRAME_MS  (20)
+#define AUDIO_FRAME_NUM (150)
+#define VIDEO_WIDTH     (640)
+#define VIDEO_HEIGHT    (480)
+#define VIDEO_FPS       (30)
+#define VIDEO_FRAME_NUM (90)
+#define VIDEO_GOP       (30)
+#define VIDEO_DATA_SIZE (16 * 1024)
+
+typedef struct {
+    const char *name;
+    bool        is_video;
+    int         codec;
+    uint32_t    cost_us;   /* Base decode cost */
+    uint32_t    jitter_us; /* Mean of exponential jitter added to cost */
+    bool        convert;   /* Expect resample or color convert stage */
+} stats_case_t;
+
+static stats_case_t *cur_case;
+static unsigned int  cost_seed = 1;
+
+int __real_adec_decode(void *h, av_render_audio_data_t *data);
+int __real_vdec_decode(void *h, av_render_video_data_t *data);
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+}
+
+static void spend_decode_time(uint32_t pts)
+{
+    if (cur_case == NULL) {
+        return;
+    }
+    double jitter = -(double)cur_case->jitter_us * log(1.0 - rand_r(&cost_seed) / (RAND_MAX + 1.0));
+    int64_t cost = cur_case->cost_us + (int64_t)jitter;
+    // Key frame costs much more than inter frame
+    if (cur_case->codec == AV_RENDER_VIDEO_CODEC_H264 && (pts / (1000 / VIDEO_FPS)) % VIDEO_GOP == 0) {
+        cost *= 3;
+    }
+    int64_t end = sim_clock_now() + cost;
+    while (sim_clock_now() < end) {
+    }
+}
+
+int __wrap_adec_decode(void *h, av_render_audio_data_t *data)
+{
+    if (data->size) {
+        spend_decode_time(data->pts);
+    }
+    return __real_adec_decode(h, data);
+}
+
+int __wrap_vdec_decode(void *h, av_render_video_data_t *data)
+{
+    if (data->size) {
+        spend_decode_time(data->pts);
+    }
+    return __real_vdec_decode(h, data);
+}
+
+static void feed_audio(av_render_handle_t render, stats_case_t *c)
+{
+    static uint8_t data_buffer[512];
+    av_render_audio_info_t audio_info = { .codec = c->codec, .channel = 1, .sample_rate = 8000, .bits_per_sample = 16 };
+    uint32_t size = 8000 * AUDIO_FRAME_MS / 1000;
+    if (c->codec == AV_RENDER_AUDIO_CODEC_OPUS) {
+        // 48kHz stereo resampled to 16kHz mono device
+        audio_info.channel = 2;
+        audio_info.sample_rate = 48000;
+        av_render_audio_frame_info_t out_info = { .sample_rate = 16000, .channel = 1, .bits_per_sample = 16 };
+        av_render_set_fixed_frame_info(render, &out_info);
+        // CELT fullband 20ms, one frame per packet
+        data_buffer[0] = (31 << 3) | 0x04;
+        size = 160;
+    }
+    av_render_add_audio_stream(render, &audio_info);
+    int64_t start = sim_clock_now();
+    for (int i = 0; i < AUDIO_FRAME_NUM; i++) {
+        av_render_audio_data_t data = { .data = data_buffer, .size = size, .pts = i * AUDIO_FRAME_MS };
+        av_render_add_audio_data(render, &data);
+        sim_clock_wait_until(start + (int64_t)(i + 1) * AUDIO_FRAME_MS * 1000);
+    }
+}
+
+static void feed_video(av_render_handle_t render, stats_case_t *c)
+{
+    static uint8_t data_buffer[VIDEO_DATA_SIZE];
+    av_render_video_info_t video_info = {
+        .codec = c->codec,
+        .width = VIDEO_WIDTH,
+        .height = VIDEO_HEIGHT,
+        .fps = VIDEO_FPS,
+    };
+    av_render_add_video_stream(render, &video_info);
+    int64_t start = sim_clock_now();
+    for (int i = 0; i < VIDEO_FRAME_NUM; i++) {
+        av_render_video_data_t data = { .data = data_buffer, .size = VIDEO_DATA_SIZE, .pts = i * 1000 / VIDEO_FPS };
+        av_render_add_video_data(render, &data);
+        sim_clock_wait_until(start + (int64_t)(i + 1) * 1000000 / VIDEO_FPS);
+    }
+}
+
+static void run(stats_case_t *c)
+{
+    static const char *stage_name[AV_RENDER_STAGE_MAX] = { "queue wait", "decode", "convert", "render", "end to end" };
+    sim_render_cfg_t render_cfg = { .audio_buffer_ms = 40 };
+    audio_render_handle_t audio_render = sim_audio_render_alloc(&render_cfg);
+    video_render_handle_t video_render = sim_video_render_alloc(&render_cfg);
+    av_render_cfg_t cfg = {
+        .audio_render = audio_render,
+        .video_render = video_render,
+        .audio_raw_fifo_size = 8 * 1024,
+        .audio_render_fifo_size = 16 * 1024,
+        .video_raw_fifo_size = 4 * (VIDEO_DATA_SIZE + 64),
+        .video_render_fifo_size = 2 * VIDEO_WIDTH * VIDEO_HEIGHT * 2 + 256,
+        .sync_mode = AV_RENDER_SYNC_NONE,
+        // Stand-in decoder can not convert, H264 YUV420 output is converted by render
+        .video_cvt_in_render = true,
+    };
+    av_render_handle_t render = av_render_open(&cfg);
+    cur_case = c;
+    if (c->is_video) {
+        feed_video(render, c);
+    } else {
+        feed_audio(render, c);
+    }
+    // Let queued frames play out
+    usleep(300 * 1000);
+    av_render_stream_stats_t stats = {};
+    av_render_stream_type_t type = c->is_video ? AV_RENDER_STREAM_TYPE_VIDEO : AV_RENDER_STREAM_TYPE_AUDIO;
+    int ret = av_render_get_stream_stats(render, type, &stats);
+    av_render_close(render);
+    cur_case = NULL;
+    audio_render_free_handle(audio_render);
+    video_render_free_handle(video_render);
+
+    uint32_t frame_num = c->is_video ? VIDEO_FRAME_NUM : AUDIO_FRAME_NUM;
+    printf("%s: in %u decoded %u rendered %u\n", c->name, (unsigned)stats.in_num, (unsigned)stats.decoded_num,
+           (unsigned)stats.rendered_num);
+    for (int i = 0; i < AV_RENDER_STAGE_MAX; i++) {
+        av_render_stage_stats_t *s = &stats.stage[i];
+        if (s->count == 0) {
+            continue;
+        }
+        printf("  %-10s %6u %8.2f %8.2f %8.2f %8.2f\n", stage_name[i], (unsigned)s->count, s->p50_us / 1000.0,
+               s->p95_us / 1000.0, s->p99_us / 1000.0, s->max_us / 1000.0);
+        TEST_CHECK(s->p50_us <= s->p95_us && s->p95_us <= s->p99_us && s->p99_us <= s->max_us,
+                   "%s %s percentiles not ordered", c->name, stage_name[i]);
+    }
+    TEST_CHECK(ret == 0, "%s get stats return %d", c->name, ret);
+    TEST_CHECK(stats.in_num == frame_num && stats.decoded_num == frame_num, "%s in %u decoded %u", c->name,
+               (unsigned)stats.in_num, (unsigned)stats.decoded_num);
+    TEST_CHECK(stats.rendered_num > 0, "%s nothing rendered", c->name);
+    TEST_CHECK(stats.stage[AV_RENDER_STAGE_DECODE].count == frame_num, "%s decode measured %u times", c->name,
+               (unsigned)stats.stage[AV_RENDER_STAGE_DECODE].count);
+    // Percentile error is within 1/8 of value
+    TEST_CHECK(stats.stage[AV_RENDER_STAGE_DECODE].p50_us >= c->cost_us * 7 / 8, "%s decode p50 %u us below cost",
+               c->name, (unsigned)stats.stage[AV_RENDER_STAGE_DECODE].p50_us);
+    TEST_CHECK((stats.stage[AV_RENDER_STAGE_CONVERT].count > 0) == c->convert, "%s convert measured %u times",
+               c->name, (unsigned)stats.stage[AV_RENDER_STAGE_CONVERT].count);
+    TEST_CHECK(stats.stage[AV_RENDER_STAGE_END_TO_END].count > 0, "%s end to end not measured", c->name);
+}
+
+int main(void)
+{
+    stats_case_t cases[] = {
+        { "G711",  false, AV_RENDER_AUDIO_CODEC_G711A, 40,   10,   false },
+        { "Opus",  false, AV_RENDER_AUDIO_CODEC_OPUS,  1200, 300,  true },
+        { "MJPEG", true,  AV_RENDER_VIDEO_CODEC_MJPEG, 6000, 1500, false },
+        { "H264",  true,  AV_RENDER_VIDEO_CODEC_H264,  8000, 2000, true },
+    };
+    media_lib_add_default_adapter();
+    printf("  %-10s %6s %8s %8s %8s %8s\n", "Stage(ms)", "Count", "p50", "p95", "p99", "max");
+    for (int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        run(&cases[i]);
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,151 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Benchmark decoded video hand over to render for synthetic 720p MJPEG stream
+ *
+ * Decode runs in sync with add data, render runs in its own thread or in sync with decoder
+ * Simulated panel with frame buffers lends them, frame from other memory is copied into panel
+ * Report bytes copied by memcpy per frame and latency from decode start to frame drawn
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "av_render.h"
+#include "sim_render.h"
+#include "host_test.h"
+
+#define WIDTH        (1280)
+#define HEIGHT       (720)
+#define DATA_SIZE    (64 * 1024)
+#define FRAME_NUM    (120)
+#define FRAME_GAP_MS (10)
+
+typedef struct {
+    const char *name;
+    uint8_t     fb_num;
+    bool        render_thread;
+} copy_case_t;
+
+static uint64_t        copy_bytes;
+static bool            count_copy;
+static int64_t         decode_time[FRAME_NUM];
+static int64_t         latency[FRAME_NUM];
+static uint32_t        drawn_num;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void *__real_memcpy(void *dst, const void *src, size_t n);
+int __real_vdec_decode(void *h, av_render_video_data_t *data);
+
+// Linked with --wrap so that copies done inside render and simulated panel are counted
+void *__wrap_memcpy(void *dst, const void *src, size_t n)
+{
+    if (__atomic_load_n(&count_copy, __ATOMIC_RELAXED)) {
+        __atomic_add_fetch(&copy_bytes, n, __ATOMIC_RELAXED);
+    }
+    return __real_memcpy(dst, src, n);
+}
+
+int __wrap_vdec_decode(void *h, av_render_video_data_t *data)
+{
+    if (data->pts < FRAME_NUM) {
+        decode_time[data->pts] = sim_clock_now();
+    }
+    return __real_vdec_decode(h, data);
+}
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+    if (kind != 'V' || pts >= FRAME_NUM) {
+        return;
+    }
+    pthread_mutex_lock(&trace_lock);
+    latency[pts] = sim_clock_now() - decode_time[pts];
+    drawn_num++;
+    pthread_mutex_unlock(&trace_lock);
+}
+
+static int cmp_i64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return x < y ? -1 : (x > y);
+}
+
+static uint64_t run(copy_case_t *c)
+{
+    static uint8_t data_buffer[DATA_SIZE];
+    sim_render_cfg_t render_cfg = { .video_fb_num = c->fb_num };
+    video_render_handle_t video_render = sim_video_render_alloc(&render_cfg);
+    av_render_cfg_t cfg = {
+        .video_render = video_render,
+        .video_render_fifo_size = c->render_thread ? 2 * WIDTH * HEIGHT * 2 + 256 : 0,
+        .sync_mode = AV_RENDER_SYNC_NONE,
+    };
+    av_render_handle_t render = av_render_open(&cfg);
+    av_render_video_info_t video_info = { .codec = AV_RENDER_VIDEO_CODEC_MJPEG, .width = WIDTH, .height = HEIGHT, .fps = 30 };
+    av_render_add_video_stream(render, &video_info);
+    memset(latency, 0, sizeof(latency));
+    drawn_num = 0;
+    copy_bytes = 0;
+    __atomic_store_n(&count_copy, true, __ATOMIC_RELAXED);
+    for (int i = 0; i < FRAME_NUM; i++) {
+        av_render_video_data_t data = { .data = data_buffer, .size = DATA_SIZE, .pts = i };
+        av_render_add_video_data(render, &data);
+        usleep(FRAME_GAP_MS * 1000);
+    }
+    usleep(100 * 1000);
+    __atomic_store_n(&count_copy, false, __ATOMIC_RELAXED);
+    av_render_close(render);
+    video_render_free_handle(video_render);
+
+    qsort(latency, FRAME_NUM, sizeof(int64_t), cmp_i64);
+    printf("%-12s %10u %10.2f %10.2f %8u\n", c->name, (unsigned)(copy_bytes / FRAME_NUM),
+           latency[FRAME_NUM / 2] / 1000.0, latency[FRAME_NUM * 99 / 100] / 1000.0, (unsigned)drawn_num);
+    TEST_CHECK(drawn_num == FRAME_NUM, "%s drawn %u frames", c->name, (unsigned)drawn_num);
+    return copy_bytes;
+}
+
+int main(void)
+{
+    copy_case_t cases[] = {
+        { "Thread fb",    3, true },
+        { "Thread no fb", 0, true },
+        { "Sync fb",      3, false },
+        { "Sync no fb",   0, false },
+    };
+    media_lib_add_default_adapter();
+    printf("%-12s %10s %10s %10s %8s\n", "Mode", "Copy(B)", "p50(ms)", "p99(ms)", "Drawn");
+    for (int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint64_t bytes = run(&cases[i]);
+        // Render lends frame buffer from second frame, only first frame decoded before render open is copied
+        if (cases[i].fb_num && cases[i].render_thread == false) {
+            TEST_CHECK(bytes <= WIDTH * HEIGHT * 2 + FRAME_NUM * 256, "%s copied %u bytes", cases[i].name,
+                       (unsigned)bytes);
+        }
+    }
+    return TEST_RESULT();
+}
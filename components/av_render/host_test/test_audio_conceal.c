@@ -0,0 +1,323 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Audio decoder packet loss concealment under burst loss
+ *
+ * 20 seconds synthetic voiced speech is G.711 A-law coded in 20ms frames, frames are dropped by Gilbert model
+ * (mean burst 2 frames) at 5%, 10% and 20% loss, then fed to decoder by PTS
+ * Concealed output must be much closer to clean decode on lost frames than silence gap (log spectral distance),
+ * keep continuous PTS and full sample count, only burst over `conceal_max_ms` may resync
+ * Opus path must use decoder PLC for short gaps and resync on gap over `conceal_max_ms`
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <math.h>
+#include "media_lib_adapter.h"
+#include "audio_decoder.h"
+#include "sim_audio_dec.h"
+#include "host_test.h"
+
+#define SAMPLE_RATE    (8000)
+#define FRAME_MS       (20)
+#define FRAME_SAMPLES  (SAMPLE_RATE * FRAME_MS / 1000)
+#define TEST_SECONDS   (20)
+#define TOTAL_SAMPLES  (SAMPLE_RATE * TEST_SECONDS)
+#define TOTAL_FRAMES   (TOTAL_SAMPLES / FRAME_SAMPLES)
+#define CONCEAL_MAX_MS (120)
+// Concealed audio must be this much closer to clean decode than silence gap
+#define MIN_LSD_GAIN_DB (3.0)
+
+#define FRAME_CONCEALED (1)
+#define FRAME_RESYNCED  (2)
+
+typedef struct {
+    int16_t *pcm;
+    int      out_samples;
+    uint32_t expect_pts;
+    int      pts_err;
+    bool     place;
+} conceal_out_t;
+
+static int frame_cb(av_render_audio_frame_t *frame, void *ctx)
+{
+    conceal_out_t *out = (conceal_out_t *)ctx;
+    if (frame->pts != out->expect_pts) {
+        out->pts_err++;
+    }
+    out->expect_pts = frame->pts + FRAME_MS;
+    int samples = frame->size / sizeof(int16_t);
+    if (out->place && frame->pts / FRAME_MS < TOTAL_FRAMES) {
+        memcpy(out->pcm + frame->pts / FRAME_MS * FRAME_SAMPLES, frame->data, frame->size);
+    }
+    out->out_samples += samples;
+    return 0;
+}
+
+static void make_speech(int16_t *pcm)
+{
+    double phase = 0;
+    unsigned seed = 3;
+    for (int i = 0; i < TOTAL_SAMPLES; i++) {
+        double t = (double)i / SAMPLE_RATE;
+        // Pitch glides 100-195Hz, harmonics shaped by 3 formants
+        double f0 = 140 + 40 * sin(2 * M_PI * 0.7 * t) + 15 * sin(2 * M_PI * 2.3 * t);
+        phase += 2 * M_PI * f0 / SAMPLE_RATE;
+        double v = 0;
+        for (int k = 1; k <= 20; k++) {
+            double fk = k * f0;
+            double w = exp(-pow((fk - 700) / 250, 2)) + 0.6 * exp(-pow((fk - 1200) / 300, 2)) +
+                       0.3 * exp(-pow((fk - 2500) / 400, 2)) + 0.05;
+            v += w * sin(k * phase) / k;
+        }
+        double env = pow(fabs(sin(2 * M_PI * 2.1 * t)), 0.6);
+        bool voiced = fmod(t, 1.7) < 1.4;
+        double noise = ((int)(rand_r(&seed) % 2001) - 1000) / 1000.0;
+        pcm[i] = (int16_t)(env * (voiced ? 9000 * v : 1500 * noise));
+    }
+}
+
+static bool frame_has_energy(int16_t *ref, int f)
+{
+    double energy = 0;
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        energy += (double)ref[f * FRAME_SAMPLES + i] * ref[f * FRAME_SAMPLES + i];
+    }
+    return energy >= 1e3 * FRAME_SAMPLES;
+}
+
+// Log spectral distance (dB) on concealed frames with energy
+static double calc_lsd(int16_t *ref, int16_t *pcm, char *lost)
+{
+    double total = 0;
+    int count = 0;
+    for (int f = 0; f < TOTAL_FRAMES; f++) {
+        if (lost[f] != FRAME_CONCEALED || frame_has_energy(ref, f) == false) {
+            continue;
+        }
+        int16_t *a = ref + f * FRAME_SAMPLES;
+        int16_t *b = pcm + f * FRAME_SAMPLES;
+        double dist = 0;
+        for (int k = 1; k < 64; k++) {
+            double ar = 0, ai = 0, br = 0, bi = 0;
+            for (int i = 0; i < FRAME_SAMPLES; i++) {
+                double w = 0.5 - 0.5 * cos(2 * M_PI * i / FRAME_SAMPLES);
+                double c = cos(2 * M_PI * k * i / 128.0);
+                double s = sin(2 * M_PI * k * i / 128.0);
+                ar += w * a[i] * c;
+                ai += w * a[i] * s;
+                br += w * b[i] * c;
+                bi += w * b[i] * s;
+            }
+            double da = 10 * log10(ar * ar + ai * ai + 1e4) - 10 * log10(br * br + bi * bi + 1e4);
+            dist += da * da;
+        }
+        total += sqrt(dist / 63);
+        count++;
+    }
+    return count ? total / count : 0;
+}
+
+// Segmental SNR (dB) over whole stream, frames clipped to [-10, 35]
+static double calc_seg_snr(int16_t *ref, int16_t *pcm)
+{
+    double sum = 0;
+    int count = 0;
+    for (int f = 0; f < TOTAL_FRAMES; f++) {
+        if (frame_has_energy(ref, f) == false) {
+            continue;
+        }
+        double se = 0, ne = 0;
+        for (int i = f * FRAME_SAMPLES; i < (f + 1) * FRAME_SAMPLES; i++) {
+            double e = (double)ref[i] - pcm[i];
+            se += (double)ref[i] * ref[i];
+            ne += e * e;
+        }
+        double snr = 10 * log10(se / (ne + 1));
+        sum += snr < -10 ? -10 : snr > 35 ? 35 : snr;
+        count++;
+    }
+    return count ? sum / count : 0;
+}
+
+static void check_g711_loss(double loss_rate, unsigned seed, uint8_t *enc, int16_t *clean)
+{
+    char *lost = (char *)calloc(TOTAL_FRAMES, 1);
+    int16_t *gap = (int16_t *)malloc(TOTAL_SAMPLES * sizeof(int16_t));
+    conceal_out_t out = {
+        .pcm = (int16_t *)calloc(TOTAL_SAMPLES, sizeof(int16_t)),
+        .place = true,
+    };
+    // Gilbert model, leave good to bad so that mean burst is 2 frames
+    double p_gb = loss_rate / (2 * (1 - loss_rate));
+    double p_bg = 0.5;
+    bool bad = false;
+    int lost_num = 0;
+    for (int f = 0; f < TOTAL_FRAMES; f++) {
+        double u = rand_r(&seed) / (double)RAND_MAX;
+        bad = bad ? (u > p_bg) : (u < p_gb);
+        // Keep head and tail so that all losses are inside stream
+        lost[f] = (f > 2 && f < TOTAL_FRAMES - 1) ? bad : 0;
+        lost_num += lost[f];
+    }
+    // Burst longer than `conceal_max_ms` is expected to resync instead of conceal
+    int conceal_num = 0, resync_num = 0;
+    for (int f = 0; f < TOTAL_FRAMES;) {
+        int burst = 0;
+        while (f + burst < TOTAL_FRAMES && lost[f + burst]) {
+            burst++;
+        }
+        if (burst == 0) {
+            f++;
+            continue;
+        }
+        bool resync = burst * FRAME_MS > CONCEAL_MAX_MS;
+        memset(lost + f, resync ? FRAME_RESYNCED : FRAME_CONCEALED, burst);
+        resync ? resync_num++ : (conceal_num += burst);
+        f += burst;
+    }
+    adec_cfg_t cfg = {
+        .audio_info = {
+            .codec = AV_RENDER_AUDIO_CODEC_G711A,
+            .sample_rate = SAMPLE_RATE,
+            .channel = 1,
+            .bits_per_sample = 16,
+        },
+        .frame_cb = frame_cb,
+        .ctx = &out,
+        .conceal_max_ms = CONCEAL_MAX_MS,
+    };
+    adec_handle_t adec = adec_open(&cfg);
+    TEST_CHECK(adec, "open decoder");
+    if (adec == NULL) {
+        goto _exit;
+    }
+    for (int f = 0; f < TOTAL_FRAMES; f++) {
+        if (lost[f]) {
+            continue;
+        }
+        av_render_audio_data_t data = {
+            .pts = f * FRAME_MS,
+            .data = enc + f * FRAME_SAMPLES,
+            .size = FRAME_SAMPLES,
+        };
+        adec_decode(adec, &data);
+    }
+    adec_conceal_stats_t stats = {};
+    adec_get_conceal_stats(adec, &stats);
+    adec_close(adec);
+    for (int i = 0; i < TOTAL_SAMPLES; i++) {
+        gap[i] = lost[i / FRAME_SAMPLES] ? 0 : clean[i];
+    }
+    double gap_lsd = calc_lsd(clean, gap, lost);
+    double conceal_lsd = calc_lsd(clean, out.pcm, lost);
+    printf("G711A loss %2.0f%% (actual %4.1f%%): LSD on concealed frames gap %.2f / conceal %.2f dB, segSNR gap %.2f / conceal %.2f dB, "
+           "lost %" PRIu32 " concealed %" PRIu32 " resync %" PRIu32 "\n",
+           100.0 * loss_rate, 100.0 * lost_num / TOTAL_FRAMES, gap_lsd, conceal_lsd, calc_seg_snr(clean, gap),
+           calc_seg_snr(clean, out.pcm), stats.lost_frames, stats.concealed_frames, stats.resync_num);
+    TEST_CHECK(conceal_lsd + MIN_LSD_GAIN_DB <= gap_lsd, "conceal LSD %.2f not below gap %.2f", conceal_lsd, gap_lsd);
+    // Only resync leaves PTS hole
+    TEST_CHECK(out.pts_err == resync_num, "%d PTS discontinuity expect %d", out.pts_err, resync_num);
+    TEST_CHECK(out.out_samples == TOTAL_SAMPLES - (lost_num - conceal_num) * FRAME_SAMPLES, "output %d samples",
+               out.out_samples);
+    TEST_CHECK(stats.lost_frames == conceal_num && stats.concealed_frames == conceal_num &&
+               stats.resync_num == resync_num, "stats lost %" PRIu32 " concealed %" PRIu32 " resync %" PRIu32
+               " expect %d/%d", stats.lost_frames, stats.concealed_frames, stats.resync_num, conceal_num, resync_num);
+_exit:
+    free(lost);
+    free(gap);
+    free(out.pcm);
+}
+
+static void check_opus_plc(void)
+{
+    // Short gaps go to decoder PLC, 10 frames gap is over `conceal_max_ms`
+    static const int drop[] = { 5, 6, 7, 20, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49 };
+    conceal_out_t out = {};
+    adec_cfg_t cfg = {
+        .audio_info = {
+            .codec = AV_RENDER_AUDIO_CODEC_OPUS,
+            .sample_rate = 48000,
+            .channel = 1,
+            .bits_per_sample = 16,
+        },
+        .frame_cb = frame_cb,
+        .ctx = &out,
+        .conceal_max_ms = CONCEAL_MAX_MS,
+    };
+    adec_handle_t adec = adec_open(&cfg);
+    TEST_CHECK(adec, "open decoder");
+    if (adec == NULL) {
+        return;
+    }
+    int16_t packet[960] = {};
+    int plc_start = sim_audio_dec_get_plc_num();
+    int sent = 0, d = 0;
+    for (int f = 0; f < 60; f++) {
+        if (d < sizeof(drop) / sizeof(drop[0]) && drop[d] == f) {
+            d++;
+            continue;
+        }
+        av_render_audio_data_t data = {
+            .pts = f * FRAME_MS,
+            .data = (uint8_t *)packet,
+            .size = sizeof(packet),
+        };
+        adec_decode(adec, &data);
+        sent++;
+    }
+    adec_conceal_stats_t stats = {};
+    adec_get_conceal_stats(adec, &stats);
+    adec_close(adec);
+    int plc_num = sim_audio_dec_get_plc_num() - plc_start;
+    printf("Opus: sent %d, PLC %d, lost %" PRIu32 " concealed %" PRIu32 " resync %" PRIu32 ", output frames %d\n",
+           sent, plc_num, stats.lost_frames, stats.concealed_frames, stats.resync_num, out.out_samples / 960);
+    TEST_CHECK(plc_num == 4 && stats.concealed_frames == 4, "PLC %d concealed %" PRIu32, plc_num,
+               stats.concealed_frames);
+    TEST_CHECK(stats.resync_num == 1, "resync %" PRIu32, stats.resync_num);
+    TEST_CHECK(out.out_samples / 960 == sent + 4, "output frames %d", out.out_samples / 960);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    int16_t *ref = (int16_t *)malloc(TOTAL_SAMPLES * sizeof(int16_t));
+    int16_t *clean = (int16_t *)malloc(TOTAL_SAMPLES * sizeof(int16_t));
+    uint8_t *enc = (uint8_t *)malloc(TOTAL_SAMPLES);
+    make_speech(ref);
+    for (int i = 0; i < TOTAL_SAMPLES; i++) {
+        enc[i] = sim_audio_dec_alaw_encode(ref[i]);
+        clean[i] = sim_audio_dec_alaw_decode(enc[i]);
+    }
+    static const double loss_rates[] = { 0.05, 0.10, 0.20 };
+    for (int r = 0; r < sizeof(loss_rates) / sizeof(loss_rates[0]); r++) {
+        check_g711_loss(loss_rates[r], 11 + r, enc, clean);
+    }
+    check_opus_plc();
+    free(ref);
+    free(clean);
+    free(enc);
+    return TEST_RESULT();
+}
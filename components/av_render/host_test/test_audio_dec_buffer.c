@@ -0,0 +1,149 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Audio decoder output buffer sized once at open
+ *
+ * Each stream decodes 100000 frames through stand-in decoder reporting real frame size of codec
+ * Streams cover every supported codec, HE-AAC signalled as 24kHz mono core, Opus and FLAC with changing frame duration,
+ * G711 mixing 20ms and 40ms packets and ADPCM mixing block sizes
+ * Decoder must never retry for output buffer not enough nor enlarge buffer after open
+ */
+
+#include <inttypes.h>
+#include "media_lib_adapter.h"
+#include "audio_decoder.h"
+#include "sim_audio_dec.h"
+#include "host_test.h"
+
+#define FRAME_NUM      (100000)
+#define MAX_PACKET_LEN (1024)
+
+typedef struct {
+    const char             *name;
+    av_render_audio_codec_t codec;
+    uint32_t                sample_rate;   /* Signalled in stream information */
+    uint8_t                 channel;
+    uint32_t                out_rate;      /* Decoded from stream */
+    uint8_t                 out_channel;
+    uint32_t                samples[2];    /* Samples per channel of frames, used in turn */
+    uint32_t                packet_len[2]; /* Packet length, used in turn */
+} dec_stream_t;
+
+static const dec_stream_t streams[] = {
+    { "MP3 44.1kHz stereo", AV_RENDER_AUDIO_CODEC_MP3, 44100, 2, 44100, 2, { 1152, 1152 }, { 418, 417 } },
+    { "MP3 22.05kHz mono", AV_RENDER_AUDIO_CODEC_MP3, 22050, 1, 22050, 1, { 576, 576 }, { 144, 144 } },
+    { "AAC-LC 48kHz stereo", AV_RENDER_AUDIO_CODEC_AAC, 48000, 2, 48000, 2, { 1024, 1024 }, { 371, 342 } },
+    { "HE-AACv2 as 24kHz mono", AV_RENDER_AUDIO_CODEC_AAC, 24000, 1, 48000, 2, { 2048, 2048 }, { 96, 110 } },
+    { "AMR-NB", AV_RENDER_AUDIO_CODEC_AMRNB, 8000, 1, 8000, 1, { 160, 160 }, { 32, 32 } },
+    { "AMR-WB", AV_RENDER_AUDIO_CODEC_AMRWB, 16000, 1, 16000, 1, { 320, 320 }, { 61, 61 } },
+    { "Opus 48kHz stereo 20/60ms", AV_RENDER_AUDIO_CODEC_OPUS, 48000, 2, 48000, 2, { 960, 2880 }, { 160, 480 } },
+    { "Opus 16kHz mono 20/120ms", AV_RENDER_AUDIO_CODEC_OPUS, 16000, 1, 16000, 1, { 320, 1920 }, { 60, 360 } },
+    { "FLAC 44.1kHz stereo", AV_RENDER_AUDIO_CODEC_FLAC, 44100, 2, 44100, 2, { 4096, 4608 }, { 900, 1000 } },
+    { "FLAC 96kHz stereo", AV_RENDER_AUDIO_CODEC_FLAC, 96000, 2, 96000, 2, { 8192, 16384 }, { 800, 1000 } },
+    { "ALAC 44.1kHz stereo", AV_RENDER_AUDIO_CODEC_ALAC, 44100, 2, 44100, 2, { 4096, 4096 }, { 1000, 900 } },
+    { "G711A 20/40ms", AV_RENDER_AUDIO_CODEC_G711A, 8000, 1, 8000, 1, { 0, 0 }, { 160, 320 } },
+    { "G711U 20/40ms", AV_RENDER_AUDIO_CODEC_G711U, 8000, 1, 8000, 1, { 0, 0 }, { 160, 320 } },
+    { "ADPCM 8kHz mono", AV_RENDER_AUDIO_CODEC_ADPCM, 8000, 1, 8000, 1, { 0, 0 }, { 256, 512 } },
+};
+
+typedef struct {
+    uint32_t expect_size;
+    int      size_err;
+    int      frame_num;
+} dec_out_t;
+
+static int frame_cb(av_render_audio_frame_t *frame, void *ctx)
+{
+    dec_out_t *out = (dec_out_t *)ctx;
+    out->size_err += (frame->size != out->expect_size);
+    out->frame_num++;
+    return 0;
+}
+
+static uint32_t expect_frame_size(const dec_stream_t *s, int i)
+{
+    uint32_t len = s->packet_len[i];
+    if (s->codec == AV_RENDER_AUDIO_CODEC_G711A || s->codec == AV_RENDER_AUDIO_CODEC_G711U) {
+        return len * 2;
+    }
+    if (s->codec == AV_RENDER_AUDIO_CODEC_ADPCM) {
+        return ((len / s->out_channel - 4) * 2 + 1) * s->out_channel * 2;
+    }
+    return s->samples[i] * s->out_channel * 2;
+}
+
+static void check_stream(const dec_stream_t *s)
+{
+    static uint8_t packet[MAX_PACKET_LEN];
+    dec_out_t out = {};
+    adec_cfg_t cfg = {
+        .audio_info = {
+            .codec = s->codec,
+            .sample_rate = s->sample_rate,
+            .channel = s->channel,
+            .bits_per_sample = 16,
+        },
+        .frame_cb = frame_cb,
+        .ctx = &out,
+    };
+    adec_handle_t adec = adec_open(&cfg);
+    TEST_CHECK(adec, "%s: open decoder", s->name);
+    if (adec == NULL) {
+        return;
+    }
+    uint32_t pts = 0;
+    for (int n = 0; n < FRAME_NUM; n++) {
+        // Change frame duration every 7 frames
+        int i = (n / 7) & 1;
+        uint32_t samples = s->samples[i] ? s->samples[i] : 1;
+        sim_audio_dec_set_frame(s->out_rate, s->out_channel, samples);
+        out.expect_size = expect_frame_size(s, i);
+        av_render_audio_data_t data = {
+            .pts = pts,
+            .data = packet,
+            .size = s->packet_len[i],
+        };
+        adec_decode(adec, &data);
+        pts += out.expect_size / 2 / s->out_channel * 1000 / s->out_rate;
+    }
+    adec_buffer_stats_t stats = {};
+    adec_get_buffer_stats(adec, &stats);
+    adec_close(adec);
+    sim_audio_dec_set_frame(0, 0, 0);
+    printf("%-26s buffer %6" PRIu32 " bytes, %d frames, retry %" PRIu32 " realloc %" PRIu32 "\n", s->name,
+           stats.frame_size, out.frame_num, stats.retry_num, stats.realloc_num);
+    TEST_CHECK(out.frame_num == FRAME_NUM && out.size_err == 0, "%s: %d frames %d wrong size", s->name,
+               out.frame_num, out.size_err);
+    TEST_CHECK(stats.retry_num == 0 && stats.realloc_num == 0, "%s: retry %" PRIu32 " realloc %" PRIu32, s->name,
+               stats.retry_num, stats.realloc_num);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    for (int i = 0; i < sizeof(streams) / sizeof(streams[0]); i++) {
+        check_stream(&streams[i]);
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,256 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Adaptive audio playout buffer under simulated network jitter and clock drift
+ *
+ * Ticks at 1ms: sender emits 20ms frames on its own clock (optionally drifting), network adds exponential
+ * jitter and Wi-Fi stalls, player outputs 1ms per tick and consumes `speed` ms of input for it
+ * Each trace runs with previous fixed threshold logic (start at 100ms, drop above 200ms) and with `audio_jitter`
+ * Adaptive buffer must keep silence low, never drop on drift and hold depth in a band without long term growth
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "media_lib_adapter.h"
+#include "audio_jitter.h"
+#include "host_test.h"
+
+#define FRAME_MS          (20)
+#define JITTER_MIN_MS     (40)
+#define JITTER_MAX_MS     (300)
+#define FIXED_THRESHOLD   (100)
+#define FIXED_DROP_MS     (200)
+#define MAX_DEPTH_MS      (4000)
+// Depth averaged per window to check drift convergence
+#define DEPTH_WINDOW_MS   (30000)
+#define MAX_WINDOW        (16)
+
+typedef struct {
+    const char *name;
+    double      jitter_mean; /*!< Mean of exponential jitter (ms) */
+    double      stall_prob;  /*!< Probability of stall per packet */
+    int         stall_ms;    /*!< Mean stall duration */
+    double      drift_ppm;   /*!< Sender clock faster when positive */
+    int         seconds;
+} net_trace_t;
+
+typedef struct {
+    double arrive;
+    uint32_t pts;
+} sim_packet_t;
+
+typedef struct {
+    double silent_ms;
+    int    underrun_num;
+    double drop_ms;
+    double depth_sum;
+    long   ticks;
+    int    depth_hist[MAX_DEPTH_MS];
+    double window_sum[MAX_WINDOW];
+    int    window_num;
+} sim_result_t;
+
+static const net_trace_t traces[] = {
+    { "LAN 3ms jitter", 3, 0, 0, 0, 120 },
+    { "Wi-Fi 15ms jitter, 2% stalls", 15, 0.02, 150, 0, 120 },
+    { "Wi-Fi, sender +800ppm", 15, 0.02, 150, 800, 300 },
+    { "Wi-Fi, sender -800ppm", 15, 0.02, 150, -800, 300 },
+    { "Bad Wi-Fi 30ms jitter, 4% stalls", 30, 0.04, 250, 0, 120 },
+};
+
+static double rand_unit(unsigned *seed)
+{
+    return rand_r(seed) / (RAND_MAX + 1.0);
+}
+
+static int make_packets(const net_trace_t *trace, unsigned seed, sim_packet_t *packets)
+{
+    int num = trace->seconds * 1000 / FRAME_MS;
+    double last = 0, stall_end = -1;
+    for (int i = 0; i < num; i++) {
+        double send = i * FRAME_MS / (1 + trace->drift_ppm * 1e-6);
+        double delay = 30 - trace->jitter_mean * log(1 - rand_unit(&seed));
+        if (trace->stall_prob && rand_unit(&seed) < trace->stall_prob) {
+            stall_end = send + trace->stall_ms * (0.5 + rand_unit(&seed));
+        }
+        double arrive = (send < stall_end ? stall_end : send) + delay;
+        // Transport keeps order
+        if (arrive < last) {
+            arrive = last;
+        }
+        last = arrive;
+        packets[i].arrive = arrive;
+        packets[i].pts = i * FRAME_MS;
+    }
+    return num;
+}
+
+static int depth_percentile(sim_result_t *res, double q)
+{
+    long count = 0;
+    for (int i = 0; i < MAX_DEPTH_MS; i++) {
+        count += res->depth_hist[i];
+        if (count >= q * res->ticks) {
+            return i;
+        }
+    }
+    return MAX_DEPTH_MS;
+}
+
+static void run_trace(sim_packet_t *packets, int num, bool adaptive, sim_result_t *res)
+{
+    memset(res, 0, sizeof(sim_result_t));
+    audio_jitter_cfg_t cfg = {
+        .min_ms = JITTER_MIN_MS,
+        .max_ms = JITTER_MAX_MS,
+    };
+    audio_jitter_handle_t jitter = adaptive ? audio_jitter_open(&cfg) : NULL;
+    int head = 0, tail = 0;
+    bool cur_valid = false, started = false, rendered = false, was_silent = false;
+    double cur_left = 0;
+    float speed = 1.0;
+    int end_ms = (int)packets[num - 1].arrive + 200;
+    for (int now = 0; now < end_ms; now++) {
+        while (head < num && packets[head].arrive <= now) {
+            if (jitter) {
+                audio_jitter_arrive(jitter, now, packets[head].pts);
+            }
+            head++;
+        }
+        double need = 1.0;
+        while (need > 1e-9) {
+            if (cur_valid == false) {
+                int q_num = head - tail;
+                uint32_t depth = q_num * FRAME_MS;
+                if (q_num == 0) {
+                    break;
+                }
+                if (jitter) {
+                    audio_jitter_action_t action = audio_jitter_control(jitter, depth, &speed);
+                    if (action == AUDIO_JITTER_ACTION_WAIT) {
+                        break;
+                    }
+                    if (action == AUDIO_JITTER_ACTION_DROP) {
+                        tail++;
+                        res->drop_ms += FRAME_MS;
+                        continue;
+                    }
+                } else {
+                    // Previous logic: wait for threshold, rebuffer under 3 frames, drop above limit
+                    if (rendered == false) {
+                        if (depth < FIXED_THRESHOLD) {
+                            break;
+                        }
+                    } else if (q_num < 3) {
+                        rendered = false;
+                        break;
+                    }
+                    if (depth >= FIXED_DROP_MS) {
+                        tail++;
+                        res->drop_ms += FRAME_MS;
+                        continue;
+                    }
+                }
+                rendered = started = cur_valid = true;
+                tail++;
+                cur_left = FRAME_MS;
+            }
+            double use = need * speed;
+            if (use > cur_left) {
+                use = cur_left;
+            }
+            cur_left -= use;
+            need -= use / speed;
+            if (cur_left <= 1e-9) {
+                cur_valid = false;
+            }
+        }
+        bool silent = started && need > 1e-9 && head < num;
+        if (silent) {
+            res->silent_ms += need;
+            if (was_silent == false) {
+                res->underrun_num++;
+            }
+        }
+        was_silent = silent;
+        if (started) {
+            int depth = (head - tail) * FRAME_MS + (int)cur_left;
+            res->depth_sum += depth;
+            res->ticks++;
+            res->depth_hist[depth < MAX_DEPTH_MS ? depth : MAX_DEPTH_MS - 1]++;
+            int w = now / DEPTH_WINDOW_MS;
+            if (w < MAX_WINDOW) {
+                res->window_sum[w] += depth;
+                res->window_num = w + 1;
+            }
+        }
+    }
+    audio_jitter_close(jitter);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    sim_packet_t *packets = (sim_packet_t *)malloc(sizeof(sim_packet_t) * 300 * 1000 / FRAME_MS);
+    sim_result_t *res = (sim_result_t *)malloc(sizeof(sim_result_t) * 2);
+    printf("%-34s | %-5s | %8s %6s | %8s | %6s %6s\n", "trace", "mode", "silent", "events", "dropped", "mean",
+           "p95");
+    for (int t = 0; t < sizeof(traces) / sizeof(traces[0]); t++) {
+        const net_trace_t *trace = &traces[t];
+        int num = make_packets(trace, 100 + t, packets);
+        for (int adaptive = 0; adaptive < 2; adaptive++) {
+            sim_result_t *r = &res[adaptive];
+            run_trace(packets, num, adaptive, r);
+            printf("%-34s | %-5s | %6.0fms %6d | %6.0fms | %4.0fms %4dms\n", trace->name,
+                   adaptive ? "adapt" : "fixed", r->silent_ms, r->underrun_num, r->drop_ms, r->depth_sum / r->ticks,
+                   depth_percentile(r, 0.95));
+        }
+        sim_result_t *fixed = &res[0], *adapt = &res[1];
+        if (trace->stall_prob == 0) {
+            // Clean network: lower latency than fixed threshold, almost no silence
+            TEST_CHECK(adapt->depth_sum / adapt->ticks < fixed->depth_sum / fixed->ticks, "%s depth", trace->name);
+            TEST_CHECK(adapt->silent_ms < 50, "%s silent %.0fms", trace->name, adapt->silent_ms);
+        } else {
+            TEST_CHECK(adapt->silent_ms * 4 < fixed->silent_ms, "%s silent %.0f / %.0fms", trace->name,
+                       adapt->silent_ms, fixed->silent_ms);
+        }
+        if (trace->drift_ppm) {
+            // Time stretch absorbs drift: no drop, windowed depth stays in band after first window
+            double min_depth = MAX_DEPTH_MS, max_depth = 0;
+            for (int w = 1; w < adapt->window_num - 1; w++) {
+                double depth = adapt->window_sum[w] / DEPTH_WINDOW_MS;
+                min_depth = depth < min_depth ? depth : min_depth;
+                max_depth = depth > max_depth ? depth : max_depth;
+            }
+            printf("  adapt depth per %ds window: %.0f - %.0fms\n", DEPTH_WINDOW_MS / 1000, min_depth, max_depth);
+            TEST_CHECK(adapt->drop_ms == 0, "%s dropped %.0fms", trace->name, adapt->drop_ms);
+            TEST_CHECK(max_depth - min_depth < 60, "%s depth drifts %.0f - %.0fms", trace->name, min_depth,
+                       max_depth);
+        }
+    }
+    free(packets);
+    free(res);
+    return TEST_RESULT();
+}
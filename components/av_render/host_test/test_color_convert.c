@@ -0,0 +1,332 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Color convert of every supported format pair against golden images
+ *
+ * Each pair converts a fixed pattern image and output CRC must equal the recorded one, so any bit change shows
+ * Converted pixels are also compared with a floating point reference, at most 1 LSB error is allowed
+ * Row band split by workers must give the same output as single thread
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "media_lib_adapter.h"
+#include "color_convert.h"
+#include "host_test.h"
+
+#define GOLDEN_WIDTH   (33)
+#define GOLDEN_HEIGHT  (17)
+#define SRC_NUM        (6)
+#define DST_NUM        (3)
+#define MAX_ERR_LSB    (1)
+
+typedef struct {
+    int      width;
+    int      height;
+    bool     chroma_vsub; /* Chroma has half height */
+    uint8_t *y;
+    uint8_t *u;
+    uint8_t *v;
+} test_image_t;
+
+static const av_render_video_frame_type_t src_fmts[SRC_NUM] = {
+    AV_RENDER_VIDEO_RAW_TYPE_YUV420, AV_RENDER_VIDEO_RAW_TYPE_NV12, AV_RENDER_VIDEO_RAW_TYPE_NV21,
+    AV_RENDER_VIDEO_RAW_TYPE_YUV422, AV_RENDER_VIDEO_RAW_TYPE_YUYV, AV_RENDER_VIDEO_RAW_TYPE_UYVY,
+};
+static const char *src_names[SRC_NUM] = { "YUV420", "NV12", "NV21", "YUV422P", "YUYV", "UYVY" };
+
+static const av_render_video_frame_type_t dst_fmts[DST_NUM] = {
+    AV_RENDER_VIDEO_RAW_TYPE_RGB565, AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE, AV_RENDER_VIDEO_RAW_TYPE_RGB888,
+};
+static const char *dst_names[DST_NUM] = { "RGB565", "RGB565_BE", "RGB888" };
+
+/* Golden output CRC of pattern image, first BT601 limited range then BT709 full range
+ * Every layout carries the same picture, so sources of same chroma subsampling share CRC
+ */
+static const uint32_t golden_crc[SRC_NUM][DST_NUM][2] = {
+    { { 0x2CD7016A, 0x43FC5481 }, { 0x371EFCD0, 0x4B195842 }, { 0x15095A58, 0xF6C03BB5 } },
+    { { 0x2CD7016A, 0x43FC5481 }, { 0x371EFCD0, 0x4B195842 }, { 0x15095A58, 0xF6C03BB5 } },
+    { { 0x2CD7016A, 0x43FC5481 }, { 0x371EFCD0, 0x4B195842 }, { 0x15095A58, 0xF6C03BB5 } },
+    { { 0x51960088, 0x504F3F48 }, { 0x278EA5B0, 0x978288F1 }, { 0xB06A3683, 0xD6BC163A } },
+    { { 0x51960088, 0x504F3F48 }, { 0x278EA5B0, 0x978288F1 }, { 0xB06A3683, 0xD6BC163A } },
+    { { 0x51960088, 0x504F3F48 }, { 0x278EA5B0, 0x978288F1 }, { 0xB06A3683, 0xD6BC163A } },
+};
+
+static uint32_t crc32_calc(const uint8_t *data, int size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (int i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void image_init(test_image_t *img, int width, int height, bool chroma_vsub, unsigned seed)
+{
+    int cw = (width + 1) / 2;
+    int ch = chroma_vsub ? (height + 1) / 2 : height;
+    img->width = width;
+    img->height = height;
+    img->chroma_vsub = chroma_vsub;
+    img->y = (uint8_t *)malloc(width * height);
+    img->u = (uint8_t *)malloc(cw * ch);
+    img->v = (uint8_t *)malloc(cw * ch);
+    // Gradient with noise so that clipping at both ends is covered
+    for (int i = 0; i < width * height; i++) {
+        img->y[i] = (uint8_t)((i % width) * 255 / width + (rand_r(&seed) & 0x1F));
+    }
+    for (int i = 0; i < cw * ch; i++) {
+        img->u[i] = (uint8_t)rand_r(&seed);
+        img->v[i] = (uint8_t)rand_r(&seed);
+    }
+}
+
+static void image_deinit(test_image_t *img)
+{
+    free(img->y);
+    free(img->u);
+    free(img->v);
+}
+
+static void image_pack(test_image_t *img, av_render_video_frame_type_t fmt, uint8_t *out)
+{
+    int w = img->width, h = img->height;
+    int cw = (w + 1) / 2;
+    int ch = img->chroma_vsub ? (h + 1) / 2 : h;
+    switch (fmt) {
+        case AV_RENDER_VIDEO_RAW_TYPE_YUV420:
+        case AV_RENDER_VIDEO_RAW_TYPE_YUV422:
+            memcpy(out, img->y, w * h);
+            memcpy(out + w * h, img->u, cw * ch);
+            memcpy(out + w * h + cw * ch, img->v, cw * ch);
+            break;
+        case AV_RENDER_VIDEO_RAW_TYPE_NV12:
+        case AV_RENDER_VIDEO_RAW_TYPE_NV21: {
+            bool nv21 = (fmt == AV_RENDER_VIDEO_RAW_TYPE_NV21);
+            memcpy(out, img->y, w * h);
+            for (int i = 0; i < cw * ch; i++) {
+                out[w * h + 2 * i] = nv21 ? img->v[i] : img->u[i];
+                out[w * h + 2 * i + 1] = nv21 ? img->u[i] : img->v[i];
+            }
+            break;
+        }
+        case AV_RENDER_VIDEO_RAW_TYPE_YUYV:
+        case AV_RENDER_VIDEO_RAW_TYPE_UYVY: {
+            bool uyvy = (fmt == AV_RENDER_VIDEO_RAW_TYPE_UYVY);
+            for (int r = 0; r < h; r++) {
+                for (int c = 0; c < cw; c++) {
+                    uint8_t *p = out + (r * cw + c) * 4;
+                    uint8_t y0 = img->y[r * w + 2 * c];
+                    uint8_t y1 = (2 * c + 1 < w) ? img->y[r * w + 2 * c + 1] : 0;
+                    uint8_t u = img->u[r * cw + c];
+                    uint8_t v = img->v[r * cw + c];
+                    if (uyvy) {
+                        p[0] = u, p[1] = y0, p[2] = v, p[3] = y1;
+                    } else {
+                        p[0] = y0, p[1] = u, p[2] = y1, p[3] = v;
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static int ref_clip(double v)
+{
+    return (int)floor(fmin(255, fmax(0, v)) + 0.5);
+}
+
+static void ref_pixel(test_image_t *img, color_convert_matrix_t matrix, bool full, int r, int c, int rgb[3])
+{
+    double kr = matrix == COLOR_CONVERT_MATRIX_BT709 ? 0.2126 : 0.299;
+    double kb = matrix == COLOR_CONVERT_MATRIX_BT709 ? 0.0722 : 0.114;
+    double kg = 1 - kr - kb;
+    double y_scale = full ? 1 : 255.0 / 219;
+    double c_scale = full ? 1 : 255.0 / 224;
+    int cw = (img->width + 1) / 2;
+    int cr = img->chroma_vsub ? r / 2 : r;
+    double y = (img->y[r * img->width + c] - (full ? 0 : 16)) * y_scale;
+    double u = (img->u[cr * cw + c / 2] - 128) * c_scale;
+    double v = (img->v[cr * cw + c / 2] - 128) * c_scale;
+    rgb[0] = ref_clip(y + 2 * (1 - kr) * v);
+    rgb[1] = ref_clip(y - 2 * kb * (1 - kb) / kg * u - 2 * kr * (1 - kr) / kg * v);
+    rgb[2] = ref_clip(y + 2 * (1 - kb) * u);
+}
+
+static int pixel_err(av_render_video_frame_type_t fmt, uint8_t *dst, int idx, int rgb[3])
+{
+    int got[3], ref[3];
+    if (fmt == AV_RENDER_VIDEO_RAW_TYPE_RGB888) {
+        for (int i = 0; i < 3; i++) {
+            got[i] = dst[idx * 3 + i];
+            ref[i] = rgb[i];
+        }
+    } else {
+        uint16_t p = ((uint16_t *)dst)[idx];
+        if (fmt == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) {
+            p = (uint16_t)((p >> 8) | (p << 8));
+        }
+        got[0] = p >> 11, got[1] = (p >> 5) & 0x3F, got[2] = p & 0x1F;
+        ref[0] = rgb[0] >> 3, ref[1] = rgb[1] >> 2, ref[2] = rgb[2] >> 3;
+    }
+    int err = 0;
+    for (int i = 0; i < 3; i++) {
+        if (abs(got[i] - ref[i]) > err) {
+            err = abs(got[i] - ref[i]);
+        }
+    }
+    return err;
+}
+
+/* Convert image and return output, NULL on failure */
+static uint8_t *convert_image(test_image_t *img, color_convert_cfg_t *cfg, int *out_size, bool check_size)
+{
+    int src_size = convert_table_get_image_size(cfg->from, cfg->width, cfg->height);
+    int dst_size = convert_table_get_image_size(cfg->to, cfg->width, cfg->height);
+    uint8_t *src = (uint8_t *)malloc(src_size);
+    uint8_t *dst = (uint8_t *)malloc(dst_size);
+    image_pack(img, cfg->from, src);
+    color_convert_table_t table = init_convert_table(cfg);
+    int ret = table ? convert_color(table, src, src_size, dst, dst_size) : -1;
+    if (table && check_size) {
+        // Wrong buffer size must be rejected
+        TEST_CHECK(convert_color(table, src, src_size - 1, dst, dst_size) != 0, "Short input accepted");
+        TEST_CHECK(convert_color(table, src, src_size, dst, dst_size - 1) != 0, "Short output accepted");
+    }
+    deinit_convert_table(table);
+    free(src);
+    if (ret != 0) {
+        free(dst);
+        return NULL;
+    }
+    *out_size = dst_size;
+    return dst;
+}
+
+static void check_golden(int si, int di)
+{
+    for (int i = 0; i < 2; i++) {
+        test_image_t img;
+        image_init(&img, GOLDEN_WIDTH, GOLDEN_HEIGHT, si < 3, 1);
+        color_convert_cfg_t cfg = {
+            .from = src_fmts[si],
+            .to = dst_fmts[di],
+            .width = GOLDEN_WIDTH,
+            .height = GOLDEN_HEIGHT,
+            .matrix = i ? COLOR_CONVERT_MATRIX_BT709 : COLOR_CONVERT_MATRIX_BT601,
+            .full_range = i != 0,
+        };
+        int size = 0;
+        uint8_t *out = convert_image(&img, &cfg, &size, i == 0);
+        TEST_CHECK(out, "%s -> %s convert failed", src_names[si], dst_names[di]);
+        if (out) {
+            uint32_t crc = crc32_calc(out, size);
+            TEST_CHECK(crc == golden_crc[si][di][i],
+                       "%s -> %s %s golden CRC 0x%08X got 0x%08X", src_names[si], dst_names[di],
+                       i ? "BT709 full" : "BT601 limited", (unsigned)golden_crc[si][di][i], (unsigned)crc);
+            // Row bands must join without seam
+            cfg.worker_num = 3;
+            uint8_t *band_out = convert_image(&img, &cfg, &size, false);
+            TEST_CHECK(band_out && memcmp(out, band_out, size) == 0, "%s -> %s differs with workers",
+                       src_names[si], dst_names[di]);
+            free(band_out);
+            free(out);
+        }
+        image_deinit(&img);
+    }
+}
+
+static void check_reference(int si, int di)
+{
+    static const int sizes[][2] = { { 64, 48 }, { 33, 17 }, { 2, 2 }, { 1, 1 } };
+    int worst = 0;
+    for (int z = 0; z < sizeof(sizes) / sizeof(sizes[0]); z++) {
+        for (int m = 0; m < 4; m++) {
+            test_image_t img;
+            image_init(&img, sizes[z][0], sizes[z][1], si < 3, z * 7 + si);
+            color_convert_cfg_t cfg = {
+                .from = src_fmts[si],
+                .to = dst_fmts[di],
+                .width = sizes[z][0],
+                .height = sizes[z][1],
+                .matrix = (m & 1) ? COLOR_CONVERT_MATRIX_BT709 : COLOR_CONVERT_MATRIX_BT601,
+                .full_range = (m & 2) != 0,
+            };
+            int size = 0;
+            uint8_t *out = convert_image(&img, &cfg, &size, false);
+            TEST_CHECK(out, "%s -> %s %dx%d convert failed", src_names[si], dst_names[di], cfg.width, cfg.height);
+            for (int r = 0; out && r < img.height; r++) {
+                for (int c = 0; c < img.width; c++) {
+                    int rgb[3];
+                    ref_pixel(&img, cfg.matrix, cfg.full_range, r, c, rgb);
+                    int err = pixel_err(cfg.to, out, r * img.width + c, rgb);
+                    if (err > worst) {
+                        worst = err;
+                    }
+                }
+            }
+            free(out);
+            image_deinit(&img);
+        }
+    }
+    TEST_CHECK(worst <= MAX_ERR_LSB, "%s -> %s max error %d LSB", src_names[si], dst_names[di], worst);
+}
+
+static void check_unsupported(void)
+{
+    static const av_render_video_frame_type_t pairs[][2] = {
+        { AV_RENDER_VIDEO_RAW_TYPE_RGB565, AV_RENDER_VIDEO_RAW_TYPE_RGB888 },
+        { AV_RENDER_VIDEO_RAW_TYPE_YUV420, AV_RENDER_VIDEO_RAW_TYPE_NV12 },
+        { AV_RENDER_VIDEO_RAW_TYPE_NONE, AV_RENDER_VIDEO_RAW_TYPE_RGB565 },
+        { AV_RENDER_VIDEO_RAW_TYPE_MAX, AV_RENDER_VIDEO_RAW_TYPE_RGB565 },
+    };
+    for (int i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        color_convert_cfg_t cfg = { .from = pairs[i][0], .to = pairs[i][1], .width = 16, .height = 16 };
+        TEST_CHECK(convert_table_is_supported(cfg.from, cfg.to) == false, "Pair %d reported supported", i);
+        TEST_CHECK(init_convert_table(&cfg) == NULL, "Pair %d accepted", i);
+    }
+    TEST_CHECK(convert_color(NULL, NULL, 0, NULL, 0) != 0, "Convert without table succeeded");
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    for (int si = 0; si < SRC_NUM; si++) {
+        for (int di = 0; di < DST_NUM; di++) {
+            TEST_CHECK(convert_table_is_supported(src_fmts[si], dst_fmts[di]), "%s -> %s not supported",
+                       src_names[si], dst_names[di]);
+            check_golden(si, di);
+            check_reference(si, di);
+        }
+    }
+    check_unsupported();
+    return TEST_RESULT();
+}
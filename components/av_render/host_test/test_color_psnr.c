@@ -0,0 +1,184 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Color convert accuracy against double precision reference
+ *
+ * Reference computes each pixel from Kr/Kb in double and quantizes to RGB565 the same way as converter
+ * PSNR over 8 bit expanded channels must stay high for BT.601 and BT.709, limited and full range, both byte orders
+ * Odd sizes and row band workers are also covered, workers must give same output as single thread
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "media_lib_adapter.h"
+#include "color_convert.h"
+#include "host_test.h"
+
+#define MIN_PSNR_DB  (60.0)
+#define MAX_WORKER   (4)
+
+typedef struct {
+    int width;
+    int height;
+} test_size_t;
+
+static const test_size_t test_sizes[] = {
+    { 64, 48 },
+    { 33, 17 },
+};
+
+static void fill_image(uint8_t *src, int width, int height, bool noise, unsigned seed)
+{
+    int cw = (width + 1) >> 1;
+    int ch = (height + 1) >> 1;
+    uint8_t *u = src + width * height;
+    uint8_t *v = u + cw * ch;
+    for (int i = 0; i < width * height; i++) {
+        src[i] = noise ? (uint8_t)rand_r(&seed) : (uint8_t)((i % width) * 255 / (width - 1));
+    }
+    for (int i = 0; i < cw * ch; i++) {
+        // Ramp goes through whole chroma range along rows so that clipping is covered
+        u[i] = noise ? (uint8_t)rand_r(&seed) : (uint8_t)((i / cw) * 255 / (ch - 1));
+        v[i] = noise ? (uint8_t)rand_r(&seed) : (uint8_t)(255 - (i % cw) * 255 / (cw - 1));
+    }
+}
+
+static int ref_channel(double a)
+{
+    a = floor(a + 0.5);
+    return a < 0 ? 0 : a > 255 ? 255 : (int)a;
+}
+
+static void ref_pixel(color_convert_matrix_t matrix, bool full_range, int y, int u, int v, int rgb[3])
+{
+    double kr = 0.299, kb = 0.114;
+    if (matrix == COLOR_CONVERT_MATRIX_BT709) {
+        kr = 0.2126;
+        kb = 0.0722;
+    }
+    double kg = 1.0 - kr - kb;
+    double l = y, cb = u - 128.0, cr = v - 128.0;
+    if (full_range == false) {
+        l = (y - 16.0) * 255.0 / 219.0;
+        cb *= 255.0 / 224.0;
+        cr *= 255.0 / 224.0;
+    }
+    rgb[0] = ref_channel(l + 2.0 * (1.0 - kr) * cr);
+    rgb[1] = ref_channel(l - 2.0 * kb * (1.0 - kb) / kg * cb - 2.0 * kr * (1.0 - kr) / kg * cr);
+    rgb[2] = ref_channel(l + 2.0 * (1.0 - kb) * cb);
+}
+
+static double calc_psnr(color_convert_cfg_t *cfg, uint8_t *src, uint16_t *dst)
+{
+    int width = cfg->width, height = cfg->height;
+    int cw = (width + 1) >> 1;
+    uint8_t *u = src + width * height;
+    uint8_t *v = u + cw * ((height + 1) >> 1);
+    double sse = 0;
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            int c = (row >> 1) * cw + (col >> 1);
+            int ref[3];
+            ref_pixel(cfg->matrix, cfg->full_range, src[row * width + col], u[c], v[c], ref);
+            uint16_t p = dst[row * width + col];
+            if (cfg->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) {
+                p = (uint16_t)((p >> 8) | (p << 8));
+            }
+            int out[3] = { (p >> 11) << 3, ((p >> 5) & 0x3F) << 2, (p & 0x1F) << 3 };
+            ref[0] &= ~7;
+            ref[1] &= ~3;
+            ref[2] &= ~7;
+            for (int i = 0; i < 3; i++) {
+                sse += (double)(out[i] - ref[i]) * (out[i] - ref[i]);
+            }
+        }
+    }
+    if (sse == 0) {
+        return INFINITY;
+    }
+    return 10.0 * log10(255.0 * 255.0 * width * height * 3 / sse);
+}
+
+static void check_case(color_convert_cfg_t *cfg, bool noise)
+{
+    int src_size = convert_table_get_image_size(AV_RENDER_VIDEO_RAW_TYPE_YUV420, cfg->width, cfg->height);
+    int dst_size = convert_table_get_image_size(cfg->to, cfg->width, cfg->height);
+    uint8_t *src = (uint8_t *)malloc(src_size);
+    uint16_t *dst = (uint16_t *)malloc(dst_size);
+    uint16_t *band_dst = (uint16_t *)malloc(dst_size);
+    fill_image(src, cfg->width, cfg->height, noise, 1234);
+
+    cfg->worker_num = 1;
+    color_convert_table_t table = init_convert_table(cfg);
+    TEST_CHECK(table, "init convert");
+    if (table) {
+        TEST_CHECK(convert_color(table, src, src_size, (uint8_t *)dst, dst_size) == 0, "convert");
+        deinit_convert_table(table);
+    }
+    double psnr = calc_psnr(cfg, src, dst);
+    printf("%s %s %s %dx%d %s: PSNR %.1f dB\n", cfg->matrix == COLOR_CONVERT_MATRIX_BT709 ? "BT709" : "BT601",
+           cfg->full_range ? "full" : "limited", cfg->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE ? "BE" : "LE",
+           cfg->width, cfg->height, noise ? "noise" : "ramp", psnr);
+    TEST_CHECK(psnr >= MIN_PSNR_DB, "PSNR %.1f dB too low", psnr);
+
+    // Row bands must not change output
+    cfg->worker_num = MAX_WORKER;
+    table = init_convert_table(cfg);
+    TEST_CHECK(table, "init convert with workers");
+    if (table) {
+        memset(band_dst, 0, dst_size);
+        convert_color(table, src, src_size, (uint8_t *)band_dst, dst_size);
+        TEST_CHECK(memcmp(dst, band_dst, dst_size) == 0, "%d workers output differs", MAX_WORKER);
+        deinit_convert_table(table);
+    }
+    free(src);
+    free(dst);
+    free(band_dst);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    for (int s = 0; s < sizeof(test_sizes) / sizeof(test_sizes[0]); s++) {
+        for (int m = COLOR_CONVERT_MATRIX_BT601; m <= COLOR_CONVERT_MATRIX_BT709; m++) {
+            for (int full = 0; full < 2; full++) {
+                for (int be = 0; be < 2; be++) {
+                    for (int noise = 0; noise < 2; noise++) {
+                        color_convert_cfg_t cfg = {
+                            .from = AV_RENDER_VIDEO_RAW_TYPE_YUV420,
+                            .to = be ? AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE : AV_RENDER_VIDEO_RAW_TYPE_RGB565,
+                            .width = test_sizes[s].width,
+                            .height = test_sizes[s].height,
+                            .matrix = (color_convert_matrix_t)m,
+                            .full_range = full,
+                        };
+                        check_case(&cfg, noise);
+                    }
+                }
+            }
+        }
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,284 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Color convert with scale, rotate and mirror against double precision reference
+ *
+ * Reference maps each output pixel back to source (mirror first, then clockwise rotation, then scale with pixel
+ * centers aligned), samples in double and converts to RGB888
+ * Nearest must be within 1 LSB and bilinear within 3 LSB per channel, row band workers must not change output
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "media_lib_adapter.h"
+#include "color_convert.h"
+#include "host_test.h"
+
+#define NEAREST_MAX_ERR  (1)
+#define BILINEAR_MAX_ERR (3)
+#define BAND_WORKER      (3)
+
+typedef struct {
+    int width;
+    int height;
+} test_size_t;
+
+static const test_size_t src_sizes[] = { { 64, 48 }, { 33, 17 }, { 50, 30 } };
+/* Output size after rotation, 0 keeps rotated source size */
+static const test_size_t out_sizes[] = { { 0, 0 }, { 32, 24 }, { 80, 60 }, { 17, 9 } };
+
+typedef struct {
+    int      width;
+    int      height;
+    int      v_shift; /* Chroma vertical subsampling shift */
+    uint8_t *y;
+    uint8_t *u;
+    uint8_t *v;
+} ref_image_t;
+
+static double ref_sample(const uint8_t *plane, int stride, int w, int h, double x, double y, bool bilinear)
+{
+    if (bilinear == false) {
+        return plane[(int)y * stride + (int)x];
+    }
+    int xi = (int)x, yi = (int)y;
+    double fx = x - xi, fy = y - yi;
+    int xn = xi < w - 1 ? xi + 1 : xi;
+    int yn = yi < h - 1 ? yi + 1 : yi;
+    double top = plane[yi * stride + xi] * (1 - fx) + plane[yi * stride + xn] * fx;
+    double bottom = plane[yn * stride + xi] * (1 - fx) + plane[yn * stride + xn] * fx;
+    return top * (1 - fy) + bottom * fy;
+}
+
+/* Source position of output index k, pixel centers aligned */
+static double ref_pos(int k, int out_len, int src_len, bool bilinear)
+{
+    if (bilinear == false) {
+        return floor((k + 0.5) * src_len / out_len);
+    }
+    double pos = (k + 0.5) * src_len / out_len - 0.5;
+    return pos < 0 ? 0 : pos > src_len - 1 ? src_len - 1 : pos;
+}
+
+static int ref_clamp(double a)
+{
+    a = floor(a + 0.5);
+    return a < 0 ? 0 : a > 255 ? 255 : (int)a;
+}
+
+static void ref_pixel(ref_image_t *img, av_render_video_transform_t *t, int out_w, int out_h, int ox, int oy,
+                      uint8_t rgb[3])
+{
+    int w = img->width, h = img->height;
+    // Without any transform convert keeps plain path, chroma is not filtered
+    bool plain = (t->rotate == AV_RENDER_VIDEO_ROTATE_NONE && t->mirror == false && out_w == w && out_h == h);
+    bool bilinear = (t->scale == AV_RENDER_VIDEO_SCALE_BILINEAR && plain == false);
+    // Mirrored source M(x, y) = S(w - 1 - x, y), then output R(x', y') read M rotated clockwise:
+    //   0: M(x', y')  90: M(y', h - 1 - x')  180: M(w - 1 - x', h - 1 - y')  270: M(w - 1 - y', x')
+    // Reversing index keeps pixel center aligned position symmetric, so the axis is scaled after reverse
+    int kx = ox, ky = oy, nx = out_w, ny = out_h;
+    bool rev_x = false, rev_y = false;
+    switch (t->rotate) {
+        default:
+        case AV_RENDER_VIDEO_ROTATE_NONE:
+            rev_x = t->mirror;
+            break;
+        case AV_RENDER_VIDEO_ROTATE_90:
+            kx = oy, nx = out_h, ky = ox, ny = out_w;
+            rev_x = t->mirror;
+            rev_y = true;
+            break;
+        case AV_RENDER_VIDEO_ROTATE_180:
+            rev_x = !t->mirror;
+            rev_y = true;
+            break;
+        case AV_RENDER_VIDEO_ROTATE_270:
+            kx = oy, nx = out_h, ky = ox, ny = out_w;
+            rev_x = !t->mirror;
+            break;
+    }
+    double x = ref_pos(rev_x ? nx - 1 - kx : kx, nx, w, bilinear);
+    double y = ref_pos(rev_y ? ny - 1 - ky : ky, ny, h, bilinear);
+    int cw = (w + 1) >> 1;
+    int ch = (h + img->v_shift) >> img->v_shift;
+    double cx, cy;
+    if (bilinear) {
+        cx = x / 2 - 0.25;
+        cy = img->v_shift ? y / 2 - 0.25 : y;
+        cx = cx < 0 ? 0 : cx;
+        cy = cy < 0 ? 0 : cy;
+    } else {
+        cx = (int)x >> 1;
+        cy = (int)y >> img->v_shift;
+    }
+    double l = ref_sample(img->y, w, w, h, x, y, bilinear);
+    double du = ref_sample(img->u, cw, cw, ch, cx, cy, bilinear) - 128;
+    double dv = ref_sample(img->v, cw, cw, ch, cx, cy, bilinear) - 128;
+    // BT.601 full range
+    double kr = 0.299, kb = 0.114, kg = 1.0 - kr - kb;
+    rgb[0] = ref_clamp(l + 2.0 * (1.0 - kr) * dv);
+    rgb[1] = ref_clamp(l - 2.0 * kb * (1.0 - kb) / kg * du - 2.0 * kr * (1.0 - kr) / kg * dv);
+    rgb[2] = ref_clamp(l + 2.0 * (1.0 - kb) * du);
+}
+
+static void image_init(ref_image_t *img, int width, int height, int v_shift, unsigned seed, uint8_t *buf)
+{
+    int cw = (width + 1) >> 1;
+    int ch = (height + v_shift) >> v_shift;
+    img->width = width;
+    img->height = height;
+    img->v_shift = v_shift;
+    img->y = buf;
+    img->u = buf + width * height;
+    img->v = img->u + cw * ch;
+    // Smooth gradient with noise so that both filters and clipping are covered
+    for (int i = 0; i < width * height; i++) {
+        img->y[i] = (uint8_t)((i % width) * 200 / width + (i / width) * 40 / height + (rand_r(&seed) & 0xF));
+    }
+    for (int i = 0; i < cw * ch; i++) {
+        img->u[i] = (uint8_t)rand_r(&seed);
+        img->v[i] = (uint8_t)((i % cw) * 255 / cw);
+    }
+}
+
+static int convert_once(color_convert_cfg_t *cfg, uint8_t *src, int src_size, uint8_t *dst, int dst_size)
+{
+    color_convert_table_t table = init_convert_table(cfg);
+    if (table == NULL) {
+        return -1;
+    }
+    int ret = convert_color(table, src, src_size, dst, dst_size);
+    deinit_convert_table(table);
+    return ret;
+}
+
+static void check_transform(av_render_video_frame_type_t from, int width, int height,
+                            av_render_video_transform_t *t)
+{
+    int v_shift = (from == AV_RENDER_VIDEO_RAW_TYPE_YUV420) ? 1 : 0;
+    color_convert_cfg_t cfg = {
+        .from = from,
+        .to = AV_RENDER_VIDEO_RAW_TYPE_RGB888,
+        .width = width,
+        .height = height,
+        .full_range = true,
+        .transform = *t,
+    };
+    int out_w, out_h;
+    convert_table_get_output_size(&cfg, &out_w, &out_h);
+    int src_size = convert_table_get_image_size(from, width, height);
+    int dst_size = out_w * out_h * 3;
+    uint8_t *src = (uint8_t *)malloc(src_size);
+    uint8_t *dst = (uint8_t *)malloc(dst_size);
+    uint8_t *band_dst = (uint8_t *)malloc(dst_size);
+    ref_image_t img;
+    image_init(&img, width, height, v_shift, width * 131 + height, src);
+
+    TEST_CHECK(convert_once(&cfg, src, src_size, dst, dst_size) == 0, "convert %dx%d", width, height);
+    int max_err = 0;
+    for (int oy = 0; oy < out_h; oy++) {
+        for (int ox = 0; ox < out_w; ox++) {
+            uint8_t ref[3];
+            ref_pixel(&img, t, out_w, out_h, ox, oy, ref);
+            uint8_t *out = dst + (oy * out_w + ox) * 3;
+            for (int c = 0; c < 3; c++) {
+                int err = abs(out[c] - ref[c]);
+                max_err = err > max_err ? err : max_err;
+            }
+        }
+    }
+    int limit = (t->scale == AV_RENDER_VIDEO_SCALE_BILINEAR) ? BILINEAR_MAX_ERR : NEAREST_MAX_ERR;
+    TEST_CHECK(max_err <= limit, "%s %dx%d to %dx%d rotate %d mirror %d scale %d: error %d",
+               v_shift ? "YUV420" : "YUV422", width, height, out_w, out_h, t->rotate * 90, t->mirror, t->scale,
+               max_err);
+
+    cfg.worker_num = BAND_WORKER;
+    memset(band_dst, 0, dst_size);
+    convert_once(&cfg, src, src_size, band_dst, dst_size);
+    TEST_CHECK(memcmp(dst, band_dst, dst_size) == 0, "%dx%d to %dx%d rotate %d: workers change output",
+               width, height, out_w, out_h, t->rotate * 90);
+    free(src);
+    free(dst);
+    free(band_dst);
+}
+
+static void check_rotate_direction(void)
+{
+    // 2x2 luma only image: A B / C D, rotate 90 clockwise gives C A / D B
+    uint8_t src[] = { 10, 20, 30, 40, 128, 128 };
+    uint8_t dst[12];
+    static const uint8_t expect[4][4] = {
+        { 10, 20, 30, 40 },
+        { 30, 10, 40, 20 },
+        { 40, 30, 20, 10 },
+        { 20, 40, 10, 30 },
+    };
+    for (int r = AV_RENDER_VIDEO_ROTATE_NONE; r <= AV_RENDER_VIDEO_ROTATE_270; r++) {
+        color_convert_cfg_t cfg = {
+            .from = AV_RENDER_VIDEO_RAW_TYPE_YUV420,
+            .to = AV_RENDER_VIDEO_RAW_TYPE_RGB888,
+            .width = 2,
+            .height = 2,
+            .full_range = true,
+            .transform = { .rotate = (av_render_video_rotate_t)r },
+        };
+        TEST_CHECK(convert_once(&cfg, src, sizeof(src), dst, sizeof(dst)) == 0, "convert 2x2");
+        for (int i = 0; i < 4; i++) {
+            TEST_CHECK(dst[i * 3] == expect[r][i], "rotate %d pixel %d is %d expect %d", r * 90, i, dst[i * 3],
+                       expect[r][i]);
+        }
+    }
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    check_rotate_direction();
+    static const av_render_video_frame_type_t fmts[] = {
+        AV_RENDER_VIDEO_RAW_TYPE_YUV420,
+        AV_RENDER_VIDEO_RAW_TYPE_YUV422,
+    };
+    for (int f = 0; f < sizeof(fmts) / sizeof(fmts[0]); f++) {
+        for (int s = 0; s < sizeof(src_sizes) / sizeof(src_sizes[0]); s++) {
+            for (int o = 0; o < sizeof(out_sizes) / sizeof(out_sizes[0]); o++) {
+                for (int r = AV_RENDER_VIDEO_ROTATE_NONE; r <= AV_RENDER_VIDEO_ROTATE_270; r++) {
+                    for (int m = 0; m < 2; m++) {
+                        for (int sc = AV_RENDER_VIDEO_SCALE_NEAREST; sc <= AV_RENDER_VIDEO_SCALE_BILINEAR; sc++) {
+                            av_render_video_transform_t t = {
+                                .width = out_sizes[o].width,
+                                .height = out_sizes[o].height,
+                                .rotate = (av_render_video_rotate_t)r,
+                                .mirror = m,
+                                .scale = (av_render_video_scale_t)sc,
+                            };
+                            check_transform(fmts[f], src_sizes[s].width, src_sizes[s].height, &t);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return TEST_RESULT();
+}
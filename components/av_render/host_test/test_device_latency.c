@@ -0,0 +1,178 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Latency reported by i2s_render and lcd_render against simulated devices
+ *
+ * Codec is DMA ring of 6 descriptors of 240 samples drained in virtual time, write blocks while full
+ * Audio is written in burst, at real time pace with jitter, after underrun, on refill and with 1.25x time stretch
+ * and latency is queried at random points, it must stay within one descriptor of true queued time
+ * DSI panel transfer takes 12ms, video latency must match rest of transfer plus one refresh period
+ */
+
+#include <stdlib.h>
+#include "media_lib_adapter.h"
+#include "av_render_default.h"
+#include "sim_render.h"
+#include "sim_device.h"
+#include "host_test.h"
+
+#define SAMPLE_RATE      (16000)
+#define FRAME_MS         (20)
+#define MAX_AUDIO_ERR_MS (16)
+#define MAX_VIDEO_ERR_MS (2)
+#define REFRESH_RATE     (50)
+
+typedef struct {
+    audio_render_handle_t render;
+    float                 speed;
+    const char           *phase;
+    int                   check_num;
+    int                   max_err;
+    int                   max_depth;
+    int                   fail_num;
+} audio_check_t;
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+}
+
+static void check_audio(audio_check_t *c)
+{
+    uint32_t latency = 0;
+    audio_render_get_latency(c->render, &latency);
+    int64_t truth_us = sim_device_audio_queued() +
+                       (int64_t)(sim_device_sonic_pending() / c->speed) * 1000000 / SAMPLE_RATE;
+    int truth = (int)(truth_us / 1000);
+    int err = abs((int)latency - truth);
+    c->check_num++;
+    c->max_err = err > c->max_err ? err : c->max_err;
+    // Previous render always reported 0
+    c->max_depth = truth > c->max_depth ? truth : c->max_depth;
+    if (err > MAX_AUDIO_ERR_MS) {
+        if (c->fail_num++ < 10) {
+            printf("  %s: reported %d ms true %d ms\n", c->phase, (int)latency, truth);
+        }
+    }
+}
+
+// Query at random points while time passes
+static void pass_time(audio_check_t *c, int us)
+{
+    while (us > 0) {
+        int step = 300 + rand() % 2000;
+        step = step > us ? us : step;
+        sim_device_advance(step);
+        us -= step;
+        check_audio(c);
+    }
+}
+
+static void play(audio_check_t *c, const char *phase, int frames, int gap_us)
+{
+    static uint8_t pcm[SAMPLE_RATE * FRAME_MS / 1000 * 2];
+    av_render_audio_frame_t frame = { .data = pcm, .size = sizeof(pcm) };
+    c->phase = phase;
+    for (int i = 0; i < frames; i++) {
+        audio_render_write(c->render, &frame);
+        check_audio(c);
+        if (gap_us) {
+            pass_time(c, gap_us + rand() % 3000);
+        }
+    }
+}
+
+static void check_i2s_latency(uint32_t dma_samples)
+{
+    i2s_render_cfg_t cfg = {
+        .play_handle = (esp_codec_dev_handle_t)1,
+        .dma_samples = dma_samples,
+    };
+    audio_check_t c = { .speed = 1.0f };
+    c.render = av_render_alloc_i2s_render(&cfg);
+    av_render_audio_frame_info_t info = { .sample_rate = SAMPLE_RATE, .channel = 1, .bits_per_sample = 16 };
+    audio_render_open(c.render, &info);
+    // Burst fills DMA and write blocks
+    play(&c, "burst", 30, 0);
+    play(&c, "pace", 100, 17000);
+    c.phase = "underrun";
+    pass_time(&c, 200000);
+    play(&c, "refill", 50, 15000);
+    c.speed = 1.25f;
+    audio_render_set_speed(c.render, c.speed);
+    play(&c, "stretch", 100, 0);
+    c.phase = "drain";
+    pass_time(&c, 150000);
+    printf("Audio dma_samples %u: %d checks, max error %d ms, true depth up to %d ms\n", (unsigned)dma_samples,
+           c.check_num, c.max_err, c.max_depth);
+    TEST_CHECK(c.fail_num == 0, "%d checks over %d ms", c.fail_num, MAX_AUDIO_ERR_MS);
+    audio_render_close(c.render);
+    audio_render_free_handle(c.render);
+}
+
+static void check_lcd_latency(void)
+{
+    lcd_render_cfg_t cfg = {
+        .lcd_handle = (esp_lcd_panel_handle_t)1,
+        .dsi_panel = true,
+        .refresh_rate = REFRESH_RATE,
+    };
+    video_render_handle_t render = av_render_alloc_lcd_render(&cfg);
+    av_render_video_frame_info_t info = { .type = AV_RENDER_VIDEO_RAW_TYPE_RGB565, .width = 16, .height = 16 };
+    video_render_open(render, &info);
+    static uint8_t rgb[16 * 16 * 2];
+    av_render_video_frame_t frame = { .data = rgb, .size = sizeof(rgb) };
+    int max_err = 0, fail_num = 0, check_num = 0;
+    for (int i = 0; i < 200; i++) {
+        video_render_write(render, &frame);
+        for (int k = 0; k < 4; k++) {
+            sim_device_advance(rand() % 8000);
+            uint32_t latency = 0;
+            video_render_get_latency(render, &latency);
+            int truth = (int)((sim_device_draw_pending() + 1000000 / REFRESH_RATE) / 1000);
+            int err = abs((int)latency - truth);
+            // Transfer time is learned from first frames
+            if (i < 8) {
+                continue;
+            }
+            check_num++;
+            max_err = err > max_err ? err : max_err;
+            fail_num += err > MAX_VIDEO_ERR_MS;
+        }
+    }
+    printf("Video DSI: %d checks, max error %d ms\n", check_num, max_err);
+    TEST_CHECK(fail_num == 0, "%d checks over %d ms", fail_num, MAX_VIDEO_ERR_MS);
+    video_render_close(render);
+    video_render_free_handle(render);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    sim_clock_use_virtual(true);
+    check_i2s_latency(6 * 240);
+    // Use default DMA size
+    check_i2s_latency(0);
+    check_lcd_latency();
+    return TEST_RESULT();
+}
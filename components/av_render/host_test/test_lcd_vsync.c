@@ -0,0 +1,153 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+/* Frame buffer present of lcd_render on simulated 60Hz DSI panel with 2 and 3 frame buffers
+ *
+ * Decoder fills frame buffer got from render for random decode time, panel switches scan out to submitted buffer
+ * on refresh, frame is torn when buffer being filled is scanned out at any time during decode
+ * 60fps source with 2-25ms decode checks tearing and decoder blocking, 25fps source checks present cadence
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "media_lib_adapter.h"
+#include "av_render_default.h"
+#include "sim_render.h"
+#include "sim_device.h"
+#include "host_test.h"
+
+#define WIDTH        (64)
+#define HEIGHT       (48)
+#define REFRESH_RATE (60)
+#define FRAME_NUM    (300)
+
+typedef struct {
+    int      torn_num;
+    int64_t  blocked_us;
+    int64_t  max_blocked_us;
+    uint32_t present_num;
+    uint32_t drop_num;
+    uint32_t interval_us;
+    uint32_t jitter_us;
+} present_result_t;
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+}
+
+static void run_present(uint8_t fb_num, int fps, int min_decode_ms, int max_decode_ms, present_result_t *res)
+{
+    sim_device_cfg_t dev_cfg = {
+        .dma_samples = 6 * 240,
+        .desc_samples = 240,
+        .draw_us = 12000,
+        .fb_num = 3,
+        .fb_size = WIDTH * HEIGHT * 2,
+        .refresh_us = 1000000 / REFRESH_RATE,
+    };
+    sim_device_set_cfg(&dev_cfg);
+    lcd_render_cfg_t cfg = {
+        .lcd_handle = (esp_lcd_panel_handle_t)1,
+        .dsi_panel = true,
+        .use_frame_buffer = true,
+        .fb_num = fb_num,
+        .refresh_rate = REFRESH_RATE,
+    };
+    video_render_handle_t render = av_render_alloc_lcd_render(&cfg);
+    av_render_video_frame_info_t info = { .type = AV_RENDER_VIDEO_RAW_TYPE_RGB565, .width = WIDTH, .height = HEIGHT };
+    video_render_open(render, &info);
+    memset(res, 0, sizeof(present_result_t));
+    int64_t start = sim_clock_now();
+    for (int i = 0; i < FRAME_NUM; i++) {
+        int64_t due = start + (int64_t)i * 1000000 / fps;
+        if (sim_clock_now() < due) {
+            sim_device_advance(due - sim_clock_now());
+        }
+        int64_t get_start = sim_clock_now();
+        av_render_frame_buffer_t fb = {};
+        if (video_render_get_frame_buffer(render, &fb) != 0) {
+            break;
+        }
+        int64_t blocked = sim_clock_now() - get_start;
+        res->blocked_us += blocked;
+        res->max_blocked_us = blocked > res->max_blocked_us ? blocked : res->max_blocked_us;
+        // Decoder writes into buffer all through decode time
+        int decode_ms = min_decode_ms + rand() % (max_decode_ms - min_decode_ms + 1);
+        bool torn = (sim_device_scan_out() == fb.data);
+        for (int ms = 0; ms < decode_ms; ms++) {
+            memset(fb.data, i, fb.size);
+            sim_device_advance(1000);
+            torn |= (sim_device_scan_out() == fb.data);
+        }
+        res->torn_num += torn;
+        av_render_video_frame_t frame = { .data = fb.data, .size = fb.size, .pts = i * 1000 / fps };
+        video_render_write(render, &frame);
+    }
+    sim_device_advance(100000);
+    video_render_stats_t stats = {};
+    video_render_get_stats(render, &stats);
+    res->present_num = stats.present_num;
+    res->drop_num = stats.drop_num;
+    res->interval_us = stats.interval_us;
+    res->jitter_us = stats.jitter_us;
+    video_render_close(render);
+    video_render_free_handle(render);
+}
+
+static void print_result(const char *name, present_result_t *res)
+{
+    printf("%s: torn %d, blocked %.1f ms per frame (max %.1f ms), shown %u, dropped %u, interval %.1f ms, "
+           "jitter %.1f ms\n",
+           name, res->torn_num, res->blocked_us / 1000.0 / FRAME_NUM, res->max_blocked_us / 1000.0,
+           (unsigned)res->present_num, (unsigned)res->drop_num, res->interval_us / 1000.0, res->jitter_us / 1000.0);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    sim_clock_use_virtual(true);
+    present_result_t res;
+    // Decode slower than refresh for some frames
+    run_present(2, 60, 2, 25, &res);
+    print_result("2 buffers 60fps", &res);
+    TEST_CHECK(res.torn_num == 0, "%d frames torn with 2 buffers", res.torn_num);
+    TEST_CHECK(res.present_num + res.drop_num >= FRAME_NUM - 1, "%u shown %u dropped of %d",
+               (unsigned)res.present_num, (unsigned)res.drop_num, FRAME_NUM);
+    int64_t double_blocked = res.blocked_us;
+
+    run_present(3, 60, 2, 25, &res);
+    print_result("3 buffers 60fps", &res);
+    TEST_CHECK(res.torn_num == 0, "%d frames torn with 3 buffers", res.torn_num);
+    TEST_CHECK(res.blocked_us * 4 < double_blocked, "3 buffers blocked %.1f ms against %.1f ms of 2 buffers",
+               res.blocked_us / 1000.0, double_blocked / 1000.0);
+
+    // Every frame shown, 40ms source on 16.7ms refresh alternates 2 and 3 refresh periods
+    run_present(3, 25, 2, 10, &res);
+    print_result("3 buffers 25fps", &res);
+    TEST_CHECK(res.torn_num == 0 && res.drop_num == 0, "%d torn %u dropped at 25fps", res.torn_num,
+               (unsigned)res.drop_num);
+    TEST_CHECK(abs((int)res.interval_us - 40000) < 1000, "interval %u us", (unsigned)res.interval_us);
+    return TEST_RESULT();
+}
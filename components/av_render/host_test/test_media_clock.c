@@ -0,0 +1,123 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Lip-sync of video following media clock while audio device drifts
+ *
+ * Audio device plays with injected drift against system clock, position is fed once per 20 ms frame write
+ * with 0-3 ms scheduling noise. 30 fps video is presented when media clock reach its PTS
+ * Lip-sync error is video PTS minus audible audio position at present time, it must stay within 40 ms
+ * for one hour of play and come back within 40 ms shortly after audio device stalls
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "media_lib_adapter.h"
+#include "media_clock.h"
+#include "host_test.h"
+
+#define PLAY_MS           (3600 * 1000)
+#define SETTLE_MS         (2000)
+#define AUDIO_FRAME_MS    (20)
+#define VIDEO_FRAME_MS    (33)
+#define LIP_SYNC_LIMIT_MS (40)
+#define DRIFT_ERR_PPM     (60)
+#define STALL_PERIOD_MS   (600000)
+#define STALL_START_MS    (300000)
+#define STALL_MS          (300)
+#define RECOVER_MS        (1000)
+
+typedef struct {
+    double max_err;
+    double sum_err;
+    int    frames;
+} lip_sync_result_t;
+
+/* Position in stall period, negative when not in stall or recovery window */
+static int stall_phase(uint32_t elapsed)
+{
+    int phase = (int)(elapsed % STALL_PERIOD_MS) - STALL_START_MS;
+    return (phase > 0 && phase < STALL_MS + RECOVER_MS) ? phase : -1;
+}
+
+static void run_play(double drift_ppm, bool stall, unsigned seed)
+{
+    media_clock_handle_t clk = media_clock_open(NULL);
+    TEST_CHECK(clk, "Fail to open clock");
+    if (clk == NULL) {
+        return;
+    }
+    lip_sync_result_t res = { 0 };
+    double audio_pos = 0;
+    double rate = 1 + drift_ppm * 1e-6;
+    uint32_t next_audio = 0;
+    uint32_t video_pts = 0;
+    uint32_t start = 1000;
+    for (uint32_t now = start; now < start + PLAY_MS; now++) {
+        uint32_t elapsed = now - start;
+        bool in_stall = stall && stall_phase(elapsed) >= 0 && stall_phase(elapsed) < STALL_MS;
+        if (in_stall == false) {
+            audio_pos += rate;
+        }
+        if (audio_pos >= next_audio) {
+            media_clock_sync(clk, now + rand_r(&seed) % 4, (uint32_t)audio_pos);
+            next_audio += AUDIO_FRAME_MS;
+        }
+        if (media_clock_started(clk) == false || media_clock_get(clk, now) < video_pts) {
+            continue;
+        }
+        double err = video_pts - audio_pos;
+        video_pts += VIDEO_FRAME_MS;
+        // Skip start up and stall recovery, stall only checks that clock comes back
+        if (elapsed < SETTLE_MS || (stall && stall_phase(elapsed) >= 0)) {
+            continue;
+        }
+        if (fabs(err) > res.max_err) {
+            res.max_err = fabs(err);
+        }
+        res.sum_err += err;
+        res.frames++;
+    }
+    media_clock_stats_t stats;
+    media_clock_get_stats(clk, &stats);
+    printf("Drift %+5.0f ppm%s: max lip-sync %.1f ms mean %+.2f ms, estimated drift %+d ppm resync %u\n",
+           drift_ppm, stall ? " with stall" : "", res.max_err, res.sum_err / res.frames, (int)stats.drift_ppm,
+           (unsigned)stats.resync_num);
+    TEST_CHECK(res.frames > PLAY_MS / VIDEO_FRAME_MS * 9 / 10, "Only %d frames presented", res.frames);
+    TEST_CHECK(res.max_err <= LIP_SYNC_LIMIT_MS, "Drift %.0f ppm lip-sync error %.1f ms", drift_ppm, res.max_err);
+    TEST_CHECK(fabs(stats.drift_ppm - drift_ppm) <= DRIFT_ERR_PPM, "Drift %.0f ppm estimated as %d ppm",
+               drift_ppm, (int)stats.drift_ppm);
+    media_clock_close(clk);
+}
+
+int main(void)
+{
+    static const double drifts[] = { -500, -100, 0, 100, 500 };
+    media_lib_add_default_adapter();
+    for (int i = 0; i < sizeof(drifts) / sizeof(drifts[0]); i++) {
+        run_play(drifts[i], false, 7 + i);
+    }
+    run_play(500, true, 3);
+    run_play(-500, true, 4);
+    return TEST_RESULT();
+}
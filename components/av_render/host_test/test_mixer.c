@@ -0,0 +1,275 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Audio mixer with real time output
+ *
+ * Output device holds 60 ms and drains in real time, written samples are captured. Checks that single source is
+ * written without copy, prompt ducks call audio to its duck gain, paced sources mix without underrun and mixed
+ * samples saturate instead of wrap
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "esp_timer.h"
+#include "av_render_mixer.h"
+#include "sim_render.h"
+#include "host_test.h"
+
+#define SAMPLE_RATE    (16000)
+#define FRAME_SAMPLES  (SAMPLE_RATE / 50)
+#define OUT_BUFFER_US  (60000)
+#define PACED_LEAD     (2)
+#define CAPTURE_NUM    (SAMPLE_RATE * 10)
+
+typedef struct {
+    audio_render_handle_t render;
+    int16_t               value;
+    int                   frames;
+    bool                  paced; /* Write every 20 ms after PACED_LEAD frames like jitter buffer of live stream */
+    volatile bool         done;
+    int16_t               buf[FRAME_SAMPLES];
+    pthread_t             thread;
+} feeder_t;
+
+static int64_t        out_end_us;
+static int16_t        captured[CAPTURE_NUM];
+static int            captured_num;
+static int            write_num, direct_num;
+static int64_t        underrun_us;
+static const uint8_t *direct_lo, *direct_hi;
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+    // Simulated devices are not used
+}
+
+static audio_render_handle_t out_init(void *cfg, int size)
+{
+    return (audio_render_handle_t)captured;
+}
+
+static int out_open(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    out_end_us = esp_timer_get_time();
+    return 0;
+}
+
+static int out_write(audio_render_handle_t h, av_render_audio_frame_t *frame)
+{
+    int64_t now = esp_timer_get_time();
+    if (out_end_us < now) {
+        if (write_num) {
+            underrun_us += now - out_end_us;
+        }
+        out_end_us = now;
+    }
+    // Block while device is full
+    while (out_end_us - esp_timer_get_time() > OUT_BUFFER_US) {
+        usleep(1000);
+    }
+    out_end_us += (int64_t)frame->size / sizeof(int16_t) * 1000000 / SAMPLE_RATE;
+    if (frame->data >= direct_lo && frame->data < direct_hi) {
+        direct_num++;
+    }
+    write_num++;
+    int n = frame->size / sizeof(int16_t);
+    if (captured_num + n <= CAPTURE_NUM) {
+        memcpy(captured + captured_num, frame->data, frame->size);
+        captured_num += n;
+    }
+    return 0;
+}
+
+static int out_get_latency(audio_render_handle_t h, uint32_t *latency)
+{
+    int64_t left = out_end_us - esp_timer_get_time();
+    *latency = left > 0 ? (uint32_t)(left / 1000) : 0;
+    return 0;
+}
+
+static int out_get_frame_info(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    return 0;
+}
+
+static int out_set_speed(audio_render_handle_t h, float speed)
+{
+    return 0;
+}
+
+static int out_close(audio_render_handle_t h)
+{
+    return 0;
+}
+
+static void out_deinit(audio_render_handle_t h)
+{
+}
+
+static void *feed_thread(void *arg)
+{
+    feeder_t *f = (feeder_t *)arg;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < f->frames; i++) {
+        if (f->paced) {
+            int64_t wait = start + (int64_t)(i - PACED_LEAD) * 20000 - esp_timer_get_time();
+            if (wait > 0) {
+                usleep((useconds_t)wait);
+            }
+        }
+        for (int k = 0; k < FRAME_SAMPLES; k++) {
+            f->buf[k] = f->value;
+        }
+        av_render_audio_frame_t frame = { .data = (uint8_t *)f->buf, .size = sizeof(f->buf) };
+        audio_render_write(f->render, &frame);
+    }
+    f->done = true;
+    return NULL;
+}
+
+static void feed_start(feeder_t *f, int frames)
+{
+    f->frames = frames;
+    f->done = false;
+    pthread_create(&f->thread, NULL, feed_thread, f);
+}
+
+static void feed_wait(feeder_t *f)
+{
+    pthread_join(f->thread, NULL);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    sim_clock_use_virtual(false);
+    av_render_audio_frame_info_t fmt = { .sample_rate = SAMPLE_RATE, .channel = 1, .bits_per_sample = 16 };
+    audio_render_cfg_t out_cfg = {
+        .ops = {
+            .init = out_init,
+            .open = out_open,
+            .write = out_write,
+            .get_latency = out_get_latency,
+            .get_frame_info = out_get_frame_info,
+            .set_speed = out_set_speed,
+            .close = out_close,
+            .deinit = out_deinit,
+        },
+    };
+    audio_render_handle_t out = audio_render_alloc_handle(&out_cfg);
+    av_render_mixer_cfg_t cfg = { .out_render = out, .out_info = fmt };
+    av_render_mixer_handle_t mixer = av_render_mixer_create(&cfg);
+    TEST_CHECK(mixer != NULL, "Fail to create mixer");
+    if (mixer == NULL) {
+        return TEST_RESULT();
+    }
+    av_render_mixer_source_cfg_t call_cfg = { .gain = 1.0f, .priority = 0, .duck_gain = 0.25f };
+    av_render_mixer_source_cfg_t prompt_cfg = { .gain = 1.0f, .priority = 1, .duck_gain = 1.0f };
+    static feeder_t call, prompt;
+    call.render = av_render_mixer_alloc_source(mixer, &call_cfg);
+    prompt.render = av_render_mixer_alloc_source(mixer, &prompt_cfg);
+    TEST_CHECK(call.render && prompt.render, "Fail to allocate sources");
+    av_render_audio_frame_info_t bad = { .sample_rate = 48000, .channel = 1, .bits_per_sample = 16 };
+    TEST_CHECK(audio_render_open(call.render, &bad) != 0, "Source of other format accepted");
+
+    // Single source is written to output directly
+    direct_lo = (uint8_t *)call.buf;
+    direct_hi = (uint8_t *)(call.buf + FRAME_SAMPLES);
+    audio_render_open(call.render, &fmt);
+    call.value = 1000;
+    feed_start(&call, 25);
+    feed_wait(&call);
+    printf("Single source: %d writes, %d without copy\n", write_num, direct_num);
+    TEST_CHECK(direct_num == 25 && write_num == 25, "Single source copied");
+
+    // Prompt over call, call ducked to 250 so mixed level is 2250 once fade done
+    feed_start(&call, 100);
+    usleep(200000);
+    audio_render_open(prompt.render, &fmt);
+    prompt.value = 2000;
+    int start = captured_num;
+    feed_start(&prompt, 50);
+    feed_wait(&prompt);
+    usleep(100000);
+    audio_render_close(prompt.render);
+    int ducked = 0;
+    for (int i = start; i < captured_num; i++) {
+        ducked += (captured[i] == 2250);
+    }
+    feed_wait(&call);
+    printf("Prompt over call: %d samples at ducked level\n", ducked);
+    // Prompt lasts 1 second, leave out fade in and fade out
+    TEST_CHECK(ducked > SAMPLE_RATE * 8 / 10 * 6 / 10, "Only %d samples ducked", ducked);
+
+    // Call owns output again after prompt closed
+    int direct_before = direct_num, write_before = write_num;
+    feed_start(&call, 25);
+    feed_wait(&call);
+    printf("After prompt: %d of %d writes without copy\n", direct_num - direct_before, write_num - write_before);
+    TEST_CHECK(direct_num - direct_before >= 20, "Direct write not resumed");
+
+    // Sources paced in real time, prompt not aligned with call frames
+    call.paced = prompt.paced = true;
+    feed_start(&call, 150);
+    usleep(507000);
+    int64_t underrun_before = underrun_us;
+    audio_render_open(prompt.render, &fmt);
+    feed_start(&prompt, 50);
+    feed_wait(&prompt);
+    audio_render_close(prompt.render);
+    feed_wait(&call);
+    printf("Paced sources: output underrun %d ms\n", (int)((underrun_us - underrun_before) / 1000));
+    TEST_CHECK(underrun_us - underrun_before < 20000, "Underrun %d ms while mixing paced sources",
+               (int)((underrun_us - underrun_before) / 1000));
+    call.paced = prompt.paced = false;
+
+    // Sum over full scale saturates
+    av_render_mixer_set_gain(mixer, call.render, 4.0f);
+    audio_render_open(prompt.render, &fmt);
+    call.value = prompt.value = 30000;
+    start = captured_num;
+    feed_start(&call, 50);
+    feed_start(&prompt, 50);
+    feed_wait(&call);
+    feed_wait(&prompt);
+    usleep(150000);
+    int clipped = 0, wrapped = 0;
+    for (int i = start; i < captured_num; i++) {
+        clipped += (captured[i] == INT16_MAX);
+        wrapped += (captured[i] < 0);
+    }
+    printf("Saturation: %d samples clipped, %d wrapped\n", clipped, wrapped);
+    TEST_CHECK(clipped > 0 && wrapped == 0, "Mixed samples wrapped");
+
+    audio_render_close(prompt.render);
+    audio_render_close(call.render);
+    audio_render_free_handle(prompt.render);
+    audio_render_free_handle(call.render);
+    av_render_mixer_destroy(mixer);
+    audio_render_free_handle(out);
+    return TEST_RESULT();
+}
@@ -0,0 +1,165 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Flush while decoder and render threads are busy or paused
+ *
+ * Render queue has a single reader, flush must leave dropping of queued data to render thread even when it is
+ * paused and decoder is blocked on full render queue. After each flush no data fed before it may reach device
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+#include "av_render.h"
+#include "sim_render.h"
+#include "host_test.h"
+
+#define ROUND_NUM        (200)
+#define ROUND_PTS        (100000)
+#define WIDTH            (64)
+#define HEIGHT           (64)
+#define WATCHDOG_MS      (5000)
+#define AUDIO_FRAME_SIZE (160)
+
+static volatile uint32_t progress;
+static volatile uint32_t round_base;
+static volatile bool     check_stale;
+static uint32_t          stale_num, written_num;
+static pthread_mutex_t   trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+    if (kind != 'A' && kind != 'V') {
+        return;
+    }
+    pthread_mutex_lock(&trace_lock);
+    written_num++;
+    if (check_stale && pts < round_base) {
+        stale_num++;
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
+
+static void *watchdog(void *arg)
+{
+    uint32_t last = progress;
+    while (1) {
+        usleep(WATCHDOG_MS * 1000);
+        if (progress == last) {
+            printf("No progress in %d ms, stuck at round %u\n", WATCHDOG_MS, (unsigned)last);
+            abort();
+        }
+        last = progress;
+    }
+    return NULL;
+}
+
+static void feed(av_render_handle_t render, uint32_t pts, int audio_num, int video_num)
+{
+    static uint8_t audio[AUDIO_FRAME_SIZE];
+    static uint8_t video[512];
+    for (int i = 0; i < audio_num; i++) {
+        av_render_audio_data_t data = { .data = audio, .size = sizeof(audio), .pts = pts + i * 20 };
+        av_render_add_audio_data(render, &data);
+    }
+    for (int i = 0; i < video_num; i++) {
+        av_render_video_data_t data = { .data = video, .size = sizeof(video), .pts = pts + i * 33 };
+        av_render_add_video_data(render, &data);
+    }
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    sim_clock_use_virtual(false);
+    srand(1);
+    sim_render_cfg_t render_cfg = { .audio_buffer_ms = 40, .video_draw_ms = 2 };
+    audio_render_handle_t audio_render = sim_audio_render_alloc(&render_cfg);
+    video_render_handle_t video_render = sim_video_render_alloc(&render_cfg);
+    // Render fifo hold few frames so that decoder blocks on it
+    av_render_cfg_t cfg = {
+        .audio_render = audio_render,
+        .video_render = video_render,
+        .audio_raw_fifo_size = 64 * 1024,
+        .audio_render_fifo_size = 2 * 1024,
+        .video_raw_fifo_size = 64 * 1024,
+        .video_render_fifo_size = 3 * WIDTH * HEIGHT * 2,
+        .sync_mode = AV_RENDER_SYNC_NONE,
+    };
+    av_render_handle_t render = av_render_open(&cfg);
+    TEST_CHECK(render != NULL, "open render");
+    if (render == NULL) {
+        return TEST_RESULT();
+    }
+    av_render_audio_info_t audio_info = { .codec = AV_RENDER_AUDIO_CODEC_G711A, .sample_rate = 8000, .channel = 1 };
+    av_render_video_info_t video_info = { .codec = AV_RENDER_VIDEO_CODEC_MJPEG, .width = WIDTH, .height = HEIGHT, .fps = 30 };
+    av_render_add_audio_stream(render, &audio_info);
+    av_render_add_video_stream(render, &video_info);
+    pthread_t dog;
+    pthread_create(&dog, NULL, watchdog, NULL);
+    pthread_detach(dog);
+
+    uint32_t paused_flush = 0;
+    for (uint32_t r = 1; r <= ROUND_NUM; r++) {
+        uint32_t pts = r * ROUND_PTS;
+        bool pause = (rand() % 2) == 0;
+        feed(render, pts, 8 + rand() % 16, 4 + rand() % 8);
+        if (pause) {
+            av_render_pause(render, true);
+            // Decoder keeps output until render queue is full
+            feed(render, pts + ROUND_PTS / 2, 16, 8);
+            paused_flush++;
+        }
+        // Flush while render is writing or paused
+        usleep(rand() % 20000);
+        round_base = pts + ROUND_PTS;
+        av_render_flush(render);
+        check_stale = true;
+        if (pause) {
+            av_render_pause(render, false);
+        }
+        // Data after flush must still play
+        pthread_mutex_lock(&trace_lock);
+        uint32_t before = written_num;
+        pthread_mutex_unlock(&trace_lock);
+        feed(render, round_base, 4, 2);
+        for (int i = 0; i < 100 && written_num == before; i++) {
+            usleep(2000);
+        }
+        TEST_CHECK(written_num != before, "round %u nothing rendered after flush", (unsigned)r);
+        check_stale = false;
+        progress = r;
+    }
+    av_render_close(render);
+    audio_render_free_handle(audio_render);
+    video_render_free_handle(video_render);
+    printf("%d rounds (%u flushed while paused), %u frames written, %u stale after flush\n", ROUND_NUM,
+           (unsigned)paused_flush, (unsigned)written_num, (unsigned)stale_num);
+    TEST_CHECK(stale_num == 0, "data fed before flush rendered after it");
+    return TEST_RESULT();
+}
@@ -0,0 +1,216 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Frame pool reference count, pointer check and data hand over through av_render
+ *
+ * Release and add reference must only accept slab data of the given pool without touching memory of other
+ * pointers. When render uses the pool, every slab must be back in pool after render close
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+#include "av_render.h"
+#include "sim_render.h"
+#include "host_test.h"
+
+#define SLAB_SIZE     (1000)
+#define SLAB_NUM      (4)
+#define STRESS_THREAD (4)
+#define STRESS_LOOP   (50000)
+#define WIDTH         (64)
+#define HEIGHT        (64)
+#define AUDIO_NUM     (100)
+#define VIDEO_NUM     (60)
+
+static av_render_pool_handle_t pool;
+static uint32_t                audio_written, video_written;
+static pthread_mutex_t         trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+    pthread_mutex_lock(&trace_lock);
+    if (kind == 'A') {
+        audio_written++;
+    } else if (kind == 'V') {
+        video_written++;
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
+
+static int free_num(av_render_pool_handle_t p)
+{
+    av_render_pool_stats_t stats = {};
+    av_render_pool_get_stats(p, &stats);
+    return stats.free_num;
+}
+
+static void test_pointer_check(void)
+{
+    av_render_pool_cfg_t cfg = { .block_size = SLAB_SIZE, .block_num = SLAB_NUM };
+    pool = av_render_pool_create(&cfg);
+    av_render_pool_handle_t other = av_render_pool_create(&cfg);
+    uint8_t *slab[SLAB_NUM];
+    for (int i = 0; i < SLAB_NUM; i++) {
+        slab[i] = av_render_pool_acquire(pool, SLAB_SIZE, 0);
+        TEST_CHECK(slab[i] != NULL, "acquire slab %d", i);
+    }
+    TEST_CHECK(av_render_pool_acquire(pool, 1, 0) == NULL, "acquire from empty pool");
+    TEST_CHECK(av_render_pool_acquire(other, SLAB_SIZE + 1, 0) == NULL, "acquire oversize");
+
+    // Heap pointer with nothing readable before it, sanitizer reports if header is read
+    uint8_t *heap = (uint8_t *)malloc(16);
+    uint8_t *other_slab = av_render_pool_acquire(other, 16, 0);
+    uint8_t stack_data[16];
+    TEST_CHECK(av_render_pool_release(pool, heap) == ESP_MEDIA_ERR_INVALID_ARG, "release heap data");
+    TEST_CHECK(av_render_pool_release(pool, stack_data) == ESP_MEDIA_ERR_INVALID_ARG, "release stack data");
+    TEST_CHECK(av_render_pool_release(pool, other_slab) == ESP_MEDIA_ERR_INVALID_ARG, "release slab of other pool");
+    TEST_CHECK(av_render_pool_release(pool, slab[1] + 4) == ESP_MEDIA_ERR_INVALID_ARG, "release inside slab");
+    TEST_CHECK(av_render_pool_add_ref(pool, heap) == ESP_MEDIA_ERR_INVALID_ARG, "add reference to heap data");
+    TEST_CHECK(av_render_pool_release(NULL, slab[0]) == ESP_MEDIA_ERR_INVALID_ARG, "release without pool");
+    free(heap);
+    TEST_CHECK(av_render_pool_release(other, other_slab) == ESP_MEDIA_ERR_OK, "release slab of other pool");
+
+    // Extra reference keeps slab out of pool
+    TEST_CHECK(av_render_pool_add_ref(pool, slab[0]) == ESP_MEDIA_ERR_OK, "add reference");
+    TEST_CHECK(av_render_pool_release(pool, slab[0]) == ESP_MEDIA_ERR_OK, "release first reference");
+    TEST_CHECK(free_num(pool) == 0, "slab returned with reference left");
+    for (int i = 0; i < SLAB_NUM; i++) {
+        TEST_CHECK(av_render_pool_release(pool, slab[i]) == ESP_MEDIA_ERR_OK, "release slab %d", i);
+    }
+    TEST_CHECK(free_num(pool) == SLAB_NUM, "%d slabs free", free_num(pool));
+    TEST_CHECK(av_render_pool_release(pool, slab[2]) == ESP_MEDIA_ERR_WRONG_STATE, "double release");
+    TEST_CHECK(av_render_pool_add_ref(pool, slab[2]) == ESP_MEDIA_ERR_WRONG_STATE, "add reference to free slab");
+    av_render_pool_destroy(other);
+}
+
+static void *stress_thread(void *arg)
+{
+    unsigned int seed = (unsigned int)(uintptr_t)arg;
+    for (int i = 0; i < STRESS_LOOP; i++) {
+        uint8_t *data = av_render_pool_acquire(pool, SLAB_SIZE, MEDIA_LIB_MAX_LOCK_TIME);
+        if (data == NULL) {
+            continue;
+        }
+        int ref = rand_r(&seed) % 3;
+        for (int j = 0; j < ref; j++) {
+            av_render_pool_add_ref(pool, data);
+        }
+        for (int j = 0; j <= ref; j++) {
+            av_render_pool_release(pool, data);
+        }
+    }
+    return NULL;
+}
+
+static void test_stress(void)
+{
+    pthread_t th[STRESS_THREAD];
+    for (int i = 0; i < STRESS_THREAD; i++) {
+        pthread_create(&th[i], NULL, stress_thread, (void *)(uintptr_t)(i + 1));
+    }
+    for (int i = 0; i < STRESS_THREAD; i++) {
+        pthread_join(th[i], NULL);
+    }
+    av_render_pool_stats_t stats = {};
+    av_render_pool_get_stats(pool, &stats);
+    TEST_CHECK(stats.free_num == SLAB_NUM && stats.peak_used == SLAB_NUM, "after stress %d free peak %d",
+               stats.free_num, stats.peak_used);
+    av_render_pool_destroy(pool);
+}
+
+static void test_render(void)
+{
+    av_render_pool_cfg_t pool_cfg = { .block_size = 4096, .block_num = 8 };
+    pool = av_render_pool_create(&pool_cfg);
+    sim_render_cfg_t render_cfg = { .audio_buffer_ms = 40, .video_draw_ms = 1 };
+    audio_render_handle_t audio_render = sim_audio_render_alloc(&render_cfg);
+    video_render_handle_t video_render = sim_video_render_alloc(&render_cfg);
+    av_render_cfg_t cfg = {
+        .audio_render = audio_render,
+        .video_render = video_render,
+        .audio_raw_fifo_size = 4096,
+        .audio_render_fifo_size = 4096,
+        .video_raw_fifo_size = 4096,
+        .video_render_fifo_size = 3 * WIDTH * HEIGHT * 2,
+        .sync_mode = AV_RENDER_SYNC_NONE,
+    };
+    av_render_handle_t render = av_render_open(&cfg);
+    TEST_CHECK(render != NULL, "open render");
+    if (render == NULL) {
+        return;
+    }
+    av_render_use_data_pool(render, av_render_pool_free_data, pool);
+    av_render_audio_info_t audio_info = { .codec = AV_RENDER_AUDIO_CODEC_G711A, .sample_rate = 8000, .channel = 1 };
+    av_render_video_info_t video_info = { .codec = AV_RENDER_VIDEO_CODEC_MJPEG, .width = WIDTH, .height = HEIGHT, .fps = 30 };
+    av_render_add_audio_stream(render, &audio_info);
+    av_render_add_video_stream(render, &video_info);
+    for (int i = 0; i < AUDIO_NUM; i++) {
+        av_render_audio_data_t audio = { .size = 160, .pts = i * 20 };
+        audio.data = av_render_pool_acquire(pool, audio.size, MEDIA_LIB_MAX_LOCK_TIME);
+        memset(audio.data, 0xD5, audio.size);
+        av_render_add_audio_data(render, &audio);
+        if (i % 2 == 0 && i / 2 < VIDEO_NUM) {
+            av_render_video_data_t video = { .size = 2048, .pts = i * 20 };
+            video.data = av_render_pool_acquire(pool, video.size, MEDIA_LIB_MAX_LOCK_TIME);
+            memset(video.data, 0, video.size);
+            av_render_add_video_data(render, &video);
+        }
+    }
+    // Pause so that decoder blocks on render fifo and slabs stay queued
+    usleep(100 * 1000);
+    av_render_pause(render, true);
+    for (int i = 0; i < AUDIO_NUM; i++) {
+        av_render_audio_data_t audio = { .size = 160, .pts = (AUDIO_NUM + i) * 20 };
+        audio.data = av_render_pool_acquire(pool, audio.size, 20);
+        if (audio.data == NULL) {
+            break;
+        }
+        memset(audio.data, 0xD5, audio.size);
+        av_render_add_audio_data(render, &audio);
+    }
+    TEST_CHECK(free_num(pool) == 0, "slabs kept by paused render");
+    // Close with data still queued, render must release them
+    av_render_close(render);
+    audio_render_free_handle(audio_render);
+    video_render_free_handle(video_render);
+    printf("Render wrote %u audio %u video frames from pool\n", (unsigned)audio_written, (unsigned)video_written);
+    TEST_CHECK(audio_written > 0 && video_written > 0, "render pool data");
+    TEST_CHECK(free_num(pool) == pool_cfg.block_num, "%d slabs not released after close",
+               pool_cfg.block_num - free_num(pool));
+    av_render_pool_destroy(pool);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    test_pointer_check();
+    test_stress();
+    test_render();
+    return TEST_RESULT();
+}
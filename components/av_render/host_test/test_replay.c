@@ -0,0 +1,202 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Replay of record file must be repeatable
+ *
+ * Record of 10s G711 and H264 with 500ms network stall is written, then replayed by `av_render_replay` on virtual
+ * clock. Two replays must give same trace hash, faster feed must change it and truncated record must be reported
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "media_lib_adapter.h"
+#include "media_lib_err.h"
+#include "av_render_record.h"
+#include "host_test.h"
+
+#define RECORD_FILE    "test_replay.avr"
+#define TRUNCATED_FILE "test_replay_truncated.avr"
+#define DURATION_MS    (10000)
+#define AUDIO_FRAME_MS (20)
+#define VIDEO_FPS      (30)
+#define VIDEO_SIZE     (2048)
+#define STALL_START_MS (4000)
+#define STALL_MS       (500)
+
+typedef struct {
+    bool     broken;
+    uint32_t item_num;
+    uint32_t trace_num;
+    uint64_t hash;
+} replay_result_t;
+
+static uint64_t arrival_us(uint32_t send_ms)
+{
+    // Data sent during stall arrives in a burst after it
+    if (send_ms >= STALL_START_MS && send_ms < STALL_START_MS + STALL_MS) {
+        return (uint64_t)(STALL_START_MS + STALL_MS) * 1000 + (send_ms - STALL_START_MS) * 10;
+    }
+    return (uint64_t)send_ms * 1000;
+}
+
+static int write_record(void)
+{
+    static uint8_t audio[8000 * AUDIO_FRAME_MS / 1000];
+    static uint8_t video[VIDEO_SIZE];
+    av_render_record_handle_t record = NULL;
+    int ret = av_render_record_create(RECORD_FILE, &record);
+    if (ret != ESP_MEDIA_ERR_OK) {
+        return ret;
+    }
+    av_render_record_item_t item = { .type = AV_RENDER_RECORD_TYPE_CONFIG };
+    item.cfg.audio_raw_fifo_size = 4096;
+    item.cfg.video_raw_fifo_size = 64 * 1024;
+    item.cfg.audio_render_fifo_size = 6 * 1024;
+    item.cfg.video_render_fifo_size = 4 * 1024 * 1024;
+    item.cfg.allow_drop_data = true;
+    item.cfg.sync_mode = AV_RENDER_SYNC_FOLLOW_AUDIO;
+    av_render_record_write(record, &item);
+    item = (av_render_record_item_t) { .type = AV_RENDER_RECORD_TYPE_AUDIO_STREAM };
+    item.audio_info = (av_render_audio_info_t) {
+        .codec = AV_RENDER_AUDIO_CODEC_G711A,
+        .channel = 1,
+        .bits_per_sample = 16,
+        .sample_rate = 8000,
+    };
+    av_render_record_write(record, &item);
+    item = (av_render_record_item_t) { .type = AV_RENDER_RECORD_TYPE_VIDEO_STREAM };
+    item.video_info = (av_render_video_info_t) {
+        .codec = AV_RENDER_VIDEO_CODEC_H264,
+        .width = 320,
+        .height = 240,
+        .fps = VIDEO_FPS,
+    };
+    av_render_record_write(record, &item);
+    uint32_t audio_ms = 0, video_idx = 0;
+    while (ret == ESP_MEDIA_ERR_OK && (audio_ms < DURATION_MS || video_idx * 1000 / VIDEO_FPS < DURATION_MS)) {
+        uint32_t video_ms = video_idx * 1000 / VIDEO_FPS;
+        if (audio_ms <= video_ms) {
+            item = (av_render_record_item_t) { .type = AV_RENDER_RECORD_TYPE_AUDIO_DATA, .time_us = arrival_us(audio_ms) };
+            item.audio_data = (av_render_audio_data_t) { .pts = audio_ms, .data = audio, .size = sizeof(audio) };
+            audio_ms += AUDIO_FRAME_MS;
+        } else {
+            item = (av_render_record_item_t) { .type = AV_RENDER_RECORD_TYPE_VIDEO_DATA, .time_us = arrival_us(video_ms) };
+            item.video_data = (av_render_video_data_t) {
+                .pts = video_ms,
+                .key_frame = (video_idx % VIDEO_FPS) == 0,
+                .data = video,
+                .size = VIDEO_SIZE - (video_idx % VIDEO_FPS) * 32,
+            };
+            video_idx++;
+        }
+        ret = av_render_record_write(record, &item);
+    }
+    av_render_record_close(record);
+    return ret;
+}
+
+static int truncate_record(void)
+{
+    FILE *in = fopen(RECORD_FILE, "rb");
+    FILE *out = fopen(TRUNCATED_FILE, "wb");
+    int ret = (in && out) ? 0 : -1;
+    if (ret == 0) {
+        fseek(in, 0, SEEK_END);
+        long size = ftell(in) - 100;
+        fseek(in, 0, SEEK_SET);
+        char buf[4096];
+        while (size > 0) {
+            size_t n = fread(buf, 1, size < (long)sizeof(buf) ? size : sizeof(buf), in);
+            if (n == 0) {
+                break;
+            }
+            fwrite(buf, 1, n, out);
+            size -= n;
+        }
+    }
+    if (in) {
+        fclose(in);
+    }
+    if (out) {
+        fclose(out);
+    }
+    return ret;
+}
+
+static int run_replay(const char *options, const char *file, replay_result_t *res)
+{
+    char cmd[512];
+    snprintf(cmd, sizeof(cmd), "%s %s %s 2>&1", REPLAY_TOOL, options, file);
+    FILE *fp = popen(cmd, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+    memset(res, 0, sizeof(replay_result_t));
+    char line[512];
+    bool done = false;
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "Record file broken", 18) == 0) {
+            res->broken = true;
+        }
+        char *p = strstr(line, "replayed ");
+        if (p && sscanf(p, "replayed %" SCNu32 " records (%*u failed), %" SCNu32 " traces, hash %" SCNx64,
+                        &res->item_num, &res->trace_num, &res->hash) == 3) {
+            done = true;
+        }
+    }
+    int status = pclose(fp);
+    printf("replay %-6s %s: %u records, %u traces, hash %016" PRIx64 "%s\n", options, file, (unsigned)res->item_num,
+           (unsigned)res->trace_num, res->hash, res->broken ? ", broken" : "");
+    return status == 0 && done ? 0 : -1;
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    TEST_CHECK(write_record() == ESP_MEDIA_ERR_OK, "Fail to write record");
+    replay_result_t first, second, fast, truncated;
+    TEST_CHECK(run_replay("", RECORD_FILE, &first) == 0, "First replay failed");
+    TEST_CHECK(run_replay("", RECORD_FILE, &second) == 0, "Second replay failed");
+    TEST_CHECK(first.hash == second.hash, "Replay not repeatable, hash %016" PRIx64 " and %016" PRIx64, first.hash,
+               second.hash);
+    TEST_CHECK(first.trace_num == second.trace_num, "Trace number %u and %u", (unsigned)first.trace_num,
+               (unsigned)second.trace_num);
+    // Each audio and video frame is traced at least once
+    uint32_t frame_num = DURATION_MS / AUDIO_FRAME_MS + DURATION_MS * VIDEO_FPS / 1000;
+    TEST_CHECK(first.item_num == frame_num + 2, "Replayed %u records", (unsigned)first.item_num);
+    TEST_CHECK(first.trace_num >= frame_num * 9 / 10, "Only %u traces", (unsigned)first.trace_num);
+    TEST_CHECK(first.broken == false, "Complete record reported broken");
+
+    // Feed 4 times faster, audio fifo overflows and trace must differ
+    TEST_CHECK(run_replay("-s 4", RECORD_FILE, &fast) == 0, "Fast replay failed");
+    TEST_CHECK(fast.hash != first.hash, "Trace hash not changed by feed speed");
+
+    TEST_CHECK(truncate_record() == 0, "Fail to truncate record");
+    TEST_CHECK(run_replay("", TRUNCATED_FILE, &truncated) == 0, "Truncated replay failed");
+    TEST_CHECK(truncated.broken && truncated.item_num < first.item_num, "Truncated record not reported");
+    remove(RECORD_FILE);
+    remove(TRUNCATED_FILE);
+    return TEST_RESULT();
+}
@@ -0,0 +1,315 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Reference aware drop of H264 under slow decoder
+ *
+ * Recorded H264 stream is fed in real time while stand-in decoder is throttled for a while, so that decoder thread
+ * falls behind and has to drop. Decode hook tracks reference chain of the stream, any frame decoded from dropped reference
+ * is corrupted and must never reach render device
+ */
+
+#include <string.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+#include "av_render.h"
+#include "sim_render.h"
+#include "sim_codec.h"
+#include "host_test.h"
+
+#define WIDTH          (64)
+#define HEIGHT         (64)
+#define FRAME_MS       (33)
+#define FRAME_NUM      (180)
+#define GOP            (60)
+#define THROTTLE_START (30)
+#define THROTTLE_END   (90)
+#define DECODE_MS      (3)
+#define NO_REF         (0xFFF)
+#define MAX_AU_SIZE    (256)
+
+typedef struct {
+    const char *name;
+    int         non_ref_every; /* Every Nth frame is non-reference, 0 for IPPP */
+    uint32_t    slow_ms;       /* Decode time during throttle */
+} drop_case_t;
+
+typedef struct {
+    uint8_t  data[MAX_AU_SIZE];
+    uint32_t size;
+} access_unit_t;
+
+typedef struct {
+    uint8_t  buf[64];
+    uint32_t bits;
+} bit_writer_t;
+
+static access_unit_t stream[FRAME_NUM];
+static uint32_t      slow_ms;
+static bool          ref_ok[FRAME_NUM];
+static bool          corrupted[FRAME_NUM];
+static bool          rendered[FRAME_NUM];
+static uint32_t      decoded_num, corrupted_num, corrupted_rendered, key_request_num;
+
+static void put_bit(bit_writer_t *w, int b)
+{
+    if (b) {
+        w->buf[w->bits >> 3] |= 0x80 >> (w->bits & 7);
+    }
+    w->bits++;
+}
+
+static void put_bits(bit_writer_t *w, uint32_t v, int n)
+{
+    for (int i = n - 1; i >= 0; i--) {
+        put_bit(w, (v >> i) & 1);
+    }
+}
+
+static void put_ue(bit_writer_t *w, uint32_t v)
+{
+    int n = 0;
+    while (((v + 1) >> n) > 1) {
+        n++;
+    }
+    put_bits(w, 0, n);
+    put_bits(w, v + 1, n + 1);
+}
+
+static uint32_t put_start_code(uint8_t *out, uint8_t nal)
+{
+    out[0] = out[1] = out[2] = 0;
+    out[3] = 1;
+    out[4] = nal;
+    return 5;
+}
+
+static uint32_t put_sps_pps(uint8_t *out)
+{
+    bit_writer_t w = {};
+    // Baseline, level 3.0, sps id 0, frame_num 4 bits, POC type 2, 1 reference frame
+    put_bits(&w, 66, 8);
+    put_bits(&w, 0, 8);
+    put_bits(&w, 30, 8);
+    put_ue(&w, 0);
+    put_ue(&w, 0);
+    put_ue(&w, 2);
+    put_ue(&w, 1);
+    put_bit(&w, 0);
+    put_ue(&w, WIDTH / 16 - 1);
+    put_ue(&w, HEIGHT / 16 - 1);
+    // frame_mbs_only, direct_8x8, no cropping, no VUI, stop bit
+    put_bits(&w, 0x19, 5);
+    uint32_t n = put_start_code(out, 0x67);
+    memcpy(out + n, w.buf, (w.bits + 7) / 8);
+    n += (w.bits + 7) / 8;
+    n += put_start_code(out + n, 0x68);
+    out[n++] = 0xCE;
+    return n;
+}
+
+/* Slice payload carries frame index and index of frame it predicts from
+ * Every byte has high bit set so that payload never forms start code
+ */
+static uint32_t put_slice(uint8_t *out, uint8_t nal, int idx, int ref)
+{
+    uint32_t n = put_start_code(out, nal);
+    for (int s = 8; s >= 0; s -= 4) {
+        out[n++] = 0x80 | ((idx >> s) & 0xF);
+    }
+    for (int s = 8; s >= 0; s -= 4) {
+        out[n++] = 0x80 | ((ref >> s) & 0xF);
+    }
+    for (int i = 0; i < 100; i++) {
+        out[n++] = 0x80 | (i & 0x3F);
+    }
+    return n;
+}
+
+static int read_num(const uint8_t *p)
+{
+    return ((p[0] & 0xF) << 8) | ((p[1] & 0xF) << 4) | (p[2] & 0xF);
+}
+
+static void record_stream(int non_ref_every)
+{
+    int last_ref = NO_REF;
+    for (int i = 0; i < FRAME_NUM; i++) {
+        access_unit_t *au = &stream[i];
+        if (i % GOP == 0) {
+            au->size = put_sps_pps(au->data);
+            au->size += put_slice(au->data + au->size, 0x65, i, NO_REF);
+            last_ref = i;
+        } else if (non_ref_every && i % non_ref_every == 0) {
+            au->size = put_slice(au->data, 0x01, i, last_ref);
+        } else {
+            au->size = put_slice(au->data, 0x41, i, last_ref);
+            last_ref = i;
+        }
+    }
+}
+
+static uint32_t decode_hook(const uint8_t *data, uint32_t size, uint32_t pts, void *ctx)
+{
+    int idx = -1, ref = NO_REF;
+    uint8_t nal = 0;
+    for (uint32_t i = 0; i + 10 < size; i++) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            nal = data[i + 3] & 0x1F;
+            if (nal == 1 || nal == 5) {
+                idx = read_num(data + i + 4);
+                ref = read_num(data + i + 7);
+                break;
+            }
+        }
+    }
+    if (idx < 0 || idx >= FRAME_NUM) {
+        return DECODE_MS;
+    }
+    // Frame predicted from reference which was not decoded or itself corrupted
+    bool broken = (nal != 5) && (ref == NO_REF || ref_ok[ref] == false);
+    ref_ok[idx] = !broken;
+    if (broken) {
+        corrupted[idx] = true;
+        corrupted_num++;
+    }
+    decoded_num++;
+    return (idx >= THROTTLE_START && idx < THROTTLE_END) ? slow_ms : DECODE_MS;
+}
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+    if (kind != 'V') {
+        return;
+    }
+    uint32_t idx = pts / FRAME_MS;
+    if (idx >= FRAME_NUM) {
+        return;
+    }
+    rendered[idx] = true;
+    if (corrupted[idx]) {
+        corrupted_rendered++;
+    }
+}
+
+static int render_event(av_render_event_t event, void *ctx)
+{
+    if (event == AV_RENDER_EVENT_VIDEO_KEY_FRAME_REQUEST) {
+        key_request_num++;
+    }
+    return 0;
+}
+
+static void run_case(const drop_case_t *c)
+{
+    record_stream(c->non_ref_every);
+    slow_ms = c->slow_ms;
+    memset(ref_ok, 0, sizeof(ref_ok));
+    memset(corrupted, 0, sizeof(corrupted));
+    memset(rendered, 0, sizeof(rendered));
+    decoded_num = corrupted_num = corrupted_rendered = key_request_num = 0;
+    sim_vdec_set_hook(decode_hook, NULL);
+
+    sim_render_cfg_t render_cfg = { .audio_buffer_ms = 40, .video_draw_ms = 2 };
+    video_render_handle_t video_render = sim_video_render_alloc(&render_cfg);
+    // Decode fifo hold all backlog so that late frames are dropped by policy instead of fifo full
+    av_render_cfg_t cfg = {
+        .video_render = video_render,
+        .video_raw_fifo_size = 64 * 1024,
+        .video_render_fifo_size = 4 * WIDTH * HEIGHT * 2,
+        .sync_mode = AV_RENDER_SYNC_FOLLOW_TIME,
+        .allow_drop_data = true,
+    };
+    av_render_handle_t render = av_render_open(&cfg);
+    TEST_CHECK(render != NULL, "%s: open render", c->name);
+    if (render == NULL) {
+        video_render_free_handle(video_render);
+        return;
+    }
+    av_render_set_event_cb(render, render_event, NULL);
+    av_render_video_info_t video_info = {
+        .codec = AV_RENDER_VIDEO_CODEC_H264,
+        .width = WIDTH,
+        .height = HEIGHT,
+        .fps = 1000 / FRAME_MS,
+    };
+    av_render_add_video_stream(render, &video_info);
+    int64_t start = sim_clock_now();
+    for (int i = 0; i < FRAME_NUM; i++) {
+        uint32_t pts = i * FRAME_MS;
+        sim_clock_wait_until(start + (int64_t)pts * 1000);
+        av_render_video_data_t data = {
+            .data = stream[i].data,
+            .size = stream[i].size,
+            .pts = pts,
+        };
+        av_render_add_video_data(render, &data);
+    }
+    // Let decoder drain backlog
+    media_lib_thread_sleep(500);
+    av_render_video_drop_stats_t stats = {};
+    av_render_get_video_drop_stats(render, &stats);
+    av_render_close(render);
+    video_render_free_handle(video_render);
+    sim_vdec_set_hook(NULL, NULL);
+
+    uint32_t rendered_num = 0, recovered_num = 0;
+    for (int i = 0; i < FRAME_NUM; i++) {
+        rendered_num += rendered[i];
+        if (i >= THROTTLE_END + GOP / 2) {
+            recovered_num += rendered[i];
+        }
+    }
+    printf("%s: decoded %u rendered %u corrupted decoded %u rendered %u, dropped non-ref %u wait IDR %u, "
+           "key request %u\n",
+           c->name, (unsigned)decoded_num, (unsigned)rendered_num, (unsigned)corrupted_num,
+           (unsigned)corrupted_rendered, (unsigned)stats.non_ref_num,
+           (unsigned)stats.wait_idr_num, (unsigned)key_request_num);
+    TEST_CHECK(corrupted_rendered == 0, "%s: %u frames decoded from missing reference rendered", c->name,
+               (unsigned)corrupted_rendered);
+    uint32_t drop_num = stats.non_ref_num + stats.wait_idr_num;
+    TEST_CHECK(drop_num > 0, "%s: slow decoder caused no drop", c->name);
+    if (c->non_ref_every == 0) {
+        TEST_CHECK(key_request_num > 0, "%s: no key frame requested after reference dropped", c->name);
+    }
+    // Render catch up after throttle ends
+    TEST_CHECK(recovered_num >= (FRAME_NUM - THROTTLE_END - GOP / 2) * 9 / 10, "%s: only %u frames rendered after "
+               "recovery", c->name, (unsigned)recovered_num);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    sim_clock_use_virtual(false);
+    static const drop_case_t cases[] = {
+        // Non-reference frames dropped first is enough to keep up
+        { "L1T2", 2, 45 },
+        // All frames are reference, far behind has to skip until next IDR
+        { "IPPP", 0, 80 },
+    };
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++) {
+        run_case(&cases[i]);
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,535 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Golden and fuzz test of H264 SPS and JPEG SOF parser
+ *
+ * Golden streams are built bit by bit with known resolution, chroma, bit depth, profile and level
+ * Every truncated prefix of header and randomly mutated stream must either fail or give sane result
+ * Parser input is copied to heap buffer of exact size so that sanitizer catches any over read
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "media_lib_err.h"
+#include "video_parser.h"
+#include "host_test.h"
+
+#define FUZZ_ROUNDS     (40000)
+#define GARBAGE_ROUNDS  (20000)
+#define MAX_PARSED_SIZE (8192)
+#define AU_SIZE         (16384)
+
+typedef int (*parse_func_t)(const uint8_t *data, int size, video_parser_info_t *info);
+
+typedef struct {
+    uint8_t buf[4096];
+    int     bits;
+} bit_writer_t;
+
+typedef struct {
+    int profile;
+    int level;
+    int sps_id;
+    int chroma;
+    int depth;
+    int scaling;
+    int poc_type;
+    int poc_offset;
+    int frame_mbs_only;
+    int mb_width;
+    int map_height;
+    int crop[4];
+    int vui;
+    int width;
+    int height;
+} sps_case_t;
+
+typedef struct {
+    uint8_t marker;
+    int     precision;
+    int     width;
+    int     height;
+    int     comp_num;
+    uint8_t sampling[4];
+    int     chroma;
+} sof_case_t;
+
+static const sps_case_t sps_cases[] = {
+    // Baseline CIF
+    { 66, 30, 0, 1, 8, 0, 2, 0, 1, 20, 15, { 0 }, 0, 320, 240 },
+    // 1080p with bottom crop of 8 lines
+    { 77, 40, 0, 1, 8, 0, 0, 0, 1, 120, 68, { 0, 0, 0, 4 }, 1, 1920, 1080 },
+    // High 4:2:2 10 bits with scaling lists and crop on every side
+    { 122, 41, 3, 2, 10, 1, 0, 0, 1, 40, 30, { 1, 2, 3, 4 }, 1, 634, 473 },
+    // High 4:4:4 with crop unit 1
+    { 244, 50, 1, 3, 8, 1, 2, 0, 1, 10, 10, { 1, 0, 0, 1 }, 0, 159, 159 },
+    // Monochrome high
+    { 100, 31, 0, 0, 8, 0, 2, 0, 1, 8, 8, { 0, 0, 1, 1 }, 0, 128, 126 },
+    // Interlaced PAL with POC type 1, huge offsets force emulation prevention
+    { 77, 30, 0, 1, 8, 0, 1, 1 << 28, 0, 45, 18, { 0 }, 0, 720, 576 },
+    // 4K with largest SPS id
+    { 100, 51, 31, 1, 8, 0, 2, 0, 1, 256, 135, { 0 }, 1, 4096, 2160 },
+};
+
+/* Fields out of range, each must be reported as malformed */
+static const sps_case_t bad_sps_cases[] = {
+    // Chroma format 4
+    { 100, 30, 0, 4, 8, 0, 2, 0, 1, 20, 15, { 0 }, 0, 0, 0 },
+    // Bit depth 15
+    { 100, 30, 0, 1, 15, 0, 2, 0, 1, 20, 15, { 0 }, 0, 0, 0 },
+    // POC type 3
+    { 66, 30, 0, 1, 8, 0, 3, 0, 1, 20, 15, { 0 }, 0, 0, 0 },
+    // SPS id 32
+    { 66, 30, 32, 1, 8, 0, 2, 0, 1, 20, 15, { 0 }, 0, 0, 0 },
+    // Width over 8192
+    { 66, 30, 0, 1, 8, 0, 2, 0, 1, 513, 15, { 0 }, 0, 0, 0 },
+    // Crop whole height
+    { 66, 30, 0, 1, 8, 0, 2, 0, 1, 20, 15, { 0, 0, 60, 60 }, 0, 0, 0 },
+    // Crop whole width
+    { 66, 30, 0, 1, 8, 0, 2, 0, 1, 20, 15, { 200, 0, 0, 0 }, 0, 0, 0 },
+};
+
+static const sof_case_t sof_cases[] = {
+    { 0xC0, 8, 640, 480, 3, { 0x22, 0x11, 0x11 }, VIDEO_CHROMA_420 },
+    { 0xC0, 8, 1280, 720, 3, { 0x21, 0x11, 0x11 }, VIDEO_CHROMA_422 },
+    { 0xC0, 8, 33, 17, 3, { 0x11, 0x11, 0x11 }, VIDEO_CHROMA_444 },
+    { 0xC0, 8, 320, 240, 1, { 0x11 }, VIDEO_CHROMA_MONO },
+    { 0xC2, 8, 800, 600, 3, { 0x22, 0x11, 0x11 }, VIDEO_CHROMA_420 },
+    { 0xC1, 12, 1024, 768, 3, { 0x41, 0x11, 0x11 }, VIDEO_CHROMA_OTHER },
+    { 0xC0, 8, 100, 100, 4, { 0x11, 0x11, 0x11, 0x11 }, VIDEO_CHROMA_OTHER },
+    { 0xC0, 8, 8192, 8192, 3, { 0x22, 0x11, 0x11 }, VIDEO_CHROMA_420 },
+};
+
+static unsigned seed = 1234;
+static int      epb_num;
+
+static void put_bit(bit_writer_t *w, int bit)
+{
+    if (bit) {
+        w->buf[w->bits >> 3] |= 0x80 >> (w->bits & 7);
+    }
+    w->bits++;
+}
+
+static void put_bits(bit_writer_t *w, uint32_t v, int n)
+{
+    for (int i = n - 1; i >= 0; i--) {
+        put_bit(w, (v >> i) & 1);
+    }
+}
+
+static void put_ue(bit_writer_t *w, uint32_t v)
+{
+    uint64_t x = (uint64_t)v + 1;
+    int n = 0;
+    while ((x >> n) > 1) {
+        n++;
+    }
+    put_bits(w, 0, n);
+    put_bits(w, (uint32_t)x, n + 1);
+}
+
+static void put_se(bit_writer_t *w, int32_t v)
+{
+    put_ue(w, v > 0 ? 2 * v - 1 : -2 * v);
+}
+
+/* Write NAL with start code, header and emulation prevention, return written size */
+static int put_nal(uint8_t *out, uint8_t hdr, bit_writer_t *w)
+{
+    // RBSP trailing bits
+    put_bit(w, 1);
+    while (w->bits & 7) {
+        put_bit(w, 0);
+    }
+    int n = 0, zeros = 0;
+    out[n++] = 0, out[n++] = 0, out[n++] = 0, out[n++] = 1, out[n++] = hdr;
+    for (int i = 0; i < w->bits / 8; i++) {
+        uint8_t b = w->buf[i];
+        if (zeros >= 2 && b <= 3) {
+            out[n++] = 3;
+            zeros = 0;
+            epb_num++;
+        }
+        out[n++] = b;
+        zeros = b ? 0 : zeros + 1;
+    }
+    return n;
+}
+
+static int make_sps(uint8_t *out, const sps_case_t *c)
+{
+    bit_writer_t w = { 0 };
+    put_bits(&w, c->profile, 8);
+    put_bits(&w, 0, 8);
+    put_bits(&w, c->level, 8);
+    put_ue(&w, c->sps_id);
+    if (c->profile >= 100) {
+        put_ue(&w, c->chroma);
+        if (c->chroma == 3) {
+            put_bit(&w, 0);
+        }
+        put_ue(&w, c->depth - 8);
+        put_ue(&w, c->depth - 8);
+        put_bit(&w, 0);
+        put_bit(&w, c->scaling);
+        for (int i = 0; c->scaling && i < (c->chroma == 3 ? 12 : 8); i++) {
+            put_bit(&w, 1);
+            for (int j = 0; j < (i < 6 ? 16 : 64); j++) {
+                put_se(&w, (j % 3) - 1);
+            }
+        }
+    }
+    put_ue(&w, 0);
+    put_ue(&w, c->poc_type);
+    if (c->poc_type == 0) {
+        put_ue(&w, 2);
+    } else if (c->poc_type == 1) {
+        put_bit(&w, 0);
+        put_se(&w, c->poc_offset);
+        put_se(&w, -3);
+        put_ue(&w, 3);
+        put_se(&w, 1);
+        put_se(&w, c->poc_offset);
+        put_se(&w, 2);
+    }
+    put_ue(&w, 4);
+    put_bit(&w, 0);
+    put_ue(&w, c->mb_width - 1);
+    put_ue(&w, c->map_height - 1);
+    put_bit(&w, c->frame_mbs_only);
+    if (c->frame_mbs_only == 0) {
+        put_bit(&w, 1);
+    }
+    put_bit(&w, 1);
+    bool crop = c->crop[0] || c->crop[1] || c->crop[2] || c->crop[3];
+    put_bit(&w, crop);
+    for (int i = 0; crop && i < 4; i++) {
+        put_ue(&w, c->crop[i]);
+    }
+    put_bit(&w, c->vui);
+    if (c->vui) {
+        // Extended SAR only
+        put_bit(&w, 1);
+        put_bits(&w, 255, 8);
+        put_bits(&w, 1, 16);
+        put_bits(&w, 1, 16);
+        put_bits(&w, 0, 5);
+    }
+    return put_nal(out, 0x67, &w);
+}
+
+static int make_pps(uint8_t *out, int pps_id, int sps_id)
+{
+    bit_writer_t w = { 0 };
+    put_ue(&w, pps_id);
+    put_ue(&w, sps_id);
+    put_bit(&w, 1);
+    put_bit(&w, 0);
+    put_ue(&w, 0);
+    return put_nal(out, 0x68, &w);
+}
+
+static int make_slice(uint8_t *out, uint8_t hdr, int len)
+{
+    int n = 0;
+    out[n++] = 0, out[n++] = 0, out[n++] = 1, out[n++] = hdr;
+    for (int i = 0; i < len; i++) {
+        out[n++] = (uint8_t)(rand_r(&seed) | 0x10);
+    }
+    return n;
+}
+
+static int make_jpeg(uint8_t *out, const sof_case_t *c, int fill)
+{
+    static const uint8_t app0[] = { 0xFF, 0xE0, 0, 16, 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0 };
+    int n = 0;
+    out[n++] = 0xFF, out[n++] = 0xD8;
+    memcpy(out + n, app0, sizeof(app0));
+    n += sizeof(app0);
+    // DQT
+    out[n++] = 0xFF, out[n++] = 0xDB, out[n++] = 0, out[n++] = 67, out[n++] = 0;
+    for (int i = 0; i < 64; i++) {
+        out[n++] = 1 + i;
+    }
+    // Fill bytes allowed before marker
+    for (int i = 0; i < fill; i++) {
+        out[n++] = 0xFF;
+    }
+    int len = 8 + 3 * c->comp_num;
+    out[n++] = 0xFF, out[n++] = c->marker;
+    out[n++] = len >> 8, out[n++] = len & 0xFF, out[n++] = c->precision;
+    out[n++] = c->height >> 8, out[n++] = c->height & 0xFF;
+    out[n++] = c->width >> 8, out[n++] = c->width & 0xFF;
+    out[n++] = c->comp_num;
+    for (int i = 0; i < c->comp_num; i++) {
+        out[n++] = i + 1, out[n++] = c->sampling[i], out[n++] = i ? 1 : 0;
+    }
+    // DHT
+    out[n++] = 0xFF, out[n++] = 0xC4, out[n++] = 0, out[n++] = 20, out[n++] = 0;
+    for (int i = 0; i < 17; i++) {
+        out[n++] = i == 0 ? 1 : 0;
+    }
+    // SOS with stuffed entropy data
+    static const uint8_t sos[] = { 0xFF, 0xDA, 0, 8, 1, 1, 0, 0, 63, 0 };
+    memcpy(out + n, sos, sizeof(sos));
+    n += sizeof(sos);
+    for (int i = 0; i < 100; i++) {
+        out[n] = (uint8_t)rand_r(&seed);
+        if (out[n++] == 0xFF) {
+            out[n++] = 0;
+        }
+    }
+    out[n++] = 0xFF, out[n++] = 0xD9;
+    return n;
+}
+
+static int parse_exact(parse_func_t parse, const uint8_t *data, int size, video_parser_info_t *info)
+{
+    uint8_t *copy = (uint8_t *)malloc(size);
+    memcpy(copy, data, size);
+    memset(info, 0, sizeof(video_parser_info_t));
+    int ret = parse(copy, size, info);
+    free(copy);
+    return ret;
+}
+
+static bool same_info(video_parser_info_t *a, video_parser_info_t *b)
+{
+    return a->width == b->width && a->height == b->height && a->chroma == b->chroma &&
+           a->bit_depth == b->bit_depth && a->profile == b->profile && a->level == b->level;
+}
+
+static bool sane_info(video_parser_info_t *info)
+{
+    return info->width > 0 && info->height > 0 && info->width <= MAX_PARSED_SIZE &&
+           info->height <= MAX_PARSED_SIZE && info->chroma <= VIDEO_CHROMA_OTHER;
+}
+
+/* Prefix without whole header must fail or report same header */
+static void check_truncated(const char *name, int idx, parse_func_t parse, const uint8_t *data, int size,
+                            video_parser_info_t *full)
+{
+    for (int n = 1; n < size; n++) {
+        video_parser_info_t info;
+        if (parse_exact(parse, data, n, &info) == ESP_MEDIA_ERR_OK) {
+            TEST_CHECK(same_info(&info, full), "%s case %d truncated at %d got %dx%d", name, idx, n,
+                       info.width, info.height);
+        }
+    }
+}
+
+/* Flip, overwrite, drop and insert random bytes */
+static void check_mutated(const char *name, int idx, parse_func_t parse, const uint8_t *data, int size)
+{
+    static uint8_t buf[AU_SIZE];
+    int ok = 0, bad = 0;
+    for (int r = 0; r < FUZZ_ROUNDS; r++) {
+        int n = size;
+        memcpy(buf, data, size);
+        int mutate_num = 1 + rand_r(&seed) % 8;
+        for (int k = 0; k < mutate_num; k++) {
+            int op = rand_r(&seed) % 4;
+            int p = rand_r(&seed) % n;
+            if (op == 0) {
+                buf[p] ^= 1 << (rand_r(&seed) % 8);
+            } else if (op == 1) {
+                buf[p] = (uint8_t)rand_r(&seed);
+            } else if (op == 2 && n > 2) {
+                memmove(buf + p, buf + p + 1, n - p - 1);
+                n--;
+            } else if (n < AU_SIZE - 1) {
+                memmove(buf + p + 1, buf + p, n - p);
+                buf[p] = (rand_r(&seed) & 1) ? 0 : 0xFF;
+                n++;
+            }
+        }
+        video_parser_info_t info;
+        int ret = parse_exact(parse, buf, n, &info);
+        if (ret == ESP_MEDIA_ERR_OK) {
+            ok++;
+            TEST_CHECK(sane_info(&info), "%s case %d fuzz round %d got %dx%d chroma %d", name, idx, r, info.width,
+                       info.height, info.chroma);
+        } else if (ret == ESP_MEDIA_ERR_BAD_DATA) {
+            bad++;
+        }
+    }
+    // Mutation must sometimes keep header valid and sometimes break it, otherwise fuzz does not reach parser
+    TEST_CHECK(ok > 0 && bad > 0, "%s case %d fuzz parsed %d malformed %d", name, idx, ok, bad);
+}
+
+static void test_h264(void)
+{
+    static uint8_t au[AU_SIZE];
+    for (int i = 0; i < sizeof(sps_cases) / sizeof(sps_cases[0]); i++) {
+        const sps_case_t *c = &sps_cases[i];
+        // AUD, SPS, PPS and IDR slice
+        int n = 0;
+        au[n++] = 0, au[n++] = 0, au[n++] = 0, au[n++] = 1, au[n++] = 0x09, au[n++] = 0xF0;
+        n += make_sps(au + n, c);
+        n += make_pps(au + n, 0, c->sps_id);
+        int hdr_size = n;
+        n += make_slice(au + n, 0x65, 2000);
+        video_parser_info_t info;
+        int ret = parse_exact(video_parse_h264, au, n, &info);
+        TEST_CHECK(ret == ESP_MEDIA_ERR_OK, "h264 case %d return %d", i, ret);
+        TEST_CHECK(info.width == c->width && info.height == c->height, "h264 case %d got %dx%d expect %dx%d", i,
+                   info.width, info.height, c->width, c->height);
+        TEST_CHECK(info.chroma == (video_chroma_t)c->chroma && info.bit_depth == c->depth &&
+                   info.profile == c->profile && info.level == c->level,
+                   "h264 case %d chroma %d depth %d profile %d level %d", i, info.chroma, info.bit_depth,
+                   info.profile, info.level);
+        TEST_CHECK(info.has_pps, "h264 case %d PPS not matched", i);
+        TEST_CHECK(video_parse_h264_frame_kind(au, n) == VIDEO_FRAME_KIND_IDR, "h264 case %d not IDR", i);
+        check_truncated("h264", i, video_parse_h264, au, hdr_size, &info);
+        check_mutated("h264", i, video_parse_h264, au, hdr_size + 32);
+    }
+    TEST_CHECK(epb_num > 0, "Emulation prevention not covered");
+
+    for (int i = 0; i < sizeof(bad_sps_cases) / sizeof(bad_sps_cases[0]); i++) {
+        video_parser_info_t info;
+        int n = make_sps(au, &bad_sps_cases[i]);
+        int ret = parse_exact(video_parse_h264, au, n, &info);
+        TEST_CHECK(ret == ESP_MEDIA_ERR_BAD_DATA, "h264 malformed case %d return %d", i, ret);
+    }
+    // SPS cut inside NAL, last NAL of buffer is read till buffer end
+    for (int i = 0; i < sizeof(sps_cases) / sizeof(sps_cases[0]); i++) {
+        int n = make_sps(au, &sps_cases[i]);
+        for (int cut = 6; cut < n - 1; cut++) {
+            video_parser_info_t info;
+            int ret = parse_exact(video_parse_h264, au, cut, &info);
+            TEST_CHECK(ret == ESP_MEDIA_ERR_BAD_DATA || (ret == ESP_MEDIA_ERR_OK && info.width == sps_cases[i].width &&
+                       info.height == sps_cases[i].height), "h264 case %d cut at %d of %d return %d %dx%d", i, cut,
+                       n, ret, info.width, info.height);
+        }
+    }
+
+    uint8_t *p = au;
+    video_parser_info_t info;
+    // PPS refer to other SPS
+    int n = make_sps(p, &sps_cases[0]);
+    n += make_pps(p + n, 0, 5);
+    TEST_CHECK(video_parse_h264(p, n, &info) == ESP_MEDIA_ERR_OK && info.has_pps == false, "PPS mismatch not found");
+    // No SPS before first slice
+    n = make_slice(p, 0x41, 500);
+    TEST_CHECK(video_parse_h264(p, n, &info) == ESP_MEDIA_ERR_NOT_FOUND, "P frame parsed");
+    n += make_sps(p + n, &sps_cases[0]);
+    TEST_CHECK(video_parse_h264(p, n, &info) == ESP_MEDIA_ERR_NOT_FOUND, "SPS after slice parsed");
+    // Length prefixed stream is not Annex-B
+    static const uint8_t avcc[] = { 0, 0, 0x10, 0x20, 0x67, 0x42, 0x10, 0x20 };
+    TEST_CHECK(video_parse_h264(avcc, sizeof(avcc), &info) == ESP_MEDIA_ERR_NOT_SUPPORT, "AVCC parsed");
+
+    // Frame kind from NAL header
+    n = make_slice(p, 0x41, 100);
+    TEST_CHECK(video_parse_h264_frame_kind(p, n) == VIDEO_FRAME_KIND_REF, "Reference P frame");
+    n = make_slice(p, 0x01, 100);
+    TEST_CHECK(video_parse_h264_frame_kind(p, n) == VIDEO_FRAME_KIND_NON_REF, "Non-reference frame");
+    n += make_slice(p + n, 0x21, 100);
+    TEST_CHECK(video_parse_h264_frame_kind(p, n) == VIDEO_FRAME_KIND_REF, "Frame with one reference slice");
+    n = make_sps(p, &sps_cases[0]);
+    TEST_CHECK(video_parse_h264_frame_kind(p, n) == VIDEO_FRAME_KIND_UNKNOWN, "SPS only frame");
+}
+
+static void test_jpeg(void)
+{
+    static uint8_t img[AU_SIZE];
+    video_parser_info_t info;
+    for (int i = 0; i < sizeof(sof_cases) / sizeof(sof_cases[0]); i++) {
+        const sof_case_t *c = &sof_cases[i];
+        int n = make_jpeg(img, c, i & 1);
+        int ret = parse_exact(video_parse_jpeg, img, n, &info);
+        TEST_CHECK(ret == ESP_MEDIA_ERR_OK && info.width == c->width && info.height == c->height &&
+                   info.chroma == (video_chroma_t)c->chroma && info.bit_depth == c->precision &&
+                   info.profile == c->marker - 0xC0,
+                   "jpeg case %d return %d %dx%d chroma %d depth %d", i, ret, info.width, info.height, info.chroma,
+                   info.bit_depth);
+        check_truncated("jpeg", i, video_parse_jpeg, img, n, &info);
+        check_mutated("jpeg", i, video_parse_jpeg, img, n);
+    }
+    // SOF segment ends at buffer end so that any read past declared length is over read
+    static const uint8_t bad_sof[][16] = {
+        // Three components in length of one
+        { 0xFF, 0xD8, 0xFF, 0xC0, 0, 11, 8, 0, 16, 0, 16, 3, 1, 0x22, 0 },
+        // No component
+        { 0xFF, 0xD8, 0xFF, 0xC0, 0, 8, 8, 0, 16, 0, 16, 0 },
+        // Five components
+        { 0xFF, 0xD8, 0xFF, 0xC0, 0, 11, 8, 0, 16, 0, 16, 5, 1, 0x11, 0 },
+        // Sampling factor 0
+        { 0xFF, 0xD8, 0xFF, 0xC0, 0, 11, 8, 0, 16, 0, 16, 1, 1, 0x01, 0 },
+        // Sampling factor 5
+        { 0xFF, 0xD8, 0xFF, 0xC0, 0, 11, 8, 0, 16, 0, 16, 1, 1, 0x51, 0 },
+        // Zero width
+        { 0xFF, 0xD8, 0xFF, 0xC0, 0, 11, 8, 0, 16, 0, 0, 1, 1, 0x11, 0 },
+        // Segment too short for size
+        { 0xFF, 0xD8, 0xFF, 0xC0, 0, 6, 8, 0, 16, 0 },
+        // Segment length 1
+        { 0xFF, 0xD8, 0xFF, 0xC0, 0, 1, 8, 0, 16, 0 },
+    };
+    static const int bad_sof_size[] = { 15, 12, 15, 15, 15, 15, 10, 10 };
+    for (int i = 0; i < sizeof(bad_sof_size) / sizeof(bad_sof_size[0]); i++) {
+        int ret = parse_exact(video_parse_jpeg, bad_sof[i], bad_sof_size[i], &info);
+        TEST_CHECK(ret == ESP_MEDIA_ERR_BAD_DATA, "jpeg malformed case %d return %d", i, ret);
+    }
+    static const uint8_t png[] = { 0x89, 'P', 'N', 'G' };
+    TEST_CHECK(video_parse_jpeg(png, sizeof(png), &info) == ESP_MEDIA_ERR_NOT_FOUND, "PNG parsed");
+    static const uint8_t sos_first[] = { 0xFF, 0xD8, 0xFF, 0xDA, 0, 2 };
+    TEST_CHECK(video_parse_jpeg(sos_first, sizeof(sos_first), &info) == ESP_MEDIA_ERR_BAD_DATA, "SOS before SOF");
+    // Height defined by DNL is not supported
+    static const uint8_t dnl[] = { 0xFF, 0xD8, 0xFF, 0xC0, 0, 11, 8, 0, 0, 0, 16, 1, 1, 0x11, 0 };
+    TEST_CHECK(video_parse_jpeg(dnl, sizeof(dnl), &info) == ESP_MEDIA_ERR_BAD_DATA, "Zero height parsed");
+    sof_case_t big = { 0xC0, 8, MAX_PARSED_SIZE + 1, 100, 1, { 0x11 }, VIDEO_CHROMA_MONO };
+    int n = make_jpeg(img, &big, 0);
+    TEST_CHECK(video_parse_jpeg(img, n, &info) == ESP_MEDIA_ERR_BAD_DATA, "Too big width parsed");
+}
+
+static void test_garbage(void)
+{
+    for (int r = 0; r < GARBAGE_ROUNDS; r++) {
+        int n = 1 + rand_r(&seed) % 300;
+        uint8_t data[300];
+        // Mostly small values so that start codes and markers appear often
+        for (int i = 0; i < n; i++) {
+            data[i] = (rand_r(&seed) % 4) ? rand_r(&seed) % 4 : (uint8_t)rand_r(&seed);
+        }
+        video_parser_info_t info;
+        if (parse_exact(video_parse_h264, data, n, &info) == ESP_MEDIA_ERR_OK) {
+            TEST_CHECK(sane_info(&info), "Garbage round %d parsed as %dx%d", r, info.width, info.height);
+        }
+        if (parse_exact(video_parse_jpeg, data, n, &info) == ESP_MEDIA_ERR_OK) {
+            TEST_CHECK(sane_info(&info), "Garbage round %d parsed as %dx%d", r, info.width, info.height);
+        }
+        uint8_t *copy = (uint8_t *)malloc(n);
+        memcpy(copy, data, n);
+        video_parse_h264_frame_kind(copy, n);
+        free(copy);
+    }
+}
+
+int main(void)
+{
+    test_h264();
+    test_jpeg();
+    test_garbage();
+    return TEST_RESULT();
+}
@@ -0,0 +1,231 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Frame rate estimation from PTS of synthetic traces
+ *
+ * Traces carry true frame duration of each frame, they cover frame loss, arrival jitter, late and reordered frames,
+ * 32 bits and 90 kHz to ms wrap, and variable frame rate of camera. Estimate must stay within 5% of true duration
+ * for most frames once settled, frames right after restart or rate change are left out for half estimate window
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "media_lib_adapter.h"
+#include "video_rate.h"
+#include "host_test.h"
+
+#define MAX_FRAMES    (4000)
+#define WARM_FRAMES   (30)
+#define SETTLE_FRAMES (16)
+#define ERR_LIMIT     (0.05)
+
+typedef struct {
+    uint32_t pts;
+    float    frame_ms; /* True frame duration */
+    bool     settled;  /* Estimate expected to have followed rate and discontinuity */
+} trace_frame_t;
+
+typedef struct {
+    double   within;     /* Share of settled frames estimated within ERR_LIMIT */
+    double   mean_err;
+    double   max_err;
+    double   mean_ms;    /* Mean estimated frame duration */
+    double   confidence; /* Mean confidence */
+    uint32_t jitter_us;  /* Jitter reported at end */
+    int      not_ready;  /* Settled frames without estimate */
+} rate_result_t;
+
+static trace_frame_t trace[MAX_FRAMES];
+static int           trace_num;
+static uint32_t      seed = 1;
+
+static float rand_unit(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return ((seed >> 8) & 0xFFFF) / 65535.0f;
+}
+
+/* Constant frame rate from `base`, frames lost at `loss` rate and delivered with up to `jitter` ms PTS error */
+static void make_cfr(float frame_ms, int num, float loss, float jitter, uint32_t base)
+{
+    trace_num = 0;
+    for (int i = 0; i < num; i++) {
+        if (rand_unit() < loss) {
+            continue;
+        }
+        float t = i * frame_ms + (jitter ? (rand_unit() * 2 - 1) * jitter : 0);
+        trace[trace_num].pts = base + (uint32_t)lroundf(t + 1000);
+        trace[trace_num].frame_ms = frame_ms;
+        trace[trace_num].settled = trace_num >= WARM_FRAMES;
+        trace_num++;
+    }
+}
+
+/* Camera lowers rate with exposure: 30 fps, ramp to 15 fps, 15 fps, 30 fps, 24 fps, with 2 ms capture jitter */
+static void make_vfr(void)
+{
+    double t = 0;
+    int since_change = 0;
+    float last_ms = 0;
+    trace_num = 0;
+    while (trace_num < MAX_FRAMES && t < 60000) {
+        float ms;
+        if (t < 10000) {
+            ms = 33.33f;
+        } else if (t < 14000) {
+            ms = 33.33f + (t - 10000) / 4000 * 33.33f;
+        } else if (t < 30000) {
+            ms = 66.67f;
+        } else if (t < 45000) {
+            ms = 33.33f;
+        } else {
+            ms = 41.67f;
+        }
+        since_change = (fabsf(ms - last_ms) > 0.01f) ? 0 : since_change + 1;
+        last_ms = ms;
+        t += ms;
+        trace[trace_num].pts = (uint32_t)lround(t + (rand_unit() * 2 - 1) * 2);
+        trace[trace_num].frame_ms = ms;
+        trace[trace_num].settled = trace_num >= WARM_FRAMES && since_change >= SETTLE_FRAMES;
+        trace_num++;
+    }
+}
+
+static void run_trace(rate_result_t *res)
+{
+    video_rate_handle_t r = video_rate_open();
+    TEST_CHECK(r != NULL, "Fail to open rate estimator");
+    memset(res, 0, sizeof(rate_result_t));
+    if (r == NULL) {
+        return;
+    }
+    int settled = 0, ok = 0, ready = 0;
+    for (int i = 0; i < trace_num; i++) {
+        video_rate_add(r, trace[i].pts);
+        if (trace[i].settled == false) {
+            continue;
+        }
+        settled++;
+        video_rate_info_t info;
+        if (video_rate_get(r, &info) == false) {
+            res->not_ready++;
+            continue;
+        }
+        ready++;
+        res->mean_ms += info.frame_us / 1000.0;
+        double err = fabs(info.frame_us / 1000.0 - trace[i].frame_ms) / trace[i].frame_ms;
+        res->mean_err += err;
+        if (err > res->max_err) {
+            res->max_err = err;
+        }
+        if (err <= ERR_LIMIT) {
+            ok++;
+        }
+        res->confidence += info.confidence;
+        res->jitter_us = info.jitter_us;
+    }
+    video_rate_close(r);
+    if (ready) {
+        res->mean_err /= ready;
+        res->mean_ms /= ready;
+        res->confidence /= ready;
+    }
+    res->within = settled ? (double)ok / settled : 0;
+}
+
+static void check_trace(const char *name, double min_within, double min_confidence, rate_result_t *res)
+{
+    run_trace(res);
+    printf("%-26s within 5%% %5.1f%% mean err %4.1f%% max %5.1f%% confidence %3.0f jitter %5.2f ms not ready %d\n",
+           name, res->within * 100, res->mean_err * 100, res->max_err * 100, res->confidence, res->jitter_us / 1000.0,
+           res->not_ready);
+    TEST_CHECK(res->within >= min_within, "%s: only %.1f%% estimates within 5%%", name, res->within * 100);
+    TEST_CHECK(res->confidence >= min_confidence, "%s: confidence %.0f too low", name, res->confidence);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    rate_result_t res;
+
+    make_cfr(1000.0f / 30, 1800, 0, 0, 0);
+    check_trace("30 fps", 1.0, 95, &res);
+    TEST_CHECK(res.max_err < 0.01 && res.jitter_us < 1000, "Steady 30 fps err %.1f%% jitter %u us",
+               res.max_err * 100, (unsigned)res.jitter_us);
+
+    make_cfr(1000.0f / 30, 1800, 0.1f, 5, 0);
+    check_trace("30 fps loss 10% jitter 5", 0.95, 70, &res);
+    TEST_CHECK(res.jitter_us >= 1000 && res.jitter_us <= 5000, "Jitter 5 ms reported as %u us",
+               (unsigned)res.jitter_us);
+
+    // Jitter close to frame duration, lost frames can not be told, rate of delivered frames is reported instead
+    static const float rates[] = { 15, 25, 30, 60 };
+    for (int i = 0; i < (int)(sizeof(rates) / sizeof(rates[0])); i++) {
+        char name[32];
+        int num = (int)rates[i] * 60;
+        snprintf(name, sizeof(name), "%.0f fps loss 10%% jitter 30", rates[i]);
+        make_cfr(1000.0f / rates[i], num, 0.1f, 30, 0);
+        check_trace(name, 0, 0, &res);
+        double delivered_ms = 1000.0 / rates[i] * num / trace_num;
+        TEST_CHECK(fabs(res.mean_ms - delivered_ms) <= delivered_ms * ERR_LIMIT, "%s: mean %.2f ms delivered %.2f ms",
+                   name, res.mean_ms, delivered_ms);
+        TEST_CHECK(res.confidence <= 60, "%s: confidence %.0f too high for jitter", name, res.confidence);
+    }
+
+    // PTS wraps at 32 bits without restart
+    make_cfr(1000.0f / 30, 1800, 0, 0, 0xFFFFF000u - 1000);
+    check_trace("30 fps 32 bits wrap", 1.0, 95, &res);
+    TEST_CHECK(res.not_ready == 0, "Estimate lost at 32 bits wrap");
+
+    // One late frame every 2 seconds
+    make_cfr(1000.0f / 30, 1800, 0, 0, 0);
+    for (int i = WARM_FRAMES; i < trace_num; i += 60) {
+        trace[i].pts += 60;
+    }
+    check_trace("30 fps late frame", 0.98, 80, &res);
+
+    // B frames in decode order I P B B
+    make_cfr(40, 1500, 0, 0, 0);
+    for (int i = 1; i + 2 < trace_num; i += 3) {
+        uint32_t p = trace[i + 2].pts;
+        trace[i + 2].pts = trace[i + 1].pts;
+        trace[i + 1].pts = trace[i].pts;
+        trace[i].pts = p;
+    }
+    check_trace("25 fps B frame reorder", 1.0, 95, &res);
+
+    // 90 kHz RTP timestamp converted to ms wraps back near 0 at 2^32 / 90
+    make_cfr(1000.0f / 30, 1800, 0, 2, 47720000);
+    for (int i = 900; i < trace_num; i++) {
+        trace[i].pts -= 47721858;
+        trace[i].settled = i >= 900 + SETTLE_FRAMES;
+    }
+    check_trace("30 fps 90 kHz ms wrap", 0.98, 80, &res);
+    TEST_CHECK(res.not_ready == 0, "Estimate not ready %d frames after restart", res.not_ready);
+
+    make_vfr();
+    check_trace("VFR camera 30/15/30/24", 0.9, 70, &res);
+    return TEST_RESULT();
+}
@@ -45,11 +45,31 @@ typedef int (*adec_frame_cb)(av_render_audio_frame_t *frame, void *ctx);
  * @brief  Audio decoder configuration
  */
 typedef struct {
-    av_render_audio_info_t audio_info; /*!< Audio information */
-    adec_frame_cb          frame_cb;   /*!< Decoded frame callback */
-    void                  *ctx;        /*!< Decoder context */
+    av_render_audio_info_t audio_info;     /*!< Audio information */
+    adec_frame_cb          frame_cb;       /*!< Decoded frame callback */
+    void                  *ctx;            /*!< Decoder context */
+    uint16_t               conceal_max_ms; /*!< Maximum PTS gap (unit ms) filled by concealed audio, 0 to disable
+                                                Support Opus (decoder PLC) and G711 (waveform repeat) */
 } adec_cfg_t;
 
+/**
+ * @brief  Audio decoder packet loss concealment statistics
+ */
+typedef struct {
+    uint32_t lost_frames;      /*!< Frames detected lost from PTS gap */
+    uint32_t concealed_frames; /*!< Frames filled with concealed audio */
+    uint32_t resync_num;       /*!< Gaps too large to conceal, treated as stream restart */
+} adec_conceal_stats_t;
+
+/**
+ * @brief  Audio decoder output buffer statistics
+ */
+typedef struct {
+    uint32_t frame_size;  /*!< Current output buffer size */
+    uint32_t retry_num;   /*!< Decode retried for output buffer not enough */
+    uint32_t realloc_num; /*!< Output buffer enlarged after open */
+} adec_buffer_stats_t;
+
 /**
  * @brief  Audio decoder handle
  */
@@ -69,6 +89,8 @@ adec_handle_t adec_open(adec_cfg_t *cfg);
 /**
  * @brief  Decode audio
  *
+ * @note  When concealment enabled, lost frames detected from PTS gap are output before decoded data
+ *
  * @param[in]  h     Audio decoder handle
  * @param[in]  data  Audio data to be decoded
  *
@@ -90,6 +112,33 @@ int adec_decode(adec_handle_t h, av_render_audio_data_t *data);
  */
 int adec_get_frame_info(adec_handle_t h, av_render_audio_frame_info_t *frame_info);
 
+/**
+ * @brief  Get packet loss concealment statistics
+ *
+ * @param[in]   h      Audio decoder handle
+ * @param[out]  stats  Concealment statistics
+ *
+ * @return
+ *       - 0       On success
+ *       - Others  Invalid argument
+ */
+int adec_get_conceal_stats(adec_handle_t h, adec_conceal_stats_t *stats);
+
+/**
+ * @brief  Get output buffer statistics
+ *
+ * @note  Output buffer is allocated for worst case frame of codec when open
+ *        Retry and reallocation only happen when stream exceed it
+ *
+ * @param[in]   h      Audio decoder handle
+ * @param[out]  stats  Output buffer statistics
+ *
+ * @return
+ *       - 0       On success
+ *       - Others  Invalid argument
+ */
+int adec_get_buffer_stats(adec_handle_t h, adec_buffer_stats_t *stats);
+
 /**
  * @brief  Close audio decoder
  *
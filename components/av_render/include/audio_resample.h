@@ -43,10 +43,13 @@ typedef int (*audio_resample_frame_cb)(av_render_audio_frame_t *frame, void *ctx
  * @brief  Audio resample configuration
  */
 typedef struct {
-    av_render_audio_frame_info_t input_info;   /*!< Input frame information */
-    av_render_audio_frame_info_t output_info;  /*!< Output frame information */
-    audio_resample_frame_cb      resample_cb;  /*!< Resample output callback */
-    void                        *ctx;          /*!< User context */
+    av_render_audio_frame_info_t input_info;     /*!< Input frame information */
+    av_render_audio_frame_info_t output_info;    /*!< Output frame information */
+    audio_resample_frame_cb      resample_cb;    /*!< Resample output callback */
+    void                        *ctx;            /*!< User context */
+    uint16_t                     block_samples;  /*!< Streaming mode: input is processed and output in blocks of this samples
+                                                      Work memory is allocated once, set to 0 to process whole frame at once */
+    uint8_t                      cache_num;      /*!< Converter chains kept besides current one for fast format switch */
 } audio_resample_cfg_t;
 
 /**
@@ -60,15 +63,35 @@ typedef struct {
  */
 audio_resample_handle_t audio_resample_open(audio_resample_cfg_t *cfg);
 
+/**
+ * @brief  Change input and output format of audio resample
+ *
+ * @note  Converter chain of recently used format pairs are kept, switching back to them need not rebuild
+ *
+ * @param[in]  h            Audio resample handle
+ * @param[in]  input_info   Input frame information
+ * @param[in]  output_info  Output frame information
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_NO_MEM       No enough memory
+ */
+int audio_resample_set_info(audio_resample_handle_t h, av_render_audio_frame_info_t *input_info,
+                            av_render_audio_frame_info_t *output_info);
+
 /**
  * @brief  Write data to audio resample
  *
  * @param[in]  h     Audio resample handle
  * @param[in]  data  Data to be written
  *
+ * @note  In streaming mode output callback is called once for each block
+ *
  * @return
- *       - ESP_MEDIA_ERR_OK      On success
- *       - ESP_MEDIA_ERR_NO_MEM  No enough memory
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_NO_MEM       No enough memory
+ *       - ESP_MEDIA_ERR_WRONG_STATE  No valid converter chain
  */
 int audio_resample_write(audio_resample_handle_t h, av_render_audio_frame_t *data);
 
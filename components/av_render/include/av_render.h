@@ -24,6 +24,7 @@
 #pragma once
 
 #include "av_render_types.h"
+#include "av_render_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,19 +61,122 @@ typedef struct {
     bool                  pause_on_first_frame;   /*!< Whether automatically pause when render receive first frame */
     void                 *ctx;                    /*!< User context */
     bool                  video_cvt_in_render;    /*!< Convert color in render*/
+    uint8_t               video_cvt_worker_num;   /*!< Threads to do color convert in row bands, 0 or 1 convert in caller thread only */
+    uint16_t              audio_jitter_max_ms;    /*!< Enable adaptive audio playout buffer for live stream when set (need `audio_render_fifo_size`)
+                                                       Buffer depth follows arrival jitter and converge by time stretching, audio above it is dropped */
 } av_render_cfg_t;
 
+/**
+ * @brief  AV render adaptive audio buffer statistics
+ */
+typedef struct {
+    uint32_t target_ms;    /*!< Target buffer depth estimated from arrival jitter */
+    uint32_t depth_ms;     /*!< Buffered audio when last frame rendered */
+    uint32_t jitter_ms;    /*!< Arrival delay at 98 percentile */
+    float    speed;        /*!< Time stretch speed currently applied */
+    uint32_t underrun_num; /*!< Times buffer run dry and rebuffered */
+    uint32_t drop_num;     /*!< Frames dropped for exceeding `audio_jitter_max_ms` */
+} av_render_audio_jitter_stats_t;
+
+/**
+ * @brief  AV render sync statistics
+ */
+typedef struct {
+    int32_t  av_offset_ms; /*!< Video display time minus audio position when last frame rendered, positive when video ahead */
+    int32_t  drift_ppm;    /*!< Estimated audio clock drift against system time */
+    uint32_t clock_pts;    /*!< Current media clock position */
+    uint32_t resync_num;   /*!< Times media clock jumped to audio for seek or underrun */
+} av_render_sync_stats_t;
+
+/**
+ * @brief  AV render video drop statistics
+ */
+typedef struct {
+    uint32_t late_num;        /*!< Independent frames (like MJPEG) dropped before decode for late */
+    uint32_t non_ref_num;     /*!< H264 non-reference frames dropped before decode for late */
+    uint32_t wait_idr_num;    /*!< H264 frames dropped while skipping until next IDR after reference frame dropped */
+    uint32_t key_request_num; /*!< Times `AV_RENDER_EVENT_VIDEO_KEY_FRAME_REQUEST` sent */
+} av_render_video_drop_stats_t;
+
+/**
+ * @brief  AV render video frame rate measured from PTS
+ */
+typedef struct {
+    float    fps;        /*!< Measured frame rate, 0 if not enough frames yet */
+    uint32_t frame_us;   /*!< Measured frame duration */
+    uint32_t jitter_us;  /*!< Mean deviation of PTS gaps from whole frame durations */
+    uint8_t  confidence; /*!< 0-100, share of recent PTS gaps which are whole frame durations */
+} av_render_video_rate_t;
+
+/**
+ * @brief  AV render pipeline stage measured for each frame
+ */
+typedef enum {
+    AV_RENDER_STAGE_QUEUE_WAIT, /*!< From data added to decode start, include time in decode fifo */
+    AV_RENDER_STAGE_DECODE,     /*!< Decode time, exclude color convert and downstream processing */
+    AV_RENDER_STAGE_CONVERT,    /*!< Audio resample or video color convert time */
+    AV_RENDER_STAGE_RENDER,     /*!< Time spent in audio or video render write */
+    AV_RENDER_STAGE_END_TO_END, /*!< From data added to played or displayed, include render fifo and render device latency */
+    AV_RENDER_STAGE_MAX,
+} av_render_stage_t;
+
+/**
+ * @brief  AV render frame drop reason
+ */
+typedef enum {
+    AV_RENDER_DROP_DECODE_ERR, /*!< Fail to decode */
+    AV_RENDER_DROP_FIFO_FULL,  /*!< No space in decode fifo */
+    AV_RENDER_DROP_LATE,       /*!< Dropped for late or buffered too much */
+    AV_RENDER_DROP_BROKEN_REF, /*!< Skipped until next key frame after reference frame dropped */
+    AV_RENDER_DROP_MAX,
+} av_render_drop_reason_t;
+
+/**
+ * @brief  AV render stage latency statistics
+ *
+ * @note  Percentiles are taken from log-scale histogram, error is within 1/8 of value
+ */
+typedef struct {
+    uint32_t count;  /*!< Samples recorded */
+    uint32_t p50_us; /*!< Median in microseconds */
+    uint32_t p95_us; /*!< 95 percentile in microseconds */
+    uint32_t p99_us; /*!< 99 percentile in microseconds */
+    uint32_t max_us; /*!< Maximum in microseconds */
+} av_render_stage_stats_t;
+
+/**
+ * @brief  AV render stream statistics
+ */
+typedef struct {
+    uint32_t                in_num;                       /*!< Frames added */
+    uint32_t                decoded_num;                  /*!< Frames decoded successfully */
+    uint32_t                rendered_num;                 /*!< Frames written to render, audio frame may be split or merged by resample */
+    uint32_t                drop_num[AV_RENDER_DROP_MAX]; /*!< Dropped frames of each reason */
+    av_render_stage_stats_t stage[AV_RENDER_STAGE_MAX];   /*!< Latency of each stage */
+} av_render_stream_stats_t;
+
+/**
+ * @brief  AV render latency
+ */
+typedef struct {
+    uint32_t audio_render_ms; /*!< Audio written to audio render not played yet, such as in codec and I2S DMA */
+    uint32_t audio_total_ms;  /*!< Audio received not played yet, from newest packet to playing position */
+    uint32_t video_render_ms; /*!< Video pending in display frame buffer and draw queue */
+    uint32_t video_total_ms;  /*!< Video received not displayed yet, from newest packet to displaying position */
+} av_render_latency_t;
+
 /**
  * @brief  AV render event type
  */
 typedef enum {
-    AV_RENDER_EVENT_NONE,             /*!< No event happen */
-    AV_RENDER_EVENT_AUDIO_RENDERED,   /*!< Audio is rendered */
-    AV_RENDER_EVENT_VIDEO_RENDERED,   /*!< Video is rendered */
-    AV_RENDER_EVENT_AUDIO_EOS,        /*!< Audio stream eos */
-    AV_RENDER_EVENT_VIDEO_EOS,        /*!< Video stream eos */
-    AV_RENDER_EVENT_AUDIO_DECODE_ERR, /*!< Audio decode error */
-    AV_RENDER_EVENT_VIDEO_DECODE_ERR, /*!< Video decode error */
+    AV_RENDER_EVENT_NONE,                    /*!< No event happen */
+    AV_RENDER_EVENT_AUDIO_RENDERED,          /*!< Audio is rendered */
+    AV_RENDER_EVENT_VIDEO_RENDERED,          /*!< Video is rendered */
+    AV_RENDER_EVENT_AUDIO_EOS,               /*!< Audio stream eos */
+    AV_RENDER_EVENT_VIDEO_EOS,               /*!< Video stream eos */
+    AV_RENDER_EVENT_AUDIO_DECODE_ERR,        /*!< Audio decode error */
+    AV_RENDER_EVENT_VIDEO_DECODE_ERR,        /*!< Video decode error */
+    AV_RENDER_EVENT_VIDEO_KEY_FRAME_REQUEST, /*!< Video skips frames until next key frame, request key frame from sender to recover quickly */
 } av_render_event_t;
 
 /**
@@ -206,6 +310,11 @@ int av_render_add_video_stream(av_render_handle_t render, av_render_video_info_t
  *
  * @note  When input audio and video data is in data pool, to avoid extra copy, need need provide pool free API
  *        When AV render not use it, it will call provided free API to release the pool data
+ *        Data is passed to decode thread by reference, raw video is also passed to render thread by reference
+ *        To use reference counted frame pool, create pool by `av_render_pool_create`, set `free` to
+ *        `av_render_pool_free_data` and `ctx` to the pool, data acquired by `av_render_pool_acquire` can then be
+ *        added directly
+ *        Need call it before add stream
  *
  * @param[in]  render    AV render handle
  * @param[in]  free      API to free data pool
@@ -233,6 +342,7 @@ int av_render_add_audio_data(av_render_handle_t render, av_render_audio_data_t *
  * @brief  Set audio threshold
  *
  * @note  Audio will not render until reach this threshold
+ *        When adaptive audio buffer enabled, it is used as lower bound of target depth
  *
  * @param[in]  render           AV render handle
  * @param[in]  audio_threshold  Audio threshold
@@ -328,6 +438,110 @@ int av_render_pause(av_render_handle_t render, bool pause);
  */
 int av_render_set_speed(av_render_handle_t render, float speed);
 
+/**
+ * @brief  Get adaptive audio buffer statistics
+ *
+ * @param[in]   render  AV render handle
+ * @param[out]  stats   Adaptive audio buffer statistics
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_NOT_SUPPORT  Adaptive audio buffer not enabled
+ */
+int av_render_get_audio_jitter_stats(av_render_handle_t render, av_render_audio_jitter_stats_t *stats);
+
+/**
+ * @brief  Get video drop statistics
+ *
+ * @note  When `allow_drop_data` set, H264 non-reference frames are dropped first when video falls behind
+ *        Reference frame is only dropped when far behind, then frames are skipped until next IDR
+ *        and `AV_RENDER_EVENT_VIDEO_KEY_FRAME_REQUEST` is sent so that no corrupted frame is rendered
+ *
+ * @param[in]   render  AV render handle
+ * @param[out]  stats   Video drop statistics
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_WRONG_STATE  No video stream added
+ */
+int av_render_get_video_drop_stats(av_render_handle_t render, av_render_video_drop_stats_t *stats);
+
+/**
+ * @brief  Get video frame rate measured from PTS of added video data
+ *
+ * @note  Lost, late and reordered frames do not change the measured rate, variable frame rate is followed
+ *        Video pacing uses measured rate once confidence reaches 50, or at once if stream fps is 0
+ *        Under large jitter rate of delivered frames is reported with low confidence
+ *
+ * @param[in]   render  AV render handle
+ * @param[out]  rate    Measured frame rate
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_WRONG_STATE  No video stream added
+ */
+int av_render_get_video_rate(av_render_handle_t render, av_render_video_rate_t *rate);
+
+/**
+ * @brief  Get statistics snapshot of audio or video stream
+ *
+ * @note  Statistics are updated lock-free by pipeline threads, calling it never stalls playback
+ *        Statistics accumulate across streams until `av_render_reset_stream_stats`
+ *
+ * @param[in]   render  AV render handle
+ * @param[in]   type    Stream type
+ * @param[out]  stats   Stream statistics
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ */
+int av_render_get_stream_stats(av_render_handle_t render, av_render_stream_type_t type, av_render_stream_stats_t *stats);
+
+/**
+ * @brief  Clear statistics of audio or video stream
+ *
+ * @param[in]  render  AV render handle
+ * @param[in]  type    Stream type
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ */
+int av_render_reset_stream_stats(av_render_handle_t render, av_render_stream_type_t type);
+
+/**
+ * @brief  Get A/V sync statistics
+ *
+ * @param[in]   render  AV render handle
+ * @param[out]  stats   Sync statistics
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_WRONG_STATE  Media clock not started yet
+ */
+int av_render_get_sync_stats(av_render_handle_t render, av_render_sync_stats_t *stats);
+
+/**
+ * @brief  Get playback latency
+ *
+ * @note  Total latency covers decoder, render fifo and render device
+ *        Add network and capture delay of sender to get mouth-to-ear latency
+ *
+ * @param[in]   render   AV render handle
+ * @param[out]  latency  Playback latency
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_WRONG_STATE  No stream rendered yet
+ */
+int av_render_get_latency(av_render_handle_t render, av_render_latency_t *latency);
+
 /**
  * @brief  Flush for AV render
  *
@@ -381,10 +595,40 @@ int av_render_get_render_pts(av_render_handle_t h, uint32_t *pts);
  */
 int av_render_query(av_render_handle_t h);
 
+/**
+ * @brief  Start to record data fed into AV render
+ *
+ * @note  Each call of stream, data and playback control API is written as one framed record with PTS and arrival time
+ *        Record can be replayed through `av_render_record_read` or host tool under `tools/replay`
+ *        Call it before adding stream so that stream information is recorded
+ *
+ * @param[in]  h     AV render handle
+ * @param[in]  path  Record file path
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_WRITE_DATA   Fail to create record file
+ */
+int av_render_start_record(av_render_handle_t h, const char *path);
+
+/**
+ * @brief  Stop recording
+ *
+ * @param[in]  h  AV render handle
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ */
+int av_render_stop_record(av_render_handle_t h);
+
 /**
  * @brief  Dump data for AV render
  *
  * @note  This API is used for debug only
+ *        Bit 1 dumps audio render data and bit 3 dumps video render data into `/sdcard`
+ *        Decoder input is no longer dumped, use `av_render_start_record` instead
  *
  * @param[in]  h     AV render handle
  * @param[in]  mask  Dump mask
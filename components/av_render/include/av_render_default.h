@@ -47,16 +47,27 @@ typedef struct {
     audio_render_ref_cb    cb;           /*!< Reference output callback */
     bool                   fixed_clock;  /*!< Fixed clock mode */
     void                  *ctx;          /*!< User context */
+    uint32_t               dma_samples;  /*!< Samples per channel held by I2S DMA buffer (`dma_desc_num * dma_frame_num`)
+                                              Used to report playback latency, set to 0 to use I2S default 6 * 240 */
 } i2s_render_cfg_t;
 
 /**
  * @brief  LCD render configuration
  */
 typedef struct {
-    esp_lcd_panel_handle_t lcd_handle;        /*!< LCD display handle */
-    bool                   rgb_panel;         /*!< Whether RGB panel */
-    bool                   dsi_panel;         /*!< Whether DSI panel */
-    bool                   use_frame_buffer;  /*!< Use display frame buffer */
+    esp_lcd_panel_handle_t      lcd_handle;        /*!< LCD display handle */
+    bool                        rgb_panel;         /*!< Whether RGB panel */
+    bool                        dsi_panel;         /*!< Whether DSI panel */
+    bool                        use_frame_buffer;  /*!< Use display frame buffer */
+    av_render_video_transform_t transform;         /*!< Scale, rotate and mirror decoded frame to fit panel
+                                                        Done together with color convert and written into frame buffer directly */
+    uint8_t                     refresh_rate;      /*!< Panel refresh rate, used to report display latency, set to 0 to use 60 */
+    uint8_t                     fb_num;            /*!< Frame buffers to use when `use_frame_buffer` set, 3 for triple buffering
+                                                        Must not exceed `num_fbs` of panel, set to 0 to use 2 */
+    bool                        async_draw;        /*!< Draw by strips in separate task for panel without frame buffer
+                                                        Frame is copied into staging buffer so that decode not wait for drawing */
+    bool                        dirty_update;      /*!< For panel without frame buffer only draw lines changed from last frame
+                                                        Keeps copy of last frame, shared with `async_draw` staging buffer */
 } lcd_render_cfg_t;
 
 /**
@@ -0,0 +1,115 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "av_render_types.h"
+#include "audio_render.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Audio mixer handle
+ */
+typedef struct av_render_mixer_t *av_render_mixer_handle_t;
+
+/**
+ * @brief  Audio mixer configuration
+ *
+ * @note  Mixer owns output render, it is opened on create and closed on destroy
+ *        Only 16 bits PCM is mixed, each source must output `out_info` format
+ *        Call `av_render_set_fixed_frame_info` on player of each source so that it resamples to it
+ */
+typedef struct {
+    audio_render_handle_t        out_render;    /*!< Render for mixed audio, like I2S render */
+    av_render_audio_frame_info_t out_info;      /*!< Mixed audio format */
+    uint16_t                     block_ms;      /*!< Mix block duration, set to 0 to use 10 ms */
+    uint16_t                     source_buf_ms; /*!< Audio buffered for each source while mixing, set to 0 to use 100 ms */
+    uint16_t                     fade_ms;       /*!< Time to fade gain change or ducking, set to 0 to use 50 ms */
+} av_render_mixer_cfg_t;
+
+/**
+ * @brief  Audio mixer source configuration
+ */
+typedef struct {
+    float   gain;      /*!< Linear gain of source, 1.0 to keep unchanged, maximum 4.0 */
+    uint8_t priority;  /*!< Source is ducked while any source of higher priority is open */
+    float   duck_gain; /*!< Linear gain applied on top of `gain` while ducked, 1.0 to not duck */
+} av_render_mixer_source_cfg_t;
+
+/**
+ * @brief  Create audio mixer
+ *
+ * @param[in]  cfg  Audio mixer configuration
+ *
+ * @return
+ *       - NULL    Invalid argument, no memory or fail to open output render
+ *       - Others  Audio mixer handle
+ */
+av_render_mixer_handle_t av_render_mixer_create(av_render_mixer_cfg_t *cfg);
+
+/**
+ * @brief  Allocate audio render as mixer source
+ *
+ * @note  Use returned handle as `audio_render` of `av_render_cfg_t`, each source has its own player so that
+ *        decoder, sample rate and playback control are independent
+ *        When only one source is open with unity gain its data is written to output render directly without copy
+ *        Free it by `audio_render_free_handle` after player closed
+ *
+ * @param[in]  mixer  Audio mixer handle
+ * @param[in]  cfg    Source configuration
+ *
+ * @return
+ *       - NULL    Invalid argument, no memory or too many sources
+ *       - Others  Audio render handle of source
+ */
+audio_render_handle_t av_render_mixer_alloc_source(av_render_mixer_handle_t mixer, av_render_mixer_source_cfg_t *cfg);
+
+/**
+ * @brief  Set gain of mixer source
+ *
+ * @param[in]  mixer   Audio mixer handle
+ * @param[in]  source  Audio render handle of source
+ * @param[in]  gain    Linear gain, maximum 4.0
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument or not source of this mixer
+ */
+int av_render_mixer_set_gain(av_render_mixer_handle_t mixer, audio_render_handle_t source, float gain);
+
+/**
+ * @brief  Destroy audio mixer
+ *
+ * @note  All sources should be freed before destroy
+ *
+ * @param[in]  mixer  Audio mixer handle
+ */
+void av_render_mixer_destroy(av_render_mixer_handle_t mixer);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,150 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  AV render frame pool handle
+ */
+typedef struct av_render_pool_t *av_render_pool_handle_t;
+
+/**
+ * @brief  AV render frame pool configuration
+ *
+ * @note  Pool is made of `block_num` fixed size slabs, typically one pool is created for each stream
+ *        with `block_size` set to the maximum frame size of the stream
+ */
+typedef struct {
+    uint32_t block_size; /*!< Maximum data size of each slab */
+    uint16_t block_num;  /*!< Number of slabs */
+    uint8_t  align;      /*!< Alignment of slab data (power of 2), set to 0 to use default 16 bytes */
+} av_render_pool_cfg_t;
+
+/**
+ * @brief  AV render frame pool statistics
+ */
+typedef struct {
+    uint32_t block_size;  /*!< Maximum data size of each slab */
+    uint16_t block_num;   /*!< Number of slabs */
+    uint16_t free_num;    /*!< Current free slabs */
+    uint16_t peak_used;   /*!< Peak slabs in use since pool created */
+    uint32_t acquire_num; /*!< Total successful acquire count */
+    uint32_t fail_num;    /*!< Acquire failed for timeout or oversize */
+} av_render_pool_stats_t;
+
+/**
+ * @brief  Create frame pool
+ *
+ * @param[in]  cfg  Frame pool configuration
+ *
+ * @return
+ *       - NULL    Invalid argument or no memory
+ *       - Others  Frame pool handle
+ */
+av_render_pool_handle_t av_render_pool_create(av_render_pool_cfg_t *cfg);
+
+/**
+ * @brief  Acquire one slab from frame pool
+ *
+ * @note  The returned slab has reference count 1, it is returned to pool when last reference released
+ *
+ * @param[in]  pool     Frame pool handle
+ * @param[in]  size     Wanted data size, must not exceed `block_size`
+ * @param[in]  timeout  Time to wait for free slab (unit ms), `MEDIA_LIB_MAX_LOCK_TIME` to wait forever
+ *
+ * @return
+ *       - NULL    No free slab in time or size too big
+ *       - Others  Slab data pointer
+ */
+uint8_t *av_render_pool_acquire(av_render_pool_handle_t pool, uint32_t size, uint32_t timeout);
+
+/**
+ * @brief  Add reference to slab
+ *
+ * @param[in]  pool  Frame pool handle
+ * @param[in]  data  Slab data pointer returned by `av_render_pool_acquire`
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Not slab data pointer of this pool
+ *       - ESP_MEDIA_ERR_WRONG_STATE  Slab already returned to pool
+ */
+int av_render_pool_add_ref(av_render_pool_handle_t pool, uint8_t *data);
+
+/**
+ * @brief  Release reference of slab
+ *
+ * @param[in]  pool  Frame pool handle
+ * @param[in]  data  Slab data pointer returned by `av_render_pool_acquire`
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Not slab data pointer of this pool
+ *       - ESP_MEDIA_ERR_WRONG_STATE  Slab already returned to pool
+ */
+int av_render_pool_release(av_render_pool_handle_t pool, uint8_t *data);
+
+/**
+ * @brief  Data pool free callback for frame pool
+ *
+ * @note  Pass it with pool as `ctx` to `av_render_use_data_pool` so that AV render releases slab after use
+ *        Audio and video data then both need come from this pool
+ *        To use separate pools, provide own free callback which calls `av_render_pool_release` on each pool,
+ *        release only accepts pointer inside the pool, so it is safe to try pools one by one
+ *
+ * @param[in]  data  Slab data pointer
+ * @param[in]  ctx   Frame pool handle
+ */
+void av_render_pool_free_data(void *data, void *ctx);
+
+/**
+ * @brief  Get frame pool statistics
+ *
+ * @param[in]   pool   Frame pool handle
+ * @param[out]  stats  Frame pool statistics
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ */
+int av_render_pool_get_stats(av_render_pool_handle_t pool, av_render_pool_stats_t *stats);
+
+/**
+ * @brief  Destroy frame pool
+ *
+ * @note  All slabs should be released before destroy, call it after `av_render_close` or `av_render_reset`
+ *
+ * @param[in]  pool  Frame pool handle
+ */
+void av_render_pool_destroy(av_render_pool_handle_t pool);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,157 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "av_render.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  AV render record file
+ *
+ * @note  Record file keeps every call which feeds `av_render` with its arrival time so that it can be replayed later
+ *        All fields are little endian:
+ *          File header: magic "AVRR", version (u16), reserved (u16)
+ *          Each record: type (u8), flags (u8), reserved (u16), payload size (u32), pts (u32),
+ *                       arrival time since record start in microseconds (u64), payload
+ */
+#define AV_RENDER_RECORD_VERSION (1)
+
+/**
+ * @brief  AV render record type
+ */
+typedef enum {
+    AV_RENDER_RECORD_TYPE_NONE,            /*!< Invalid record type */
+    AV_RENDER_RECORD_TYPE_CONFIG,          /*!< Render configuration when record started */
+    AV_RENDER_RECORD_TYPE_AUDIO_STREAM,    /*!< Call of `av_render_add_audio_stream` */
+    AV_RENDER_RECORD_TYPE_VIDEO_STREAM,    /*!< Call of `av_render_add_video_stream` */
+    AV_RENDER_RECORD_TYPE_AUDIO_DATA,      /*!< Call of `av_render_add_audio_data` */
+    AV_RENDER_RECORD_TYPE_VIDEO_DATA,      /*!< Call of `av_render_add_video_data` */
+    AV_RENDER_RECORD_TYPE_FIXED_INFO,      /*!< Call of `av_render_set_fixed_frame_info` */
+    AV_RENDER_RECORD_TYPE_AUDIO_THRESHOLD, /*!< Call of `av_render_set_audio_threshold` */
+    AV_RENDER_RECORD_TYPE_SPEED,           /*!< Call of `av_render_set_speed` */
+    AV_RENDER_RECORD_TYPE_PAUSE,           /*!< Call of `av_render_pause` */
+    AV_RENDER_RECORD_TYPE_FLUSH,           /*!< Call of `av_render_flush` */
+    AV_RENDER_RECORD_TYPE_RESET,           /*!< Call of `av_render_reset` */
+} av_render_record_type_t;
+
+/**
+ * @brief  AV render record item
+ *
+ * @note  When read, data and codec specified information point to reader buffer, valid until next read
+ */
+typedef struct {
+    av_render_record_type_t type;    /*!< Record type */
+    uint64_t                time_us; /*!< Arrival time since record start in microseconds */
+    union {
+        av_render_cfg_t              cfg;             /*!< Render configuration, render handles and context are not kept */
+        av_render_audio_info_t       audio_info;      /*!< Audio stream information */
+        av_render_video_info_t       video_info;      /*!< Video stream information */
+        av_render_audio_data_t       audio_data;      /*!< Audio data */
+        av_render_video_data_t       video_data;      /*!< Video data */
+        av_render_audio_frame_info_t fixed_info;      /*!< Fixed audio output frame information */
+        uint32_t                     audio_threshold; /*!< Audio threshold */
+        float                        speed;           /*!< Playback speed */
+        bool                         pause;           /*!< Pause or resume */
+    };
+} av_render_record_item_t;
+
+/**
+ * @brief  AV render record handle
+ */
+typedef struct av_render_record_t *av_render_record_handle_t;
+
+/**
+ * @brief  Create record file for write
+ *
+ * @param[in]   path    File path
+ * @param[out]  record  Record handle
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_NO_MEM       No memory
+ *       - ESP_MEDIA_ERR_WRITE_DATA   Fail to create file
+ */
+int av_render_record_create(const char *path, av_render_record_handle_t *record);
+
+/**
+ * @brief  Write one item into record file
+ *
+ * @param[in]  record  Record handle
+ * @param[in]  item    Record item
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_WRITE_DATA   Fail to write file
+ */
+int av_render_record_write(av_render_record_handle_t record, av_render_record_item_t *item);
+
+/**
+ * @brief  Open record file for read
+ *
+ * @param[in]   path    File path
+ * @param[out]  record  Record handle
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK                On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG       Invalid argument
+ *       - ESP_MEDIA_ERR_NO_MEM            No memory
+ *       - ESP_MEDIA_ERR_READ_DATA         Fail to open file
+ *       - ESP_MEDIA_ERR_BAD_DATA          Not a record file
+ *       - ESP_MEDIA_ERR_INVALID_VERSION   Record version not supported
+ */
+int av_render_record_open(const char *path, av_render_record_handle_t *record);
+
+/**
+ * @brief  Read next item from record file
+ *
+ * @note  Unknown record types written by newer version are skipped
+ *
+ * @param[in]   record  Record handle
+ * @param[out]  item    Record item
+ *
+ * @return
+ *       - ESP_MEDIA_ERR_OK           On success
+ *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
+ *       - ESP_MEDIA_ERR_NOT_FOUND    Reach end of file
+ *       - ESP_MEDIA_ERR_BAD_DATA     Record truncated or corrupted
+ *       - ESP_MEDIA_ERR_NO_MEM       No memory for record payload
+ */
+int av_render_record_read(av_render_record_handle_t record, av_render_record_item_t *item);
+
+/**
+ * @brief  Close record file
+ *
+ * @param[in]  record  Record handle
+ */
+void av_render_record_close(av_render_record_handle_t record);
+
+#ifdef __cplusplus
+}
+#endif
@@ -110,13 +110,50 @@ typedef struct {
  */
 typedef enum {
     AV_RENDER_VIDEO_RAW_TYPE_NONE,      /*!< Invalid video render frame type */
-    AV_RENDER_VIDEO_RAW_TYPE_YUV422,    /*!< YUV422 frame type */
-    AV_RENDER_VIDEO_RAW_TYPE_YUV420,    /*!< YUV420 frame type */
+    AV_RENDER_VIDEO_RAW_TYPE_YUV422,    /*!< YUV422 planar frame type */
+    AV_RENDER_VIDEO_RAW_TYPE_YUV420,    /*!< YUV420 planar frame type */
     AV_RENDER_VIDEO_RAW_TYPE_RGB565,    /*!< RGB565 frame type */
     AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE, /*!< RGB565 bigedian frame type */
+    AV_RENDER_VIDEO_RAW_TYPE_NV12,      /*!< YUV420 with Y plane followed by interleaved UV plane */
+    AV_RENDER_VIDEO_RAW_TYPE_NV21,      /*!< YUV420 with Y plane followed by interleaved VU plane */
+    AV_RENDER_VIDEO_RAW_TYPE_YUYV,      /*!< YUV422 packed in Y0 U Y1 V order */
+    AV_RENDER_VIDEO_RAW_TYPE_UYVY,      /*!< YUV422 packed in U Y0 V Y1 order */
+    AV_RENDER_VIDEO_RAW_TYPE_RGB888,    /*!< RGB888 frame type in R G B byte order */
     AV_RENDER_VIDEO_RAW_TYPE_MAX,       /*!< Maximum of video render frame type */
 } av_render_video_frame_type_t;
 
+/**
+ * @brief  Video rotation in clockwise direction
+ */
+typedef enum {
+    AV_RENDER_VIDEO_ROTATE_NONE, /*!< No rotation */
+    AV_RENDER_VIDEO_ROTATE_90,   /*!< Rotate 90 degree */
+    AV_RENDER_VIDEO_ROTATE_180,  /*!< Rotate 180 degree */
+    AV_RENDER_VIDEO_ROTATE_270,  /*!< Rotate 270 degree */
+} av_render_video_rotate_t;
+
+/**
+ * @brief  Video scale filter
+ */
+typedef enum {
+    AV_RENDER_VIDEO_SCALE_NEAREST,  /*!< Nearest neighbor, fastest */
+    AV_RENDER_VIDEO_SCALE_BILINEAR, /*!< Bilinear interpolation, smoother */
+} av_render_video_scale_t;
+
+/**
+ * @brief  Video transform done together with color convert
+ *
+ * @note  Source is mirrored firstly, then rotated and scaled to `width` x `height`
+ *        Set all fields to 0 to keep decoded frame as is
+ */
+typedef struct {
+    uint16_t                 width;  /*!< Output width after rotation, 0 to use rotated source width */
+    uint16_t                 height; /*!< Output height after rotation, 0 to use rotated source height */
+    av_render_video_rotate_t rotate; /*!< Rotation */
+    bool                     mirror; /*!< Mirror horizontally */
+    av_render_video_scale_t  scale;  /*!< Scale filter */
+} av_render_video_transform_t;
+
 /**
  * @brief video render frame information
  */
@@ -151,13 +188,14 @@ typedef struct {
  * @brief Video information
  */
 typedef struct {
-    av_render_video_codec_t codec;           /*!< Video codec type */
-    uint16_t                width;           /*!< Video width */
-    uint16_t                height;          /*!< Video height */
-    uint8_t                 fps;             /*!< Video framerate per second */
-    void                   *codec_spec_info; /*!< Video codec specified info,
-                                                 For H264 need to provide SPS and PPS information*/
-    int                     spec_info_len;   /*!< Video codec specified information length */
+    av_render_video_codec_t     codec;           /*!< Video codec type */
+    uint16_t                    width;           /*!< Video width */
+    uint16_t                    height;          /*!< Video height */
+    uint8_t                     fps;             /*!< Video framerate per second */
+    void                       *codec_spec_info; /*!< Video codec specified info,
+                                                     For H264 need to provide SPS and PPS information*/
+    int                         spec_info_len;   /*!< Video codec specified information length */
+    av_render_video_transform_t transform;       /*!< Transform for decoded stream, if not set use video render one */
 } av_render_video_info_t;
 
 /**
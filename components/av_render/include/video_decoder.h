@@ -84,6 +84,9 @@ vdec_handle_t vdec_open(vdec_cfg_t *cfg);
 /**
  * @brief  Set frame buffer callback
  *
+ * @note  Decoded frame (or color converted frame) is always written into buffer got from `fb_fetch`
+ *        If not set, decoder uses buffer allocated by itself
+ *
  * @param[in]  h    Video decoder handle
  * @param[in]  cfg  Frame buffer callback configuration
  *
@@ -107,17 +110,18 @@ int vdec_set_fb_cb(vdec_handle_t h, vdec_fb_cb_cfg_t *cfg);
 int vdec_decode(vdec_handle_t h, av_render_video_data_t *data);
 
 /**
- * @brief  Set frame buffer
+ * @brief  Get color convert time of last decoded frame
+ *
+ * @note  It is 0 when decoder output format is used directly
  *
- * @param[in]  h       Video decoder handle
- * @param[in]  buffer  Frame buffer to put decoded data
+ * @param[in]   h           Video decoder handle
+ * @param[out]  convert_us  Color convert time in microseconds
  *
  * @return
  *       - ESP_MEDIA_ERR_OK           On success
  *       - ESP_MEDIA_ERR_INVALID_ARG  Invalid argument
- *       - Other                      Fail to decode
  */
-int vdec_set_frame_buffer(vdec_handle_t h, av_render_frame_buffer_t *buffer);
+int vdec_get_convert_time(vdec_handle_t h, uint32_t *convert_us);
 
 /**
  * @brief  Get frame information from video decoder
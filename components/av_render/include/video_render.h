@@ -74,6 +74,26 @@ typedef int (*video_render_clear_func)(video_render_handle_t render);
  */
 typedef int (*video_render_close_func)(video_render_handle_t render);
 
+/**
+ * @brief  Get wanted transform of video render callback
+ */
+typedef int (*video_render_get_transform_func)(video_render_handle_t render, av_render_video_transform_t *transform);
+
+/**
+ * @brief  Video render presentation statistics
+ */
+typedef struct {
+    uint32_t present_num;  /*!< Frames shown on display */
+    uint32_t drop_num;     /*!< Frames replaced by newer frame before shown */
+    uint32_t interval_us;  /*!< Average interval between shown frames */
+    uint32_t jitter_us;    /*!< Average deviation of interval between shown frames */
+} video_render_stats_t;
+
+/**
+ * @brief  Get presentation statistics of video render callback
+ */
+typedef int (*video_render_get_stats_func)(video_render_handle_t render, video_render_stats_t *stats);
+
 /**
  * @brief  Video render operations
  */
@@ -87,6 +107,8 @@ typedef struct _render_video_ops {
     video_render_get_frame_info_func   get_frame_info;   /*!< Get frame information */
     video_render_clear_func            clear;            /*!< Clear of video render */
     video_render_close_func            close;            /*!< Close of video render */
+    video_render_get_transform_func    get_transform;    /*!< Get wanted transform (optional) */
+    video_render_get_stats_func        get_stats;        /*!< Get presentation statistics (optional) */
 } video_render_ops_t;
 
 /**
@@ -181,6 +203,36 @@ int video_render_get_frame_buffer(video_render_handle_t render, av_render_frame_
  */
 int video_render_get_frame_info(video_render_handle_t render, av_render_video_frame_info_t *info);
 
+/**
+ * @brief  Get transform wanted by video render
+ *
+ * @note  Render like LCD can ask decoded frame to be scaled, rotated or mirrored to fit the panel
+ *
+ * @param[in]   render     Video render handle
+ * @param[out]  transform  Transform wanted by video render
+ *
+ * @return
+ *       - 0                          On success
+ *       - ESP_MEDIA_ERR_NOT_SUPPORT  Render not support transform
+ *       - Others                     Fail to get
+ */
+int video_render_get_transform(video_render_handle_t render, av_render_video_transform_t *transform);
+
+/**
+ * @brief  Get presentation statistics of video render
+ *
+ * @note  Used to check pacing of shown frames and frames dropped by display
+ *
+ * @param[in]   render  Video render handle
+ * @param[out]  stats   Presentation statistics
+ *
+ * @return
+ *       - 0                          On success
+ *       - ESP_MEDIA_ERR_NOT_SUPPORT  Render not support statistics
+ *       - Others                     Fail to get
+ */
+int video_render_get_stats(video_render_handle_t render, video_render_stats_t *stats);
+
 /**
  * @brief  Close of video render
  *
@@ -27,6 +27,7 @@
 #include "esp_codec_dev.h"
 #include "esp_log.h"
 #include "esp_ae_sonic.h"
+#include "esp_timer.h"
 
 #define TAG "I2S_RENDER"
 
@@ -34,6 +35,11 @@
 
 #define DEFALUT_SONIC_OUT_SAMPLES (1024 * 4)
 
+// Same as `dma_desc_num * dma_frame_num` of I2S default channel configuration
+#define DEFAULT_DMA_SAMPLES (6 * 240)
+// Write takes longer than it only when waiting DMA buffer free
+#define WRITE_BLOCKED_US (2000)
+
 typedef struct {
     audio_render_ref_cb          ref_cb;
     av_render_audio_frame_info_t info;
@@ -44,6 +50,10 @@ typedef struct {
     bool                         sonic_enable;
     char                        *sonic_out;
     int                          sonic_out_size;
+    float                        speed;
+    float                        sonic_pending; /* Input samples kept inside sonic */
+    uint32_t                     dma_samples;
+    uint32_t                     play_end;      /* Time when written audio finish playing (unit us) */
 } i2s_render_t;
 
 static audio_render_handle_t i2s_render_init(void *cfg, int cfg_size)
@@ -60,6 +70,8 @@ static audio_render_handle_t i2s_render_init(void *cfg, int cfg_size)
     i2s->ref_ctx = i2s_cfg->ctx;
     i2s->fixed_clock = i2s_cfg->fixed_clock;
     i2s->play_handle = i2s_cfg->play_handle;
+    i2s->dma_samples = i2s_cfg->dma_samples ? i2s_cfg->dma_samples : DEFAULT_DMA_SAMPLES;
+    i2s->speed = 1.0f;
     if (i2s->play_handle == NULL) {
         ESP_LOGE(TAG, "Play device not exists");
         media_lib_free(i2s);
@@ -84,10 +96,39 @@ static int i2s_render_open(audio_render_handle_t render, av_render_audio_frame_i
     int ret = esp_codec_dev_open(i2s->play_handle, &fs);
     if (ret == 0) {
         memcpy(&i2s->info, info, sizeof(av_render_audio_frame_info_t));
+        i2s->play_end = (uint32_t)esp_timer_get_time();
     }
     return ret;
 }
 
+static uint32_t samples_to_us(i2s_render_t *i2s, uint32_t samples)
+{
+    return i2s->info.sample_rate ? (uint32_t)((uint64_t)samples * 1000000 / i2s->info.sample_rate) : 0;
+}
+
+static int i2s_render_play(i2s_render_t *i2s, uint8_t *data, int size)
+{
+    uint32_t start = (uint32_t)esp_timer_get_time();
+    int ret = esp_codec_dev_write(i2s->play_handle, data, size);
+    if (ret != 0) {
+        return ret;
+    }
+    // DMA drains at sample rate, track when written audio finish playing
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    uint32_t dma_us = samples_to_us(i2s, i2s->dma_samples);
+    uint32_t end = (int32_t)(i2s->play_end - start) > 0 ? i2s->play_end : start;
+    end += samples_to_us(i2s, size / SAMPLE_SIZE(i2s->info));
+    // Blocked write means DMA is full when it returns
+    if ((int32_t)(now - start) > WRITE_BLOCKED_US || (int32_t)(end - now) > (int32_t)dma_us) {
+        end = now + dma_us;
+    }
+    i2s->play_end = end;
+    if (i2s->ref_cb) {
+        i2s->ref_cb(data, size, i2s->ref_ctx);
+    }
+    return 0;
+}
+
 static int i2s_render_write(audio_render_handle_t render, av_render_audio_frame_t *audio_data)
 {
     if (render == NULL || audio_data == NULL) {
@@ -105,28 +146,33 @@ static int i2s_render_write(audio_render_handle_t render, av_render_audio_frame_
             .samples = i2s->sonic_out,
             .needed_num = DEFALUT_SONIC_OUT_SAMPLES,
         };
+        int consumed = 0;
         while (sample_num > 0) {
+            in_samples.num = sample_num;
+            in_samples.samples = audio_data->data + consumed * SAMPLE_SIZE(i2s->info);
             ret = esp_ae_sonic_process(i2s->sonic_handle, &in_samples, &out_samples);
             if (ret != ESP_AE_ERR_OK) {
                 printf("sonic process error\n");
                 return -1;
             }
-            if (out_samples.out_num == 0) {
-                break;
+            if (out_samples.out_num) {
+                // Reference need match what is played after time stretch
+                int out_size = out_samples.out_num * SAMPLE_SIZE(i2s->info);
+                ret = i2s_render_play(i2s, (uint8_t *)out_samples.samples, out_size);
             }
-            ret = esp_codec_dev_write(i2s->play_handle, out_samples.samples, out_samples.out_num * SAMPLE_SIZE(i2s->info));
-            if (ret == 0 && i2s->ref_cb) {
-                i2s->ref_cb(audio_data->data, audio_data->size, i2s->ref_ctx);
+            i2s->sonic_pending += in_samples.consume_num - out_samples.out_num * i2s->speed;
+            if (i2s->sonic_pending < 0) {
+                i2s->sonic_pending = 0;
+            }
+            // Sonic may keep input internally without output, only stop when nothing consumed
+            if (in_samples.consume_num == 0 && out_samples.out_num == 0) {
+                break;
             }
             sample_num -= in_samples.consume_num;
-            in_samples.num = sample_num;
-            in_samples.samples = audio_data->data + in_samples.consume_num * SAMPLE_SIZE(i2s->info);
+            consumed += in_samples.consume_num;
         }
     } else {
-        int ret = esp_codec_dev_write(i2s->play_handle, audio_data->data, audio_data->size);
-        if (ret == 0 && i2s->ref_cb) {
-            i2s->ref_cb(audio_data->data, audio_data->size, i2s->ref_ctx);
-        }
+        ret = i2s_render_play(i2s, audio_data->data, audio_data->size);
     }
     return ret;
 }
@@ -136,7 +182,14 @@ static int i2s_render_get_latency(audio_render_handle_t render, uint32_t *latenc
     if (render == NULL) {
         return -1;
     }
-    *latency = 0;
+    i2s_render_t *i2s = (i2s_render_t *)render;
+    int32_t left = (int32_t)(i2s->play_end - (uint32_t)esp_timer_get_time());
+    uint32_t latency_us = left > 0 ? left : 0;
+    // Input kept by time stretch is played later at current speed
+    if (i2s->sonic_enable) {
+        latency_us += samples_to_us(i2s, (uint32_t)(i2s->sonic_pending / i2s->speed));
+    }
+    *latency = latency_us / 1000;
     return 0;
 }
 
@@ -172,6 +225,7 @@ static int i2s_render_set_speed(audio_render_handle_t render, float speed)
     }
     if (i2s->sonic_enable) {
         esp_ae_sonic_set_speed(i2s->sonic_handle, speed);
+        i2s->speed = speed;
     }
     return 0;
 }
@@ -192,6 +246,8 @@ static int i2s_render_close(audio_render_handle_t render)
         i2s->sonic_out = NULL;
     }
     i2s->sonic_enable = false;
+    i2s->sonic_pending = 0;
+    i2s->speed = 1.0f;
     return 0;
 }
 
@@ -28,6 +28,8 @@
 #include "media_lib_os.h"
 #include "esp_log.h"
 #include "esp_lcd_panel_ops.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #if SOC_LCD_RGB_SUPPORTED
 #include "esp_lcd_panel_rgb.h"
 #endif
@@ -38,28 +40,358 @@
 
 #define TAG "LCD_RENDER"
 
+// Maximum wait time for last frame transfer done or free frame buffer
+#define LCD_DRAW_TIMEOUT_MS (100)
+
+#define LCD_DEFAULT_REFRESH_RATE (60)
+#define LCD_MAX_FB_NUM           (3)
+#define LCD_STRIP_LINES          (40)
+#define LCD_BAND_LINES           (8)
+// Changed bands above this percentage are drawn as full frame
+#define LCD_DIRTY_FULL_PERCENT   (75)
+
 typedef struct {
     av_render_video_frame_info_t info;
     esp_lcd_panel_handle_t       handle;
     bool                         rgb_panel;
     bool                         dsi_panel;
-    uint8_t                     *frame_buffer[2];
-    bool                         sel;
+    uint8_t                     *frame_buffer[LCD_MAX_FB_NUM];
+    uint8_t                      fb_num;
+    int8_t                       fill_idx;    /* Frame buffer handed out for next frame */
+    int8_t                       pending_idx; /* Frame buffer submitted and waiting for vsync */
+    int8_t                       scan_idx;    /* Frame buffer being scanned out */
+    bool                         vsync_ready;
+    portMUX_TYPE                 lock;
+    SemaphoreHandle_t            vsync;
     uint32_t                     start_time;
     uint8_t                      frame_num;
-    bool                         drawing;
+    uint32_t                     refresh_us;
+    uint32_t                     last_vsync;
+    uint32_t                     last_present;
+    video_render_stats_t         stats;
+    uint32_t                     draw_start;
+    volatile uint32_t            draw_end;    /* Zero when transfer in flight */
+    uint32_t                     draw_cost;   /* Average transfer time of one frame (unit us) */
+    bool                         async_draw;
+    bool                         draw_quit;
+    uint8_t                     *stage;       /* Frame copy for async draw, also last drawn frame for dirty check */
+    int                          stage_size;
+    bool                         dirty_update;
+    bool                         stage_valid;
+    bool                         partial;     /* Only draw bands marked in dirty for current frame */
+    uint8_t                     *dirty;
+    int                          band_num;
+    media_lib_sema_handle_t      stage_free;
+    media_lib_sema_handle_t      stage_ready;
+    media_lib_sema_handle_t      draw_exit;
+#if CONFIG_IDF_TARGET_ESP32P4
+    SemaphoreHandle_t            draw_done;
+#endif
+    av_render_video_transform_t  transform;
 } lcd_render_t;
 
 static int lcd_render_close(video_render_handle_t h);
 
+static void lcd_update_draw_cost(lcd_render_t *lcd, uint32_t cost)
+{
+    // Smooth with 1/8 weight for new sample
+    lcd->draw_cost = lcd->draw_cost ? lcd->draw_cost - (lcd->draw_cost >> 3) + (cost >> 3) : cost;
+}
+
+static void lcd_frame_presented(lcd_render_t *lcd, uint32_t now)
+{
+    video_render_stats_t *stats = &lcd->stats;
+    uint32_t interval = now - lcd->last_present;
+    // Skip gap of pause or stream switch
+    if (stats->present_num && interval < 1000000) {
+        if (stats->interval_us == 0) {
+            stats->interval_us = interval;
+        } else {
+            // Smooth with 1/16 weight for new sample
+            int32_t dev = (int32_t)(interval - stats->interval_us);
+            stats->interval_us += dev / 16;
+            stats->jitter_us += ((dev < 0 ? -dev : dev) - (int32_t)stats->jitter_us) / 16;
+        }
+    }
+    lcd->last_present = now;
+    stats->present_num++;
+}
+
+static void lcd_draw_begin(lcd_render_t *lcd)
+{
+    // Latency query reads draw time from other thread
+    portENTER_CRITICAL(&lcd->lock);
+    lcd->draw_end = 0;
+    lcd->draw_start = (uint32_t)esp_timer_get_time();
+    portEXIT_CRITICAL(&lcd->lock);
+}
+
+#if SOC_LCD_RGB_SUPPORTED || CONFIG_IDF_TARGET_ESP32P4
+static bool lcd_on_vsync(lcd_render_t *lcd)
+{
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    bool presented = false;
+    portENTER_CRITICAL_ISR(&lcd->lock);
+    lcd->last_vsync = now;
+    // Submitted frame buffer is scanned from now on, the old one become free
+    if (lcd->pending_idx >= 0) {
+        lcd->scan_idx = lcd->pending_idx;
+        lcd->pending_idx = -1;
+        lcd_frame_presented(lcd, now);
+        presented = true;
+    }
+    portEXIT_CRITICAL_ISR(&lcd->lock);
+    BaseType_t need_yield = pdFALSE;
+    if (presented) {
+        xSemaphoreGiveFromISR(lcd->vsync, &need_yield);
+    }
+    return need_yield == pdTRUE;
+}
+#endif
+
+#if SOC_LCD_RGB_SUPPORTED
+static bool rgb_vsync(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *data, void *ctx)
+{
+    return lcd_on_vsync((lcd_render_t *)ctx);
+}
+#endif
+
 #if CONFIG_IDF_TARGET_ESP32P4
+static bool dpi_refresh_done(esp_lcd_panel_handle_t panel, esp_lcd_dpi_panel_event_data_t *data, void *ctx)
+{
+    return lcd_on_vsync((lcd_render_t *)ctx);
+}
+
 static bool draw_finished(esp_lcd_panel_handle_t panel, esp_lcd_dpi_panel_event_data_t *data, void *ctx)
 {
     lcd_render_t *lcd = (lcd_render_t *)ctx;
-    lcd->drawing      = false;
-    return true;
+    portENTER_CRITICAL_ISR(&lcd->lock);
+    lcd->draw_end = (uint32_t)esp_timer_get_time();
+    portEXIT_CRITICAL_ISR(&lcd->lock);
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(lcd->draw_done, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+static int dsi_draw_frame(lcd_render_t *lcd, uint8_t *data)
+{
+    // Block until last transfer done, woken by transfer done interrupt
+    if (xSemaphoreTake(lcd->draw_done, pdMS_TO_TICKS(LCD_DRAW_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Wait for last frame draw timeout");
+    } else if (lcd->draw_end) {
+        lcd_update_draw_cost(lcd, lcd->draw_end - lcd->draw_start);
+        portENTER_CRITICAL(&lcd->lock);
+        lcd_frame_presented(lcd, lcd->draw_end);
+        portEXIT_CRITICAL(&lcd->lock);
+    }
+    lcd_draw_begin(lcd);
+    int ret = esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, lcd->info.width, lcd->info.height, data);
+    if (ret != ESP_OK) {
+        // Transfer not started, no done interrupt will come
+        portENTER_CRITICAL(&lcd->lock);
+        lcd->draw_end = lcd->draw_start;
+        portEXIT_CRITICAL(&lcd->lock);
+        xSemaphoreGive(lcd->draw_done);
+    }
+    return ret;
+}
+#endif
+
+static int lcd_draw_strips(lcd_render_t *lcd, uint8_t *rgb_data, uint8_t *dirty)
+{
+    int w = lcd->info.width;
+    int h = lcd->info.height;
+    int y = 0;
+    int ret = 0;
+    lcd_draw_begin(lcd);
+    while (y < h) {
+        if (dirty && dirty[y / LCD_BAND_LINES] == 0) {
+            y += LCD_BAND_LINES;
+            continue;
+        }
+        // Merge following changed bands into one strip
+        int n = LCD_BAND_LINES;
+        while (n < LCD_STRIP_LINES && y + n < h && (dirty == NULL || dirty[(y + n) / LCD_BAND_LINES])) {
+            n += LCD_BAND_LINES;
+        }
+        if (y + n > h) {
+            n = h - y;
+        }
+        ret = esp_lcd_panel_draw_bitmap(lcd->handle, 0, y, w, y + n, rgb_data + y * w * 2);
+        y += n;
+    }
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    lcd_update_draw_cost(lcd, now - lcd->draw_start);
+    portENTER_CRITICAL(&lcd->lock);
+    lcd_frame_presented(lcd, now);
+    lcd->draw_end = now;
+    portEXIT_CRITICAL(&lcd->lock);
+    return ret;
+}
+
+static void lcd_copy_frame(lcd_render_t *lcd, uint8_t *rgb_data, int size)
+{
+    if (lcd->dirty_update == false) {
+        memcpy(lcd->stage, rgb_data, size);
+        return;
+    }
+    // Compare with last drawn frame by bands, only copy and mark changed ones
+    int band_size = lcd->info.width * 2 * LCD_BAND_LINES;
+    int dirty_num = 0;
+    for (int i = 0; i < lcd->band_num; i++) {
+        int offset = i * band_size;
+        int len = offset + band_size > size ? size - offset : band_size;
+        lcd->dirty[i] = (lcd->stage_valid == false || memcmp(lcd->stage + offset, rgb_data + offset, len) != 0);
+        if (lcd->dirty[i]) {
+            memcpy(lcd->stage + offset, rgb_data + offset, len);
+            dirty_num++;
+        }
+    }
+    lcd->stage_valid = true;
+    // Too many scattered strips cost more than one full draw
+    lcd->partial = (dirty_num * 100 <= lcd->band_num * LCD_DIRTY_FULL_PERCENT);
+}
+
+static void lcd_draw_thread(void *arg)
+{
+    lcd_render_t *lcd = (lcd_render_t *)arg;
+    while (1) {
+        media_lib_sema_lock(lcd->stage_ready, MEDIA_LIB_MAX_LOCK_TIME);
+        if (lcd->draw_quit) {
+            break;
+        }
+        lcd_draw_strips(lcd, lcd->stage, lcd->partial ? lcd->dirty : NULL);
+        media_lib_sema_unlock(lcd->stage_free);
+    }
+    media_lib_sema_unlock(lcd->draw_exit);
+    media_lib_thread_destroy(NULL);
+}
+
+static int lcd_async_draw(lcd_render_t *lcd, uint8_t *rgb_data, int size)
+{
+    // Only wait for last frame drawn, draw task push this one while render prepare next frame
+    if (media_lib_sema_lock(lcd->stage_free, LCD_DRAW_TIMEOUT_MS) != 0) {
+        ESP_LOGW(TAG, "Drop frame for last frame draw timeout");
+        lcd->stats.drop_num++;
+        return 0;
+    }
+    lcd_copy_frame(lcd, rgb_data, size);
+    media_lib_sema_unlock(lcd->stage_ready);
+    return 0;
+}
+
+static int lcd_async_draw_start(lcd_render_t *lcd)
+{
+    int ret = media_lib_sema_create(&lcd->stage_free);
+    ret |= media_lib_sema_create(&lcd->stage_ready);
+    ret |= media_lib_sema_create(&lcd->draw_exit);
+    if (ret != 0) {
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    media_lib_sema_unlock(lcd->stage_free);
+    media_lib_thread_handle_t thread = NULL;
+    ret = media_lib_thread_create_from_scheduler(&thread, "LcdDraw", lcd_draw_thread, lcd);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Fail to create draw thread");
+        return ret;
+    }
+    lcd->async_draw = true;
+    return 0;
+}
+
+static void lcd_async_draw_stop(lcd_render_t *lcd)
+{
+    if (lcd->async_draw) {
+        lcd->draw_quit = true;
+        media_lib_sema_unlock(lcd->stage_ready);
+        media_lib_sema_lock(lcd->draw_exit, MEDIA_LIB_MAX_LOCK_TIME);
+        lcd->async_draw = false;
+    }
+    if (lcd->stage_free) {
+        media_lib_sema_destroy(lcd->stage_free);
+    }
+    if (lcd->stage_ready) {
+        media_lib_sema_destroy(lcd->stage_ready);
+    }
+    if (lcd->draw_exit) {
+        media_lib_sema_destroy(lcd->draw_exit);
+    }
+    if (lcd->stage) {
+        media_lib_free(lcd->stage);
+        lcd->stage = NULL;
+    }
+    if (lcd->dirty) {
+        media_lib_free(lcd->dirty);
+        lcd->dirty = NULL;
+    }
+}
+
+static int lcd_get_panel_frame_buffer(lcd_render_t *lcd, int fb_num)
+{
+    int ret = ESP_FAIL;
+    if (lcd->rgb_panel) {
+#if SOC_LCD_RGB_SUPPORTED
+        void **fb = (void **)lcd->frame_buffer;
+        ret = fb_num == 3 ? esp_lcd_rgb_panel_get_frame_buffer(lcd->handle, 3, &fb[0], &fb[1], &fb[2])
+                          : esp_lcd_rgb_panel_get_frame_buffer(lcd->handle, 2, &fb[0], &fb[1]);
+#endif
+    }
+    if (lcd->dsi_panel) {
+#if CONFIG_IDF_TARGET_ESP32P4
+        void **fb = (void **)lcd->frame_buffer;
+        ret = fb_num == 3 ? esp_lcd_dpi_panel_get_frame_buffer(lcd->handle, 3, &fb[0], &fb[1], &fb[2])
+                          : esp_lcd_dpi_panel_get_frame_buffer(lcd->handle, 2, &fb[0], &fb[1]);
+#endif
+    }
+    if (ret == ESP_OK && lcd->frame_buffer[0]) {
+        lcd->fb_num = fb_num;
+        return 0;
+    }
+    memset(lcd->frame_buffer, 0, sizeof(lcd->frame_buffer));
+    return -1;
+}
+
+static void lcd_register_vsync(lcd_render_t *lcd)
+{
+#if SOC_LCD_RGB_SUPPORTED
+    if (lcd->rgb_panel && lcd->frame_buffer[0]) {
+        esp_lcd_rgb_panel_event_callbacks_t rgb_cb = {
+            .on_vsync = rgb_vsync,
+        };
+        lcd->vsync_ready = (esp_lcd_rgb_panel_register_event_callbacks(lcd->handle, &rgb_cb, lcd) == ESP_OK);
+    }
+#endif
+#if CONFIG_IDF_TARGET_ESP32P4
+    // DPI callbacks only apply to DSI panel, RGB and SPI panel on P4 use their own driver
+    if (lcd->dsi_panel) {
+        esp_lcd_dpi_panel_event_callbacks_t dpi_cb = {
+            .on_color_trans_done = draw_finished,
+            .on_refresh_done = dpi_refresh_done,
+        };
+        if (esp_lcd_dpi_panel_register_event_callbacks(lcd->handle, &dpi_cb, lcd) == ESP_OK) {
+            lcd->vsync_ready = (lcd->frame_buffer[0] != NULL);
+        }
+    }
+#endif
 }
+
+static void lcd_unregister_vsync(lcd_render_t *lcd)
+{
+    // Render instance is freed after close, callbacks must not use it any more
+#if SOC_LCD_RGB_SUPPORTED
+    if (lcd->rgb_panel && lcd->vsync_ready) {
+        esp_lcd_rgb_panel_event_callbacks_t rgb_cb = { 0 };
+        esp_lcd_rgb_panel_register_event_callbacks(lcd->handle, &rgb_cb, NULL);
+    }
 #endif
+#if CONFIG_IDF_TARGET_ESP32P4
+    if (lcd->dsi_panel) {
+        esp_lcd_dpi_panel_event_callbacks_t dpi_cb = { 0 };
+        esp_lcd_dpi_panel_register_event_callbacks(lcd->handle, &dpi_cb, NULL);
+    }
+#endif
+    lcd->vsync_ready = false;
+}
 
 static video_render_handle_t lcd_render_open(void *cfg, int size)
 {
@@ -75,31 +407,46 @@ static video_render_handle_t lcd_render_open(void *cfg, int size)
     lcd->handle = lcd_cfg->lcd_handle; // lcd_cfg->lcd_handle;
     lcd->rgb_panel = lcd_cfg->rgb_panel;
     lcd->dsi_panel = lcd_cfg->dsi_panel;
+    lcd->transform = lcd_cfg->transform;
+    lcd->refresh_us = 1000000 / (lcd_cfg->refresh_rate ? lcd_cfg->refresh_rate : LCD_DEFAULT_REFRESH_RATE);
+    lcd->fill_idx = -1;
+    lcd->pending_idx = -1;
+    portMUX_INITIALIZE(&lcd->lock);
     if (lcd_cfg->use_frame_buffer) {
-        if (lcd->rgb_panel) {
-#if SOC_LCD_RGB_SUPPORTED
-            esp_lcd_rgb_panel_get_frame_buffer(lcd->handle, 2, (void **)&lcd->frame_buffer[0],
-                                               (void **)&lcd->frame_buffer[1]);
-#endif
-        }
-        if (lcd->dsi_panel) {
-#if CONFIG_IDF_TARGET_ESP32P4
-            esp_lcd_dpi_panel_get_frame_buffer(lcd->handle, 2, (void **)&lcd->frame_buffer[0],
-                                               (void **)&lcd->frame_buffer[1]);
-#endif
+        // Panel starts from showing first frame buffer
+        if (lcd_cfg->fb_num < 3 || lcd_get_panel_frame_buffer(lcd, 3) != 0) {
+            lcd_get_panel_frame_buffer(lcd, 2);
         }
         if (lcd->frame_buffer[0] == NULL) {
             ESP_LOGE(TAG, "Fail to get frame buffer");
             lcd_render_close(lcd);
             return NULL;
         }
+        ESP_LOGI(TAG, "Use %d frame buffers", lcd->fb_num);
+    }
+    lcd->vsync = xSemaphoreCreateBinary();
+    if (lcd->vsync == NULL) {
+        lcd_render_close(lcd);
+        return NULL;
     }
 #if CONFIG_IDF_TARGET_ESP32P4
-    esp_lcd_dpi_panel_event_callbacks_t dpi_cb = {
-        .on_color_trans_done = draw_finished,
-    };
-    esp_lcd_dpi_panel_register_event_callbacks(lcd->handle, &dpi_cb, lcd);
+    lcd->draw_done = xSemaphoreCreateBinary();
+    if (lcd->draw_done == NULL) {
+        lcd_render_close(lcd);
+        return NULL;
+    }
+    // No transfer in progress yet
+    xSemaphoreGive(lcd->draw_done);
 #endif
+    // Panel without frame buffer is drawn by strips
+    if (lcd->frame_buffer[0] == NULL && lcd->dsi_panel == false) {
+        lcd->dirty_update = lcd_cfg->dirty_update;
+        if (lcd_cfg->async_draw && lcd_async_draw_start(lcd) != 0) {
+            lcd_render_close(lcd);
+            return NULL;
+        }
+    }
+    lcd_register_vsync(lcd);
     return lcd;
 }
 
@@ -137,11 +484,72 @@ static int lcd_render_set_frame_info(video_render_handle_t h, av_render_video_fr
         return ESP_MEDIA_ERR_NOT_SUPPORT;
     }
     lcd_render_t *lcd = (lcd_render_t *)h;
+    if (lcd->async_draw || lcd->dirty_update) {
+        int stage_size = info->width * info->height * 2;
+        int band_num = (info->height + LCD_BAND_LINES - 1) / LCD_BAND_LINES;
+        // Wait for draw task idle before change staging buffer
+        if (lcd->async_draw) {
+            media_lib_sema_lock(lcd->stage_free, MEDIA_LIB_MAX_LOCK_TIME);
+        }
+        if (stage_size > lcd->stage_size) {
+            media_lib_free(lcd->stage);
+            lcd->stage = (uint8_t *)media_lib_malloc(stage_size);
+            lcd->stage_size = lcd->stage ? stage_size : 0;
+        }
+        if (lcd->dirty_update && band_num != lcd->band_num) {
+            media_lib_free(lcd->dirty);
+            lcd->dirty = (uint8_t *)media_lib_malloc(band_num);
+            lcd->band_num = lcd->dirty ? band_num : 0;
+        }
+        lcd->stage_valid = false;
+        if (lcd->async_draw) {
+            media_lib_sema_unlock(lcd->stage_free);
+        }
+        if (lcd->stage == NULL || (lcd->dirty_update && lcd->dirty == NULL)) {
+            ESP_LOGE(TAG, "No memory for staging buffer");
+            return ESP_MEDIA_ERR_NO_MEM;
+        }
+    }
     memcpy(&lcd->info, info, sizeof(av_render_video_frame_info_t));
     ESP_LOGI(TAG, "Render started %dx%d", info->width, info->height);
     return 0;
 }
 
+static int lcd_fb_index(lcd_render_t *lcd, uint8_t *data)
+{
+    for (int i = 0; i < lcd->fb_num; i++) {
+        if (lcd->frame_buffer[i] == data) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int lcd_submit_frame_buffer(lcd_render_t *lcd, int idx)
+{
+    // Only switch scan out buffer, panel take it on next vsync
+    int ret = esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, lcd->info.width, lcd->info.height, lcd->frame_buffer[idx]);
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    portENTER_CRITICAL(&lcd->lock);
+    if (lcd->fill_idx == idx) {
+        lcd->fill_idx = -1;
+    }
+    if (ret == ESP_OK) {
+        if (lcd->vsync_ready == false) {
+            lcd->scan_idx = idx;
+            lcd_frame_presented(lcd, now);
+        } else {
+            if (lcd->pending_idx >= 0) {
+                // Replaced before ever shown
+                lcd->stats.drop_num++;
+            }
+            lcd->pending_idx = idx;
+        }
+    }
+    portEXIT_CRITICAL(&lcd->lock);
+    return ret;
+}
+
 static int lcd_render_write(video_render_handle_t h, av_render_video_frame_t *video_data)
 {
     lcd_render_t *lcd = (lcd_render_t *)h;
@@ -160,44 +568,62 @@ static int lcd_render_write(video_render_handle_t h, av_render_video_frame_t *vi
         lcd->start_time = cur_time;
         lcd->frame_num = 0;
     }
-#if CONFIG_IDF_TARGET_ESP32P4
-    while (lcd->drawing) {
-        media_lib_thread_sleep(10);
-    }
-    lcd->drawing = true;
-#endif
     if (lcd->info.type == AV_RENDER_VIDEO_RAW_TYPE_RGB565 || lcd->info.type == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) {
         uint8_t *rgb_data = video_data->data;
+        int frame_size = lcd->info.width * lcd->info.height * 2;
         ESP_LOGD(TAG, "pts:%d size %d", (int)video_data->pts, (int)video_data->size);
-        if (video_data->size < lcd->info.width * lcd->info.height * 2) {
+        if (video_data->size < frame_size) {
             return ESP_MEDIA_ERR_INVALID_ARG;
         }
-        if (lcd->frame_buffer[0]) {
-            // Check whether input ptr is frame buffer or not
-            lcd->sel = !lcd->sel;
-            return esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, lcd->info.width, lcd->info.height, rgb_data);
+        int idx = lcd_fb_index(lcd, rgb_data);
+        if (idx >= 0) {
+            return lcd_submit_frame_buffer(lcd, idx);
+        }
+        if (lcd->async_draw) {
+            return lcd_async_draw(lcd, rgb_data, frame_size);
+        }
+        if (lcd->dirty_update) {
+            lcd_copy_frame(lcd, rgb_data, frame_size);
+            return lcd_draw_strips(lcd, rgb_data, lcd->partial ? lcd->dirty : NULL);
         }
 #if CONFIG_IDF_TARGET_ESP32P4
-        return esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, lcd->info.width, lcd->info.height, rgb_data);
+        // Transfer done is only reported by DSI panel
+        if (lcd->dsi_panel) {
+            return dsi_draw_frame(lcd, rgb_data);
+        }
 #endif
-        int w = lcd->info.width;
-        int h = lcd->info.height;
-        int i = 0;
-        int n = 40;
-        int ret = 0;
-        while (i < h) {
-            if (i + n > h) {
-                n = h - i;
-            }
-            ret = esp_lcd_panel_draw_bitmap(lcd->handle, 0, i, w, i + n, rgb_data);
-            rgb_data += n * w * 2;
-            i += n;
+        if (lcd->frame_buffer[0]) {
+            return esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, lcd->info.width, lcd->info.height, rgb_data);
         }
-        return ret;
+        return lcd_draw_strips(lcd, rgb_data, NULL);
     }
     return ESP_MEDIA_ERR_NOT_SUPPORT;
 }
 
+static int lcd_pick_frame_buffer(lcd_render_t *lcd, bool overwrite)
+{
+    int idx = -1;
+    portENTER_CRITICAL(&lcd->lock);
+    if (lcd->fill_idx >= 0) {
+        idx = lcd->fill_idx;
+    } else {
+        for (int i = 0; i < lcd->fb_num; i++) {
+            if (i != lcd->scan_idx && i != lcd->pending_idx) {
+                idx = lcd->fill_idx = i;
+                break;
+            }
+        }
+        // No free buffer, take back the frame waiting for vsync
+        if (idx < 0 && overwrite && lcd->pending_idx >= 0) {
+            idx = lcd->fill_idx = lcd->pending_idx;
+            lcd->pending_idx = -1;
+            lcd->stats.drop_num++;
+        }
+    }
+    portEXIT_CRITICAL(&lcd->lock);
+    return idx;
+}
+
 static int lcd_render_get_frame_buffer(video_render_handle_t h, av_render_frame_buffer_t *buffer)
 {
     lcd_render_t *lcd = (lcd_render_t *)h;
@@ -207,12 +633,22 @@ static int lcd_render_get_frame_buffer(video_render_handle_t h, av_render_frame_
     if (lcd->frame_buffer[0] == NULL) {
         return ESP_MEDIA_ERR_NOT_SUPPORT;
     }
-    uint8_t *frame_buffer = lcd->frame_buffer[lcd->sel];
-    if (frame_buffer == NULL) {
-        frame_buffer = lcd->frame_buffer[0];
+    int idx = lcd_pick_frame_buffer(lcd, false);
+    // All buffers busy (double buffer with one frame waiting), wait for it to be shown
+    while (idx < 0 && xSemaphoreTake(lcd->vsync, pdMS_TO_TICKS(LCD_DRAW_TIMEOUT_MS)) == pdTRUE) {
+        idx = lcd_pick_frame_buffer(lcd, false);
+    }
+    if (idx < 0) {
+        // No vsync come in time, overwrite the waiting frame if any
+        idx = lcd_pick_frame_buffer(lcd, true);
+        if (idx < 0) {
+            ESP_LOGE(TAG, "No frame buffer available");
+            return ESP_MEDIA_ERR_WRONG_STATE;
+        }
+        ESP_LOGW(TAG, "Wait for vsync timeout");
     }
     // Only support RGB565 currently
-    buffer->data = frame_buffer;
+    buffer->data = lcd->frame_buffer[idx];
     buffer->size = lcd->info.width * lcd->info.height * 2;
     return 0;
 }
@@ -223,7 +659,42 @@ static int lcd_render_get_latency(video_render_handle_t h, uint32_t *latency)
     if (lcd == NULL) {
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
-    *latency = 0;
+    // Vsync and transfer done interrupt update them
+    portENTER_CRITICAL(&lcd->lock);
+    bool pending = lcd->pending_idx >= 0;
+    uint32_t last_vsync = lcd->last_vsync;
+    uint32_t draw_start = lcd->draw_start;
+    uint32_t draw_end = lcd->draw_end;
+    portEXIT_CRITICAL(&lcd->lock);
+    // Panel scans out written frame in next refresh
+    uint32_t latency_us = lcd->refresh_us;
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    if (pending) {
+        // Add wait for vsync which switch to submitted frame buffer
+        uint32_t elapse = now - last_vsync;
+        if (last_vsync && lcd->refresh_us > elapse) {
+            latency_us += lcd->refresh_us - elapse;
+        }
+    } else if (draw_end == 0 && draw_start) {
+        // Add rest of transfer still in flight
+        uint32_t elapse = now - draw_start;
+        if (lcd->draw_cost > elapse) {
+            latency_us += lcd->draw_cost - elapse;
+        }
+    }
+    *latency = latency_us / 1000;
+    return 0;
+}
+
+static int lcd_render_get_stats(video_render_handle_t h, video_render_stats_t *stats)
+{
+    lcd_render_t *lcd = (lcd_render_t *)h;
+    if (lcd == NULL || stats == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&lcd->lock);
+    *stats = lcd->stats;
+    portEXIT_CRITICAL(&lcd->lock);
     return 0;
 }
 
@@ -237,6 +708,16 @@ static int lcd_render_get_frame_info(video_render_handle_t h, av_render_video_fr
     return 0;
 }
 
+static int lcd_render_get_transform(video_render_handle_t h, av_render_video_transform_t *transform)
+{
+    lcd_render_t *lcd = (lcd_render_t *)h;
+    if (lcd == NULL || transform == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    memcpy(transform, &lcd->transform, sizeof(av_render_video_transform_t));
+    return 0;
+}
+
 static int lcd_render_clear(video_render_handle_t h)
 {
     lcd_render_t *lcd = (lcd_render_t *)h;
@@ -244,22 +725,45 @@ static int lcd_render_clear(video_render_handle_t h)
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
     if (lcd->handle && lcd->info.width) {
-        uint8_t *frame_buffer = lcd->frame_buffer[lcd->sel];
-        if (frame_buffer == NULL) {
+        if (lcd->frame_buffer[0] == NULL) {
 #ifndef CONFIG_IDF_TARGET_ESP32P4
             uint8_t *line_buffer = (uint8_t *)media_lib_malloc(lcd->info.width * 2);
             if (line_buffer) {
+                // Not to interleave with frame drawing in progress
+                if (lcd->async_draw) {
+                    media_lib_sema_lock(lcd->stage_free, LCD_DRAW_TIMEOUT_MS);
+                }
                 memset(line_buffer, 0, lcd->info.width * 2);
                 for (int i = 0; i < lcd->info.height; i++) {
                     esp_lcd_panel_draw_bitmap(lcd->handle, 0, i, lcd->info.width, i + 1, line_buffer);
                 }
+                // Panel no longer show last frame
+                lcd->stage_valid = false;
+                if (lcd->async_draw) {
+                    media_lib_sema_unlock(lcd->stage_free);
+                }
                 media_lib_free(line_buffer);
             }
 #endif
         } else {
+            // Switch back to first frame buffer as when opened, so that next open know which one is scanned
             int len = lcd->info.width * lcd->info.height * 2;
-            memset(frame_buffer, 0, len);
-            esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, 1, 1, frame_buffer);
+            memset(lcd->frame_buffer[0], 0, len);
+            esp_lcd_panel_draw_bitmap(lcd->handle, 0, 0, 1, 1, lcd->frame_buffer[0]);
+            portENTER_CRITICAL(&lcd->lock);
+            lcd->fill_idx = -1;
+            if (lcd->vsync_ready && lcd->scan_idx != 0) {
+                lcd->pending_idx = 0;
+            } else {
+                lcd->scan_idx = 0;
+                lcd->pending_idx = -1;
+            }
+            portEXIT_CRITICAL(&lcd->lock);
+            while (lcd->pending_idx >= 0) {
+                if (xSemaphoreTake(lcd->vsync, pdMS_TO_TICKS(LCD_DRAW_TIMEOUT_MS)) != pdTRUE) {
+                    break;
+                }
+            }
         }
     }
     return 0;
@@ -271,7 +775,17 @@ static int lcd_render_close(video_render_handle_t h)
     if (lcd == NULL) {
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
+    lcd_async_draw_stop(lcd);
     lcd_render_clear(h);
+    lcd_unregister_vsync(lcd);
+#if CONFIG_IDF_TARGET_ESP32P4
+    if (lcd->draw_done) {
+        vSemaphoreDelete(lcd->draw_done);
+    }
+#endif
+    if (lcd->vsync) {
+        vSemaphoreDelete(lcd->vsync);
+    }
     media_lib_free(lcd);
     return 0;
 }
@@ -289,6 +803,8 @@ video_render_handle_t av_render_alloc_lcd_render(lcd_render_cfg_t *lcd_cfg)
             .get_frame_info = lcd_render_get_frame_info,
             .clear = lcd_render_clear,
             .close = lcd_render_close,
+            .get_transform = lcd_render_get_transform,
+            .get_stats = lcd_render_get_stats,
         },
         .cfg = lcd_cfg,
         .cfg_size = sizeof(lcd_render_cfg_t),
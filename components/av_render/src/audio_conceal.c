@@ -0,0 +1,200 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "audio_conceal.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+
+// Pitch search range 2.5ms to 15ms follow G.711 Appendix I
+#define CONCEAL_MIN_PITCH_US (2500)
+#define CONCEAL_MAX_PITCH_US (15000)
+#define CONCEAL_HOLD_MS      (10)
+#define CONCEAL_FADE_MS      (50)
+#define CONCEAL_OLA_MS       (4)
+
+struct audio_conceal_t {
+    uint8_t  channel;
+    int      min_pitch;
+    int      max_pitch;
+    int      hist_len;
+    int16_t *hist;       /*!< Last good samples (interleaved) */
+    int      hist_fill;
+    int      pitch;
+    int      pos;        /*!< Phase inside pitch period */
+    int      erased;     /*!< Samples concealed in current loss */
+    int      hold_len;
+    int      fade_len;
+    int      ola_len;
+    int16_t *ola;        /*!< Continuation of concealed signal for cross fade */
+};
+
+audio_conceal_handle_t audio_conceal_open(uint32_t sample_rate, uint8_t channel)
+{
+    if (sample_rate == 0 || channel == 0) {
+        return NULL;
+    }
+    struct audio_conceal_t *c = (struct audio_conceal_t *)media_lib_calloc(1, sizeof(struct audio_conceal_t));
+    if (c == NULL) {
+        return NULL;
+    }
+    c->channel = channel;
+    c->min_pitch = sample_rate * CONCEAL_MIN_PITCH_US / 1000000;
+    c->max_pitch = sample_rate * CONCEAL_MAX_PITCH_US / 1000000;
+    // Correlation window of one max pitch before the compared period
+    c->hist_len = c->max_pitch * 2;
+    c->hold_len = sample_rate * CONCEAL_HOLD_MS / 1000;
+    c->fade_len = sample_rate * CONCEAL_FADE_MS / 1000;
+    c->ola_len = sample_rate * CONCEAL_OLA_MS / 1000;
+    c->hist = (int16_t *)media_lib_malloc(c->hist_len * channel * sizeof(int16_t));
+    c->ola = (int16_t *)media_lib_malloc(c->ola_len * channel * sizeof(int16_t));
+    if (c->hist == NULL || c->ola == NULL || c->min_pitch == 0) {
+        audio_conceal_close(c);
+        return NULL;
+    }
+    return c;
+}
+
+static int find_pitch(struct audio_conceal_t *c)
+{
+    // Maximize normalized cross correlation of last window with the one `lag` before, use first channel only
+    int ch = c->channel;
+    int win = c->max_pitch;
+    int16_t *cur = c->hist + (c->hist_len - win) * ch;
+    int best = c->max_pitch;
+    float best_score = 0;
+    for (int lag = c->min_pitch; lag <= c->max_pitch; lag++) {
+        int16_t *prev = cur - lag * ch;
+        int64_t num = 0, den = 0;
+        for (int i = 0; i < win; i++) {
+            num += (int32_t)cur[i * ch] * prev[i * ch];
+            den += (int32_t)prev[i * ch] * prev[i * ch];
+        }
+        if (num <= 0) {
+            continue;
+        }
+        float score = (float)num * (float)num / (float)den;
+        if (score > best_score) {
+            best_score = score;
+            best = lag;
+        }
+    }
+    return best;
+}
+
+static void conceal_output(struct audio_conceal_t *c, int16_t *pcm, int sample_num, bool advance)
+{
+    int ch = c->channel;
+    int16_t *period = c->hist + (c->hist_len - c->pitch) * ch;
+    int pos = c->pos;
+    int erased = c->erased;
+    for (int i = 0; i < sample_num; i++) {
+        // Keep full level for hold time then fade out linearly
+        int32_t gain = 32768;
+        if (erased >= c->hold_len + c->fade_len) {
+            gain = 0;
+        } else if (erased > c->hold_len) {
+            gain = 32768 - (int32_t)((int64_t)(erased - c->hold_len) * 32768 / c->fade_len);
+        }
+        for (int j = 0; j < ch; j++) {
+            pcm[i * ch + j] = (int16_t)(((int32_t)period[pos * ch + j] * gain) >> 15);
+        }
+        if (++pos >= c->pitch) {
+            pos = 0;
+        }
+        erased++;
+    }
+    if (advance) {
+        c->pos = pos;
+        c->erased = erased;
+    }
+}
+
+int audio_conceal_generate(audio_conceal_handle_t h, int16_t *pcm, int sample_num)
+{
+    struct audio_conceal_t *c = h;
+    if (c == NULL || pcm == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    if (c->hist_fill < c->hist_len) {
+        // Not enough history, fill silence
+        memset(pcm, 0, sample_num * c->channel * sizeof(int16_t));
+        return ESP_MEDIA_ERR_OK;
+    }
+    if (c->erased == 0) {
+        c->pitch = find_pitch(c);
+        c->pos = 0;
+    }
+    conceal_output(c, pcm, sample_num, true);
+    return ESP_MEDIA_ERR_OK;
+}
+
+void audio_conceal_feed(audio_conceal_handle_t h, int16_t *pcm, int sample_num)
+{
+    struct audio_conceal_t *c = h;
+    if (c == NULL || pcm == NULL || sample_num <= 0) {
+        return;
+    }
+    int ch = c->channel;
+    if (c->erased && c->hist_fill >= c->hist_len) {
+        // Cross fade from concealed signal into good audio
+        int ola_len = sample_num < c->ola_len ? sample_num : c->ola_len;
+        conceal_output(c, c->ola, ola_len, false);
+        for (int i = 0; i < ola_len; i++) {
+            int32_t w = (i + 1) * 32768 / (ola_len + 1);
+            for (int j = 0; j < ch; j++) {
+                int idx = i * ch + j;
+                pcm[idx] = (int16_t)(((int32_t)pcm[idx] * w + (int32_t)c->ola[idx] * (32768 - w)) >> 15);
+            }
+        }
+    }
+    c->erased = 0;
+    // Keep last `hist_len` samples
+    if (sample_num >= c->hist_len) {
+        memcpy(c->hist, pcm + (sample_num - c->hist_len) * ch, c->hist_len * ch * sizeof(int16_t));
+    } else {
+        memmove(c->hist, c->hist + sample_num * ch, (c->hist_len - sample_num) * ch * sizeof(int16_t));
+        memcpy(c->hist + (c->hist_len - sample_num) * ch, pcm, sample_num * ch * sizeof(int16_t));
+    }
+    c->hist_fill += sample_num;
+    if (c->hist_fill > c->hist_len) {
+        c->hist_fill = c->hist_len;
+    }
+}
+
+void audio_conceal_close(audio_conceal_handle_t h)
+{
+    struct audio_conceal_t *c = h;
+    if (c == NULL) {
+        return;
+    }
+    if (c->hist) {
+        media_lib_free(c->hist);
+    }
+    if (c->ola) {
+        media_lib_free(c->ola);
+    }
+    media_lib_free(c);
+}
@@ -0,0 +1,51 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct audio_conceal_t *audio_conceal_handle_t;
+
+/* Waveform repeat concealment for 16 bits interleaved PCM
+ * Lost audio is filled by repeating last pitch period of good audio with fade out (silent after 60ms)
+ * First good frame after loss is cross faded from the concealed signal to avoid click
+ */
+audio_conceal_handle_t audio_conceal_open(uint32_t sample_rate, uint8_t channel);
+
+/* Feed decoded good audio, `pcm` is modified in place when recovering from loss */
+void audio_conceal_feed(audio_conceal_handle_t h, int16_t *pcm, int sample_num);
+
+/* Generate concealed audio for lost samples */
+int audio_conceal_generate(audio_conceal_handle_t h, int16_t *pcm, int sample_num);
+
+void audio_conceal_close(audio_conceal_handle_t h);
+
+#ifdef __cplusplus
+}
+#endif
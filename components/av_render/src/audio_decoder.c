@@ -24,6 +24,7 @@
 
 #include <inttypes.h>
 #include "audio_decoder.h"
+#include "audio_conceal.h"
 #include "esp_audio_dec.h"
 #include "esp_audio_dec_default.h"
 #include "media_lib_os.h"
@@ -32,6 +33,8 @@
 #define TAG "AUDIO_DEC"
 
 #define ADEC_DEFAULT_OUTPUT_SIZE (4096)
+// Longest Opus packet duration
+#define ADEC_OPUS_MAX_FRAME_MS   (120)
 
 typedef struct {
     av_render_audio_codec_t      codec;
@@ -42,6 +45,14 @@ typedef struct {
     void                        *ctx;
     uint8_t                     *frame_data;
     int                          frame_size;
+    uint16_t                     conceal_max_ms;
+    audio_conceal_handle_t       conceal;
+    bool                         pts_valid;
+    uint32_t                     next_pts;
+    uint32_t                     frame_samples;
+    uint32_t                     decoded_samples;
+    adec_conceal_stats_t         stats;
+    adec_buffer_stats_t          buffer_stats;
 } adec_t;
 
 static esp_audio_type_t get_audio_decoder_type(av_render_audio_codec_t audio_format)
@@ -74,6 +85,77 @@ static esp_audio_type_t get_audio_decoder_type(av_render_audio_codec_t audio_for
     }
 }
 
+static uint32_t get_max_frame_samples(av_render_audio_codec_t codec, uint32_t sample_rate)
+{
+    // Worst case samples per channel of one decoded frame, 0 if decided by input size
+    switch (codec) {
+        case AV_RENDER_AUDIO_CODEC_MP3:
+            return 1152;
+        case AV_RENDER_AUDIO_CODEC_AAC:
+            // HE-AAC doubles 1024 samples by SBR
+            return 2048;
+        case AV_RENDER_AUDIO_CODEC_AMRNB:
+            return 160;
+        case AV_RENDER_AUDIO_CODEC_AMRWB:
+            return 320;
+        case AV_RENDER_AUDIO_CODEC_OPUS:
+            return (sample_rate ? sample_rate : 48000) * ADEC_OPUS_MAX_FRAME_MS / 1000;
+        case AV_RENDER_AUDIO_CODEC_FLAC:
+            // Maximum block size of FLAC streamable subset
+            return sample_rate > 48000 ? 16384 : 4608;
+        case AV_RENDER_AUDIO_CODEC_VORBIS:
+        case AV_RENDER_AUDIO_CODEC_ALAC:
+            return 4096;
+        default:
+            return 0;
+    }
+}
+
+static uint32_t get_max_frame_size(adec_t *adec, int in_size)
+{
+    uint8_t channel = adec->frame_info.channel ? adec->frame_info.channel : 2;
+    // HE-AACv2 output stereo from mono core by parametric stereo
+    if (adec->codec == AV_RENDER_AUDIO_CODEC_AAC && channel < 2) {
+        channel = 2;
+    }
+    uint8_t sample_bytes = adec->frame_info.bits_per_sample > 16 ? 4 : 2;
+    uint32_t samples = get_max_frame_samples(adec->codec, adec->frame_info.sample_rate);
+    if (samples) {
+        return samples * channel * sample_bytes;
+    }
+    switch (adec->codec) {
+        case AV_RENDER_AUDIO_CODEC_G711A:
+        case AV_RENDER_AUDIO_CODEC_G711U:
+            // One byte for each sample
+            return in_size * sample_bytes;
+        case AV_RENDER_AUDIO_CODEC_ADPCM:
+            // At most 4 bits for each sample, block header carries extra sample
+            return in_size * 2 * sample_bytes;
+        default:
+            return ADEC_DEFAULT_OUTPUT_SIZE;
+    }
+}
+
+static int reserve_output(adec_t *adec, uint32_t size)
+{
+    if (size <= adec->frame_size) {
+        return ESP_MEDIA_ERR_OK;
+    }
+    // Content not kept, avoid realloc copy
+    media_lib_free(adec->frame_data);
+    adec->frame_data = (uint8_t *)media_lib_malloc(size);
+    if (adec->frame_data == NULL) {
+        adec->frame_size = 0;
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    if (adec->frame_size) {
+        adec->buffer_stats.realloc_num++;
+    }
+    adec->frame_size = size;
+    adec->buffer_stats.frame_size = size;
+    return ESP_MEDIA_ERR_OK;
+}
+
 static int _open_audio_dec(adec_t *adec, av_render_audio_info_t *stream_info)
 {
     esp_audio_dec_cfg_t dec_cfg = {
@@ -82,12 +164,11 @@ static int _open_audio_dec(adec_t *adec, av_render_audio_info_t *stream_info)
     if (dec_cfg.type == ESP_AUDIO_TYPE_UNSUPPORT) {
         return -1;
     }
-    uint8_t *frame_data = (uint8_t *)media_lib_realloc(adec->frame_data, ADEC_DEFAULT_OUTPUT_SIZE);
-    if (frame_data == NULL) {
+    // Allocate for worst case frame once, codec decided by input size grow before decode
+    uint32_t frame_size = get_max_frame_size(adec, 0);
+    if (reserve_output(adec, frame_size ? frame_size : ADEC_DEFAULT_OUTPUT_SIZE) != ESP_MEDIA_ERR_OK) {
         return ESP_MEDIA_ERR_NO_MEM;
     }
-    adec->frame_size = ADEC_DEFAULT_OUTPUT_SIZE;
-    adec->frame_data = frame_data;
 
     switch (dec_cfg.type) {
         case ESP_AUDIO_TYPE_VORBIS: {
@@ -176,12 +257,24 @@ static int _close_audio_dec(adec_t *adec)
     return -1;
 }
 
+static bool conceal_supported(adec_t *adec)
+{
+    if (adec->conceal_max_ms == 0 || adec->frame_info.bits_per_sample != 16) {
+        return false;
+    }
+    return adec->codec == AV_RENDER_AUDIO_CODEC_OPUS || adec->codec == AV_RENDER_AUDIO_CODEC_G711A ||
+           adec->codec == AV_RENDER_AUDIO_CODEC_G711U;
+}
+
 static int decoder_one_frame(adec_t *adec, uint8_t *data, int size, av_render_audio_frame_t *frame_data)
 {
     esp_audio_dec_in_raw_t raw = {
         .buffer = data,
         .len = size,
     };
+    if (reserve_output(adec, get_max_frame_size(adec, size)) != ESP_MEDIA_ERR_OK) {
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
     esp_audio_dec_out_frame_t frame = {
         .buffer = adec->frame_data,
         .len = adec->frame_size,
@@ -190,15 +283,14 @@ RETRY:
     frame.decoded_size = 0;
     esp_audio_err_t ret = esp_audio_dec_process(adec->dec_handle, &raw, &frame);
     if (ret == ESP_AUDIO_ERR_BUFF_NOT_ENOUGH) {
-        ESP_LOGI(TAG, "Enlarge PCM buffer to %" PRIu32, frame.needed_size);
-        uint8_t *output_fifo = (uint8_t *)media_lib_realloc(adec->frame_data, frame.needed_size);
-        if (output_fifo == NULL) {
+        // Should not happen unless stream exceed worst case frame size
+        ESP_LOGW(TAG, "Enlarge PCM buffer to %" PRIu32, frame.needed_size);
+        adec->buffer_stats.retry_num++;
+        if (reserve_output(adec, frame.needed_size) != ESP_MEDIA_ERR_OK) {
             return ESP_MEDIA_ERR_NO_MEM;
         }
-        frame.buffer = output_fifo;
-        frame.len = frame.needed_size;
-        adec->frame_data = output_fifo;
-        adec->frame_size = frame.needed_size;
+        frame.buffer = adec->frame_data;
+        frame.len = adec->frame_size;
         goto RETRY;
     }
     if (ret != ESP_AUDIO_ERR_OK) {
@@ -215,12 +307,30 @@ RETRY:
             adec->frame_info.bits_per_sample = header.bits_per_sample;
         }
         adec->header_parsed = true;
+        // Opus conceal by decoder PLC, G711 use waveform repeat
+        if (conceal_supported(adec) && adec->codec != AV_RENDER_AUDIO_CODEC_OPUS && adec->conceal == NULL) {
+            adec->conceal = audio_conceal_open(adec->frame_info.sample_rate, adec->frame_info.channel);
+        }
     }
     frame_data->data = adec->frame_data;
     frame_data->size = frame.decoded_size;
+    int sample_size = adec->frame_info.channel * (adec->frame_info.bits_per_sample >> 3);
+    if (sample_size) {
+        uint32_t sample_num = frame.decoded_size / sample_size;
+        adec->decoded_samples += sample_num;
+        if (adec->conceal) {
+            audio_conceal_feed(adec->conceal, (int16_t *)frame_data->data, sample_num);
+        }
+    }
     if (adec->frame_cb) {
         adec->frame_cb(frame_data, adec->ctx);
     }
+    // Format parsed from header may need larger frame than guessed from stream information
+    if (reserve_output(adec, get_max_frame_size(adec, size)) != ESP_MEDIA_ERR_OK) {
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    frame.buffer = adec->frame_data;
+    frame.len = adec->frame_size;
     if (raw.consumed < raw.len) {
         raw.buffer += raw.consumed;
         raw.len -= raw.consumed;
@@ -230,14 +340,89 @@ RETRY:
     return ESP_MEDIA_ERR_OK;
 }
 
+static int conceal_one_frame(adec_t *adec, av_render_audio_frame_t *frame_data)
+{
+    int sample_size = adec->frame_info.channel * (adec->frame_info.bits_per_sample >> 3);
+    if (adec->codec == AV_RENDER_AUDIO_CODEC_OPUS) {
+        // Let decoder do PLC, input data not needed
+        esp_audio_dec_in_raw_t raw = {
+            .frame_recover = ESP_AUDIO_DEC_RECOVERY_PLC,
+        };
+        esp_audio_dec_out_frame_t frame = {
+            .buffer = adec->frame_data,
+            .len = adec->frame_size,
+        };
+        esp_audio_err_t ret = esp_audio_dec_process(adec->dec_handle, &raw, &frame);
+        if (ret != ESP_AUDIO_ERR_OK) {
+            return ret;
+        }
+        frame_data->size = frame.decoded_size;
+    } else {
+        int need_size = adec->frame_samples * sample_size;
+        if (reserve_output(adec, need_size) != ESP_MEDIA_ERR_OK) {
+            return ESP_MEDIA_ERR_NO_MEM;
+        }
+        audio_conceal_generate(adec->conceal, (int16_t *)adec->frame_data, adec->frame_samples);
+        frame_data->size = need_size;
+    }
+    frame_data->data = adec->frame_data;
+    frame_data->eos = false;
+    if (adec->frame_cb) {
+        adec->frame_cb(frame_data, adec->ctx);
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+static void conceal_lost_frames(adec_t *adec, uint32_t pts)
+{
+    if (adec->pts_valid == false || adec->frame_samples == 0 || conceal_supported(adec) == false) {
+        return;
+    }
+    uint32_t frame_ms = adec->frame_samples * 1000 / adec->frame_info.sample_rate;
+    if (frame_ms == 0) {
+        return;
+    }
+    // Tolerate half frame jitter, PTS going back or jump too far is treated as stream restart
+    int32_t gap = (int32_t)(pts - adec->next_pts);
+    if (gap <= (int32_t)(frame_ms / 2)) {
+        return;
+    }
+    if (gap > adec->conceal_max_ms) {
+        adec->stats.resync_num++;
+        return;
+    }
+    uint32_t lost = (gap + frame_ms / 2) / frame_ms;
+    adec->stats.lost_frames += lost;
+    av_render_audio_frame_t frame_data = {
+        .pts = adec->next_pts,
+    };
+    for (uint32_t i = 0; i < lost; i++) {
+        if (conceal_one_frame(adec, &frame_data) != ESP_MEDIA_ERR_OK) {
+            ESP_LOGW(TAG, "Fail to conceal lost frame at %" PRIu32, frame_data.pts);
+            break;
+        }
+        adec->stats.concealed_frames++;
+        frame_data.pts += frame_ms;
+    }
+    ESP_LOGD(TAG, "Concealed %" PRIu32 " frames before %" PRIu32, lost, pts);
+}
+
 static int _start_audio_dec(adec_t *adec, av_render_audio_data_t *frame, av_render_audio_frame_t *frame_data)
 {
     if (frame->size == 0) {
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
+    conceal_lost_frames(adec, frame->pts);
     uint8_t *dec_buffer = frame->data;
     frame_data->pts = frame->pts;
-    return decoder_one_frame(adec, dec_buffer, frame->size, frame_data);
+    adec->decoded_samples = 0;
+    int ret = decoder_one_frame(adec, dec_buffer, frame->size, frame_data);
+    if (ret == ESP_MEDIA_ERR_OK && adec->decoded_samples && adec->frame_info.sample_rate) {
+        adec->frame_samples = adec->decoded_samples;
+        adec->next_pts = frame->pts + adec->decoded_samples * 1000 / adec->frame_info.sample_rate;
+        adec->pts_valid = true;
+    }
+    return ret;
 }
 
 adec_handle_t adec_open(adec_cfg_t *cfg)
@@ -252,6 +437,7 @@ adec_handle_t adec_open(adec_cfg_t *cfg)
     adec->frame_info.sample_rate = cfg->audio_info.sample_rate;
     adec->frame_info.channel = cfg->audio_info.channel;
     adec->frame_info.bits_per_sample = cfg->audio_info.bits_per_sample;
+    adec->conceal_max_ms = cfg->conceal_max_ms;
     int ret = _open_audio_dec(adec, &cfg->audio_info);
     if (ret == 0) {
         return adec;
@@ -290,6 +476,26 @@ int adec_get_frame_info(adec_handle_t h, av_render_audio_frame_info_t *frame_inf
     return 0;
 }
 
+int adec_get_conceal_stats(adec_handle_t h, adec_conceal_stats_t *stats)
+{
+    if (h == NULL || stats == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    adec_t *adec = (adec_t *)h;
+    *stats = adec->stats;
+    return 0;
+}
+
+int adec_get_buffer_stats(adec_handle_t h, adec_buffer_stats_t *stats)
+{
+    if (h == NULL || stats == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    adec_t *adec = (adec_t *)h;
+    memcpy(stats, &adec->buffer_stats, sizeof(adec_buffer_stats_t));
+    return 0;
+}
+
 int adec_close(adec_handle_t h)
 {
     if (h == NULL) {
@@ -297,6 +503,9 @@ int adec_close(adec_handle_t h)
     }
     adec_t *adec = (adec_t *)h;
     _close_audio_dec(adec);
+    if (adec->conceal) {
+        audio_conceal_close(adec->conceal);
+    }
     if (adec->frame_data) {
         media_lib_free(adec->frame_data);
     }
@@ -0,0 +1,260 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "audio_jitter.h"
+#include "media_lib_os.h"
+
+#define JITTER_DELAY_WIN      (64)    /* Packets to find base delay, follow clock drift */
+#define JITTER_BUCKET_MS      (5)
+#define JITTER_MAX_BUCKET     (128)
+#define JITTER_FORGET         (0.995f) /* About 200 packets memory */
+#define JITTER_RESET_GAP_MS   (1000)
+#define JITTER_DEFAULT_FRAME  (20)
+#define JITTER_SPEED_GAIN     (0.0005f) /* Speed change per ms depth error */
+#define JITTER_MAX_STRETCH    (0.06f)
+#define JITTER_SPEED_STEP     (0.01f)
+
+typedef enum {
+    JITTER_STATE_BUFFERING,
+    JITTER_STATE_PLAYING,
+} jitter_state_t;
+
+struct audio_jitter_t {
+    audio_jitter_cfg_t cfg;
+    int32_t            delay[JITTER_DELAY_WIN];
+    int                delay_num;
+    int                delay_pos;
+    float              hist[JITTER_MAX_BUCKET];
+    int                bucket_num;
+    bool               pts_valid;
+    uint32_t           last_pts;
+    uint32_t           frame_ms;
+    volatile uint32_t  target_ms;
+    uint32_t           jitter_ms;
+    jitter_state_t     state;
+    bool               stretching;
+    float              speed;
+    uint32_t           depth_ms;
+    uint32_t           underrun_num;
+    uint32_t           drop_num;
+};
+
+static void jitter_clear_history(struct audio_jitter_t *j)
+{
+    j->delay_num = 0;
+    j->delay_pos = 0;
+    j->pts_valid = false;
+    memset(j->hist, 0, sizeof(j->hist));
+}
+
+static uint32_t clamp_target(struct audio_jitter_t *j, uint32_t target)
+{
+    if (target < j->cfg.min_ms) {
+        target = j->cfg.min_ms;
+    }
+    // Leave room for at least one frame before drop limit
+    if (target + j->frame_ms > j->cfg.max_ms) {
+        target = j->cfg.max_ms > j->frame_ms ? j->cfg.max_ms - j->frame_ms : 0;
+    }
+    return target;
+}
+
+audio_jitter_handle_t audio_jitter_open(audio_jitter_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->max_ms == 0 || cfg->min_ms >= cfg->max_ms) {
+        return NULL;
+    }
+    struct audio_jitter_t *j = (struct audio_jitter_t *)media_lib_calloc(1, sizeof(struct audio_jitter_t));
+    if (j == NULL) {
+        return NULL;
+    }
+    j->cfg = *cfg;
+    if (j->cfg.percentile == 0 || j->cfg.percentile > 100) {
+        j->cfg.percentile = 98;
+    }
+    j->bucket_num = cfg->max_ms / JITTER_BUCKET_MS + 1;
+    if (j->bucket_num > JITTER_MAX_BUCKET) {
+        j->bucket_num = JITTER_MAX_BUCKET;
+    }
+    j->frame_ms = JITTER_DEFAULT_FRAME;
+    audio_jitter_reset(j);
+    return j;
+}
+
+void audio_jitter_set_min(audio_jitter_handle_t h, uint16_t min_ms)
+{
+    struct audio_jitter_t *j = h;
+    if (j && min_ms < j->cfg.max_ms) {
+        j->cfg.min_ms = min_ms;
+        j->target_ms = clamp_target(j, j->target_ms);
+    }
+}
+
+void audio_jitter_arrive(audio_jitter_handle_t h, uint32_t now, uint32_t pts)
+{
+    struct audio_jitter_t *j = h;
+    if (j == NULL) {
+        return;
+    }
+    if (j->pts_valid) {
+        int32_t pts_diff = (int32_t)(pts - j->last_pts);
+        // PTS jump means new stream, restart estimation
+        if (pts_diff < 0 || pts_diff > JITTER_RESET_GAP_MS) {
+            jitter_clear_history(j);
+        } else if (pts_diff > 0 && pts_diff < j->frame_ms * 4) {
+            // Track frame duration, lost packets give multiple of it
+            j->frame_ms = pts_diff;
+        }
+    }
+    j->pts_valid = true;
+    j->last_pts = pts;
+    // Transit delay with unknown offset, delay relative to window minimum is the jitter
+    int32_t delay = (int32_t)(now - pts);
+    j->delay[j->delay_pos] = delay;
+    j->delay_pos = (j->delay_pos + 1) % JITTER_DELAY_WIN;
+    if (j->delay_num < JITTER_DELAY_WIN) {
+        j->delay_num++;
+    }
+    int32_t base = delay;
+    for (int i = 0; i < j->delay_num; i++) {
+        if ((int32_t)(j->delay[i] - base) < 0) {
+            base = j->delay[i];
+        }
+    }
+    uint32_t rel = (uint32_t)(delay - base);
+    int bucket = rel / JITTER_BUCKET_MS;
+    if (bucket >= j->bucket_num) {
+        bucket = j->bucket_num - 1;
+    }
+    float total = 0;
+    for (int i = 0; i < j->bucket_num; i++) {
+        j->hist[i] *= JITTER_FORGET;
+        total += j->hist[i];
+    }
+    j->hist[bucket] += 1.0f - JITTER_FORGET;
+    total += 1.0f - JITTER_FORGET;
+    float limit = total * j->cfg.percentile / 100;
+    float sum = 0;
+    int i = 0;
+    for (; i < j->bucket_num - 1; i++) {
+        sum += j->hist[i];
+        if (sum >= limit) {
+            break;
+        }
+    }
+    j->jitter_ms = (i + 1) * JITTER_BUCKET_MS;
+    // Need hold one frame besides jitter so that render never wait for next arrival
+    j->target_ms = clamp_target(j, j->jitter_ms + j->frame_ms);
+}
+
+audio_jitter_action_t audio_jitter_control(audio_jitter_handle_t h, uint32_t depth_ms, float *speed)
+{
+    struct audio_jitter_t *j = h;
+    *speed = 1.0f;
+    if (j == NULL) {
+        return AUDIO_JITTER_ACTION_PLAY;
+    }
+    uint32_t target = j->target_ms;
+    j->depth_ms = depth_ms;
+    if (j->state == JITTER_STATE_BUFFERING) {
+        if (depth_ms < target) {
+            return AUDIO_JITTER_ACTION_WAIT;
+        }
+        j->state = JITTER_STATE_PLAYING;
+    } else if (depth_ms < j->frame_ms) {
+        // Only current frame left, rebuffer to avoid play in tiny pieces
+        j->underrun_num++;
+        j->state = JITTER_STATE_BUFFERING;
+        j->stretching = false;
+        j->speed = 1.0f;
+        return AUDIO_JITTER_ACTION_WAIT;
+    }
+    if (depth_ms > j->cfg.max_ms) {
+        j->drop_num++;
+        return AUDIO_JITTER_ACTION_DROP;
+    }
+    // Dead band of one frame with hysteresis, then speed proportional to depth error
+    int32_t err = (int32_t)depth_ms - (int32_t)target;
+    int32_t abs_err = err > 0 ? err : -err;
+    if (j->stretching == false && abs_err > (int32_t)j->frame_ms) {
+        j->stretching = true;
+    } else if (j->stretching && abs_err < (int32_t)j->frame_ms / 2) {
+        j->stretching = false;
+    }
+    float new_speed = 1.0f;
+    if (j->stretching) {
+        float stretch = err * JITTER_SPEED_GAIN;
+        if (stretch > JITTER_MAX_STRETCH) {
+            stretch = JITTER_MAX_STRETCH;
+        } else if (stretch < -JITTER_MAX_STRETCH) {
+            stretch = -JITTER_MAX_STRETCH;
+        }
+        // Quantize to avoid reconfigure time stretch for every frame
+        int step = (int)(stretch / JITTER_SPEED_STEP + (stretch > 0 ? 0.5f : -0.5f));
+        if (step == 0) {
+            step = err > 0 ? 1 : -1;
+        }
+        new_speed = 1.0f + step * JITTER_SPEED_STEP;
+    }
+    j->speed = new_speed;
+    *speed = new_speed;
+    return AUDIO_JITTER_ACTION_PLAY;
+}
+
+void audio_jitter_reset(audio_jitter_handle_t h)
+{
+    struct audio_jitter_t *j = h;
+    if (j == NULL) {
+        return;
+    }
+    jitter_clear_history(j);
+    j->state = JITTER_STATE_BUFFERING;
+    j->stretching = false;
+    j->speed = 1.0f;
+    j->jitter_ms = 0;
+    j->target_ms = clamp_target(j, j->frame_ms);
+}
+
+void audio_jitter_get_stats(audio_jitter_handle_t h, audio_jitter_stats_t *stats)
+{
+    struct audio_jitter_t *j = h;
+    if (j == NULL || stats == NULL) {
+        return;
+    }
+    stats->target_ms = j->target_ms;
+    stats->depth_ms = j->depth_ms;
+    stats->jitter_ms = j->jitter_ms;
+    stats->speed = j->speed;
+    stats->underrun_num = j->underrun_num;
+    stats->drop_num = j->drop_num;
+}
+
+void audio_jitter_close(audio_jitter_handle_t h)
+{
+    if (h) {
+        media_lib_free(h);
+    }
+}
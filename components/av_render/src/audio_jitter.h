@@ -0,0 +1,79 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct audio_jitter_t *audio_jitter_handle_t;
+
+typedef struct {
+    uint16_t min_ms;     /*!< Lower bound of target depth */
+    uint16_t max_ms;     /*!< Audio buffered above it is dropped */
+    uint8_t  percentile; /*!< Percentile of arrival delay covered by target depth, 0 use 98 */
+} audio_jitter_cfg_t;
+
+typedef enum {
+    AUDIO_JITTER_ACTION_PLAY, /*!< Render frame using returned speed */
+    AUDIO_JITTER_ACTION_WAIT, /*!< Buffering, keep frame and wait for more data */
+    AUDIO_JITTER_ACTION_DROP, /*!< Buffer exceed limit, drop frame */
+} audio_jitter_action_t;
+
+typedef struct {
+    uint32_t target_ms;    /*!< Current target depth */
+    uint32_t depth_ms;     /*!< Last measured depth */
+    uint32_t jitter_ms;    /*!< Arrival delay at configured percentile */
+    float    speed;        /*!< Current playout speed */
+    uint32_t underrun_num; /*!< Times buffer run dry and rebuffered */
+    uint32_t drop_num;     /*!< Frames dropped for exceeding limit */
+} audio_jitter_stats_t;
+
+/* Adaptive playout buffer
+ * Arrival side tracks delay of each packet against its PTS and keeps a decaying histogram,
+ * target depth is set from the percentile of it. Render side compares queued depth with target
+ * and returns playout speed so that time stretching converges without audible drops
+ * `audio_jitter_arrive` and `audio_jitter_control` can run in different threads
+ */
+audio_jitter_handle_t audio_jitter_open(audio_jitter_cfg_t *cfg);
+
+void audio_jitter_set_min(audio_jitter_handle_t h, uint16_t min_ms);
+
+/* Record packet arrival, `now` and `pts` both in milliseconds */
+void audio_jitter_arrive(audio_jitter_handle_t h, uint32_t now, uint32_t pts);
+
+audio_jitter_action_t audio_jitter_control(audio_jitter_handle_t h, uint32_t depth_ms, float *speed);
+
+void audio_jitter_reset(audio_jitter_handle_t h);
+
+void audio_jitter_get_stats(audio_jitter_handle_t h, audio_jitter_stats_t *stats);
+
+void audio_jitter_close(audio_jitter_handle_t h);
+
+#ifdef __cplusplus
+}
+#endif
@@ -34,6 +34,8 @@
 
 #define SAMPLE_SIZE(info) (info.channel * (info.bits_per_sample >> 3))
 
+#define RESAMPLE_MAX_CACHE (8)
+
 typedef struct {
     uint8_t *data;
     int      size;
@@ -47,38 +49,53 @@ typedef enum {
     RESAMPLE_OPS_RATE_CVT,
 } resample_ops_t;
 
+/**
+ * Converter chain for one input and output format pair
+ */
+typedef struct {
+    av_render_audio_frame_info_t input_info;
+    av_render_audio_frame_info_t output_info;
+    esp_ae_ch_cvt_handle_t       ch_cvt_handle;
+    esp_ae_rate_cvt_handle_t     rate_cvt_handle;
+    esp_ae_bit_cvt_handle_t      bit_cvt_handle;
+    resample_ops_t               ops[3];
+    uint32_t                     used_seq;
+    bool                         valid;
+} resample_chain_t;
+
 typedef struct {
-    audio_resample_cfg_t     cfg;
-    esp_ae_ch_cvt_handle_t   ch_cvt_handle;
-    esp_ae_rate_cvt_handle_t rate_cvt_handle;
-    esp_ae_bit_cvt_handle_t  bit_cvt_handle;
-    resample_ops_t           ops[3];
-    work_buf_t               work_buf[2];
+    audio_resample_cfg_t cfg;
+    resample_chain_t    *chains;
+    uint8_t              chain_num;
+    resample_chain_t    *cur;
+    uint32_t             used_seq;
+    work_buf_t           work_buf[2];
 } resample_t;
 
-static int add_bits_resample(resample_t *resample, audio_resample_cfg_t *cfg, int i)
+static int add_bits_resample(resample_chain_t *chain, int i)
 {
-    if (cfg->input_info.bits_per_sample > cfg->output_info.bits_per_sample) {
-        resample->ops[i++] = RESAMPLE_OPS_BIT_CVT;
+    if (chain->input_info.bits_per_sample > chain->output_info.bits_per_sample) {
+        chain->ops[i++] = RESAMPLE_OPS_BIT_CVT;
     }
-    if (cfg->input_info.sample_rate != cfg->output_info.sample_rate) {
-        resample->ops[i++] = RESAMPLE_OPS_RATE_CVT;
+    if (chain->input_info.sample_rate != chain->output_info.sample_rate) {
+        chain->ops[i++] = RESAMPLE_OPS_RATE_CVT;
     }
-    if (cfg->input_info.bits_per_sample < cfg->output_info.bits_per_sample) {
-        resample->ops[i++] = RESAMPLE_OPS_BIT_CVT;
+    if (chain->input_info.bits_per_sample < chain->output_info.bits_per_sample) {
+        chain->ops[i++] = RESAMPLE_OPS_BIT_CVT;
     }
     return i;
 }
 
-static void sort_resample_ops(resample_t *resample, audio_resample_cfg_t *cfg)
+static void sort_resample_ops(resample_chain_t *chain)
 {
     int i = 0;
-    if (cfg->input_info.channel > cfg->output_info.channel) {
-        resample->ops[i++] = RESAMPLE_OPS_CH_CVT;
+    memset(chain->ops, 0, sizeof(chain->ops));
+    if (chain->input_info.channel > chain->output_info.channel) {
+        chain->ops[i++] = RESAMPLE_OPS_CH_CVT;
     }
-    i = add_bits_resample(resample, cfg, i);
-    if (cfg->input_info.channel < cfg->output_info.channel) {
-        resample->ops[i++] = RESAMPLE_OPS_CH_CVT;
+    i = add_bits_resample(chain, i);
+    if (chain->input_info.channel < chain->output_info.channel) {
+        chain->ops[i++] = RESAMPLE_OPS_CH_CVT;
     }
 }
 
@@ -108,124 +125,239 @@ static void release_work_buf(work_buf_t *buf)
     }
 }
 
-static int get_need_size(resample_t *resample, resample_ops_t op, uint32_t *sample, av_render_audio_frame_info_t *info)
+static int get_need_size(resample_chain_t *chain, resample_ops_t op, uint32_t *sample, av_render_audio_frame_info_t *info)
 {
     if (op == RESAMPLE_OPS_CH_CVT) {
-        return (*sample * resample->cfg.output_info.channel * (info->bits_per_sample >> 3));
+        return (*sample * chain->output_info.channel * (info->bits_per_sample >> 3));
     }
     if (op == RESAMPLE_OPS_RATE_CVT) {
         uint32_t out_sample = 0;
-        esp_ae_rate_cvt_get_max_out_sample_num(resample->rate_cvt_handle, *sample, &out_sample);
+        esp_ae_rate_cvt_get_max_out_sample_num(chain->rate_cvt_handle, *sample, &out_sample);
         *sample = out_sample;
         return out_sample * info->channel * (info->bits_per_sample >> 3);
     }
     if (op == RESAMPLE_OPS_BIT_CVT) {
-        return (*sample * info->channel * (resample->cfg.output_info.bits_per_sample >> 3));
+        return (*sample * info->channel * (chain->output_info.bits_per_sample >> 3));
     }
     return 0;
 }
 
-audio_resample_handle_t audio_resample_open(audio_resample_cfg_t *cfg)
+static void close_chain(resample_chain_t *chain)
 {
-    resample_t *resample = (resample_t *)media_lib_calloc(1, sizeof(resample_t));
-    do {
-        if (resample == NULL) {
+    if (chain->bit_cvt_handle) {
+        esp_ae_bit_cvt_close(chain->bit_cvt_handle);
+        chain->bit_cvt_handle = NULL;
+    }
+    if (chain->ch_cvt_handle) {
+        esp_ae_ch_cvt_close(chain->ch_cvt_handle);
+        chain->ch_cvt_handle = NULL;
+    }
+    if (chain->rate_cvt_handle) {
+        esp_ae_rate_cvt_close(chain->rate_cvt_handle);
+        chain->rate_cvt_handle = NULL;
+    }
+    chain->valid = false;
+}
+
+static int open_chain(resample_chain_t *chain, av_render_audio_frame_info_t *input_info,
+                      av_render_audio_frame_info_t *output_info)
+{
+    chain->input_info = *input_info;
+    chain->output_info = *output_info;
+    sort_resample_ops(chain);
+    av_render_audio_frame_info_t cur_info = *input_info;
+    esp_ae_err_t ret = ESP_AE_ERR_OK;
+    for (int i = 0; i < ELEMS(chain->ops); i++) {
+        if (chain->ops[i] == RESAMPLE_OPS_NONE) {
             break;
         }
-        sort_resample_ops(resample, cfg);
-        av_render_audio_frame_info_t cur_info = cfg->input_info;
-        esp_ae_err_t ret = ESP_AE_ERR_OK;
-        for (int i = 0; i < ELEMS(resample->ops); i++) {
-            if (resample->ops[i] == RESAMPLE_OPS_NONE) {
+        if (chain->ops[i] == RESAMPLE_OPS_CH_CVT) {
+            esp_ae_ch_cvt_cfg_t ch_cfg = {
+                .sample_rate = cur_info.sample_rate,
+                .bits_per_sample = cur_info.bits_per_sample,
+                .src_ch = cur_info.channel,
+                .dest_ch = output_info->channel,
+            };
+            ret = esp_ae_ch_cvt_open(&ch_cfg, &chain->ch_cvt_handle);
+            if (ret != ESP_AE_ERR_OK) {
                 break;
             }
-            if (resample->ops[i] == RESAMPLE_OPS_CH_CVT) {
-                esp_ae_ch_cvt_cfg_t ch_cfg = {
-                    .sample_rate = cur_info.sample_rate,
-                    .bits_per_sample = cur_info.bits_per_sample,
-                    .src_ch = cur_info.channel,
-                    .dest_ch = cfg->output_info.channel,
-                };
-                ret = esp_ae_ch_cvt_open(&ch_cfg, &resample->ch_cvt_handle);
-                if (ret != ESP_AE_ERR_OK) {
-                    break;
-                }
-                cur_info.channel = cfg->output_info.channel;
-            } else if (resample->ops[i] == RESAMPLE_OPS_RATE_CVT) {
-                esp_ae_rate_cvt_cfg_t rate_cfg = {
-                    .src_rate = cur_info.sample_rate,
-                    .dest_rate = cfg->output_info.sample_rate,
-                    .channel = cur_info.channel,
-                    .bits_per_sample = cur_info.bits_per_sample,
-                    .complexity = 2,
-                    .perf_type = ESP_AE_RATE_CVT_PERF_TYPE_SPEED,
-                };
-                ret = esp_ae_rate_cvt_open(&rate_cfg, &resample->rate_cvt_handle);
-                if (ret != ESP_AE_ERR_OK) {
-                    break;
-                }
-                cur_info.sample_rate = cfg->output_info.sample_rate;
-            } else if (resample->ops[i] == RESAMPLE_OPS_BIT_CVT) {
-                esp_ae_bit_cvt_cfg_t bit_cfg = {
-                    .channel = cur_info.channel,
-                    .sample_rate = cur_info.sample_rate,
-                    .src_bits = cur_info.bits_per_sample,
-                    .dest_bits = cfg->output_info.bits_per_sample,
-                };
-                ret = esp_ae_bit_cvt_open(&bit_cfg, &resample->bit_cvt_handle);
-                if (ret != ESP_AE_ERR_OK) {
-                    break;
-                }
-                cur_info.bits_per_sample = cfg->output_info.bits_per_sample;
+            cur_info.channel = output_info->channel;
+        } else if (chain->ops[i] == RESAMPLE_OPS_RATE_CVT) {
+            esp_ae_rate_cvt_cfg_t rate_cfg = {
+                .src_rate = cur_info.sample_rate,
+                .dest_rate = output_info->sample_rate,
+                .channel = cur_info.channel,
+                .bits_per_sample = cur_info.bits_per_sample,
+                .complexity = 2,
+                .perf_type = ESP_AE_RATE_CVT_PERF_TYPE_SPEED,
+            };
+            ret = esp_ae_rate_cvt_open(&rate_cfg, &chain->rate_cvt_handle);
+            if (ret != ESP_AE_ERR_OK) {
+                break;
+            }
+            cur_info.sample_rate = output_info->sample_rate;
+        } else if (chain->ops[i] == RESAMPLE_OPS_BIT_CVT) {
+            esp_ae_bit_cvt_cfg_t bit_cfg = {
+                .channel = cur_info.channel,
+                .sample_rate = cur_info.sample_rate,
+                .src_bits = cur_info.bits_per_sample,
+                .dest_bits = output_info->bits_per_sample,
+            };
+            ret = esp_ae_bit_cvt_open(&bit_cfg, &chain->bit_cvt_handle);
+            if (ret != ESP_AE_ERR_OK) {
+                break;
             }
+            cur_info.bits_per_sample = output_info->bits_per_sample;
         }
-        if (ret != ESP_AE_ERR_OK) {
-            ESP_LOGE(TAG, "Fail to open AE for resample");
+    }
+    if (ret != ESP_AE_ERR_OK) {
+        ESP_LOGE(TAG, "Fail to open AE for resample");
+        close_chain(chain);
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    chain->valid = true;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int reserve_work_buf(resample_t *resample, resample_chain_t *chain, uint32_t sample_num)
+{
+    // Walk through chain to get size of each stage, stage output use work buffers in turn
+    av_render_audio_frame_info_t cur_info = chain->input_info;
+    for (int i = 0; i < ELEMS(chain->ops); i++) {
+        if (chain->ops[i] == RESAMPLE_OPS_NONE) {
+            break;
+        }
+        int need_size = get_need_size(chain, chain->ops[i], &sample_num, &cur_info);
+        work_buf_t *buf = &resample->work_buf[i & 1];
+        if (need_size > buf->size) {
+            uint8_t *new_buf = media_lib_realloc(buf->data, need_size);
+            if (new_buf == NULL) {
+                return ESP_MEDIA_ERR_NO_MEM;
+            }
+            buf->data = new_buf;
+            buf->size = need_size;
+        }
+        if (chain->ops[i] == RESAMPLE_OPS_CH_CVT) {
+            cur_info.channel = chain->output_info.channel;
+        } else if (chain->ops[i] == RESAMPLE_OPS_RATE_CVT) {
+            cur_info.sample_rate = chain->output_info.sample_rate;
+        } else if (chain->ops[i] == RESAMPLE_OPS_BIT_CVT) {
+            cur_info.bits_per_sample = chain->output_info.bits_per_sample;
+        }
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+static resample_chain_t *get_chain(resample_t *resample, av_render_audio_frame_info_t *input_info,
+                                   av_render_audio_frame_info_t *output_info)
+{
+    resample_chain_t *sel = NULL;
+    for (int i = 0; i < resample->chain_num; i++) {
+        resample_chain_t *chain = &resample->chains[i];
+        if (chain->valid == false) {
+            if (sel == NULL || sel->valid) {
+                sel = chain;
+            }
+            continue;
+        }
+        if (memcmp(&chain->input_info, input_info, sizeof(av_render_audio_frame_info_t)) == 0 &&
+            memcmp(&chain->output_info, output_info, sizeof(av_render_audio_frame_info_t)) == 0) {
+            chain->used_seq = ++resample->used_seq;
+            return chain;
+        }
+        // Evict least recently used one when no free slot
+        if (sel == NULL || (sel->valid && chain->used_seq < sel->used_seq)) {
+            sel = chain;
+        }
+    }
+    if (sel->valid) {
+        close_chain(sel);
+    }
+    if (open_chain(sel, input_info, output_info) != ESP_MEDIA_ERR_OK) {
+        return NULL;
+    }
+    sel->used_seq = ++resample->used_seq;
+    return sel;
+}
+
+audio_resample_handle_t audio_resample_open(audio_resample_cfg_t *cfg)
+{
+    resample_t *resample = (resample_t *)media_lib_calloc(1, sizeof(resample_t));
+    do {
+        if (resample == NULL) {
             break;
         }
         resample->cfg = *cfg;
+        // Current chain always take one slot
+        resample->chain_num = cfg->cache_num < RESAMPLE_MAX_CACHE ? cfg->cache_num + 1 : RESAMPLE_MAX_CACHE;
+        resample->chains = (resample_chain_t *)media_lib_calloc(resample->chain_num, sizeof(resample_chain_t));
+        if (resample->chains == NULL) {
+            break;
+        }
+        if (audio_resample_set_info(resample, &cfg->input_info, &cfg->output_info) != ESP_MEDIA_ERR_OK) {
+            break;
+        }
         return resample;
     } while (0);
     audio_resample_close(resample);
     return NULL;
 }
 
-int audio_resample_write(audio_resample_handle_t h, av_render_audio_frame_t *data)
+int audio_resample_set_info(audio_resample_handle_t h, av_render_audio_frame_info_t *input_info,
+                            av_render_audio_frame_info_t *output_info)
 {
     resample_t *resample = (resample_t *)h;
-    // Bypass or size is 0
-    if (data->size == 0 || resample->ops[0] == RESAMPLE_OPS_NONE) {
-        resample->cfg.resample_cb(data, resample->cfg.ctx);
-        return ESP_MEDIA_ERR_OK;
+    if (resample == NULL || input_info == NULL || output_info == NULL ||
+        SAMPLE_SIZE((*input_info)) == 0 || SAMPLE_SIZE((*output_info)) == 0) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    resample_chain_t *chain = get_chain(resample, input_info, output_info);
+    if (chain == NULL) {
+        resample->cur = NULL;
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    // Streaming mode size work buffers once so that no realloc happen during write
+    if (resample->cfg.block_samples && reserve_work_buf(resample, chain, resample->cfg.block_samples) != 0) {
+        resample->cur = NULL;
+        return ESP_MEDIA_ERR_NO_MEM;
     }
-    av_render_audio_frame_info_t cur_info = resample->cfg.input_info;
+    resample->cur = chain;
+    resample->cfg.input_info = *input_info;
+    resample->cfg.output_info = *output_info;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int resample_process(resample_t *resample, uint8_t *data, uint32_t sample_num, uint8_t **out, int *out_size)
+{
+    resample_chain_t *chain = resample->cur;
+    av_render_audio_frame_info_t cur_info = chain->input_info;
     work_buf_t *cur = NULL;
     work_buf_t *last = NULL;
-    uint32_t sample_num = data->size / SAMPLE_SIZE(cur_info);
     int need_size = 0;
-    for (int i = 0; i < ELEMS(resample->ops); i++) {
-        if (resample->ops[i] == RESAMPLE_OPS_NONE) {
+    for (int i = 0; i < ELEMS(chain->ops); i++) {
+        if (chain->ops[i] == RESAMPLE_OPS_NONE) {
             break;
         }
         uint32_t out_sample = sample_num;
-        need_size = get_need_size(resample, resample->ops[i], &out_sample, &cur_info);
+        need_size = get_need_size(chain, chain->ops[i], &out_sample, &cur_info);
         cur = alloc_work_buf(resample, need_size);
         if (cur == NULL) {
             release_work_buf(last);
             return ESP_MEDIA_ERR_NO_MEM;
         }
-        esp_ae_sample_t in_sample = (esp_ae_sample_t)(last ? last->data : data->data);
-        if (resample->ops[i] == RESAMPLE_OPS_CH_CVT) {
-            esp_ae_ch_cvt_process(resample->ch_cvt_handle, sample_num, in_sample, (esp_ae_sample_t)cur->data);
-            cur_info.channel = resample->cfg.output_info.channel;
-        } else if (resample->ops[i] == RESAMPLE_OPS_RATE_CVT) {
-            esp_ae_rate_cvt_process(resample->rate_cvt_handle, in_sample, sample_num, (esp_ae_sample_t)cur->data, &out_sample);
+        esp_ae_sample_t in_sample = (esp_ae_sample_t)(last ? last->data : data);
+        if (chain->ops[i] == RESAMPLE_OPS_CH_CVT) {
+            esp_ae_ch_cvt_process(chain->ch_cvt_handle, sample_num, in_sample, (esp_ae_sample_t)cur->data);
+            cur_info.channel = chain->output_info.channel;
+        } else if (chain->ops[i] == RESAMPLE_OPS_RATE_CVT) {
+            esp_ae_rate_cvt_process(chain->rate_cvt_handle, in_sample, sample_num, (esp_ae_sample_t)cur->data, &out_sample);
             need_size = out_sample * SAMPLE_SIZE(cur_info);
-            cur_info.sample_rate = resample->cfg.output_info.sample_rate;
+            cur_info.sample_rate = chain->output_info.sample_rate;
             sample_num = out_sample;
-        } else if (resample->ops[i] == RESAMPLE_OPS_BIT_CVT) {
-            esp_ae_bit_cvt_process(resample->bit_cvt_handle, sample_num, in_sample, (esp_ae_sample_t)cur->data);
-            cur_info.bits_per_sample = resample->cfg.output_info.bits_per_sample;
+        } else if (chain->ops[i] == RESAMPLE_OPS_BIT_CVT) {
+            esp_ae_bit_cvt_process(chain->bit_cvt_handle, sample_num, in_sample, (esp_ae_sample_t)cur->data);
+            cur_info.bits_per_sample = chain->output_info.bits_per_sample;
         }
         if (last) {
             release_work_buf(last);
@@ -233,10 +365,40 @@ int audio_resample_write(audio_resample_handle_t h, av_render_audio_frame_t *dat
         last = cur;
     }
     release_work_buf(cur);
+    *out = cur->data;
+    *out_size = need_size;
+    return ESP_MEDIA_ERR_OK;
+}
+
+int audio_resample_write(audio_resample_handle_t h, av_render_audio_frame_t *data)
+{
+    resample_t *resample = (resample_t *)h;
+    if (resample->cur == NULL) {
+        return ESP_MEDIA_ERR_WRONG_STATE;
+    }
+    // Bypass or size is 0
+    if (data->size == 0 || resample->cur->ops[0] == RESAMPLE_OPS_NONE) {
+        resample->cfg.resample_cb(data, resample->cfg.ctx);
+        return ESP_MEDIA_ERR_OK;
+    }
+    av_render_audio_frame_info_t *in_info = &resample->cur->input_info;
+    int sample_size = SAMPLE_SIZE((*in_info));
+    uint32_t sample_num = data->size / sample_size;
+    uint32_t block = resample->cfg.block_samples ? resample->cfg.block_samples : sample_num;
+    uint32_t done = 0;
     av_render_audio_frame_t new_frame = *data;
-    new_frame.data = cur->data;
-    new_frame.size = need_size;
-    resample->cfg.resample_cb(&new_frame, resample->cfg.ctx);
+    // Split into fixed blocks so that work memory and latency are bounded by block size
+    while (done < sample_num) {
+        uint32_t n = (sample_num - done) > block ? block : (sample_num - done);
+        int ret = resample_process(resample, data->data + done * sample_size, n, &new_frame.data, &new_frame.size);
+        if (ret != ESP_MEDIA_ERR_OK) {
+            return ret;
+        }
+        new_frame.pts = data->pts + (uint32_t)((uint64_t)done * 1000 / in_info->sample_rate);
+        done += n;
+        new_frame.eos = (done >= sample_num) ? data->eos : false;
+        resample->cfg.resample_cb(&new_frame, resample->cfg.ctx);
+    }
     return ESP_MEDIA_ERR_OK;
 }
 
@@ -246,17 +408,12 @@ void audio_resample_close(audio_resample_handle_t h)
     if (resample == NULL) {
         return;
     }
-    if (resample->bit_cvt_handle) {
-        esp_ae_bit_cvt_close(resample->bit_cvt_handle);
-        resample->bit_cvt_handle = NULL;
-    }
-    if (resample->ch_cvt_handle) {
-        esp_ae_ch_cvt_close(resample->ch_cvt_handle);
-        resample->ch_cvt_handle = NULL;
-    }
-    if (resample->rate_cvt_handle) {
-        esp_ae_rate_cvt_close(resample->rate_cvt_handle);
-        resample->rate_cvt_handle = NULL;
+    if (resample->chains) {
+        for (int i = 0; i < resample->chain_num; i++) {
+            close_chain(&resample->chains[i]);
+        }
+        media_lib_free(resample->chains);
+        resample->chains = NULL;
     }
     for (int i = 0; i < ELEMS(resample->work_buf); i++) {
         if (resample->work_buf[i].data) {
@@ -33,6 +33,12 @@
 #include "audio_render.h"
 #include "video_render.h"
 #include "audio_resample.h"
+#include "audio_jitter.h"
+#include "video_drop.h"
+#include "video_rate.h"
+#include "render_stats.h"
+#include "av_render_record.h"
+#include "media_clock.h"
 #include "esp_timer.h"
 #include "color_convert.h"
 #include "esp_log.h"
@@ -55,11 +61,48 @@
 #define VIDEO_ERR_FRAME_TOLERANCE (5)
 #define AUDIO_ERR_FRAME_TOLERANCE (10)
 
+// Resample in blocks to bound latency and work memory, keep chains for recent formats
+#define AUDIO_RESAMPLE_BLOCK_SAMPLES (512)
+#define AUDIO_RESAMPLE_CACHE_NUM     (2)
+
+// Maximum audio gap filled by packet loss concealment
+#define AUDIO_CONCEAL_MAX_MS (120)
+
+// Fallback drop limit of queued audio for live stream when adaptive buffer not enabled
+#define AUDIO_DROP_LATENCY_MS (200)
+#define AUDIO_JITTER_MIN_MS   (40)
+
+// Bound of audio render wait for more data, it is woken by data arrival in most case
+#define AUDIO_WAIT_MIN_MS (10)
+#define AUDIO_WAIT_MAX_MS (200)
+
+// Video frame duration when fps is unknown
+#define VIDEO_DEFAULT_FPS (20)
+// Measured frame rate is preferred over stream fps when confidence reaches it
+#define VIDEO_RATE_MIN_CONFIDENCE (50)
+// Video restart sync when it is off from media clock more than this
+#define VIDEO_SYNC_LOST_MS (600)
+// Frames video can fall behind media clock before dropped in decoder or render
+#define VIDEO_DECODE_LATE_FRAMES (3)
+#define VIDEO_RENDER_LATE_FRAMES (4)
+// Frames behind before reference frame is dropped and decoder skips until next IDR
+#define VIDEO_DECODE_FAR_FRAMES  (10)
+// Queued frames to drop when not sync, reference frame is dropped when reach far one
+#define VIDEO_DECODE_LATE_QUEUE  (2)
+#define VIDEO_DECODE_FAR_QUEUE   (6)
+// Longest wait for render thread to finish frames of old resolution
+#define VIDEO_RESIZE_WAIT_MS (200)
+
+// Audio rate correction under time sync, 0.1% speed change for each step of error
+#define AUDIO_CLOCK_STEP_MS  (4)
+#define AUDIO_CLOCK_MAX_STEP (10)
+
 typedef enum {
     AV_RENDER_MSG_NONE,
     AV_RENDER_MSG_PAUSE,
     AV_RENDER_MSG_RESUME,
     AV_RENDER_MSG_FLUSH,
+    AV_RENDER_MSG_DRAIN,
     AV_RENDER_MSG_DATA,
     AV_RENDER_MSG_CLOSE,
 } av_render_msg_type_t;
@@ -86,6 +129,7 @@ typedef struct {
     av_render_thread_res_t thread_res;
     adec_handle_t          adec;
     int                    audio_err_cnt;
+    uint32_t               cb_us;
 } av_render_adec_res_t;
 
 typedef struct {
@@ -98,6 +142,14 @@ typedef struct {
     color_convert_table_t       *vid_convert;
     uint8_t                     *vid_convert_out;
     int                          vid_convert_out_size;
+    uint8_t                     *dec_out;
+    int                          dec_out_size;
+    bool                         full_range;
+    av_render_video_transform_t  transform;
+    uint16_t                     dec_width;
+    uint16_t                     dec_height;
+    video_drop_handle_t          drop;
+    uint32_t                     cb_us;
 } av_render_vdec_res_t;
 
 struct _av_render;
@@ -110,10 +162,17 @@ typedef struct {
     av_render_audio_frame_info_t out_frame_info;
     audio_resample_handle_t      resample_handle;
     bool                         need_resample;
+    bool                         resample_active;
+    audio_jitter_handle_t        jitter;
+    float                        jitter_speed;
+    uint16_t                     jitter_min_ms;
+    float                        clock_speed;
     uint32_t                     audio_send_pts;
+    uint32_t                     audio_recv_pts;
     bool                         decode_in_sync;
     bool                         audio_is_pcm;
     bool                         a_render_in_sync;
+    uint32_t                     cb_us;
 } av_render_audio_res_t;
 
 typedef struct {
@@ -124,13 +183,14 @@ typedef struct {
     bool                         decode_in_sync;
     bool                         use_fb;
     uint32_t                     video_send_pts;
+    uint32_t                     video_recv_pts;
     bool                         v_render_in_sync;
     bool                         video_is_raw;
     uint32_t                     sent_frame_num;
-    uint32_t                     video_start_time;
     uint32_t                     video_start_pts;
-    uint32_t                     video_last_pts;
-    int                          sync_tolerance;
+    uint8_t                      stream_fps;
+    video_rate_handle_t          rate;
+    int32_t                      av_offset;
 } av_render_video_res_t;
 
 typedef struct _av_render {
@@ -145,10 +205,17 @@ typedef struct _av_render {
     media_lib_event_grp_handle_t event_group;
     media_lib_mutex_handle_t     api_lock;
     uint32_t                     audio_threshold;
+    float                        play_speed;
+    media_clock_handle_t         clock;
+    media_clock_handle_t         audio_clock;
     av_render_event_cb           event_cb;
     void                        *event_ctx;
     av_render_pool_data_free     pool_free;
     void                        *pool;
+    render_stats_t              *audio_stats;
+    render_stats_t              *video_stats;
+    av_render_record_handle_t    record;
+    int64_t                      record_start;
 } av_render_t;
 
 typedef enum {
@@ -229,16 +296,16 @@ static int put_to_a_render(data_queue_t *q, av_render_audio_frame_t *data)
     return data_queue_send_buffer(q, size);
 }
 
-static int put_to_v_render(data_queue_t *q, av_render_video_frame_t *data)
+static int put_to_v_render(data_queue_t *q, av_render_video_frame_t *data, bool use_pool)
 {
     int head_size = sizeof(av_render_video_frame_t);
-    int size = head_size + data->size;
+    int size = head_size + (use_pool ? 0 : data->size);
     uint8_t *b = (uint8_t *)data_queue_get_buffer(q, size);
     if (b == NULL) {
         return -1;
     }
     memcpy(b, data, head_size);
-    if (data->size) {
+    if (use_pool == false && data->size) {
         memcpy(b + head_size, data->data, data->size);
     }
     return data_queue_send_buffer(q, size);
@@ -304,13 +371,18 @@ static int read_for_a_render(data_queue_t *q, av_render_audio_frame_t *data)
     return ret;
 }
 
-static int read_for_v_render(data_queue_t *q, av_render_video_frame_t *data)
+static int read_for_v_render(data_queue_t *q, av_render_video_frame_t *data, bool use_pool)
 {
     uint8_t *b;
     int size;
     int ret = data_queue_read_lock(q, (void **)&b, &size);
     RETURN_ON_FAIL(ret);
     av_render_video_frame_t *r = (av_render_video_frame_t *)b;
+    // Frame from data pool is kept by reference
+    if (use_pool) {
+        *data = *r;
+        return ret;
+    }
     if (r->data > b && r->data + r->size == b + size) {
         *data = *r;
         return ret;
@@ -325,6 +397,20 @@ static int read_for_v_render(data_queue_t *q, av_render_video_frame_t *data)
     return ret;
 }
 
+static void record_call(av_render_t *render, av_render_record_item_t *item)
+{
+    // Called with API lock held so that audio and video records are not interleaved
+    if (render->record == NULL) {
+        return;
+    }
+    item->time_us = (uint64_t)(esp_timer_get_time() - render->record_start);
+    if (av_render_record_write(render->record, item) != ESP_MEDIA_ERR_OK) {
+        ESP_LOGE(TAG, "Fail to write record, stop recording");
+        av_render_record_close(render->record);
+        render->record = NULL;
+    }
+}
+
 static void dump_data(av_render_dump_type_t type, uint8_t *data, int size)
 {
     static FILE *fp[AV_RENDER_DUMP_STOP_INDEX];
@@ -362,12 +448,50 @@ static void dump_data(av_render_dump_type_t type, uint8_t *data, int size)
     }
 }
 
+static void stats_decode_start(render_stats_t *stats, uint32_t pts, uint32_t start)
+{
+    uint32_t wait = 0;
+    if (render_stats_since_arrive(stats, pts, start, &wait)) {
+        render_stats_add(stats, AV_RENDER_STAGE_QUEUE_WAIT, wait);
+    }
+}
+
+static void stats_decode_end(render_stats_t *stats, int ret, uint32_t decode_us)
+{
+    if (ret != 0) {
+        render_stats_drop(stats, AV_RENDER_DROP_DECODE_ERR);
+        return;
+    }
+    render_stats_add(stats, AV_RENDER_STAGE_DECODE, decode_us);
+    render_stats_inc(&stats->decoded_num);
+}
+
+static void stats_render_end(render_stats_t *stats, uint32_t pts, uint32_t start, uint32_t device_ms)
+{
+    uint32_t end = render_stats_now();
+    render_stats_add(stats, AV_RENDER_STAGE_RENDER, end - start);
+    render_stats_inc(&stats->rendered_num);
+    uint32_t elapse = 0;
+    if (render_stats_since_arrive(stats, pts, end, &elapse)) {
+        render_stats_add(stats, AV_RENDER_STAGE_END_TO_END, elapse + device_ms * 1000);
+    }
+}
+
 static int decode_audio(av_render_adec_res_t *adec_res, av_render_audio_data_t *data)
 {
     int ret = 0;
     if (data->size || data->eos) {
-        dump_data(AV_RENDER_DUMP_ADEC_DATA, data->data, data->size);
+        render_stats_t *stats = adec_res->thread_res.render->audio_stats;
+        uint32_t start = render_stats_now();
+        if (stats && data->size) {
+            stats_decode_start(stats, data->pts, start);
+        }
+        // Time in frame callback belongs to later stages
+        adec_res->cb_us = 0;
         ret = adec_decode(adec_res->adec, data);
+        if (stats && data->size) {
+            stats_decode_end(stats, ret, render_stats_now() - start - adec_res->cb_us);
+        }
         if (ret != 0) {
             av_render_t *render = adec_res->thread_res.render;
             adec_res->audio_err_cnt++;
@@ -410,59 +534,186 @@ static int adec_body(av_render_thread_res_t *res, bool drop)
     return 0;
 }
 
-static int get_video_sync_time(av_render_t *render, av_render_video_res_t *v_render, uint32_t *cur_time,
-                               uint32_t *ref_time)
+static uint32_t video_frame_ms(av_render_video_res_t *v_render)
 {
-    int ret = 0;
-    *ref_time = get_cur_time() - v_render->video_start_time + v_render->video_start_pts;
-    if (render->cfg.sync_mode == AV_RENDER_SYNC_FOLLOW_AUDIO) {
-        ret = av_render_get_audio_pts(render, cur_time);
-    } else {
-        *cur_time = *ref_time;
+    // Stream fps is only kept when PTS too irregular to measure
+    video_rate_info_t info;
+    if (video_rate_get(v_render->rate, &info) &&
+        (info.confidence >= VIDEO_RATE_MIN_CONFIDENCE || v_render->stream_fps == 0)) {
+        return (info.frame_us + 500) / 1000;
     }
-    return ret;
+    int fps = v_render->stream_fps;
+    return 1000 / (fps ? fps : VIDEO_DEFAULT_FPS);
 }
 
-static int video_sync_control_before_decode(av_render_t *render, uint32_t video_pts, int q_num, bool *skip)
+static video_drop_late_t video_decode_late_level(av_render_t *render, uint32_t video_pts, int q_num)
 {
     av_render_video_res_t *v_render = render->v_render_res;
-    if (render->cfg.allow_drop_data == false) {
-        return 0;
-    }
-    // No need sync, return directly
+    // No need sync, judge from queued frames
     if (render->cfg.sync_mode == AV_RENDER_SYNC_NONE) {
-        if (q_num >= 2) {
-            *skip = true;
+        if (q_num >= VIDEO_DECODE_FAR_QUEUE) {
+            return VIDEO_DROP_LATE_FAR;
         }
+        return q_num >= VIDEO_DECODE_LATE_QUEUE ? VIDEO_DROP_LATE : VIDEO_DROP_LATE_NONE;
+    }
+    // Do not skip data until first frame rendered and clock running
+    if (v_render->sent_frame_num == 0 || media_clock_started(render->clock) == false) {
+        return VIDEO_DROP_LATE_NONE;
+    }
+    uint32_t now = media_clock_get(render->clock, get_cur_time());
+    int32_t behind = (int32_t)(now - video_pts);
+    int32_t frame_ms = (int32_t)video_frame_ms(v_render);
+    if (behind > frame_ms * VIDEO_DECODE_FAR_FRAMES) {
+        return VIDEO_DROP_LATE_FAR;
+    }
+    return behind > frame_ms * VIDEO_DECODE_LATE_FRAMES ? VIDEO_DROP_LATE : VIDEO_DROP_LATE_NONE;
+}
+
+static int video_sync_control_before_decode(av_render_t *render, av_render_video_data_t *data, int q_num, bool *skip)
+{
+    if (render->cfg.allow_drop_data == false) {
         return 0;
     }
-    uint32_t now, ref_time;
-    int ret = get_video_sync_time(render, v_render, &now, &ref_time);
-    RETURN_ON_FAIL(ret);
-    if (v_render->sent_frame_num) {
-        // Do not skip data until first frame decoded
-        // TODO currently set 100 as tolerance
-        if (video_pts + 100 < now) {
-            printf("D %d < %d\n", (int)video_pts, (int)now);
-            *skip = true;
-        }
+    video_drop_late_t late = video_decode_late_level(render, data->pts, q_num);
+    bool key_request = false;
+    // Drop policy keeps skipping until IDR even when no longer late
+    video_drop_reason_t reason = video_drop_check(render->vdec_res->drop, data->data, data->size, data->pts, late,
+                                                  &key_request);
+    if (reason != VIDEO_DROP_REASON_NONE) {
+        ESP_LOGD(TAG, "Skip decode pts %d late level %d", (int)data->pts, late);
+        render_stats_drop(render->video_stats,
+                          reason == VIDEO_DROP_REASON_WAIT_IDR ? AV_RENDER_DROP_BROKEN_REF : AV_RENDER_DROP_LATE);
+        *skip = true;
+    }
+    if (key_request && render->event_cb) {
+        render->event_cb(AV_RENDER_EVENT_VIDEO_KEY_FRAME_REQUEST, render->event_ctx);
     }
     return 0;
 }
 
-static int audio_drop_before_render(av_render_t *render, int size, bool *skip)
+static uint32_t audio_bytes_to_ms(av_render_audio_res_t *a_render, uint32_t size)
+{
+    // Render use resample output format when resample enabled
+    av_render_audio_frame_info_t *info = a_render->resample_active ? &a_render->out_frame_info : &a_render->audio_frame_info;
+    int sample_size = info->channel * info->bits_per_sample >> 3;
+    if (info->sample_rate == 0 || sample_size == 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)size / sample_size * 1000 / info->sample_rate);
+}
+
+static uint32_t audio_queued_ms(av_render_audio_res_t *a_render, int q_num, int q_size)
+{
+    // Exclude frame header stored together with PCM data
+    int size = q_size - q_num * (int)sizeof(av_render_audio_frame_t);
+    return size > 0 ? audio_bytes_to_ms(a_render, size) : 0;
+}
+
+static int audio_drop_before_render(av_render_t *render, uint32_t latency, bool *skip)
 {
     if (render->cfg.allow_drop_data == false) {
         return 0;
     }
-    av_render_audio_frame_info_t *info = &render->a_render_res->out_frame_info;
     // No need sync, return directly
-    if (render->cfg.sync_mode == AV_RENDER_SYNC_NONE && info->sample_rate) {
-        int sample_size = info->channel * info->bits_per_sample >> 3;
-        int latency = size / sample_size * 1000 / info->sample_rate;
-        if (latency >= 200) {
-            *skip = true;
-        }
+    if (render->cfg.sync_mode == AV_RENDER_SYNC_NONE && latency >= AUDIO_DROP_LATENCY_MS) {
+        *skip = true;
+    }
+    return 0;
+}
+
+static void audio_wait_more_data(av_render_thread_res_t *res, int q_num, uint32_t cur_ms, uint32_t target_ms)
+{
+    data_queue_peek_unlock(res->data_q);
+    // Arrival, pause, flush and close wake it up, timeout is when missing data is due at real time pace
+    uint32_t timeout = target_ms > cur_ms ? target_ms - cur_ms : 0;
+    if (timeout < AUDIO_WAIT_MIN_MS) {
+        timeout = AUDIO_WAIT_MIN_MS;
+    } else if (timeout > AUDIO_WAIT_MAX_MS) {
+        timeout = AUDIO_WAIT_MAX_MS;
+    }
+    data_queue_wait_arrive(res->data_q, q_num, timeout);
+}
+
+static int audio_apply_speed(av_render_t *render)
+{
+    av_render_audio_res_t *a_render = render->a_render_res;
+    uint32_t cur = get_cur_time();
+    float speed = render->play_speed;
+    // Time sync master runs at play speed only
+    if (render->audio_clock) {
+        media_clock_set_speed(render->clock, cur, speed);
+    }
+    if (a_render && a_render->jitter && a_render->jitter_speed) {
+        speed *= a_render->jitter_speed;
+    }
+    if (a_render && a_render->clock_speed) {
+        speed *= a_render->clock_speed;
+    }
+    // Clock driven by audio runs at the pace audio is consumed
+    media_clock_set_speed(render->audio_clock ? render->audio_clock : render->clock, cur, speed);
+    return audio_render_set_speed(render->cfg.audio_render, speed);
+}
+
+static void audio_sync_clock(av_render_t *render)
+{
+    uint32_t audio_pts = 0;
+    if (av_render_get_audio_pts(render, &audio_pts) != 0) {
+        return;
+    }
+    uint32_t cur = get_cur_time();
+    if (render->audio_clock == NULL) {
+        // Audio position is master of media clock
+        media_clock_sync(render->clock, cur, audio_pts);
+        return;
+    }
+    media_clock_sync(render->audio_clock, cur, audio_pts);
+    if (media_clock_started(render->clock) == false) {
+        media_clock_start(render->clock, cur, audio_pts);
+        return;
+    }
+    // Adaptive buffer owns time stretch, otherwise pull audio toward system time by resampling rate
+    av_render_audio_res_t *a_render = render->a_render_res;
+    if (a_render->jitter) {
+        return;
+    }
+    int32_t offset = (int32_t)(media_clock_get(render->audio_clock, cur) - media_clock_get(render->clock, cur));
+    int step = offset / AUDIO_CLOCK_STEP_MS;
+    if (offset > VIDEO_SYNC_LOST_MS || offset < -VIDEO_SYNC_LOST_MS) {
+        // Too far to catch up by resampling
+        step = 0;
+    } else if (step > AUDIO_CLOCK_MAX_STEP) {
+        step = AUDIO_CLOCK_MAX_STEP;
+    } else if (step < -AUDIO_CLOCK_MAX_STEP) {
+        step = -AUDIO_CLOCK_MAX_STEP;
+    }
+    float speed = 1.0f - step * 0.001f;
+    if (speed != a_render->clock_speed) {
+        a_render->clock_speed = speed;
+        audio_apply_speed(render);
+    }
+}
+
+static int audio_jitter_before_render(av_render_t *render, uint32_t latency, bool *skip)
+{
+    av_render_audio_res_t *a_render = render->a_render_res;
+    // User threshold act as lower bound of target depth
+    uint32_t min_ms = render->audio_threshold ? audio_bytes_to_ms(a_render, render->audio_threshold) : AUDIO_JITTER_MIN_MS;
+    if (min_ms != a_render->jitter_min_ms) {
+        a_render->jitter_min_ms = min_ms;
+        audio_jitter_set_min(a_render->jitter, min_ms);
+    }
+    float speed = 1.0f;
+    audio_jitter_action_t action = audio_jitter_control(a_render->jitter, latency, &speed);
+    if (action == AUDIO_JITTER_ACTION_WAIT) {
+        return 1;
+    }
+    if (action == AUDIO_JITTER_ACTION_DROP) {
+        *skip = true;
+    }
+    // Converge to target depth by time stretching
+    if (speed != a_render->jitter_speed) {
+        a_render->jitter_speed = speed;
+        audio_apply_speed(render);
     }
     return 0;
 }
@@ -470,18 +721,23 @@ static int audio_drop_before_render(av_render_t *render, int size, bool *skip)
 static int decode_video(av_render_vdec_res_t *vdec_res, av_render_video_data_t *data)
 {
     av_render_t *render = vdec_res->thread_res.render;
-    if (render->v_render_res->thread_res.thread == NULL) {
-        // Get frame buffer not support render in separate thread
-        av_render_frame_buffer_t frame_buffer = { 0 };
-        int ret = video_render_get_frame_buffer(render->cfg.video_render, &frame_buffer);
-        if (ret == 0) {
-            vdec_set_frame_buffer(vdec_res->vdec, &frame_buffer);
-        }
-    }
     int ret = 0;
     if (data->size || data->eos) {
-        dump_data(AV_RENDER_DUMP_VDEC_DATA, data->data, data->size);
+        render_stats_t *stats = render->video_stats;
+        uint32_t start = render_stats_now();
+        if (stats && data->size) {
+            stats_decode_start(stats, data->pts, start);
+        }
+        vdec_res->cb_us = 0;
         int ret = vdec_decode(vdec_res->vdec, data);
+        if (stats && data->size) {
+            uint32_t convert_us = 0;
+            vdec_get_convert_time(vdec_res->vdec, &convert_us);
+            if (convert_us) {
+                render_stats_add(stats, AV_RENDER_STAGE_CONVERT, convert_us);
+            }
+            stats_decode_end(stats, ret, render_stats_now() - start - vdec_res->cb_us - convert_us);
+        }
         if (ret != 0) {
             vdec_res->video_err_cnt++;
             if (vdec_res->video_err_cnt == AUDIO_ERR_FRAME_TOLERANCE) {
@@ -502,20 +758,20 @@ static int vdec_body(av_render_thread_res_t *res, bool drop)
 {
     av_render_video_data_t data;
     av_render_vdec_res_t *vdec_res = (av_render_vdec_res_t *)res;
-    int ret = read_for_vdec(res->data_q, &data, vdec_res->thread_res.render->pool_free != NULL);
+    int ret = read_for_vdec(res->data_q, &data, res->use_pool);
     RETURN_ON_FAIL(ret);
     int q_num = 0, q_size = 0;
     data_queue_query(res->data_q, &q_num, &q_size);
     // EOS data may not contain size
     if (data.size || data.eos) {
         bool skip = false;
-        video_sync_control_before_decode(res->render, data.pts, q_num, &skip);
+        video_sync_control_before_decode(res->render, &data, q_num, &skip);
         if (drop == false && (skip == false || data.eos)) {
             decode_video(vdec_res, &data);
         }
     }
-    if (data.data && vdec_res->thread_res.use_pool) {
-        vdec_res->thread_res.render->pool_free(data.data, vdec_res->thread_res.render->pool);
+    if (data.data && res->use_pool) {
+        res->render->pool_free(data.data, res->render->pool);
     }
     data_queue_read_unlock(res->data_q);
     if (data.eos) {
@@ -529,68 +785,69 @@ static int vdec_body(av_render_thread_res_t *res, bool drop)
     return 0;
 }
 
+static void video_wait_frame_due(av_render_t *render, uint32_t wait_time)
+{
+    // Wait on queue of current thread so that pause, flush and close wake it up early
+    data_queue_t *q = NULL;
+    if (render->v_render_res->thread_res.thread) {
+        q = render->v_render_res->thread_res.data_q;
+    } else if (render->vdec_res && render->vdec_res->thread_res.thread) {
+        q = render->vdec_res->thread_res.data_q;
+    }
+    if (q == NULL) {
+        media_lib_thread_sleep(wait_time);
+        return;
+    }
+    data_queue_wait_arrive(q, -1, wait_time);
+}
+
 static int video_sync_control_before_render(av_render_t *render, uint32_t video_pts, bool *skip)
 {
     av_render_video_res_t *v_render = render->v_render_res;
-    // No need sync, return directly
-    if (render->cfg.sync_mode == AV_RENDER_SYNC_NONE) {
+    uint32_t latency = 0;
+    video_render_get_latency(render->cfg.video_render, &latency);
+    // Frame is shown after render latency, compare its display time with clock
+    uint32_t due = video_pts - latency;
+    uint32_t cur = get_cur_time();
+    if (render->cfg.sync_mode == AV_RENDER_SYNC_FOLLOW_TIME && media_clock_started(render->clock) == false) {
+        media_clock_start(render->clock, cur, due);
+    }
+    if (v_render->sent_frame_num == 0) {
+        ESP_LOGI(TAG, "Video start pts set to %" PRIu32, video_pts);
+        v_render->video_start_pts = video_pts;
+    }
+    v_render->sent_frame_num++;
+    // Render directly before audio drive the clock
+    if (media_clock_started(render->clock) == false) {
         return 0;
     }
-    // Decoder sync control only skip data to avoid decoder too slow
-    uint32_t now, ref_time, audio_pts;
-    int ret = get_video_sync_time(render, v_render, &audio_pts, &ref_time);
-    RETURN_ON_FAIL(ret);
-    now = audio_pts;
-    int fps = v_render->video_frame_info.fps;
-    if (fps == 0) {
-        fps = 20;
-    }
-    if (v_render->sent_frame_num) {
-        uint32_t video_cur_pts = 0;
-        av_render_get_video_pts(render, &video_cur_pts);
-        bool in_sync = false;
-        for (int i = 0; i < 2; i++) {
-            if (video_cur_pts < now + v_render->sync_tolerance && video_cur_pts + v_render->sync_tolerance > now) {
-                in_sync = true;
-                break;
+    int32_t diff = (int32_t)(due - media_clock_get(render->clock, cur));
+    if (render->cfg.sync_mode != AV_RENDER_SYNC_NONE) {
+        if (diff > VIDEO_SYNC_LOST_MS || diff < -VIDEO_SYNC_LOST_MS) {
+            ESP_LOGE(TAG, "Video lost sync pts:%d diff:%d", (int)video_pts, (int)diff);
+            if (render->cfg.sync_mode == AV_RENDER_SYNC_FOLLOW_TIME) {
+                media_clock_start(render->clock, cur, due);
             }
-            if (now == ref_time) {
-                break;
+        } else if (diff > 0) {
+            // Clock may run faster or slower than system time
+            float rate = media_clock_get_rate(render->clock);
+            video_wait_frame_due(render, rate > 0 ? (uint32_t)(diff / rate) : (uint32_t)diff);
+        } else if (diff + (int32_t)(video_frame_ms(v_render) * VIDEO_RENDER_LATE_FRAMES) <= 0) {
+            // Only do drop if not drop data before decode
+            if (render->cfg.allow_drop_data == false) {
+                *skip = true;
             }
-            now = ref_time;
-            continue;
-        }
-        if (in_sync) {
-            if (video_cur_pts > now) {
-                uint32_t sleep_time = video_cur_pts - now;
-                uint32_t max_frame_time = 2 * 1000 / fps;
-                if (sleep_time > max_frame_time) {
-                    sleep_time = max_frame_time;
-                }
-                media_lib_thread_sleep(sleep_time);
-            } else {
-                // TODO need more accurate to control drop threshold
-                uint32_t frame_pts = 1000 / fps * 4;
-                // Only do drop if not drop data before decode
-                if (video_pts + frame_pts <= now && render->cfg.allow_drop_data == false) {
-                    *skip = true;
-                }
-            }
-            if ((v_render->sent_frame_num % fps) == 0) {
-                ESP_LOGI(TAG, "Video pts:%d now:%d ref:%d", (int)video_cur_pts, (int)audio_pts, (int)ref_time);
-            }
-        } else {
-            // Lost sync need resync from now
-            v_render->sent_frame_num = 0;
-            ESP_LOGE(TAG, "Video lost sync now:%d audio:%d ref:%d", (int)video_cur_pts, (int)audio_pts, (int)ref_time);
         }
     }
-    if (v_render->sent_frame_num == 0) {
-        ESP_LOGI(TAG, "Video start pts set to %" PRIu32, video_pts);
-        v_render->video_start_time = get_cur_time();
-        v_render->video_start_pts = video_pts;
+    // Offset against audio position, positive when video is ahead
+    media_clock_handle_t audio_clock = render->audio_clock ? render->audio_clock : render->clock;
+    if (media_clock_started(audio_clock)) {
+        v_render->av_offset = (int32_t)(due - media_clock_get(audio_clock, get_cur_time()));
+    }
+    uint32_t frame_ms = video_frame_ms(v_render);
+    if ((v_render->sent_frame_num % (1000 / (frame_ms ? frame_ms : 1))) == 0) {
+        ESP_LOGI(TAG, "Video pts:%d av offset:%d", (int)video_pts, (int)v_render->av_offset);
     }
-    v_render->sent_frame_num++;
     return 0;
 }
 
@@ -609,15 +866,23 @@ static int _render_write_audio(av_render_thread_res_t *res, av_render_audio_fram
     if (res->paused) {
         return 0;
     }
-    // Update send pts
-    res->render->a_render_res->audio_send_pts = audio_frame->pts;
+    // Update send pts to end of frame so that minus render latency get playing position
+    res->render->a_render_res->audio_send_pts = audio_frame->pts + audio_bytes_to_ms(res->render->a_render_res, audio_frame->size);
     int ret = 0;
-    if (res->flushing == false) {
+    // EOS frame may carry no data
+    if (res->flushing == false && audio_frame->size) {
+        uint32_t start = render_stats_now();
         ret = audio_render_write(res->render->cfg.audio_render, audio_frame);
         if (ret != 0) {
             ESP_LOGE(TAG, "Fail to render audio ret %d", ret);
             return ret;
         }
+        if (res->render->audio_stats) {
+            uint32_t latency = 0;
+            audio_render_get_latency(res->render->cfg.audio_render, &latency);
+            stats_render_end(res->render->audio_stats, audio_frame->pts, start, latency);
+        }
+        audio_sync_clock(res->render);
     }
     if (audio_frame->eos) {
         if (res->render->event_cb) {
@@ -663,11 +928,16 @@ static int _render_write_video(av_render_thread_res_t *res, av_render_video_fram
                 // Do av sync logic
                 video_sync_control_before_render(res->render, video_frame->pts, &skip);
             }
+            uint32_t start = render_stats_now();
             if (1 || skip == false) {
                 ret = video_render_write(res->render->cfg.video_render, video_frame);
             }
             if (ret != 0) {
                 ESP_LOGE(TAG, "Fail to render video ret %d", ret);
+            } else if (res->render->video_stats && video_frame->size) {
+                uint32_t latency = 0;
+                video_render_get_latency(res->render->cfg.video_render, &latency);
+                stats_render_end(res->render->video_stats, video_frame->pts, start, latency);
             }
         }
     }
@@ -689,30 +959,43 @@ static int a_render_body(av_render_thread_res_t *res, bool drop)
     if (data.size) {
         int q_num = 0, q_size = 0;
         data_queue_query(res->data_q, &q_num, &q_size);
-        if (res->paused == false && res->render->audio_threshold) {
+        uint32_t latency = audio_queued_ms(res->render->a_render_res, q_num, q_size);
+        if (res->render->a_render_res->jitter) {
+            if (drop == false && res->paused == false && audio_jitter_before_render(res->render, latency, &skip) > 0) {
+                // Wait for data reach target depth
+                audio_jitter_stats_t stats = { 0 };
+                audio_jitter_get_stats(res->render->a_render_res->jitter, &stats);
+                audio_wait_more_data(res, q_num, latency, stats.target_ms);
+                return 0;
+            }
+        } else if (drop == false && res->paused == false && res->render->audio_threshold) {
+            uint32_t threshold_ms = audio_bytes_to_ms(res->render->a_render_res, res->render->audio_threshold);
             if (res->render->a_render_res->audio_rendered == false) {
                 if (q_size < res->render->audio_threshold) {
-                    data_queue_peek_unlock(res->data_q);
                     // Wait for data reach threshold
-                    media_lib_thread_sleep(10);
+                    audio_wait_more_data(res, q_num, latency, threshold_ms);
                     return 0;
                 }
             } else if (q_num < 3) {
                 res->render->a_render_res->audio_rendered = false;
-                data_queue_peek_unlock(res->data_q);
-                media_lib_thread_sleep(10);
+                audio_wait_more_data(res, q_num, latency, threshold_ms);
                 return 0;
             }
         }
-        audio_drop_before_render(res->render, q_size, &skip);
+        if (res->render->a_render_res->jitter == NULL) {
+            audio_drop_before_render(res->render, latency, &skip);
+        }
     }
     if (drop == false && skip == false && (data.size || data.eos)) {
         ret = _render_write_audio(res, &data);
         if (ret != 0) {
             ESP_LOGE(TAG, "Fail to render audio");
         }
+    } else if (skip) {
+        render_stats_drop(res->render->audio_stats, AV_RENDER_DROP_LATE);
     }
-    if (res->paused) {
+    // Keep frame for paused render, but always consume when drop so that flush can finish
+    if (res->paused && drop == false) {
         data_queue_peek_unlock(res->data_q);
     } else {
         data_queue_read_unlock(res->data_q);
@@ -720,34 +1003,83 @@ static int a_render_body(av_render_thread_res_t *res, bool drop)
     return 0;
 }
 
+static int convert_video_frame(av_render_t *render, av_render_video_frame_t *frame)
+{
+    av_render_vdec_res_t *vdec_res = render->vdec_res;
+    int out_size = vdec_res->vid_convert_out_size;
+    uint8_t *out = NULL;
+    av_render_frame_buffer_t frame_buffer = { 0 };
+    // Convert into render frame buffer directly so that render need not copy again
+    if (video_render_get_frame_buffer(render->cfg.video_render, &frame_buffer) == 0 && frame_buffer.data &&
+        frame_buffer.size >= out_size) {
+        out = frame_buffer.data;
+    } else {
+        if (vdec_res->vid_convert_out == NULL) {
+            vdec_res->vid_convert_out = media_lib_malloc(out_size);
+            if (vdec_res->vid_convert_out == NULL) {
+                ESP_LOGE(TAG, "Fail to allocate video convert output");
+                return ESP_MEDIA_ERR_NO_MEM;
+            }
+        }
+        out = vdec_res->vid_convert_out;
+    }
+    uint32_t start = render_stats_now();
+    int ret = convert_color(vdec_res->vid_convert, frame->data, frame->size, out, out_size);
+    render_stats_add(render->video_stats, AV_RENDER_STAGE_CONVERT, render_stats_now() - start);
+    frame->data = out;
+    frame->size = out_size;
+    return ret;
+}
+
 static int v_render_body(av_render_thread_res_t *res, bool drop)
 {
     av_render_video_frame_t data;
-    int ret = read_for_v_render(res->data_q, &data);
+    int ret = read_for_v_render(res->data_q, &data, res->use_pool);
     RETURN_ON_FAIL(ret);
     if (drop == false && (data.size || data.eos)) {
         av_render_vdec_res_t *vdec_res = res->render->vdec_res;
+        uint8_t *data_ptr = data.data;
         if (vdec_res && vdec_res->vid_convert) {
             // Do color convert firstly
-            ret = convert_color(vdec_res->vid_convert,
-                 data.data, data.size,
-                 vdec_res->vid_convert_out, vdec_res->vid_convert_out_size);
-            data.data = vdec_res->vid_convert_out;
-            data.size = vdec_res->vid_convert_out_size;
+            ret = convert_video_frame(res->render, &data);
         }
         ret = _render_write_video(res, &data);
+        data.data = data_ptr;
         if (ret != 0) {
             ESP_LOGE(TAG, "Fail to render video");
         }
     }
-    if (res->paused) {
+    // Keep frame for paused render, but always consume when drop so that flush can finish
+    if (res->paused && drop == false) {
         data_queue_peek_unlock(res->data_q);
     } else {
+        if (data.data && res->use_pool) {
+            res->render->pool_free(data.data, res->render->pool);
+        }
         data_queue_read_unlock(res->data_q);
     }
     return 0;
 }
 
+static int render_msg_priority(av_render_msg_type_t type)
+{
+    switch (type) {
+        case AV_RENDER_MSG_CLOSE:
+            return 2;
+        case AV_RENDER_MSG_FLUSH:
+        case AV_RENDER_MSG_DRAIN:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static int render_msg_cmp(void *a, void *b, void *tag)
+{
+    // Close and flush jump ahead of queued pause resume and data messages
+    return render_msg_priority(((av_render_msg_t *)b)->type) - render_msg_priority(((av_render_msg_t *)a)->type);
+}
+
 static int create_thread_res(av_render_thread_res_t *res, const char *name,
                              int (*body)(av_render_thread_res_t *res, bool drop),
                              int buffer_size, int wait_bits)
@@ -759,9 +1091,10 @@ static int create_thread_res(av_render_thread_res_t *res, const char *name,
         if (res->msg_q == NULL) {
             break;
         }
+        msg_q_sort(res->msg_q, render_msg_cmp, NULL);
         res->name = name;
         if (res->data_q == NULL) {
-            res->data_q = data_queue_init(buffer_size);
+            res->data_q = data_queue_init_spsc(buffer_size);
         }
         if (res->data_q == NULL) {
             break;
@@ -804,6 +1137,9 @@ static int send_msg_to_thread(av_render_thread_res_t *res, int head_size, av_ren
                 memset(b, 0, head_size);
                 data_queue_send_buffer(res->data_q, head_size);
             }
+        } else {
+            // Reader may wait for more data or frame due time
+            data_queue_wake_reader(res->data_q);
         }
     }
     return ret;
@@ -820,6 +1156,8 @@ static const char *msg_to_str(av_render_msg_type_t msg)
             return "Resume";
         case AV_RENDER_MSG_FLUSH:
             return "Flush";
+        case AV_RENDER_MSG_DRAIN:
+            return "Drain";
         default:
             return "";
     }
@@ -841,7 +1179,7 @@ static void render_thread(void *arg)
     av_render_thread_res_t *res = (av_render_thread_res_t *)arg;
     while (1) {
         av_render_msg_t msg = { 0 };
-        msg_q_recv(res->msg_q, &msg, sizeof(av_render_msg_t), !res->paused);
+        msg_q_recv(res->msg_q, &msg, sizeof(av_render_msg_t), !res->paused || res->flushing);
         if (msg.type != AV_RENDER_MSG_NONE) {
             ESP_LOGI(TAG, "%s got msg:%s", res->name, msg_to_str(msg.type));
         }
@@ -861,11 +1199,16 @@ static void render_thread(void *arg)
             ESP_LOGI(TAG, "%s resumed", res->name);
             res->paused = false;
         }
-        if (res->paused) {
+        if (msg.type != AV_RENDER_MSG_NONE) {
+            // Handle all queued messages before blocking on data, wakeup data is sent once for each message
+            continue;
+        }
+        if (res->paused && res->flushing == false) {
             continue;
         }
         if (res->render_body) {
-            int ret = res->render_body(res, false);
+            // Drop data during flush even paused, so that decoder never blocks on full queue
+            int ret = res->render_body(res, res->flushing);
             if (ret != 0) {
                 ESP_LOGE(TAG, "Thread %s process fail %d", res->name, ret);
                 break;
@@ -933,6 +1276,7 @@ int audio_render_frame_reached(av_render_audio_frame_t *frame, void *ctx)
 {
     av_render_audio_res_t *a_render = (av_render_audio_res_t *)ctx;
     int ret = -1;
+    uint32_t start = render_stats_now();
     dump_data(AV_RENDER_DUMP_ARENDER_DATA, frame->data, frame->size);
     if (a_render->audio_packet_reached) {
         // Write to audio render queue or write to audio render directly
@@ -942,10 +1286,11 @@ int audio_render_frame_reached(av_render_audio_frame_t *frame, void *ctx)
             ret = _render_write_audio(&a_render->thread_res, frame);
         }
     }
+    a_render->cb_us += render_stats_now() - start;
     return ret;
 }
 
-static int av_render_audio_frame_reached(av_render_audio_frame_t *frame, void *ctx)
+static int _audio_frame_reached(av_render_audio_frame_t *frame, void *ctx)
 {
     av_render_t *render = (av_render_t *)ctx;
     av_render_audio_res_t *a_render = render->a_render_res;
@@ -971,24 +1316,33 @@ static int av_render_audio_frame_reached(av_render_audio_frame_t *frame, void *c
         audio_render_close(render->cfg.audio_render);
         ESP_LOGI(TAG, "Get need resample %d in:%d out:%d", a_render->need_resample,
                  (int)a_render->audio_frame_info.sample_rate, (int)a_render->out_frame_info.sample_rate);
+        a_render->resample_active = false;
         if (a_render->need_resample && audio_need_resample(a_render)) {
             ret = audio_render_open(render->cfg.audio_render, &a_render->out_frame_info);
-            audio_resample_cfg_t resample_cfg = {
-                .input_info = a_render->audio_frame_info,
-                .output_info = a_render->out_frame_info,
-                .resample_cb = audio_render_frame_reached,
-                .ctx = a_render,
-            };
-            a_render->resample_handle = audio_resample_open(&resample_cfg);
-            if (a_render->resample_handle == NULL) {
-                ESP_LOGE(TAG, "Fail to create audio resample");
-                ret = -1;
-            }
-        } else {
+            // Keep resample across format change, reuse cached chain if format used before
             if (a_render->resample_handle) {
-                audio_resample_close(a_render->resample_handle);
-                a_render->resample_handle = NULL;
+                if (audio_resample_set_info(a_render->resample_handle, &a_render->audio_frame_info,
+                                            &a_render->out_frame_info) != 0) {
+                    ESP_LOGE(TAG, "Fail to change audio resample format");
+                    ret = -1;
+                }
+            } else {
+                audio_resample_cfg_t resample_cfg = {
+                    .input_info = a_render->audio_frame_info,
+                    .output_info = a_render->out_frame_info,
+                    .resample_cb = audio_render_frame_reached,
+                    .ctx = a_render,
+                    .block_samples = AUDIO_RESAMPLE_BLOCK_SAMPLES,
+                    .cache_num = AUDIO_RESAMPLE_CACHE_NUM,
+                };
+                a_render->resample_handle = audio_resample_open(&resample_cfg);
+                if (a_render->resample_handle == NULL) {
+                    ESP_LOGE(TAG, "Fail to create audio resample");
+                    ret = -1;
+                }
             }
+            a_render->resample_active = (ret == 0);
+        } else {
             ret = audio_render_open(render->cfg.audio_render, &a_render->audio_frame_info);
         }
         if (ret != 0) {
@@ -1008,15 +1362,30 @@ static int av_render_audio_frame_reached(av_render_audio_frame_t *frame, void *c
             }
         }
     }
-    if (a_render->resample_handle) {
+    if (a_render->resample_active) {
         // write to resample
+        uint32_t start = render_stats_now();
+        a_render->cb_us = 0;
         ret = audio_resample_write(a_render->resample_handle, frame);
+        render_stats_add(render->audio_stats, AV_RENDER_STAGE_CONVERT, render_stats_now() - start - a_render->cb_us);
     } else {
         ret = audio_render_frame_reached(frame, a_render);
     }
     return ret;
 }
 
+static int av_render_audio_frame_reached(av_render_audio_frame_t *frame, void *ctx)
+{
+    av_render_t *render = (av_render_t *)ctx;
+    uint32_t start = render_stats_now();
+    int ret = _audio_frame_reached(frame, ctx);
+    // Exclude time after decoded from decode stage
+    if (render->adec_res) {
+        render->adec_res->cb_us += render_stats_now() - start;
+    }
+    return ret;
+}
+
 static void convert_to_audio_frame(av_render_audio_info_t *audio_info, av_render_audio_frame_info_t *frame_info)
 {
     frame_info->bits_per_sample = audio_info->bits_per_sample;
@@ -1024,6 +1393,37 @@ static void convert_to_audio_frame(av_render_audio_info_t *audio_info, av_render
     frame_info->sample_rate = audio_info->sample_rate;
 }
 
+static uint8_t *fetch_render_fb(av_render_t *render, int align, int size)
+{
+    av_render_vdec_res_t *vdec_res = render->vdec_res;
+    av_render_video_res_t *v_render = render->v_render_res;
+    // Decoded data is source of color convert in render, keep it out of render frame buffer
+    // Render is reopened when resolution changes, only lend buffer of same frame size
+    if (vdec_res->vid_convert == NULL && vdec_res->dec_out_fmt == vdec_res->out_fmt && v_render->video_packet_reached &&
+        size == convert_table_get_image_size(vdec_res->out_fmt, v_render->video_frame_info.width,
+                                             v_render->video_frame_info.height)) {
+        av_render_frame_buffer_t frame_buffer = { 0 };
+        if (video_render_get_frame_buffer(render->cfg.video_render, &frame_buffer) == 0 && frame_buffer.data &&
+            frame_buffer.size >= size && ((uintptr_t)frame_buffer.data & (align - 1)) == 0) {
+            if (vdec_res->dec_out) {
+                media_lib_free_align(vdec_res->dec_out);
+                vdec_res->dec_out = NULL;
+            }
+            return frame_buffer.data;
+        }
+    }
+    // Render can not lend buffer, decode into own one and let render copy it
+    if (vdec_res->dec_out && vdec_res->dec_out_size < size) {
+        media_lib_free_align(vdec_res->dec_out);
+        vdec_res->dec_out = NULL;
+    }
+    if (vdec_res->dec_out == NULL) {
+        vdec_res->dec_out = (uint8_t *)media_lib_malloc_align(size, align);
+        vdec_res->dec_out_size = size;
+    }
+    return vdec_res->dec_out;
+}
+
 static uint8_t *av_render_fetch_vid_fb(int align, int size, void *ctx)
 {
     av_render_t *render = (av_render_t *)ctx;
@@ -1031,6 +1431,13 @@ static uint8_t *av_render_fetch_vid_fb(int align, int size, void *ctx)
     if (v_render == NULL || size == 0) {
         return NULL;
     }
+    if (align < 1) {
+        align = 1;
+    }
+    if (v_render->use_fb == false || v_render->thread_res.thread == NULL) {
+        return fetch_render_fb(render, align, size);
+    }
+    // Decode into render fifo directly
     av_render_vdec_res_t *vdec_res = render->vdec_res;
     size = sizeof(av_render_video_frame_t) + size + align;
     uint8_t *b = (uint8_t *)data_queue_get_buffer(v_render->thread_res.data_q, size);
@@ -1040,7 +1447,7 @@ static uint8_t *av_render_fetch_vid_fb(int align, int size, void *ctx)
     vdec_res->fb_frame = (av_render_video_frame_t *)b;
     b += sizeof(av_render_video_frame_t);
     align -= 1;
-    vdec_res->fb_frame->data = (uint8_t *)(((uint32_t)b + align) & (~align));
+    vdec_res->fb_frame->data = (uint8_t *)(((uintptr_t)b + align) & ~(uintptr_t)align);
     vdec_res->fb_frame->size = 0;
     return vdec_res->fb_frame->data;
 }
@@ -1049,21 +1456,62 @@ static int av_render_release_vid_fb(uint8_t *addr, bool drop, void *ctx)
 {
     av_render_t *render = (av_render_t *)ctx;
     av_render_video_res_t *v_render = render->v_render_res;
-    if (v_render == NULL) {
+    // Render frame buffer or own buffer is consumed when frame written to render
+    if (v_render == NULL || v_render->use_fb == false || v_render->thread_res.thread == NULL) {
         return 0;
     }
     av_render_vdec_res_t *vdec_res = render->vdec_res;
     if (vdec_res->fb_frame == NULL || addr != vdec_res->fb_frame->data) {
         ESP_LOGE(TAG, "Release wrong data");
+        if (vdec_res->fb_frame) {
+            // Give back fetched queue buffer without sending it
+            data_queue_send_buffer(v_render->thread_res.data_q, 0);
+            vdec_res->fb_frame = NULL;
+        }
+        return ESP_MEDIA_ERR_INVALID_ARG;
     }
     uint32_t size = 0;
     if (drop == false) {
         size = vdec_res->fb_frame->size + (uint32_t)(addr - (uint8_t *)vdec_res->fb_frame);
     }
+    // Frame belongs to render thread once sent
+    vdec_res->fb_frame = NULL;
     return data_queue_send_buffer(v_render->thread_res.data_q, size);
 }
 
-static int av_render_video_frame_reached(av_render_video_frame_t *frame, void *ctx)
+static bool video_resolution_changed(av_render_t *render)
+{
+    av_render_vdec_res_t *vdec_res = render->vdec_res;
+    av_render_video_frame_info_t frame_info = { 0 };
+    if (render->v_render_res->video_is_raw || vdec_res == NULL || vdec_res->vdec == NULL ||
+        vdec_get_frame_info(vdec_res->vdec, &frame_info) != 0) {
+        return false;
+    }
+    return frame_info.width != vdec_res->dec_width || frame_info.height != vdec_res->dec_height;
+}
+
+static int video_wait_render_idle(av_render_video_res_t *v_render)
+{
+    // Frame stays in queue until rendered, empty queue means render thread is idle
+    data_queue_t *q = v_render->thread_res.data_q;
+    uint32_t start = get_cur_time();
+    uint32_t elapsed = 0;
+    while (v_render->thread_res.paused == false && elapsed < VIDEO_RESIZE_WAIT_MS) {
+        int q_num = 0, q_size = 0;
+        data_queue_query(q, &q_num, &q_size);
+        if (q_num == 0) {
+            return 0;
+        }
+        // Woken up on each consume, recheck pause in case render thread stops consuming
+        if (data_queue_wait_drain(q, 0, VIDEO_RESIZE_WAIT_MS - elapsed) < 0) {
+            break;
+        }
+        elapsed = get_cur_time() - start;
+    }
+    return ESP_MEDIA_ERR_TIMEOUT;
+}
+
+static int _video_frame_reached(av_render_video_frame_t *frame, void *ctx)
 {
     av_render_t *render = (av_render_t *)ctx;
     av_render_video_res_t *v_render = render->v_render_res;
@@ -1073,6 +1521,23 @@ static int av_render_video_frame_reached(av_render_video_frame_t *frame, void *c
     av_render_vdec_res_t *vdec_res = render->vdec_res;
     int ret = 0;
     dump_data(AV_RENDER_DUMP_VRENDER_DATA, frame->data, frame->size);
+    if (v_render->video_packet_reached && video_resolution_changed(render)) {
+        // Render thread use convert table of old resolution, let it finish queued frames
+        if (v_render->thread_res.thread && video_wait_render_idle(v_render) != 0) {
+            ESP_LOGW(TAG, "Render busy, skip frame of new resolution");
+            if (v_render->use_fb && vdec_res->fb_frame) {
+                // Empty frame is consumed by render without drawing
+                vdec_res->fb_frame->size = 0;
+                vdec_res->fb_frame->eos = false;
+            }
+            return 0;
+        }
+        if (vdec_res->vid_convert) {
+            deinit_convert_table(vdec_res->vid_convert);
+            vdec_res->vid_convert = NULL;
+        }
+        v_render->video_packet_reached = false;
+    }
     // Open video render when first packet reached
     if (v_render->video_packet_reached == false) {
         if (v_render->video_is_raw == false) {
@@ -1086,36 +1551,49 @@ static int av_render_video_frame_reached(av_render_video_frame_t *frame, void *c
                 ESP_LOGE(TAG, "Fail to get video frame information");
                 return ret;
             }
+            vdec_res->dec_width = v_render->video_frame_info.width;
+            vdec_res->dec_height = v_render->video_frame_info.height;
             if (vdec_res->dec_out_fmt != vdec_res->out_fmt) {
                 color_convert_cfg_t convert_cfg = {
                     .from = vdec_res->dec_out_fmt,
                     .to = vdec_res->out_fmt,
                     .width = v_render->video_frame_info.width,
                     .height = v_render->video_frame_info.height,
+                    .full_range = vdec_res->full_range,
+                    .worker_num = render->cfg.video_cvt_worker_num,
+                    .transform = vdec_res->transform,
                 };
                 vdec_res->vid_convert = init_convert_table(&convert_cfg);
                 if (vdec_res->vid_convert == NULL) {
                     ESP_LOGE(TAG, "Fail to init video convert");
                     return ESP_MEDIA_ERR_NO_MEM;
                 }
+                // Render at transformed resolution
+                int width = 0, height = 0;
+                convert_table_get_output_size(&convert_cfg, &width, &height);
+                v_render->video_frame_info.width = width;
+                v_render->video_frame_info.height = height;
             }
             if (vdec_res && vdec_res->vid_convert) {
-                // Delay to malloc video convert output size
+                // Output is allocated when render has no frame buffer
                 int image_size = convert_table_get_image_size(vdec_res->out_fmt,
                         v_render->video_frame_info.width,
                         v_render->video_frame_info.height);
-                uint8_t* vid_cvt_out = media_lib_realloc(vdec_res->vid_convert_out, image_size);
-                if (vid_cvt_out == NULL) {
-                    ESP_LOGE(TAG, "Fail to allocate video convert output");
-                    return ESP_MEDIA_ERR_NO_MEM;
+                if (vdec_res->vid_convert_out && vdec_res->vid_convert_out_size != image_size) {
+                    media_lib_free(vdec_res->vid_convert_out);
+                    vdec_res->vid_convert_out = NULL;
                 }
-                vdec_res->vid_convert_out = vid_cvt_out;
                 vdec_res->vid_convert_out_size = image_size;
                 v_render->video_frame_info.type = vdec_res->out_fmt;
             }
             if (v_render->video_frame_info.fps == 0) {
                 v_render->video_frame_info.fps = old_fps;
             }
+            // Let render know measured frame rate when stream not tell
+            video_rate_info_t rate_info;
+            if (v_render->video_frame_info.fps == 0 && video_rate_get(v_render->rate, &rate_info)) {
+                v_render->video_frame_info.fps = (uint8_t)(rate_info.fps + 0.5f);
+            }
         }
         // Reopen video render using new frame information
         video_render_close(render->cfg.video_render);
@@ -1126,8 +1604,6 @@ static int av_render_video_frame_reached(av_render_video_frame_t *frame, void *c
         }
         v_render->video_packet_reached = true;
         v_render->v_render_in_sync = true;
-        // Tolerance for 3 frame later
-        v_render->sync_tolerance = 600;
         v_render->thread_res.render = render;
         if (v_render->use_fb == false && video_need_render_in_sync(render) == false && v_render->thread_res.thread == NULL) {
             ret = create_thread_res(&v_render->thread_res, "VRender", v_render_body, render->cfg.video_render_fifo_size,
@@ -1151,17 +1627,13 @@ static int av_render_video_frame_reached(av_render_video_frame_t *frame, void *c
                     vdec_res->fb_frame->data = frame_data;
                 }
             } else {
-                ret = put_to_v_render(v_render->thread_res.data_q, frame);
+                ret = put_to_v_render(v_render->thread_res.data_q, frame, v_render->thread_res.use_pool);
             }
         } else {
             av_render_vdec_res_t *vdec_res = render->vdec_res;
             if (vdec_res && vdec_res->vid_convert) {
                 // Do color convert firstly
-                ret = convert_color(vdec_res->vid_convert,
-                    frame->data, frame->size,
-                    vdec_res->vid_convert_out, vdec_res->vid_convert_out_size);
-                frame->data = vdec_res->vid_convert_out;
-                frame->size = vdec_res->vid_convert_out_size;
+                ret = convert_video_frame(render, frame);
             }
             ret = _render_write_video(&v_render->thread_res, frame);
         }
@@ -1169,6 +1641,17 @@ static int av_render_video_frame_reached(av_render_video_frame_t *frame, void *c
     return ret;
 }
 
+static int av_render_video_frame_reached(av_render_video_frame_t *frame, void *ctx)
+{
+    av_render_t *render = (av_render_t *)ctx;
+    uint32_t start = render_stats_now();
+    int ret = _video_frame_reached(frame, ctx);
+    if (render->vdec_res) {
+        render->vdec_res->cb_us += render_stats_now() - start;
+    }
+    return ret;
+}
+
 static void convert_to_video_frame(av_render_video_info_t *video_info, av_render_video_frame_info_t *frame_info)
 {
     memset(frame_info, 0, sizeof(av_render_video_frame_info_t));
@@ -1190,17 +1673,6 @@ static void convert_to_video_frame(av_render_video_info_t *video_info, av_render
     frame_info->fps = video_info->fps;
 }
 
-static void correct_video_fps(av_render_video_res_t *v_render, uint32_t pts)
-{
-    // Considering minimum fps is 10 for file
-    if (v_render->video_last_pts && pts > v_render->video_last_pts && pts <= v_render->video_last_pts + 100) {
-        v_render->video_frame_info.fps = 1000 / (pts - v_render->video_last_pts);
-        ESP_LOGI(TAG, "Correct video fps to %d", v_render->video_frame_info.fps);
-    } else {
-        v_render->video_last_pts = pts;
-    }
-}
-
 av_render_handle_t av_render_open(av_render_cfg_t *cfg)
 {
     if (cfg == NULL || (cfg->audio_render == NULL && cfg->video_render == NULL)) {
@@ -1213,11 +1685,29 @@ av_render_handle_t av_render_open(av_render_cfg_t *cfg)
     }
     // Copy configuration
     render->cfg = *cfg;
+    render->play_speed = 1.0f;
     do {
         int ret = media_lib_mutex_create(&render->api_lock);
         BREAK_ON_FAIL(ret);
         ret = media_lib_event_group_create(&render->event_group);
         BREAK_ON_FAIL(ret);
+        render->clock = media_clock_open(NULL);
+        if (render->clock == NULL) {
+            break;
+        }
+        // Under time sync audio keeps its own clock to measure its offset against system time
+        if (cfg->sync_mode == AV_RENDER_SYNC_FOLLOW_TIME && cfg->audio_render) {
+            render->audio_clock = media_clock_open(NULL);
+            if (render->audio_clock == NULL) {
+                break;
+            }
+        }
+        if (cfg->audio_render) {
+            render->audio_stats = (render_stats_t *)media_lib_calloc(1, sizeof(render_stats_t));
+        }
+        if (cfg->video_render) {
+            render->video_stats = (render_stats_t *)media_lib_calloc(1, sizeof(render_stats_t));
+        }
         return render;
     } while (0);
     av_render_close(render);
@@ -1257,6 +1747,11 @@ int av_render_add_audio_stream(av_render_handle_t h, av_render_audio_info_t *aud
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_AUDIO_STREAM,
+        .audio_info = *audio_info,
+    };
+    record_call(render, &item);
     int ret = 0;
     do {
         if (render->cfg.audio_render == NULL) {
@@ -1271,6 +1766,20 @@ int av_render_add_audio_stream(av_render_handle_t h, av_render_audio_info_t *aud
                 ret = ESP_MEDIA_ERR_NO_MEM;
                 break;
             }
+            // Adaptive buffer works on render fifo only
+            if (render->cfg.audio_jitter_max_ms && render->cfg.audio_render_fifo_size) {
+                audio_jitter_cfg_t jitter_cfg = {
+                    .min_ms = AUDIO_JITTER_MIN_MS,
+                    .max_ms = render->cfg.audio_jitter_max_ms,
+                };
+                render->a_render_res->jitter = audio_jitter_open(&jitter_cfg);
+                if (render->a_render_res->jitter == NULL) {
+                    ESP_LOGW(TAG, "Fail to create audio jitter buffer, use fixed threshold");
+                }
+                render->a_render_res->jitter_min_ms = AUDIO_JITTER_MIN_MS;
+                render->a_render_res->jitter_speed = 1.0f;
+            }
+            render->a_render_res->clock_speed = 1.0f;
         }
         if (render->aud_fix_info.sample_rate) {
             memcpy(&render->a_render_res->out_frame_info, &render->aud_fix_info, sizeof(av_render_audio_frame_info_t));
@@ -1293,6 +1802,10 @@ int av_render_add_audio_stream(av_render_handle_t h, av_render_audio_info_t *aud
         // Clear frame number
         a_render->audio_packet_reached = false;
         a_render->audio_rendered = false;
+        audio_jitter_reset(a_render->jitter);
+        // New stream may come from other sender
+        media_clock_reset(render->clock);
+        media_clock_reset(render->audio_clock);
         // Create new decoder if needed
         a_render->audio_is_pcm = (audio_info->codec == AV_RENDER_AUDIO_CODEC_PCM);
 
@@ -1312,6 +1825,7 @@ int av_render_add_audio_stream(av_render_handle_t h, av_render_audio_info_t *aud
                 .audio_info = *audio_info,
                 .frame_cb = av_render_audio_frame_reached,
                 .ctx = render,
+                .conceal_max_ms = AUDIO_CONCEAL_MAX_MS,
             };
             adec_res->adec = adec_open(&cfg);
             if (adec_res->adec == NULL) {
@@ -1367,12 +1881,22 @@ int av_render_set_fixed_frame_info(av_render_handle_t h, av_render_audio_frame_i
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_FIXED_INFO,
+        .fixed_info = *frame_info,
+    };
+    record_call(render, &item);
     int ret = ESP_MEDIA_ERR_WRONG_STATE;
     render->aud_fix_info = *frame_info;
     media_lib_mutex_unlock(render->api_lock);
     return ret;
 }
 
+static bool video_transform_needed(av_render_video_transform_t *transform)
+{
+    return transform->width || transform->height || transform->rotate != AV_RENDER_VIDEO_ROTATE_NONE || transform->mirror;
+}
+
 static bool get_support_output_format(av_render_t *render, av_render_video_info_t *video_info, vdec_cfg_t *cfg)
 {
     av_render_video_frame_type_t out_type;
@@ -1381,7 +1905,7 @@ static bool get_support_output_format(av_render_t *render, av_render_video_info_
     uint8_t num = sizeof(out_fmts)/sizeof(out_fmts[0]);
     vdec_get_output_formats(video_info->codec, out_fmts, &num);
     // Try to match decoder supported formats
-    for (int i = 0; i < num; i++) {
+    for (int i = 0; i < num && video_transform_needed(&vdec_res->transform) == false; i++) {
         if (video_render_format_supported(render->cfg.video_render, out_fmts[i])) {
             ESP_LOGI(TAG, "Set video decoder prefer output format %d", out_fmts[i]);
             cfg->out_type = out_fmts[i];
@@ -1394,6 +1918,19 @@ static bool get_support_output_format(av_render_t *render, av_render_video_info_
         if (video_render_format_supported(render->cfg.video_render, out_type) == false) {
             continue;
         }
+        // Transform is done together with color convert, let decoder output YUV
+        if (video_transform_needed(&vdec_res->transform)) {
+            for (int i = 0; i < num; i++) {
+                if (convert_table_is_supported(out_fmts[i], out_type)) {
+                    cfg->out_type = out_fmts[i];
+                    vdec_res->out_fmt = out_type;
+                    vdec_res->dec_out_fmt = out_fmts[i];
+                    return true;
+                }
+            }
+            ESP_LOGW(TAG, "Decoder output can not be transformed, ignore transform");
+            memset(&vdec_res->transform, 0, sizeof(av_render_video_transform_t));
+        }
         ESP_LOGI(TAG, "Set video render output format %d", out_type);
         // Let decoder do color convert
         if (render->cfg.video_cvt_in_render == false) {
@@ -1419,6 +1956,11 @@ int av_render_add_video_stream(av_render_handle_t h, av_render_video_info_t *vid
     }
     int ret = 0;
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_VIDEO_STREAM,
+        .video_info = *video_info,
+    };
+    record_call(render, &item);
     do {
         if (render->cfg.video_render == NULL) {
             ESP_LOGE(TAG, "Video render not set, stream is skipped");
@@ -1432,8 +1974,15 @@ int av_render_add_video_stream(av_render_handle_t h, av_render_video_info_t *vid
                 ret = ESP_MEDIA_ERR_NO_MEM;
                 break;
             }
+            render->v_render_res->rate = video_rate_open();
+            if (render->v_render_res->rate == NULL) {
+                ESP_LOGW(TAG, "Fail to create video rate estimator, use stream fps");
+            }
         }
         av_render_video_res_t *v_render = render->v_render_res;
+        // Measure frame rate again for new stream
+        v_render->stream_fps = video_info->fps;
+        video_rate_reset(v_render->rate);
         // TODO here force to use fetch decode output data
         v_render->use_fb = true;
         // Close old decoder
@@ -1474,6 +2023,14 @@ int av_render_add_video_stream(av_render_handle_t h, av_render_video_info_t *vid
                 }
             }
             av_render_vdec_res_t *vdec_res = render->vdec_res;
+            // JPEG use full range YUV
+            vdec_res->full_range = (video_info->codec == AV_RENDER_VIDEO_CODEC_MJPEG);
+            // Stream transform take priority over render one
+            vdec_res->transform = video_info->transform;
+            if (video_transform_needed(&vdec_res->transform) == false) {
+                memset(&vdec_res->transform, 0, sizeof(av_render_video_transform_t));
+                video_render_get_transform(render->cfg.video_render, &vdec_res->transform);
+            }
             vdec_cfg_t cfg = {
                 .video_info = *video_info,
                 .frame_cb = av_render_video_frame_reached,
@@ -1488,9 +2045,17 @@ int av_render_add_video_stream(av_render_handle_t h, av_render_video_info_t *vid
                 ret = ESP_MEDIA_ERR_FAIL;
                 break;
             }
+            // Drop counters accumulate across streams
+            if (vdec_res->drop == NULL) {
+                vdec_res->drop = video_drop_open(video_info->codec == AV_RENDER_VIDEO_CODEC_H264);
+            } else {
+                video_drop_reset(vdec_res->drop, video_info->codec == AV_RENDER_VIDEO_CODEC_H264);
+            }
             vdec_res->thread_res.render = render;
             vdec_res->thread_res.use_pool = (render->pool_free != NULL);
             v_render->thread_res.render = render;
+            // Decoded frames are always copied or decoded into render fifo
+            v_render->thread_res.use_pool = false;
             // When use FB pre create render resource
             if (v_render->use_fb && video_need_render_in_sync(render) == false && v_render->thread_res.thread == NULL) {
                 ret = create_thread_res(&v_render->thread_res, "VRender", v_render_body, render->cfg.video_render_fifo_size,
@@ -1499,16 +2064,17 @@ int av_render_add_video_stream(av_render_handle_t h, av_render_video_info_t *vid
                     ESP_LOGE(TAG, "Fail to create video render thread resource");
                 } else {
                     v_render->v_render_in_sync = false;
-                    vdec_fb_cb_cfg_t vdec_cfg = {
-                        .fb_fetch = av_render_fetch_vid_fb,
-                        .fb_return = av_render_release_vid_fb,
-                        .ctx = render,
-                    };
-                    vdec_set_fb_cb(vdec_res->vdec, &vdec_cfg);
                 }
             } else {
                 v_render->use_fb = false;
             }
+            // Decode into render fifo, render frame buffer or own output buffer
+            vdec_fb_cb_cfg_t vdec_cfg = {
+                .fb_fetch = av_render_fetch_vid_fb,
+                .fb_return = av_render_release_vid_fb,
+                .ctx = render,
+            };
+            vdec_set_fb_cb(vdec_res->vdec, &vdec_cfg);
             // Create thread for audio decoder
             if (video_need_decode_in_sync(render, video_info) == false) {
                 ret = create_thread_res(&vdec_res->thread_res, "Vdec", vdec_body, render->cfg.video_raw_fifo_size,
@@ -1523,6 +2089,11 @@ int av_render_add_video_stream(av_render_handle_t h, av_render_video_info_t *vid
         } else {
             // Convert to frame info
             convert_to_video_frame(video_info, &v_render->video_frame_info);
+            if (render->pool_free && v_render->thread_res.thread == NULL) {
+                // Hand raw frames in data pool to render thread by reference
+                v_render->use_fb = false;
+                v_render->thread_res.use_pool = true;
+            }
         }
     } while (0);
     media_lib_mutex_unlock(render->api_lock);
@@ -1550,6 +2121,11 @@ int av_render_add_audio_data(av_render_handle_t h, av_render_audio_data_t *audio
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_AUDIO_DATA,
+        .audio_data = *audio_data,
+    };
+    record_call(render, &item);
     int ret = 0;
     do {
         av_render_audio_res_t *a_render = render->a_render_res;
@@ -1557,6 +2133,16 @@ int av_render_add_audio_data(av_render_handle_t h, av_render_audio_data_t *audio
             ret = ESP_MEDIA_ERR_WRONG_STATE;
             break;
         }
+        if (a_render->jitter && audio_data->size) {
+            audio_jitter_arrive(a_render->jitter, get_cur_time(), audio_data->pts);
+        }
+        if (render->audio_stats && audio_data->size) {
+            render_stats_inc(&render->audio_stats->in_num);
+            render_stats_arrive(render->audio_stats, audio_data->pts, render_stats_now());
+        }
+        if (audio_data->size) {
+            a_render->audio_recv_pts = audio_data->pts;
+        }
         // If no need decode, notify raw data reached directly
         if (a_render->audio_is_pcm) {
             av_render_audio_frame_t audio_frame = {
@@ -1578,6 +2164,7 @@ int av_render_add_audio_data(av_render_handle_t h, av_render_audio_data_t *audio
             media_lib_mutex_unlock(render->api_lock);
             ret = put_to_adec(adec->thread_res.data_q, audio_data, adec->thread_res.use_pool);
             if (ret != 0) {
+                render_stats_drop(render->audio_stats, AV_RENDER_DROP_FIFO_FULL);
                 if (render->pool_free && audio_data->data) {
                     render->pool_free(audio_data->data, render->pool);
                 }
@@ -1601,6 +2188,11 @@ int av_render_set_audio_threshold(av_render_handle_t h, uint32_t audio_threshold
         return -1;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_AUDIO_THRESHOLD,
+        .audio_threshold = audio_threshold,
+    };
+    record_call(render, &item);
     if (render->cfg.audio_render_fifo_size == 0) {
         ESP_LOGW(TAG, "Not support set audio threshold without render fifo");
     } else {
@@ -1623,6 +2215,11 @@ int av_render_add_video_data(av_render_handle_t h, av_render_video_data_t *video
         return -1;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_VIDEO_DATA,
+        .video_data = *video_data,
+    };
+    record_call(render, &item);
     av_render_video_res_t *v_render = render->v_render_res;
     int ret = 0;
     do {
@@ -1630,8 +2227,13 @@ int av_render_add_video_data(av_render_handle_t h, av_render_video_data_t *video
             ret = ESP_MEDIA_ERR_WRONG_STATE;
             break;
         }
-        if (v_render->video_frame_info.fps == 0) {
-            correct_video_fps(v_render, video_data->pts);
+        if (video_data->size) {
+            v_render->video_recv_pts = video_data->pts;
+            video_rate_add(v_render->rate, video_data->pts);
+        }
+        if (render->video_stats && video_data->size) {
+            render_stats_inc(&render->video_stats->in_num);
+            render_stats_arrive(render->video_stats, video_data->pts, render_stats_now());
         }
         // If no need decode, notify raw data reached directly
         if (v_render->video_is_raw) {
@@ -1642,6 +2244,11 @@ int av_render_add_video_data(av_render_handle_t h, av_render_video_data_t *video
                 .eos = video_data->eos,
             };
             ret = av_render_video_frame_reached(&video_frame, render);
+            if (ret == 0 && v_render->thread_res.thread && v_render->thread_res.use_pool) {
+                // Pool data owned by render thread now
+                media_lib_mutex_unlock(render->api_lock);
+                return ret;
+            }
             break;
         }
         if (render->vdec_res->vdec == NULL) {
@@ -1654,6 +2261,7 @@ int av_render_add_video_data(av_render_handle_t h, av_render_video_data_t *video
             media_lib_mutex_unlock(render->api_lock);
             ret = put_to_vdec(vdec->thread_res.data_q, video_data, vdec->thread_res.use_pool);
             if (ret != 0) {
+                render_stats_drop(render->video_stats, AV_RENDER_DROP_FIFO_FULL);
                 if (render->pool_free && video_data->data) {
                     render->pool_free(video_data->data, render->pool);
                 }
@@ -1727,6 +2335,9 @@ bool av_render_video_fifo_enough(av_render_handle_t h, av_render_video_data_t *v
             break;
         }
         if (v_render->thread_res.data_q) {
+            if (v_render->thread_res.use_pool) {
+                need_size -= video_data->size;
+            }
             int avail = data_queue_get_available(v_render->thread_res.data_q);
             enough = (need_size <= avail);
             break;
@@ -1815,6 +2426,9 @@ int render_pause(av_render_t *render, bool pause)
             send_msg_to_thread(&render->vdec_res->thread_res, sizeof(av_render_video_data_t), &msg);
         }
     }
+    uint32_t cur = get_cur_time();
+    media_clock_pause(render->clock, cur, pause);
+    media_clock_pause(render->audio_clock, cur, pause);
     printf("Pause set to %d\n", pause);
     return 0;
 }
@@ -1825,12 +2439,15 @@ static int render_flush(av_render_t *render)
         .type = AV_RENDER_MSG_FLUSH,
     };
     int wait_bits;
-    // Consume render data so that decode can output even render is paused
+    // Let render thread drop data so that decode can output even render is paused
     if (render->adec_res && render->adec_res->thread_res.thread) {
         render->adec_res->thread_res.flushing = true;
-        if (render->a_render_res && render->a_render_res->thread_res.data_q) {
+        if (render->a_render_res && render->a_render_res->thread_res.thread) {
+            av_render_msg_t drain = {
+                .type = AV_RENDER_MSG_DRAIN,
+            };
             render->a_render_res->thread_res.flushing = true;
-            render_consume_all(&render->a_render_res->thread_res);
+            send_msg_to_thread(&render->a_render_res->thread_res, sizeof(av_render_audio_frame_t), &drain);
         }
         send_msg_to_thread(&render->adec_res->thread_res, sizeof(av_render_audio_data_t), &msg);
         wait_bits = render->adec_res->thread_res.wait_bits << FLUSH_SHIFT_BITS;
@@ -1839,9 +2456,12 @@ static int render_flush(av_render_t *render)
     }
     if (render->vdec_res && render->vdec_res->thread_res.thread) {
         render->vdec_res->thread_res.flushing = true;
-        if (render->v_render_res && render->v_render_res->thread_res.data_q) {
+        if (render->v_render_res && render->v_render_res->thread_res.thread) {
+            av_render_msg_t drain = {
+                .type = AV_RENDER_MSG_DRAIN,
+            };
             render->v_render_res->thread_res.flushing = true;
-            render_consume_all(&render->v_render_res->thread_res);
+            send_msg_to_thread(&render->v_render_res->thread_res, sizeof(av_render_video_frame_t), &drain);
         }
         send_msg_to_thread(&render->vdec_res->thread_res, sizeof(av_render_video_data_t), &msg);
         wait_bits = render->vdec_res->thread_res.wait_bits << FLUSH_SHIFT_BITS;
@@ -1857,17 +2477,22 @@ static int render_flush(av_render_t *render)
     if (render->v_render_res && render->v_render_res->thread_res.thread) {
         render->v_render_res->thread_res.flushing = true;
         send_msg_to_thread(&render->v_render_res->thread_res, sizeof(av_render_video_frame_t), &msg);
-        wait_bits = render->v_render_res->thread_res.wait_bits << FLUSH_SHIFT_BITS;
+        wait_bits |= render->v_render_res->thread_res.wait_bits << FLUSH_SHIFT_BITS;
     }
     _WAIT_BITS(render->event_group, wait_bits);
     // Resend first frame pts
     if (render->v_render_res) {
         render->v_render_res->video_rendered = false;
         render->v_render_res->sent_frame_num = 0;
+        video_rate_reset(render->v_render_res->rate);
     }
     if (render->a_render_res) {
         render->a_render_res->audio_rendered = false;
+        audio_jitter_reset(render->a_render_res->jitter);
     }
+    // Restart from new position, keep learned drift
+    media_clock_stop(render->clock);
+    media_clock_stop(render->audio_clock);
     return 0;
 }
 
@@ -1881,7 +2506,173 @@ int av_render_set_speed(av_render_handle_t h, float speed)
         return 0;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
-    int ret = audio_render_set_speed(render->cfg.audio_render, speed);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_SPEED,
+        .speed = speed,
+    };
+    record_call(render, &item);
+    render->play_speed = speed;
+    // Keep time stretch of adaptive audio buffer and drift correction on top of playback speed
+    int ret = audio_apply_speed(render);
+    media_lib_mutex_unlock(render->api_lock);
+    return ret;
+}
+
+int av_render_get_audio_jitter_stats(av_render_handle_t h, av_render_audio_jitter_stats_t *stats)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || stats == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int ret = ESP_MEDIA_ERR_OK;
+    if (render->a_render_res && render->a_render_res->jitter) {
+        audio_jitter_stats_t jitter_stats;
+        audio_jitter_get_stats(render->a_render_res->jitter, &jitter_stats);
+        stats->target_ms = jitter_stats.target_ms;
+        stats->depth_ms = jitter_stats.depth_ms;
+        stats->jitter_ms = jitter_stats.jitter_ms;
+        stats->speed = jitter_stats.speed;
+        stats->underrun_num = jitter_stats.underrun_num;
+        stats->drop_num = jitter_stats.drop_num;
+    } else {
+        ret = ESP_MEDIA_ERR_NOT_SUPPORT;
+    }
+    media_lib_mutex_unlock(render->api_lock);
+    return ret;
+}
+
+int av_render_get_video_drop_stats(av_render_handle_t h, av_render_video_drop_stats_t *stats)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || stats == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int ret = ESP_MEDIA_ERR_OK;
+    if (render->v_render_res) {
+        memset(stats, 0, sizeof(av_render_video_drop_stats_t));
+        if (render->vdec_res && render->vdec_res->drop) {
+            video_drop_stats_t drop_stats = { 0 };
+            video_drop_get_stats(render->vdec_res->drop, &drop_stats);
+            stats->late_num = drop_stats.late_num;
+            stats->non_ref_num = drop_stats.non_ref_num;
+            stats->wait_idr_num = drop_stats.wait_idr_num;
+            stats->key_request_num = drop_stats.key_request_num;
+        }
+    } else {
+        ret = ESP_MEDIA_ERR_WRONG_STATE;
+    }
+    media_lib_mutex_unlock(render->api_lock);
+    return ret;
+}
+
+int av_render_get_video_rate(av_render_handle_t h, av_render_video_rate_t *rate)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || rate == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int ret = ESP_MEDIA_ERR_OK;
+    memset(rate, 0, sizeof(av_render_video_rate_t));
+    if (render->v_render_res) {
+        video_rate_info_t info;
+        if (video_rate_get(render->v_render_res->rate, &info)) {
+            rate->fps = info.fps;
+            rate->frame_us = info.frame_us;
+            rate->jitter_us = info.jitter_us;
+            rate->confidence = info.confidence;
+        }
+    } else {
+        ret = ESP_MEDIA_ERR_WRONG_STATE;
+    }
+    media_lib_mutex_unlock(render->api_lock);
+    return ret;
+}
+
+static render_stats_t *get_stream_stats(av_render_t *render, av_render_stream_type_t type)
+{
+    if (type == AV_RENDER_STREAM_TYPE_AUDIO) {
+        return render->audio_stats;
+    }
+    return type == AV_RENDER_STREAM_TYPE_VIDEO ? render->video_stats : NULL;
+}
+
+int av_render_get_stream_stats(av_render_handle_t h, av_render_stream_type_t type, av_render_stream_stats_t *stats)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || stats == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    // No lock so that pipeline is never blocked by query
+    render_stats_t *s = get_stream_stats(render, type);
+    if (s == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    render_stats_get(s, stats);
+    return ESP_MEDIA_ERR_OK;
+}
+
+int av_render_reset_stream_stats(av_render_handle_t h, av_render_stream_type_t type)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    render_stats_t *s = get_stream_stats(render, type);
+    if (s == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    render_stats_reset(s);
+    return ESP_MEDIA_ERR_OK;
+}
+
+int av_render_get_sync_stats(av_render_handle_t h, av_render_sync_stats_t *stats)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || stats == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    if (media_clock_started(render->clock) == false) {
+        return ESP_MEDIA_ERR_WRONG_STATE;
+    }
+    media_clock_stats_t clock_stats = { 0 };
+    // Drift is learned by clock driven by audio
+    media_clock_get_stats(render->audio_clock ? render->audio_clock : render->clock, &clock_stats);
+    stats->drift_ppm = clock_stats.drift_ppm;
+    stats->resync_num = clock_stats.resync_num;
+    stats->clock_pts = media_clock_get(render->clock, get_cur_time());
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    stats->av_offset_ms = render->v_render_res ? render->v_render_res->av_offset : 0;
+    media_lib_mutex_unlock(render->api_lock);
+    return ESP_MEDIA_ERR_OK;
+}
+
+int av_render_get_latency(av_render_handle_t h, av_render_latency_t *latency)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || latency == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    memset(latency, 0, sizeof(av_render_latency_t));
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_audio_res_t *a_render = render->a_render_res;
+    av_render_video_res_t *v_render = render->v_render_res;
+    int ret = ESP_MEDIA_ERR_WRONG_STATE;
+    uint32_t pts = 0;
+    if (a_render && a_render->audio_packet_reached && av_render_get_audio_pts(render, &pts) == 0) {
+        audio_render_get_latency(render->cfg.audio_render, &latency->audio_render_ms);
+        int32_t total = (int32_t)(a_render->audio_recv_pts - pts);
+        latency->audio_total_ms = total > 0 ? total : 0;
+        ret = ESP_MEDIA_ERR_OK;
+    }
+    if (v_render && v_render->video_packet_reached && av_render_get_video_pts(render, &pts) == 0) {
+        video_render_get_latency(render->cfg.video_render, &latency->video_render_ms);
+        int32_t total = (int32_t)(v_render->video_recv_pts - pts);
+        latency->video_total_ms = total > 0 ? total : 0;
+        ret = ESP_MEDIA_ERR_OK;
+    }
     media_lib_mutex_unlock(render->api_lock);
     return ret;
 }
@@ -1893,6 +2684,11 @@ int av_render_pause(av_render_handle_t h, bool pause)
         return -1;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_PAUSE,
+        .pause = pause,
+    };
+    record_call(render, &item);
     int ret = render_pause(render, pause);
     media_lib_mutex_unlock(render->api_lock);
     return ret;
@@ -1905,6 +2701,10 @@ int av_render_flush(av_render_handle_t h)
         return -1;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_FLUSH,
+    };
+    record_call(render, &item);
     int ret = render_flush(render);
     media_lib_mutex_unlock(render->api_lock);
     return ret;
@@ -1957,12 +2757,7 @@ static int av_render_get_video_pts(av_render_t *render, uint32_t *out_pts)
             int q_num = 0, q_size = 0;
             data_queue_query(v_render->thread_res.data_q, &q_num, &q_size);
             if (q_num) {
-                int fps = v_render->video_frame_info.fps;
-                if (fps == 0) {
-                    fps = 20;
-                }
-                int q_pts = q_num * 1000 / fps;
-                video_pts -= q_pts;
+                video_pts -= q_num * video_frame_ms(v_render);
             }
         }
         *out_pts = video_pts;
@@ -2025,8 +2820,53 @@ int av_render_query(av_render_handle_t h)
     return 0;
 }
 
+int av_render_start_record(av_render_handle_t h, const char *path)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL || path == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (render->record) {
+        av_render_record_close(render->record);
+        render->record = NULL;
+    }
+    int ret = av_render_record_create(path, &render->record);
+    if (ret == ESP_MEDIA_ERR_OK) {
+        ESP_LOGI(TAG, "Start record to %s", path);
+        render->record_start = esp_timer_get_time();
+        // Replay need configuration to open render in same way
+        av_render_record_item_t item = {
+            .type = AV_RENDER_RECORD_TYPE_CONFIG,
+            .cfg = render->cfg,
+        };
+        record_call(render, &item);
+    }
+    media_lib_mutex_unlock(render->api_lock);
+    return ret;
+}
+
+int av_render_stop_record(av_render_handle_t h)
+{
+    av_render_t *render = (av_render_t *)h;
+    if (render == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (render->record) {
+        av_render_record_close(render->record);
+        render->record = NULL;
+        ESP_LOGI(TAG, "Record stopped");
+    }
+    media_lib_mutex_unlock(render->api_lock);
+    return ESP_MEDIA_ERR_OK;
+}
+
 void av_render_dump(av_render_handle_t h, uint8_t mask)
 {
+    if (mask & ((1 << AV_RENDER_DUMP_ADEC_DATA) | (1 << AV_RENDER_DUMP_VDEC_DATA))) {
+        ESP_LOGW(TAG, "Decoder input is not dumped, use av_render_start_record instead");
+    }
     render_dump_mask = mask;
     ESP_LOGI(TAG, "Dump mask set to %x", mask);
     if (mask == 0) {
@@ -2072,6 +2912,10 @@ int av_render_reset(av_render_handle_t h)
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
     media_lib_mutex_lock(render->api_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    av_render_record_item_t item = {
+        .type = AV_RENDER_RECORD_TYPE_RESET,
+    };
+    record_call(render, &item);
     // wait thread quit
     av_render_msg_t msg = {
         .type = AV_RENDER_MSG_CLOSE,
@@ -2137,6 +2981,14 @@ int av_render_reset(av_render_handle_t h)
             media_lib_free(vdec_res->vid_convert_out);
             vdec_res->vid_convert_out = NULL;
         }
+        if (vdec_res->dec_out) {
+            media_lib_free_align(vdec_res->dec_out);
+            vdec_res->dec_out = NULL;
+        }
+        if (vdec_res->drop) {
+            video_drop_close(vdec_res->drop);
+            vdec_res->drop = NULL;
+        }
         destroy_thread_res(&render->vdec_res->thread_res);
         media_lib_free(render->vdec_res);
         render->vdec_res = NULL;
@@ -2148,11 +3000,18 @@ int av_render_reset(av_render_handle_t h)
             audio_resample_close(render->a_render_res->resample_handle);
             render->a_render_res->resample_handle = NULL;
         }
+        if (render->a_render_res->jitter) {
+            audio_jitter_close(render->a_render_res->jitter);
+            render->a_render_res->jitter = NULL;
+        }
         media_lib_free(render->a_render_res);
         render->a_render_res = NULL;
     }
     if (render->v_render_res) {
         destroy_thread_res(&render->v_render_res->thread_res);
+        if (render->v_render_res->rate) {
+            video_rate_close(render->v_render_res->rate);
+        }
         media_lib_free(render->v_render_res);
         render->v_render_res = NULL;
     }
@@ -2173,13 +3032,22 @@ int av_render_close(av_render_handle_t h)
     if (render == NULL) {
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
+    av_render_stop_record(h);
     av_render_reset(h);
+    media_clock_close(render->clock);
+    media_clock_close(render->audio_clock);
     if (render->event_group) {
         media_lib_event_group_destroy(render->event_group);
     }
     if (render->api_lock) {
         media_lib_mutex_destroy(render->api_lock);
     }
+    if (render->audio_stats) {
+        media_lib_free(render->audio_stats);
+    }
+    if (render->video_stats) {
+        media_lib_free(render->video_stats);
+    }
     media_lib_free(render);
     return ESP_MEDIA_ERR_OK;
 }
@@ -0,0 +1,640 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include "av_render_mixer.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#define TAG "RENDER_MIXER"
+
+#define MIXER_MAX_SOURCE        (8)
+#define MIXER_DEFAULT_BLOCK_MS  (10)
+#define MIXER_DEFAULT_BUF_MS    (100)
+#define MIXER_DEFAULT_FADE_MS   (50)
+#define MIXER_GAIN_SHIFT        (14)
+#define MIXER_UNITY_GAIN        (1 << MIXER_GAIN_SHIFT)
+#define MIXER_MAX_GAIN          (4 << MIXER_GAIN_SHIFT)
+#define MIXER_RAMP_SHIFT        (10) /* Extra precision of gain ramp */
+#define MIXER_STARVE_BLOCKS     (2)  /* Mix without late source once output holds less than it */
+#define MIXER_IDLE_WAIT_MS      (100)
+#define MIXER_SPACE_WAIT_MS     (100)
+
+typedef struct {
+    struct av_render_mixer_t    *mixer;
+    audio_render_handle_t        handle;
+    av_render_mixer_source_cfg_t cfg;
+    int32_t                      gain;
+    int32_t                      duck_gain;
+    int32_t                      cur_gain;
+    bool                         is_open;
+    uint8_t                     *buf;
+    uint32_t                     buf_size;
+    uint32_t                     rd_pos;
+    uint32_t                     fill;
+    media_lib_sema_handle_t      space_sema;
+} mixer_source_t;
+
+typedef struct {
+    struct av_render_mixer_t     *mixer;
+    av_render_mixer_source_cfg_t *cfg;
+    mixer_source_t              **source;
+} mixer_source_init_t;
+
+struct av_render_mixer_t {
+    av_render_mixer_cfg_t    cfg;
+    uint32_t                 block_bytes;
+    uint32_t                 bytes_per_ms;
+    int32_t                  fade_step;
+    mixer_source_t          *sources[MIXER_MAX_SOURCE];
+    int                      source_num;
+    int32_t                 *acc;
+    int16_t                 *out_buf;
+    bool                     mixing;
+    bool                     out_speed_set;
+    int64_t                  wait_start;
+    bool                     stopping;
+    media_lib_mutex_handle_t lock;
+    media_lib_mutex_handle_t out_lock;
+    media_lib_sema_handle_t  data_sema;
+    media_lib_sema_handle_t  exit_sema;
+};
+
+static int32_t to_gain(float gain)
+{
+    if (gain <= 0) {
+        return 0;
+    }
+    int32_t g = (int32_t)(gain * MIXER_UNITY_GAIN + 0.5f);
+    return g > MIXER_MAX_GAIN ? MIXER_MAX_GAIN : g;
+}
+
+// Add samples scaled by gain into accumulator, gain ramps linearly from `from` to `to` over `total` samples
+static void mix_add(int32_t *acc, const int16_t *in, int n, int32_t from, int32_t to, int start, int total)
+{
+    if (from == to) {
+        if (from == MIXER_UNITY_GAIN) {
+            for (int i = 0; i < n; i++) {
+                acc[i] += in[i];
+            }
+        } else {
+            for (int i = 0; i < n; i++) {
+                acc[i] += (in[i] * from) >> MIXER_GAIN_SHIFT;
+            }
+        }
+        return;
+    }
+    int32_t step = (to - from) * (1 << MIXER_RAMP_SHIFT) / total;
+    int32_t g = (from << MIXER_RAMP_SHIFT) + step * start;
+    for (int i = 0; i < n; i++) {
+        acc[i] += (in[i] * (g >> MIXER_RAMP_SHIFT)) >> MIXER_GAIN_SHIFT;
+        g += step;
+    }
+}
+
+static void mix_saturate(int16_t *out, const int32_t *acc, int n)
+{
+    for (int i = 0; i < n; i++) {
+        int32_t v = acc[i];
+        out[i] = v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t)v);
+    }
+}
+
+static int32_t source_target_gain(struct av_render_mixer_t *m, mixer_source_t *s)
+{
+    for (int i = 0; i < m->source_num; i++) {
+        mixer_source_t *o = m->sources[i];
+        if (o->is_open && o->cfg.priority > s->cfg.priority) {
+            return (s->gain * s->duck_gain) >> MIXER_GAIN_SHIFT;
+        }
+    }
+    return s->gain;
+}
+
+static int32_t fade_gain(struct av_render_mixer_t *m, int32_t cur, int32_t target)
+{
+    if (target > cur + m->fade_step) {
+        return cur + m->fade_step;
+    }
+    if (target < cur - m->fade_step) {
+        return cur - m->fade_step;
+    }
+    return target;
+}
+
+static int open_source_num(struct av_render_mixer_t *m)
+{
+    int n = 0;
+    for (int i = 0; i < m->source_num; i++) {
+        if (m->sources[i]->is_open) {
+            n++;
+        }
+    }
+    return n;
+}
+
+// Only audio and needs no gain, data goes to output without mixing
+static bool owns_output(struct av_render_mixer_t *m, mixer_source_t *s)
+{
+    if (s->is_open == false || open_source_num(m) != 1) {
+        return false;
+    }
+    return s->cur_gain == MIXER_UNITY_GAIN && source_target_gain(m, s) == MIXER_UNITY_GAIN;
+}
+
+static mixer_source_t *get_output_owner(struct av_render_mixer_t *m)
+{
+    for (int i = 0; i < m->source_num; i++) {
+        if (owns_output(m, m->sources[i])) {
+            return m->sources[i];
+        }
+    }
+    return NULL;
+}
+
+static void mix_block(struct av_render_mixer_t *m, bool take_partial)
+{
+    int total = m->block_bytes / sizeof(int16_t);
+    memset(m->acc, 0, m->block_bytes * 2);
+    for (int i = 0; i < m->source_num; i++) {
+        mixer_source_t *s = m->sources[i];
+        if (s->is_open == false) {
+            continue;
+        }
+        int32_t from = s->cur_gain;
+        s->cur_gain = fade_gain(m, from, source_target_gain(m, s));
+        if (s->fill < m->block_bytes && take_partial == false) {
+            continue;
+        }
+        uint32_t size = s->fill < m->block_bytes ? s->fill : m->block_bytes;
+        // Mix from ring directly, wrapped data in two parts
+        uint32_t first = s->buf_size - s->rd_pos;
+        if (first > size) {
+            first = size;
+        }
+        int n = first / sizeof(int16_t);
+        mix_add(m->acc, (int16_t *)(s->buf + s->rd_pos), n, from, s->cur_gain, 0, total);
+        if (size > first) {
+            mix_add(m->acc + n, (int16_t *)s->buf, (size - first) / sizeof(int16_t), from, s->cur_gain, n, total);
+        }
+        s->rd_pos = (s->rd_pos + size) % s->buf_size;
+        s->fill -= size;
+        media_lib_sema_unlock(s->space_sema);
+    }
+    mix_saturate(m->out_buf, m->acc, total);
+}
+
+static bool output_starving(struct av_render_mixer_t *m)
+{
+    uint32_t latency = 0;
+    if (audio_render_get_latency(m->cfg.out_render, &latency) != 0) {
+        return true;
+    }
+    return latency < m->cfg.block_ms * MIXER_STARVE_BLOCKS;
+}
+
+static void mixer_thread(void *arg)
+{
+    struct av_render_mixer_t *m = (struct av_render_mixer_t *)arg;
+    while (m->stopping == false) {
+        bool starving = output_starving(m);
+        media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+        int open_num = 0, ready = 0, pending = 0;
+        for (int i = 0; i < m->source_num; i++) {
+            mixer_source_t *s = m->sources[i];
+            if (s->is_open) {
+                open_num++;
+                ready += (s->fill >= m->block_bytes);
+                pending += (s->fill > 0);
+            }
+        }
+        // Play data left in ring directly before owner writes to output again
+        mixer_source_t *owner = get_output_owner(m);
+        if (owner && owner->fill) {
+            uint32_t size = owner->buf_size - owner->rd_pos;
+            size = size < owner->fill ? size : owner->fill;
+            m->mixing = true;
+            media_lib_mutex_unlock(m->lock);
+            av_render_audio_frame_t frame = {
+                .data = owner->buf + owner->rd_pos,
+                .size = size,
+            };
+            media_lib_mutex_lock(m->out_lock, MEDIA_LIB_MAX_LOCK_TIME);
+            audio_render_write(m->cfg.out_render, &frame);
+            media_lib_mutex_unlock(m->out_lock);
+            media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+            owner->rd_pos = (owner->rd_pos + size) % owner->buf_size;
+            owner->fill -= size;
+            m->mixing = false;
+            media_lib_mutex_unlock(m->lock);
+            media_lib_sema_unlock(owner->space_sema);
+            continue;
+        }
+        bool do_mix = false;
+        if (ready) {
+            // Wait at most one block for other sources so that they are not cut into pieces
+            int64_t now = esp_timer_get_time();
+            if (m->wait_start == 0) {
+                m->wait_start = now;
+            }
+            do_mix = (ready == open_num || starving || now - m->wait_start >= m->cfg.block_ms * 1000);
+        } else if (pending) {
+            // Tail shorter than one block
+            do_mix = starving;
+        }
+        if (do_mix) {
+            mix_block(m, ready == 0);
+            m->wait_start = 0;
+            m->mixing = true;
+        }
+        media_lib_mutex_unlock(m->lock);
+        if (do_mix == false) {
+            media_lib_sema_lock(m->data_sema, pending ? (m->cfg.block_ms + 1) / 2 : MIXER_IDLE_WAIT_MS);
+            continue;
+        }
+        av_render_audio_frame_t frame = {
+            .data = (uint8_t *)m->out_buf,
+            .size = m->block_bytes,
+        };
+        media_lib_mutex_lock(m->out_lock, MEDIA_LIB_MAX_LOCK_TIME);
+        // Speed set by single source not apply to mixed audio
+        if (m->out_speed_set) {
+            audio_render_set_speed(m->cfg.out_render, 1.0f);
+            m->out_speed_set = false;
+        }
+        audio_render_write(m->cfg.out_render, &frame);
+        media_lib_mutex_unlock(m->out_lock);
+        media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+        m->mixing = false;
+        media_lib_mutex_unlock(m->lock);
+    }
+    media_lib_sema_unlock(m->exit_sema);
+    media_lib_thread_destroy(NULL);
+}
+
+static audio_render_handle_t source_init(void *cfg, int cfg_size)
+{
+    if (cfg == NULL || cfg_size != sizeof(mixer_source_init_t)) {
+        return NULL;
+    }
+    mixer_source_init_t *init = (mixer_source_init_t *)cfg;
+    struct av_render_mixer_t *m = init->mixer;
+    mixer_source_t *s = (mixer_source_t *)media_lib_calloc(1, sizeof(mixer_source_t));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->mixer = m;
+    s->cfg = *init->cfg;
+    s->gain = to_gain(s->cfg.gain);
+    s->duck_gain = to_gain(s->cfg.duck_gain);
+    s->buf_size = (m->cfg.source_buf_ms * m->bytes_per_ms + m->block_bytes - 1) / m->block_bytes * m->block_bytes;
+    if (s->buf_size < m->block_bytes * 2) {
+        s->buf_size = m->block_bytes * 2;
+    }
+    s->buf = (uint8_t *)media_lib_malloc(s->buf_size);
+    media_lib_sema_create(&s->space_sema);
+    if (s->buf == NULL || s->space_sema == NULL) {
+        ESP_LOGE(TAG, "No memory for source");
+        if (s->space_sema) {
+            media_lib_sema_destroy(s->space_sema);
+        }
+        media_lib_free(s->buf);
+        media_lib_free(s);
+        return NULL;
+    }
+    *init->source = s;
+    return s;
+}
+
+static int source_open(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    mixer_source_t *s = (mixer_source_t *)h;
+    struct av_render_mixer_t *m = s->mixer;
+    av_render_audio_frame_info_t *out = &m->cfg.out_info;
+    if (info->sample_rate != out->sample_rate || info->channel != out->channel ||
+        info->bits_per_sample != out->bits_per_sample) {
+        ESP_LOGE(TAG, "Source format %d/%d/%d not match mixer, set fixed frame info on player",
+                 (int)info->sample_rate, info->channel, info->bits_per_sample);
+        return ESP_MEDIA_ERR_NOT_SUPPORT;
+    }
+    media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    s->rd_pos = s->fill = 0;
+    s->is_open = true;
+    // Start at wanted gain, ducking of others fades
+    s->cur_gain = source_target_gain(m, s);
+    media_lib_mutex_unlock(m->lock);
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int source_write(audio_render_handle_t h, av_render_audio_frame_t *audio_data)
+{
+    mixer_source_t *s = (mixer_source_t *)h;
+    struct av_render_mixer_t *m = s->mixer;
+    if (audio_data->size == 0) {
+        return ESP_MEDIA_ERR_OK;
+    }
+    while (1) {
+        media_lib_mutex_lock(m->out_lock, MEDIA_LIB_MAX_LOCK_TIME);
+        media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+        bool own = owns_output(m, s);
+        bool pass = own && s->fill == 0 && m->mixing == false;
+        media_lib_mutex_unlock(m->lock);
+        if (pass) {
+            // Single source write to output without copy
+            int ret = audio_render_write(m->cfg.out_render, audio_data);
+            media_lib_mutex_unlock(m->out_lock);
+            return ret;
+        }
+        media_lib_mutex_unlock(m->out_lock);
+        if (own == false) {
+            break;
+        }
+        // Wait for buffered data played to keep order
+        media_lib_sema_lock(s->space_sema, MIXER_SPACE_WAIT_MS);
+    }
+    uint8_t *data = audio_data->data;
+    uint32_t left = audio_data->size;
+    while (left) {
+        media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+        if (s->is_open == false) {
+            media_lib_mutex_unlock(m->lock);
+            return ESP_MEDIA_ERR_WRONG_STATE;
+        }
+        uint32_t size = s->buf_size - s->fill;
+        if (size > left) {
+            size = left;
+        }
+        uint32_t wr_pos = (s->rd_pos + s->fill) % s->buf_size;
+        uint32_t first = s->buf_size - wr_pos;
+        if (first > size) {
+            first = size;
+        }
+        memcpy(s->buf + wr_pos, data, first);
+        memcpy(s->buf, data + first, size - first);
+        s->fill += size;
+        media_lib_mutex_unlock(m->lock);
+        data += size;
+        left -= size;
+        if (size) {
+            media_lib_sema_unlock(m->data_sema);
+        }
+        if (left) {
+            media_lib_sema_lock(s->space_sema, MIXER_SPACE_WAIT_MS);
+        }
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int source_get_latency(audio_render_handle_t h, uint32_t *latency)
+{
+    mixer_source_t *s = (mixer_source_t *)h;
+    struct av_render_mixer_t *m = s->mixer;
+    uint32_t out_latency = 0;
+    audio_render_get_latency(m->cfg.out_render, &out_latency);
+    media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    *latency = out_latency + s->fill / m->bytes_per_ms;
+    media_lib_mutex_unlock(m->lock);
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int source_get_frame_info(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    mixer_source_t *s = (mixer_source_t *)h;
+    *info = s->mixer->cfg.out_info;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int source_set_speed(audio_render_handle_t h, float speed)
+{
+    mixer_source_t *s = (mixer_source_t *)h;
+    struct av_render_mixer_t *m = s->mixer;
+    // Speed can only be changed when source owns output
+    media_lib_mutex_lock(m->out_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    bool own = owns_output(m, s);
+    media_lib_mutex_unlock(m->lock);
+    int ret = ESP_MEDIA_ERR_NOT_SUPPORT;
+    if (own) {
+        ret = audio_render_set_speed(m->cfg.out_render, speed);
+        m->out_speed_set = (ret == 0 && speed != 1.0f);
+    }
+    media_lib_mutex_unlock(m->out_lock);
+    return ret;
+}
+
+static int source_close(audio_render_handle_t h)
+{
+    mixer_source_t *s = (mixer_source_t *)h;
+    struct av_render_mixer_t *m = s->mixer;
+    media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    s->is_open = false;
+    s->rd_pos = s->fill = 0;
+    media_lib_mutex_unlock(m->lock);
+    media_lib_sema_unlock(s->space_sema);
+    media_lib_sema_unlock(m->data_sema);
+    return ESP_MEDIA_ERR_OK;
+}
+
+static void source_deinit(audio_render_handle_t h)
+{
+    mixer_source_t *s = (mixer_source_t *)h;
+    struct av_render_mixer_t *m = s->mixer;
+    media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    for (int i = 0; i < m->source_num; i++) {
+        if (m->sources[i] == s) {
+            m->sources[i] = m->sources[--m->source_num];
+            break;
+        }
+    }
+    media_lib_mutex_unlock(m->lock);
+    media_lib_sema_destroy(s->space_sema);
+    media_lib_free(s->buf);
+    media_lib_free(s);
+}
+
+av_render_mixer_handle_t av_render_mixer_create(av_render_mixer_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->out_render == NULL || cfg->out_info.bits_per_sample != 16 ||
+        cfg->out_info.sample_rate == 0 || cfg->out_info.channel == 0) {
+        ESP_LOGE(TAG, "Only support 16 bits PCM output");
+        return NULL;
+    }
+    struct av_render_mixer_t *m = (struct av_render_mixer_t *)media_lib_calloc(1, sizeof(struct av_render_mixer_t));
+    if (m == NULL) {
+        return NULL;
+    }
+    m->cfg = *cfg;
+    if (m->cfg.block_ms == 0) {
+        m->cfg.block_ms = MIXER_DEFAULT_BLOCK_MS;
+    }
+    if (m->cfg.source_buf_ms == 0) {
+        m->cfg.source_buf_ms = MIXER_DEFAULT_BUF_MS;
+    }
+    if (m->cfg.fade_ms == 0) {
+        m->cfg.fade_ms = MIXER_DEFAULT_FADE_MS;
+    }
+    uint32_t sample_bytes = cfg->out_info.channel * sizeof(int16_t);
+    m->block_bytes = cfg->out_info.sample_rate * m->cfg.block_ms / 1000 * sample_bytes;
+    m->bytes_per_ms = cfg->out_info.sample_rate * sample_bytes / 1000;
+    m->fade_step = MIXER_UNITY_GAIN * m->cfg.block_ms / m->cfg.fade_ms;
+    if (m->fade_step == 0) {
+        m->fade_step = 1;
+    }
+    int ret = ESP_MEDIA_ERR_NO_MEM;
+    do {
+        if (m->block_bytes == 0 || m->bytes_per_ms == 0) {
+            ret = ESP_MEDIA_ERR_INVALID_ARG;
+            break;
+        }
+        m->acc = (int32_t *)media_lib_malloc(m->block_bytes * 2);
+        m->out_buf = (int16_t *)media_lib_malloc(m->block_bytes);
+        if (m->acc == NULL || m->out_buf == NULL) {
+            break;
+        }
+        media_lib_mutex_create(&m->lock);
+        media_lib_mutex_create(&m->out_lock);
+        media_lib_sema_create(&m->data_sema);
+        media_lib_sema_create(&m->exit_sema);
+        if (m->lock == NULL || m->out_lock == NULL || m->data_sema == NULL || m->exit_sema == NULL) {
+            break;
+        }
+        ret = audio_render_open(cfg->out_render, &m->cfg.out_info);
+        if (ret != 0) {
+            ESP_LOGE(TAG, "Fail to open output render ret %d", ret);
+            break;
+        }
+        media_lib_thread_handle_t thread = NULL;
+        ret = media_lib_thread_create_from_scheduler(&thread, "AMixer", mixer_thread, m);
+        if (ret != 0) {
+            ESP_LOGE(TAG, "Fail to create mixer thread");
+            audio_render_close(cfg->out_render);
+            break;
+        }
+        return m;
+    } while (0);
+    if (m->lock) {
+        media_lib_mutex_destroy(m->lock);
+    }
+    if (m->out_lock) {
+        media_lib_mutex_destroy(m->out_lock);
+    }
+    if (m->data_sema) {
+        media_lib_sema_destroy(m->data_sema);
+    }
+    if (m->exit_sema) {
+        media_lib_sema_destroy(m->exit_sema);
+    }
+    media_lib_free(m->acc);
+    media_lib_free(m->out_buf);
+    media_lib_free(m);
+    return NULL;
+}
+
+audio_render_handle_t av_render_mixer_alloc_source(av_render_mixer_handle_t mixer, av_render_mixer_source_cfg_t *cfg)
+{
+    struct av_render_mixer_t *m = (struct av_render_mixer_t *)mixer;
+    if (m == NULL || cfg == NULL) {
+        return NULL;
+    }
+    media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (m->source_num >= MIXER_MAX_SOURCE) {
+        media_lib_mutex_unlock(m->lock);
+        ESP_LOGE(TAG, "Too many sources");
+        return NULL;
+    }
+    media_lib_mutex_unlock(m->lock);
+    mixer_source_t *s = NULL;
+    mixer_source_init_t init = {
+        .mixer = m,
+        .cfg = cfg,
+        .source = &s,
+    };
+    audio_render_cfg_t render_cfg = {
+        .ops = {
+            .init = source_init,
+            .open = source_open,
+            .write = source_write,
+            .get_latency = source_get_latency,
+            .get_frame_info = source_get_frame_info,
+            .set_speed = source_set_speed,
+            .close = source_close,
+            .deinit = source_deinit,
+        },
+        .cfg = &init,
+        .cfg_size = sizeof(mixer_source_init_t),
+    };
+    audio_render_handle_t handle = audio_render_alloc_handle(&render_cfg);
+    if (handle == NULL) {
+        return NULL;
+    }
+    media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    s->handle = handle;
+    m->sources[m->source_num++] = s;
+    media_lib_mutex_unlock(m->lock);
+    return handle;
+}
+
+int av_render_mixer_set_gain(av_render_mixer_handle_t mixer, audio_render_handle_t source, float gain)
+{
+    struct av_render_mixer_t *m = (struct av_render_mixer_t *)mixer;
+    if (m == NULL || source == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    int ret = ESP_MEDIA_ERR_INVALID_ARG;
+    media_lib_mutex_lock(m->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    for (int i = 0; i < m->source_num; i++) {
+        if (m->sources[i]->handle == source) {
+            m->sources[i]->gain = to_gain(gain);
+            ret = ESP_MEDIA_ERR_OK;
+            break;
+        }
+    }
+    media_lib_mutex_unlock(m->lock);
+    return ret;
+}
+
+void av_render_mixer_destroy(av_render_mixer_handle_t mixer)
+{
+    struct av_render_mixer_t *m = (struct av_render_mixer_t *)mixer;
+    if (m == NULL) {
+        return;
+    }
+    if (m->source_num) {
+        ESP_LOGW(TAG, "Destroy with %d sources not freed", m->source_num);
+    }
+    m->stopping = true;
+    media_lib_sema_unlock(m->data_sema);
+    media_lib_sema_lock(m->exit_sema, MEDIA_LIB_MAX_LOCK_TIME);
+    audio_render_close(m->cfg.out_render);
+    media_lib_mutex_destroy(m->lock);
+    media_lib_mutex_destroy(m->out_lock);
+    media_lib_sema_destroy(m->data_sema);
+    media_lib_sema_destroy(m->exit_sema);
+    media_lib_free(m->acc);
+    media_lib_free(m->out_buf);
+    media_lib_free(m);
+}
@@ -0,0 +1,272 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdbool.h>
+#include "av_render_pool.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+#include "esp_log.h"
+
+#define TAG "RENDER_POOL"
+
+#define POOL_DEFAULT_ALIGN (16)
+#define POOL_ALIGN_UP(v, a) (((v) + (a) - 1) & ~((a) - 1))
+
+#define _ATOMIC_LOAD(v)        __atomic_load_n(&(v), __ATOMIC_SEQ_CST)
+#define _ATOMIC_CAS(v, cur, d) __atomic_compare_exchange_n(&(v), &(cur), d, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+/**
+ * Slab header lives right before slab data, only accessed after data pointer is checked inside pool
+ */
+typedef struct {
+    int32_t  ref;
+    uint16_t index;
+} pool_block_t;
+
+struct av_render_pool_t {
+    av_render_pool_cfg_t     cfg;
+    uint8_t                 *buffer;
+    uint32_t                 block_stride;
+    uint32_t                 head_size;
+    uint16_t                *free_list;
+    uint16_t                 free_num;
+    uint16_t                 peak_used;
+    uint32_t                 acquire_num;
+    uint32_t                 fail_num;
+    media_lib_mutex_handle_t lock;
+    media_lib_sema_handle_t  free_sema;
+};
+
+static inline pool_block_t *get_block(uint8_t *data)
+{
+    return (pool_block_t *)(data - sizeof(pool_block_t));
+}
+
+static inline uint8_t *get_block_data(struct av_render_pool_t *pool, uint16_t index)
+{
+    return pool->buffer + index * pool->block_stride + pool->head_size;
+}
+
+static pool_block_t *check_block(struct av_render_pool_t *pool, uint8_t *data)
+{
+    if (pool == NULL || data == NULL) {
+        return NULL;
+    }
+    // Compare address only, foreign pointer may have no readable memory before it
+    if (data < pool->buffer || data >= pool->buffer + pool->block_stride * pool->cfg.block_num) {
+        return NULL;
+    }
+    uint32_t offset = (uint32_t)(data - pool->buffer);
+    if (offset % pool->block_stride != pool->head_size) {
+        return NULL;
+    }
+    return get_block(data);
+}
+
+static uint8_t *pool_try_acquire(struct av_render_pool_t *pool)
+{
+    uint8_t *data = NULL;
+    bool more = false;
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (pool->free_num) {
+        uint16_t index = pool->free_list[--pool->free_num];
+        data = get_block_data(pool, index);
+        get_block(data)->ref = 1;
+        uint16_t used = pool->cfg.block_num - pool->free_num;
+        if (used > pool->peak_used) {
+            pool->peak_used = used;
+        }
+        pool->acquire_num++;
+        more = (pool->free_num > 0);
+    }
+    media_lib_mutex_unlock(pool->lock);
+    // Semaphore is binary, pass wakeup to other waiter if still have free slab
+    if (more) {
+        media_lib_sema_unlock(pool->free_sema);
+    }
+    return data;
+}
+
+static void pool_put_back(struct av_render_pool_t *pool, pool_block_t *block)
+{
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    pool->free_list[pool->free_num++] = block->index;
+    media_lib_mutex_unlock(pool->lock);
+    media_lib_sema_unlock(pool->free_sema);
+}
+
+av_render_pool_handle_t av_render_pool_create(av_render_pool_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->block_size == 0 || cfg->block_num == 0) {
+        ESP_LOGE(TAG, "Invalid pool configuration");
+        return NULL;
+    }
+    uint8_t align = cfg->align ? cfg->align : POOL_DEFAULT_ALIGN;
+    if ((align & (align - 1)) || align < sizeof(uint32_t)) {
+        ESP_LOGE(TAG, "Wrong pool alignment %d", align);
+        return NULL;
+    }
+    struct av_render_pool_t *pool = (struct av_render_pool_t *)media_lib_calloc(1, sizeof(struct av_render_pool_t));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->cfg = *cfg;
+    pool->cfg.align = align;
+    pool->head_size = POOL_ALIGN_UP(sizeof(pool_block_t), align);
+    pool->block_stride = POOL_ALIGN_UP(pool->head_size + cfg->block_size, align);
+    do {
+        pool->buffer = (uint8_t *)media_lib_malloc_align(pool->block_stride * cfg->block_num, align);
+        pool->free_list = (uint16_t *)media_lib_malloc(cfg->block_num * sizeof(uint16_t));
+        if (pool->buffer == NULL || pool->free_list == NULL) {
+            ESP_LOGE(TAG, "No memory for %d slabs of %d", cfg->block_num, (int)cfg->block_size);
+            break;
+        }
+        if (media_lib_mutex_create(&pool->lock) != 0 || media_lib_sema_create(&pool->free_sema) != 0) {
+            break;
+        }
+        // Push in reverse order so that first acquire get first slab
+        for (int i = 0; i < cfg->block_num; i++) {
+            uint16_t index = cfg->block_num - 1 - i;
+            pool_block_t *block = get_block(get_block_data(pool, index));
+            block->ref = 0;
+            block->index = index;
+            pool->free_list[i] = index;
+        }
+        pool->free_num = cfg->block_num;
+        return pool;
+    } while (0);
+    av_render_pool_destroy(pool);
+    return NULL;
+}
+
+uint8_t *av_render_pool_acquire(av_render_pool_handle_t pool, uint32_t size, uint32_t timeout)
+{
+    if (pool == NULL) {
+        return NULL;
+    }
+    if (size > pool->cfg.block_size) {
+        ESP_LOGE(TAG, "Acquire size %d exceed slab size %d", (int)size, (int)pool->cfg.block_size);
+        media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+        pool->fail_num++;
+        media_lib_mutex_unlock(pool->lock);
+        return NULL;
+    }
+    while (1) {
+        uint8_t *data = pool_try_acquire(pool);
+        if (data) {
+            return data;
+        }
+        if (timeout == 0 || media_lib_sema_lock(pool->free_sema, timeout) != 0) {
+            break;
+        }
+    }
+    // Last try in case slab released just after wait timeout
+    uint8_t *data = pool_try_acquire(pool);
+    if (data == NULL) {
+        media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+        pool->fail_num++;
+        media_lib_mutex_unlock(pool->lock);
+    }
+    return data;
+}
+
+int av_render_pool_add_ref(av_render_pool_handle_t pool, uint8_t *data)
+{
+    pool_block_t *block = check_block(pool, data);
+    if (block == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    int32_t ref = _ATOMIC_LOAD(block->ref);
+    while (ref > 0) {
+        if (_ATOMIC_CAS(block->ref, ref, ref + 1)) {
+            return ESP_MEDIA_ERR_OK;
+        }
+    }
+    ESP_LOGE(TAG, "Add reference to free slab %p", data);
+    return ESP_MEDIA_ERR_WRONG_STATE;
+}
+
+int av_render_pool_release(av_render_pool_handle_t pool, uint8_t *data)
+{
+    pool_block_t *block = check_block(pool, data);
+    if (block == NULL) {
+        ESP_LOGE(TAG, "Release non slab data %p", data);
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    int32_t ref = _ATOMIC_LOAD(block->ref);
+    while (ref > 0) {
+        if (_ATOMIC_CAS(block->ref, ref, ref - 1)) {
+            if (ref == 1) {
+                pool_put_back(pool, block);
+            }
+            return ESP_MEDIA_ERR_OK;
+        }
+    }
+    ESP_LOGE(TAG, "Double release of slab %p", data);
+    return ESP_MEDIA_ERR_WRONG_STATE;
+}
+
+void av_render_pool_free_data(void *data, void *ctx)
+{
+    av_render_pool_release((av_render_pool_handle_t)ctx, (uint8_t *)data);
+}
+
+int av_render_pool_get_stats(av_render_pool_handle_t pool, av_render_pool_stats_t *stats)
+{
+    if (pool == NULL || stats == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    media_lib_mutex_lock(pool->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    stats->block_size = pool->cfg.block_size;
+    stats->block_num = pool->cfg.block_num;
+    stats->free_num = pool->free_num;
+    stats->peak_used = pool->peak_used;
+    stats->acquire_num = pool->acquire_num;
+    stats->fail_num = pool->fail_num;
+    media_lib_mutex_unlock(pool->lock);
+    return ESP_MEDIA_ERR_OK;
+}
+
+void av_render_pool_destroy(av_render_pool_handle_t pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+    if (pool->free_list && pool->free_num != pool->cfg.block_num) {
+        ESP_LOGW(TAG, "Destroy pool with %d slabs still in use", pool->cfg.block_num - pool->free_num);
+    }
+    if (pool->lock) {
+        media_lib_mutex_destroy(pool->lock);
+    }
+    if (pool->free_sema) {
+        media_lib_sema_destroy(pool->free_sema);
+    }
+    if (pool->buffer) {
+        media_lib_free_align(pool->buffer);
+    }
+    if (pool->free_list) {
+        media_lib_free(pool->free_list);
+    }
+    media_lib_free(pool);
+}
@@ -0,0 +1,397 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "av_render_record.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+#include "esp_log.h"
+
+#define TAG "RENDER_RECORD"
+
+#define RECORD_MAGIC       "AVRR"
+#define RECORD_FILE_HEAD   (8)
+#define RECORD_HEAD_SIZE   (20)
+#define RECORD_CONFIG_SIZE (24)
+#define RECORD_MAX_PAYLOAD (4 * 1024 * 1024)
+
+#define RECORD_FLAG_EOS       (1 << 0)
+#define RECORD_FLAG_KEY_FRAME (1 << 1)
+#define RECORD_FLAG_PAUSE     (1 << 2)
+
+#define RECORD_CFG_QUIT_WHEN_EOS  (1 << 0)
+#define RECORD_CFG_ALLOW_DROP     (1 << 1)
+#define RECORD_CFG_PAUSE_RENDER   (1 << 2)
+#define RECORD_CFG_PAUSE_ON_FIRST (1 << 3)
+#define RECORD_CFG_CVT_IN_RENDER  (1 << 4)
+
+struct av_render_record_t {
+    FILE    *fp;
+    bool     for_write;
+    uint8_t *buffer;
+    uint32_t buffer_size;
+};
+
+static inline void put_u16(uint8_t *b, uint16_t v)
+{
+    b[0] = (uint8_t)v;
+    b[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32(uint8_t *b, uint32_t v)
+{
+    put_u16(b, (uint16_t)v);
+    put_u16(b + 2, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t get_u16(const uint8_t *b)
+{
+    return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *b)
+{
+    return get_u16(b) | ((uint32_t)get_u16(b + 2) << 16);
+}
+
+static int write_record(struct av_render_record_t *record, uint8_t type, uint8_t flags, uint32_t pts, uint64_t time_us,
+                        const uint8_t *meta, uint32_t meta_size, const uint8_t *data, uint32_t data_size)
+{
+    uint8_t head[RECORD_HEAD_SIZE] = { type, flags };
+    put_u32(head + 4, meta_size + data_size);
+    put_u32(head + 8, pts);
+    put_u32(head + 12, (uint32_t)time_us);
+    put_u32(head + 16, (uint32_t)(time_us >> 32));
+    if (fwrite(head, 1, sizeof(head), record->fp) != sizeof(head) ||
+        (meta_size && fwrite(meta, 1, meta_size, record->fp) != meta_size) ||
+        (data_size && fwrite(data, 1, data_size, record->fp) != data_size)) {
+        return ESP_MEDIA_ERR_WRITE_DATA;
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+static uint32_t pack_config(av_render_cfg_t *cfg, uint8_t *b)
+{
+    memset(b, 0, RECORD_CONFIG_SIZE);
+    b[0] = (uint8_t)cfg->sync_mode;
+    b[1] = (cfg->quit_when_eos ? RECORD_CFG_QUIT_WHEN_EOS : 0) | (cfg->allow_drop_data ? RECORD_CFG_ALLOW_DROP : 0) |
+           (cfg->pause_render_only ? RECORD_CFG_PAUSE_RENDER : 0) |
+           (cfg->pause_on_first_frame ? RECORD_CFG_PAUSE_ON_FIRST : 0) |
+           (cfg->video_cvt_in_render ? RECORD_CFG_CVT_IN_RENDER : 0);
+    b[2] = cfg->video_cvt_worker_num;
+    put_u32(b + 4, cfg->audio_raw_fifo_size);
+    put_u32(b + 8, cfg->video_raw_fifo_size);
+    put_u32(b + 12, cfg->audio_render_fifo_size);
+    put_u32(b + 16, cfg->video_render_fifo_size);
+    put_u16(b + 20, cfg->audio_jitter_max_ms);
+    return RECORD_CONFIG_SIZE;
+}
+
+static void unpack_config(const uint8_t *b, av_render_cfg_t *cfg)
+{
+    memset(cfg, 0, sizeof(av_render_cfg_t));
+    cfg->sync_mode = (av_render_sync_mode_t)b[0];
+    cfg->quit_when_eos = !!(b[1] & RECORD_CFG_QUIT_WHEN_EOS);
+    cfg->allow_drop_data = !!(b[1] & RECORD_CFG_ALLOW_DROP);
+    cfg->pause_render_only = !!(b[1] & RECORD_CFG_PAUSE_RENDER);
+    cfg->pause_on_first_frame = !!(b[1] & RECORD_CFG_PAUSE_ON_FIRST);
+    cfg->video_cvt_in_render = !!(b[1] & RECORD_CFG_CVT_IN_RENDER);
+    cfg->video_cvt_worker_num = b[2];
+    cfg->audio_raw_fifo_size = get_u32(b + 4);
+    cfg->video_raw_fifo_size = get_u32(b + 8);
+    cfg->audio_render_fifo_size = get_u32(b + 12);
+    cfg->video_render_fifo_size = get_u32(b + 16);
+    cfg->audio_jitter_max_ms = get_u16(b + 20);
+}
+
+int av_render_record_create(const char *path, av_render_record_handle_t *record)
+{
+    if (path == NULL || record == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    struct av_render_record_t *r = (struct av_render_record_t *)media_lib_calloc(1, sizeof(struct av_render_record_t));
+    if (r == NULL) {
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    r->for_write = true;
+    r->fp = fopen(path, "wb");
+    uint8_t head[RECORD_FILE_HEAD] = { 0 };
+    memcpy(head, RECORD_MAGIC, 4);
+    put_u16(head + 4, AV_RENDER_RECORD_VERSION);
+    if (r->fp == NULL || fwrite(head, 1, sizeof(head), r->fp) != sizeof(head)) {
+        ESP_LOGE(TAG, "Fail to create record %s", path);
+        av_render_record_close(r);
+        return ESP_MEDIA_ERR_WRITE_DATA;
+    }
+    *record = r;
+    return ESP_MEDIA_ERR_OK;
+}
+
+int av_render_record_write(av_render_record_handle_t record, av_render_record_item_t *item)
+{
+    if (record == NULL || record->for_write == false || item == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    uint8_t meta[RECORD_CONFIG_SIZE] = { 0 };
+    switch (item->type) {
+        case AV_RENDER_RECORD_TYPE_CONFIG: {
+            uint32_t size = pack_config(&item->cfg, meta);
+            return write_record(record, item->type, 0, 0, item->time_us, meta, size, NULL, 0);
+        }
+        case AV_RENDER_RECORD_TYPE_AUDIO_STREAM: {
+            av_render_audio_info_t *info = &item->audio_info;
+            meta[0] = (uint8_t)info->codec;
+            meta[1] = info->channel;
+            meta[2] = info->bits_per_sample;
+            meta[3] = info->aac_no_adts;
+            put_u32(meta + 4, info->sample_rate);
+            return write_record(record, item->type, 0, 0, item->time_us, meta, 8, info->codec_spec_info,
+                                info->codec_spec_info ? info->spec_info_len : 0);
+        }
+        case AV_RENDER_RECORD_TYPE_VIDEO_STREAM: {
+            av_render_video_info_t *info = &item->video_info;
+            meta[0] = (uint8_t)info->codec;
+            meta[1] = info->fps;
+            put_u16(meta + 2, info->width);
+            put_u16(meta + 4, info->height);
+            put_u16(meta + 6, info->transform.width);
+            put_u16(meta + 8, info->transform.height);
+            meta[10] = (uint8_t)info->transform.rotate;
+            meta[11] = (uint8_t)info->transform.scale;
+            meta[12] = info->transform.mirror;
+            return write_record(record, item->type, 0, 0, item->time_us, meta, 16, info->codec_spec_info,
+                                info->codec_spec_info ? info->spec_info_len : 0);
+        }
+        case AV_RENDER_RECORD_TYPE_AUDIO_DATA: {
+            av_render_audio_data_t *data = &item->audio_data;
+            return write_record(record, item->type, data->eos ? RECORD_FLAG_EOS : 0, data->pts, item->time_us, NULL, 0,
+                                data->data, data->data ? data->size : 0);
+        }
+        case AV_RENDER_RECORD_TYPE_VIDEO_DATA: {
+            av_render_video_data_t *data = &item->video_data;
+            uint8_t flags = (data->eos ? RECORD_FLAG_EOS : 0) | (data->key_frame ? RECORD_FLAG_KEY_FRAME : 0);
+            return write_record(record, item->type, flags, data->pts, item->time_us, NULL, 0,
+                                data->data, data->data ? data->size : 0);
+        }
+        case AV_RENDER_RECORD_TYPE_FIXED_INFO:
+            meta[0] = item->fixed_info.channel;
+            meta[1] = item->fixed_info.bits_per_sample;
+            put_u32(meta + 4, item->fixed_info.sample_rate);
+            return write_record(record, item->type, 0, 0, item->time_us, meta, 8, NULL, 0);
+        case AV_RENDER_RECORD_TYPE_AUDIO_THRESHOLD:
+            put_u32(meta, item->audio_threshold);
+            return write_record(record, item->type, 0, 0, item->time_us, meta, 4, NULL, 0);
+        case AV_RENDER_RECORD_TYPE_SPEED: {
+            uint32_t v;
+            memcpy(&v, &item->speed, sizeof(v));
+            put_u32(meta, v);
+            return write_record(record, item->type, 0, 0, item->time_us, meta, 4, NULL, 0);
+        }
+        case AV_RENDER_RECORD_TYPE_PAUSE:
+            return write_record(record, item->type, item->pause ? RECORD_FLAG_PAUSE : 0, 0, item->time_us, NULL, 0,
+                                NULL, 0);
+        case AV_RENDER_RECORD_TYPE_FLUSH:
+        case AV_RENDER_RECORD_TYPE_RESET:
+            return write_record(record, item->type, 0, 0, item->time_us, NULL, 0, NULL, 0);
+        default:
+            return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+}
+
+int av_render_record_open(const char *path, av_render_record_handle_t *record)
+{
+    if (path == NULL || record == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    struct av_render_record_t *r = (struct av_render_record_t *)media_lib_calloc(1, sizeof(struct av_render_record_t));
+    if (r == NULL) {
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    r->fp = fopen(path, "rb");
+    if (r->fp == NULL) {
+        ESP_LOGE(TAG, "Fail to open record %s", path);
+        av_render_record_close(r);
+        return ESP_MEDIA_ERR_READ_DATA;
+    }
+    uint8_t head[RECORD_FILE_HEAD];
+    if (fread(head, 1, sizeof(head), r->fp) != sizeof(head) || memcmp(head, RECORD_MAGIC, 4) != 0) {
+        ESP_LOGE(TAG, "%s is not record file", path);
+        av_render_record_close(r);
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    if (get_u16(head + 4) > AV_RENDER_RECORD_VERSION) {
+        ESP_LOGE(TAG, "Record version %d not supported", get_u16(head + 4));
+        av_render_record_close(r);
+        return ESP_MEDIA_ERR_INVALID_VERSION;
+    }
+    *record = r;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int read_payload(struct av_render_record_t *record, uint32_t size)
+{
+    if (size > RECORD_MAX_PAYLOAD) {
+        ESP_LOGE(TAG, "Record payload %d too large", (int)size);
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    if (size > record->buffer_size) {
+        uint8_t *buffer = (uint8_t *)media_lib_realloc(record->buffer, size);
+        if (buffer == NULL) {
+            return ESP_MEDIA_ERR_NO_MEM;
+        }
+        record->buffer = buffer;
+        record->buffer_size = size;
+    }
+    if (size && fread(record->buffer, 1, size, record->fp) != size) {
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+int av_render_record_read(av_render_record_handle_t record, av_render_record_item_t *item)
+{
+    if (record == NULL || record->for_write || item == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    while (1) {
+        uint8_t head[RECORD_HEAD_SIZE];
+        size_t n = fread(head, 1, sizeof(head), record->fp);
+        if (n == 0) {
+            return ESP_MEDIA_ERR_NOT_FOUND;
+        }
+        if (n != sizeof(head)) {
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+        uint32_t size = get_u32(head + 4);
+        int ret = read_payload(record, size);
+        if (ret != ESP_MEDIA_ERR_OK) {
+            return ret;
+        }
+        uint8_t *b = record->buffer;
+        uint8_t flags = head[1];
+        memset(item, 0, sizeof(av_render_record_item_t));
+        item->type = (av_render_record_type_t)head[0];
+        item->time_us = get_u32(head + 12) | ((uint64_t)get_u32(head + 16) << 32);
+        uint32_t pts = get_u32(head + 8);
+        switch (item->type) {
+            case AV_RENDER_RECORD_TYPE_CONFIG:
+                if (size < RECORD_CONFIG_SIZE) {
+                    return ESP_MEDIA_ERR_BAD_DATA;
+                }
+                unpack_config(b, &item->cfg);
+                return ESP_MEDIA_ERR_OK;
+            case AV_RENDER_RECORD_TYPE_AUDIO_STREAM:
+                if (size < 8) {
+                    return ESP_MEDIA_ERR_BAD_DATA;
+                }
+                item->audio_info.codec = (av_render_audio_codec_t)b[0];
+                item->audio_info.channel = b[1];
+                item->audio_info.bits_per_sample = b[2];
+                item->audio_info.aac_no_adts = b[3];
+                item->audio_info.sample_rate = get_u32(b + 4);
+                if (size > 8) {
+                    item->audio_info.codec_spec_info = b + 8;
+                    item->audio_info.spec_info_len = size - 8;
+                }
+                return ESP_MEDIA_ERR_OK;
+            case AV_RENDER_RECORD_TYPE_VIDEO_STREAM:
+                if (size < 16) {
+                    return ESP_MEDIA_ERR_BAD_DATA;
+                }
+                item->video_info.codec = (av_render_video_codec_t)b[0];
+                item->video_info.fps = b[1];
+                item->video_info.width = get_u16(b + 2);
+                item->video_info.height = get_u16(b + 4);
+                item->video_info.transform.width = get_u16(b + 6);
+                item->video_info.transform.height = get_u16(b + 8);
+                item->video_info.transform.rotate = (av_render_video_rotate_t)b[10];
+                item->video_info.transform.scale = (av_render_video_scale_t)b[11];
+                item->video_info.transform.mirror = b[12];
+                if (size > 16) {
+                    item->video_info.codec_spec_info = b + 16;
+                    item->video_info.spec_info_len = size - 16;
+                }
+                return ESP_MEDIA_ERR_OK;
+            case AV_RENDER_RECORD_TYPE_AUDIO_DATA:
+                item->audio_data.pts = pts;
+                item->audio_data.data = size ? b : NULL;
+                item->audio_data.size = size;
+                item->audio_data.eos = !!(flags & RECORD_FLAG_EOS);
+                return ESP_MEDIA_ERR_OK;
+            case AV_RENDER_RECORD_TYPE_VIDEO_DATA:
+                item->video_data.pts = pts;
+                item->video_data.data = size ? b : NULL;
+                item->video_data.size = size;
+                item->video_data.eos = !!(flags & RECORD_FLAG_EOS);
+                item->video_data.key_frame = !!(flags & RECORD_FLAG_KEY_FRAME);
+                return ESP_MEDIA_ERR_OK;
+            case AV_RENDER_RECORD_TYPE_FIXED_INFO:
+                if (size < 8) {
+                    return ESP_MEDIA_ERR_BAD_DATA;
+                }
+                item->fixed_info.channel = b[0];
+                item->fixed_info.bits_per_sample = b[1];
+                item->fixed_info.sample_rate = get_u32(b + 4);
+                return ESP_MEDIA_ERR_OK;
+            case AV_RENDER_RECORD_TYPE_AUDIO_THRESHOLD:
+            case AV_RENDER_RECORD_TYPE_SPEED: {
+                if (size < 4) {
+                    return ESP_MEDIA_ERR_BAD_DATA;
+                }
+                uint32_t v = get_u32(b);
+                if (item->type == AV_RENDER_RECORD_TYPE_SPEED) {
+                    memcpy(&item->speed, &v, sizeof(v));
+                } else {
+                    item->audio_threshold = v;
+                }
+                return ESP_MEDIA_ERR_OK;
+            }
+            case AV_RENDER_RECORD_TYPE_PAUSE:
+                item->pause = !!(flags & RECORD_FLAG_PAUSE);
+                return ESP_MEDIA_ERR_OK;
+            case AV_RENDER_RECORD_TYPE_FLUSH:
+            case AV_RENDER_RECORD_TYPE_RESET:
+                return ESP_MEDIA_ERR_OK;
+            default:
+                // Skip record added in newer version
+                ESP_LOGD(TAG, "Skip unknown record type %d", head[0]);
+                break;
+        }
+    }
+}
+
+void av_render_record_close(av_render_record_handle_t record)
+{
+    if (record == NULL) {
+        return;
+    }
+    if (record->fp) {
+        fclose(record->fp);
+    }
+    if (record->buffer) {
+        media_lib_free(record->buffer);
+    }
+    media_lib_free(record);
+}
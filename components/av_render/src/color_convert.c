@@ -22,7 +22,10 @@
  *
  */
 #include <sdkconfig.h>
+#include <stdlib.h>
 #include "color_convert.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
 #include "esp_log.h"
 
 #if CONFIG_IDF_TARGET_ESP32P4
@@ -31,86 +34,443 @@ extern void i420_to_rgb565le(uint8_t *in_image, uint8_t *out_image, int16_t widt
 
 #define TAG "CLR_CONVERT"
 
-#define COLOR_LIMIT(a) (a > 255 ? 255 : a < 0 ? 0 \
-                                              : a)
+#define CVT_FIX_SHIFT       (16)
+#define CVT_FIX_ROUND       (1 << (CVT_FIX_SHIFT - 1))
+#define CVT_FIX(a)          ((int32_t)((a) * (1 << CVT_FIX_SHIFT) + 0.5))
+#define CVT_CLAMP(a)        ((a) < 0 ? 0 : (a) > 255 ? 255 : (a))
+#define CVT_MAX_WORKER      (4)
+#define RGB565(r, g, b)     ((((r) >> 3) << 11) | (((g) >> 2) << 5) | ((b) >> 3))
+#define SWAP_BYTES_16(v)    ((uint16_t)(((v) >> 8) | ((v) << 8)))
 
-#define YUV2RO(C, D, E) COLOR_LIMIT((298 * (C) + 409 * (E) + 128) >> 8)
-#define YUV2GO(C, D, E) COLOR_LIMIT((298 * (C)-100 * (D)-208 * (E) + 128) >> 8)
-#define YUV2BO(C, D, E) COLOR_LIMIT((298 * (C) + 516 * (D) + 128) >> 8)
-#define RGB565(r, g, b) (((((r) << 6) | (g)) << 5) | (b))
+/**
+ * YUV to RGB coefficients in Q16, chroma contribution already scaled for limited range
+ */
+typedef struct {
+    int32_t y_off;
+    int32_t y_mul;
+    int32_t v_r;
+    int32_t u_g;
+    int32_t v_g;
+    int32_t u_b;
+} yuv_coef_t;
+
+struct _color_convert;
 
 typedef struct {
-    uint8_t                     *table;
+    struct _color_convert    *convert;
+    media_lib_thread_handle_t thread;
+    media_lib_sema_handle_t   start;
+    media_lib_sema_handle_t   done;
+    int32_t                  *chroma;
+    uint8_t                  *luma;
+    uint8_t                  *u;
+    uint8_t                  *v;
+    int                       row_start;
+    int                       row_end;
+} convert_worker_t;
+
+typedef struct _color_convert {
     av_render_video_frame_type_t from;
     av_render_video_frame_type_t to;
     int                          width;
     int                          height;
+    int                          chroma_width;
+    int                          out_width;
+    int                          out_height;
+    bool                         fused;
+    bool                         transpose;
+    bool                         bilinear;
+    int32_t                     *col_map;
+    int32_t                     *row_map;
+    yuv_coef_t                   coef;
+    bool                         use_hw;
+    uint8_t                     *src;
+    uint8_t                     *dst;
+    bool                         quit;
+    int                          worker_num;
+    convert_worker_t             worker[CVT_MAX_WORKER];
 } color_convert_t;
 
-static int get_table_size(av_render_video_frame_type_t from, av_render_video_frame_type_t to)
+static void init_coef(yuv_coef_t *coef, color_convert_matrix_t matrix, bool full_range)
 {
-    if (from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) {
-        return 256 * 256 * 2;
+    double kr = 0.299, kb = 0.114;
+    if (matrix == COLOR_CONVERT_MATRIX_BT709) {
+        kr = 0.2126;
+        kb = 0.0722;
     }
-    if (from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && to == AV_RENDER_VIDEO_RAW_TYPE_RGB565) {
-        return 256 * 256 * 2;
+    double kg = 1.0 - kr - kb;
+    double y_scale = 1.0, c_scale = 1.0;
+    coef->y_off = 0;
+    if (full_range == false) {
+        y_scale = 255.0 / 219.0;
+        c_scale = 255.0 / 224.0;
+        coef->y_off = 16;
+    }
+    coef->y_mul = CVT_FIX(y_scale);
+    coef->v_r = CVT_FIX(2.0 * (1.0 - kr) * c_scale);
+    coef->u_g = CVT_FIX(2.0 * kb * (1.0 - kb) / kg * c_scale);
+    coef->v_g = CVT_FIX(2.0 * kr * (1.0 - kr) / kg * c_scale);
+    coef->u_b = CVT_FIX(2.0 * (1.0 - kb) * c_scale);
+}
+
+// Expand chroma to full width so that luma loop is unit stride, rounding is also folded in here
+static inline void convert_chroma_row(const yuv_coef_t *coef, const uint8_t *u, const uint8_t *v, int step,
+                                      int32_t *chroma, int width)
+{
+    int32_t *cr = chroma;
+    int32_t *cg = chroma + width;
+    int32_t *cb = chroma + 2 * width;
+    for (int i = 0; i < width; i++) {
+        int32_t du = u[(i >> 1) * step] - 128;
+        int32_t dv = v[(i >> 1) * step] - 128;
+        cr[i] = coef->v_r * dv + CVT_FIX_ROUND;
+        cg[i] = CVT_FIX_ROUND - coef->u_g * du - coef->v_g * dv;
+        cb[i] = coef->u_b * du + CVT_FIX_ROUND;
+    }
+}
+
+static void expand_chroma_row(const yuv_coef_t *coef, const uint8_t *u, const uint8_t *v, int step,
+                              int32_t *chroma, int width)
+{
+    // Call with constant step so that each one get its own optimized loop
+    switch (step) {
+        case 1:
+            convert_chroma_row(coef, u, v, 1, chroma, width);
+            break;
+        case 2:
+            convert_chroma_row(coef, u, v, 2, chroma, width);
+            break;
+        default:
+            convert_chroma_row(coef, u, v, 4, chroma, width);
+            break;
+    }
+}
+
+// Keep inner loop branch free so that compiler can vectorize it, `swap` is constant after inline
+static inline void convert_luma_row(const yuv_coef_t *coef, const uint8_t *y, const int32_t *chroma,
+                                    uint16_t *dst, int width, bool swap)
+{
+    const int32_t *cr = chroma;
+    const int32_t *cg = chroma + width;
+    const int32_t *cb = chroma + 2 * width;
+    int32_t y_off = coef->y_off;
+    int32_t y_mul = coef->y_mul;
+    for (int i = 0; i < width; i++) {
+        int32_t l = (y[i] - y_off) * y_mul;
+        int32_t r = (l + cr[i]) >> CVT_FIX_SHIFT;
+        int32_t g = (l + cg[i]) >> CVT_FIX_SHIFT;
+        int32_t b = (l + cb[i]) >> CVT_FIX_SHIFT;
+        r = CVT_CLAMP(r);
+        g = CVT_CLAMP(g);
+        b = CVT_CLAMP(b);
+        uint16_t p = (uint16_t)RGB565(r, g, b);
+        dst[i] = swap ? SWAP_BYTES_16(p) : p;
+    }
+}
+
+static void convert_luma_row_rgb888(const yuv_coef_t *coef, const uint8_t *y, const int32_t *chroma,
+                                    uint8_t *dst, int width)
+{
+    const int32_t *cr = chroma;
+    const int32_t *cg = chroma + width;
+    const int32_t *cb = chroma + 2 * width;
+    int32_t y_off = coef->y_off;
+    int32_t y_mul = coef->y_mul;
+    for (int i = 0; i < width; i++) {
+        int32_t l = (y[i] - y_off) * y_mul;
+        int32_t r = (l + cr[i]) >> CVT_FIX_SHIFT;
+        int32_t g = (l + cg[i]) >> CVT_FIX_SHIFT;
+        int32_t b = (l + cb[i]) >> CVT_FIX_SHIFT;
+        dst[3 * i] = (uint8_t)CVT_CLAMP(r);
+        dst[3 * i + 1] = (uint8_t)CVT_CLAMP(g);
+        dst[3 * i + 2] = (uint8_t)CVT_CLAMP(b);
+    }
+}
+
+/**
+ * Source plane layout, pixel (x, y) is at `y_plane[y * y_stride + x * y_step]`
+ * Chroma of it is at `u_plane[(y >> v_shift) * c_stride + (x >> 1) * c_step]`
+ */
+typedef struct {
+    uint8_t *y_plane;
+    uint8_t *u_plane;
+    uint8_t *v_plane;
+    int      y_stride;
+    int      y_step;
+    int      c_stride;
+    int      c_step;
+    int      v_shift;
+} src_layout_t;
+
+static void get_src_layout(color_convert_t *convert, src_layout_t *layout)
+{
+    int width = convert->width;
+    int height = convert->height;
+    int cw = convert->chroma_width;
+    uint8_t *src = convert->src;
+    layout->y_plane = src;
+    layout->u_plane = src + width * height;
+    layout->v_plane = layout->u_plane;
+    layout->y_stride = width;
+    layout->y_step = 1;
+    layout->c_stride = cw;
+    layout->c_step = 1;
+    layout->v_shift = 0;
+    switch (convert->from) {
+        default:
+        case AV_RENDER_VIDEO_RAW_TYPE_YUV420:
+            layout->v_plane = layout->u_plane + cw * ((height + 1) >> 1);
+            layout->v_shift = 1;
+            break;
+        case AV_RENDER_VIDEO_RAW_TYPE_NV12:
+            layout->v_plane = layout->u_plane + 1;
+            layout->c_stride = cw * 2;
+            layout->c_step = 2;
+            layout->v_shift = 1;
+            break;
+        case AV_RENDER_VIDEO_RAW_TYPE_NV21:
+            layout->u_plane = layout->v_plane + 1;
+            layout->c_stride = cw * 2;
+            layout->c_step = 2;
+            layout->v_shift = 1;
+            break;
+        case AV_RENDER_VIDEO_RAW_TYPE_YUV422:
+            layout->v_plane = layout->u_plane + cw * height;
+            break;
+        case AV_RENDER_VIDEO_RAW_TYPE_YUYV:
+        case AV_RENDER_VIDEO_RAW_TYPE_UYVY: {
+            bool yuyv = (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUYV);
+            layout->y_plane = yuyv ? src : src + 1;
+            layout->u_plane = yuyv ? src + 1 : src;
+            layout->v_plane = layout->u_plane + 2;
+            layout->y_stride = layout->c_stride = cw * 4;
+            layout->y_step = 2;
+            layout->c_step = 4;
+            break;
+        }
+    }
+}
+
+static void write_rgb_row(color_convert_t *convert, const uint8_t *y, const int32_t *chroma, uint8_t *dst, int width)
+{
+    switch (convert->to) {
+        case AV_RENDER_VIDEO_RAW_TYPE_RGB565:
+            convert_luma_row(&convert->coef, y, chroma, (uint16_t *)dst, width, false);
+            break;
+        case AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE:
+            convert_luma_row(&convert->coef, y, chroma, (uint16_t *)dst, width, true);
+            break;
+        default:
+            convert_luma_row_rgb888(&convert->coef, y, chroma, dst, width);
+            break;
     }
-    return 0;
 }
 
-static int init_table(color_convert_t *convert)
-{
-    uint16_t *table16 = (uint16_t *)convert->table;
-    if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE) {
-        for (int u0 = 0; u0 < 32; u0++) {
-            for (int v0 = 0; v0 < 32; v0++) {
-                for (int y0 = 0; y0 < 64; y0++) {
-                    int idx = (y0 << 10) + (u0 << 5) + v0;
-                    int y = (y0 << 2) + (y0 & 0x3);
-                    int u = (u0 << 3) + (y0 & 0x7);
-                    int v = (v0 << 3) + (v0 & 0x7);
-                    y -= 16;
-                    u -= 128;
-                    v -= 128;
-                    uint16_t r = (YUV2RO(y, u, v) >> 3) & 0x1f;
-                    uint16_t g = (YUV2GO(y, u, v) >> 2) & 0x3f;
-                    uint16_t b = (YUV2BO(y, u, v) >> 3) & 0x1f;
-                    table16[idx] = RGB565(r, g, b);
-                    table16[idx] = (table16[idx] >> 8) | (table16[idx] << 8);
-                }
+static void convert_band(color_convert_t *convert, convert_worker_t *worker)
+{
+    int width = convert->width;
+    src_layout_t l;
+    get_src_layout(convert, &l);
+    int out_bytes = (convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB888) ? 3 : 2;
+    // Band start is always even so that two luma rows share one chroma row for YUV420
+    for (int row = worker->row_start; row < worker->row_end; row++) {
+        if (row == worker->row_start || ((row & l.v_shift) == 0)) {
+            int c_row = row >> l.v_shift;
+            expand_chroma_row(&convert->coef, l.u_plane + c_row * l.c_stride, l.v_plane + c_row * l.c_stride,
+                              l.c_step, worker->chroma, width);
+        }
+        uint8_t *y = l.y_plane + row * l.y_stride;
+        if (l.y_step != 1) {
+            // Gather packed luma into contiguous row
+            for (int i = 0; i < width; i++) {
+                worker->luma[i] = y[2 * i];
             }
+            y = worker->luma;
         }
+        write_rgb_row(convert, y, worker->chroma, convert->dst + row * width * out_bytes, width);
     }
-    if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565) {
-        for (int u0 = 0; u0 < 32; u0++) {
-            for (int v0 = 0; v0 < 32; v0++) {
-                for (int y0 = 0; y0 < 64; y0++) {
-                    int idx = (y0 << 10) + (u0 << 5) + v0;
-                    int y = (y0 << 2) + (y0 & 0x3);
-                    int u = (u0 << 3) + (y0 & 0x7);
-                    int v = (v0 << 3) + (v0 & 0x7);
-                    y -= 16;
-                    u -= 128;
-                    v -= 128;
-                    uint16_t r = (YUV2RO(y, u, v) >> 3) & 0x1f;
-                    uint16_t g = (YUV2GO(y, u, v) >> 2) & 0x3f;
-                    uint16_t b = (YUV2BO(y, u, v) >> 3) & 0x1f;
-                    table16[idx] = RGB565(r, g, b);
-                }
+}
+
+static inline uint8_t sample_bilinear(const uint8_t *plane, int stride, int step, int32_t x, int32_t y,
+                                      int max_x, int max_y)
+{
+    int xi = x >> CVT_FIX_SHIFT;
+    int yi = y >> CVT_FIX_SHIFT;
+    int32_t fx = (x >> 8) & 0xFF;
+    int32_t fy = (y >> 8) & 0xFF;
+    int dx = (xi < max_x) ? step : 0;
+    int dy = (yi < max_y) ? stride : 0;
+    const uint8_t *p = plane + yi * stride + xi * step;
+    int32_t top = p[0] * (256 - fx) + p[dx] * fx;
+    int32_t bottom = p[dy] * (256 - fx) + p[dy + dx] * fx;
+    return (uint8_t)((top * (256 - fy) + bottom * fy + CVT_FIX_ROUND) >> CVT_FIX_SHIFT);
+}
+
+static void convert_band_fused(color_convert_t *convert, convert_worker_t *worker)
+{
+    int out_width = convert->out_width;
+    int max_x = convert->width - 1;
+    int max_y = convert->height - 1;
+    src_layout_t l;
+    get_src_layout(convert, &l);
+    int max_cx = convert->chroma_width - 1;
+    int max_cy = ((convert->height + l.v_shift) >> l.v_shift) - 1;
+    int out_bytes = (convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB888) ? 3 : 2;
+    // Only visit source pixels which are sampled, output row may map to source column when rotated
+    for (int row = worker->row_start; row < worker->row_end; row++) {
+        int32_t row_pos = convert->row_map[row];
+        for (int i = 0; i < out_width; i++) {
+            int32_t x = convert->transpose ? row_pos : convert->col_map[i];
+            int32_t y = convert->transpose ? convert->col_map[i] : row_pos;
+            if (convert->bilinear) {
+                // Chroma sample center sits between two luma samples
+                int32_t cx = (x >> 1) - (1 << (CVT_FIX_SHIFT - 2));
+                int32_t cy = l.v_shift ? (y >> 1) - (1 << (CVT_FIX_SHIFT - 2)) : y;
+                cx = cx < 0 ? 0 : cx;
+                cy = cy < 0 ? 0 : cy;
+                worker->luma[i] = sample_bilinear(l.y_plane, l.y_stride, l.y_step, x, y, max_x, max_y);
+                worker->u[i] = sample_bilinear(l.u_plane, l.c_stride, l.c_step, cx, cy, max_cx, max_cy);
+                worker->v[i] = sample_bilinear(l.v_plane, l.c_stride, l.c_step, cx, cy, max_cx, max_cy);
+            } else {
+                int xi = x >> CVT_FIX_SHIFT;
+                int yi = y >> CVT_FIX_SHIFT;
+                int c_pos = (yi >> l.v_shift) * l.c_stride + (xi >> 1) * l.c_step;
+                worker->luma[i] = l.y_plane[yi * l.y_stride + xi * l.y_step];
+                worker->u[i] = l.u_plane[c_pos];
+                worker->v[i] = l.v_plane[c_pos];
             }
         }
+        // Chroma is already at output resolution
+        int32_t *cr = worker->chroma;
+        int32_t *cg = cr + out_width;
+        int32_t *cb = cg + out_width;
+        for (int i = 0; i < out_width; i++) {
+            int32_t du = worker->u[i] - 128;
+            int32_t dv = worker->v[i] - 128;
+            cr[i] = convert->coef.v_r * dv + CVT_FIX_ROUND;
+            cg[i] = CVT_FIX_ROUND - convert->coef.u_g * du - convert->coef.v_g * dv;
+            cb[i] = convert->coef.u_b * du + CVT_FIX_ROUND;
+        }
+        write_rgb_row(convert, worker->luma, worker->chroma, convert->dst + row * out_width * out_bytes, out_width);
+    }
+}
+
+static void convert_worker_thread(void *arg)
+{
+    convert_worker_t *worker = (convert_worker_t *)arg;
+    color_convert_t *convert = worker->convert;
+    while (1) {
+        media_lib_sema_lock(worker->start, MEDIA_LIB_MAX_LOCK_TIME);
+        if (convert->quit) {
+            break;
+        }
+        if (convert->fused) {
+            convert_band_fused(convert, worker);
+        } else {
+            convert_band(convert, worker);
+        }
+        media_lib_sema_unlock(worker->done);
+    }
+    media_lib_sema_unlock(worker->done);
+    media_lib_thread_destroy(NULL);
+}
+
+static int create_workers(color_convert_t *convert, int worker_num)
+{
+    if (worker_num > CVT_MAX_WORKER) {
+        worker_num = CVT_MAX_WORKER;
+    }
+    if (worker_num < 1) {
+        worker_num = 1;
+    }
+    // Each band need at least 2 rows
+    if (worker_num > (convert->out_height + 1) / 2) {
+        worker_num = (convert->out_height + 1) / 2;
+    }
+    // Scratch width follow the wider one of source and output
+    int width = convert->width > convert->out_width ? convert->width : convert->out_width;
+    // Worker 0 runs in caller thread
+    for (int i = 0; i < worker_num; i++) {
+        convert_worker_t *worker = &convert->worker[i];
+        worker->convert = convert;
+        // Chroma for 3 components followed by gathered luma, sampled U and V
+        worker->chroma = (int32_t *)media_lib_malloc(sizeof(int32_t) * 3 * width + 3 * width);
+        if (worker->chroma == NULL) {
+            return ESP_MEDIA_ERR_NO_MEM;
+        }
+        worker->luma = (uint8_t *)(worker->chroma + 3 * width);
+        worker->u = worker->luma + width;
+        worker->v = worker->u + width;
+        if (i == 0) {
+            convert->worker_num++;
+            continue;
+        }
+        if (media_lib_sema_create(&worker->start) != 0 || media_lib_sema_create(&worker->done) != 0) {
+            return ESP_MEDIA_ERR_NO_MEM;
+        }
+        if (media_lib_thread_create_from_scheduler(&worker->thread, "ClrCvt", convert_worker_thread, worker) != 0) {
+            ESP_LOGE(TAG, "Fail to create convert worker %d", i);
+            return ESP_MEDIA_ERR_FAIL;
+        }
+        convert->worker_num++;
+    }
+    // Split rows in even bands
+    int pairs = (convert->out_height + 1) / 2;
+    for (int i = 0; i < convert->worker_num; i++) {
+        convert->worker[i].row_start = pairs * i / convert->worker_num * 2;
+        convert->worker[i].row_end = pairs * (i + 1) / convert->worker_num * 2;
+        if (convert->worker[i].row_end > convert->out_height) {
+            convert->worker[i].row_end = convert->out_height;
+        }
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
+static void destroy_workers(color_convert_t *convert)
+{
+    convert->quit = true;
+    for (int i = 1; i < CVT_MAX_WORKER; i++) {
+        convert_worker_t *worker = &convert->worker[i];
+        if (worker->thread) {
+            media_lib_sema_unlock(worker->start);
+            media_lib_sema_lock(worker->done, MEDIA_LIB_MAX_LOCK_TIME);
+            worker->thread = NULL;
+        }
+        if (worker->start) {
+            media_lib_sema_destroy(worker->start);
+            worker->start = NULL;
+        }
+        if (worker->done) {
+            media_lib_sema_destroy(worker->done);
+            worker->done = NULL;
+        }
+    }
+    for (int i = 0; i < CVT_MAX_WORKER; i++) {
+        if (convert->worker[i].chroma) {
+            media_lib_free(convert->worker[i].chroma);
+            convert->worker[i].chroma = NULL;
+        }
     }
-    return 0;
 }
 
 int convert_table_get_image_size(av_render_video_frame_type_t fmt, int width, int height)
 {
+    int cw = (width + 1) >> 1;
     switch (fmt) {
         case AV_RENDER_VIDEO_RAW_TYPE_YUV420:
-            return width * height * 3 / 2;
+        case AV_RENDER_VIDEO_RAW_TYPE_NV12:
+        case AV_RENDER_VIDEO_RAW_TYPE_NV21:
+            return width * height + cw * ((height + 1) >> 1) * 2;
+        case AV_RENDER_VIDEO_RAW_TYPE_YUV422:
+            return width * height + cw * height * 2;
+        case AV_RENDER_VIDEO_RAW_TYPE_YUYV:
+        case AV_RENDER_VIDEO_RAW_TYPE_UYVY:
+            return cw * 4 * height;
         case AV_RENDER_VIDEO_RAW_TYPE_RGB565:
         case AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE:
             return width * height * 2;
+        case AV_RENDER_VIDEO_RAW_TYPE_RGB888:
+            return width * height * 3;
         default:
             ESP_LOGE(TAG, "Not supported format %d", fmt);
             break;
@@ -118,8 +478,107 @@ int convert_table_get_image_size(av_render_video_frame_type_t fmt, int width, in
     return 0;
 }
 
+bool convert_table_is_supported(av_render_video_frame_type_t from, av_render_video_frame_type_t to)
+{
+    switch (from) {
+        case AV_RENDER_VIDEO_RAW_TYPE_YUV420:
+        case AV_RENDER_VIDEO_RAW_TYPE_NV12:
+        case AV_RENDER_VIDEO_RAW_TYPE_NV21:
+        case AV_RENDER_VIDEO_RAW_TYPE_YUV422:
+        case AV_RENDER_VIDEO_RAW_TYPE_YUYV:
+        case AV_RENDER_VIDEO_RAW_TYPE_UYVY:
+            break;
+        default:
+            return false;
+    }
+    return (to == AV_RENDER_VIDEO_RAW_TYPE_RGB565 || to == AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE ||
+            to == AV_RENDER_VIDEO_RAW_TYPE_RGB888);
+}
+
+void convert_table_get_output_size(color_convert_cfg_t *cfg, int *width, int *height)
+{
+    av_render_video_transform_t *transform = &cfg->transform;
+    bool transpose = (transform->rotate == AV_RENDER_VIDEO_ROTATE_90 || transform->rotate == AV_RENDER_VIDEO_ROTATE_270);
+    *width = transform->width ? transform->width : (transpose ? cfg->height : cfg->width);
+    *height = transform->height ? transform->height : (transpose ? cfg->width : cfg->height);
+}
+
+static int32_t *create_map(int out_len, int src_len, bool reverse, bool bilinear)
+{
+    int32_t *map = (int32_t *)media_lib_malloc(out_len * sizeof(int32_t));
+    if (map == NULL) {
+        return NULL;
+    }
+    // Align pixel centers: source position is (k + 0.5) * src_len / out_len - 0.5
+    int64_t max_pos = (int64_t)(src_len - 1) << CVT_FIX_SHIFT;
+    for (int i = 0; i < out_len; i++) {
+        int k = reverse ? out_len - 1 - i : i;
+        int64_t pos;
+        if (bilinear) {
+            pos = ((int64_t)(2 * k + 1) * src_len << CVT_FIX_SHIFT) / (2 * out_len) - CVT_FIX_ROUND;
+            pos = pos < 0 ? 0 : pos > max_pos ? max_pos : pos;
+        } else {
+            pos = (int64_t)((2 * k + 1) * (int64_t)src_len / (2 * out_len)) << CVT_FIX_SHIFT;
+        }
+        map[i] = (int32_t)pos;
+    }
+    return map;
+}
+
+static int init_transform(color_convert_t *convert, color_convert_cfg_t *cfg)
+{
+    av_render_video_transform_t *transform = &cfg->transform;
+    convert_table_get_output_size(cfg, &convert->out_width, &convert->out_height);
+    convert->transpose = (transform->rotate == AV_RENDER_VIDEO_ROTATE_90 || transform->rotate == AV_RENDER_VIDEO_ROTATE_270);
+    int map_w = convert->transpose ? convert->out_height : convert->out_width;
+    int map_h = convert->transpose ? convert->out_width : convert->out_height;
+    if (transform->rotate == AV_RENDER_VIDEO_ROTATE_NONE && transform->mirror == false &&
+        map_w == convert->width && map_h == convert->height) {
+        return ESP_MEDIA_ERR_OK;
+    }
+    convert->fused = true;
+    convert->bilinear = (transform->scale == AV_RENDER_VIDEO_SCALE_BILINEAR);
+    // Map output column and row to source coordinate in Q16, for 90 and 270 output column goes along source height
+    bool col_reverse = false, row_reverse = false;
+    switch (transform->rotate) {
+        default:
+        case AV_RENDER_VIDEO_ROTATE_NONE:
+            col_reverse = transform->mirror;
+            break;
+        case AV_RENDER_VIDEO_ROTATE_90:
+            col_reverse = true;
+            row_reverse = transform->mirror;
+            break;
+        case AV_RENDER_VIDEO_ROTATE_180:
+            col_reverse = !transform->mirror;
+            row_reverse = true;
+            break;
+        case AV_RENDER_VIDEO_ROTATE_270:
+            row_reverse = !transform->mirror;
+            break;
+    }
+    if (convert->transpose) {
+        convert->col_map = create_map(convert->out_width, convert->height, col_reverse, convert->bilinear);
+        convert->row_map = create_map(convert->out_height, convert->width, row_reverse, convert->bilinear);
+    } else {
+        convert->col_map = create_map(convert->out_width, convert->width, col_reverse, convert->bilinear);
+        convert->row_map = create_map(convert->out_height, convert->height, row_reverse, convert->bilinear);
+    }
+    if (convert->col_map == NULL || convert->row_map == NULL) {
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    return ESP_MEDIA_ERR_OK;
+}
+
 color_convert_table_t init_convert_table(color_convert_cfg_t *cfg)
 {
+    if (cfg == NULL || cfg->width <= 0 || cfg->height <= 0) {
+        return NULL;
+    }
+    if (convert_table_is_supported(cfg->from, cfg->to) == false) {
+        ESP_LOGE(TAG, "Not supported convert from %d to %d", cfg->from, cfg->to);
+        return NULL;
+    }
     color_convert_t *convert = (color_convert_t *)calloc(1, sizeof(color_convert_t));
     do {
         if (convert == NULL) {
@@ -129,99 +588,72 @@ color_convert_table_t init_convert_table(color_convert_cfg_t *cfg)
         convert->to = cfg->to;
         convert->width = cfg->width;
         convert->height = cfg->height;
+        convert->chroma_width = (cfg->width + 1) >> 1;
+        init_coef(&convert->coef, cfg->matrix, cfg->full_range);
+        if (init_transform(convert, cfg) != ESP_MEDIA_ERR_OK) {
+            break;
+        }
 #if CONFIG_IDF_TARGET_ESP32P4
-        if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565) {
+        // Optimized library only support BT.601 limited range without transform
+        if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565 &&
+            cfg->matrix == COLOR_CONVERT_MATRIX_BT601 && cfg->full_range == false && convert->fused == false) {
+            convert->use_hw = true;
             return (color_convert_table_t)convert;
         }
 #endif
-        int table_size = get_table_size(cfg->from, cfg->to);
-        if (table_size) {
-            convert->table = (uint8_t *)malloc(table_size);
-            if (convert->table == NULL) {
-                break;
-            }
+        if (create_workers(convert, cfg->worker_num) != ESP_MEDIA_ERR_OK) {
+            break;
         }
-        init_table(convert);
         return (color_convert_table_t)convert;
     } while (0);
     deinit_convert_table(convert);
     return NULL;
 }
 
-static void yuv420_to_rgb565(color_convert_t *convert, uint8_t *src, uint8_t *dst)
-{
-    uint8_t *y_plane = src;
-    uint8_t *u_plane = src + (convert->width * convert->height);
-    uint8_t *v_plane = src + (convert->width * convert->height * 5 / 4);
-    int y_pos = 0, u_pos = 0, rgb_idx = 0;
-    uint16_t *rgb565 = (uint16_t *)dst;
-    uint16_t *table16 = (uint16_t *)convert->table;
-    for (int i = 0; i < convert->height; i++) {
-        for (int j = 0; j < convert->width; j += 2) {
-            int y = y_plane[y_pos];
-            int u = u_plane[u_pos];
-            int v = v_plane[u_pos];
-            int y_idx = (y >> 2) << 10;
-            int uv_idx = ((u >> 3) << 5) + (v >> 3);
-
-            rgb565[rgb_idx++] = table16[y_idx + uv_idx];
-
-            y = y_plane[y_pos + 1];
-            y_idx = (y >> 2) << 10;
-            rgb565[rgb_idx++] = table16[y_idx + uv_idx];
-            y_pos += 2;
-            u_pos++;
-        }
-        // odd line not increase
-        if ((i & 1) == 0) {
-            u_pos -= convert->width >> 1;
-        }
-    }
-}
-
 int convert_color(color_convert_table_t table, uint8_t *src, int src_size, uint8_t *dst, int dst_size)
 {
     color_convert_t *convert = (color_convert_t *)table;
-    if (convert->from == AV_RENDER_VIDEO_RAW_TYPE_YUV420 && convert->to == AV_RENDER_VIDEO_RAW_TYPE_RGB565) {
+    if (convert == NULL || src == NULL || dst == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    int src_need = convert_table_get_image_size(convert->from, convert->width, convert->height);
+    int dst_need = convert_table_get_image_size(convert->to, convert->out_width, convert->out_height);
+    if (src_size < src_need || dst_size < dst_need) {
+        ESP_LOGE(TAG, "Size mismatch src %d need %d dst %d need %d", src_size, src_need, dst_size, dst_need);
+        return ESP_MEDIA_ERR_INVALID_SIZE;
+    }
 #if CONFIG_IDF_TARGET_ESP32P4
+    if (convert->use_hw) {
         i420_to_rgb565le(src, dst, convert->width, convert->height);
-        return 0;
+        return ESP_MEDIA_ERR_OK;
+    }
 #endif
+    convert->src = src;
+    convert->dst = dst;
+    for (int i = 1; i < convert->worker_num; i++) {
+        media_lib_sema_unlock(convert->worker[i].start);
     }
-    
-    switch (convert->from) {
-        case AV_RENDER_VIDEO_RAW_TYPE_YUV420: {
-            int src_need = convert->width * convert->height * 3 / 2;
-            int dst_need = convert->width * convert->height * 2;
-            if (src_size != src_need || dst_size < dst_need) {
-                ESP_LOGE(TAG, "size dismatch");
-                return -1;
-            }
-            switch (convert->to) {
-                case AV_RENDER_VIDEO_RAW_TYPE_RGB565:
-                case AV_RENDER_VIDEO_RAW_TYPE_RGB565_BE:
-                    yuv420_to_rgb565(convert, src, dst);
-                    break;
-                default:
-                    ESP_LOGE(TAG, "Bad format to %d", convert->to);
-                    return -1;
-            }
-        } break;
-        default:
-            ESP_LOGE(TAG, "Bad format from %d", convert->from);
-            *(int *)0 = 0;
-            return -1;
+    if (convert->fused) {
+        convert_band_fused(convert, &convert->worker[0]);
+    } else {
+        convert_band(convert, &convert->worker[0]);
     }
-    return 0;
+    for (int i = 1; i < convert->worker_num; i++) {
+        media_lib_sema_lock(convert->worker[i].done, MEDIA_LIB_MAX_LOCK_TIME);
+    }
+    return ESP_MEDIA_ERR_OK;
 }
 
 void deinit_convert_table(color_convert_table_t t)
 {
     color_convert_t *convert = (color_convert_t *)t;
     if (convert) {
-        if (convert->table) {
-            free(convert->table);
-            convert->table = NULL;
+        destroy_workers(convert);
+        if (convert->col_map) {
+            media_lib_free(convert->col_map);
+        }
+        if (convert->row_map) {
+            media_lib_free(convert->row_map);
         }
         free(convert);
     }
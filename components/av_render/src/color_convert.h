@@ -29,15 +29,32 @@
 
 typedef void *color_convert_table_t;
 
+typedef enum {
+    COLOR_CONVERT_MATRIX_BT601 = 0, /*!< ITU-R BT.601, used by SD video and JPEG */
+    COLOR_CONVERT_MATRIX_BT709,     /*!< ITU-R BT.709, used by HD video */
+} color_convert_matrix_t;
+
 typedef struct {
     av_render_video_frame_type_t from;
     av_render_video_frame_type_t to;
     int                          width;
     int                          height;
+    color_convert_matrix_t       matrix;     /*!< YUV to RGB matrix */
+    bool                         full_range; /*!< YUV use full range (0-255) other than limited range (16-235) */
+    uint8_t                      worker_num; /*!< Number of threads to convert row bands, 0 or 1 convert in caller only */
+    av_render_video_transform_t  transform;  /*!< Scale, rotate and mirror done in the same pass */
 } color_convert_cfg_t;
 
+/* Support YUV420, NV12, NV21, YUV422 planar, YUYV and UYVY to RGB565, RGB565_BE and RGB888
+ * Unsupported pair makes `init_convert_table` return NULL
+ */
+bool convert_table_is_supported(av_render_video_frame_type_t from, av_render_video_frame_type_t to);
+
 int convert_table_get_image_size(av_render_video_frame_type_t fmt, int width, int height);
 
+/* Get output resolution after transform */
+void convert_table_get_output_size(color_convert_cfg_t *cfg, int *width, int *height);
+
 color_convert_table_t init_convert_table(color_convert_cfg_t *cfg);
 
 int convert_color(color_convert_table_t table, uint8_t *src, int src_size, uint8_t *dst, int dst_size);
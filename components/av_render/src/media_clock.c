@@ -0,0 +1,282 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdbool.h>
+#include "media_clock.h"
+#include "media_lib_os.h"
+
+#define CLOCK_DEFAULT_KP        (0.14f) /* Natural frequency 0.1 rad/s with damping 0.7 */
+#define CLOCK_DEFAULT_KI        (0.01f)
+#define CLOCK_DEFAULT_RESYNC_MS (200)
+#define CLOCK_DEFAULT_MAX_DRIFT (2000)
+#define CLOCK_DEFAULT_HOLD_MS   (100)
+#define CLOCK_MAX_SLEW          (0.005f) /* Limit of phase correction rate */
+#define CLOCK_MAX_SYNC_GAP_MS   (1000)
+
+struct media_clock_t {
+    media_clock_cfg_t        cfg;
+    media_lib_mutex_handle_t lock;
+    bool                     started;
+    bool                     paused;
+    bool                     mastered;  /* Master sample received since start */
+    uint32_t                 base_time;
+    int64_t                  base_us;   /* Clock position at base time */
+    uint32_t                 last_sync;
+    float                    speed;
+    float                    drift;
+    float                    slew;
+    int32_t                  offset_ms;
+    uint32_t                 resync_num;
+};
+
+static float clamp_float(float v, float limit)
+{
+    return v > limit ? limit : (v < -limit ? -limit : v);
+}
+
+static int64_t clock_at(struct media_clock_t *c, uint32_t now)
+{
+    if (c->paused) {
+        return c->base_us;
+    }
+    int32_t elapse_ms = (int32_t)(now - c->base_time);
+    if (c->mastered) {
+        int32_t limit = (int32_t)(c->last_sync + c->cfg.hold_ms - c->base_time);
+        if (elapse_ms > limit) {
+            elapse_ms = limit;
+        }
+    }
+    int64_t elapse = (int64_t)elapse_ms * 1000;
+    float rate = c->speed * (1.0f + c->drift + c->slew);
+    // Only deviation goes through float so that long elapse keeps precision
+    return c->base_us + elapse + (int64_t)((float)elapse * (rate - 1.0f));
+}
+
+static void clock_rebase(struct media_clock_t *c, uint32_t now)
+{
+    c->base_us = clock_at(c, now);
+    c->base_time = now;
+}
+
+static void clock_start(struct media_clock_t *c, uint32_t now, uint32_t pts)
+{
+    c->base_us = (int64_t)pts * 1000;
+    c->base_time = now;
+    c->last_sync = now;
+    c->slew = 0;
+    c->offset_ms = 0;
+    c->mastered = false;
+    c->started = true;
+}
+
+media_clock_handle_t media_clock_open(media_clock_cfg_t *cfg)
+{
+    struct media_clock_t *c = (struct media_clock_t *)media_lib_calloc(1, sizeof(struct media_clock_t));
+    if (c == NULL) {
+        return NULL;
+    }
+    if (cfg) {
+        c->cfg = *cfg;
+    }
+    if (c->cfg.kp <= 0) {
+        c->cfg.kp = CLOCK_DEFAULT_KP;
+    }
+    if (c->cfg.ki <= 0) {
+        c->cfg.ki = CLOCK_DEFAULT_KI;
+    }
+    if (c->cfg.resync_ms == 0) {
+        c->cfg.resync_ms = CLOCK_DEFAULT_RESYNC_MS;
+    }
+    if (c->cfg.max_drift_ppm == 0) {
+        c->cfg.max_drift_ppm = CLOCK_DEFAULT_MAX_DRIFT;
+    }
+    if (c->cfg.hold_ms == 0) {
+        c->cfg.hold_ms = CLOCK_DEFAULT_HOLD_MS;
+    }
+    c->speed = 1.0f;
+    media_lib_mutex_create(&c->lock);
+    if (c->lock == NULL) {
+        media_lib_free(c);
+        return NULL;
+    }
+    return c;
+}
+
+void media_clock_start(media_clock_handle_t h, uint32_t now, uint32_t pts)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL) {
+        return;
+    }
+    media_lib_mutex_lock(c->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    clock_start(c, now, pts);
+    media_lib_mutex_unlock(c->lock);
+}
+
+void media_clock_sync(media_clock_handle_t h, uint32_t now, uint32_t pts)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL) {
+        return;
+    }
+    media_lib_mutex_lock(c->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (c->started == false) {
+        clock_start(c, now, pts);
+    } else if (c->paused == false) {
+        int64_t error_us = (int64_t)pts * 1000 - clock_at(c, now);
+        c->offset_ms = (int32_t)(error_us / 1000);
+        if (c->mastered && (int32_t)(now - c->last_sync) > c->cfg.hold_ms) {
+            // Master come back after hold, continue from it
+            c->base_us = (int64_t)pts * 1000;
+            c->base_time = now;
+            c->slew = 0;
+        } else if (c->offset_ms > c->cfg.resync_ms || c->offset_ms < -c->cfg.resync_ms) {
+            // Master jumped for seek or underrun, follow it directly
+            c->base_us = (int64_t)pts * 1000;
+            c->base_time = now;
+            c->slew = 0;
+            c->resync_num++;
+        } else {
+            float error = (float)error_us / 1000000.0f;
+            uint32_t gap = now - c->last_sync;
+            float dt = (gap > CLOCK_MAX_SYNC_GAP_MS ? CLOCK_MAX_SYNC_GAP_MS : gap) / 1000.0f;
+            clock_rebase(c, now);
+            c->drift = clamp_float(c->drift + c->cfg.ki * error * dt, c->cfg.max_drift_ppm / 1000000.0f);
+            c->slew = clamp_float(c->cfg.kp * error, CLOCK_MAX_SLEW);
+        }
+        c->last_sync = now;
+    }
+    c->mastered = true;
+    media_lib_mutex_unlock(c->lock);
+}
+
+uint32_t media_clock_get(media_clock_handle_t h, uint32_t now)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL) {
+        return 0;
+    }
+    media_lib_mutex_lock(c->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    int64_t pos = c->started ? clock_at(c, now) : 0;
+    media_lib_mutex_unlock(c->lock);
+    return pos > 0 ? (uint32_t)(pos / 1000) : 0;
+}
+
+void media_clock_set_speed(media_clock_handle_t h, uint32_t now, float speed)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL || speed <= 0) {
+        return;
+    }
+    media_lib_mutex_lock(c->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (c->started) {
+        clock_rebase(c, now);
+    }
+    c->speed = speed;
+    media_lib_mutex_unlock(c->lock);
+}
+
+void media_clock_pause(media_clock_handle_t h, uint32_t now, bool pause)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL) {
+        return;
+    }
+    media_lib_mutex_lock(c->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    if (pause && c->paused == false) {
+        clock_rebase(c, now);
+        c->paused = true;
+    } else if (pause == false && c->paused) {
+        c->base_time = now;
+        c->last_sync = now;
+        c->paused = false;
+    }
+    media_lib_mutex_unlock(c->lock);
+}
+
+float media_clock_get_rate(media_clock_handle_t h)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL || c->paused) {
+        return 0;
+    }
+    return c->speed * (1.0f + c->drift + c->slew);
+}
+
+bool media_clock_started(media_clock_handle_t h)
+{
+    struct media_clock_t *c = h;
+    return c ? c->started : false;
+}
+
+void media_clock_get_stats(media_clock_handle_t h, media_clock_stats_t *stats)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL || stats == NULL) {
+        return;
+    }
+    media_lib_mutex_lock(c->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    stats->started = c->started;
+    stats->offset_ms = c->offset_ms;
+    stats->drift_ppm = (int32_t)(c->drift * 1000000.0f);
+    stats->resync_num = c->resync_num;
+    media_lib_mutex_unlock(c->lock);
+}
+
+void media_clock_stop(media_clock_handle_t h)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL) {
+        return;
+    }
+    media_lib_mutex_lock(c->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    c->started = false;
+    c->paused = false;
+    media_lib_mutex_unlock(c->lock);
+}
+
+void media_clock_reset(media_clock_handle_t h)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL) {
+        return;
+    }
+    media_lib_mutex_lock(c->lock, MEDIA_LIB_MAX_LOCK_TIME);
+    c->started = false;
+    c->paused = false;
+    c->drift = 0;
+    c->slew = 0;
+    c->offset_ms = 0;
+    media_lib_mutex_unlock(c->lock);
+}
+
+void media_clock_close(media_clock_handle_t h)
+{
+    struct media_clock_t *c = h;
+    if (c == NULL) {
+        return;
+    }
+    media_lib_mutex_destroy(c->lock);
+    media_lib_free(c);
+}
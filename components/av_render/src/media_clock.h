@@ -0,0 +1,91 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct media_clock_t *media_clock_handle_t;
+
+typedef struct {
+    float    kp;            /*!< Rate correction per second of phase error, 0 use default */
+    float    ki;            /*!< Drift correction per second squared of phase error, 0 use default */
+    uint16_t resync_ms;     /*!< Jump to master when phase error exceed it, 0 use 200 */
+    uint16_t max_drift_ppm; /*!< Limit of drift estimation, 0 use 2000 */
+    uint16_t hold_ms;       /*!< Stop running when master not updated for it, 0 use 100 */
+} media_clock_cfg_t;
+
+typedef struct {
+    bool     started;    /*!< Clock is started */
+    int32_t  offset_ms;  /*!< Last phase error, master minus clock */
+    int32_t  drift_ppm;  /*!< Estimated master drift against system clock */
+    uint32_t resync_num; /*!< Times clock jumped to master */
+} media_clock_stats_t;
+
+/* Media clock
+ * Runs from system time at nominal speed and is disciplined by master position samples
+ * through PI control, proportional part pulls phase and integral part learns drift so that
+ * clock is smooth between coarse samples. When master stop updating clock holds and
+ * jump to master when it comes back, so that followers wait instead of running ahead
+ * Without samples it is a plain system time clock, all time and PTS are in milliseconds
+ * Clock can be read and updated from different threads
+ */
+media_clock_handle_t media_clock_open(media_clock_cfg_t *cfg);
+
+/* Start clock from `pts` at system time `now`, learned drift is kept */
+void media_clock_start(media_clock_handle_t h, uint32_t now, uint32_t pts);
+
+/* Feed master position `pts` sampled at `now`, start clock if not started */
+void media_clock_sync(media_clock_handle_t h, uint32_t now, uint32_t pts);
+
+uint32_t media_clock_get(media_clock_handle_t h, uint32_t now);
+
+/* Nominal speed of master, such as play speed and time stretch */
+void media_clock_set_speed(media_clock_handle_t h, uint32_t now, float speed);
+
+void media_clock_pause(media_clock_handle_t h, uint32_t now, bool pause);
+
+/* Clock rate against system time including speed and correction */
+float media_clock_get_rate(media_clock_handle_t h);
+
+bool media_clock_started(media_clock_handle_t h);
+
+void media_clock_get_stats(media_clock_handle_t h, media_clock_stats_t *stats);
+
+/* Stop clock, learned drift is kept for next start */
+void media_clock_stop(media_clock_handle_t h);
+
+/* Stop clock and clear learned drift */
+void media_clock_reset(media_clock_handle_t h);
+
+void media_clock_close(media_clock_handle_t h);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,181 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "render_stats.h"
+#include "esp_timer.h"
+
+#define STATS_LINEAR_NUM (8)
+#define STATS_SUB_BITS   (2)
+
+#define _ATOMIC_LOAD(v)     __atomic_load_n(&(v), __ATOMIC_RELAXED)
+#define _ATOMIC_STORE(v, d) __atomic_store_n(&(v), d, __ATOMIC_RELAXED)
+#define _ATOMIC_INC(v)      __atomic_fetch_add(&(v), 1, __ATOMIC_RELAXED)
+
+uint32_t render_stats_now(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+static int get_bucket(uint32_t us)
+{
+    if (us < STATS_LINEAR_NUM) {
+        return (int)us;
+    }
+    int e = 31 - __builtin_clz(us);
+    int idx = STATS_LINEAR_NUM + ((e - 3) << STATS_SUB_BITS) + ((us >> (e - STATS_SUB_BITS)) & ((1 << STATS_SUB_BITS) - 1));
+    return idx < RENDER_STATS_BUCKET_NUM ? idx : RENDER_STATS_BUCKET_NUM - 1;
+}
+
+// Report middle of bucket, error within 1/8 of value
+static uint32_t get_bucket_value(int idx)
+{
+    if (idx < STATS_LINEAR_NUM) {
+        return (uint32_t)idx;
+    }
+    int e = ((idx - STATS_LINEAR_NUM) >> STATS_SUB_BITS) + 3;
+    uint32_t sub = (idx - STATS_LINEAR_NUM) & ((1 << STATS_SUB_BITS) - 1);
+    uint32_t low = ((1 << STATS_SUB_BITS) + sub) << (e - STATS_SUB_BITS);
+    return low + (1u << (e - STATS_SUB_BITS)) / 2;
+}
+
+void render_stats_arrive(render_stats_t *s, uint32_t pts, uint32_t now)
+{
+    if (s == NULL) {
+        return;
+    }
+    // Only data adding thread writes, readers may see slot being overwritten which just loses one sample
+    uint32_t pos = s->arrive_pos % RENDER_STATS_ARRIVE_NUM;
+    _ATOMIC_STORE(s->arrive[pos].time, now);
+    _ATOMIC_STORE(s->arrive[pos].pts, pts);
+    __atomic_store_n(&s->arrive_pos, s->arrive_pos + 1, __ATOMIC_RELEASE);
+}
+
+bool render_stats_since_arrive(render_stats_t *s, uint32_t pts, uint32_t now, uint32_t *elapse)
+{
+    if (s == NULL) {
+        return false;
+    }
+    uint32_t end = __atomic_load_n(&s->arrive_pos, __ATOMIC_ACQUIRE);
+    uint32_t num = end < RENDER_STATS_ARRIVE_NUM ? end : RENDER_STATS_ARRIVE_NUM;
+    // Search from newest, data split into frames carries later PTS than its packet
+    for (uint32_t i = 1; i <= num; i++) {
+        render_stats_arrive_t *a = &s->arrive[(end - i) % RENDER_STATS_ARRIVE_NUM];
+        if ((int32_t)(pts - _ATOMIC_LOAD(a->pts)) >= 0) {
+            *elapse = now - _ATOMIC_LOAD(a->time);
+            return true;
+        }
+    }
+    return false;
+}
+
+void render_stats_add(render_stats_t *s, av_render_stage_t stage, uint32_t us)
+{
+    if (s == NULL || stage >= AV_RENDER_STAGE_MAX) {
+        return;
+    }
+    _ATOMIC_INC(s->hist[stage][get_bucket(us)]);
+    uint32_t max = _ATOMIC_LOAD(s->max_us[stage]);
+    while (us > max) {
+        if (__atomic_compare_exchange_n(&s->max_us[stage], &max, us, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+}
+
+void render_stats_inc(uint32_t *counter)
+{
+    __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+void render_stats_drop(render_stats_t *s, av_render_drop_reason_t reason)
+{
+    if (s && reason < AV_RENDER_DROP_MAX) {
+        _ATOMIC_INC(s->drop_num[reason]);
+    }
+}
+
+static void get_stage_stats(render_stats_t *s, av_render_stage_t stage, av_render_stage_stats_t *out)
+{
+    uint32_t hist[RENDER_STATS_BUCKET_NUM];
+    uint32_t count = 0;
+    for (int i = 0; i < RENDER_STATS_BUCKET_NUM; i++) {
+        hist[i] = _ATOMIC_LOAD(s->hist[stage][i]);
+        count += hist[i];
+    }
+    memset(out, 0, sizeof(av_render_stage_stats_t));
+    out->count = count;
+    out->max_us = _ATOMIC_LOAD(s->max_us[stage]);
+    if (count == 0) {
+        return;
+    }
+    // Rank of each percentile rounded up
+    uint32_t rank[3] = { (count * 50 + 99) / 100, (count * 95 + 99) / 100, (count * 99 + 99) / 100 };
+    uint32_t *value[3] = { &out->p50_us, &out->p95_us, &out->p99_us };
+    uint32_t sum = 0;
+    int k = 0;
+    for (int i = 0; i < RENDER_STATS_BUCKET_NUM && k < 3; i++) {
+        sum += hist[i];
+        while (k < 3 && sum >= rank[k]) {
+            uint32_t v = get_bucket_value(i);
+            *value[k++] = (out->max_us && v > out->max_us) ? out->max_us : v;
+        }
+    }
+}
+
+void render_stats_get(render_stats_t *s, av_render_stream_stats_t *stats)
+{
+    memset(stats, 0, sizeof(av_render_stream_stats_t));
+    if (s == NULL) {
+        return;
+    }
+    stats->in_num = _ATOMIC_LOAD(s->in_num);
+    stats->decoded_num = _ATOMIC_LOAD(s->decoded_num);
+    stats->rendered_num = _ATOMIC_LOAD(s->rendered_num);
+    for (int i = 0; i < AV_RENDER_DROP_MAX; i++) {
+        stats->drop_num[i] = _ATOMIC_LOAD(s->drop_num[i]);
+    }
+    for (int i = 0; i < AV_RENDER_STAGE_MAX; i++) {
+        get_stage_stats(s, (av_render_stage_t)i, &stats->stage[i]);
+    }
+}
+
+void render_stats_reset(render_stats_t *s)
+{
+    if (s == NULL) {
+        return;
+    }
+    for (int i = 0; i < AV_RENDER_STAGE_MAX; i++) {
+        for (int j = 0; j < RENDER_STATS_BUCKET_NUM; j++) {
+            _ATOMIC_STORE(s->hist[i][j], 0);
+        }
+        _ATOMIC_STORE(s->max_us[i], 0);
+    }
+    _ATOMIC_STORE(s->in_num, 0);
+    _ATOMIC_STORE(s->decoded_num, 0);
+    _ATOMIC_STORE(s->rendered_num, 0);
+    for (int i = 0; i < AV_RENDER_DROP_MAX; i++) {
+        _ATOMIC_STORE(s->drop_num[i], 0);
+    }
+}
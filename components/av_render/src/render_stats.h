@@ -0,0 +1,79 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "av_render.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RENDER_STATS_BUCKET_NUM  (100) /* Log-linear buckets, 4 per octave, up to about 30s */
+#define RENDER_STATS_ARRIVE_NUM  (64)  /* Recent arrivals kept to match PTS of later stages */
+
+typedef struct {
+    uint32_t pts;
+    uint32_t time;
+} render_stats_arrive_t;
+
+/* Per stream statistics
+ * All updates are relaxed atomic so that pipeline threads never wait for each other or for reader
+ * Snapshot copy buckets without lock, so it may mix samples of a frame still in flight
+ */
+typedef struct {
+    uint32_t              hist[AV_RENDER_STAGE_MAX][RENDER_STATS_BUCKET_NUM];
+    uint32_t              max_us[AV_RENDER_STAGE_MAX];
+    uint32_t              in_num;
+    uint32_t              decoded_num;
+    uint32_t              rendered_num;
+    uint32_t              drop_num[AV_RENDER_DROP_MAX];
+    render_stats_arrive_t arrive[RENDER_STATS_ARRIVE_NUM];
+    uint32_t              arrive_pos;
+} render_stats_t;
+
+/* Time in microseconds, wrap around is handled by unsigned subtraction */
+uint32_t render_stats_now(void);
+
+/* Record data arrival, used as start point of queue wait and end-to-end latency */
+void render_stats_arrive(render_stats_t *s, uint32_t pts, uint32_t now);
+
+/* Elapsed time since arrival of data containing `pts`, return false if not found */
+bool render_stats_since_arrive(render_stats_t *s, uint32_t pts, uint32_t now, uint32_t *elapse);
+
+void render_stats_add(render_stats_t *s, av_render_stage_t stage, uint32_t us);
+
+void render_stats_inc(uint32_t *counter);
+
+void render_stats_drop(render_stats_t *s, av_render_drop_reason_t reason);
+
+void render_stats_get(render_stats_t *s, av_render_stream_stats_t *stats);
+
+void render_stats_reset(render_stats_t *s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,28 +28,35 @@
 #include "esp_log.h"
 #include "color_convert.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "esp_video_dec.h"
 #include "esp_video_codec_utils.h"
+#include "video_parser.h"
 
 #define TAG "VID_DEC"
 
 typedef struct {
     av_render_video_frame_info_t frame_info;
+    av_render_video_codec_t      codec;
     esp_video_dec_handle_t       dec_handle;
-    uint8_t                     *out_data;
-    uint8_t                     *frame_data;
-    int                          frame_data_size;
+    uint8_t                     *dec_data;
+    uint32_t                     dec_size;
     uint32_t                     out_size;
     bool                         header_parsed;
+    uint16_t                     header_width;
+    uint16_t                     header_height;
+    bool                         res_checked;
     vdec_frame_cb                frame_cb;
     void                        *ctx;
     esp_video_codec_pixel_fmt_t  dec_out_fmt;
     uint8_t                      out_frame_align;
     bool                         need_clr_convert;
+    bool                         full_range;
     color_convert_table_t        convert_table;
-    uint8_t                     *raw_buffer;
-    int                          raw_buffer_size;
+    uint32_t                     convert_us;
     vdec_fb_cb_cfg_t             fb_cb;
+    uint8_t                     *local_fb;
+    uint32_t                     local_fb_size;
 } vdec_t;
 
 static esp_video_codec_type_t get_codec_type(av_render_video_codec_t codec)
@@ -92,115 +99,198 @@ static av_render_video_frame_type_t get_frame_type(esp_video_codec_pixel_fmt_t f
     }
 }
 
+static int setup_output(vdec_t *vdec, uint16_t width, uint16_t height)
+{
+    esp_video_codec_frame_info_t frame_info = {
+        .res.width = width,
+        .res.height = height,
+    };
+    if (vdec->dec_data) {
+        esp_video_codec_free(vdec->dec_data);
+        vdec->dec_data = NULL;
+    }
+    if (vdec->convert_table) {
+        deinit_convert_table(vdec->convert_table);
+        vdec->convert_table = NULL;
+    }
+    vdec->frame_info.width = width;
+    vdec->frame_info.height = height;
+    ESP_LOGI(TAG, "Video resolution %dx%d fmt:%d", width, height, vdec->dec_out_fmt);
+    vdec->dec_size = esp_video_codec_get_image_size(vdec->dec_out_fmt, &frame_info.res);
+    vdec->out_size = vdec->dec_size;
+    if (vdec->need_clr_convert) {
+        // Decoder output is source of color convert, only convert output goes to frame buffer
+        vdec->dec_data = esp_video_codec_align_alloc(vdec->out_frame_align, vdec->dec_size, &vdec->dec_size);
+        if (vdec->dec_data == NULL) {
+            ESP_LOGE(TAG, "No memory for decode output size %d", (int)vdec->dec_size);
+            return ESP_MEDIA_ERR_NO_MEM;
+        }
+        color_convert_cfg_t color_cfg = {
+            .width = width,
+            .height = height,
+            .from = get_frame_type(vdec->dec_out_fmt),
+            .to = vdec->frame_info.type,
+            .full_range = vdec->full_range,
+        };
+        vdec->convert_table = init_convert_table(&color_cfg);
+        if (vdec->convert_table == NULL) {
+            ESP_LOGE(TAG, "No memory for color convert from %d to %d", color_cfg.from, color_cfg.to);
+            return ESP_MEDIA_ERR_NO_MEM;
+        }
+        vdec->out_size = esp_video_codec_get_image_size(get_out_fmt(vdec->frame_info.type), &frame_info.res);
+    }
+    vdec->header_parsed = true;
+    vdec->res_checked = false;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int parse_header(vdec_t *vdec, av_render_video_data_t *data, video_parser_info_t *info)
+{
+    switch (vdec->codec) {
+        case AV_RENDER_VIDEO_CODEC_H264:
+            return video_parse_h264(data->data, data->size, info);
+        case AV_RENDER_VIDEO_CODEC_MJPEG:
+            return video_parse_jpeg(data->data, data->size, info);
+        default:
+            return ESP_MEDIA_ERR_NOT_SUPPORT;
+    }
+}
+
+static int probe_header(vdec_t *vdec, esp_video_dec_in_frame_t *in_frame)
+{
+    // Let decoder report resolution by decoding into tiny buffer
+    uint32_t probe_size = 64;
+    uint8_t *probe_data = esp_video_codec_align_alloc(vdec->out_frame_align, probe_size, &probe_size);
+    if (probe_data == NULL) {
+        return ESP_MEDIA_ERR_NO_MEM;
+    }
+    esp_video_dec_out_frame_t decoded_frame = {
+        .data = probe_data,
+        .size = probe_size,
+    };
+    int ret = esp_video_dec_process(vdec->dec_handle, in_frame, &decoded_frame);
+    esp_video_codec_free(probe_data);
+    if (ret != ESP_VC_ERR_BUF_NOT_ENOUGH) {
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    esp_video_codec_frame_info_t frame_info = {};
+    ret = esp_video_dec_get_frame_info(vdec->dec_handle, &frame_info);
+    if (ret != ESP_VC_ERR_OK) {
+        return ESP_MEDIA_ERR_NOT_SUPPORT;
+    }
+    return setup_output(vdec, frame_info.res.width, frame_info.res.height);
+}
+
+static int check_header(vdec_t *vdec, av_render_video_data_t *data, esp_video_dec_in_frame_t *in_frame)
+{
+    video_parser_info_t info = {};
+    int ret = parse_header(vdec, data, &info);
+    if (ret == ESP_MEDIA_ERR_OK) {
+        // Only react to header change so that decoder adjusted resolution is kept
+        if (vdec->header_parsed && info.width == vdec->header_width && info.height == vdec->header_height) {
+            return ESP_MEDIA_ERR_OK;
+        }
+        if (vdec->header_parsed) {
+            ESP_LOGI(TAG, "Resolution change from %dx%d", vdec->frame_info.width, vdec->frame_info.height);
+        }
+        if (info.chroma != VIDEO_CHROMA_420 || info.bit_depth != 8) {
+            ESP_LOGW(TAG, "Stream profile %d chroma %d depth %d may not be supported", info.profile, info.chroma,
+                     info.bit_depth);
+        }
+        vdec->header_width = info.width;
+        vdec->header_height = info.height;
+        return setup_output(vdec, info.width, info.height);
+    }
+    if (vdec->header_parsed) {
+        return ESP_MEDIA_ERR_OK;
+    }
+    if (ret == ESP_MEDIA_ERR_NOT_FOUND && vdec->codec == AV_RENDER_VIDEO_CODEC_H264) {
+        // Nothing decodable before SPS
+        return ESP_MEDIA_ERR_NOT_FOUND;
+    }
+    return probe_header(vdec, in_frame);
+}
+
 static int do_decode(vdec_t *vdec, av_render_video_data_t *data, av_render_video_frame_t *out_frame)
 {
-    int ret = -1;
     esp_video_dec_in_frame_t in_frame = {
         .pts = data->pts,
         .data = data->data,
         .size = data->size,
     };
     esp_video_dec_out_frame_t decoded_frame = {};
-    if (vdec->header_parsed == false) {
-        vdec->out_size = 64;
-        vdec->out_data = esp_video_codec_align_alloc(vdec->out_frame_align, vdec->out_size, &vdec->out_size);
-        decoded_frame.data = vdec->out_data;
-        decoded_frame.size = vdec->out_size;
-        ret = esp_video_dec_process(vdec->dec_handle, &in_frame, &decoded_frame);
-        if (ret != ESP_VC_ERR_BUF_NOT_ENOUGH) {
-            return ESP_MEDIA_ERR_BAD_DATA;
+    int ret = check_header(vdec, data, &in_frame);
+    if (ret != ESP_MEDIA_ERR_OK) {
+        if (ret == ESP_MEDIA_ERR_NOT_FOUND) {
+            ESP_LOGD(TAG, "Skip frame before SPS");
+            return ESP_MEDIA_ERR_OK;
         }
-        esp_video_codec_free(vdec->out_data);
-        vdec->out_data = NULL;
-        esp_video_codec_frame_info_t frame_info = {};
-        ret = esp_video_dec_get_frame_info(vdec->dec_handle, &frame_info);
-        if (ret != ESP_VC_ERR_OK) {
-            return ESP_MEDIA_ERR_NOT_SUPPORT;
+        return ret;
+    }
+    vdec_fb_cb_cfg_t *fb_cb = &vdec->fb_cb;
+    for (int retry = 0; retry < 2; retry++) {
+        if (vdec->need_clr_convert) {
+            decoded_frame.data = vdec->dec_data;
+        } else {
+            decoded_frame.data = fb_cb->fb_fetch(vdec->out_frame_align, vdec->dec_size, fb_cb->ctx);
         }
-        vdec->frame_info.width = frame_info.res.width;
-        vdec->frame_info.height = frame_info.res.height;
-        ESP_LOGI(TAG, "Video resolution %dx%d fmt:%d", (int)frame_info.res.width, (int)frame_info.res.height, vdec->dec_out_fmt);
-        vdec->out_size = esp_video_codec_get_image_size(vdec->dec_out_fmt, &frame_info.res);
-        if ((vdec->frame_data == NULL && vdec->fb_cb.fb_fetch == NULL) || vdec->need_clr_convert) {
-            // TODO this middle buffer not needed if can get decoder output frame directly
-            vdec->out_data = esp_video_codec_align_alloc(vdec->out_frame_align, vdec->out_size, &vdec->out_size);
-            if (vdec->out_data == NULL) {
-                ESP_LOGE(TAG, "No memory for decode output size %d", (int)vdec->out_size);
-                return ESP_MEDIA_ERR_NO_MEM;
-            }
+        if (decoded_frame.data == NULL) {
+            return ESP_MEDIA_ERR_NO_MEM;
         }
-        if (vdec->need_clr_convert) {
-            color_convert_cfg_t color_cfg = {
-                .width = frame_info.res.width,
-                .height = frame_info.res.height,
-                .from = get_frame_type(vdec->dec_out_fmt),
-                .to = vdec->frame_info.type,
-            };
-            vdec->convert_table = init_convert_table(&color_cfg);
-            if (vdec->convert_table == NULL) {
-                ESP_LOGE(TAG, "No memory for color convert from %d to %d", color_cfg.from, color_cfg.to);
-                return -1;
-            }
-            vdec->raw_buffer_size = esp_video_codec_get_image_size(get_out_fmt(vdec->frame_info.type), &frame_info.res);
-            if (vdec->fb_cb.fb_fetch == NULL && vdec->raw_buffer == NULL) {
-                vdec->raw_buffer = (uint8_t *)malloc(vdec->raw_buffer_size);
-                if (vdec->raw_buffer == NULL) {
-                    ESP_LOGE(TAG, "Fail to allocate convert output");
-                    return ESP_MEDIA_ERR_NO_MEM;
-                }
-            }
+        decoded_frame.size = vdec->dec_size;
+        ret = esp_video_dec_process(vdec->dec_handle, &in_frame, &decoded_frame);
+        if (ret != ESP_VC_ERR_OK && vdec->need_clr_convert == false) {
+            fb_cb->fb_return(decoded_frame.data, true, fb_cb->ctx);
         }
-        vdec->header_parsed = true;
-    }
-    if (vdec->need_clr_convert == false) {
-        if (vdec->fb_cb.fb_fetch) {
-            decoded_frame.data = vdec->fb_cb.fb_fetch(vdec->out_frame_align, vdec->out_size, vdec->fb_cb.ctx);
-        } else {
-            decoded_frame.data = vdec->frame_data ? vdec->frame_data : vdec->out_data;
+        if (ret != ESP_VC_ERR_BUF_NOT_ENOUGH) {
+            break;
+        }
+        // Header missed by parser, take resolution from decoder and decode again
+        esp_video_codec_frame_info_t frame_info = {};
+        if (esp_video_dec_get_frame_info(vdec->dec_handle, &frame_info) != ESP_VC_ERR_OK ||
+            setup_output(vdec, frame_info.res.width, frame_info.res.height) != ESP_MEDIA_ERR_OK) {
+            break;
         }
-    } else {
-        decoded_frame.data = vdec->out_data;
     }
-    decoded_frame.size = vdec->out_size;
-    ret = esp_video_dec_process(vdec->dec_handle, &in_frame, &decoded_frame);
     if (ret != ESP_VC_ERR_OK) {
-        printf("Data size %d ", (int)data->size);
-#define CC(a) a[0], a[1], a[2], a[3]
-        printf("%02x %02x %02x %02x\n", CC(data->data));
-#define CC1(a, size) a[size - 4], a[size - 3], a[size - 2], a[size - 1]
-        printf("Tail %02x %02x %02x %02x\n", CC1(data->data, data->size));
-        ESP_LOGE(TAG, "Fail to decode data ret %d", ret);
-        if (vdec->fb_cb.fb_fetch && vdec->need_clr_convert == false) {
-            vdec->fb_cb.fb_return(decoded_frame.data, true, vdec->fb_cb.ctx);
-        }
+        ESP_LOGE(TAG, "Fail to decode data ret %d size %d", ret, (int)data->size);
         return ret;
     }
+    if (vdec->res_checked == false) {
+        // Decoder is final judge of output layout, drop this frame if it differs from header
+        vdec->res_checked = true;
+        esp_video_codec_frame_info_t frame_info = {};
+        if (esp_video_dec_get_frame_info(vdec->dec_handle, &frame_info) == ESP_VC_ERR_OK &&
+            (frame_info.res.width != vdec->frame_info.width || frame_info.res.height != vdec->frame_info.height)) {
+            ESP_LOGW(TAG, "Decoder output %dx%d differs from header", frame_info.res.width, frame_info.res.height);
+            if (vdec->need_clr_convert == false) {
+                fb_cb->fb_return(decoded_frame.data, true, fb_cb->ctx);
+            }
+            return setup_output(vdec, frame_info.res.width, frame_info.res.height);
+        }
+    }
     if (vdec->need_clr_convert == false) {
         out_frame->pts = data->pts;
         out_frame->data = decoded_frame.data;
-        out_frame->size = vdec->out_size;
+        out_frame->size = vdec->dec_size;
         return ESP_MEDIA_ERR_OK;
     }
-
-    uint8_t *out_data = vdec->frame_data ? vdec->frame_data : vdec->raw_buffer;
-    if (vdec->fb_cb.fb_fetch) {
-        out_data = vdec->fb_cb.fb_fetch(vdec->out_frame_align, vdec->raw_buffer_size, vdec->fb_cb.ctx);
-        if (out_data == NULL) {
-            return ESP_MEDIA_ERR_NO_MEM;
-        }
+    uint8_t *out_data = fb_cb->fb_fetch(vdec->out_frame_align, vdec->out_size, fb_cb->ctx);
+    if (out_data == NULL) {
+        return ESP_MEDIA_ERR_NO_MEM;
     }
+    int64_t start = esp_timer_get_time();
     ret = convert_color(vdec->convert_table, decoded_frame.data, decoded_frame.decoded_size,
-                        out_data, vdec->raw_buffer_size);
+                        out_data, vdec->out_size);
+    vdec->convert_us = (uint32_t)(esp_timer_get_time() - start);
     if (ret != 0) {
         ESP_LOGE(TAG, "Fail to convert color");
-        if (vdec->fb_cb.fb_fetch) {
-            vdec->fb_cb.fb_return(out_data, true, vdec->fb_cb.ctx);
-        }
+        fb_cb->fb_return(out_data, true, fb_cb->ctx);
         return ret;
     }
     out_frame->pts = decoded_frame.pts;
     out_frame->data = out_data;
-    out_frame->size = vdec->raw_buffer_size;
+    out_frame->size = vdec->out_size;
     return ESP_MEDIA_ERR_OK;
 }
 
@@ -249,6 +339,25 @@ int vdec_get_output_formats(av_render_video_codec_t codec, av_render_video_frame
     return ESP_MEDIA_ERR_OK;
 }
 
+static uint8_t *local_fb_fetch(int align, int size, void *ctx)
+{
+    // Used only when user does not lend frame buffer
+    vdec_t *vdec = (vdec_t *)ctx;
+    if (vdec->local_fb && vdec->local_fb_size < (uint32_t)size) {
+        esp_video_codec_free(vdec->local_fb);
+        vdec->local_fb = NULL;
+    }
+    if (vdec->local_fb == NULL) {
+        vdec->local_fb = esp_video_codec_align_alloc(align, size, &vdec->local_fb_size);
+    }
+    return vdec->local_fb;
+}
+
+static int local_fb_return(uint8_t *addr, bool drop, void *ctx)
+{
+    return ESP_MEDIA_ERR_OK;
+}
+
 vdec_handle_t vdec_open(vdec_cfg_t *cfg)
 {
     if (cfg == NULL) {
@@ -264,6 +373,12 @@ vdec_handle_t vdec_open(vdec_cfg_t *cfg)
     vdec->frame_info.fps = cfg->video_info.fps;
     vdec->frame_cb = cfg->frame_cb;
     vdec->ctx = cfg->ctx;
+    vdec->codec = cfg->video_info.codec;
+    vdec->fb_cb.fb_fetch = local_fb_fetch;
+    vdec->fb_cb.fb_return = local_fb_return;
+    vdec->fb_cb.ctx = vdec;
+    // JPEG use full range YUV
+    vdec->full_range = (cfg->video_info.codec == AV_RENDER_VIDEO_CODEC_MJPEG);
 
     av_render_video_frame_type_t output_type = cfg->out_type;
     if (output_type == AV_RENDER_VIDEO_RAW_TYPE_NONE) {
@@ -298,6 +413,10 @@ int vdec_set_fb_cb(vdec_handle_t h, vdec_fb_cb_cfg_t *cfg)
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
     vdec->fb_cb = *cfg;
+    if (vdec->local_fb) {
+        esp_video_codec_free(vdec->local_fb);
+        vdec->local_fb = NULL;
+    }
     return ESP_MEDIA_ERR_OK;
 }
 
@@ -311,28 +430,23 @@ int vdec_decode(vdec_handle_t h, av_render_video_data_t *data)
         .eos = data->eos,
         .pts = data->pts
     };
+    vdec->convert_us = 0;
     int ret = do_decode(vdec, data, &out_frame);
-    if (ret == 0 && vdec->frame_cb) {
-        vdec->header_parsed = true;
+    // No output when waiting for stream header
+    if (ret == 0 && out_frame.data && vdec->frame_cb) {
         vdec->frame_cb(&out_frame, vdec->ctx);
-        if (vdec->fb_cb.fb_fetch && out_frame.data) {
-            vdec->fb_cb.fb_return(out_frame.data, false, vdec->fb_cb.ctx);
-        }
+        vdec->fb_cb.fb_return(out_frame.data, false, vdec->fb_cb.ctx);
     }
     return ret;
 }
 
-int vdec_set_frame_buffer(vdec_handle_t h, av_render_frame_buffer_t *buffer)
+int vdec_get_convert_time(vdec_handle_t h, uint32_t *convert_us)
 {
     vdec_t *vdec = (vdec_t *)h;
-    if (vdec == NULL || buffer == NULL) {
+    if (vdec == NULL || convert_us == NULL) {
         return ESP_MEDIA_ERR_INVALID_ARG;
     }
-    vdec->frame_data = buffer->data;
-    // Notes make sure frame buffer size big than JPEG image size
-    if (buffer->size > 0) {
-        vdec->frame_data_size = buffer->size;
-    }
+    *convert_us = vdec->convert_us;
     return ESP_MEDIA_ERR_OK;
 }
 
@@ -359,17 +473,17 @@ int vdec_close(vdec_handle_t h)
         esp_video_dec_close(vdec->dec_handle);
         vdec->dec_handle = NULL;
     }
-    if (vdec->out_data) {
-        free(vdec->out_data);
-        vdec->out_data = NULL;
+    if (vdec->dec_data) {
+        esp_video_codec_free(vdec->dec_data);
+        vdec->dec_data = NULL;
     }
     if (vdec->convert_table) {
         deinit_convert_table(vdec->convert_table);
         vdec->convert_table = NULL;
     }
-    if (vdec->raw_buffer) {
-        free(vdec->raw_buffer);
-        vdec->raw_buffer = NULL;
+    if (vdec->local_fb) {
+        esp_video_codec_free(vdec->local_fb);
+        vdec->local_fb = NULL;
     }
     media_lib_free(vdec);
     return ESP_MEDIA_ERR_OK;
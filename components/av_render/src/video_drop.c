@@ -0,0 +1,131 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "video_drop.h"
+#include "video_parser.h"
+#include "media_lib_os.h"
+#include "esp_log.h"
+
+#define TAG "VID_DROP"
+
+#define VIDEO_KEY_REQUEST_INTERVAL_MS (1000) /* Request again if IDR still not received */
+
+struct video_drop_t {
+    bool               is_h264;
+    bool               wait_idr;
+    uint32_t           request_pts;
+    video_drop_stats_t stats;
+};
+
+video_drop_handle_t video_drop_open(bool is_h264)
+{
+    struct video_drop_t *d = (struct video_drop_t *)media_lib_calloc(1, sizeof(struct video_drop_t));
+    if (d == NULL) {
+        return NULL;
+    }
+    d->is_h264 = is_h264;
+    return d;
+}
+
+static void request_key_frame(struct video_drop_t *d, uint32_t pts, bool *key_request)
+{
+    d->request_pts = pts;
+    d->stats.key_request_num++;
+    *key_request = true;
+}
+
+video_drop_reason_t video_drop_check(video_drop_handle_t h, const uint8_t *data, int size, uint32_t pts,
+                                     video_drop_late_t late, bool *key_request)
+{
+    struct video_drop_t *d = h;
+    *key_request = false;
+    if (d == NULL) {
+        return late != VIDEO_DROP_LATE_NONE ? VIDEO_DROP_REASON_LATE : VIDEO_DROP_REASON_NONE;
+    }
+    if (d->is_h264 == false) {
+        if (late == VIDEO_DROP_LATE_NONE) {
+            return VIDEO_DROP_REASON_NONE;
+        }
+        d->stats.late_num++;
+        return VIDEO_DROP_REASON_LATE;
+    }
+    video_frame_kind_t kind = video_parse_h264_frame_kind(data, size);
+    if (d->wait_idr) {
+        if (kind != VIDEO_FRAME_KIND_IDR) {
+            d->stats.wait_idr_num++;
+            if ((int32_t)(pts - d->request_pts) >= VIDEO_KEY_REQUEST_INTERVAL_MS) {
+                request_key_frame(d, pts, key_request);
+            }
+            return VIDEO_DROP_REASON_WAIT_IDR;
+        }
+        ESP_LOGI(TAG, "IDR received after %d frames skipped", (int)d->stats.wait_idr_num);
+        d->wait_idr = false;
+    }
+    if (late == VIDEO_DROP_LATE_NONE) {
+        return VIDEO_DROP_REASON_NONE;
+    }
+    switch (kind) {
+        case VIDEO_FRAME_KIND_NON_REF:
+            d->stats.non_ref_num++;
+            return VIDEO_DROP_REASON_LATE;
+        case VIDEO_FRAME_KIND_REF:
+            if (late == VIDEO_DROP_LATE_FAR) {
+                // Later frames refer to this one, they are all broken until next IDR
+                ESP_LOGW(TAG, "Too late drop reference frame pts %d, skip until IDR", (int)pts);
+                d->wait_idr = true;
+                d->stats.wait_idr_num++;
+                request_key_frame(d, pts, key_request);
+                return VIDEO_DROP_REASON_WAIT_IDR;
+            }
+            return VIDEO_DROP_REASON_NONE;
+        default:
+            // IDR is where decoding recovers, parameter sets are needed later
+            return VIDEO_DROP_REASON_NONE;
+    }
+}
+
+void video_drop_reset(video_drop_handle_t h, bool is_h264)
+{
+    struct video_drop_t *d = h;
+    if (d) {
+        d->is_h264 = is_h264;
+        d->wait_idr = false;
+    }
+}
+
+void video_drop_get_stats(video_drop_handle_t h, video_drop_stats_t *stats)
+{
+    struct video_drop_t *d = h;
+    if (d == NULL || stats == NULL) {
+        return;
+    }
+    *stats = d->stats;
+}
+
+void video_drop_close(video_drop_handle_t h)
+{
+    if (h) {
+        media_lib_free(h);
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct video_drop_t *video_drop_handle_t;
+
+typedef enum {
+    VIDEO_DROP_LATE_NONE, /*!< Frame in time */
+    VIDEO_DROP_LATE,      /*!< Behind schedule, drop frames which no other frame refers to */
+    VIDEO_DROP_LATE_FAR,  /*!< Too far behind, reference frame can be dropped and skip until next IDR */
+} video_drop_late_t;
+
+typedef enum {
+    VIDEO_DROP_REASON_NONE,     /*!< Decode frame */
+    VIDEO_DROP_REASON_LATE,     /*!< Drop for late */
+    VIDEO_DROP_REASON_WAIT_IDR, /*!< Drop for reference lost, wait for next IDR */
+} video_drop_reason_t;
+
+typedef struct {
+    uint32_t late_num;        /*!< Independent frames (like MJPEG) dropped for late */
+    uint32_t non_ref_num;     /*!< H264 non-reference frames dropped for late */
+    uint32_t wait_idr_num;    /*!< H264 frames dropped while skipping until next IDR */
+    uint32_t key_request_num; /*!< Times key frame requested */
+} video_drop_stats_t;
+
+/* Reference aware drop policy of encoded video
+ * For H264 frames are classified from NAL type and nal_ref_idc, non-reference frames are dropped first
+ * Reference frame is only dropped when far behind, then all frames are skipped until next IDR
+ * so that no frame decoded from missing reference is rendered
+ * Other codecs are treated as independent frames
+ */
+video_drop_handle_t video_drop_open(bool is_h264);
+
+/* Return reason when frame should be dropped, `key_request` is set when key frame need to be requested from sender */
+video_drop_reason_t video_drop_check(video_drop_handle_t h, const uint8_t *data, int size, uint32_t pts,
+                                     video_drop_late_t late, bool *key_request);
+
+/* Start new stream, drop counters are kept */
+void video_drop_reset(video_drop_handle_t h, bool is_h264);
+
+void video_drop_get_stats(video_drop_handle_t h, video_drop_stats_t *stats);
+
+void video_drop_close(video_drop_handle_t h);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,452 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stddef.h>
+#include "video_parser.h"
+#include "media_lib_err.h"
+
+// Bigger image is taken as corrupted header
+#define VIDEO_MAX_SIZE         (8192)
+#define H264_NAL_SLICE         (1)
+#define H264_NAL_PARTITION_A   (2)
+#define H264_NAL_IDR           (5)
+#define H264_NAL_SPS           (7)
+#define H264_NAL_PPS           (8)
+#define H264_MAX_MB_NUM        (VIDEO_MAX_SIZE / 16)
+#define H264_MAX_SPS_ID        (31)
+#define H264_MAX_PPS_ID        (255)
+#define H264_MAX_BIT_DEPTH     (14)
+#define JPEG_MARKER_SOI        (0xD8)
+#define JPEG_MARKER_EOI        (0xD9)
+#define JPEG_MARKER_SOS        (0xDA)
+#define JPEG_MAX_COMPONENT     (4)
+
+/**
+ * Bit reader over RBSP, emulation prevention bytes are skipped on the fly
+ * Reading beyond end set `error` and return 0 so that caller only check once after parsing
+ */
+typedef struct {
+    const uint8_t *data;
+    int            size;
+    int            pos;
+    int            zeros;
+    uint8_t        cur;
+    uint8_t        bits;
+    bool           error;
+} bit_reader_t;
+
+static void reader_init(bit_reader_t *r, const uint8_t *data, int size)
+{
+    r->data = data;
+    r->size = size;
+    r->pos = 0;
+    r->zeros = 0;
+    r->cur = 0;
+    r->bits = 0;
+    r->error = (size <= 0);
+}
+
+static uint8_t reader_next_byte(bit_reader_t *r)
+{
+    if (r->pos >= r->size) {
+        r->error = true;
+        return 0;
+    }
+    uint8_t b = r->data[r->pos++];
+    if (r->zeros >= 2 && b == 3) {
+        r->zeros = 0;
+        if (r->pos >= r->size) {
+            r->error = true;
+            return 0;
+        }
+        b = r->data[r->pos++];
+    }
+    r->zeros = b ? 0 : r->zeros + 1;
+    return b;
+}
+
+static uint32_t read_bit(bit_reader_t *r)
+{
+    if (r->bits == 0) {
+        r->cur = reader_next_byte(r);
+        if (r->error) {
+            return 0;
+        }
+        r->bits = 8;
+    }
+    r->bits--;
+    return (r->cur >> r->bits) & 1;
+}
+
+static uint32_t read_bits(bit_reader_t *r, int n)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < n; i++) {
+        v = (v << 1) | read_bit(r);
+    }
+    return v;
+}
+
+static uint32_t read_ue(bit_reader_t *r)
+{
+    int zeros = 0;
+    while (read_bit(r) == 0) {
+        // Longer than 32 bits code is invalid, also stops on error
+        if (r->error || ++zeros > 31) {
+            r->error = true;
+            return 0;
+        }
+    }
+    return ((1u << zeros) - 1) + read_bits(r, zeros);
+}
+
+static int32_t read_se(bit_reader_t *r)
+{
+    uint32_t k = read_ue(r);
+    return (k & 1) ? (int32_t)((k + 1) >> 1) : -(int32_t)(k >> 1);
+}
+
+static bool h264_profile_has_chroma_info(uint8_t profile)
+{
+    switch (profile) {
+        case 100: case 110: case 122: case 244: case 44:
+        case 83: case 86: case 118: case 128: case 138:
+        case 139: case 134: case 135:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void h264_skip_scaling_list(bit_reader_t *r, int list_size)
+{
+    int last_scale = 8;
+    int next_scale = 8;
+    for (int i = 0; i < list_size && r->error == false; i++) {
+        if (next_scale != 0) {
+            int32_t delta = read_se(r);
+            if (delta < -128 || delta > 127) {
+                r->error = true;
+                return;
+            }
+            next_scale = (last_scale + delta + 256) % 256;
+        }
+        last_scale = next_scale ? next_scale : last_scale;
+    }
+}
+
+static int h264_parse_sps(const uint8_t *data, int size, video_parser_info_t *info, int *sps_id)
+{
+    bit_reader_t r;
+    reader_init(&r, data, size);
+    uint8_t profile = (uint8_t)read_bits(&r, 8);
+    read_bits(&r, 8); // constraint flags
+    uint8_t level = (uint8_t)read_bits(&r, 8);
+    uint32_t id = read_ue(&r);
+    uint32_t chroma_format = 1;
+    uint32_t bit_depth = 8;
+    if (h264_profile_has_chroma_info(profile)) {
+        chroma_format = read_ue(&r);
+        if (chroma_format > 3) {
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+        if (chroma_format == 3) {
+            read_bit(&r); // separate_colour_plane_flag
+        }
+        bit_depth = read_ue(&r) + 8;
+        uint32_t chroma_depth = read_ue(&r) + 8;
+        if (bit_depth > H264_MAX_BIT_DEPTH || chroma_depth > H264_MAX_BIT_DEPTH) {
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+        read_bit(&r); // qpprime_y_zero_transform_bypass_flag
+        if (read_bit(&r)) {
+            int list_num = (chroma_format == 3) ? 12 : 8;
+            for (int i = 0; i < list_num && r.error == false; i++) {
+                if (read_bit(&r)) {
+                    h264_skip_scaling_list(&r, i < 6 ? 16 : 64);
+                }
+            }
+        }
+    }
+    if (read_ue(&r) > 12) { // log2_max_frame_num_minus4
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    uint32_t poc_type = read_ue(&r);
+    if (poc_type == 0) {
+        if (read_ue(&r) > 12) { // log2_max_pic_order_cnt_lsb_minus4
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+    } else if (poc_type == 1) {
+        read_bit(&r); // delta_pic_order_always_zero_flag
+        read_se(&r);  // offset_for_non_ref_pic
+        read_se(&r);  // offset_for_top_to_bottom_field
+        uint32_t cycle_num = read_ue(&r);
+        if (cycle_num > 255) {
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+        for (uint32_t i = 0; i < cycle_num && r.error == false; i++) {
+            read_se(&r);
+        }
+    } else if (poc_type != 2) {
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    read_ue(&r);  // max_num_ref_frames
+    read_bit(&r); // gaps_in_frame_num_value_allowed_flag
+    uint32_t mb_width = read_ue(&r) + 1;
+    uint32_t map_height = read_ue(&r) + 1;
+    uint32_t frame_mbs_only = read_bit(&r);
+    if (frame_mbs_only == 0) {
+        read_bit(&r); // mb_adaptive_frame_field_flag
+    }
+    read_bit(&r); // direct_8x8_inference_flag
+    uint32_t crop[4] = { 0 };
+    if (read_bit(&r)) {
+        for (int i = 0; i < 4; i++) {
+            crop[i] = read_ue(&r);
+        }
+    }
+    // VUI is not needed, only require data until cropping
+    if (r.error || id > H264_MAX_SPS_ID) {
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    uint32_t mb_height = map_height * (2 - frame_mbs_only);
+    if (mb_width > H264_MAX_MB_NUM || mb_height > H264_MAX_MB_NUM) {
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    // Crop unit follows chroma sub-sampling, see H.264 7.4.2.1.1
+    uint32_t unit_x = 1, unit_y = 2 - frame_mbs_only;
+    if (chroma_format == 1 || chroma_format == 2) {
+        unit_x = 2;
+        unit_y *= (chroma_format == 1) ? 2 : 1;
+    }
+    uint32_t width = mb_width * 16;
+    uint32_t height = mb_height * 16;
+    for (int i = 0; i < 4; i++) {
+        if (crop[i] > width + height) {
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+    }
+    uint32_t crop_x = (crop[0] + crop[1]) * unit_x;
+    uint32_t crop_y = (crop[2] + crop[3]) * unit_y;
+    if (crop_x >= width || crop_y >= height) {
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    info->width = (uint16_t)(width - crop_x);
+    info->height = (uint16_t)(height - crop_y);
+    info->chroma = (video_chroma_t)chroma_format;
+    info->bit_depth = (uint8_t)bit_depth;
+    info->profile = profile;
+    info->level = level;
+    info->has_pps = false;
+    *sps_id = (int)id;
+    return ESP_MEDIA_ERR_OK;
+}
+
+static int h264_parse_pps(const uint8_t *data, int size)
+{
+    bit_reader_t r;
+    reader_init(&r, data, size);
+    uint32_t pps_id = read_ue(&r);
+    uint32_t sps_id = read_ue(&r);
+    if (r.error || pps_id > H264_MAX_PPS_ID || sps_id > H264_MAX_SPS_ID) {
+        return -1;
+    }
+    return (int)sps_id;
+}
+
+static int h264_find_start_code(const uint8_t *data, int size, int pos)
+{
+    for (int i = pos; i + 2 < size; i++) {
+        // No start code can begin in next 3 bytes
+        if (data[i + 2] > 1) {
+            i += 2;
+            continue;
+        }
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            return i + 3;
+        }
+    }
+    return -1;
+}
+
+int video_parse_h264(const uint8_t *data, int size, video_parser_info_t *info)
+{
+    if (data == NULL || size <= 0 || info == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    int ret = ESP_MEDIA_ERR_NOT_FOUND;
+    int sps_id = -1;
+    uint32_t pps_mask = 0;
+    int pos = h264_find_start_code(data, size, 0);
+    if (pos < 0) {
+        // Not Annex-B stream
+        return ESP_MEDIA_ERR_NOT_SUPPORT;
+    }
+    while (pos >= 0 && pos < size) {
+        int next = h264_find_start_code(data, size, pos);
+        // Trailing zero of next start code does not matter for header parsing
+        int end = (next < 0) ? size : next - 3;
+        uint8_t nal_type = data[pos] & 0x1F;
+        if (nal_type >= 1 && nal_type <= 5) {
+            // Parameter sets always come before slices of access unit
+            break;
+        }
+        if (nal_type == H264_NAL_SPS && sps_id < 0) {
+            ret = h264_parse_sps(data + pos + 1, end - pos - 1, info, &sps_id);
+            if (ret != ESP_MEDIA_ERR_OK) {
+                return ret;
+            }
+        } else if (nal_type == H264_NAL_PPS) {
+            int id = h264_parse_pps(data + pos + 1, end - pos - 1);
+            if (id >= 0) {
+                pps_mask |= (1u << id);
+            }
+        }
+        pos = next;
+    }
+    if (sps_id >= 0) {
+        info->has_pps = (pps_mask >> sps_id) & 1;
+    }
+    return ret;
+}
+
+video_frame_kind_t video_parse_h264_frame_kind(const uint8_t *data, int size)
+{
+    if (data == NULL || size <= 0) {
+        return VIDEO_FRAME_KIND_UNKNOWN;
+    }
+    video_frame_kind_t kind = VIDEO_FRAME_KIND_UNKNOWN;
+    int pos = h264_find_start_code(data, size, 0);
+    while (pos >= 0 && pos < size) {
+        uint8_t nal_type = data[pos] & 0x1F;
+        uint8_t ref_idc = (data[pos] >> 5) & 0x3;
+        if (nal_type == H264_NAL_IDR) {
+            return VIDEO_FRAME_KIND_IDR;
+        }
+        // Partition B and C always follow partition A of same slice
+        if (nal_type == H264_NAL_SLICE || nal_type == H264_NAL_PARTITION_A) {
+            if (ref_idc) {
+                return VIDEO_FRAME_KIND_REF;
+            }
+            kind = VIDEO_FRAME_KIND_NON_REF;
+        }
+        pos = h264_find_start_code(data, size, pos);
+    }
+    return kind;
+}
+
+static bool jpeg_is_sof(uint8_t marker)
+{
+    // DHT, JPG and DAC share the SOF range
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+static int jpeg_parse_sof(uint8_t marker, const uint8_t *d, int len, video_parser_info_t *info)
+{
+    if (len < 6) {
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    uint16_t height = (d[1] << 8) | d[2];
+    uint16_t width = (d[3] << 8) | d[4];
+    int comp_num = d[5];
+    // Height 0 means defined by DNL later which is not supported
+    if (height == 0 || width == 0 || height > VIDEO_MAX_SIZE || width > VIDEO_MAX_SIZE || comp_num == 0 || comp_num > JPEG_MAX_COMPONENT || len < 6 + comp_num * 3) {
+        return ESP_MEDIA_ERR_BAD_DATA;
+    }
+    uint8_t h[JPEG_MAX_COMPONENT], v[JPEG_MAX_COMPONENT];
+    for (int i = 0; i < comp_num; i++) {
+        h[i] = d[7 + i * 3] >> 4;
+        v[i] = d[7 + i * 3] & 0xF;
+        if (h[i] == 0 || h[i] > 4 || v[i] == 0 || v[i] > 4) {
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+    }
+    video_chroma_t chroma = VIDEO_CHROMA_OTHER;
+    if (comp_num == 1) {
+        chroma = VIDEO_CHROMA_MONO;
+    } else if (comp_num == 3 && h[1] == h[2] && v[1] == v[2]) {
+        if (h[0] == h[1] && v[0] == v[1]) {
+            chroma = VIDEO_CHROMA_444;
+        } else if (h[0] == h[1] * 2 && v[0] == v[1] * 2) {
+            chroma = VIDEO_CHROMA_420;
+        } else if (h[0] == h[1] * 2 && v[0] == v[1]) {
+            chroma = VIDEO_CHROMA_422;
+        }
+    }
+    info->width = width;
+    info->height = height;
+    info->chroma = chroma;
+    info->bit_depth = d[0];
+    info->profile = marker - 0xC0;
+    info->level = 0;
+    info->has_pps = false;
+    return ESP_MEDIA_ERR_OK;
+}
+
+int video_parse_jpeg(const uint8_t *data, int size, video_parser_info_t *info)
+{
+    if (data == NULL || size <= 0 || info == NULL) {
+        return ESP_MEDIA_ERR_INVALID_ARG;
+    }
+    if (size < 2 || data[0] != 0xFF || data[1] != JPEG_MARKER_SOI) {
+        return ESP_MEDIA_ERR_NOT_FOUND;
+    }
+    int pos = 2;
+    while (pos < size) {
+        // Segments must be back to back, garbage between them is treated as corrupted
+        if (data[pos] != 0xFF) {
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+        while (pos < size && data[pos] == 0xFF) {
+            pos++;
+        }
+        if (pos >= size) {
+            break;
+        }
+        uint8_t marker = data[pos++];
+        if (marker == JPEG_MARKER_SOS || marker == JPEG_MARKER_EOI || marker == 0) {
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+        // Standalone markers without length
+        if ((marker >= 0xD0 && marker <= 0xD7) || marker == 0x01 || marker == JPEG_MARKER_SOI) {
+            continue;
+        }
+        if (pos + 2 > size) {
+            break;
+        }
+        int len = (data[pos] << 8) | data[pos + 1];
+        if (len < 2) {
+            return ESP_MEDIA_ERR_BAD_DATA;
+        }
+        if (pos + len > size) {
+            break;
+        }
+        if (jpeg_is_sof(marker)) {
+            return jpeg_parse_sof(marker, data + pos + 2, len - 2, info);
+        }
+        pos += len;
+    }
+    // Truncated before frame header
+    return ESP_MEDIA_ERR_BAD_DATA;
+}
@@ -0,0 +1,80 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    VIDEO_CHROMA_MONO = 0,
+    VIDEO_CHROMA_420,
+    VIDEO_CHROMA_422,
+    VIDEO_CHROMA_444,
+    VIDEO_CHROMA_OTHER,
+} video_chroma_t;
+
+typedef struct {
+    uint16_t       width;     /*!< Display width after cropping */
+    uint16_t       height;    /*!< Display height after cropping */
+    video_chroma_t chroma;    /*!< Chroma format */
+    uint8_t        bit_depth; /*!< Luma bit depth */
+    uint8_t        profile;   /*!< H264 profile_idc, or JPEG SOF type (0 baseline, 1 extended, 2 progressive ...) */
+    uint8_t        level;     /*!< H264 level_idc, 0 for JPEG */
+    bool           has_pps;   /*!< H264 PPS referring to the SPS is also found */
+} video_parser_info_t;
+
+typedef enum {
+    VIDEO_FRAME_KIND_UNKNOWN = 0, /*!< No slice found */
+    VIDEO_FRAME_KIND_IDR,         /*!< IDR frame, decodable without previous frames */
+    VIDEO_FRAME_KIND_REF,         /*!< Non-IDR frame referenced by later frames */
+    VIDEO_FRAME_KIND_NON_REF,     /*!< Frame no later frame refers to, safe to drop */
+} video_frame_kind_t;
+
+/* Bitstream header parsers
+ * They only read stream headers so that resolution is known before decode, all reads are bounded
+ * so truncated or corrupted data never read out of `data`
+ * Return ESP_MEDIA_ERR_NOT_FOUND when header not present, ESP_MEDIA_ERR_BAD_DATA when header is malformed
+ */
+
+/* Find SPS (and PPS) in H264 Annex-B access unit, stops at first slice
+ * Return ESP_MEDIA_ERR_NOT_SUPPORT when no start code found
+ */
+int video_parse_h264(const uint8_t *data, int size, video_parser_info_t *info);
+
+/* Classify H264 Annex-B access unit from slice NAL type and nal_ref_idc, only NAL headers are read
+ * Frame is non-reference only when all of its slices have nal_ref_idc 0
+ */
+video_frame_kind_t video_parse_h264_frame_kind(const uint8_t *data, int size);
+
+/* Find SOF in JPEG image, stops at first scan */
+int video_parse_jpeg(const uint8_t *data, int size, video_parser_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,180 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "video_rate.h"
+#include "media_lib_os.h"
+
+#define RATE_WIN            (32)      /* Recent PTS used for estimation */
+#define RATE_MIN_GAPS       (4)
+#define RATE_FULL_GAPS      (16)      /* Gaps needed for full confidence */
+#define RATE_DISCONT_MS     (1000)    /* PTS jump treated as wrap or seek */
+#define RATE_MAX_TIME_MS    (1 << 30) /* Restart before unwrapped time overflow */
+#define RATE_SMOOTH         (8)       /* Weight of old estimate */
+
+struct video_rate_t {
+    bool     pts_valid;
+    uint32_t last_pts;
+    int32_t  time_ms; /* Unwrapped PTS since restart */
+    int32_t  win[RATE_WIN];
+    int      win_num;
+    int      win_pos;
+    bool     ready;
+    float    frame_ms;
+    float    jitter_ms;
+    uint8_t  confidence;
+};
+
+video_rate_handle_t video_rate_open(void)
+{
+    return (struct video_rate_t *)media_lib_calloc(1, sizeof(struct video_rate_t));
+}
+
+static void sort_i32(int32_t *v, int n)
+{
+    for (int i = 1; i < n; i++) {
+        int32_t x = v[i];
+        int j = i - 1;
+        for (; j >= 0 && v[j] > x; j--) {
+            v[j + 1] = v[j];
+        }
+        v[j + 1] = x;
+    }
+}
+
+static void restart(struct video_rate_t *r, uint32_t pts)
+{
+    memset(r, 0, sizeof(struct video_rate_t));
+    r->pts_valid = true;
+    r->last_pts = pts;
+    r->win_num = r->win_pos = 1;
+}
+
+static int frames_in_gap(int32_t gap, float frame_ms)
+{
+    return (int)(gap / frame_ms + 0.5f);
+}
+
+static void estimate(struct video_rate_t *r)
+{
+    int32_t v[RATE_WIN], gap[RATE_WIN];
+    memcpy(v, r->win, r->win_num * sizeof(int32_t));
+    // Gaps are taken after sort so that reordered frames (like B frames) still give frame duration
+    sort_i32(v, r->win_num);
+    int n = 0;
+    for (int i = 1; i < r->win_num; i++) {
+        // Duplicated PTS is not a frame gap
+        if (v[i] > v[i - 1]) {
+            gap[n++] = v[i] - v[i - 1];
+        }
+    }
+    if (n < RATE_MIN_GAPS) {
+        return;
+    }
+    sort_i32(gap, n);
+    // Median gap is a frame duration unless over half frames lost, fit window span onto its multiples
+    // so that lost frame counts as several and gap inside one frame slot (late frame) counts as none
+    float median = (float)gap[n / 2];
+    int frames = 0;
+    for (int i = 0; i < n; i++) {
+        frames += frames_in_gap(gap[i], median);
+    }
+    int32_t span = v[r->win_num - 1] - v[0];
+    float frame_ms = (float)span / frames;
+    int fit = 0;
+    float dev = 0;
+    for (int i = 0; i < n; i++) {
+        int k = frames_in_gap(gap[i], frame_ms);
+        float err = (float)gap[i] - (k > 1 ? k : 1) * frame_ms;
+        err = err >= 0 ? err : -err;
+        dev += err;
+        if (err <= frame_ms / 4) {
+            fit++;
+        }
+    }
+    // Jitter is too large to tell lost frames, use rate of delivered frames instead
+    if (fit * 2 < n) {
+        frame_ms = (float)span / n;
+    }
+    float diff = frame_ms - r->frame_ms;
+    if (r->ready == false || (fit * 4 >= n * 3 && (diff > r->frame_ms / 4 || -diff > r->frame_ms / 4))) {
+        // Follow rate step at once when new rate fits well
+        r->frame_ms = frame_ms;
+        r->ready = true;
+    } else {
+        r->frame_ms += diff / RATE_SMOOTH;
+    }
+    r->jitter_ms = dev / n;
+    r->confidence = (uint8_t)(fit * 100 / n * (n < RATE_FULL_GAPS ? n : RATE_FULL_GAPS) / RATE_FULL_GAPS);
+}
+
+void video_rate_add(video_rate_handle_t h, uint32_t pts)
+{
+    struct video_rate_t *r = (struct video_rate_t *)h;
+    if (r == NULL) {
+        return;
+    }
+    // Signed difference keeps going across 32 bits wrap
+    int32_t diff = (int32_t)(pts - r->last_pts);
+    if (r->pts_valid == false || diff > RATE_DISCONT_MS || diff < -RATE_DISCONT_MS ||
+        r->time_ms > RATE_MAX_TIME_MS) {
+        restart(r, pts);
+        return;
+    }
+    r->last_pts = pts;
+    r->time_ms += diff;
+    r->win[r->win_pos] = r->time_ms;
+    r->win_pos = (r->win_pos + 1) % RATE_WIN;
+    if (r->win_num < RATE_WIN) {
+        r->win_num++;
+    }
+    estimate(r);
+}
+
+bool video_rate_get(video_rate_handle_t h, video_rate_info_t *info)
+{
+    struct video_rate_t *r = (struct video_rate_t *)h;
+    memset(info, 0, sizeof(video_rate_info_t));
+    if (r == NULL || r->ready == false) {
+        return false;
+    }
+    info->frame_us = (uint32_t)(r->frame_ms * 1000 + 0.5f);
+    info->fps = 1000.0f / r->frame_ms;
+    info->jitter_us = (uint32_t)(r->jitter_ms * 1000 + 0.5f);
+    info->confidence = r->confidence;
+    return true;
+}
+
+void video_rate_reset(video_rate_handle_t h)
+{
+    struct video_rate_t *r = (struct video_rate_t *)h;
+    if (r) {
+        memset(r, 0, sizeof(struct video_rate_t));
+    }
+}
+
+void video_rate_close(video_rate_handle_t h)
+{
+    media_lib_free(h);
+}
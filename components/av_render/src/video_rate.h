@@ -0,0 +1,62 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct video_rate_t *video_rate_handle_t;
+
+typedef struct {
+    uint32_t frame_us;   /*!< Estimated frame duration, 0 if not enough frames */
+    float    fps;        /*!< Estimated frame rate, 0 if not enough frames */
+    uint32_t jitter_us;  /*!< Mean deviation of PTS gaps from whole frame durations */
+    uint8_t  confidence; /*!< 0-100, share of recent PTS gaps which are whole frame durations */
+} video_rate_info_t;
+
+/* Estimate frame rate and PTS jitter from PTS of incoming frames
+ * Recent PTS are sorted and fitted onto multiples of median gap, so lost frames, late frames and reordered frames
+ * do not change the estimate, rate change is followed within half window
+ * When jitter is too large to tell lost frames, rate of delivered frames is reported with low confidence
+ * PTS jump over 1 second (wrap, seek or splice) restarts estimation
+ */
+video_rate_handle_t video_rate_open(void);
+
+void video_rate_add(video_rate_handle_t h, uint32_t pts);
+
+/* Return false when estimate not ready yet */
+bool video_rate_get(video_rate_handle_t h, video_rate_info_t *info);
+
+void video_rate_reset(video_rate_handle_t h);
+
+void video_rate_close(video_rate_handle_t h);
+
+#ifdef __cplusplus
+}
+#endif
@@ -129,6 +129,30 @@ int video_render_get_frame_info(video_render_handle_t render, av_render_video_fr
     return v_render->render_ops.get_frame_info(v_render->render_handle, info);
 }
 
+int video_render_get_transform(video_render_handle_t render, av_render_video_transform_t *transform)
+{
+    video_render_t *v_render = render;
+    if (transform == NULL || v_render == NULL || v_render->render_handle == NULL) {
+        return -1;
+    }
+    if (v_render->render_ops.get_transform == NULL) {
+        return ESP_MEDIA_ERR_NOT_SUPPORT;
+    }
+    return v_render->render_ops.get_transform(v_render->render_handle, transform);
+}
+
+int video_render_get_stats(video_render_handle_t render, video_render_stats_t *stats)
+{
+    video_render_t *v_render = render;
+    if (stats == NULL || v_render == NULL || v_render->render_handle == NULL) {
+        return -1;
+    }
+    if (v_render->render_ops.get_stats == NULL) {
+        return ESP_MEDIA_ERR_NOT_SUPPORT;
+    }
+    return v_render->render_ops.get_stats(v_render->render_handle, stats);
+}
+
 int video_render_close(video_render_handle_t render)
 {
     video_render_t *v_render = render;
@@ -0,0 +1,279 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Replay av_render record file on host
+ *
+ * Default mode runs decode and render inline on virtual clock, every record is fed at its arrival time and
+ * render waits only move the clock, so sync and drop decisions are same in every run and printed trace hash
+ * can be compared between runs and code changes
+ * Real time mode (-r) opens render with recorded fifo configuration and threads on system clock, it is close to
+ * device behavior but thread scheduling makes it not repeatable
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "media_lib_err.h"
+#include "av_render.h"
+#include "av_render_record.h"
+#include "sim_render.h"
+
+#define FNV_OFFSET (0xcbf29ce484222325ULL)
+#define FNV_PRIME  (0x100000001b3ULL)
+
+typedef struct {
+    bool                     real_time;
+    float                    speed;
+    sim_render_cfg_t         render_cfg;
+    FILE                    *trace_fp;
+    uint64_t                 hash;
+    uint32_t                 trace_num;
+    int64_t                  start_us;
+    media_lib_mutex_handle_t trace_lock;
+    audio_render_handle_t    audio_render;
+    video_render_handle_t    video_render;
+} replay_t;
+
+static replay_t replay = {
+    .speed = 1.0f,
+    .render_cfg = {
+        .audio_buffer_ms = 60,
+    },
+    .hash = FNV_OFFSET,
+};
+
+void sim_trace(char kind, uint32_t pts, uint32_t size)
+{
+    char line[64];
+    int64_t t = sim_clock_now() - replay.start_us;
+    int len = snprintf(line, sizeof(line), "%c %" PRId64 " %" PRIu32 " %" PRIu32 "\n", kind, t, pts, size);
+    media_lib_mutex_lock(replay.trace_lock, MEDIA_LIB_MAX_LOCK_TIME);
+    for (int i = 0; i < len; i++) {
+        replay.hash = (replay.hash ^ (uint8_t)line[i]) * FNV_PRIME;
+    }
+    replay.trace_num++;
+    if (replay.trace_fp) {
+        fwrite(line, 1, len, replay.trace_fp);
+    }
+    media_lib_mutex_unlock(replay.trace_lock);
+}
+
+static int render_event(av_render_event_t event, void *ctx)
+{
+    if (event != AV_RENDER_EVENT_AUDIO_RENDERED && event != AV_RENDER_EVENT_VIDEO_RENDERED) {
+        sim_trace('E', event, 0);
+    }
+    return 0;
+}
+
+static av_render_handle_t open_render(av_render_cfg_t *cfg)
+{
+    replay.audio_render = sim_audio_render_alloc(&replay.render_cfg);
+    replay.video_render = sim_video_render_alloc(&replay.render_cfg);
+    cfg->audio_render = replay.audio_render;
+    cfg->video_render = replay.video_render;
+    if (replay.real_time == false) {
+        // No thread so that every decision happens in feeding order
+        cfg->audio_raw_fifo_size = 0;
+        cfg->video_raw_fifo_size = 0;
+        cfg->audio_render_fifo_size = 0;
+        cfg->video_render_fifo_size = 0;
+        cfg->video_cvt_worker_num = 0;
+    }
+    av_render_handle_t render = av_render_open(cfg);
+    if (render) {
+        av_render_set_event_cb(render, render_event, NULL);
+    }
+    return render;
+}
+
+static void close_render(av_render_handle_t render)
+{
+    av_render_close(render);
+    audio_render_free_handle(replay.audio_render);
+    video_render_free_handle(replay.video_render);
+    replay.audio_render = NULL;
+    replay.video_render = NULL;
+}
+
+static int feed_item(av_render_handle_t render, av_render_record_item_t *item)
+{
+    switch (item->type) {
+        case AV_RENDER_RECORD_TYPE_AUDIO_STREAM:
+            return av_render_add_audio_stream(render, &item->audio_info);
+        case AV_RENDER_RECORD_TYPE_VIDEO_STREAM:
+            return av_render_add_video_stream(render, &item->video_info);
+        case AV_RENDER_RECORD_TYPE_AUDIO_DATA:
+            return av_render_add_audio_data(render, &item->audio_data);
+        case AV_RENDER_RECORD_TYPE_VIDEO_DATA:
+            return av_render_add_video_data(render, &item->video_data);
+        case AV_RENDER_RECORD_TYPE_FIXED_INFO:
+            return av_render_set_fixed_frame_info(render, &item->fixed_info);
+        case AV_RENDER_RECORD_TYPE_AUDIO_THRESHOLD:
+            return av_render_set_audio_threshold(render, item->audio_threshold);
+        case AV_RENDER_RECORD_TYPE_SPEED:
+            return av_render_set_speed(render, item->speed);
+        case AV_RENDER_RECORD_TYPE_PAUSE:
+            return av_render_pause(render, item->pause);
+        case AV_RENDER_RECORD_TYPE_FLUSH:
+            return av_render_flush(render);
+        case AV_RENDER_RECORD_TYPE_RESET:
+            return av_render_reset(render);
+        default:
+            return ESP_MEDIA_ERR_OK;
+    }
+}
+
+static void trace_stats(av_render_handle_t render)
+{
+    av_render_stream_type_t types[] = { AV_RENDER_STREAM_TYPE_AUDIO, AV_RENDER_STREAM_TYPE_VIDEO };
+    const char *names[] = { "audio", "video" };
+    for (int i = 0; i < 2; i++) {
+        av_render_stream_stats_t stats;
+        if (av_render_get_stream_stats(render, types[i], &stats) != ESP_MEDIA_ERR_OK) {
+            continue;
+        }
+        printf("%s: in %" PRIu32 " decoded %" PRIu32 " rendered %" PRIu32 " dropped", names[i], stats.in_num,
+               stats.decoded_num, stats.rendered_num);
+        for (int j = 0; j < AV_RENDER_DROP_MAX; j++) {
+            printf(" %" PRIu32, stats.drop_num[j]);
+            sim_trace('S', j, stats.drop_num[j]);
+        }
+        printf("\n");
+        sim_trace('S', stats.decoded_num, stats.rendered_num);
+    }
+    av_render_sync_stats_t sync = {0};
+    if (av_render_get_sync_stats(render, &sync) == ESP_MEDIA_ERR_OK) {
+        printf("sync: av offset %" PRId32 " ms drift %" PRId32 " ppm resync %" PRIu32 "\n", sync.av_offset_ms,
+               sync.drift_ppm, sync.resync_num);
+        sim_trace('S', (uint32_t)sync.av_offset_ms, sync.resync_num);
+    }
+    av_render_video_rate_t rate = {0};
+    if (av_render_get_video_rate(render, &rate) == ESP_MEDIA_ERR_OK) {
+        printf("video rate: %.2f fps jitter %" PRIu32 " us confidence %d\n", rate.fps, rate.jitter_us,
+               (int)rate.confidence);
+    }
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options] record_file\n"
+           "  -r          Real time with recorded fifo and threads (not repeatable)\n"
+           "  -s speed    Feed faster than recorded, for example 4 for 4 times\n"
+           "  -a ms       Audio buffered in simulated device before write blocks (default 60)\n"
+           "  -d ms       Simulated panel draw time of one frame (default 0)\n"
+           "  -o file     Write trace of every rendered frame\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "rs:a:d:o:h")) != -1) {
+        switch (opt) {
+            case 'r':
+                replay.real_time = true;
+                break;
+            case 's':
+                replay.speed = (float)atof(optarg);
+                break;
+            case 'a':
+                replay.render_cfg.audio_buffer_ms = (uint16_t)atoi(optarg);
+                break;
+            case 'd':
+                replay.render_cfg.video_draw_ms = (uint16_t)atoi(optarg);
+                break;
+            case 'o':
+                replay.trace_fp = fopen(optarg, "w");
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc || replay.speed <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    media_lib_add_default_adapter();
+    media_lib_mutex_create(&replay.trace_lock);
+    sim_clock_use_virtual(replay.real_time == false);
+
+    av_render_record_handle_t record = NULL;
+    int ret = av_render_record_open(argv[optind], &record);
+    if (ret != ESP_MEDIA_ERR_OK) {
+        printf("Fail to open record %s ret %d\n", argv[optind], ret);
+        return 1;
+    }
+    av_render_handle_t render = NULL;
+    av_render_record_item_t item;
+    uint32_t item_num = 0, fail_num = 0;
+    replay.start_us = sim_clock_now();
+    while ((ret = av_render_record_read(record, &item)) == ESP_MEDIA_ERR_OK) {
+        if (item.type == AV_RENDER_RECORD_TYPE_CONFIG) {
+            if (render) {
+                close_render(render);
+            }
+            render = open_render(&item.cfg);
+            continue;
+        }
+        if (render == NULL) {
+            // Record started without configuration, use synchronous render
+            av_render_cfg_t cfg = { 0 };
+            render = open_render(&cfg);
+        }
+        if (render == NULL) {
+            printf("Fail to open render\n");
+            break;
+        }
+        // Data arrives late if caller is still blocked in render, same as on device
+        sim_clock_wait_until(replay.start_us + (int64_t)(item.time_us / replay.speed));
+        if (feed_item(render, &item) != ESP_MEDIA_ERR_OK) {
+            fail_num++;
+        }
+        item_num++;
+    }
+    if (ret != ESP_MEDIA_ERR_NOT_FOUND) {
+        printf("Record file broken ret %d\n", ret);
+    }
+    if (render) {
+        if (replay.real_time) {
+            // Let render threads drain queued data
+            media_lib_thread_sleep(1000);
+        }
+        trace_stats(render);
+        close_render(render);
+    }
+    av_render_record_close(record);
+    printf("replayed %" PRIu32 " records (%" PRIu32 " failed), %" PRIu32 " traces, hash %016" PRIx64 "\n",
+           item_num, fail_num, replay.trace_num, replay.hash);
+    if (replay.trace_fp) {
+        fclose(replay.trace_fp);
+    }
+    media_lib_mutex_destroy(replay.trace_lock);
+    return 0;
+}
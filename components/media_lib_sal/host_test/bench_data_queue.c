@@ -0,0 +1,183 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Benchmark data_queue handoff between one writer and one reader, mutex mode against SPSC mode
+ *
+ * Throughput: writer sends frames as fast as queue allows, reader consumes at once, report frames per second
+ * Latency: writer sends next frame only after last one consumed, so that p99 shows wakeup cost of reader
+ * Frame payload is not filled so that result shows queue cost only
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "media_lib_adapter.h"
+#include "data_queue.h"
+#include "host_test.h"
+
+typedef struct {
+    uint32_t seq;
+    uint64_t send_ns;
+} frame_head_t;
+
+typedef struct {
+    int      frame_size;
+    int      throughput_num;
+    int      latency_num;
+} bench_cfg_t;
+
+typedef struct {
+    data_queue_t *q;
+    int           num;
+    uint32_t      consumed;
+    uint64_t     *latency;
+    int           order_err;
+} bench_ctx_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void *reader_thread(void *arg)
+{
+    bench_ctx_t *ctx = (bench_ctx_t *) arg;
+    for (int i = 0; i < ctx->num; i++) {
+        void *data = NULL;
+        int size = 0;
+        if (data_queue_read_lock(ctx->q, &data, &size) != 0) {
+            break;
+        }
+        frame_head_t *head = (frame_head_t *) data;
+        if (ctx->latency) {
+            ctx->latency[i] = now_ns() - head->send_ns;
+        }
+        if (head->seq != (uint32_t) i) {
+            ctx->order_err++;
+        }
+        data_queue_read_unlock(ctx->q);
+        __atomic_store_n(&ctx->consumed, i + 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static int send_frame(data_queue_t *q, int size, uint32_t seq)
+{
+    frame_head_t *head = (frame_head_t *) data_queue_get_buffer(q, size);
+    if (head == NULL) {
+        return -1;
+    }
+    head->seq = seq;
+    head->send_ns = now_ns();
+    return data_queue_send_buffer(q, size);
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return x < y ? -1 : (x > y);
+}
+
+static data_queue_t *create_queue(bool spsc, int frame_size)
+{
+    // Keep about 4 frames in queue so that writer and reader run in parallel
+    int size = (frame_size + 64) * 4;
+    if (size < 64 * 1024) {
+        size = 64 * 1024;
+    }
+    return spsc ? data_queue_init_spsc(size) : data_queue_init(size);
+}
+
+static double bench_throughput(bool spsc, bench_cfg_t *cfg)
+{
+    bench_ctx_t ctx = {
+        .q = create_queue(spsc, cfg->frame_size),
+        .num = cfg->throughput_num,
+    };
+    pthread_t th;
+    pthread_create(&th, NULL, reader_thread, &ctx);
+    uint64_t start = now_ns();
+    for (int i = 0; i < ctx.num; i++) {
+        if (send_frame(ctx.q, cfg->frame_size, i) != 0) {
+            break;
+        }
+    }
+    pthread_join(th, NULL);
+    double cost = (double) (now_ns() - start) / 1e9;
+    TEST_CHECK(ctx.consumed == (uint32_t) ctx.num && ctx.order_err == 0, "%s %d bytes received %u order error %d",
+               spsc ? "SPSC" : "Mutex", cfg->frame_size, ctx.consumed, ctx.order_err);
+    data_queue_deinit(ctx.q);
+    return ctx.num / cost;
+}
+
+static void bench_latency(bool spsc, bench_cfg_t *cfg, double *p50_us, double *p99_us)
+{
+    bench_ctx_t ctx = {
+        .q = create_queue(spsc, cfg->frame_size),
+        .num = cfg->latency_num,
+        .latency = (uint64_t *) calloc(cfg->latency_num, sizeof(uint64_t)),
+    };
+    pthread_t th;
+    pthread_create(&th, NULL, reader_thread, &ctx);
+    for (int i = 0; i < ctx.num; i++) {
+        if (send_frame(ctx.q, cfg->frame_size, i) != 0) {
+            break;
+        }
+        // Wait for reader to consume so that each sample measures one wakeup
+        while (__atomic_load_n(&ctx.consumed, __ATOMIC_ACQUIRE) != (uint32_t) (i + 1)) {
+            sched_yield();
+        }
+    }
+    pthread_join(th, NULL);
+    qsort(ctx.latency, ctx.num, sizeof(uint64_t), cmp_u64);
+    *p50_us = ctx.latency[ctx.num / 2] / 1000.0;
+    *p99_us = ctx.latency[ctx.num * 99 / 100] / 1000.0;
+    free(ctx.latency);
+    data_queue_deinit(ctx.q);
+}
+
+int main(void)
+{
+    bench_cfg_t cfgs[] = {
+        {64, 200000, 20000},
+        {4 * 1024, 100000, 20000},
+        {500 * 1024, 5000, 2000},
+    };
+    media_lib_add_default_adapter();
+    printf("%-6s %8s %12s %10s %10s\n", "Mode", "Frame", "Frames/s", "p50(us)", "p99(us)");
+    for (int i = 0; i < sizeof(cfgs) / sizeof(cfgs[0]); i++) {
+        for (int spsc = 0; spsc < 2; spsc++) {
+            double p50 = 0, p99 = 0;
+            double fps = bench_throughput(spsc, &cfgs[i]);
+            bench_latency(spsc, &cfgs[i], &p50, &p99);
+            printf("%-6s %8d %12.0f %10.1f %10.1f\n", spsc ? "SPSC" : "Mutex", cfgs[i].frame_size, fps, p50, p99);
+        }
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,210 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Occupancy counters of data_queue against a walk over blocks in ring
+ *
+ * Random send, cancel, partial send, peek, read and consume all in both mutex and SPSC mode
+ * After every step block number, data size and used bytes (block head and ring back slack included)
+ * reported from counters must equal what is really in the ring, and every block keeps its content
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "media_lib_adapter.h"
+#include "data_queue.h"
+#include "host_test.h"
+
+#define QUEUE_SIZE  (4000)
+#define CYCLE_NUM   (300000)
+#define HEAD_SIZE   (4)
+#define SPSC_ALIGN  (4)
+
+typedef struct {
+    int      num;
+    int      size;
+    uint32_t bytes;
+} ring_count_t;
+
+static void walk_spsc(data_queue_t *q, ring_count_t *c)
+{
+    uint32_t left = q->in_total - q->out_total;
+    int rp = q->rp;
+    while (left) {
+        int head = *(int *)((uint8_t *)q->buffer + rp);
+        int len;
+        if (head == 0) {
+            // Padding till buffer end
+            len = q->size - rp;
+            rp = 0;
+        } else {
+            len = (head + SPSC_ALIGN - 1) & ~(SPSC_ALIGN - 1);
+            c->num++;
+            c->size += head - HEAD_SIZE;
+            rp += len;
+            if (rp == q->size) {
+                rp = 0;
+            }
+        }
+        left -= len;
+        c->bytes += len;
+    }
+}
+
+static void walk_mutex(data_queue_t *q, ring_count_t *c)
+{
+    if (q->filled == 0) {
+        return;
+    }
+    int rp = q->rp;
+    int ring_end = q->fill_end;
+    // Blocks till fill_end then from start till write position
+    while (rp != q->wp || ring_end) {
+        int head = *(int *)((uint8_t *)q->buffer + rp);
+        rp += head;
+        c->bytes += head;
+        c->num++;
+        c->size += head - HEAD_SIZE;
+        if (ring_end && rp == ring_end) {
+            c->bytes += q->size - ring_end;
+            ring_end = 0;
+            rp = 0;
+        }
+    }
+}
+
+// Whether writer gets buffer without waiting, ring back to start when end is not enough
+static bool can_write(data_queue_t *q, int size)
+{
+    if (q->spsc) {
+        // Zero is also reported when only block head fits
+        int avail = data_queue_get_available(q);
+        return avail > 0 && avail >= ((size + SPSC_ALIGN - 1) & ~(SPSC_ALIGN - 1));
+    }
+    int need = size + HEAD_SIZE;
+    if (q->wp == q->rp) {
+        return q->fill_end == 0 && need <= q->size;
+    }
+    if (q->wp > q->rp) {
+        return q->size - q->wp >= need || q->rp >= need;
+    }
+    return q->rp - q->wp >= need;
+}
+
+static void fill_pattern(uint8_t *data, int size, uint8_t seq)
+{
+    for (int i = 0; i < size; i++) {
+        data[i] = (uint8_t)(seq + i);
+    }
+}
+
+static bool check_pattern(uint8_t *data, int size)
+{
+    for (int i = 1; i < size; i++) {
+        if (data[i] != (uint8_t)(data[0] + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int run(bool spsc)
+{
+    data_queue_t *q = spsc ? data_queue_init_spsc(QUEUE_SIZE) : data_queue_init(QUEUE_SIZE);
+    TEST_CHECK(q != NULL, "create queue");
+    if (q == NULL) {
+        return -1;
+    }
+    unsigned int seed = 42;
+    int fail = host_test_fail_num;
+    uint8_t seq = 0;
+    uint32_t ring_back = 0;
+    for (int cycle = 0; cycle < CYCLE_NUM && fail == host_test_fail_num; cycle++) {
+        int op = rand_r(&seed) % 10;
+        int q_num = 0, q_size = 0;
+        data_queue_query(q, &q_num, &q_size);
+        if (op < 5) {
+            // Mostly small blocks, sometimes large one, SPSC also takes unaligned size
+            int size = (rand_r(&seed) % 4 == 0) ? rand_r(&seed) % 900 : rand_r(&seed) % 64;
+            size = size * 4 + (spsc ? rand_r(&seed) % 4 : 0);
+            if (can_write(q, size) == false) {
+                continue;
+            }
+            uint8_t *data = (uint8_t *)data_queue_get_buffer(q, size);
+            TEST_CHECK(data != NULL, "cycle %d get %d bytes", cycle, size);
+            if (data == NULL) {
+                break;
+            }
+            int send = size;
+            // Cancel or send part of reserved buffer
+            if (rand_r(&seed) % 20 == 0) {
+                send = 0;
+            } else if (rand_r(&seed) % 3 == 0) {
+                send = size / 2;
+            }
+            if ((uint8_t *)data - HEAD_SIZE == (uint8_t *)q->buffer && q_num) {
+                ring_back++;
+            }
+            fill_pattern(data, send, seq++);
+            TEST_CHECK(data_queue_send_buffer(q, send) == 0, "cycle %d send", cycle);
+        } else if (op < 9) {
+            if (q_num) {
+                void *data = NULL;
+                int size = 0;
+                TEST_CHECK(data_queue_read_lock(q, &data, &size) == 0, "cycle %d read", cycle);
+                TEST_CHECK(check_pattern((uint8_t *)data, size), "cycle %d content of %d bytes", cycle, size);
+                if (rand_r(&seed) % 4 == 0) {
+                    data_queue_peek_unlock(q);
+                } else {
+                    data_queue_read_unlock(q);
+                }
+            }
+        } else if (rand_r(&seed) % 50 == 0) {
+            data_queue_consume_all(q);
+        }
+        ring_count_t ring = { 0 };
+        if (spsc) {
+            walk_spsc(q, &ring);
+        } else {
+            walk_mutex(q, &ring);
+        }
+        data_queue_query(q, &q_num, &q_size);
+        TEST_CHECK(ring.num == q_num && ring.size == q_size && ring.bytes == q->in_total - q->out_total,
+                   "cycle %d ring has %d blocks %d bytes used %u, counters %d %d %u", cycle, ring.num, ring.size,
+                   (unsigned)ring.bytes, q_num, q_size, (unsigned)(q->in_total - q->out_total));
+        TEST_CHECK(data_queue_have_data(q) == (q_num > 0), "cycle %d have data", cycle);
+    }
+    printf("%s mode: %d cycles with %u ring back %s\n", spsc ? "SPSC" : "Mutex", CYCLE_NUM, (unsigned)ring_back,
+           fail == host_test_fail_num ? "match" : "mismatch");
+    TEST_CHECK(ring_back > 1000, "ring back is covered");
+    data_queue_deinit(q);
+    return 0;
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    run(false);
+    run(true);
+    return TEST_RESULT();
+}
@@ -0,0 +1,217 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Writer waits for reader to drain data_queue
+ *
+ * Reader consumes blocks slowly, writer blocked in `data_queue_wait_drain` must see queue empty soon after
+ * last consume without polling, report timeout when reader stalls and leave on `data_queue_wakeup`
+ * Writer blocked for space must still be woken by consume after or while another thread waits for drain
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include "media_lib_adapter.h"
+#include "data_queue.h"
+#include "host_test.h"
+
+#define BLOCK_NUM        (8)
+#define CONSUME_GAP_MS   (5)
+#define WAIT_TIMEOUT_MS  (1000)
+#define STALL_TIMEOUT_MS (50)
+#define BIG_BLOCK_SIZE   (240)
+
+static data_queue_t *queue;
+static bool          big_sent;
+static bool          drain_stop;
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static void send_blocks(int num)
+{
+    for (int i = 0; i < num; i++) {
+        void *data = data_queue_get_buffer(queue, 16);
+        data_queue_send_buffer(queue, data ? 16 : 0);
+    }
+}
+
+static void *slow_reader(void *arg)
+{
+    int num = (int)(intptr_t)arg;
+    for (int i = 0; i < num; i++) {
+        void *data = NULL;
+        int size = 0;
+        usleep(CONSUME_GAP_MS * 1000);
+        if (data_queue_read_lock(queue, &data, &size) != 0) {
+            break;
+        }
+        data_queue_read_unlock(queue);
+    }
+    return NULL;
+}
+
+static void *wakeup_later(void *arg)
+{
+    usleep(STALL_TIMEOUT_MS * 1000);
+    data_queue_wakeup(queue);
+    return NULL;
+}
+
+static void *big_writer(void *arg)
+{
+    void *data = data_queue_get_buffer(queue, BIG_BLOCK_SIZE);
+    data_queue_send_buffer(queue, data ? BIG_BLOCK_SIZE : 0);
+    __atomic_store_n(&big_sent, data != NULL, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *drain_waiter(void *arg)
+{
+    while (__atomic_load_n(&drain_stop, __ATOMIC_ACQUIRE) == false) {
+        if (data_queue_wait_drain(queue, 0, 20) < 0) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void check_space_wake(bool spsc, const char *mode, bool drain_on_consume)
+{
+    pthread_t writer, waiter;
+    queue = spsc ? data_queue_init_spsc(1024) : data_queue_init(1024);
+    // Leave no room for one more big block
+    for (int i = 0; i < 4; i++) {
+        void *data = data_queue_get_buffer(queue, BIG_BLOCK_SIZE);
+        data_queue_send_buffer(queue, data ? BIG_BLOCK_SIZE : 0);
+    }
+    big_sent = false;
+    drain_stop = false;
+    pthread_create(&writer, NULL, big_writer, NULL);
+    usleep(10 * 1000);
+    if (drain_on_consume) {
+        pthread_create(&waiter, NULL, drain_waiter, NULL);
+    } else {
+        // Drain wait finished before consume must not hide writer still waiting
+        data_queue_wait_drain(queue, 0, 10);
+    }
+    usleep(20 * 1000);
+    for (int i = 0; i < 2; i++) {
+        void *data = NULL;
+        int size = 0;
+        data_queue_read_lock(queue, &data, &size);
+        data_queue_read_unlock(queue);
+        usleep(CONSUME_GAP_MS * 1000);
+    }
+    uint32_t start = now_ms();
+    while (__atomic_load_n(&big_sent, __ATOMIC_ACQUIRE) == false && now_ms() - start < WAIT_TIMEOUT_MS) {
+        usleep(1000);
+    }
+    bool sent = __atomic_load_n(&big_sent, __ATOMIC_ACQUIRE);
+    TEST_CHECK(sent, "%s writer waiting for space not woken %s drain wait", mode, drain_on_consume ? "during" : "after");
+    __atomic_store_n(&drain_stop, true, __ATOMIC_RELEASE);
+    if (drain_on_consume) {
+        pthread_join(waiter, NULL);
+    }
+    if (sent == false) {
+        // Release blocked writer
+        data_queue_wakeup(queue);
+    }
+    pthread_join(writer, NULL);
+    data_queue_deinit(queue);
+}
+
+/* Wait until queue empty, return elapsed time or -1 on failure */
+static int wait_empty(uint32_t timeout)
+{
+    uint32_t start = now_ms();
+    int q_num = 0, q_size = 0;
+    while (now_ms() - start < timeout) {
+        data_queue_query(queue, &q_num, &q_size);
+        if (q_num == 0) {
+            return (int)(now_ms() - start);
+        }
+        if (data_queue_wait_drain(queue, 0, timeout) != 0) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+static void run(bool spsc)
+{
+    const char *mode = spsc ? "SPSC" : "Mutex";
+    pthread_t th;
+    queue = spsc ? data_queue_init_spsc(1024) : data_queue_init(1024);
+
+    // Already drained returns at once
+    TEST_CHECK(data_queue_wait_drain(queue, 0, WAIT_TIMEOUT_MS) == 0, "%s wait on empty queue", mode);
+
+    // Drained by slow reader, woken by consume
+    send_blocks(BLOCK_NUM);
+    pthread_create(&th, NULL, slow_reader, (void *)(intptr_t)BLOCK_NUM);
+    int elapsed = wait_empty(WAIT_TIMEOUT_MS);
+    pthread_join(th, NULL);
+    TEST_CHECK(elapsed >= 0 && elapsed < BLOCK_NUM * CONSUME_GAP_MS + 100, "%s drain took %d ms", mode, elapsed);
+
+    // Partly drained to given block number
+    send_blocks(BLOCK_NUM);
+    pthread_create(&th, NULL, slow_reader, (void *)(intptr_t)(BLOCK_NUM / 2));
+    int q_num = BLOCK_NUM, q_size = 0;
+    while (q_num > BLOCK_NUM / 2 && data_queue_wait_drain(queue, BLOCK_NUM / 2, WAIT_TIMEOUT_MS) == 0) {
+        data_queue_query(queue, &q_num, &q_size);
+    }
+    pthread_join(th, NULL);
+    TEST_CHECK(q_num == BLOCK_NUM / 2, "%s drained to %d blocks", mode, q_num);
+
+    // Reader stalls, wait reports timeout
+    uint32_t start = now_ms();
+    int ret = data_queue_wait_drain(queue, 0, STALL_TIMEOUT_MS);
+    uint32_t cost = now_ms() - start;
+    TEST_CHECK(ret == 1 && cost >= STALL_TIMEOUT_MS - 1, "%s stall wait return %d after %u ms", mode, ret,
+               (unsigned)cost);
+
+    // Wakeup releases waiter
+    pthread_create(&th, NULL, wakeup_later, NULL);
+    ret = data_queue_wait_drain(queue, 0, WAIT_TIMEOUT_MS);
+    pthread_join(th, NULL);
+    TEST_CHECK(ret == -1, "%s wait after wakeup return %d", mode, ret);
+    data_queue_deinit(queue);
+
+    check_space_wake(spsc, mode, false);
+    check_space_wake(spsc, mode, true);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    run(false);
+    run(true);
+    return TEST_RESULT();
+}
@@ -0,0 +1,95 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Check data_queue SPSC mode keeps block order and size across ring back and rejects send without reservation */
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "media_lib_adapter.h"
+#include "data_queue.h"
+#include "host_test.h"
+
+#define QUEUE_SIZE  (1024)
+#define BLOCK_NUM   (20000)
+
+static data_queue_t *queue;
+static int           bad_num;
+
+/* Use sizes not aligned to head so that padding and ring back both happen */
+static int block_size(int i)
+{
+    return 1 + (i * 37) % 300;
+}
+
+static void *reader_thread(void *arg)
+{
+    for (int i = 0; i < BLOCK_NUM; i++) {
+        uint8_t *data = NULL;
+        int size = 0;
+        if (data_queue_read_lock(queue, (void **) &data, &size) != 0) {
+            bad_num++;
+            break;
+        }
+        if (size != block_size(i) || data[0] != (uint8_t) i || data[size - 1] != (uint8_t) i) {
+            bad_num++;
+        }
+        data_queue_read_unlock(queue);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    queue = data_queue_init_spsc(QUEUE_SIZE);
+    TEST_CHECK(queue != NULL, "create queue");
+
+    // Send without reserved buffer must not touch lock or user count
+    TEST_CHECK(data_queue_send_buffer(queue, 16) != 0, "send without reservation");
+    TEST_CHECK(data_queue_get_buffer(queue, QUEUE_SIZE) == NULL, "get buffer larger than queue");
+    TEST_CHECK(data_queue_send_buffer(queue, 16) != 0, "send after failed get buffer");
+    TEST_CHECK(queue->user == 0, "user count %d after failed send", queue->user);
+
+    pthread_t th;
+    pthread_create(&th, NULL, reader_thread, NULL);
+    for (int i = 0; i < BLOCK_NUM; i++) {
+        int size = block_size(i);
+        uint8_t *data = (uint8_t *) data_queue_get_buffer(queue, size);
+        if (data == NULL) {
+            bad_num++;
+            break;
+        }
+        memset(data, (uint8_t) i, size);
+        data_queue_send_buffer(queue, size);
+    }
+    pthread_join(th, NULL);
+    TEST_CHECK(bad_num == 0, "%d blocks mismatch", bad_num);
+
+    int q_num = -1, q_size = -1;
+    data_queue_query(queue, &q_num, &q_size);
+    TEST_CHECK(q_num == 0 && q_size == 0, "queue left %d blocks %d bytes", q_num, q_size);
+    data_queue_deinit(queue);
+    return TEST_RESULT();
+}
@@ -0,0 +1,123 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Reader wait of data_queue in both mutex and SPSC mode
+ *
+ * Reader blocks in `data_queue_wait_arrive` while another thread sends data, wakes reader or quits queue
+ * It must return early with right code, wait only for wake up when `q_num` is -1,
+ * return at once when more blocks than `q_num` are queued and time out when nothing happens
+ */
+
+#include <time.h>
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+#include "data_queue.h"
+#include "host_test.h"
+
+#define WAIT_TIMEOUT_MS (300)
+#define ACT_DELAY_MS    (30)
+
+typedef enum {
+    WAIT_ACT_NONE,
+    WAIT_ACT_SEND,
+    WAIT_ACT_WAKE,
+    WAIT_ACT_QUIT,
+} wait_act_t;
+
+static const char *act_names[] = { "none", "send", "wake", "quit" };
+
+typedef struct {
+    data_queue_t *q;
+    wait_act_t    act;
+} wait_ctx_t;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void act_thread(void *arg)
+{
+    wait_ctx_t *ctx = (wait_ctx_t *)arg;
+    media_lib_thread_sleep(ACT_DELAY_MS);
+    if (ctx->act == WAIT_ACT_SEND) {
+        data_queue_get_buffer(ctx->q, 8);
+        data_queue_send_buffer(ctx->q, 8);
+    } else if (ctx->act == WAIT_ACT_WAKE) {
+        data_queue_wake_reader(ctx->q);
+    } else if (ctx->act == WAIT_ACT_QUIT) {
+        data_queue_wakeup(ctx->q);
+    }
+    media_lib_thread_destroy(NULL);
+}
+
+static void check_wait(bool spsc, wait_act_t act, bool wake_only)
+{
+    wait_ctx_t ctx = {
+        .q = spsc ? data_queue_init_spsc(1024) : data_queue_init(1024),
+        .act = act,
+    };
+    data_queue_get_buffer(ctx.q, 8);
+    data_queue_send_buffer(ctx.q, 8);
+    media_lib_thread_handle_t thread;
+    media_lib_thread_create_from_scheduler(&thread, "act", act_thread, &ctx);
+    double start = now_ms();
+    int ret = data_queue_wait_arrive(ctx.q, wake_only ? -1 : 1, WAIT_TIMEOUT_MS);
+    double elapse = now_ms() - start;
+    // Send does not wake reader which only waits for wake up
+    bool early = (act == WAIT_ACT_SEND && wake_only == false) || act == WAIT_ACT_WAKE || act == WAIT_ACT_QUIT;
+    int expect = act == WAIT_ACT_QUIT ? -1 : early ? 0 : 1;
+    printf("%s %s%s: ret %d after %.0f ms\n", spsc ? "SPSC " : "Mutex", act_names[act],
+           wake_only ? " (wake only)" : "", ret, elapse);
+    TEST_CHECK(ret == expect, "%s %s wake_only %d ret %d", spsc ? "SPSC" : "Mutex", act_names[act], wake_only, ret);
+    if (early) {
+        TEST_CHECK(elapse < WAIT_TIMEOUT_MS - 50, "not woken early %.0f ms", elapse);
+    } else {
+        TEST_CHECK(elapse >= WAIT_TIMEOUT_MS - 5, "return before timeout %.0f ms", elapse);
+    }
+    if (act == WAIT_ACT_SEND && wake_only == false) {
+        // Already more blocks than q_num, no wait
+        start = now_ms();
+        ret = data_queue_wait_arrive(ctx.q, 1, WAIT_TIMEOUT_MS);
+        TEST_CHECK(ret == 0 && now_ms() - start < 20, "wait with 2 blocks ret %d", ret);
+    }
+    // Let action thread finish before queue is gone
+    media_lib_thread_sleep(ACT_DELAY_MS + 20);
+    data_queue_wakeup(ctx.q);
+    data_queue_deinit(ctx.q);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    for (int spsc = 0; spsc < 2; spsc++) {
+        for (wait_act_t act = WAIT_ACT_NONE; act <= WAIT_ACT_QUIT; act++) {
+            check_wait(spsc, act, false);
+            check_wait(spsc, act, true);
+        }
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,253 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Message queue with N senders and M receivers
+ *
+ * Every message must be received exactly once and no waiter may sleep forever (lost wakeup)
+ * Queue is kept much smaller than senders and receivers so that both full and empty waits happen often
+ * At last receivers blocked on empty queue and senders blocked on full queue must leave on wakeup, reset and destroy
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "media_lib_adapter.h"
+#include "msg_q.h"
+#include "host_test.h"
+
+#define MAX_THREADS     (16)
+#define BLOCKED_NUM     (8)
+#define QUIT_SENDER     (-1)
+#define STALL_TIMEOUT   (5)
+
+/* Not exported in public header, used by SAL users to kick waiters */
+int msg_q_reset(msg_q_handle_t q);
+int msg_q_wakeup(msg_q_handle_t q);
+
+typedef struct {
+    int sender;
+    int seq;
+} test_msg_t;
+
+typedef struct {
+    int senders;
+    int receivers;
+    int msg_num;
+    int slots;
+} torture_cfg_t;
+
+static msg_q_handle_t   msg_q;
+static torture_cfg_t    cfg;
+static uint8_t         *seen;
+static int              dup_num;
+static int              order_err;
+static int              send_err;
+static int              recv_num;
+static pthread_mutex_t  seen_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void *sender_thread(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    for (int i = 0; i < cfg.msg_num; i++) {
+        test_msg_t msg = { .sender = id, .seq = i };
+        if (msg_q_send(msg_q, &msg, sizeof(msg)) != 0) {
+            __atomic_add_fetch(&send_err, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+static void *receiver_thread(void *arg)
+{
+    // FIFO queue keeps order of each sender even with many receivers
+    int *last_seq = (int *)malloc(sizeof(int) * cfg.senders);
+    for (int i = 0; i < cfg.senders; i++) {
+        last_seq[i] = -1;
+    }
+    while (1) {
+        test_msg_t msg;
+        if (msg_q_recv(msg_q, &msg, sizeof(msg), false) != 0 || msg.sender == QUIT_SENDER) {
+            break;
+        }
+        if (msg.seq <= last_seq[msg.sender]) {
+            __atomic_add_fetch(&order_err, 1, __ATOMIC_RELAXED);
+        }
+        last_seq[msg.sender] = msg.seq;
+        pthread_mutex_lock(&seen_lock);
+        if (seen[msg.sender * cfg.msg_num + msg.seq]++) {
+            dup_num++;
+        }
+        recv_num++;
+        pthread_mutex_unlock(&seen_lock);
+    }
+    free(last_seq);
+    return NULL;
+}
+
+static void *watchdog_thread(void *arg)
+{
+    int last = -1;
+    int stall = 0;
+    while (1) {
+        sleep(1);
+        pthread_mutex_lock(&seen_lock);
+        int cur = recv_num;
+        pthread_mutex_unlock(&seen_lock);
+        stall = (cur == last) ? stall + 1 : 0;
+        last = cur;
+        if (stall >= STALL_TIMEOUT) {
+            // Waiter sleeps forever, report it instead of waiting for ctest timeout
+            printf("%dx%d slots %d: stalled after %d of %d messages, lost wakeup\n",
+                   cfg.senders, cfg.receivers, cfg.slots, cur, cfg.senders * cfg.msg_num);
+            fflush(stdout);
+            abort();
+        }
+    }
+    return NULL;
+}
+
+static void run_torture(int senders, int receivers, int msg_num, int slots)
+{
+    pthread_t send_th[MAX_THREADS], recv_th[MAX_THREADS];
+    cfg = (torture_cfg_t) { senders, receivers, msg_num, slots };
+    msg_q = msg_q_create(slots, sizeof(test_msg_t));
+    seen = (uint8_t *)calloc(senders * msg_num, 1);
+    dup_num = order_err = send_err = recv_num = 0;
+    for (int i = 0; i < receivers; i++) {
+        pthread_create(&recv_th[i], NULL, receiver_thread, NULL);
+    }
+    for (int i = 0; i < senders; i++) {
+        pthread_create(&send_th[i], NULL, sender_thread, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < senders; i++) {
+        pthread_join(send_th[i], NULL);
+    }
+    // One quit message for each receiver, queued after all data
+    for (int i = 0; i < receivers; i++) {
+        test_msg_t msg = { .sender = QUIT_SENDER };
+        msg_q_send(msg_q, &msg, sizeof(msg));
+    }
+    for (int i = 0; i < receivers; i++) {
+        pthread_join(recv_th[i], NULL);
+    }
+    int lost = 0;
+    for (int i = 0; i < senders * msg_num; i++) {
+        if (seen[i] == 0) {
+            lost++;
+        }
+    }
+    TEST_CHECK(send_err == 0, "%dx%d slots %d: %d send failed", senders, receivers, slots, send_err);
+    TEST_CHECK(lost == 0, "%dx%d slots %d: %d messages lost", senders, receivers, slots, lost);
+    TEST_CHECK(dup_num == 0, "%dx%d slots %d: %d messages duplicated", senders, receivers, slots, dup_num);
+    TEST_CHECK(order_err == 0, "%dx%d slots %d: %d messages out of order", senders, receivers, slots, order_err);
+    TEST_CHECK(msg_q_number(msg_q) == 0, "%dx%d slots %d: queue not empty", senders, receivers, slots);
+    msg_q_destroy(msg_q);
+    free(seen);
+}
+
+static void *blocked_recv_thread(void *arg)
+{
+    test_msg_t msg;
+    *(int *)arg = msg_q_recv(msg_q, &msg, sizeof(msg), false);
+    return NULL;
+}
+
+static void *blocked_send_thread(void *arg)
+{
+    test_msg_t msg = { 0 };
+    *(int *)arg = msg_q_send(msg_q, &msg, sizeof(msg));
+    return NULL;
+}
+
+static void start_blocked(pthread_t *th, int *ret, void *(*func)(void *))
+{
+    for (int i = 0; i < BLOCKED_NUM; i++) {
+        ret[i] = 1;
+        pthread_create(&th[i], NULL, func, &ret[i]);
+    }
+    // Give waiters time to sleep inside queue
+    usleep(20000);
+}
+
+static int join_blocked(pthread_t *th, int *ret)
+{
+    int kicked = 0;
+    for (int i = 0; i < BLOCKED_NUM; i++) {
+        pthread_join(th[i], NULL);
+        if (ret[i] == -2) {
+            kicked++;
+        }
+    }
+    return kicked;
+}
+
+static void run_kick(void)
+{
+    const int slots = 4;
+    pthread_t th[BLOCKED_NUM];
+    int ret[BLOCKED_NUM];
+    test_msg_t msg = { 0 };
+    msg_q = msg_q_create(slots, sizeof(test_msg_t));
+
+    // Wakeup kicks receivers blocked on empty queue
+    start_blocked(th, ret, blocked_recv_thread);
+    msg_q_wakeup(msg_q);
+    TEST_CHECK(join_blocked(th, ret) == BLOCKED_NUM, "Not all receivers left on wakeup");
+
+    // Reset kicks senders blocked on full queue and drops queued messages
+    while (msg_q_number(msg_q) < slots) {
+        msg_q_send(msg_q, &msg, sizeof(msg));
+    }
+    start_blocked(th, ret, blocked_send_thread);
+    msg_q_reset(msg_q);
+    TEST_CHECK(join_blocked(th, ret) == BLOCKED_NUM, "Not all senders left on reset");
+    TEST_CHECK(msg_q_number(msg_q) == 0, "Queue not empty after reset");
+
+    // Queue still usable after reset
+    TEST_CHECK(msg_q_send(msg_q, &msg, sizeof(msg)) == 0, "Send after reset failed");
+    TEST_CHECK(msg_q_recv(msg_q, &msg, sizeof(msg), true) == 0, "Receive after reset failed");
+    TEST_CHECK(msg_q_recv(msg_q, &msg, sizeof(msg), true) == 1, "Receive on empty queue not return 1");
+
+    // Destroy waits for blocked receivers to leave
+    start_blocked(th, ret, blocked_recv_thread);
+    msg_q_destroy(msg_q);
+    TEST_CHECK(join_blocked(th, ret) == BLOCKED_NUM, "Not all receivers left on destroy");
+}
+
+int main(void)
+{
+    pthread_t watchdog;
+    media_lib_add_default_adapter();
+    pthread_create(&watchdog, NULL, watchdog_thread, NULL);
+    pthread_detach(watchdog);
+    run_torture(1, 1, 200000, 1);
+    run_torture(4, 4, 50000, 2);
+    run_torture(8, 2, 20000, 4);
+    run_torture(2, 8, 50000, 1);
+    run_torture(16, 16, 10000, 8);
+    run_kick();
+    return TEST_RESULT();
+}
@@ -0,0 +1,231 @@
+/**
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/* Message queue in place access and priority order
+ *
+ * Reserved slots can be committed in any order, peeked head blocks other receivers until release,
+ * priority insert is stable and never passes peeked head, reset keeps peeked and reserved slots usable
+ * At last compare copy send/recv with in place reserve/commit and peek/release
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "media_lib_adapter.h"
+#include "msg_q.h"
+#include "host_test.h"
+
+#define SLOT_NUM       (8)
+#define BENCH_MSG_SIZE (4096)
+
+/* Not exported in public header, used by SAL users to kick waiters */
+int msg_q_reset(msg_q_handle_t q);
+
+typedef struct {
+    int prio;
+    int id;
+    char fill[21];
+} test_msg_t;
+
+static msg_q_handle_t q;
+
+static int cmp_prio(void *a, void *b, void *tag)
+{
+    // Smaller value first
+    return ((test_msg_t *)a)->prio - ((test_msg_t *)b)->prio;
+}
+
+static void send_msg(int prio, int id)
+{
+    test_msg_t msg = { .prio = prio, .id = id };
+    msg_q_send(q, &msg, sizeof(msg));
+}
+
+static int recv_id(void)
+{
+    test_msg_t msg = { .id = -1 };
+    if (msg_q_recv(q, &msg, sizeof(msg), true) != 0) {
+        return -1;
+    }
+    return msg.id;
+}
+
+static void *blocked_recv(void *arg)
+{
+    int *id = (int *)arg;
+    *id = recv_id();
+    // Wait till peeked head released
+    test_msg_t msg = { .id = -1 };
+    msg_q_recv(q, &msg, sizeof(msg), false);
+    *id = msg.id;
+    return NULL;
+}
+
+static void test_commit_order(void)
+{
+    test_msg_t *slot[3];
+    for (int i = 0; i < 3; i++) {
+        slot[i] = (test_msg_t *)msg_q_reserve(q, true);
+        TEST_CHECK(slot[i] && ((uintptr_t)slot[i] & 7) == 0, "reserve aligned slot %d", i);
+        slot[i]->id = i;
+    }
+    TEST_CHECK(msg_q_number(q) == 0, "reserved slot counted as message");
+    // Committed order decides queue order
+    msg_q_commit(q, slot[2]);
+    msg_q_commit(q, slot[0]);
+    TEST_CHECK(msg_q_commit(q, slot[0]) != 0, "commit twice");
+    msg_q_commit(q, slot[1]);
+    int order[3] = { recv_id(), recv_id(), recv_id() };
+    TEST_CHECK(order[0] == 2 && order[1] == 0 && order[2] == 1, "commit order %d %d %d", order[0], order[1],
+               order[2]);
+    // Reserved slots count as used
+    void *all[SLOT_NUM];
+    for (int i = 0; i < SLOT_NUM; i++) {
+        all[i] = msg_q_reserve(q, true);
+        TEST_CHECK(all[i] != NULL, "reserve %d", i);
+    }
+    TEST_CHECK(msg_q_reserve(q, true) == NULL, "reserve on full queue");
+    for (int i = 0; i < SLOT_NUM; i++) {
+        msg_q_commit(q, all[i]);
+    }
+    msg_q_reset(q);
+    TEST_CHECK(msg_q_number(q) == 0, "queue not empty after reset");
+}
+
+static void test_peek(void)
+{
+    send_msg(0, 10);
+    send_msg(0, 11);
+    test_msg_t *head = (test_msg_t *)msg_q_peek(q, true);
+    TEST_CHECK(head && head->id == 10, "peek head");
+    TEST_CHECK(recv_id() == -1, "receive while head peeked");
+    // Blocked receiver gets next message only after release
+    int got = -2;
+    pthread_t th;
+    pthread_create(&th, NULL, blocked_recv, &got);
+    usleep(20000);
+    TEST_CHECK(got == -1, "receiver not blocked by peeked head, got %d", got);
+    TEST_CHECK(msg_q_release(q, head) == 0, "release head");
+    TEST_CHECK(msg_q_release(q, head) != 0, "release twice");
+    pthread_join(th, NULL);
+    TEST_CHECK(got == 11, "receiver after release got %d", got);
+    TEST_CHECK(msg_q_number(q) == 0, "queue left %d", msg_q_number(q));
+}
+
+static void test_priority(void)
+{
+    send_msg(3, 0);
+    send_msg(1, 1);
+    send_msg(3, 2);
+    send_msg(2, 3);
+    // Sort queued messages at once, same priority keeps order
+    msg_q_sort(q, cmp_prio, NULL);
+    test_msg_t *head = (test_msg_t *)msg_q_peek(q, true);
+    TEST_CHECK(head && head->id == 1, "head after sort %d", head ? head->id : -1);
+    // New message with top priority never passes peeked head
+    send_msg(0, 4);
+    send_msg(2, 5);
+    msg_q_release(q, head);
+    int expect[] = { 4, 3, 5, 0, 2 };
+    for (int i = 0; i < 5; i++) {
+        int id = recv_id();
+        TEST_CHECK(id == expect[i], "priority order %d got %d expect %d", i, id, expect[i]);
+    }
+    msg_q_sort(q, NULL, NULL);
+    send_msg(3, 6);
+    send_msg(1, 7);
+    TEST_CHECK(recv_id() == 6 && recv_id() == 7, "FIFO restored");
+}
+
+static void test_reset(void)
+{
+    send_msg(0, 20);
+    send_msg(0, 21);
+    test_msg_t *head = (test_msg_t *)msg_q_peek(q, true);
+    test_msg_t *slot = (test_msg_t *)msg_q_reserve(q, true);
+    send_msg(0, 22);
+    msg_q_reset(q);
+    // Peeked head stays until release, reserved slot can still be committed
+    TEST_CHECK(msg_q_number(q) == 1 && head->id == 20, "after reset %d messages", msg_q_number(q));
+    TEST_CHECK(msg_q_release(q, head) == 0, "release head after reset");
+    slot->id = 23;
+    TEST_CHECK(msg_q_commit(q, slot) == 0, "commit after reset");
+    TEST_CHECK(recv_id() == 23 && recv_id() == -1, "only committed slot left");
+    // All slots usable again
+    for (int i = 0; i < SLOT_NUM; i++) {
+        send_msg(0, 30 + i);
+    }
+    TEST_CHECK(msg_q_number(q) == SLOT_NUM, "queue full after reset %d", msg_q_number(q));
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_in_place(void)
+{
+    const int n = 200000;
+    msg_q_handle_t bq = msg_q_create(SLOT_NUM, BENCH_MSG_SIZE);
+    uint8_t *msg = (uint8_t *)calloc(1, BENCH_MSG_SIZE);
+    uint64_t start = now_ns();
+    for (int i = 0; i < n; i++) {
+        msg[0] = (uint8_t)i;
+        msg_q_send(bq, msg, BENCH_MSG_SIZE);
+        msg_q_recv(bq, msg, BENCH_MSG_SIZE, true);
+    }
+    uint64_t copy_ns = now_ns() - start;
+    start = now_ns();
+    for (int i = 0; i < n; i++) {
+        uint8_t *slot = (uint8_t *)msg_q_reserve(bq, true);
+        slot[0] = (uint8_t)i;
+        msg_q_commit(bq, slot);
+        slot = (uint8_t *)msg_q_peek(bq, true);
+        msg_q_release(bq, slot);
+    }
+    uint64_t in_place_ns = now_ns() - start;
+    printf("%d bytes message: copy %.1f ns/op, in place %.1f ns/op\n", BENCH_MSG_SIZE,
+           (double)copy_ns / n, (double)in_place_ns / n);
+    free(msg);
+    msg_q_destroy(bq);
+}
+
+int main(void)
+{
+    media_lib_add_default_adapter();
+    q = msg_q_create(SLOT_NUM, sizeof(test_msg_t));
+    test_commit_order();
+    test_peek();
+    test_priority();
+    test_reset();
+    msg_q_destroy(q);
+    bench_in_place();
+    return TEST_RESULT();
+}
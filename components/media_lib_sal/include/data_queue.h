@@ -25,6 +25,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,19 +36,38 @@ extern "C" {
  *        Data queue works like a queue, you can receive the exact size of data as you send previously.
  *        It allows you to get continuous buffer so that no need to care ring back issue.
  *        It adds a fill_end member to record fifo write end position before ring back.
+ *
+ *        When created by `data_queue_init_spsc`, queue works in single producer single consumer mode:
+ *        Read side is lock free, write side only takes `write_lock` to serialize writers.
+ *        Reader and writer share atomic in/out counters, event group is only touched when one side need sleep.
+ *
+ *        In and out counters are kept in both modes so that occupancy query is constant time.
  */
 typedef struct {
-    void *buffer;     /*!< Buffer for queue */
-    int   size;       /*!< Buffer size */
-    int   fill_end;   /*!< Buffer write position before ring back */
-    int   wp;         /*!< Write pointer */
-    int   rp;         /*!< Read pointer */
-    int   filled;     /*!< Buffer filled size */
-    int   user;       /*!< Buffer reference by reader or writer */
-    int   quit;       /*!< Buffer quit flag */
-    void *lock;       /*!< Protect lock */
-    void *write_lock; /*!< Write lock to let only one writer at same time */
-    void *event;      /*!< Event group to wake up reader or writer */
+    void     *buffer;      /*!< Buffer for queue */
+    int       size;        /*!< Buffer size */
+    int       fill_end;    /*!< Buffer write position before ring back */
+    int       wp;          /*!< Write pointer */
+    int       rp;          /*!< Read pointer */
+    int       filled;      /*!< Buffer filled size */
+    int       user;        /*!< Buffer reference by reader or writer */
+    int       quit;        /*!< Buffer quit flag */
+    void     *lock;        /*!< Protect lock */
+    void     *write_lock;  /*!< Write lock to let only one writer at same time */
+    void     *event;       /*!< Event group to wake up reader or writer */
+    bool      spsc;        /*!< Single producer single consumer mode */
+    uint32_t  in_total;    /*!< Total bytes sent including block head and ring back slack */
+    uint32_t  out_total;   /*!< Total bytes consumed including block head and ring back slack */
+    uint32_t  in_num;      /*!< Total blocks sent */
+    uint32_t  out_num;     /*!< Total blocks consumed */
+    uint32_t  in_size;     /*!< Total data size sent */
+    uint32_t  out_size;    /*!< Total data size consumed */
+    int       reserve_pos; /*!< SPSC: Position of block being written */
+    int       reserve_pad; /*!< SPSC: Padding before block being written when ring back */
+    int       reserve_len; /*!< SPSC: Block size reserved by writer */
+    bool      reserved;    /*!< SPSC: Writer holds write lock and user count from `data_queue_get_buffer` */
+    int       read_wait;   /*!< SPSC: Reader is waiting for data */
+    int       write_wait;  /*!< SPSC: Number of writer waits for space or drain */
 } data_queue_t;
 
 /**
@@ -59,6 +79,20 @@ typedef struct {
  */
 data_queue_t *data_queue_init(int size);
 
+/**
+ * @brief         Initialize data queue in single producer single consumer mode
+ *
+ * @note          Only one thread can read from the queue (`data_queue_read_lock`, `data_queue_read_unlock`,
+ *                `data_queue_peek_unlock` and `data_queue_consume_all`)
+ *                Writers are still serialized so that occasional write from other thread is safe
+ *                Query APIs can be called from any thread
+ *
+ * @param         size: Buffer size
+ * @return        - NULL: Fail to initialize queue
+ *                - Others: Data queue instance
+ */
+data_queue_t *data_queue_init_spsc(int size);
+
 /**
  * @brief         Wakeup thread which wait on queue data
  *
@@ -134,6 +168,44 @@ int data_queue_read_unlock(data_queue_t *q);
  */
 int data_queue_peek_unlock(data_queue_t *q);
 
+/**
+ * @brief         Wait for new data arrival without holding data
+ *
+ * @note          Used by reader to block until more data come instead of polling
+ *                Returns early when woken by `data_queue_wake_reader` or `data_queue_wakeup`
+ *                Spurious return is possible, caller need check queue status again
+ *
+ * @param         q: Data queue instance
+ * @param         q_num: Return when queued block number exceed it, set to -1 to only wait for wake up
+ * @param         timeout: Maximum wait time in milliseconds
+ * @return        - 0: Data arrived or woken up
+ *                - 1: Wait timeout
+ *                - -1: Queue is quit or invalid argument
+ */
+int data_queue_wait_arrive(data_queue_t *q, int q_num, uint32_t timeout);
+
+/**
+ * @brief         Wake up reader blocked in `data_queue_wait_arrive`
+ *
+ * @param         q: Data queue instance
+ */
+void data_queue_wake_reader(data_queue_t *q);
+
+/**
+ * @brief         Wait for queued data to be consumed by reader
+ *
+ * @note          Used by writer to know reader progress instead of polling
+ *                Returns on each consume, spurious return is possible, caller need check queue status again
+ *
+ * @param         q: Data queue instance
+ * @param         q_num: Return when queued block number not exceed it
+ * @param         timeout: Maximum wait time in milliseconds
+ * @return        - 0: Data consumed or queued block number already not exceed `q_num`
+ *                - 1: Wait timeout
+ *                - -1: Queue is quit or invalid argument
+ */
+int data_queue_wait_drain(data_queue_t *q, int q_num, uint32_t timeout);
+
 /**
  * @brief         Consume all data in queue
  *
@@ -35,6 +35,16 @@ extern "C" {
  */
 typedef struct msg_q_t* msg_q_handle_t;
 
+/**
+ * @brief  Message compare function for priority queue
+ *
+ * @return
+ *       - > 0     Message `a` need be placed after message `b`
+ *       - Others  Keep current order
+ *
+ */
+typedef int (*msg_q_cmp)(void *a, void *b, void *tag);
+
 /**
  * @brief  Create message queue
  *
@@ -78,6 +88,79 @@ int msg_q_send(msg_q_handle_t q, void *msg, int size);
  */
 int msg_q_recv(msg_q_handle_t q, void *msg, int size, bool no_wait);
 
+/**
+ * @brief  Reserve one message slot so that message can be built in place
+ *
+ * @note  Reserved slot must be committed by `msg_q_commit` later
+ *
+ * @param[in]   q        Message queue handle
+ * @param[in]   no_wait  If true, return immediately if queue is full
+ *
+ * @return
+ *       - NULL    Queue full with no_wait, or woken up by reset or destroy
+ *       - Others  Slot to fill message into, size is msg_size when created
+ *
+ */
+void *msg_q_reserve(msg_q_handle_t q, bool no_wait);
+
+/**
+ * @brief  Commit reserved message slot into queue
+ *
+ * @param[in]   q    Message queue handle
+ * @param[in]   msg  Slot returned by `msg_q_reserve`
+ *
+ * @return
+ *       - 0    On success
+ *       - -1   Slot is not reserved
+ *
+ */
+int msg_q_commit(msg_q_handle_t q, void *msg);
+
+/**
+ * @brief  Peek message at queue head without copy
+ *
+ * @note  Peeked message stays in queue until `msg_q_release`, other receivers wait during this period
+ *
+ * @param[in]   q        Message queue handle
+ * @param[in]   no_wait  If true, return immediately if no message in queue
+ *
+ * @return
+ *       - NULL    No message with no_wait, or woken up by reset or destroy
+ *       - Others  Message at queue head
+ *
+ */
+void *msg_q_peek(msg_q_handle_t q, bool no_wait);
+
+/**
+ * @brief  Release message peeked by `msg_q_peek` and remove it from queue
+ *
+ * @param[in]   q    Message queue handle
+ * @param[in]   msg  Message returned by `msg_q_peek`
+ *
+ * @return
+ *       - 0    On success
+ *       - -1   Message is not peeked
+ *
+ */
+int msg_q_release(msg_q_handle_t q, void *msg);
+
+/**
+ * @brief  Keep messages in queue sorted by compare function
+ *
+ * @note  Queued messages are sorted at once, later sent messages are inserted by priority
+ *        Messages of same priority keep sending order, set `cmp_func` to NULL to restore FIFO order
+ *
+ * @param[in]   q         Message queue handle
+ * @param[in]   cmp_func  Message compare function
+ * @param[in]   tag       User context passed to compare function
+ *
+ * @return
+ *       - 0    On success
+ *       - -1   Invalid argument
+ *
+ */
+int msg_q_sort(msg_q_handle_t q, msg_q_cmp cmp_func, void *tag);
+
 /**
  * @brief  Get items number in message queue
  *
@@ -274,8 +274,8 @@ int media_lib_mutex_destroy(media_lib_mutex_handle_t mutex)
 
 int media_lib_enter_critical_section(void)
 {
-    if (media_os_lib.leave_critical) {
-        return media_os_lib.leave_critical();
+    if (media_os_lib.enter_critical) {
+        return media_os_lib.enter_critical();
     }
     return ESP_ERR_NOT_SUPPORTED;
 }
@@ -24,6 +24,7 @@
  *
  */
 
+#include <stdlib.h>
 #include "media_lib_mem_his.h"
 #include "media_lib_mem_trace.h"
 #include "media_lib_err.h"
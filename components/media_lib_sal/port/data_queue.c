@@ -24,11 +24,17 @@
 
 #include "media_lib_os.h"
 #include "data_queue.h"
+#include "esp_log.h"
+
+#define TAG "DATA_Q"
 
 #define DATA_Q_ALLOC_HEAD_SIZE   (4)
 #define DATA_Q_DATA_ARRIVE_BITS  (1)
 #define DATA_Q_DATA_CONSUME_BITS (2)
 #define DATA_Q_USER_FREE_BITS    (4)
+#define DATA_Q_READER_WAKE_BITS  (8)
+// Consume notify for drain waiter, kept apart so that its clear not eat wake up of writer waiting for space
+#define DATA_Q_DATA_DRAIN_BITS   (16)
 
 #define _SET_BITS(group, bit)    media_lib_event_group_set_bits((media_lib_event_grp_handle_t) group, bit)
 // Need manual clear bits
@@ -39,6 +45,21 @@
 #define _MUTEX_LOCK(mutex)   media_lib_mutex_lock((media_lib_mutex_handle_t) mutex, MEDIA_LIB_MAX_LOCK_TIME)
 #define _MUTEX_UNLOCK(mutex) media_lib_mutex_unlock((media_lib_mutex_handle_t) mutex)
 
+// SPSC block is aligned so that block head can be accessed directly
+#define DATA_Q_SPSC_ALIGN(size)  (((size) + DATA_Q_ALLOC_HEAD_SIZE - 1) & ~(DATA_Q_ALLOC_HEAD_SIZE - 1))
+// Block head value to mark left buffer before ring back as padding
+#define DATA_Q_SPSC_PAD_HEAD     (0)
+// Set in user count when quit so that user release goes through lock
+#define DATA_Q_SPSC_USER_QUIT    (0x40000000)
+
+#define _ATOMIC_LOAD(v)          __atomic_load_n(&(v), __ATOMIC_SEQ_CST)
+#define _ATOMIC_STORE(v, d)      __atomic_store_n(&(v), d, __ATOMIC_SEQ_CST)
+#define _ATOMIC_LOAD_RELAXED(v)  __atomic_load_n(&(v), __ATOMIC_RELAXED)
+#define _ATOMIC_STORE_RELAXED(v, d) __atomic_store_n(&(v), d, __ATOMIC_RELAXED)
+#define _ATOMIC_ADD(v, d)        __atomic_add_fetch(&(v), d, __ATOMIC_SEQ_CST)
+#define _ATOMIC_OR(v, d)         __atomic_or_fetch(&(v), d, __ATOMIC_SEQ_CST)
+#define _ATOMIC_CAS(v, cur, d)   __atomic_compare_exchange_n(&(v), &(cur), d, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
 static int data_queue_release_user(data_queue_t *q)
 {
     _SET_BITS(q->event, DATA_Q_USER_FREE_BITS);
@@ -65,7 +86,7 @@ static int data_queue_wait_data(data_queue_t *q)
 
 static int data_queue_data_consumed(data_queue_t *q)
 {
-    _SET_BITS(q->event, DATA_Q_DATA_CONSUME_BITS);
+    _SET_BITS(q->event, DATA_Q_DATA_CONSUME_BITS | DATA_Q_DATA_DRAIN_BITS);
     return 0;
 }
 
@@ -102,6 +123,341 @@ static bool _data_queue_have_data_from_last(data_queue_t *q)
     return q->filled ? true : false;
 }
 
+/* Consume front block and update counters, need hold lock */
+static void _data_queue_consume(data_queue_t *q)
+{
+    uint8_t *buffer = (uint8_t *) q->buffer + q->rp;
+    int size = *((int *) buffer);
+    if (size < 0 || size > q->size) {
+        *(int*)0 = 0;
+    }
+    q->rp += size;
+    q->filled -= size;
+    q->out_num++;
+    q->out_size += size - DATA_Q_ALLOC_HEAD_SIZE;
+    q->out_total += size;
+    if (q->fill_end && q->rp >= q->fill_end) {
+        // Ring back slack is released together
+        q->out_total += q->size - q->fill_end;
+        q->fill_end = 0;
+        q->rp = 0;
+    }
+}
+
+/*   SPSC mode:
+ *   Writer owns wp, in_xxx counters, reader owns rp, out_xxx counters
+ *   Used size is in_total - out_total, queue is empty when they are equal
+ *   When left buffer is not enough, writer mark it as padding and write from start
+ *   When queue is empty, writer can reset rp to 0 safely for reader only move rp when have data
+ *   Each API holds one user count during access so that wakeup can wait for all users leave
+ */
+static void data_queue_spsc_add_user(data_queue_t *q)
+{
+    _ATOMIC_ADD(q->user, 1);
+}
+
+static void data_queue_spsc_release_user(data_queue_t *q)
+{
+    int user = _ATOMIC_LOAD(q->user);
+    while ((user & DATA_Q_SPSC_USER_QUIT) == 0) {
+        if (_ATOMIC_CAS(q->user, user, user - 1)) {
+            return;
+        }
+    }
+    // Quit in progress, release under lock so that wakeup can wait for it
+    _MUTEX_LOCK(q->lock);
+    _ATOMIC_ADD(q->user, -1);
+    data_queue_release_user(q);
+    _MUTEX_UNLOCK(q->lock);
+}
+
+static int data_queue_spsc_wait_data(data_queue_t *q)
+{
+    _ATOMIC_STORE(q->read_wait, 1);
+    // Check again after set wait flag to avoid missing notify, stale bits only cause one more check
+    if (_ATOMIC_LOAD(q->in_total) == q->out_total && _ATOMIC_LOAD(q->quit) == 0) {
+        _WAIT_BITS(q->event, DATA_Q_DATA_ARRIVE_BITS);
+    }
+    _ATOMIC_STORE(q->read_wait, 0);
+    return _ATOMIC_LOAD(q->quit) ? -1 : 0;
+}
+
+static int data_queue_spsc_wait_consume(data_queue_t *q, uint32_t need)
+{
+    _ATOMIC_ADD(q->write_wait, 1);
+    if (q->size - (q->in_total - _ATOMIC_LOAD(q->out_total)) < need && _ATOMIC_LOAD(q->quit) == 0) {
+        _WAIT_BITS(q->event, DATA_Q_DATA_CONSUME_BITS);
+    }
+    _ATOMIC_ADD(q->write_wait, -1);
+    return _ATOMIC_LOAD(q->quit) ? -1 : 0;
+}
+
+static void data_queue_spsc_notify_data(data_queue_t *q)
+{
+    if (_ATOMIC_LOAD(q->read_wait)) {
+        data_queue_notify_data(q);
+    }
+}
+
+static void data_queue_spsc_data_consumed(data_queue_t *q)
+{
+    if (_ATOMIC_LOAD(q->write_wait) > 0) {
+        data_queue_data_consumed(q);
+    }
+}
+
+static int data_queue_spsc_queued_num(data_queue_t *q)
+{
+    // Load in_total firstly so that block counter published with it is visible
+    _ATOMIC_LOAD(q->in_total);
+    return (int) (_ATOMIC_LOAD(q->in_num) - _ATOMIC_LOAD(q->out_num));
+}
+
+static int data_queue_spsc_wait_arrive(data_queue_t *q, int q_num, uint32_t timeout)
+{
+    uint32_t bits = q_num < 0 ? DATA_Q_READER_WAKE_BITS : DATA_Q_DATA_ARRIVE_BITS;
+    int ret = 0;
+    data_queue_spsc_add_user(q);
+    if (q_num >= 0) {
+        _ATOMIC_STORE(q->read_wait, 1);
+    }
+    // Check again after set wait flag to avoid missing notify
+    if (_ATOMIC_LOAD(q->quit) == 0 &&
+        (q_num < 0 || data_queue_spsc_queued_num(q) <= q_num)) {
+        uint32_t got = media_lib_event_group_wait_bits((media_lib_event_grp_handle_t) q->event, bits, timeout);
+        media_lib_event_group_clr_bits(q->event, DATA_Q_DATA_ARRIVE_BITS | DATA_Q_READER_WAKE_BITS);
+        ret = (got & bits) ? 0 : 1;
+    }
+    _ATOMIC_STORE(q->read_wait, 0);
+    if (_ATOMIC_LOAD(q->quit)) {
+        ret = -1;
+    }
+    data_queue_spsc_release_user(q);
+    return ret;
+}
+
+static int data_queue_spsc_wait_drain(data_queue_t *q, int q_num, uint32_t timeout)
+{
+    int ret = 0;
+    data_queue_spsc_add_user(q);
+    // Consume is notified while any writer waits, clear stale drain notify after counted in
+    _ATOMIC_ADD(q->write_wait, 1);
+    media_lib_event_group_clr_bits(q->event, DATA_Q_DATA_DRAIN_BITS);
+    if (_ATOMIC_LOAD(q->quit) == 0 && data_queue_spsc_queued_num(q) > q_num) {
+        uint32_t got = media_lib_event_group_wait_bits((media_lib_event_grp_handle_t) q->event,
+                                                       DATA_Q_DATA_DRAIN_BITS, timeout);
+        media_lib_event_group_clr_bits(q->event, DATA_Q_DATA_DRAIN_BITS);
+        ret = (got & DATA_Q_DATA_DRAIN_BITS) ? 0 : 1;
+    }
+    _ATOMIC_ADD(q->write_wait, -1);
+    if (_ATOMIC_LOAD(q->quit)) {
+        ret = -1;
+    }
+    data_queue_spsc_release_user(q);
+    return ret;
+}
+
+static void data_queue_spsc_wakeup(data_queue_t *q)
+{
+    _ATOMIC_STORE(q->quit, 1);
+    _MUTEX_LOCK(q->lock);
+    _ATOMIC_OR(q->user, DATA_Q_SPSC_USER_QUIT);
+    // send quit message to let user quit
+    _SET_BITS(q->event, DATA_Q_READER_WAKE_BITS);
+    data_queue_notify_data(q);
+    data_queue_data_consumed(q);
+    while (_ATOMIC_LOAD(q->user) & ~DATA_Q_SPSC_USER_QUIT) {
+        data_queue_wait_user(q);
+    }
+    _MUTEX_UNLOCK(q->lock);
+}
+
+/* Get front block position skipping padding, return -1 if empty */
+static int data_queue_spsc_front(data_queue_t *q)
+{
+    while (_ATOMIC_LOAD(q->in_total) != q->out_total) {
+        int rp = _ATOMIC_LOAD_RELAXED(q->rp);
+        if (q->size - rp >= DATA_Q_ALLOC_HEAD_SIZE &&
+            *(int *) ((uint8_t *) q->buffer + rp) != DATA_Q_SPSC_PAD_HEAD) {
+            return rp;
+        }
+        // Skip padding and notify writer for space released
+        _ATOMIC_STORE_RELAXED(q->rp, 0);
+        _ATOMIC_STORE(q->out_total, q->out_total + (q->size - rp));
+        data_queue_spsc_data_consumed(q);
+    }
+    return -1;
+}
+
+static void *data_queue_spsc_get_buffer(data_queue_t *q, int size)
+{
+    int need = DATA_Q_SPSC_ALIGN(size + DATA_Q_ALLOC_HEAD_SIZE);
+    if (need > q->size) {
+        return NULL;
+    }
+    data_queue_spsc_add_user(q);
+    _MUTEX_LOCK(q->write_lock);
+    while (_ATOMIC_LOAD(q->quit) == 0) {
+        uint32_t used = q->in_total - _ATOMIC_LOAD(q->out_total);
+        int wp = q->wp;
+        if (used == 0 && q->size - wp < need) {
+            // Reader is idle when empty, restart from buffer start
+            _ATOMIC_STORE_RELAXED(q->rp, 0);
+            _ATOMIC_STORE_RELAXED(q->wp, 0);
+            wp = 0;
+        }
+        int pad = (q->size - wp < need) ? q->size - wp : 0;
+        if (q->size - used >= (uint32_t) (pad + need)) {
+            q->reserve_pos = pad ? 0 : wp;
+            q->reserve_pad = pad;
+            q->reserve_len = need;
+            q->reserved = true;
+            return (uint8_t *) q->buffer + q->reserve_pos + DATA_Q_ALLOC_HEAD_SIZE;
+        }
+        if (data_queue_spsc_wait_consume(q, pad + need) != 0) {
+            break;
+        }
+    }
+    _MUTEX_UNLOCK(q->write_lock);
+    data_queue_spsc_release_user(q);
+    return NULL;
+}
+
+static int data_queue_spsc_send_buffer(data_queue_t *q, int size)
+{
+    int ret = -1;
+    if (q->reserved == false) {
+        // Get buffer failed, write lock and user count already released
+        ESP_LOGE(TAG, "Send %d without buffer reserved", size);
+        return -1;
+    }
+    if (size == 0) {
+        ret = 0;
+    } else if (size > 0 && DATA_Q_SPSC_ALIGN(size + DATA_Q_ALLOC_HEAD_SIZE) <= q->reserve_len) {
+        int need = DATA_Q_SPSC_ALIGN(size + DATA_Q_ALLOC_HEAD_SIZE);
+        if (q->reserve_pad >= DATA_Q_ALLOC_HEAD_SIZE) {
+            *(int *) ((uint8_t *) q->buffer + q->wp) = DATA_Q_SPSC_PAD_HEAD;
+        }
+        *(int *) ((uint8_t *) q->buffer + q->reserve_pos) = size + DATA_Q_ALLOC_HEAD_SIZE;
+        int wp = q->reserve_pos + need;
+        _ATOMIC_STORE_RELAXED(q->wp, wp == q->size ? 0 : wp);
+        _ATOMIC_STORE_RELAXED(q->in_num, q->in_num + 1);
+        _ATOMIC_STORE_RELAXED(q->in_size, q->in_size + size);
+        // Publish block to reader
+        _ATOMIC_STORE(q->in_total, q->in_total + q->reserve_pad + need);
+        data_queue_spsc_notify_data(q);
+        ret = 0;
+    } else {
+        ESP_LOGE(TAG, "Send %d exceed reserved %d", size, q->reserve_len);
+    }
+    q->reserve_len = 0;
+    q->reserved = false;
+    // Release lock before user so that wakeup can make sure lock is not used
+    _MUTEX_UNLOCK(q->write_lock);
+    data_queue_spsc_release_user(q);
+    return ret;
+}
+
+static int data_queue_spsc_read_lock(data_queue_t *q, void **buffer, int *size)
+{
+    data_queue_spsc_add_user(q);
+    while (_ATOMIC_LOAD(q->quit) == 0) {
+        int rp = data_queue_spsc_front(q);
+        if (rp < 0) {
+            if (data_queue_spsc_wait_data(q) != 0) {
+                break;
+            }
+            continue;
+        }
+        uint8_t *data_buffer = (uint8_t *) q->buffer + rp;
+        int data_size = *((int *) data_buffer);
+        if (data_size < DATA_Q_ALLOC_HEAD_SIZE || data_size > q->size - rp) {
+            *(int*)0 = 0;
+        }
+        *buffer = data_buffer + DATA_Q_ALLOC_HEAD_SIZE;
+        *size = data_size - DATA_Q_ALLOC_HEAD_SIZE;
+        // Keep user count until unlock
+        return 0;
+    }
+    data_queue_spsc_release_user(q);
+    return -1;
+}
+
+static void data_queue_spsc_consume(data_queue_t *q, int rp)
+{
+    int size = *(int *) ((uint8_t *) q->buffer + rp);
+    if (size < DATA_Q_ALLOC_HEAD_SIZE || size > q->size - rp) {
+        *(int*)0 = 0;
+    }
+    int len = DATA_Q_SPSC_ALIGN(size);
+    rp += len;
+    _ATOMIC_STORE_RELAXED(q->rp, rp == q->size ? 0 : rp);
+    _ATOMIC_STORE_RELAXED(q->out_num, q->out_num + 1);
+    _ATOMIC_STORE_RELAXED(q->out_size, q->out_size + size - DATA_Q_ALLOC_HEAD_SIZE);
+    _ATOMIC_STORE(q->out_total, q->out_total + len);
+    data_queue_spsc_data_consumed(q);
+}
+
+static int data_queue_spsc_read_unlock(data_queue_t *q)
+{
+    int rp = data_queue_spsc_front(q);
+    if (rp >= 0) {
+        data_queue_spsc_consume(q, rp);
+        data_queue_spsc_release_user(q);
+    }
+    return 0;
+}
+
+static int data_queue_spsc_consume_all(data_queue_t *q)
+{
+    int rp;
+    data_queue_spsc_add_user(q);
+    while (_ATOMIC_LOAD(q->quit) == 0 && (rp = data_queue_spsc_front(q)) >= 0) {
+        data_queue_spsc_consume(q, rp);
+    }
+    data_queue_spsc_release_user(q);
+    return 0;
+}
+
+static int data_queue_spsc_get_available(data_queue_t *q)
+{
+    uint32_t used = _ATOMIC_LOAD(q->in_total) - _ATOMIC_LOAD(q->out_total);
+    int wp = _ATOMIC_LOAD_RELAXED(q->wp);
+    int free_size = q->size - (int) used;
+    int avail;
+    if (used == 0) {
+        avail = q->size;
+    } else if (wp <= _ATOMIC_LOAD_RELAXED(q->rp)) {
+        // Same position with data means full
+        avail = free_size;
+    } else {
+        // Either left buffer or buffer before read position after padding
+        int left = q->size - wp;
+        avail = left > free_size - left ? left : free_size - left;
+    }
+    avail &= ~(DATA_Q_ALLOC_HEAD_SIZE - 1);
+    return avail >= DATA_Q_ALLOC_HEAD_SIZE ? avail - DATA_Q_ALLOC_HEAD_SIZE : 0;
+}
+
+static void data_queue_get_count(data_queue_t *q, int *q_num, int *q_size)
+{
+    // Load consumed counters firstly so that result never goes negative
+    uint32_t out_num = _ATOMIC_LOAD(q->out_num);
+    uint32_t out_size = _ATOMIC_LOAD(q->out_size);
+    *q_num = (int) (_ATOMIC_LOAD(q->in_num) - out_num);
+    *q_size = (int) (_ATOMIC_LOAD(q->in_size) - out_size);
+}
+
+data_queue_t *data_queue_init_spsc(int size)
+{
+    // Align size so that padding always have room for block head
+    data_queue_t *q = data_queue_init(size & ~(DATA_Q_ALLOC_HEAD_SIZE - 1));
+    if (q) {
+        q->spsc = true;
+    }
+    return q;
+}
+
 data_queue_t *data_queue_init(int size)
 {
     data_queue_t *q = media_lib_calloc(1, sizeof(data_queue_t));
@@ -122,10 +478,15 @@ data_queue_t *data_queue_init(int size)
 
 void data_queue_wakeup(data_queue_t *q)
 {
+    if (q && q->spsc) {
+        data_queue_spsc_wakeup(q);
+        return;
+    }
     if (q && q->lock) {
         _MUTEX_LOCK(q->lock);
         q->quit = 1;
         // send quit message to let user quit
+        _SET_BITS(q->event, DATA_Q_READER_WAKE_BITS);
         data_queue_notify_data(q);
         data_queue_data_consumed(q);
         while (q->user) {
@@ -137,23 +498,16 @@ void data_queue_wakeup(data_queue_t *q)
 
 int data_queue_consume_all(data_queue_t *q)
 {
+    if (q && q->spsc) {
+        return data_queue_spsc_consume_all(q);
+    }
     if (q && q->lock) {
         _MUTEX_LOCK(q->lock);
         while (_data_queue_have_data(q)) {
             if (q->quit) {
                 break;
             }
-            uint8_t *buffer = (uint8_t *) q->buffer + q->rp;
-            int size = *((int *) buffer);
-            if (size < 0 || size >= q->size) {
-                *(int*)0 = 0;
-            }
-            q->rp += size;
-            q->filled -= size;
-            if (q->fill_end && q->rp >= q->fill_end) {
-                q->fill_end = 0;
-                q->rp = 0;
-            }
+            _data_queue_consume(q);
             data_queue_data_consumed(q);
         }
         _MUTEX_UNLOCK(q->lock);
@@ -204,6 +558,9 @@ int data_queue_get_available(data_queue_t *q)
     if (q == NULL) {
         return 0;
     }
+    if (q->spsc) {
+        return data_queue_spsc_get_available(q);
+    }
     _MUTEX_LOCK(q->lock);
     int avail;
     // Handle corner case [0 rp==wp fifo_end]
@@ -225,6 +582,9 @@ int data_queue_get_available(data_queue_t *q)
 void *data_queue_get_buffer(data_queue_t *q, int size)
 {
     int avail = 0;
+    if (q && q->spsc) {
+        return data_queue_spsc_get_buffer(q, size);
+    }
     size += DATA_Q_ALLOC_HEAD_SIZE;
     if (q == NULL || size > q->size) {
         return NULL;
@@ -240,6 +600,10 @@ void *data_queue_get_buffer(data_queue_t *q, int size)
             }
             q->fill_end = q->wp;
             q->wp = 0;
+            if (q->fill_end) {
+                // Count ring back slack as used until reader ring back
+                q->in_total += q->size - q->fill_end;
+            }
             avail = get_available_size(q);
         }
         if (avail >= size) {
@@ -263,6 +627,9 @@ void *data_queue_get_write_data(data_queue_t *q)
     if (q == NULL) {
         return NULL;
     }
+    if (q->spsc) {
+        return (uint8_t *) q->buffer + q->reserve_pos + DATA_Q_ALLOC_HEAD_SIZE;
+    }
     _MUTEX_LOCK(q->lock);
     uint8_t *buffer = (uint8_t *) q->buffer + q->wp;
     _MUTEX_UNLOCK(q->lock);
@@ -275,6 +642,9 @@ int data_queue_send_buffer(data_queue_t *q, int size)
     if (q == NULL) {
         return -1;
     }
+    if (q->spsc) {
+        return data_queue_spsc_send_buffer(q, size);
+    }
     _MUTEX_LOCK(q->lock);
     if (size == 0) {
         q->user--;
@@ -292,6 +662,9 @@ int data_queue_send_buffer(data_queue_t *q, int size)
         }
         q->wp += size;
         q->filled += size;
+        q->in_num++;
+        q->in_size += size - DATA_Q_ALLOC_HEAD_SIZE;
+        q->in_total += size;
         q->user--;
         data_queue_notify_data(q);
         data_queue_release_user(q);
@@ -314,6 +687,9 @@ bool data_queue_have_data(data_queue_t *q)
     if (q == NULL) {
         return has_data;
     }
+    if (q->spsc) {
+        return _ATOMIC_LOAD(q->quit) == 0 && _ATOMIC_LOAD(q->in_num) != _ATOMIC_LOAD(q->out_num);
+    }
     _MUTEX_LOCK(q->lock);
     if (!q->quit) {
         has_data = _data_queue_have_data(q);
@@ -328,6 +704,9 @@ int data_queue_read_lock(data_queue_t *q, void **buffer, int *size)
     if (q == NULL) {
         return -1;
     }
+    if (q->spsc) {
+        return data_queue_spsc_read_lock(q, buffer, size);
+    }
     _MUTEX_LOCK(q->lock);
     while (!q->quit) {
         if (_data_queue_have_data_from_last(q) == false) {
@@ -358,9 +737,80 @@ int data_queue_read_lock(data_queue_t *q, void **buffer, int *size)
     return ret;
 }
 
+int data_queue_wait_arrive(data_queue_t *q, int q_num, uint32_t timeout)
+{
+    if (q == NULL) {
+        return -1;
+    }
+    if (q->spsc) {
+        return data_queue_spsc_wait_arrive(q, q_num, timeout);
+    }
+    uint32_t bits = q_num < 0 ? DATA_Q_READER_WAKE_BITS : DATA_Q_DATA_ARRIVE_BITS;
+    int ret = 0;
+    _MUTEX_LOCK(q->lock);
+    if (!q->quit && (q_num < 0 || (int) (q->in_num - q->out_num) <= q_num)) {
+        // Arrival is notified under lock, clear stale one so that only new arrival wakes up
+        media_lib_event_group_clr_bits(q->event, DATA_Q_DATA_ARRIVE_BITS);
+        q->user++;
+        _MUTEX_UNLOCK(q->lock);
+        uint32_t got = media_lib_event_group_wait_bits((media_lib_event_grp_handle_t) q->event, bits, timeout);
+        media_lib_event_group_clr_bits(q->event, DATA_Q_DATA_ARRIVE_BITS | DATA_Q_READER_WAKE_BITS);
+        _MUTEX_LOCK(q->lock);
+        q->user--;
+        data_queue_release_user(q);
+        ret = (got & bits) ? 0 : 1;
+    }
+    if (q->quit) {
+        ret = -1;
+    }
+    _MUTEX_UNLOCK(q->lock);
+    return ret;
+}
+
+int data_queue_wait_drain(data_queue_t *q, int q_num, uint32_t timeout)
+{
+    if (q == NULL) {
+        return -1;
+    }
+    if (q->spsc) {
+        return data_queue_spsc_wait_drain(q, q_num, timeout);
+    }
+    int ret = 0;
+    _MUTEX_LOCK(q->lock);
+    if (!q->quit && (int) (q->in_num - q->out_num) > q_num) {
+        // Consume is notified under lock, clear stale one so that only new consume wakes up
+        media_lib_event_group_clr_bits(q->event, DATA_Q_DATA_DRAIN_BITS);
+        q->user++;
+        _MUTEX_UNLOCK(q->lock);
+        uint32_t got = media_lib_event_group_wait_bits((media_lib_event_grp_handle_t) q->event,
+                                                       DATA_Q_DATA_DRAIN_BITS, timeout);
+        media_lib_event_group_clr_bits(q->event, DATA_Q_DATA_DRAIN_BITS);
+        _MUTEX_LOCK(q->lock);
+        q->user--;
+        data_queue_release_user(q);
+        ret = (got & DATA_Q_DATA_DRAIN_BITS) ? 0 : 1;
+    }
+    if (q->quit) {
+        ret = -1;
+    }
+    _MUTEX_UNLOCK(q->lock);
+    return ret;
+}
+
+void data_queue_wake_reader(data_queue_t *q)
+{
+    if (q && q->event) {
+        _SET_BITS(q->event, DATA_Q_DATA_ARRIVE_BITS | DATA_Q_READER_WAKE_BITS);
+    }
+}
+
 int data_queue_peek_unlock(data_queue_t *q)
 {
     int ret = -1;
+    if (q && q->spsc) {
+        data_queue_spsc_release_user(q);
+        return 0;
+    }
     if (q) {
         _MUTEX_LOCK(q->lock);
         q->user--;
@@ -373,20 +823,13 @@ int data_queue_peek_unlock(data_queue_t *q)
 int data_queue_read_unlock(data_queue_t *q)
 {
     int ret = -1;
+    if (q && q->spsc) {
+        return data_queue_spsc_read_unlock(q);
+    }
     if (q) {
         _MUTEX_LOCK(q->lock);
         if (_data_queue_have_data(q)) {
-            uint8_t *buffer = (uint8_t *) q->buffer + q->rp;
-            int size = *((int *) buffer);
-            if (size < 0 || size >q->size) {
-                *(int*)0 = 0;
-            }
-            q->rp += size;
-            q->filled -= size;
-            if (q->fill_end && q->rp >= q->fill_end) {
-                q->fill_end = 0;
-                q->rp = 0;
-            }
+            _data_queue_consume(q);
             q->user--;
             data_queue_data_consumed(q);
             data_queue_release_user(q);
@@ -399,26 +842,13 @@ int data_queue_read_unlock(data_queue_t *q)
 
 int data_queue_query(data_queue_t *q, int *q_num, int *q_size)
 {
+    if (q && q->spsc) {
+        data_queue_get_count(q, q_num, q_size);
+        return 0;
+    }
     if (q) {
         _MUTEX_LOCK(q->lock);
-        *q_num = *q_size = 0;
-        if (_data_queue_have_data(q)) {
-            int rp = q->rp;
-            int ring = q->fill_end;
-            while (rp != q->wp || ring) {
-                int size = *(int *) (q->buffer + rp);
-                if (size < 0 || size > q->size) {
-                    *(int*)0 = 0;
-                }
-                rp += size;
-                if (ring && rp == ring) {
-                    ring = 0;
-                    rp = 0;
-                }
-                (*q_num)++;
-                (*q_size) += size - DATA_Q_ALLOC_HEAD_SIZE;
-            }
-        }
+        data_queue_get_count(q, q_num, q_size);
         _MUTEX_UNLOCK(q->lock);
     }
     return 0;
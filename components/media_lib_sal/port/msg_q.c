@@ -26,75 +26,172 @@
 #include "string.h"
 #include "stdio.h"
 #include "stdlib.h"
-#include <unistd.h>
 #include "pthread.h"
 #include "stdbool.h"
+#include "stdint.h"
+
+#define MSG_Q_SLOT_ALIGN (8)
 
 typedef struct msg_q_t {
    pthread_mutex_t data_mutex;
-   pthread_cond_t  data_cond;
-   void**          data;
+   pthread_cond_t  not_empty;  // Receivers wait for new message
+   pthread_cond_t  not_full;   // Senders and consume waiters wait for free slot
+   pthread_cond_t  idle;       // Destroy waits for all waiters left
+   uint8_t*        slab;       // All slots in one allocation
+   void**          data;       // Slot pointers in queue order, second half is scratch for reset
    const char*     name;
    int             cur;
    int             each_size;
    int             number;
-   int             filled;
+   int             filled;     // Committed messages including peeked head
+   int             reserved;   // Slots reserved by senders and not committed yet, follow filled ones
+   bool            peeked;     // Head message is held by receiver until release
    bool            quit;
-   bool            reset;
+   msg_q_cmp       cmp;
+   void*           cmp_tag;
+   uint32_t        wakeup_gen; // Increased by reset or wakeup to kick out current waiters
+   uint32_t        recv_count;
+   int             consume_waiting;
    int             user;
 } msg_q_t;
 
-msg_q_handle_t msg_q_create(int msg_number, int msg_size) {
+static msg_q_t* msg_q_alloc(const char* name, int msg_size, int msg_number) {
+    if (msg_size <= 0 || msg_number <= 0) {
+        return NULL;
+    }
     msg_q_t* q = (msg_q_t*)calloc(1, sizeof(msg_q_t));
-    if (msg_size == 0 || msg_number == 0) {
+    if (q == NULL) {
         return NULL;
     }
-    if (q) {
-        q->name = "";
-        pthread_mutex_init(&(q->data_mutex), NULL);
-        pthread_cond_init(&q->data_cond, NULL);
-        q->data = (void**)malloc(sizeof(void*) * msg_number);
-        for (int i = 0; i < msg_number; i++) {
-            q->data[i] = malloc(msg_size);
-        }
-        q->number = msg_number;
-        q->each_size = msg_size;
+    int slot_size = (msg_size + MSG_Q_SLOT_ALIGN - 1) & ~(MSG_Q_SLOT_ALIGN - 1);
+    q->slab = (uint8_t*)malloc(slot_size * msg_number);
+    q->data = (void**)malloc(sizeof(void*) * msg_number * 2);
+    if (q->slab == NULL || q->data == NULL) {
+        free(q->slab);
+        free(q->data);
+        free(q);
+        return NULL;
     }
+    for (int i = 0; i < msg_number; i++) {
+        q->data[i] = q->slab + i * slot_size;
+    }
+    q->name = name;
+    q->number = msg_number;
+    q->each_size = msg_size;
+    pthread_mutex_init(&(q->data_mutex), NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    pthread_cond_init(&q->idle, NULL);
     return q;
 }
 
-msg_q_handle_t msg_q_create_by_name(const char* name, int msg_size, int msg_number) {
-    msg_q_t* q = (msg_q_t*)calloc(1, sizeof(msg_q_t));
-    if (msg_size == 0 || msg_number == 0) {
-        return NULL;
+static inline int msg_q_pos(msg_q_t* q, int i) {
+    return (q->cur + i) % q->number;
+}
+
+static inline void msg_q_swap(msg_q_t* q, int i, int j) {
+    void* t = q->data[msg_q_pos(q, i)];
+    q->data[msg_q_pos(q, i)] = q->data[msg_q_pos(q, j)];
+    q->data[msg_q_pos(q, j)] = t;
+}
+
+static inline bool msg_q_full(msg_q_t* q) {
+    return q->filled + q->reserved >= q->number;
+}
+
+// No message can be received when queue empty or head is peeked
+static inline bool msg_q_empty(msg_q_t* q) {
+    return q->filled == 0 || q->peeked;
+}
+
+// Wait on condition with user count held so that destroy can wait for waiter to leave
+static void msg_q_wait(msg_q_t* q, pthread_cond_t* cond) {
+    q->user++;
+    pthread_cond_wait(cond, &(q->data_mutex));
+    q->user--;
+    if (q->quit && q->user == 0) {
+        pthread_cond_signal(&q->idle);
     }
-    if (q) {
-        q->name = name;
-        pthread_mutex_init(&(q->data_mutex), NULL);
-        pthread_cond_init(&q->data_cond, NULL);
-        q->data = (void**)malloc(sizeof(void*) * msg_number);
-        for (int i = 0; i < msg_number; i++) {
-            q->data[i] = malloc(msg_size);
+}
+
+// Whether waiter should give up because of destroy, reset or wakeup
+static inline bool msg_q_kicked(msg_q_t* q, uint32_t gen) {
+    return q->quit || q->wakeup_gen != gen;
+}
+
+static void msg_q_kick_waiters(msg_q_t* q) {
+    q->wakeup_gen++;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_cond_broadcast(&q->not_full);
+}
+
+static void* msg_q_take_slot(msg_q_t* q) {
+    void* slot = q->data[msg_q_pos(q, q->filled + q->reserved)];
+    q->reserved++;
+    return slot;
+}
+
+static int msg_q_put_slot(msg_q_t* q, void* slot) {
+    int i;
+    for (i = q->filled; i < q->filled + q->reserved; i++) {
+        if (q->data[msg_q_pos(q, i)] == slot) {
+            break;
         }
-        q->number = msg_number;
-        q->each_size = msg_size;
     }
-    return q;
+    if (i == q->filled + q->reserved) {
+        return -1;
+    }
+    // Move to queue tail, commit order can differ from reserve order
+    msg_q_swap(q, i, q->filled);
+    i = q->filled;
+    q->filled++;
+    q->reserved--;
+    if (q->cmp) {
+        // Stable priority insert, never pass peeked head
+        int head = q->peeked ? 1 : 0;
+        while (i > head && q->cmp(q->data[msg_q_pos(q, i - 1)], slot, q->cmp_tag) > 0) {
+            msg_q_swap(q, i - 1, i);
+            i--;
+        }
+    }
+    // Notify have data, only receivers wait on it
+    pthread_cond_signal(&q->not_empty);
+    return 0;
+}
+
+static void msg_q_drop_head(msg_q_t* q) {
+    q->filled--;
+    q->cur = msg_q_pos(q, 1);
+    q->recv_count++;
+    // Slot freed, wake one sender or all when someone waits for consume
+    if (q->consume_waiting) {
+        pthread_cond_broadcast(&q->not_full);
+    } else {
+        pthread_cond_signal(&q->not_full);
+    }
+}
+
+msg_q_handle_t msg_q_create(int msg_number, int msg_size) {
+    return msg_q_alloc("", msg_size, msg_number);
+}
+
+msg_q_handle_t msg_q_create_by_name(const char* name, int msg_size, int msg_number) {
+    return msg_q_alloc(name, msg_size, msg_number);
 }
 
 int msg_q_wait_consume(msg_q_handle_t q) {
     int ret = -1;
     if (q) {
         pthread_mutex_lock(&(q->data_mutex));
-        if (q->filled) {
-            q->user++;
-            pthread_cond_wait(&(q->data_cond), &(q->data_mutex));
-            q->user--;
-            if (q->quit == false && q->reset == false) {
-                ret = 0;
-            }
+        uint32_t gen = q->wakeup_gen;
+        uint32_t recv_count = q->recv_count;
+        // Wait for one message consumed
+        q->consume_waiting++;
+        while (q->filled && q->recv_count == recv_count && msg_q_kicked(q, gen) == false) {
+            msg_q_wait(q, &q->not_full);
         }
-        else {
+        q->consume_waiting--;
+        if (msg_q_kicked(q, gen) == false) {
             ret = 0;
         }
         pthread_mutex_unlock(&(q->data_mutex));
@@ -110,35 +207,51 @@ int msg_q_send(msg_q_handle_t q, void* msg, int size) {
             return -1;
         }
         pthread_mutex_lock(&(q->data_mutex));
-        //printf("msg buffer %s filled %d total:%d\n", q->name, q->filled, q->number);
-        while (q->quit == false && q->filled >= q->number && q->reset == false) {
+        uint32_t gen = q->wakeup_gen;
+        while (msg_q_full(q) && msg_q_kicked(q, gen) == false) {
             //printf("msg buffer %s full\n", q->name);
-            q->user++;
-            pthread_cond_wait(&(q->data_cond), &(q->data_mutex));
-            q->user--;
-        }
-        if (q->reset) {
-            q->reset = false;
+            msg_q_wait(q, &q->not_full);
         }
-        if (q->quit == false && q->reset == false) {
-            int idx = (q->cur + q->filled) % q->number;
-            memcpy(q->data[idx], msg, size);
-            q->filled++;
-            // printf("Send q %s OK have: %d\n", q->name, q->filled);
+        if (msg_q_kicked(q, gen) == false) {
+            void* slot = msg_q_take_slot(q);
+            memcpy(slot, msg, size);
+            msg_q_put_slot(q, slot);
         }
         else {
             ret = -2;
         }
         pthread_mutex_unlock(&(q->data_mutex));
-        //notify have data
-        if (ret == 0) {
-            pthread_cond_signal(&(q->data_cond));
-        }
         return ret;
     }
     return -1;
 }
 
+void* msg_q_reserve(msg_q_handle_t q, bool no_wait) {
+    void* slot = NULL;
+    if (q) {
+        pthread_mutex_lock(&(q->data_mutex));
+        uint32_t gen = q->wakeup_gen;
+        while (msg_q_full(q) && msg_q_kicked(q, gen) == false && no_wait == false) {
+            msg_q_wait(q, &q->not_full);
+        }
+        if (msg_q_full(q) == false && msg_q_kicked(q, gen) == false) {
+            slot = msg_q_take_slot(q);
+        }
+        pthread_mutex_unlock(&(q->data_mutex));
+    }
+    return slot;
+}
+
+int msg_q_commit(msg_q_handle_t q, void* msg) {
+    int ret = -1;
+    if (q) {
+        pthread_mutex_lock(&(q->data_mutex));
+        ret = msg_q_put_slot(q, msg);
+        pthread_mutex_unlock(&(q->data_mutex));
+    }
+    return ret;
+}
+
 int msg_q_recv(msg_q_handle_t q, void* msg, int size, bool no_wait) {
     if (q) {
         int ret = 0;
@@ -147,41 +260,67 @@ int msg_q_recv(msg_q_handle_t q, void* msg, int size, bool no_wait) {
             return -1;
         }
         pthread_mutex_lock(&(q->data_mutex));
-        while (q->quit == false && q->filled == 0 && q->reset == false) {
+        uint32_t gen = q->wakeup_gen;
+        while (msg_q_empty(q) && msg_q_kicked(q, gen) == false) {
             if (no_wait) {
                 pthread_mutex_unlock(&(q->data_mutex));
                 return 1;
             }
-            q->user++;
             //printf("msg buffer %s empty\n", q->name);
-            ret = pthread_cond_wait(&(q->data_cond), &(q->data_mutex));
-            //printf("msg buffer %s reset:%d\n", q->name, q->reset);
-            q->user--;
+            msg_q_wait(q, &q->not_empty);
         }
-        if (q->quit == false && q->reset == false) {
+        if (msg_q_kicked(q, gen) == false) {
             memcpy(msg, q->data[q->cur], size);
-            // printf("Recv q %s OK have: %d\n", q->name, q->filled);
-            q->filled--;
-            q->cur++;
-            q->cur %= q->number;
+            msg_q_drop_head(q);
         }
         else {
-            if (q->reset) {
-                q->reset = false;
+            if (q->quit) {
+                printf("recv after destroy\n");
             }
-            printf("recv after destroy\n");
             ret = -2;
         }
         pthread_mutex_unlock(&(q->data_mutex));
-        if (ret == 0) {
-            pthread_cond_signal(&(q->data_cond));
-        }
         return ret;
     }
     printf("q not created\n");
     return -1;
 }
 
+void* msg_q_peek(msg_q_handle_t q, bool no_wait) {
+    void* msg = NULL;
+    if (q) {
+        pthread_mutex_lock(&(q->data_mutex));
+        uint32_t gen = q->wakeup_gen;
+        while (msg_q_empty(q) && msg_q_kicked(q, gen) == false && no_wait == false) {
+            msg_q_wait(q, &q->not_empty);
+        }
+        if (msg_q_empty(q) == false && msg_q_kicked(q, gen) == false) {
+            q->peeked = true;
+            msg = q->data[q->cur];
+        }
+        pthread_mutex_unlock(&(q->data_mutex));
+    }
+    return msg;
+}
+
+int msg_q_release(msg_q_handle_t q, void* msg) {
+    int ret = -1;
+    if (q) {
+        pthread_mutex_lock(&(q->data_mutex));
+        if (q->peeked && q->data[q->cur] == msg) {
+            q->peeked = false;
+            msg_q_drop_head(q);
+            // Other receivers may wait for peeked head
+            if (q->filled) {
+                pthread_cond_signal(&q->not_empty);
+            }
+            ret = 0;
+        }
+        pthread_mutex_unlock(&(q->data_mutex));
+    }
+    return ret;
+}
+
 int msg_q_add_user(msg_q_handle_t q, int dir) {
     if (q) {
         pthread_mutex_lock(&(q->data_mutex));
@@ -190,6 +329,9 @@ int msg_q_add_user(msg_q_handle_t q, int dir) {
         }
         else {
             q->user--;
+            if (q->quit && q->user == 0) {
+                pthread_cond_signal(&q->idle);
+            }
         }
         pthread_mutex_unlock(&(q->data_mutex));
         return 0;
@@ -197,21 +339,36 @@ int msg_q_add_user(msg_q_handle_t q, int dir) {
     return -1;
 }
 
+// Drop queued messages but keep peeked head and reserved slots which are still in use
+static void msg_q_clear(msg_q_t* q) {
+    void** order = q->data + q->number;
+    int head = q->peeked ? 1 : 0;
+    int n = 0;
+    int i;
+    if (head) {
+        order[n++] = q->data[q->cur];
+    }
+    for (i = 0; i < q->reserved; i++) {
+        order[n++] = q->data[msg_q_pos(q, q->filled + i)];
+    }
+    for (i = head; i < q->filled; i++) {
+        order[n++] = q->data[msg_q_pos(q, i)];
+    }
+    for (i = q->filled + q->reserved; i < q->number; i++) {
+        order[n++] = q->data[msg_q_pos(q, i)];
+    }
+    memcpy(q->data, order, sizeof(void*) * q->number);
+    q->cur = 0;
+    q->filled = head;
+}
+
 int msg_q_reset(msg_q_handle_t q) {
     if (q) {
-        while (q->user) {
-            pthread_mutex_lock(&(q->data_mutex));
-            //printf("reset msg %s\n", q->name);
-            q->reset = true;
-            pthread_cond_broadcast(&(q->data_cond));
-            pthread_mutex_unlock(&(q->data_mutex));
-            usleep(2000);
-        }
         pthread_mutex_lock(&(q->data_mutex));
-        q->cur = 0;
-        q->filled = 0;
+        // Kicked waiters never touch queue data again, so clear it directly
+        msg_q_kick_waiters(q);
+        msg_q_clear(q);
         pthread_mutex_unlock(&(q->data_mutex));
-        //printf("reset Finished %s\n", q->name);
     }
     return 0;
 }
@@ -219,17 +376,8 @@ int msg_q_reset(msg_q_handle_t q) {
 int msg_q_wakeup(msg_q_handle_t q) {
     if (q) {
         pthread_mutex_lock(&(q->data_mutex));
-        //printf("reset msg %s\n", q->name);
-        q->reset = true;
-        pthread_cond_signal(&(q->data_cond));
+        msg_q_kick_waiters(q);
         pthread_mutex_unlock(&(q->data_mutex));
-        while (q->user) {
-            usleep(1000);
-        }
-        pthread_mutex_lock(&(q->data_mutex));
-        q->reset = false;
-        pthread_mutex_unlock(&(q->data_mutex));
-        //printf("reset Finished %s\n", q->name);
     }
     return 0;
 }
@@ -244,57 +392,47 @@ int msg_q_number(msg_q_handle_t q) {
     return n;
 }
 
-#if 0
-int msg_q_sort(msg_q_t*q, msg_q_cmp cmp_func, void* tag) {
+int msg_q_sort(msg_q_handle_t q, msg_q_cmp cmp_func, void* tag) {
     if (q) {
         pthread_mutex_lock(&(q->data_mutex));
-        int total_swap = 0;
-        if (q->filled > 1) {
-            int i, j;
-            for (i = 0; i < q->filled - 1; i++) {
-               int swap = 0;
-               for (j = 0; j < q->filled -1 -i; j++) {
-                   int a = (j + q->cur) % q->number;
-                   int b = (j + 1+ q->cur) % q->number;
-                   void* cmp_a = q->data[a];
-                   void* cmp_b = q->data[b];
-                   if (cmp_func(cmp_a, cmp_b, tag) > 0) {
-                       q->data[a] = cmp_b;
-                       q->data[b] = cmp_a;
-                       swap++;
-                   }
-               }
-               total_swap += swap;
-               if (swap == 0) break;
+        q->cmp = cmp_func;
+        q->cmp_tag = tag;
+        if (cmp_func) {
+            // Stable insertion sort on slot pointers for queued messages
+            int head = q->peeked ? 1 : 0;
+            for (int i = head + 1; i < q->filled; i++) {
+                for (int j = i; j > head; j--) {
+                    if (cmp_func(q->data[msg_q_pos(q, j - 1)], q->data[msg_q_pos(q, j)], tag) <= 0) {
+                        break;
+                    }
+                    msg_q_swap(q, j - 1, j);
+                }
             }
-            printf("have video frame:%d swap:%d\n", q->filled, total_swap);
         }
         pthread_mutex_unlock(&(q->data_mutex));
+        return 0;
     }
-    return 0;
+    return -1;
 }
-#endif
 
 void msg_q_destroy(msg_q_handle_t q) {
     if (q) {
         pthread_mutex_lock(&(q->data_mutex));
         q->quit = true;
-        pthread_cond_signal(&(q->data_cond));
-        pthread_mutex_unlock(&(q->data_mutex));
+        pthread_cond_broadcast(&q->not_empty);
+        pthread_cond_broadcast(&q->not_full);
+        // Each waiter signals idle when it is the last one to leave
         while (q->user) {
-            usleep(1000);
+            pthread_cond_wait(&q->idle, &(q->data_mutex));
         }
-        pthread_mutex_lock(&(q->data_mutex));
         pthread_mutex_unlock(&(q->data_mutex));
 
         pthread_mutex_destroy(&(q->data_mutex));
-        pthread_cond_destroy(&(q->data_cond));
-        int i;
-        for (i = 0; i < q->number; i++) {
-            free(q->data[i]);
-        }
+        pthread_cond_destroy(&q->not_empty);
+        pthread_cond_destroy(&q->not_full);
+        pthread_cond_destroy(&q->idle);
+        free(q->slab);
         free(q->data);
         free(q);
     }
 }
-
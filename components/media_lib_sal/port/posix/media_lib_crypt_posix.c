@@ -0,0 +1,221 @@
+
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in
+ * which case, it is free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the
+ * Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <openssl/evp.h>
+#include "esp_log.h"
+#include "media_lib_crypt_reg.h"
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+
+#ifdef CONFIG_MEDIA_PROTOCOL_LIB_ENABLE
+
+#define RETURN_ON_NULL_HANDLE(h)                                               \
+    if (h == NULL)   {                                                         \
+        return ESP_ERR_INVALID_ARG;                                            \
+    }
+
+#define AES_BLOCK_SIZE (16)
+
+typedef struct {
+    EVP_CIPHER_CTX *ctx;
+    uint8_t         key[32];
+    uint8_t         key_bits;
+} posix_aes_t;
+
+static void md_init(void **ctx)
+{
+    EVP_MD_CTX *md = EVP_MD_CTX_new();
+    if (md) {
+        *ctx = md;
+    }
+}
+
+static void md_free(void *ctx)
+{
+    if (ctx) {
+        EVP_MD_CTX_free((EVP_MD_CTX *)ctx);
+    }
+}
+
+static int md_start(void *ctx, const EVP_MD *type)
+{
+    RETURN_ON_NULL_HANDLE(ctx);
+    return EVP_DigestInit_ex((EVP_MD_CTX *)ctx, type, NULL) == 1 ? ESP_OK : ESP_FAIL;
+}
+
+static int md_update(void *ctx, const unsigned char *input, size_t len)
+{
+    RETURN_ON_NULL_HANDLE(ctx);
+    return EVP_DigestUpdate((EVP_MD_CTX *)ctx, input, len) == 1 ? ESP_OK : ESP_FAIL;
+}
+
+static int md_finish(void *ctx, unsigned char *output)
+{
+    RETURN_ON_NULL_HANDLE(ctx);
+    return EVP_DigestFinal_ex((EVP_MD_CTX *)ctx, output, NULL) == 1 ? ESP_OK : ESP_FAIL;
+}
+
+static void _md5_init(media_lib_md5_handle_t *ctx)
+{
+    md_init(ctx);
+}
+
+static void _md5_free(media_lib_md5_handle_t ctx)
+{
+    md_free(ctx);
+}
+
+static int _md5_start(media_lib_md5_handle_t ctx)
+{
+    return md_start(ctx, EVP_md5());
+}
+
+static int _md5_update(media_lib_md5_handle_t ctx, const unsigned char *input, size_t len)
+{
+    return md_update(ctx, input, len);
+}
+
+static int _md5_finish(media_lib_md5_handle_t ctx, unsigned char output[16])
+{
+    return md_finish(ctx, output);
+}
+
+static void _sha256_init(media_lib_sha256_handle_t *ctx)
+{
+    md_init(ctx);
+}
+
+static void _sha256_free(media_lib_sha256_handle_t ctx)
+{
+    md_free(ctx);
+}
+
+static int _sha256_start(media_lib_sha256_handle_t ctx)
+{
+    return md_start(ctx, EVP_sha256());
+}
+
+static int _sha256_update(media_lib_sha256_handle_t ctx, const unsigned char *input, size_t len)
+{
+    return md_update(ctx, input, len);
+}
+
+static int _sha256_finish(media_lib_sha256_handle_t ctx, unsigned char output[32])
+{
+    return md_finish(ctx, output);
+}
+
+static void _aes_init(media_lib_aes_handle_t *ctx)
+{
+    posix_aes_t *aes = (posix_aes_t *)media_lib_calloc(1, sizeof(posix_aes_t));
+    if (aes == NULL) {
+        return;
+    }
+    aes->ctx = EVP_CIPHER_CTX_new();
+    if (aes->ctx == NULL) {
+        media_lib_free(aes);
+        return;
+    }
+    *ctx = aes;
+}
+
+static void _aes_free(media_lib_aes_handle_t ctx)
+{
+    if (ctx) {
+        posix_aes_t *aes = (posix_aes_t *)ctx;
+        EVP_CIPHER_CTX_free(aes->ctx);
+        memset(aes->key, 0, sizeof(aes->key));
+        media_lib_free(aes);
+    }
+}
+
+static int _aes_set_key(media_lib_aes_handle_t ctx, uint8_t *key, uint8_t key_bits)
+{
+    RETURN_ON_NULL_HANDLE(ctx);
+    // Key bits is stored in uint8_t so 256 can not be represented, same limitation as target
+    if (key_bits != 128 && key_bits != 192) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    posix_aes_t *aes = (posix_aes_t *)ctx;
+    memcpy(aes->key, key, key_bits / 8);
+    aes->key_bits = key_bits;
+    return ESP_OK;
+}
+
+static int _aes_crypt_cbc(media_lib_aes_handle_t ctx, bool decrypt_mode, uint8_t iv[16], uint8_t *input,
+                          size_t size, uint8_t *output)
+{
+    RETURN_ON_NULL_HANDLE(ctx);
+    posix_aes_t *aes = (posix_aes_t *)ctx;
+    if (aes->key_bits == 0 || (size % AES_BLOCK_SIZE) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (size == 0) {
+        return ESP_OK;
+    }
+    const EVP_CIPHER *cipher = aes->key_bits == 128 ? EVP_aes_128_cbc() : EVP_aes_192_cbc();
+    uint8_t next_iv[AES_BLOCK_SIZE];
+    // Input may equal to output, keep last cipher block before update
+    if (decrypt_mode) {
+        memcpy(next_iv, input + size - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+    }
+    int out_len = 0;
+    if (EVP_CipherInit_ex(aes->ctx, cipher, NULL, aes->key, iv, decrypt_mode ? 0 : 1) != 1 ||
+        EVP_CIPHER_CTX_set_padding(aes->ctx, 0) != 1 ||
+        EVP_CipherUpdate(aes->ctx, output, &out_len, input, (int) size) != 1) {
+        return ESP_FAIL;
+    }
+    if (decrypt_mode == false) {
+        memcpy(next_iv, output + size - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+    }
+    // Update IV so that continuous calls chain same as target
+    memcpy(iv, next_iv, AES_BLOCK_SIZE);
+    return ESP_OK;
+}
+
+esp_err_t media_lib_add_default_crypt_adapter(void)
+{
+    media_lib_crypt_t crypt_lib = {
+        .md5_init = _md5_init,
+        .md5_free = _md5_free,
+        .md5_start = _md5_start,
+        .md5_update = _md5_update,
+        .md5_finish = _md5_finish,
+        .sha256_init = _sha256_init,
+        .sha256_free = _sha256_free,
+        .sha256_start = _sha256_start,
+        .sha256_update = _sha256_update,
+        .sha256_finish = _sha256_finish,
+        .aes_init = _aes_init,
+        .aes_free = _aes_free,
+        .aes_set_key = _aes_set_key,
+        .aes_crypt_cbc = _aes_crypt_cbc,
+    };
+    return media_lib_crypt_register(&crypt_lib);
+}
+#endif
@@ -0,0 +1,110 @@
+
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in
+ * which case, it is free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the
+ * Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "esp_log.h"
+#include "media_lib_netif_reg.h"
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+
+#ifdef CONFIG_MEDIA_PROTOCOL_LIB_ENABLE
+
+#define TAG "NETIF_Lib"
+
+static bool is_wireless_if(const char *name)
+{
+    return strncmp(name, "wl", 2) == 0;
+}
+
+static int _get_ipv4_info(media_lib_net_type_t type, media_lib_ipv4_info_t *ip_info)
+{
+    if (ip_info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (type != MEDIA_LIB_NET_TYPE_STA && type != MEDIA_LIB_NET_TYPE_ETH && type != MEDIA_LIB_NET_TYPE_AP) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    struct ifaddrs *if_list = NULL;
+    if (getifaddrs(&if_list) != 0) {
+        ESP_LOGE(TAG, "Fail to get interface list");
+        return ESP_FAIL;
+    }
+    // Prefer wireless interface for STA and AP, wired one for ETH, fallback to first usable interface
+    struct ifaddrs *found = NULL;
+    for (struct ifaddrs *ifa = if_list; ifa; ifa = ifa->ifa_next) {
+        if (ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_INET ||
+            (ifa->ifa_flags & IFF_LOOPBACK) || (ifa->ifa_flags & IFF_UP) == 0) {
+            continue;
+        }
+        if (is_wireless_if(ifa->ifa_name) == (type != MEDIA_LIB_NET_TYPE_ETH)) {
+            found = ifa;
+            break;
+        }
+        if (found == NULL) {
+            found = ifa;
+        }
+    }
+    int ret = ESP_ERR_NOT_FOUND;
+    if (found) {
+        memset(ip_info, 0, sizeof(media_lib_ipv4_info_t));
+        ip_info->ip.addr = ((struct sockaddr_in *)found->ifa_addr)->sin_addr.s_addr;
+        if (found->ifa_netmask) {
+            ip_info->netmask.addr = ((struct sockaddr_in *)found->ifa_netmask)->sin_addr.s_addr;
+        }
+        // Gateway is not reported by getifaddrs, keep it zero
+        ret = ESP_OK;
+    }
+    freeifaddrs(if_list);
+    return ret;
+}
+
+static char *_ipv4_ntoa(const media_lib_ipv4_addr_t *addr)
+{
+    static __thread char ip_str[INET_ADDRSTRLEN];
+    if (addr == NULL) {
+        return NULL;
+    }
+    struct in_addr in = {
+        .s_addr = addr->addr,
+    };
+    return (char *)inet_ntop(AF_INET, &in, ip_str, sizeof(ip_str));
+}
+
+esp_err_t media_lib_add_default_netif_adapter(void)
+{
+    media_lib_netif_t netif_lib = {
+        .get_ipv4_info = _get_ipv4_info,
+        .ipv4_ntoa = _ipv4_ntoa,
+    };
+    return media_lib_netif_register(&netif_lib);
+}
+
+#endif
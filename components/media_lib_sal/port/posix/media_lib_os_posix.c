@@ -0,0 +1,436 @@
+
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in
+ * which case, it is free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the
+ * Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
+
+#include "esp_log.h"
+#include "media_lib_adapter.h"
+#include "media_lib_os_reg.h"
+
+#define RETURN_ON_NULL_HANDLE(h)                                               \
+    if (h == NULL) {                                                           \
+        return ESP_ERR_INVALID_ARG;                                            \
+    }
+
+#define TAG "MEDIA_OS"
+
+/* Wait forever when timeout equal to `MEDIA_LIB_MAX_LOCK_TIME` */
+#define POSIX_WAIT_FOREVER      (0xFFFFFFFF)
+/* FreeRTOS stack size is tuned for target, host libc need much more */
+#define POSIX_MIN_STACK_SIZE    (256 * 1024)
+#define POSIX_MAX_THREAD_NAME   (16)
+
+typedef struct {
+    void (*body)(void *arg);
+    void *arg;
+} posix_thread_arg_t;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    int             count;
+} posix_sema_t;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    uint32_t        bits;
+} posix_event_group_t;
+
+static pthread_mutex_t critical_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+static void get_abs_time(struct timespec *ts, uint32_t ms)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (long) (ms % 1000) * 1000000;
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+
+static int init_cond(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int ret = pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return ret;
+}
+
+/* Wait on cond with mutex held, return non-zero when timeout */
+static int cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *ts)
+{
+    if (ts == NULL) {
+        return pthread_cond_wait(cond, mutex);
+    }
+    return pthread_cond_timedwait(cond, mutex, ts);
+}
+
+static void *_malloc_align(size_t size, uint8_t align)
+{
+    if (!align || ((align & (align - 1)) != 0)) {
+        return NULL;
+    }
+    void *buf = NULL;
+    if (align < sizeof(void *)) {
+        align = sizeof(void *);
+    }
+    if (posix_memalign(&buf, align, size) != 0) {
+        return NULL;
+    }
+    return buf;
+}
+
+static void _free_align(void *addr)
+{
+    free(addr);
+}
+
+static int _get_stack_frame(void **addr, int n)
+{
+#ifdef __GLIBC__
+    void *frames[n + 1];
+    int filled = backtrace(frames, n + 1);
+    // Skip current frame
+    if (filled <= 1) {
+        return 0;
+    }
+    memcpy(addr, frames + 1, (filled - 1) * sizeof(void *));
+    return filled - 1;
+#else
+    return 0;
+#endif
+}
+
+static void *thread_entry(void *arg)
+{
+    posix_thread_arg_t thread_arg = *(posix_thread_arg_t *)arg;
+    free(arg);
+    thread_arg.body(thread_arg.arg);
+    return NULL;
+}
+
+static int _thread_create(media_lib_thread_handle_t *handle, const char *name,
+                          void(*body)(void *arg), void *arg, uint32_t stack_size,
+                          int prio, int core)
+{
+    // Priority and core affinity are not applied so that host runs are not serialized on one CPU
+    posix_thread_arg_t *thread_arg = (posix_thread_arg_t *)malloc(sizeof(posix_thread_arg_t));
+    if (thread_arg == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    thread_arg->body = body;
+    thread_arg->arg = arg;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (stack_size < POSIX_MIN_STACK_SIZE) {
+        stack_size = POSIX_MIN_STACK_SIZE;
+    }
+    pthread_attr_setstacksize(&attr, stack_size);
+    pthread_t tid;
+    int ret = pthread_create(&tid, &attr, thread_entry, thread_arg);
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Fail to create thread %s ret %d", name ? name : "", ret);
+        free(thread_arg);
+        return ESP_FAIL;
+    }
+    if (name) {
+        char thread_name[POSIX_MAX_THREAD_NAME];
+        strncpy(thread_name, name, sizeof(thread_name) - 1);
+        thread_name[sizeof(thread_name) - 1] = 0;
+        pthread_setname_np(tid, thread_name);
+    }
+    if (handle) {
+        *handle = (media_lib_thread_handle_t)tid;
+    }
+    return ESP_OK;
+}
+
+static void _thread_destroy(media_lib_thread_handle_t handle)
+{
+    // allow NULL to destroy self
+    if (handle == NULL || (pthread_t)handle == pthread_self()) {
+        pthread_exit(NULL);
+    }
+    pthread_cancel((pthread_t)handle);
+}
+
+static bool _thread_set_priority(media_lib_thread_handle_t handle, int prio)
+{
+    // Normal user threads run under SCHED_OTHER, keep same behavior as target and report success
+    return true;
+}
+
+static void _thread_sleep(uint32_t ms)
+{
+    struct timespec ts = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (long) (ms % 1000) * 1000000,
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR);
+}
+
+static int _sema_create(media_lib_sema_handle_t *sema)
+{
+    RETURN_ON_NULL_HANDLE(sema);
+    posix_sema_t *s = (posix_sema_t *)calloc(1, sizeof(posix_sema_t));
+    if (s == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_mutex_init(&s->mutex, NULL);
+    init_cond(&s->cond);
+    *sema = (media_lib_sema_handle_t)s;
+    return ESP_OK;
+}
+
+static int _sema_lock_timeout(media_lib_sema_handle_t sema, uint32_t timeout)
+{
+    RETURN_ON_NULL_HANDLE(sema);
+    posix_sema_t *s = (posix_sema_t *)sema;
+    struct timespec ts;
+    if (timeout != POSIX_WAIT_FOREVER) {
+        get_abs_time(&ts, timeout);
+    }
+    int ret = ESP_OK;
+    pthread_mutex_lock(&s->mutex);
+    while (s->count == 0) {
+        if (cond_wait(&s->cond, &s->mutex, timeout == POSIX_WAIT_FOREVER ? NULL : &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (s->count > 0) {
+        s->count--;
+    } else {
+        ret = ESP_FAIL;
+    }
+    pthread_mutex_unlock(&s->mutex);
+    return ret;
+}
+
+static int _sema_unlock(media_lib_sema_handle_t sema)
+{
+    RETURN_ON_NULL_HANDLE(sema);
+    posix_sema_t *s = (posix_sema_t *)sema;
+    pthread_mutex_lock(&s->mutex);
+    // Same as target counting semaphore with max count 1
+    s->count = 1;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->mutex);
+    return ESP_OK;
+}
+
+static int _sema_destroy(media_lib_sema_handle_t sema)
+{
+    RETURN_ON_NULL_HANDLE(sema);
+    posix_sema_t *s = (posix_sema_t *)sema;
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->mutex);
+    free(s);
+    return ESP_OK;
+}
+
+static int _mutex_create(media_lib_mutex_handle_t *mutex)
+{
+    RETURN_ON_NULL_HANDLE(mutex);
+    pthread_mutex_t *m = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
+    if (m == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    // Keep recursive same as target
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(m, &attr);
+    pthread_mutexattr_destroy(&attr);
+    *mutex = (media_lib_mutex_handle_t)m;
+    return ESP_OK;
+}
+
+static int _mutex_lock_timeout(media_lib_mutex_handle_t mutex, uint32_t timeout)
+{
+    RETURN_ON_NULL_HANDLE(mutex);
+    pthread_mutex_t *m = (pthread_mutex_t *)mutex;
+    if (timeout == POSIX_WAIT_FOREVER) {
+        return pthread_mutex_lock(m) == 0 ? ESP_OK : ESP_FAIL;
+    }
+    if (timeout == 0) {
+        return pthread_mutex_trylock(m) == 0 ? ESP_OK : ESP_FAIL;
+    }
+    struct timespec ts;
+    get_abs_time(&ts, timeout);
+    return pthread_mutex_clocklock(m, CLOCK_MONOTONIC, &ts) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+static int _mutex_unlock(media_lib_mutex_handle_t mutex)
+{
+    RETURN_ON_NULL_HANDLE(mutex);
+    return pthread_mutex_unlock((pthread_mutex_t *)mutex) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+static int _mutex_destroy(media_lib_mutex_handle_t mutex)
+{
+    RETURN_ON_NULL_HANDLE(mutex);
+    pthread_mutex_destroy((pthread_mutex_t *)mutex);
+    free(mutex);
+    return ESP_OK;
+}
+
+static int _enter_critical(void)
+{
+    pthread_mutex_lock(&critical_lock);
+    return ESP_OK;
+}
+
+static int _leave_critical(void)
+{
+    pthread_mutex_unlock(&critical_lock);
+    return ESP_OK;
+}
+
+static int _event_group_create(media_lib_event_grp_handle_t *group)
+{
+    RETURN_ON_NULL_HANDLE(group);
+    posix_event_group_t *g = (posix_event_group_t *)calloc(1, sizeof(posix_event_group_t));
+    if (g == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_mutex_init(&g->mutex, NULL);
+    init_cond(&g->cond);
+    *group = (media_lib_event_grp_handle_t)g;
+    return ESP_OK;
+}
+
+static uint32_t _event_group_set_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    RETURN_ON_NULL_HANDLE(group);
+    posix_event_group_t *g = (posix_event_group_t *)group;
+    pthread_mutex_lock(&g->mutex);
+    g->bits |= bits;
+    uint32_t cur_bits = g->bits;
+    pthread_cond_broadcast(&g->cond);
+    pthread_mutex_unlock(&g->mutex);
+    return cur_bits;
+}
+
+static uint32_t _event_group_clr_bits(media_lib_event_grp_handle_t group, uint32_t bits)
+{
+    RETURN_ON_NULL_HANDLE(group);
+    posix_event_group_t *g = (posix_event_group_t *)group;
+    pthread_mutex_lock(&g->mutex);
+    // Return bits before clear same as target
+    uint32_t cur_bits = g->bits;
+    g->bits &= ~bits;
+    pthread_mutex_unlock(&g->mutex);
+    return cur_bits;
+}
+
+static uint32_t _event_group_wait_bits(media_lib_event_grp_handle_t group,
+                                       uint32_t bits, uint32_t timeout)
+{
+    RETURN_ON_NULL_HANDLE(group);
+    posix_event_group_t *g = (posix_event_group_t *)group;
+    struct timespec ts;
+    if (timeout != POSIX_WAIT_FOREVER) {
+        get_abs_time(&ts, timeout);
+    }
+    pthread_mutex_lock(&g->mutex);
+    // Wait for all bits and not clear on exit
+    while ((g->bits & bits) != bits) {
+        if (cond_wait(&g->cond, &g->mutex, timeout == POSIX_WAIT_FOREVER ? NULL : &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    uint32_t cur_bits = g->bits;
+    pthread_mutex_unlock(&g->mutex);
+    return cur_bits;
+}
+
+static int _event_group_destroy(media_lib_event_grp_handle_t group)
+{
+    RETURN_ON_NULL_HANDLE(group);
+    posix_event_group_t *g = (posix_event_group_t *)group;
+    pthread_cond_destroy(&g->cond);
+    pthread_mutex_destroy(&g->mutex);
+    free(g);
+    return ESP_OK;
+}
+
+esp_err_t media_lib_add_default_os_adapter(void)
+{
+    media_lib_os_t os_lib = {
+        .malloc = malloc,
+        .free = free,
+        .calloc = calloc,
+        .realloc = realloc,
+        .malloc_align = _malloc_align,
+        .free_align = _free_align,
+        .strdup = strdup,
+        .get_stack_frame = _get_stack_frame,
+
+        .thread_create = _thread_create,
+        .thread_destroy = _thread_destroy,
+        .thread_set_prio = _thread_set_priority,
+        .thread_sleep = _thread_sleep,
+
+        .sema_create = _sema_create,
+        .sema_lock   = _sema_lock_timeout,
+        .sema_unlock = _sema_unlock,
+        .sema_destroy = _sema_destroy,
+
+        .mutex_create = _mutex_create,
+        .mutex_lock =   _mutex_lock_timeout,
+        .mutex_unlock = _mutex_unlock,
+        .mutex_destroy = _mutex_destroy,
+
+        .enter_critical = _enter_critical,
+        .leave_critical = _leave_critical,
+
+        .group_create = _event_group_create,
+        .group_set_bits = _event_group_set_bits,
+        .group_clr_bits = _event_group_clr_bits,
+        .group_wait_bits = _event_group_wait_bits,
+        .group_destroy = _event_group_destroy,
+    };
+    return media_lib_os_register(&os_lib);
+}
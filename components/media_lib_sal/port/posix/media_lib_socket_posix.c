@@ -0,0 +1,102 @@
+
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in
+ * which case, it is free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the
+ * Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "media_lib_adapter.h"
+#include "media_lib_socket_reg.h"
+
+#ifdef CONFIG_MEDIA_PROTOCOL_LIB_ENABLE
+
+static int _ioctl(int s, long cmd, void *argp)
+{
+    return ioctl(s, (unsigned long) cmd, argp);
+}
+
+static int _fcntl(int s, int cmd, int val)
+{
+    return fcntl(s, cmd, val);
+}
+
+static int _select(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptset, media_lib_timeval *timeout)
+{
+    if (timeout == NULL) {
+        return select(maxfdp1, readset, writeset, exceptset, NULL);
+    }
+    struct timeval tm = {
+        .tv_sec = timeout->tv_sec,
+        .tv_usec = timeout->tv_usec,
+    };
+    return select(maxfdp1, readset, writeset, exceptset, &tm);
+}
+
+static ssize_t _send(int s, const void *dataptr, size_t size, int flags)
+{
+    // Avoid SIGPIPE when peer closed, report error through return value same as lwip
+    return send(s, dataptr, size, flags | MSG_NOSIGNAL);
+}
+
+static ssize_t _sendto(int s, const void *dataptr, size_t size, int flags, const struct sockaddr *to, socklen_t tolen)
+{
+    return sendto(s, dataptr, size, flags | MSG_NOSIGNAL, to, tolen);
+}
+
+static ssize_t _sendmsg(int s, const struct msghdr *message, int flags)
+{
+    return sendmsg(s, message, flags | MSG_NOSIGNAL);
+}
+
+esp_err_t media_lib_add_default_socket_adapter(void)
+{
+    media_lib_socket_t sock_lib = {
+        .sock_accept = accept,
+        .sock_bind = bind,
+        .sock_shutdown = shutdown,
+        .sock_close = close,
+        .sock_connect = connect,
+        .sock_listen = listen,
+        .sock_recv = recv,
+        .sock_read = read,
+        .sock_readv = readv,
+        .sock_recvfrom = recvfrom,
+        .sock_recvmsg = recvmsg,
+        .sock_send = _send,
+        .sock_sendmsg = _sendmsg,
+        .sock_sendto = _sendto,
+        .sock_open = socket,
+        .sock_write = write,
+        .sock_writev = writev,
+        .sock_select = _select,
+        .sock_ioctl = _ioctl,
+        .sock_fcntl = _fcntl,
+        .sock_inet_ntop = inet_ntop,
+        .sock_inet_pton = inet_pton,
+        .sock_setsockopt = setsockopt,
+        .sock_getsockopt = getsockopt,
+        .sock_getsockname = getsockname,
+    };
+    return media_lib_socket_register(&sock_lib);
+}
+#endif
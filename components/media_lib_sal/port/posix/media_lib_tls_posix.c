@@ -0,0 +1,369 @@
+
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2025 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in
+ * which case, it is free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the
+ * Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include "esp_log.h"
+#include "media_lib_tls_reg.h"
+#include "media_lib_adapter.h"
+#include "media_lib_os.h"
+
+#ifdef CONFIG_MEDIA_PROTOCOL_LIB_ENABLE
+
+#define TAG "TLS_Lib"
+
+/* Same value as MBEDTLS_ERR_SSL_WANT_READ returned by esp_tls */
+#define TLS_ERR_SSL_WANT_READ (-0x6900)
+
+typedef struct {
+    SSL_CTX *ctx;
+    SSL     *ssl;
+    int      fd;
+    bool     is_server;
+} media_lib_tls_inst_t;
+
+static BIO *mem_bio(const char *buf, int size)
+{
+    // PEM buffer from target config include terminating zero in size
+    if (size > 0 && buf[size - 1] == 0) {
+        size--;
+    }
+    return BIO_new_mem_buf(buf, size);
+}
+
+static int load_ca(SSL_CTX *ctx, const char *buf, int size)
+{
+    BIO *bio = mem_bio(buf, size);
+    if (bio == NULL) {
+        return -1;
+    }
+    X509_STORE *store = SSL_CTX_get_cert_store(ctx);
+    int count = 0;
+    X509 *cert;
+    while ((cert = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL) {
+        if (X509_STORE_add_cert(store, cert) == 1) {
+            count++;
+        }
+        X509_free(cert);
+    }
+    ERR_clear_error();
+    BIO_free(bio);
+    return count > 0 ? 0 : -1;
+}
+
+static int load_cert_key(SSL_CTX *ctx, const char *cert_buf, int cert_size,
+                         const char *key_buf, int key_size, const char *password)
+{
+    int ret = -1;
+    BIO *cert_bio = mem_bio(cert_buf, cert_size);
+    BIO *key_bio = mem_bio(key_buf, key_size);
+    X509 *cert = NULL;
+    EVP_PKEY *key = NULL;
+    do {
+        if (cert_bio == NULL || key_bio == NULL) {
+            break;
+        }
+        cert = PEM_read_bio_X509(cert_bio, NULL, NULL, NULL);
+        key = PEM_read_bio_PrivateKey(key_bio, NULL, NULL, (void *)password);
+        if (cert == NULL || key == NULL) {
+            break;
+        }
+        if (SSL_CTX_use_certificate(ctx, cert) != 1 || SSL_CTX_use_PrivateKey(ctx, key) != 1) {
+            break;
+        }
+        ret = 0;
+    } while (0);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    BIO_free(cert_bio);
+    BIO_free(key_bio);
+    return ret;
+}
+
+static void set_sock_timeout(int fd, int timeout_ms)
+{
+    if (timeout_ms <= 0) {
+        return;
+    }
+    struct timeval tv = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+static int tcp_connect(const char *hostname, int hostlen, int port, int timeout_ms)
+{
+    char *host = strndup(hostname, hostlen > 0 ? (size_t) hostlen : strlen(hostname));
+    if (host == NULL) {
+        return -1;
+    }
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%d", port);
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct addrinfo *res = NULL;
+    int ret = getaddrinfo(host, port_str, &hints, &res);
+    free(host);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Fail to resolve host %.*s", hostlen, hostname);
+        return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        set_sock_timeout(fd, timeout_ms);
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static void tls_inst_free(media_lib_tls_inst_t *tls_lib)
+{
+    if (tls_lib->ssl) {
+        SSL_shutdown(tls_lib->ssl);
+        SSL_free(tls_lib->ssl);
+    }
+    if (tls_lib->ctx) {
+        SSL_CTX_free(tls_lib->ctx);
+    }
+    // Server socket is owned by caller
+    if (tls_lib->is_server == false && tls_lib->fd >= 0) {
+        close(tls_lib->fd);
+    }
+    free(tls_lib);
+}
+
+static media_lib_tls_handle_t _tls_new(const char *hostname, int hostlen, int port, const media_lib_tls_cfg_t *cfg)
+{
+    if (hostname == NULL || cfg == NULL) {
+        return NULL;
+    }
+    media_lib_tls_inst_t *tls_lib = calloc(1, sizeof(media_lib_tls_inst_t));
+    if (tls_lib == NULL) {
+        ESP_LOGE(TAG, "No memory for instance");
+        return NULL;
+    }
+    tls_lib->fd = -1;
+    do {
+        tls_lib->ctx = SSL_CTX_new(TLS_client_method());
+        if (tls_lib->ctx == NULL) {
+            break;
+        }
+        if (cfg->cacert_buf) {
+            if (load_ca(tls_lib->ctx, cfg->cacert_buf, cfg->cacert_bytes) != 0) {
+                ESP_LOGE(TAG, "Fail to load CA certificate");
+                break;
+            }
+            SSL_CTX_set_verify(tls_lib->ctx, SSL_VERIFY_PEER, NULL);
+        } else if (cfg->use_global_ca_store || cfg->crt_bundle_attach) {
+            // Use system CA store instead of global store or certificate bundle
+            SSL_CTX_set_default_verify_paths(tls_lib->ctx);
+            SSL_CTX_set_verify(tls_lib->ctx, SSL_VERIFY_PEER, NULL);
+        }
+        if (cfg->clientcert_buf && cfg->clientkey_buf &&
+            load_cert_key(tls_lib->ctx, cfg->clientcert_buf, cfg->clientcert_bytes,
+                          cfg->clientkey_buf, cfg->clientkey_bytes, cfg->clientkey_password) != 0) {
+            ESP_LOGE(TAG, "Fail to load client certificate");
+            break;
+        }
+        tls_lib->fd = tcp_connect(hostname, hostlen, port, cfg->timeout_ms);
+        if (tls_lib->fd < 0) {
+            break;
+        }
+        tls_lib->ssl = SSL_new(tls_lib->ctx);
+        if (tls_lib->ssl == NULL) {
+            break;
+        }
+        SSL_set_fd(tls_lib->ssl, tls_lib->fd);
+        char *host = strndup(hostname, hostlen > 0 ? (size_t) hostlen : strlen(hostname));
+        if (host) {
+            SSL_set_tlsext_host_name(tls_lib->ssl, host);
+            if (cfg->skip_common_name == false) {
+                SSL_set1_host(tls_lib->ssl, host);
+            }
+            free(host);
+        }
+        if (SSL_connect(tls_lib->ssl) != 1) {
+            ESP_LOGE(TAG, "Fail to handshake with %.*s:%d", hostlen, hostname, port);
+            break;
+        }
+        if (cfg->non_block) {
+            fcntl(tls_lib->fd, F_SETFL, fcntl(tls_lib->fd, F_GETFL, 0) | O_NONBLOCK);
+        }
+        return (media_lib_tls_handle_t)tls_lib;
+    } while (0);
+    ESP_LOGE(TAG, "Fail to connect client");
+    tls_inst_free(tls_lib);
+    return NULL;
+}
+
+static media_lib_tls_handle_t _tls_new_server(int fd, const media_lib_tls_server_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->servercert_buf == NULL || cfg->serverkey_buf == NULL) {
+        ESP_LOGE(TAG, "Server certificate and key must be set");
+        return NULL;
+    }
+    media_lib_tls_inst_t *tls_lib = calloc(1, sizeof(media_lib_tls_inst_t));
+    if (tls_lib == NULL) {
+        ESP_LOGE(TAG, "No memory for instance");
+        return NULL;
+    }
+    tls_lib->fd = fd;
+    tls_lib->is_server = true;
+    do {
+        tls_lib->ctx = SSL_CTX_new(TLS_server_method());
+        if (tls_lib->ctx == NULL) {
+            break;
+        }
+        if (load_cert_key(tls_lib->ctx, cfg->servercert_buf, cfg->servercert_bytes,
+                          cfg->serverkey_buf, cfg->serverkey_bytes, cfg->serverkey_password) != 0) {
+            ESP_LOGE(TAG, "Fail to load server certificate");
+            break;
+        }
+        if (cfg->cacert_buf) {
+            if (load_ca(tls_lib->ctx, cfg->cacert_buf, cfg->cacert_bytes) != 0) {
+                break;
+            }
+            SSL_CTX_set_verify(tls_lib->ctx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, NULL);
+        }
+        tls_lib->ssl = SSL_new(tls_lib->ctx);
+        if (tls_lib->ssl == NULL) {
+            break;
+        }
+        SSL_set_fd(tls_lib->ssl, fd);
+        if (SSL_accept(tls_lib->ssl) != 1) {
+            break;
+        }
+        return (media_lib_tls_handle_t)tls_lib;
+    } while (0);
+    ESP_LOGE(TAG, "Fail to create server session");
+    tls_inst_free(tls_lib);
+    return NULL;
+}
+
+static int tls_io_ret(media_lib_tls_inst_t *tls_lib, int ret)
+{
+    if (ret > 0) {
+        return ret;
+    }
+    int err = SSL_get_error(tls_lib->ssl, ret);
+    if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+        // Same as esp_tls, caller should retry
+        return TLS_ERR_SSL_WANT_READ;
+    }
+    if (err == SSL_ERROR_ZERO_RETURN) {
+        return 0;
+    }
+    return -1;
+}
+
+static int _tls_write(media_lib_tls_handle_t tls, const void *data, size_t datalen)
+{
+    if (tls) {
+        media_lib_tls_inst_t *tls_lib = (media_lib_tls_inst_t *)tls;
+        return tls_io_ret(tls_lib, SSL_write(tls_lib->ssl, data, (int) datalen));
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static int _tls_read(media_lib_tls_handle_t tls, void *data, size_t datalen)
+{
+    if (tls) {
+        media_lib_tls_inst_t *tls_lib = (media_lib_tls_inst_t *)tls;
+        return tls_io_ret(tls_lib, SSL_read(tls_lib->ssl, data, (int) datalen));
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static int _tls_getsockfd(media_lib_tls_handle_t tls)
+{
+    if (tls) {
+        media_lib_tls_inst_t *tls_lib = (media_lib_tls_inst_t *)tls;
+        return tls_lib->fd;
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static int _tls_delete(media_lib_tls_handle_t tls)
+{
+    if (tls) {
+        tls_inst_free((media_lib_tls_inst_t *)tls);
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+static int _tls_get_bytes_avail(media_lib_tls_handle_t tls)
+{
+    if (tls) {
+        media_lib_tls_inst_t *tls_lib = (media_lib_tls_inst_t *)tls;
+        return SSL_pending(tls_lib->ssl);
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+esp_err_t media_lib_add_default_tls_adapter(void)
+{
+    media_lib_tls_t tls_lib = {
+        .tls_new = _tls_new,
+        .tls_new_server = _tls_new_server,
+        .tls_write = _tls_write,
+        .tls_read = _tls_read,
+        .tls_getsockfd = _tls_getsockfd,
+        .tls_delete = _tls_delete,
+        .tls_get_bytes_avail = _tls_get_bytes_avail,
+    };
+    return media_lib_tls_register(&tls_lib);
+}
+
+#endif
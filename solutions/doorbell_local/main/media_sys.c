@@ -14,6 +14,7 @@
 #endif
 #include "av_render.h"
 #include "av_render_default.h"
+#include "av_render_mixer.h"
 #include "common.h"
 #include "esp_log.h"
 #include "settings.h"
@@ -28,6 +29,14 @@
 
 #define TAG "MEDIA_SYS"
 
+// Maximum wait time for queued music rendered out
+#define MUSIC_DRAIN_TIMEOUT_MS (5000)
+
+// Call audio and music are mixed in this format, call audio is ducked while music playing
+#define MIX_SAMPLE_RATE (16000)
+#define MIX_CHANNEL     (1)
+#define CALL_DUCK_GAIN  (0.3f)
+
 #define RET_ON_NULL(ptr, v) do {                                \
     if (ptr == NULL) {                                          \
         ESP_LOGE(TAG, "Memory allocate fail on %d", __LINE__);  \
@@ -42,9 +51,13 @@ typedef struct {
 } capture_system_t;
 
 typedef struct {
-    audio_render_handle_t audio_render;
-    video_render_handle_t video_render;
-    av_render_handle_t    player;
+    audio_render_handle_t    audio_render;
+    video_render_handle_t    video_render;
+    av_render_handle_t       player;
+    av_render_mixer_handle_t mixer;
+    audio_render_handle_t    call_source;
+    audio_render_handle_t    music_source;
+    av_render_handle_t       music_player;
 } player_system_t;
 
 static capture_system_t capture_sys;
@@ -55,6 +68,10 @@ static bool           music_stopping = false;
 static const uint8_t *music_to_play;
 static int            music_size;
 static int            music_duration;
+// Given when music rendered to end or stop requested
+static media_lib_sema_handle_t music_wake;
+// Given when music thread exited
+static media_lib_sema_handle_t music_exit;
 
 static esp_capture_video_src_if_t *create_video_source(void)
 {
@@ -161,6 +178,32 @@ static int build_player_system()
         ESP_LOGE(TAG, "Fail to create audio render");
         return -1;
     }
+    // Music has its own player so that it no longer replaces call audio
+    av_render_audio_frame_info_t mix_info = {
+        .sample_rate = MIX_SAMPLE_RATE,
+        .channel = MIX_CHANNEL,
+        .bits_per_sample = 16,
+    };
+    av_render_mixer_cfg_t mixer_cfg = {
+        .out_render = player_sys.audio_render,
+        .out_info = mix_info,
+    };
+    player_sys.mixer = av_render_mixer_create(&mixer_cfg);
+    RET_ON_NULL(player_sys.mixer, -1);
+    av_render_mixer_source_cfg_t call_cfg = {
+        .gain = 1.0f,
+        .priority = 0,
+        .duck_gain = CALL_DUCK_GAIN,
+    };
+    player_sys.call_source = av_render_mixer_alloc_source(player_sys.mixer, &call_cfg);
+    RET_ON_NULL(player_sys.call_source, -1);
+    av_render_mixer_source_cfg_t music_cfg = {
+        .gain = 1.0f,
+        .priority = 1,
+        .duck_gain = 1.0f,
+    };
+    player_sys.music_source = av_render_mixer_alloc_source(player_sys.mixer, &music_cfg);
+    RET_ON_NULL(player_sys.music_source, -1);
     lcd_render_cfg_t lcd_cfg = {
         .lcd_handle = board_get_lcd_handle(),
     };
@@ -171,7 +214,7 @@ static int build_player_system()
         // Allow not display
     }
     av_render_cfg_t render_cfg = {
-        .audio_render = player_sys.audio_render,
+        .audio_render = player_sys.call_source,
         .video_render = player_sys.video_render,
         .audio_raw_fifo_size = 4096,
         .audio_render_fifo_size = 6 * 1024,
@@ -184,6 +227,18 @@ static int build_player_system()
         ESP_LOGE(TAG, "Fail to create player");
         return -1;
     }
+    av_render_set_fixed_frame_info(player_sys.player, &mix_info);
+    av_render_cfg_t music_render_cfg = {
+        .audio_render = player_sys.music_source,
+        .audio_raw_fifo_size = 4096,
+        .audio_render_fifo_size = 6 * 1024,
+    };
+    player_sys.music_player = av_render_open(&music_render_cfg);
+    if (player_sys.music_player == NULL) {
+        ESP_LOGE(TAG, "Fail to create music player");
+        return -1;
+    }
+    av_render_set_fixed_frame_info(player_sys.music_player, &mix_info);
     return 0;
 }
 
@@ -273,7 +328,7 @@ static void music_play_thread(void *arg)
     av_render_audio_info_t render_aud_info = {
         .codec = AV_RENDER_AUDIO_CODEC_AAC,
     };
-    av_render_add_audio_stream(player_sys.player, &render_aud_info);
+    av_render_add_audio_stream(player_sys.music_player, &render_aud_info);
     int music_pos = 0;
     while (!music_stopping && music_duration >= 0) {
         uint32_t start_time = esp_timer_get_time() / 1000;
@@ -292,7 +347,7 @@ static void music_play_thread(void *arg)
                 .data = (uint8_t *)adts_header,
                 .size = send_size,
             };
-            int ret = av_render_add_audio_data(player_sys.player, &audio_data);
+            int ret = av_render_add_audio_data(player_sys.music_player, &audio_data);
             if (ret != 0) {
                 break;
             }
@@ -302,15 +357,12 @@ static void music_play_thread(void *arg)
             music_pos = 0;
             // Play one loop only
             if (music_duration == 0) {
-                av_render_fifo_stat_t stat = { 0 };
-                while (!music_stopping) {
-                    av_render_get_audio_fifo_level(player_sys.player, &stat);
-                    if (stat.data_size > 0) {
-                        media_lib_thread_sleep(50);
-                        continue;
-                    }
-                    break;
-                }
+                // Send EOS and block until it is rendered or stop requested
+                av_render_audio_data_t eos_data = {
+                    .eos = true,
+                };
+                av_render_add_audio_data(player_sys.music_player, &eos_data);
+                media_lib_sema_lock(music_wake, MUSIC_DRAIN_TIMEOUT_MS);
                 break;
             }
         }
@@ -319,18 +371,41 @@ static void music_play_thread(void *arg)
             music_duration -= end_time - start_time;
         }
     }
-    av_render_reset(player_sys.player);
+    av_render_reset(player_sys.music_player);
     music_stopping = false;
     music_playing = false;
+    media_lib_sema_unlock(music_exit);
     media_lib_thread_destroy(NULL);
 }
 
+static int music_render_event(av_render_event_t event, void *ctx)
+{
+    if (event == AV_RENDER_EVENT_AUDIO_EOS) {
+        media_lib_sema_unlock(music_wake);
+    }
+    return 0;
+}
+
 int play_music(const uint8_t *data, int size, int duration)
 {
     if (music_playing) {
         ESP_LOGE(TAG, "Music is playing, stop automatically");
         stop_music();
     }
+    if (music_wake == NULL) {
+        media_lib_sema_create(&music_wake);
+        media_lib_sema_create(&music_exit);
+        if (music_wake == NULL || music_exit == NULL) {
+            ESP_LOGE(TAG, "Fail to create music semaphore");
+            return -1;
+        }
+    }
+    // Clear stale signal from last play
+    while (media_lib_sema_lock(music_wake, 0) == 0) {
+    }
+    while (media_lib_sema_lock(music_exit, 0) == 0) {
+    }
+    av_render_set_event_cb(player_sys.music_player, music_render_event, NULL);
     music_playing = true;
     music_to_play = data;
     music_size = size;
@@ -349,9 +424,8 @@ int stop_music()
 {
     if (music_playing) {
         music_stopping = true;
-        while (music_stopping) {
-            media_lib_thread_sleep(20);
-        }
+        media_lib_sema_unlock(music_wake);
+        media_lib_sema_lock(music_exit, MEDIA_LIB_MAX_LOCK_TIME);
     }
     return 0;
 }
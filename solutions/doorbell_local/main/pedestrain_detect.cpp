@@ -126,7 +126,7 @@ int start_pedestrian_detection(pedestrian_detect_cfg_t *cfg)
     do {
         // Create dual buffer to avoid block output too long
         int size = DETECT_WIDTH * DETECT_HEIGHT * 2 + 256;
-        detector->q = data_queue_init(size);
+        detector->q = data_queue_init_spsc(size);
         if (detector->q == NULL) {
             ESP_LOGE(TAG, "Fail to init queue");
             break;